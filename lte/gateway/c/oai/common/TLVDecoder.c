@@ -37,6 +37,8 @@
 
 int errorCodeDecoder = 0;
 
+static __thread tlv_decode_arena_t *tlv_decode_arena = NULL;
+
 //------------------------------------------------------------------------------
 int decode_bstring(
   bstring *bstr,
@@ -49,7 +51,14 @@ int decode_bstring(
   }
 
   if ((bstr) && (buffer)) {
-    *bstr = blk2bstr(buffer, pdulen);
+    if (
+      (tlv_decode_arena) &&
+      (tlv_decode_arena->nb_views < TLV_DECODE_ARENA_MAX_VIEWS)) {
+      *bstr = &tlv_decode_arena->views[tlv_decode_arena->nb_views++];
+      btfromblk(**bstr, buffer, pdulen);
+    } else {
+      *bstr = blk2bstr(buffer, pdulen);
+    }
     return pdulen;
   } else {
     *bstr = NULL;
@@ -57,6 +66,51 @@ int decode_bstring(
   }
 }
 
+//------------------------------------------------------------------------------
+void tlv_decode_arena_begin(tlv_decode_arena_t *const arena)
+{
+  arena->nb_views = 0;
+  arena->used = 0;
+  tlv_decode_arena = arena;
+}
+
+//------------------------------------------------------------------------------
+void tlv_decode_arena_end(tlv_decode_arena_t *const arena)
+{
+  if (tlv_decode_arena == arena) {
+    tlv_decode_arena = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+void *tlv_decode_arena_alloc(const size_t size)
+{
+  uint8_t *block = NULL;
+
+  if (!tlv_decode_arena) {
+    return NULL;
+  }
+  if (size > TLV_DECODE_ARENA_SIZE - tlv_decode_arena->used) {
+    /* Views into the heap block the caller falls back on would not outlive
+     * it, decode the rest of the message into heap copies */
+    tlv_decode_arena = NULL;
+    return NULL;
+  }
+  block = &tlv_decode_arena->buffer[tlv_decode_arena->used];
+  tlv_decode_arena->used += size;
+  memset(block, 0, size);
+  return block;
+}
+
+//------------------------------------------------------------------------------
+bstring tlv_decode_bstring_own(bstring bstr)
+{
+  if ((bstr) && (bstr->mlen < 0)) {
+    return blk2bstr(bstr->data, bstr->slen);
+  }
+  return bstr;
+}
+
 //------------------------------------------------------------------------------
 bstring dump_bstring_xml(const bstring const bstr)
 {
@@ -52,6 +52,35 @@ int decode_bstring(
 
 bstring dump_bstring_xml(const bstring const bstr);
 
+/* Optional zero-copy decoding: while an arena is installed on the decoding
+ * thread, decode_bstring() returns write protected views into the decoded
+ * buffer instead of heap copies, and a security protected message is
+ * deciphered into the arena instead of a heap buffer. Views are ignored by
+ * bdestroy(), so the usual per field release of the decoded message stays
+ * harmless, and all of them go away with the arena. The decoded buffer must
+ * outlive the views; an IE kept beyond that has to go through
+ * tlv_decode_bstring_own(). Once out of views, decode_bstring() falls back on
+ * heap copies; once out of buffer, the arena is removed for the rest of the
+ * message. */
+#define TLV_DECODE_ARENA_MAX_VIEWS 32
+#define TLV_DECODE_ARENA_SIZE 1024
+
+typedef struct tlv_decode_arena_s {
+  int nb_views;
+  struct tagbstring views[TLV_DECODE_ARENA_MAX_VIEWS];
+  uint32_t used;
+  uint8_t buffer[TLV_DECODE_ARENA_SIZE];
+} tlv_decode_arena_t;
+
+void tlv_decode_arena_begin(tlv_decode_arena_t *const arena);
+void tlv_decode_arena_end(tlv_decode_arena_t *const arena);
+
+/** \brief Zeroed block of the installed arena, NULL if none or full */
+void *tlv_decode_arena_alloc(const size_t size);
+
+/** \brief Give a heap copy of a view, other bstrings are returned as is */
+bstring tlv_decode_bstring_own(bstring bstr);
+
 void tlv_decode_perror(void);
 
 #define CHECK_PDU_POINTER_AND_LENGTH_DECODER(bUFFER, mINIMUMlENGTH, lENGTH)    \
@@ -192,6 +192,11 @@ void itti_free_msg_content(MessageDef *const message_p)
       // DO nothing (trxn)
       break;
 
+    case S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST:
+    case S11_RELEASE_ACCESS_BEARERS_BULK_RESPONSE:
+      // DO nothing
+      break;
+
     case S1AP_UPLINK_NAS_LOG:
     case S1AP_UE_CAPABILITY_IND_LOG:
     case S1AP_INITIAL_CONTEXT_SETUP_LOG:
@@ -0,0 +1,320 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file itti_workers.c
+  \brief Keyed worker threads for ITTI messages, see itti_workers.h.
+*/
+
+#define _GNU_SOURCE // required for pthread_rwlockattr_setkind_np()
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "assertions.h"
+#include "common_defs.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "itti_workers.h"
+
+#define ITTI_WORKER_QUEUE_INITIAL_SIZE 256
+#define ITTI_WORKER_NAME_MAX 10
+
+/*
+ * A barrier message is queued to every worker: each worker reaching it parks,
+ * the last one runs the message then releases the others.
+ */
+typedef struct itti_workers_barrier_s {
+  MessageDef *message_p;
+  // Workers that have not reached the barrier yet
+  uint32_t nb_pending;
+  // Workers that have not left the barrier yet, the last one frees it
+  uint32_t nb_parked;
+  bool released;
+} itti_workers_barrier_t;
+
+typedef struct itti_worker_item_s {
+  MessageDef *message_p;
+  bool exclusive;
+  itti_workers_barrier_t *barrier;
+} itti_worker_item_t;
+
+typedef struct itti_worker_s {
+  struct itti_workers_s *workers;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  bool running;
+  // Ring of pending messages, doubled when full
+  itti_worker_item_t *items;
+  uint32_t size;
+  uint32_t head;
+  uint32_t count;
+} itti_worker_t;
+
+struct itti_workers_s {
+  uint32_t nb_workers;
+  itti_workers_handler_t handler;
+  // Read locked by a worker running a message, write locked for exclusive ones
+  pthread_rwlock_t rwlock;
+  /*
+   * Held while a barrier is queued so that all the workers see the barriers
+   * in the same order, and while parking at or leaving a barrier
+   */
+  pthread_mutex_t barrier_lock;
+  pthread_cond_t barrier_cond;
+  itti_worker_t worker[];
+};
+
+//------------------------------------------------------------------------------
+static void itti_worker_run(
+  itti_workers_t *const workers,
+  const itti_worker_item_t *const item)
+{
+  if (item->exclusive) {
+    pthread_rwlock_wrlock(&workers->rwlock);
+  } else {
+    pthread_rwlock_rdlock(&workers->rwlock);
+  }
+  workers->handler(item->message_p);
+  pthread_rwlock_unlock(&workers->rwlock);
+}
+
+//------------------------------------------------------------------------------
+static void itti_worker_barrier(
+  itti_workers_t *const workers,
+  itti_workers_barrier_t *barrier)
+{
+  bool last = false;
+
+  pthread_mutex_lock(&workers->barrier_lock);
+  if (!(--barrier->nb_pending)) {
+    // Every other worker is parked, the message runs alone
+    pthread_mutex_unlock(&workers->barrier_lock);
+    workers->handler(barrier->message_p);
+    pthread_mutex_lock(&workers->barrier_lock);
+    barrier->released = true;
+    pthread_cond_broadcast(&workers->barrier_cond);
+  }
+  while (!barrier->released) {
+    pthread_cond_wait(&workers->barrier_cond, &workers->barrier_lock);
+  }
+  last = !(--barrier->nb_parked);
+  pthread_mutex_unlock(&workers->barrier_lock);
+  if (last) {
+    free_wrapper((void **) &barrier);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *itti_worker_thread(void *args)
+{
+  itti_worker_t *worker = (itti_worker_t *) args;
+  itti_worker_item_t item = {0};
+
+  while (true) {
+    pthread_mutex_lock(&worker->lock);
+    while ((!worker->count) && worker->running) {
+      pthread_cond_wait(&worker->cond, &worker->lock);
+    }
+    if (!worker->count) {
+      // Stopped and nothing left to process
+      pthread_mutex_unlock(&worker->lock);
+      break;
+    }
+    item = worker->items[worker->head];
+    worker->head = (worker->head + 1) % worker->size;
+    worker->count--;
+    pthread_mutex_unlock(&worker->lock);
+
+    if (item.barrier) {
+      itti_worker_barrier(worker->workers, item.barrier);
+    } else {
+      itti_worker_run(worker->workers, &item);
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void itti_worker_push(
+  itti_worker_t *const worker,
+  MessageDef *message_p,
+  const bool exclusive,
+  itti_workers_barrier_t *const barrier)
+{
+  pthread_mutex_lock(&worker->lock);
+  if (worker->count == worker->size) {
+    itti_worker_item_t *items =
+      calloc(2 * worker->size, sizeof(itti_worker_item_t));
+    DevAssert(items != NULL);
+    for (uint32_t i = 0; i < worker->count; i++) {
+      items[i] = worker->items[(worker->head + i) % worker->size];
+    }
+    free_wrapper((void **) &worker->items);
+    worker->items = items;
+    worker->head = 0;
+    worker->size *= 2;
+  }
+  itti_worker_item_t *item =
+    &worker->items[(worker->head + worker->count) % worker->size];
+  item->message_p = message_p;
+  item->exclusive = exclusive;
+  item->barrier = barrier;
+  worker->count++;
+  pthread_cond_signal(&worker->cond);
+  pthread_mutex_unlock(&worker->lock);
+}
+
+//------------------------------------------------------------------------------
+itti_workers_t *itti_workers_create(
+  const char *const name,
+  const uint32_t nb_workers,
+  itti_workers_handler_t handler)
+{
+  itti_workers_t *workers = NULL;
+  pthread_rwlockattr_t attr;
+  char thread_name[24];
+
+  DevAssert(handler != NULL);
+  if (!nb_workers) {
+    return NULL;
+  }
+  workers =
+    calloc(1, sizeof(itti_workers_t) + nb_workers * sizeof(itti_worker_t));
+  if (!workers) {
+    return NULL;
+  }
+  workers->handler = handler;
+  /*
+   * Without writer preference, a steady flow of messages on the other workers
+   * would delay an exclusive message forever.
+   */
+  pthread_rwlockattr_init(&attr);
+  pthread_rwlockattr_setkind_np(
+    &attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+  pthread_rwlock_init(&workers->rwlock, &attr);
+  pthread_rwlockattr_destroy(&attr);
+  pthread_mutex_init(&workers->barrier_lock, NULL);
+  pthread_cond_init(&workers->barrier_cond, NULL);
+
+  for (uint32_t i = 0; i < nb_workers; i++) {
+    itti_worker_t *worker = &workers->worker[i];
+
+    worker->workers = workers;
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->cond, NULL);
+    worker->items =
+      calloc(ITTI_WORKER_QUEUE_INITIAL_SIZE, sizeof(itti_worker_item_t));
+    DevAssert(worker->items != NULL);
+    worker->size = ITTI_WORKER_QUEUE_INITIAL_SIZE;
+    worker->running = true;
+    if (pthread_create(&worker->thread, NULL, itti_worker_thread, worker)) {
+      OAILOG_ERROR(LOG_ITTI, "Failed to create %s worker %u\n", name, i);
+      pthread_cond_destroy(&worker->cond);
+      pthread_mutex_destroy(&worker->lock);
+      free_wrapper((void **) &worker->items);
+      itti_workers_destroy(&workers);
+      return NULL;
+    }
+    snprintf(
+      thread_name,
+      sizeof(thread_name),
+      "%.*s %u",
+      ITTI_WORKER_NAME_MAX,
+      name,
+      i);
+    pthread_setname_np(worker->thread, thread_name);
+    // Only account for the started ones, in case of destroy on failure
+    workers->nb_workers++;
+  }
+  OAILOG_INFO(LOG_ITTI, "Started %u %s workers\n", workers->nb_workers, name);
+  return workers;
+}
+
+//------------------------------------------------------------------------------
+uint32_t itti_workers_count(const itti_workers_t *const workers)
+{
+  return workers ? workers->nb_workers : 0;
+}
+
+//------------------------------------------------------------------------------
+void itti_workers_dispatch(
+  itti_workers_t *const workers,
+  const uint32_t key,
+  const bool exclusive,
+  MessageDef *message_p)
+{
+  DevAssert(workers != NULL);
+  itti_worker_push(
+    &workers->worker[key % workers->nb_workers], message_p, exclusive, NULL);
+}
+
+//------------------------------------------------------------------------------
+void itti_workers_dispatch_barrier(
+  itti_workers_t *const workers,
+  MessageDef *message_p)
+{
+  itti_workers_barrier_t *barrier = NULL;
+
+  DevAssert(workers != NULL);
+  barrier = calloc(1, sizeof(itti_workers_barrier_t));
+  DevAssert(barrier != NULL);
+  barrier->message_p = message_p;
+  barrier->nb_pending = workers->nb_workers;
+  barrier->nb_parked = workers->nb_workers;
+  pthread_mutex_lock(&workers->barrier_lock);
+  for (uint32_t i = 0; i < workers->nb_workers; i++) {
+    itti_worker_push(&workers->worker[i], NULL, false, barrier);
+  }
+  pthread_mutex_unlock(&workers->barrier_lock);
+}
+
+//------------------------------------------------------------------------------
+void itti_workers_destroy(itti_workers_t **workers)
+{
+  itti_workers_t *pool = *workers;
+
+  if (!pool) {
+    return;
+  }
+  for (uint32_t i = 0; i < pool->nb_workers; i++) {
+    itti_worker_t *worker = &pool->worker[i];
+
+    pthread_mutex_lock(&worker->lock);
+    worker->running = false;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+  }
+  for (uint32_t i = 0; i < pool->nb_workers; i++) {
+    itti_worker_t *worker = &pool->worker[i];
+
+    pthread_join(worker->thread, NULL);
+    pthread_cond_destroy(&worker->cond);
+    pthread_mutex_destroy(&worker->lock);
+    free_wrapper((void **) &worker->items);
+  }
+  pthread_cond_destroy(&pool->barrier_cond);
+  pthread_mutex_destroy(&pool->barrier_lock);
+  pthread_rwlock_destroy(&pool->rwlock);
+  free_wrapper((void **) workers);
+}
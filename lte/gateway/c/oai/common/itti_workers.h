@@ -0,0 +1,72 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file itti_workers.h
+  \brief Pool of threads running the messages of an ITTI task in parallel.
+
+  Every message is given a key (an eNB association, a UE...) and is queued to
+  the worker owning that key, so the messages of a key are processed one at a
+  time and in the order they have been dispatched. Workers run the messages
+  with the pool lock held for reading; a message dispatched as exclusive is
+  run with the lock held for writing, i.e. while no other worker of the pool
+  is running anything. A message dispatched as a barrier is run once every
+  message dispatched before it has been processed, and before any message
+  dispatched after it.
+*/
+
+#ifndef FILE_ITTI_WORKERS_SEEN
+#define FILE_ITTI_WORKERS_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "intertask_interface.h"
+
+// Takes ownership of the message: it has to be freed by the handler
+typedef void (*itti_workers_handler_t)(MessageDef *message_p);
+
+typedef struct itti_workers_s itti_workers_t;
+
+// name is the thread name prefix, at most 10 characters are kept
+itti_workers_t *itti_workers_create(
+  const char *const name,
+  const uint32_t nb_workers,
+  itti_workers_handler_t handler);
+
+// Number of running workers, 0 for a NULL pool
+uint32_t itti_workers_count(const itti_workers_t *const workers);
+
+// Queue the message to the worker owning key
+void itti_workers_dispatch(
+  itti_workers_t *const workers,
+  const uint32_t key,
+  const bool exclusive,
+  MessageDef *message_p);
+
+// Queue the message behind the messages of every worker, see above
+void itti_workers_dispatch_barrier(
+  itti_workers_t *const workers,
+  MessageDef *message_p);
+
+// Process the queued messages then stop and join the workers, free the pool
+void itti_workers_destroy(itti_workers_t **workers);
+
+#endif /* FILE_ITTI_WORKERS_SEEN */
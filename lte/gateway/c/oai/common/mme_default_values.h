@@ -35,6 +35,12 @@
  ******************************************************************************/
 #define MME_STATISTIC_TIMER_S (60)
 
+/*******************************************************************************
+ * MME_APP Constants
+ ******************************************************************************/
+#define MME_UE_WORKERS_DEFAULT (1) ///< MME_APP/NAS UE processing threads
+#define MME_UE_WORKERS_MAX (32) ///< Upper bound of UE_WORKERS
+
 /*******************************************************************************
  * GTPV1 User Plane Constants
  ******************************************************************************/
@@ -48,6 +54,8 @@
 #define S1AP_SCTP_PPID (18) ///< S1AP SCTP Payload Protocol Identifier (PPID)
 
 #define S1AP_OUTCOME_TIMER_DEFAULT (5) ///< S1AP Outcome drop timer (s)
+#define S1AP_WORKERS_DEFAULT (1) ///< S1AP eNB processing threads
+#define S1AP_WORKERS_MAX (32) ///< Upper bound of S1AP_WORKERS
 
 /*******************************************************************************
  * S6A Constants
@@ -35,6 +35,9 @@ typedef struct mme_app_desc_s {
   long statistic_timer_id;
   uint32_t statistic_timer_period;
 
+  /* Periodic timer driving the UE sweep after an HSS reset, 0 when idle */
+  long hss_reset_timer_id;
+
   /* Reader/writer lock */
   pthread_rwlock_t rw_lock;
 
@@ -22,6 +22,8 @@
 #ifndef FILE_MME_APP_STATISTICS_SEEN
 #define FILE_MME_APP_STATISTICS_SEEN
 
+#include <stdint.h>
+
 int mme_app_statistics_display(void);
 
 /*********************************** Utility Functions to update Statistics**************************************/
@@ -31,6 +33,7 @@ void update_mme_app_stats_connected_ue_add(void);
 void update_mme_app_stats_connected_ue_sub(void);
 void update_mme_app_stats_s1u_bearer_add(void);
 void update_mme_app_stats_s1u_bearer_sub(void);
+void update_mme_app_stats_s1u_bearer_sub_bulk(uint32_t nb_bearers);
 void update_mme_app_stats_default_bearer_add(void);
 void update_mme_app_stats_default_bearer_sub(void);
 void update_mme_app_stats_attached_ue_add(void);
@@ -48,6 +48,7 @@
 #include "service303.h"
 
 #define MAX_GUMMEI 2
+#define MME_CONFIG_MAX_TAI 16
 
 #define MME_CONFIG_STRING_MME_CONFIG "MME"
 #define MME_CONFIG_STRING_PID_DIRECTORY "PID_DIRECTORY"
@@ -58,6 +59,7 @@
 #define MME_CONFIG_STRING_MAXUE "MAXUE"
 #define MME_CONFIG_STRING_RELATIVE_CAPACITY "RELATIVE_CAPACITY"
 #define MME_CONFIG_STRING_STATISTIC_TIMER "MME_STATISTIC_TIMER"
+#define MME_CONFIG_STRING_UE_WORKERS "UE_WORKERS"
 
 #define MME_CONFIG_STRING_IP_CAPABILITY "IP_CAPABILITY"
 #define MME_CONFIG_STRING_FULL_NETWORK_NAME "FULL_NETWORK_NAME"
@@ -94,6 +96,7 @@
 #define MME_CONFIG_STRING_S1AP_CONFIG "S1AP"
 #define MME_CONFIG_STRING_S1AP_OUTCOME_TIMER "S1AP_OUTCOME_TIMER"
 #define MME_CONFIG_STRING_S1AP_PORT "S1AP_PORT"
+#define MME_CONFIG_STRING_S1AP_WORKERS "S1AP_WORKERS"
 
 #define MME_CONFIG_STRING_GUMMEI_LIST "GUMMEI_LIST"
 #define MME_CONFIG_STRING_MME_CODE "MME_CODE"
@@ -135,6 +138,13 @@
   "DISABLE_ESM_INFORMATION_PROCEDURE"
 #define MME_CONFIG_STRING_NAS_FORCE_PUSH_DEDICATED_BEARER                      \
   "FORCE_PUSH_DEDICATED_BEARER"
+#define MME_CONFIG_STRING_NAS_ZERO_COPY_DECODE "ZERO_COPY_DECODE"
+#define MME_CONFIG_STRING_NAS_AUTH_VECTOR_PREFETCH "AUTH_VECTOR_PREFETCH"
+#define MME_CONFIG_STRING_NAS_AUTH_VECTOR_LOW_WATER_MARK                       \
+  "AUTH_VECTOR_LOW_WATER_MARK"
+#define MME_CONFIG_STRING_NAS_AUTH_VECTOR_LIFETIME "AUTH_VECTOR_LIFETIME"
+#define MME_CONFIG_STRING_NAS_AUTH_VECTOR_CACHE_MAX_UE                         \
+  "AUTH_VECTOR_CACHE_MAX_UE"
 
 #define MME_CONFIG_STRING_SGS_CONFIG "SGS"
 #define MME_CONFIG_STRING_SGS_TS6_1_TIMER "TS6_1"
@@ -187,6 +197,7 @@ typedef struct sctp_config_s {
 typedef struct s1ap_config_s {
     uint16_t port_number;
     uint8_t outcome_drop_timer_sec;
+    uint8_t nb_workers;
 } s1ap_config_t;
 
 typedef struct ipv4_s {
@@ -227,6 +238,13 @@ typedef struct nas_config_s {
     bool force_reject_tau;
     bool force_reject_sr;
     bool disable_esm_information;
+    // decode EMM messages into a per-message arena, see TLVDecoder.h
+    bool zero_copy_decode;
+    // authentication vector cache, disabled when prefetch <= 1
+    uint8_t auth_vector_prefetch;
+    uint8_t auth_vector_low_water_mark;
+    uint32_t auth_vector_lifetime_sec;
+    uint32_t auth_vector_cache_max_ue;
 } nas_config_t;
 
 typedef struct sgs_config_s {
@@ -269,6 +287,8 @@ typedef struct mme_config_s {
 
   uint32_t mme_statistic_timer;
 
+  uint8_t nb_ue_workers;
+
   bstring ip_capability;
   bstring non_eps_service_control;
 
@@ -309,6 +329,7 @@ void mme_config_init(mme_config_t *);
 int mme_config_parse_opt_line(int argc, char *argv[], mme_config_t *mme_config);
 int mme_config_parse_file(mme_config_t *);
 void mme_config_display(mme_config_t *);
+int mme_config_reload(void);
 
 void mme_config_exit(void);
 
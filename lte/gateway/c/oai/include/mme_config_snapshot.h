@@ -0,0 +1,88 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_config_snapshot.h
+  \brief Immutable views of the reloadable part of the MME configuration.
+
+  A snapshot is built and validated once from a parsed mme_config_t, with
+  the data derived from the served TAIs (S1AP encoded PLMNs and TAIs, NAS
+  TAI list), then published. Readers take a reference on the current one
+  without locking and release it with mme_config_snapshot_put(): a snapshot
+  is not modified once published, the one replaced by a reload is freed by
+  the last of its readers.
+  The GUMMEI list is part of the snapshot but cannot change on reload, the
+  GUTIs allocated by NAS depend on it.
+*/
+
+#ifndef FILE_MME_CONFIG_SNAPSHOT_SEEN
+#define FILE_MME_CONFIG_SNAPSHOT_SEEN
+
+#include <stdint.h>
+
+#include "mme_config.h"
+#include "TrackingAreaIdentityList.h"
+
+typedef struct mme_config_served_plmn_s {
+  uint16_t mcc;
+  uint16_t mnc;
+  uint16_t mnc_len;
+  uint8_t tbcd[3]; // PLMN identity, as encoded in S1AP
+} mme_config_served_plmn_t;
+
+typedef struct mme_config_encoded_tai_s {
+  uint8_t plmn[3]; // PLMN identity, as encoded in S1AP
+  uint8_t tac[2];  // TAC, network byte order
+} mme_config_encoded_tai_t;
+
+typedef struct mme_config_snapshot_s {
+  uint32_t generation;
+
+  uint32_t max_enbs;
+  uint8_t relative_capacity;
+  gummei_config_t gummei;
+  served_tai_t served_tai;
+
+  // Derived from served_tai
+  uint8_t nb_served_plmn;
+  mme_config_served_plmn_t served_plmn[MME_CONFIG_MAX_TAI];
+  mme_config_encoded_tai_t encoded_tai[MME_CONFIG_MAX_TAI];
+  tai_list_t nas_tai_list;
+
+  // References of the readers, plus one while it is the current snapshot
+  uint32_t refcount;
+} mme_config_snapshot_t;
+
+/*
+ * Validate the configuration, build its snapshot and make it the current one.
+ * Returns RETURNerror, keeping the current snapshot, if the configuration is
+ * invalid or changes the GUMMEI list.
+ */
+int mme_config_snapshot_publish(const mme_config_t *config_pP);
+
+// Reference the current snapshot, NULL before the first publish
+const mme_config_snapshot_t *mme_config_snapshot_get(void);
+
+// Release a snapshot got from mme_config_snapshot_get(), NULL is ignored
+void mme_config_snapshot_put(const mme_config_snapshot_t *snapshot);
+
+void mme_config_snapshot_exit(void);
+
+#endif /* FILE_MME_CONFIG_SNAPSHOT_SEEN */
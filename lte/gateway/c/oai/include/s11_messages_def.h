@@ -83,6 +83,16 @@ MESSAGE_DEF(
   MESSAGE_PRIORITY_MED,
   itti_s11_release_access_bearers_response_t,
   s11_release_access_bearers_response)
+MESSAGE_DEF(
+  S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST,
+  MESSAGE_PRIORITY_MED,
+  itti_s11_release_access_bearers_bulk_request_t,
+  s11_release_access_bearers_bulk_request)
+MESSAGE_DEF(
+  S11_RELEASE_ACCESS_BEARERS_BULK_RESPONSE,
+  MESSAGE_PRIORITY_MED,
+  itti_s11_release_access_bearers_bulk_response_t,
+  s11_release_access_bearers_bulk_response)
 MESSAGE_DEF(
   S11_PAGING_REQUEST,
   MESSAGE_PRIORITY_MED,
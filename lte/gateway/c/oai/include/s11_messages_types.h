@@ -59,6 +59,10 @@
   (mSGpTR)->ittiMsg.s11_release_access_bearers_request
 #define S11_RELEASE_ACCESS_BEARERS_RESPONSE(mSGpTR)                            \
   (mSGpTR)->ittiMsg.s11_release_access_bearers_response
+#define S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST(mSGpTR)                        \
+  (mSGpTR)->ittiMsg.s11_release_access_bearers_bulk_request
+#define S11_RELEASE_ACCESS_BEARERS_BULK_RESPONSE(mSGpTR)                       \
+  (mSGpTR)->ittiMsg.s11_release_access_bearers_bulk_response
 #define S11_PAGING_REQUEST(mSGpTR) (mSGpTR)->ittiMsg.s11_paging_request
 #define S11_PAGING_RESPONSE(mSGpTR) (mSGpTR)->ittiMsg.s11_paging_response
 #define S11_SUSPEND_NOTIFICATION(mSGpTR)                                       \
@@ -1133,6 +1137,37 @@ typedef struct itti_s11_release_access_bearers_response_s {
   struct in_addr peer_ip;
 } itti_s11_release_access_bearers_response_t;
 
+#define S11_RELEASE_ACCESS_BEARERS_PER_BULK_MESSAGE 128
+//-----------------------------------------------------------------------------
+/** @struct itti_s11_release_access_bearers_bulk_request_t
+ *  @brief Release Access Bearers Requests of many UEs served by the same SGW
+ *
+ * Internal to the MME and SPGW tasks: used when a whole eNB is released
+ * (reset or SCTP shutdown). The S11 task sends one GTPv2-C Release Access
+ * Bearers Request per entry, the embedded SPGW handles the batch at once and
+ * answers with a single bulk response.
+ */
+typedef struct itti_s11_release_access_bearers_bulk_request_s {
+  struct in_addr peer_ip; ///< SGW shared by all the entries
+  uint16_t num_requests;
+  struct {
+    teid_t local_teid; ///< MME S11 TEID of the UE
+    teid_t teid;       ///< SGW S11 TEID of the PDN connection
+  } requests[S11_RELEASE_ACCESS_BEARERS_PER_BULK_MESSAGE];
+} itti_s11_release_access_bearers_bulk_request_t;
+
+//-----------------------------------------------------------------------------
+/** @struct itti_s11_release_access_bearers_bulk_response_t
+ *  @brief Answers to an itti_s11_release_access_bearers_bulk_request_t
+ */
+typedef struct itti_s11_release_access_bearers_bulk_response_s {
+  uint16_t num_responses;
+  struct {
+    teid_t teid; ///< MME S11 TEID of the UE, 0 if the context was not found
+    gtpv2c_cause_t cause;
+  } responses[S11_RELEASE_ACCESS_BEARERS_PER_BULK_MESSAGE];
+} itti_s11_release_access_bearers_bulk_response_t;
+
 //-----------------------------------------------------------------------------
 /** @struct itti_s11_delete_bearer_command_t
  *  @brief Initiate Delete Bearer procedure
@@ -90,8 +90,11 @@ typedef struct s6a_auth_info_req_s {
   char imsi[IMSI_BCD_DIGITS_MAX + 1];
   uint8_t imsi_length;
   plmn_t visited_plmn;
-  /* Number of vectors to retrieve from HSS, should be equal to one */
+  /* Number of vectors to retrieve from HSS, one unless the MME caches the
+   * unused vectors */
   uint8_t nb_of_vectors;
+  /* Vectors are prefetched for the MME cache, no procedure waits for them */
+  unsigned prefetch : 1;
 
   /* Bit to indicate that USIM has requested a re-synchronization of SQN */
   unsigned re_synchronization : 1;
@@ -109,6 +112,8 @@ typedef struct s6a_auth_info_ans_s {
   s6a_result_t result;
   /* Authentication info containing the vector(s) */
   authentication_info_t auth_info;
+  /* Answer to a prefetch request, see s6a_auth_info_req_t */
+  unsigned prefetch : 1;
 } s6a_auth_info_ans_t;
 
 typedef struct s6a_cancel_location_req_s {
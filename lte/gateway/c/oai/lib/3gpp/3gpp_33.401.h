@@ -63,5 +63,11 @@
  * authentication procedure between UE and MME.
  */
 #define MAX_EPS_AUTH_VECTORS 1
+/* Vectors the MME may ask for in one Authentication Information Request when
+ * it keeps the unused ones in its authentication vector cache. Following
+ * NOTE 2, the cached vectors of a subscriber are dropped on any SQN
+ * re-synchronisation.
+ */
+#define MAX_EPS_AUTH_VECTORS_PER_AIR 5
 
 #endif /* FILE_3GPP_33_401_SEEN */
@@ -0,0 +1,178 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <utility>
+
+#include "DirectoryUpdateQueue.h"
+
+namespace magma {
+
+DirectoryUpdateQueue::DirectoryUpdateQueue(
+  Sender sender,
+  std::chrono::milliseconds window,
+  uint32_t max_in_flight,
+  FlushObserver observer):
+  sender_(std::move(sender)),
+  window_(window),
+  max_in_flight_(max_in_flight ? max_in_flight : 1),
+  observer_(std::move(observer)),
+  stopping_(false),
+  flushing_(false),
+  coalesced_(0),
+  flush_thread_([this]() { flush_loop(); })
+{
+}
+
+DirectoryUpdateQueue::~DirectoryUpdateQueue()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  flush_thread_.join();
+}
+
+std::string DirectoryUpdateQueue::get_key(
+  table_id_t table,
+  const std::string &id)
+{
+  return std::to_string(table) + ":" + id;
+}
+
+void DirectoryUpdateQueue::update_location(
+  table_id_t table,
+  const std::string &id,
+  const std::string &location)
+{
+  enqueue({table, id, false, location});
+}
+
+void DirectoryUpdateQueue::delete_location(
+  table_id_t table,
+  const std::string &id)
+{
+  enqueue({table, id, true, ""});
+}
+
+void DirectoryUpdateQueue::enqueue(DirectoryUpdate update)
+{
+  std::string key = get_key(update.table, update.id);
+  std::lock_guard<std::mutex> guard(lock_);
+
+  auto it = pending_.find(key);
+  if (it == pending_.end()) {
+    pending_.emplace(key, std::move(update));
+    order_.push_back(std::move(key));
+    cv_.notify_all();
+    return;
+  }
+  // An add then remove still deletes, the directory may hold the object
+  // from a previous run
+  coalesced_++;
+  it->second = std::move(update);
+}
+
+std::vector<DirectoryUpdate> DirectoryUpdateQueue::take_ready()
+{
+  std::vector<DirectoryUpdate> batch;
+  std::deque<std::string> deferred;
+
+  while (!order_.empty() && in_flight_.size() < max_in_flight_) {
+    std::string key = std::move(order_.front());
+    order_.pop_front();
+    auto it = pending_.find(key);
+    if (it == pending_.end()) {
+      continue;
+    }
+    // Sent once the previous update of the object is answered
+    if (in_flight_.count(key)) {
+      deferred.push_back(std::move(key));
+      continue;
+    }
+    batch.push_back(std::move(it->second));
+    pending_.erase(it);
+    in_flight_.insert(std::move(key));
+  }
+  order_.insert(order_.begin(), deferred.begin(), deferred.end());
+  return batch;
+}
+
+void DirectoryUpdateQueue::flush_loop()
+{
+  std::unique_lock<std::mutex> lock(lock_);
+
+  while (true) {
+    cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      break;
+    }
+    // Let the burst accumulate
+    if (!stopping_) {
+      cv_.wait_for(lock, window_, [this]() { return stopping_; });
+    }
+
+    flush_stats_t stats = {pending_.size(), 0, coalesced_};
+    coalesced_ = 0;
+    flushing_ = true;
+    // Updates queued meanwhile wait for the next window
+    while (!pending_.empty() && stats.batch_size < stats.queue_depth) {
+      auto batch = take_ready();
+      if (batch.empty()) {
+        cv_.wait(lock);
+        continue;
+      }
+      stats.batch_size += batch.size();
+      lock.unlock();
+      for (const auto &update : batch) {
+        std::string key = get_key(update.table, update.id);
+        sender_(update, [this, key](bool ok) { on_done(key); });
+      }
+      lock.lock();
+    }
+    if (observer_) {
+      lock.unlock();
+      observer_(stats);
+      lock.lock();
+    }
+    flushing_ = false;
+    cv_.notify_all();
+  }
+  cv_.wait(lock, [this]() { return in_flight_.empty(); });
+}
+
+void DirectoryUpdateQueue::on_done(const std::string &key)
+{
+  // Notified under the lock, the queue may be destroyed once it is released
+  std::lock_guard<std::mutex> guard(lock_);
+  in_flight_.erase(key);
+  cv_.notify_all();
+}
+
+bool DirectoryUpdateQueue::wait_idle(std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(lock_);
+  return cv_.wait_for(lock, timeout, [this]() {
+    return pending_.empty() && in_flight_.empty() && !flushing_;
+  });
+}
+
+} // namespace magma
@@ -0,0 +1,127 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "directoryd.h"
+
+namespace magma {
+
+/*
+ * Location update of an object, sent as an UpdateLocation or a DeleteLocation
+ */
+struct DirectoryUpdate {
+  table_id_t table;
+  std::string id;
+  bool remove;
+  std::string location;
+};
+
+/*
+ * Coalesces the location updates sent to directoryd during attach and detach
+ * storms. The updates of an object are merged within a window and the latest
+ * one wins, so a location added then removed is sent as a single
+ * DeleteLocation. After the window everything pending is sent,
+ * with at most max_in_flight RPCs outstanding and never two for the same
+ * object, so that they can't be reordered.
+ */
+class DirectoryUpdateQueue {
+ public:
+  // Sends an update, done must be called once, from any thread
+  using Sender = std::function<void(
+    const DirectoryUpdate &update,
+    std::function<void(bool ok)> done)>;
+
+  struct flush_stats_t {
+    size_t queue_depth; // updates pending when the window closed
+    size_t batch_size;  // updates sent by the flush
+    size_t coalesced;   // updates merged since the last flush
+  };
+  // Called from the queue thread after each flush
+  using FlushObserver = std::function<void(const flush_stats_t &stats)>;
+
+  DirectoryUpdateQueue(
+    Sender sender,
+    std::chrono::milliseconds window,
+    uint32_t max_in_flight,
+    FlushObserver observer = nullptr);
+
+  // Sends what is pending and waits for the RPCs in flight
+  ~DirectoryUpdateQueue();
+
+  void update_location(
+    table_id_t table,
+    const std::string &id,
+    const std::string &location);
+
+  void delete_location(table_id_t table, const std::string &id);
+
+  /*
+   * Waits until nothing is pending or in flight, and the last flush was
+   * reported
+   *
+   * @return false on timeout
+   */
+  bool wait_idle(std::chrono::milliseconds timeout);
+
+ private:
+  void enqueue(DirectoryUpdate update);
+
+  void flush_loop();
+
+  // Takes the pending updates that can be sent now, with lock_ held
+  std::vector<DirectoryUpdate> take_ready();
+
+  void on_done(const std::string &key);
+
+  static std::string get_key(table_id_t table, const std::string &id);
+
+ private:
+  Sender sender_;
+  const std::chrono::milliseconds window_;
+  const uint32_t max_in_flight_;
+  FlushObserver observer_;
+
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool stopping_;
+  bool flushing_;
+  std::unordered_map<std::string, DirectoryUpdate> pending_;
+  // Keys of pending_ by first update, may hold keys no longer pending
+  std::deque<std::string> order_;
+  std::unordered_set<std::string> in_flight_;
+  size_t coalesced_;
+  std::thread flush_thread_;
+};
+
+} // namespace magma
@@ -19,47 +19,92 @@
  *      contact@openairinterface.org
  */
 
+#include <chrono>
 #include <string>
 #include <thread>
 
+#include "DirectoryUpdateQueue.h"
 #include "DirectorydClient.h"
 #include "directoryd.h"
+#include "service303.h"
+
+using magma::DirectoryUpdate;
+using magma::DirectoryUpdateQueue;
+
+// Attach and detach storms are coalesced over this window
+#define DIRECTORYD_UPDATE_WINDOW_MS 50
+#define DIRECTORYD_MAX_IN_FLIGHT 32
 
 static void directoryd_rpc_call_done(const grpc::Status &status);
 
+static void send_update(
+  const DirectoryUpdate &update,
+  std::function<void(bool ok)> done)
+{
+  auto callback = [done](grpc::Status status, magma::Void response) {
+    directoryd_rpc_call_done(status);
+    done(status.ok());
+  };
+  if (update.remove) {
+    magma::DirectoryServiceClient::DeleteLocation(
+      static_cast<magma::TableID>(update.table), update.id, callback);
+  } else {
+    magma::DirectoryServiceClient::UpdateLocation(
+      static_cast<magma::TableID>(update.table),
+      update.id,
+      update.location,
+      callback);
+  }
+}
+
+static void report_flush(const DirectoryUpdateQueue::flush_stats_t &stats)
+{
+  set_gauge("directoryd_update_queue_depth", stats.queue_depth, NO_LABELS);
+  observe_histogram(
+    "directoryd_update_batch_size",
+    stats.batch_size,
+    NO_LABELS,
+    (size_t) 4,
+    1.,
+    10.,
+    100.,
+    1000.);
+  if (stats.coalesced) {
+    increment_counter(
+      "directoryd_updates_coalesced", stats.coalesced, NO_LABELS);
+  }
+}
+
+// Never destroyed, the updates pending at exit would need the client, which
+// may already be gone
+static DirectoryUpdateQueue &get_update_queue()
+{
+  static DirectoryUpdateQueue *queue = new DirectoryUpdateQueue(
+    send_update,
+    std::chrono::milliseconds(DIRECTORYD_UPDATE_WINDOW_MS),
+    DIRECTORYD_MAX_IN_FLIGHT,
+    report_flush);
+  return *queue;
+}
+
 bool directoryd_report_location(table_id_t table, char *imsi)
 {
   // Actual GW_ID will be filled in the cloud
-  magma::DirectoryServiceClient::UpdateLocation(
-    static_cast<magma::TableID>(table),
-    "IMSI" + std::string(imsi),
-    std::string("GW_ID"),
-    [&](grpc::Status status, magma::Void response) {
-      directoryd_rpc_call_done(status);
-    });
+  get_update_queue().update_location(
+    table, "IMSI" + std::string(imsi), std::string("GW_ID"));
   return true;
 }
 
 bool directoryd_remove_location(table_id_t table, char *imsi)
 {
-  magma::DirectoryServiceClient::DeleteLocation(
-    static_cast<magma::TableID>(table),
-    "IMSI" + std::string(imsi),
-    [&](grpc::Status status, magma::Void response) {
-      directoryd_rpc_call_done(status);
-    });
+  get_update_queue().delete_location(table, "IMSI" + std::string(imsi));
   return true;
 }
 
 bool directoryd_update_location(table_id_t table, char *imsi, char *location)
 {
-  magma::DirectoryServiceClient::UpdateLocation(
-    static_cast<magma::TableID>(table),
-    "IMSI" + std::string(imsi),
-    std::string(location),
-    [&](grpc::Status status, magma::Void response) {
-      directoryd_rpc_call_done(status);
-    });
+  get_update_queue().update_location(
+    table, "IMSI" + std::string(imsi), std::string(location));
   return true;
 }
 
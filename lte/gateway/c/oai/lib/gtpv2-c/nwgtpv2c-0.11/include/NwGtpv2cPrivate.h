@@ -34,6 +34,8 @@
 #ifndef __NW_GTPV2C_PRIVATE_H__
 #define __NW_GTPV2C_PRIVATE_H__
 
+#include <pthread.h>
+#include <stddef.h>
 #include <sys/time.h>
 
 #include "assertions.h"
@@ -100,6 +102,49 @@ extern "C" {
  * gtpv2c stack class definition
  */
 
+/*--------------------------------------------------------------------------*
+ * Object Pool Definition
+ *--------------------------------------------------------------------------*/
+
+/**
+ * Free list of one type of object, owned by a stack instance. The objects are
+ * linked through their own next pointer, found at linkOffset. The lock allows
+ * an object to be released by another thread than the one of its stack.
+ */
+
+typedef struct nw_gtpv2c_pool_s {
+  pthread_mutex_t lock;
+  size_t objSize;
+  size_t linkOffset;
+  void *pFreeList;
+  uint32_t freeCount;
+  uint32_t freeMax;
+  uint32_t usedCount;
+  uint32_t usedMax;
+  uint64_t heapAllocCount;
+} nw_gtpv2c_pool_t;
+
+#define NW_GTPV2C_POOL_INIT(_pool, _type, _prealloc, _freeMax)                 \
+  nwGtpv2cPoolInit(                                                            \
+    (_pool), sizeof(_type), offsetof(_type, next), (_prealloc), (_freeMax))
+
+nw_rc_t nwGtpv2cPoolInit(
+  nw_gtpv2c_pool_t *thiz,
+  size_t objSize,
+  size_t linkOffset,
+  uint32_t preallocCount,
+  uint32_t freeMax);
+
+void nwGtpv2cPoolFinalize(nw_gtpv2c_pool_t *thiz);
+
+void *nwGtpv2cPoolAlloc(nw_gtpv2c_pool_t *thiz);
+
+void nwGtpv2cPoolFree(nw_gtpv2c_pool_t *thiz, void *pObj);
+
+void nwGtpv2cPoolGetStats(
+  nw_gtpv2c_pool_t *thiz,
+  nw_gtpv2c_pool_stats_t *pStats);
+
 typedef struct nw_gtpv2c_stack_s {
   uint32_t id;
   nw_gtpv2c_ulp_entity_t ulp;
@@ -122,6 +167,11 @@ typedef struct nw_gtpv2c_stack_s {
   outstandingRxSeqNumMap;
   RB_HEAD(NwGtpv2cActiveTimerList, nw_gtpv2c_timeout_info_s) activeTimerList;
   NwPtrT hTmrMinHeap;
+
+  nw_gtpv2c_pool_t msgPool;
+  nw_gtpv2c_pool_t trxnPool;
+  nw_gtpv2c_pool_t tunnelPool;
+  nw_gtpv2c_pool_t timeoutInfoPool;
 } nw_gtpv2c_stack_t;
 
 /*--------------------------------------------------------------------------*
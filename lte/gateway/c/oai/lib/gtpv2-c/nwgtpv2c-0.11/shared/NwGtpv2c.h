@@ -138,6 +138,40 @@ typedef struct nw_gtpv2c_stack_config_s {
   uint16_t __tbd;
 } nw_gtpv2c_stack_config_t;
 
+/*--------------------------------------------------------------------------*
+ *            S T A C K        P O O L      D E F I N I T I O N S           *
+ *--------------------------------------------------------------------------*/
+
+/**
+ * Each stack instance keeps its own pools of messages, transactions, tunnels
+ * and timers. PREALLOC objects are allocated by nwGtpv2cInitialize, at most
+ * FREE_MAX released objects are kept for reuse, the others go back to the
+ * heap.
+ */
+#define NW_GTPV2C_MSG_POOL_PREALLOC (64)
+#define NW_GTPV2C_MSG_POOL_FREE_MAX (256)
+#define NW_GTPV2C_TRXN_POOL_PREALLOC (256)
+#define NW_GTPV2C_TRXN_POOL_FREE_MAX (4096)
+#define NW_GTPV2C_TUNNEL_POOL_PREALLOC (256)
+#define NW_GTPV2C_TUNNEL_POOL_FREE_MAX (16384)
+#define NW_GTPV2C_TIMEOUT_INFO_POOL_PREALLOC (256)
+#define NW_GTPV2C_TIMEOUT_INFO_POOL_FREE_MAX (4096)
+
+typedef struct nw_gtpv2c_pool_stats_s {
+  uint32_t usedCount;      /**< Objects currently in use              */
+  uint32_t usedMax;        /**< Highest number of objects in use      */
+  uint32_t freeCount;      /**< Objects kept in the pool for reuse    */
+  uint32_t freeMax;        /**< Bound of freeCount                    */
+  uint64_t heapAllocCount; /**< Allocations not served by the pool    */
+} nw_gtpv2c_pool_stats_t;
+
+typedef struct nw_gtpv2c_stack_stats_s {
+  nw_gtpv2c_pool_stats_t msgPool;
+  nw_gtpv2c_pool_stats_t trxnPool;
+  nw_gtpv2c_pool_stats_t tunnelPool;
+  nw_gtpv2c_pool_stats_t timeoutInfoPool;
+} nw_gtpv2c_stack_stats_t;
+
 /*--------------------------------------------------------------------------*
  *            S T A C K        A P I      D E F I N I T I O N S             *
  *--------------------------------------------------------------------------*/
@@ -591,6 +625,19 @@ nw_rc_t nwGtpv2cProcessUlpReq(
 
 nw_rc_t nwGtpv2cProcessTimeout(NW_IN void *timeoutArg);
 
+/**
+ Get the occupancy of the pools of a stack instance. May be called from any
+ thread.
+
+ @param[in] hGtpcStackHandle : Stack instance handle
+ @param[out] pStats : Pool statistics
+ @return NW_OK on success.
+ */
+
+nw_rc_t nwGtpv2cGetStackStats(
+  NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+  NW_OUT nw_gtpv2c_stack_stats_t *pStats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,7 @@
  * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.          *
  *----------------------------------------------------------------------------*/
 
+#include <stddef.h>
 #include <string.h>
 #include "NwTypes.h"
 #include "NwGtpv2c.h"
@@ -70,6 +71,51 @@ typedef struct nw_gtpv2c_msg_parser_s {
   uint8_t *pIe[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
 } nw_gtpv2c_msg_parser_t;
 
+/**
+ * Maximum number of IEs described by a message parser template.
+ */
+#define NW_GTPV2C_MSG_PARSER_TEMPLATE_MAX_IES (32)
+
+/**
+ * Argument offset of the template IEs whose read callback takes no argument.
+ */
+#define NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG ((size_t) -1)
+
+/**
+ * A message parser template is the read-only description of one message type,
+ * built once and shared by all the parses of this message type. The callback
+ * arguments of the IEs are stored as offsets in a per parse context (usually
+ * the ITTI message being filled), ieIndex gives in one lookup the entry of a
+ * received (type, instance) pair.
+ */
+typedef struct nw_gtpv2c_msg_parser_template_s {
+  uint16_t msgType;
+  uint8_t ieCount;
+  uint32_t mandatoryIeMask; /* Bit n set if ieParseInfo[n] is mandatory */
+  nw_rc_t (*ieReadCallback)(
+    uint8_t ieType,
+    uint8_t ieLength,
+    uint8_t ieInstance,
+    uint8_t *ieValue,
+    void *ieReadCallbackArg);
+
+  struct {
+    uint8_t ieType;
+    uint8_t ieInstance;
+    uint8_t iePresence;
+    nw_rc_t (*ieReadCallback)(
+      uint8_t ieType,
+      uint8_t ieLength,
+      uint8_t ieInstance,
+      uint8_t *ieValue,
+      void *ieReadCallbackArg);
+    size_t ieReadCallbackArgOffset;
+  } ieParseInfo[NW_GTPV2C_MSG_PARSER_TEMPLATE_MAX_IES];
+
+  /* 1 + index in ieParseInfo, 0 for the IEs not expected in this message */
+  uint8_t ieIndex[NW_GTPV2C_IE_TYPE_MAXIMUM][NW_GTPV2C_IE_INSTANCE_MAXIMUM];
+} nw_gtpv2c_msg_parser_template_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -151,6 +197,72 @@ nw_rc_t nwGtpv2cMsgParserRun(
   NW_OUT uint8_t *pOffendingIeInstance,
   NW_OUT uint16_t *pOffendingIeLength);
 
+/**
+ * Allocate a gtpv2c message parser template.
+ *
+ * @param[in] msgType : Message type for this template.
+ * @param[in] ieReadCallback : Callback of the IEs added without callback,
+ *            called with a NULL argument.
+ * @param[out] pthiz : Pointer to message parser template handle.
+ */
+
+nw_rc_t nwGtpv2cMsgParserTemplateNew(
+  NW_IN uint8_t msgType,
+  NW_IN nw_rc_t (*ieReadCallback)(
+    uint8_t ieType,
+    uint8_t ieLength,
+    uint8_t ieInstance,
+    uint8_t *ieValue,
+    void *ieReadCallbackArg),
+  NW_OUT nw_gtpv2c_msg_parser_template_t **pthiz);
+
+/**
+ * Free a gtpv2c message parser template.
+ *
+ * @param[in] thiz : Message parser template handle.
+ */
+
+nw_rc_t nwGtpv2cMsgParserTemplateDelete(
+  NW_IN nw_gtpv2c_msg_parser_template_t *thiz);
+
+/**
+ * Describe an IE of the message.
+ *
+ * @param[in] ieReadCallbackArgOffset : Offset of the callback argument in the
+ *            context given to nwGtpv2cMsgParserTemplateRun, or
+ *            NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG to call it with NULL.
+ */
+
+nw_rc_t nwGtpv2cMsgParserTemplateAddIe(
+  NW_IN nw_gtpv2c_msg_parser_template_t *thiz,
+  NW_IN uint8_t ieType,
+  NW_IN uint8_t ieInstance,
+  NW_IN uint8_t iePresence,
+  NW_IN nw_rc_t (*ieReadCallback)(
+    uint8_t ieType,
+    uint8_t ieLength,
+    uint8_t ieInstance,
+    uint8_t *ieValue,
+    void *ieReadCallbackArg),
+  NW_IN size_t ieReadCallbackArgOffset);
+
+/**
+ * Parse a message in a single pass over its IEs. The template is not modified
+ * and may be used concurrently by several threads.
+ *
+ * @param[in] thiz : Message parser template handle.
+ * @param[in] hMsg : Message to parse.
+ * @param[in] pCtx : Base of the IE callback arguments.
+ */
+
+nw_rc_t nwGtpv2cMsgParserTemplateRun(
+  NW_IN const nw_gtpv2c_msg_parser_template_t *thiz,
+  NW_IN nw_gtpv2c_msg_handle_t hMsg,
+  NW_IN void *pCtx,
+  NW_OUT uint8_t *pOffendingIeType,
+  NW_OUT uint8_t *pOffendingIeInstance,
+  NW_OUT uint16_t *pOffendingIeLength);
+
 #ifdef __cplusplus
 }
 #endif
@@ -95,8 +95,6 @@
 extern "C" {
 #endif
 
-static nw_gtpv2c_timeout_info_t *gpGtpv2cTimeoutInfoPool = NULL;
-
 typedef struct {
   int currSize;
   int maxSize;
@@ -1175,6 +1173,145 @@ static nw_rc_t nwGtpv2cHandleTriggeredRsp(
   return rc;
 }
 
+/*--------------------------------------------------------------------------*
+                      P O O L   F U N C T I O N S
+  --------------------------------------------------------------------------*/
+
+#define NW_GTPV2C_POOL_LINK(_pool, _obj)                                       \
+  (*((void **) (((uint8_t *) (_obj)) + (_pool)->linkOffset)))
+
+/**
+   Initialize an object pool and fill it with preallocCount objects.
+*/
+
+nw_rc_t nwGtpv2cPoolInit(
+  nw_gtpv2c_pool_t *thiz,
+  size_t objSize,
+  size_t linkOffset,
+  uint32_t preallocCount,
+  uint32_t freeMax)
+{
+  void *pObj;
+
+  memset(thiz, 0, sizeof(nw_gtpv2c_pool_t));
+  pthread_mutex_init(&thiz->lock, NULL);
+  thiz->objSize = objSize;
+  thiz->linkOffset = linkOffset;
+  thiz->freeMax = freeMax;
+
+  for (uint32_t i = 0; i < preallocCount; i++) {
+    pObj = malloc(objSize);
+
+    if (!pObj) {
+      return NW_FAILURE;
+    }
+
+    NW_GTPV2C_POOL_LINK(thiz, pObj) = thiz->pFreeList;
+    thiz->pFreeList = pObj;
+    thiz->freeCount++;
+  }
+
+  return NW_OK;
+}
+
+/**
+   Release the objects kept by a pool. The objects still in use are not
+   tracked by the pool and must have been released before.
+*/
+
+void nwGtpv2cPoolFinalize(nw_gtpv2c_pool_t *thiz)
+{
+  void *pObj;
+
+  while (thiz->pFreeList) {
+    pObj = thiz->pFreeList;
+    thiz->pFreeList = NW_GTPV2C_POOL_LINK(thiz, pObj);
+    free_wrapper(&pObj);
+  }
+
+  thiz->freeCount = 0;
+  pthread_mutex_destroy(&thiz->lock);
+}
+
+/**
+   Get an object from a pool, from the heap when the pool is empty.
+*/
+
+void *nwGtpv2cPoolAlloc(nw_gtpv2c_pool_t *thiz)
+{
+  void *pObj;
+
+  pthread_mutex_lock(&thiz->lock);
+  pObj = thiz->pFreeList;
+
+  if (pObj) {
+    thiz->pFreeList = NW_GTPV2C_POOL_LINK(thiz, pObj);
+    thiz->freeCount--;
+  } else {
+    thiz->heapAllocCount++;
+  }
+
+  thiz->usedCount++;
+
+  if (thiz->usedCount > thiz->usedMax) {
+    thiz->usedMax = thiz->usedCount;
+  }
+
+  pthread_mutex_unlock(&thiz->lock);
+
+  if (!pObj) {
+    pObj = malloc(thiz->objSize);
+
+    if (!pObj) {
+      pthread_mutex_lock(&thiz->lock);
+      thiz->usedCount--;
+      pthread_mutex_unlock(&thiz->lock);
+    }
+  }
+
+  return pObj;
+}
+
+/**
+   Give an object back to its pool, to the heap when the pool is full.
+*/
+
+void nwGtpv2cPoolFree(nw_gtpv2c_pool_t *thiz, void *pObj)
+{
+  pthread_mutex_lock(&thiz->lock);
+  thiz->usedCount--;
+
+  if (thiz->freeCount < thiz->freeMax) {
+    NW_GTPV2C_POOL_LINK(thiz, pObj) = thiz->pFreeList;
+    thiz->pFreeList = pObj;
+    thiz->freeCount++;
+    pObj = NULL;
+  }
+
+  pthread_mutex_unlock(&thiz->lock);
+
+  if (pObj) {
+    free_wrapper(&pObj);
+  }
+}
+
+/**
+   Snapshot of the occupancy of a pool.
+*/
+
+void nwGtpv2cPoolGetStats(
+  nw_gtpv2c_pool_t *thiz,
+  nw_gtpv2c_pool_stats_t *pStats)
+{
+  pthread_mutex_lock(&thiz->lock);
+  pStats->usedCount = thiz->usedCount;
+  pStats->usedMax = thiz->usedMax;
+  pStats->freeCount = thiz->freeCount;
+  pStats->freeMax = thiz->freeMax;
+  pStats->heapAllocCount = thiz->heapAllocCount;
+  pthread_mutex_unlock(&thiz->lock);
+}
+
 /*--------------------------------------------------------------------------*
                        P U B L I C   F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -1207,6 +1344,32 @@ nw_rc_t nwGtpv2cInitialize(NW_INOUT nw_gtpv2c_stack_handle_t *hGtpcStackHandle)
     /* clang-format on */
     thiz->hTmrMinHeap = (NwPtrT) nwGtpv2cTmrMinHeapNew(10000);
     OAI_GCC_DIAG_ON(pointer - to - int - cast);
+
+    if (
+      (NW_GTPV2C_POOL_INIT(
+         &thiz->msgPool,
+         nw_gtpv2c_msg_t,
+         NW_GTPV2C_MSG_POOL_PREALLOC,
+         NW_GTPV2C_MSG_POOL_FREE_MAX) != NW_OK) ||
+      (NW_GTPV2C_POOL_INIT(
+         &thiz->trxnPool,
+         nw_gtpv2c_trxn_t,
+         NW_GTPV2C_TRXN_POOL_PREALLOC,
+         NW_GTPV2C_TRXN_POOL_FREE_MAX) != NW_OK) ||
+      (NW_GTPV2C_POOL_INIT(
+         &thiz->tunnelPool,
+         nw_gtpv2c_tunnel_t,
+         NW_GTPV2C_TUNNEL_POOL_PREALLOC,
+         NW_GTPV2C_TUNNEL_POOL_FREE_MAX) != NW_OK) ||
+      (NW_GTPV2C_POOL_INIT(
+         &thiz->timeoutInfoPool,
+         nw_gtpv2c_timeout_info_t,
+         NW_GTPV2C_TIMEOUT_INFO_POOL_PREALLOC,
+         NW_GTPV2C_TIMEOUT_INFO_POOL_FREE_MAX) != NW_OK)) {
+      OAILOG_ERROR(LOG_GTPV2C, "Failed to preallocate the stack pools\n");
+      rc = NW_FAILURE;
+    }
+
     NW_GTPV2C_INIT_MSG_IE_PARSE_INFO(thiz, NW_GTP_ECHO_RSP);
     /*
        * For S11 interface
@@ -1288,6 +1451,12 @@ nw_rc_t nwGtpv2cFinalize(NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle)
       ->hTmrMinHeap);
   OAI_GCC_DIAG_ON(int - to - pointer - cast);
 
+  nwGtpv2cPoolFinalize(&((nw_gtpv2c_stack_t *) hGtpcStackHandle)->msgPool);
+  nwGtpv2cPoolFinalize(&((nw_gtpv2c_stack_t *) hGtpcStackHandle)->trxnPool);
+  nwGtpv2cPoolFinalize(&((nw_gtpv2c_stack_t *) hGtpcStackHandle)->tunnelPool);
+  nwGtpv2cPoolFinalize(
+    &((nw_gtpv2c_stack_t *) hGtpcStackHandle)->timeoutInfoPool);
+
   free_wrapper((void **) &hGtpcStackHandle);
   return NW_OK;
 }
@@ -1386,6 +1555,25 @@ nw_rc_t nwGtpv2cSetLogLevel(
   return NW_OK;
 }
 
+/**
+  Get the occupancy of the pools of the stack.
+*/
+
+nw_rc_t nwGtpv2cGetStackStats(
+  NW_IN nw_gtpv2c_stack_handle_t hGtpcStackHandle,
+  NW_OUT nw_gtpv2c_stack_stats_t *pStats)
+{
+  nw_gtpv2c_stack_t *thiz = (nw_gtpv2c_stack_t *) hGtpcStackHandle;
+
+  NW_ASSERT(thiz);
+  NW_ASSERT(pStats);
+  nwGtpv2cPoolGetStats(&thiz->msgPool, &pStats->msgPool);
+  nwGtpv2cPoolGetStats(&thiz->trxnPool, &pStats->trxnPool);
+  nwGtpv2cPoolGetStats(&thiz->tunnelPool, &pStats->tunnelPool);
+  nwGtpv2cPoolGetStats(&thiz->timeoutInfoPool, &pStats->timeoutInfoPool);
+  return NW_OK;
+}
+
 /**
    Process Request from Udp Layer
 */
@@ -1565,6 +1753,8 @@ nw_rc_t nwGtpv2cProcessTimeoutOld(void *arg)
   nw_gtpv2c_timeout_info_t *timeoutInfo = (nw_gtpv2c_timeout_info_t *) arg;
   nw_gtpv2c_timeout_info_t *pNextTimeoutInfo = NULL;
   struct timeval tv = {0};
+  nw_rc_t (*timeoutCallbackFunc)(void *) = NULL;
+  void *timeoutArg = NULL;
 
   NW_ASSERT(timeoutInfo != NULL);
   thiz =
@@ -1575,9 +1765,10 @@ nw_rc_t nwGtpv2cProcessTimeoutOld(void *arg)
   if (thiz->activeTimerInfo == timeoutInfo) {
     thiz->activeTimerInfo = NULL;
     RB_REMOVE(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
+    timeoutCallbackFunc = timeoutInfo->timeoutCallbackFunc;
+    timeoutArg = timeoutInfo->timeoutArg;
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
+    rc = timeoutCallbackFunc(timeoutArg);
   } else {
     OAILOG_WARNING(
       LOG_GTPV2C,
@@ -1598,9 +1789,10 @@ nw_rc_t nwGtpv2cProcessTimeoutOld(void *arg)
     pNextTimeoutInfo =
       RB_NEXT(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
     RB_REMOVE(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
+    timeoutCallbackFunc = timeoutInfo->timeoutCallbackFunc;
+    timeoutArg = timeoutInfo->timeoutArg;
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
+    rc = timeoutCallbackFunc(timeoutArg);
     timeoutInfo = pNextTimeoutInfo;
   }
 
@@ -1633,6 +1825,8 @@ nw_rc_t nwGtpv2cProcessTimeout(void *arg)
   nw_gtpv2c_stack_t *thiz = NULL;
   nw_gtpv2c_timeout_info_t *timeoutInfo = (nw_gtpv2c_timeout_info_t *) arg;
   struct timeval tv = {0};
+  nw_rc_t (*timeoutCallbackFunc)(void *) = NULL;
+  void *timeoutArg = NULL;
 
   NW_ASSERT(timeoutInfo != NULL);
   thiz = (nw_gtpv2c_stack_t *) (timeoutInfo->hStack);
@@ -1648,9 +1842,10 @@ nw_rc_t nwGtpv2cProcessTimeout(void *arg)
       (NwGtpv2cTmrMinHeapT *) thiz->hTmrMinHeap,
       timeoutInfo->timerMinHeapIndex);
     OAI_GCC_DIAG_ON(int - to - pointer - cast);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
+    timeoutCallbackFunc = timeoutInfo->timeoutCallbackFunc;
+    timeoutArg = timeoutInfo->timeoutArg;
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
+    rc = timeoutCallbackFunc(timeoutArg);
   } else {
     OAILOG_WARNING(
       LOG_GTPV2C,
@@ -1680,9 +1875,10 @@ nw_rc_t nwGtpv2cProcessTimeout(void *arg)
       (NwGtpv2cTmrMinHeapT *) thiz->hTmrMinHeap,
       timeoutInfo->timerMinHeapIndex);
     OAI_GCC_DIAG_ON(int - to - pointer - cast);
-    timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = timeoutInfo;
-    rc = ((timeoutInfo)->timeoutCallbackFunc)(timeoutInfo->timeoutArg);
+    timeoutCallbackFunc = timeoutInfo->timeoutCallbackFunc;
+    timeoutArg = timeoutInfo->timeoutArg;
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
+    rc = timeoutCallbackFunc(timeoutArg);
     /* clang-format off */
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
     /* clang-format on */
@@ -1738,16 +1934,8 @@ nw_rc_t nwGtpv2cStartTimer(
 
   OAILOG_FUNC_IN(LOG_GTPV2C);
 
-  if (gpGtpv2cTimeoutInfoPool) {
-    timeoutInfo = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(
-      thiz,
-      sizeof(nw_gtpv2c_timeout_info_t),
-      timeoutInfo,
-      nw_gtpv2c_timeout_info_t *);
-  }
+  timeoutInfo = (nw_gtpv2c_timeout_info_t *) nwGtpv2cPoolAlloc(
+    &thiz->timeoutInfoPool);
 
   if (timeoutInfo) {
     timeoutInfo->tmrType = tmrType;
@@ -1845,16 +2033,8 @@ nw_rc_t nwGtpv2cStartTimerOld(
   NW_ASSERT(thiz != NULL);
   OAILOG_FUNC_IN(LOG_GTPV2C);
 
-  if (gpGtpv2cTimeoutInfoPool) {
-    timeoutInfo = gpGtpv2cTimeoutInfoPool;
-    gpGtpv2cTimeoutInfoPool = gpGtpv2cTimeoutInfoPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(
-      thiz,
-      sizeof(nw_gtpv2c_timeout_info_t),
-      timeoutInfo,
-      nw_gtpv2c_timeout_info_t *);
-  }
+  timeoutInfo = (nw_gtpv2c_timeout_info_t *) nwGtpv2cPoolAlloc(
+    &thiz->timeoutInfoPool);
 
   if (timeoutInfo) {
     timeoutInfo->tmrType = tmrType;
@@ -1947,8 +2127,6 @@ nw_rc_t nwGtpv2cStopTimer(
   rc = nwGtpv2cTmrMinHeapRemove(
     (NwGtpv2cTmrMinHeapT *) thiz->hTmrMinHeap, timeoutInfo->timerMinHeapIndex);
   OAI_GCC_DIAG_ON(int - to - pointer - cast);
-  timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-  gpGtpv2cTimeoutInfoPool = timeoutInfo;
   OAILOG_DEBUG(
     LOG_GTPV2C,
     "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n",
@@ -1971,6 +2149,7 @@ nw_rc_t nwGtpv2cStopTimer(
         timeoutInfo->hTimer,
         timeoutInfo);
     }
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
     /* clang-format off */
       OAI_GCC_DIAG_OFF(int-to-pointer-cast);
     /* clang-format on */
@@ -2003,6 +2182,8 @@ nw_rc_t nwGtpv2cStopTimer(
         thiz->activeTimerInfo = timeoutInfo;
       }
     }
+  } else {
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
   }
 
   OAILOG_FUNC_RETURN(LOG_GTPV2C, rc);
@@ -2020,8 +2201,6 @@ nw_rc_t nwGtpv2cStopTimerOld(
   OAILOG_FUNC_IN(LOG_GTPV2C);
   timeoutInfo = (nw_gtpv2c_timeout_info_t *) hTimer;
   RB_REMOVE(NwGtpv2cActiveTimerList, &(thiz->activeTimerList), timeoutInfo);
-  timeoutInfo->next = gpGtpv2cTimeoutInfoPool;
-  gpGtpv2cTimeoutInfoPool = timeoutInfo;
   OAILOG_DEBUG(
     LOG_GTPV2C,
     "Stopping active timer 0x%" PRIxPTR " for info 0x%p!\n",
@@ -2038,6 +2217,7 @@ nw_rc_t nwGtpv2cStopTimerOld(
       thiz->tmrMgr.tmrMgrHandle, timeoutInfo->hTimer);
     thiz->activeTimerInfo = NULL;
     NW_ASSERT(NW_OK == rc);
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
     timeoutInfo = RB_MIN(NwGtpv2cActiveTimerList, &(thiz->activeTimerList));
 
     if (timeoutInfo) {
@@ -2065,6 +2245,8 @@ nw_rc_t nwGtpv2cStopTimerOld(
         thiz->activeTimerInfo = timeoutInfo;
       }
     }
+  } else {
+    nwGtpv2cPoolFree(&thiz->timeoutInfoPool, timeoutInfo);
   }
 
   OAILOG_FUNC_RETURN(LOG_GTPV2C, rc);
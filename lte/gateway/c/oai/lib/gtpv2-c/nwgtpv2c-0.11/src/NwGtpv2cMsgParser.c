@@ -341,6 +341,218 @@ nw_rc_t nwGtpv2cMsgParserRun(
   return rc;
 }
 
+/**
+   Allocate a gtpv2c message parser template.
+
+   @param[in] msgType : Message type for this template.
+   @param[out] pthiz : Pointer to message parser template handle.
+*/
+
+nw_rc_t nwGtpv2cMsgParserTemplateNew(
+  NW_IN uint8_t msgType,
+  NW_IN nw_rc_t (*ieReadCallback)(
+    uint8_t ieType,
+    uint8_t ieLength,
+    uint8_t ieInstance,
+    uint8_t *ieValue,
+    void *ieReadCallbackArg),
+  NW_OUT nw_gtpv2c_msg_parser_template_t **pthiz)
+{
+  nw_gtpv2c_msg_parser_template_t *thiz;
+
+  thiz = (nw_gtpv2c_msg_parser_template_t *) calloc(
+    1, sizeof(nw_gtpv2c_msg_parser_template_t));
+
+  if (thiz) {
+    thiz->msgType = msgType;
+    thiz->ieReadCallback = ieReadCallback;
+    *pthiz = thiz;
+    return NW_OK;
+  }
+
+  return NW_FAILURE;
+}
+
+/**
+   Free a gtpv2c message parser template.
+
+   @param[in] thiz : Message parser template handle.
+*/
+
+nw_rc_t nwGtpv2cMsgParserTemplateDelete(
+  NW_IN nw_gtpv2c_msg_parser_template_t *thiz)
+{
+  free_wrapper((void **) &thiz);
+  return NW_OK;
+}
+
+nw_rc_t nwGtpv2cMsgParserTemplateAddIe(
+  NW_IN nw_gtpv2c_msg_parser_template_t *thiz,
+  NW_IN uint8_t ieType,
+  NW_IN uint8_t ieInstance,
+  NW_IN uint8_t iePresence,
+  NW_IN nw_rc_t (*ieReadCallback)(
+    uint8_t ieType,
+    uint8_t ieLength,
+    uint8_t ieInstance,
+    uint8_t *ieValue,
+    void *ieReadCallbackArg),
+  NW_IN size_t ieReadCallbackArgOffset)
+{
+  uint8_t ieIndex;
+
+  NW_ASSERT(thiz);
+
+  if (
+    (ieInstance >= NW_GTPV2C_IE_INSTANCE_MAXIMUM) ||
+    (thiz->ieCount >= NW_GTPV2C_MSG_PARSER_TEMPLATE_MAX_IES)) {
+    OAILOG_ERROR(
+      LOG_GTPV2C,
+      "Cannot add IE to template of msg %u for type %u and instance %u!\n",
+      thiz->msgType,
+      ieType,
+      ieInstance);
+    return NW_FAILURE;
+  }
+
+  if (thiz->ieIndex[ieType][ieInstance]) {
+    OAILOG_ERROR(
+      LOG_GTPV2C,
+      "Cannot add IE to template for type %u and instance %u. IE info "
+      "already exists!\n",
+      ieType,
+      ieInstance);
+    return NW_FAILURE;
+  }
+
+  ieIndex = thiz->ieCount++;
+  thiz->ieParseInfo[ieIndex].ieType = ieType;
+  thiz->ieParseInfo[ieIndex].ieInstance = ieInstance;
+  thiz->ieParseInfo[ieIndex].iePresence = iePresence;
+  thiz->ieParseInfo[ieIndex].ieReadCallback = ieReadCallback;
+  thiz->ieParseInfo[ieIndex].ieReadCallbackArgOffset = ieReadCallbackArgOffset;
+  thiz->ieIndex[ieType][ieInstance] = ieIndex + 1;
+
+  if (iePresence == NW_GTPV2C_IE_PRESENCE_MANDATORY) {
+    thiz->mandatoryIeMask |= (1U << ieIndex);
+  }
+
+  return NW_OK;
+}
+
+nw_rc_t nwGtpv2cMsgParserTemplateRun(
+  NW_IN const nw_gtpv2c_msg_parser_template_t *thiz,
+  NW_IN nw_gtpv2c_msg_handle_t hMsg,
+  NW_IN void *pCtx,
+  NW_OUT uint8_t *pOffendingIeType,
+  NW_OUT uint8_t *pOffendingIeInstance,
+  NW_OUT uint16_t *pOffendingIeLength)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t flags;
+  uint8_t ieIndex;
+  uint8_t ieInstance;
+  uint32_t mandatoryIeMask = 0;
+  nw_gtpv2c_ie_tlv_t *pIe;
+  uint8_t *pIeStart;
+  uint8_t *pIeEnd;
+  uint16_t ieLength;
+  void *ieReadCallbackArg;
+  nw_gtpv2c_msg_t *pMsg = (nw_gtpv2c_msg_t *) hMsg;
+
+  NW_ASSERT(thiz);
+  NW_ASSERT(pMsg);
+  flags = *((uint8_t *) (pMsg->msgBuf));
+  pIeStart = (uint8_t *) (pMsg->msgBuf + (flags & 0x08 ? 12 : 8));
+  pIeEnd = (uint8_t *) (pMsg->msgBuf + pMsg->msgLen);
+  memset(pMsg->pIe, 0, sizeof(pMsg->pIe));
+
+  while (pIeStart < pIeEnd) {
+    pIe = (nw_gtpv2c_ie_tlv_t *) pIeStart;
+
+    if (pIeStart + 4 > pIeEnd) {
+      *pOffendingIeType = pIe->t;
+      *pOffendingIeLength = 0;
+      *pOffendingIeInstance = 0;
+      return NW_GTPV2C_MSG_MALFORMED;
+    }
+
+    ieLength = ntohs(pIe->l);
+
+    if (pIeStart + 4 + ieLength > pIeEnd) {
+      *pOffendingIeType = pIe->t;
+      *pOffendingIeLength = pIe->l;
+      *pOffendingIeInstance = pIe->i;
+      return NW_GTPV2C_MSG_MALFORMED;
+    }
+
+    /*
+     * The spare bits of the instance octet are ignored on reception
+     */
+    ieInstance = pIe->i & 0x0f;
+    ieIndex = (ieInstance < NW_GTPV2C_IE_INSTANCE_MAXIMUM) ?
+                thiz->ieIndex[pIe->t][ieInstance] :
+                0;
+
+    if (ieIndex) {
+      ieIndex--;
+      pMsg->pIe[pIe->t][ieInstance] = (uint8_t *) pIeStart;
+
+      if (thiz->ieParseInfo[ieIndex].ieReadCallback) {
+        ieReadCallbackArg =
+          (thiz->ieParseInfo[ieIndex].ieReadCallbackArgOffset ==
+           NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG) ?
+            NULL :
+            ((uint8_t *) pCtx) +
+              thiz->ieParseInfo[ieIndex].ieReadCallbackArgOffset;
+        rc = thiz->ieParseInfo[ieIndex].ieReadCallback(
+          pIe->t, ieLength, ieInstance, pIeStart + 4, ieReadCallbackArg);
+      } else if (thiz->ieReadCallback) {
+        rc = thiz->ieReadCallback(
+          pIe->t, ieLength, ieInstance, pIeStart + 4, NULL);
+      }
+
+      if (NW_OK != rc) {
+        OAILOG_ERROR(
+          LOG_GTPV2C,
+          "Error while parsing IE %u with instance %u and length %u!\n",
+          pIe->t,
+          ieInstance,
+          ieLength);
+        break;
+      }
+
+      mandatoryIeMask |= (1U << ieIndex);
+    } else {
+      OAILOG_WARNING(
+        LOG_GTPV2C,
+        "Unexpected IE %u of length %u received in msg %u!\n",
+        pIe->t,
+        ieLength,
+        thiz->msgType);
+    }
+
+    pIeStart += (ieLength + 4);
+  }
+
+  mandatoryIeMask &= thiz->mandatoryIeMask;
+
+  if ((NW_OK == rc) && (mandatoryIeMask != thiz->mandatoryIeMask)) {
+    for (ieIndex = 0; ieIndex < thiz->ieCount; ieIndex++) {
+      if ((thiz->mandatoryIeMask & ~mandatoryIeMask) & (1U << ieIndex)) {
+        break;
+      }
+    }
+
+    *pOffendingIeType = thiz->ieParseInfo[ieIndex].ieType;
+    *pOffendingIeInstance = thiz->ieParseInfo[ieIndex].ieInstance;
+    *pOffendingIeLength = 0;
+    return NW_GTPV2C_MANDATORY_IE_MISSING;
+  }
+
+  return rc;
+}
+
 #ifdef __cplusplus
 }
 #endif
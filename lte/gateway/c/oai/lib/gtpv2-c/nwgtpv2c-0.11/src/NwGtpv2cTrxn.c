@@ -54,8 +54,6 @@
 extern "C" {
 #endif
 
-static nw_gtpv2c_trxn_t *gpGtpv2cTrxnPool = NULL;
-
 /*--------------------------------------------------------------------------*
                      P R I V A T E      F U N C T I O N S
   --------------------------------------------------------------------------*/
@@ -225,16 +223,12 @@ nw_gtpv2c_trxn_t *nwGtpv2cTrxnNew(NW_IN nw_gtpv2c_stack_t *thiz)
 {
   nw_gtpv2c_trxn_t *pTrxn;
 
-  if (gpGtpv2cTrxnPool) {
-    pTrxn = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t *);
-  }
+  pTrxn = (nw_gtpv2c_trxn_t *) nwGtpv2cPoolAlloc(&thiz->trxnPool);
 
   if (pTrxn) {
     pTrxn->pStack = thiz;
     pTrxn->pMsg = NULL;
+    pTrxn->hRspTmr = 0;
     pTrxn->maxRetries = 2;
     pTrxn->t3Timer = 2;
     pTrxn->seqNum = thiz->seqNum;
@@ -263,16 +257,12 @@ nw_gtpv2c_trxn_t *nwGtpv2cTrxnWithSeqNumNew(
 {
   nw_gtpv2c_trxn_t *pTrxn;
 
-  if (gpGtpv2cTrxnPool) {
-    pTrxn = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t *);
-  }
+  pTrxn = (nw_gtpv2c_trxn_t *) nwGtpv2cPoolAlloc(&thiz->trxnPool);
 
   if (pTrxn) {
     pTrxn->pStack = thiz;
     pTrxn->pMsg = NULL;
+    pTrxn->hRspTmr = 0;
     pTrxn->maxRetries = 2;
     pTrxn->t3Timer = 2;
     pTrxn->seqNum = seqNum;
@@ -305,12 +295,7 @@ nw_gtpv2c_trxn_t *nwGtpv2cTrxnOutstandingRxNew(
   nw_rc_t rc;
   nw_gtpv2c_trxn_t *pTrxn, *pCollision;
 
-  if (gpGtpv2cTrxnPool) {
-    pTrxn = gpGtpv2cTrxnPool;
-    gpGtpv2cTrxnPool = gpGtpv2cTrxnPool->next;
-  } else {
-    NW_GTPV2C_MALLOC(thiz, sizeof(nw_gtpv2c_trxn_t), pTrxn, nw_gtpv2c_trxn_t *);
-  }
+  pTrxn = (nw_gtpv2c_trxn_t *) nwGtpv2cPoolAlloc(&thiz->trxnPool);
 
   if (pTrxn) {
     pTrxn->pStack = thiz;
@@ -388,8 +373,7 @@ nw_rc_t nwGtpv2cTrxnDelete(NW_INOUT nw_gtpv2c_trxn_t **pthiz)
   }
 
   OAILOG_DEBUG(LOG_GTPV2C, "Purging  transaction 0x%p\n", thiz);
-  thiz->next = gpGtpv2cTrxnPool;
-  gpGtpv2cTrxnPool = thiz;
+  nwGtpv2cPoolFree(&pStack->trxnPool, thiz);
   *pthiz = NULL;
   return rc;
 }
@@ -175,6 +175,7 @@ typedef struct itti_desc_s {
 
   bool thread_handling_signals;
   pthread_t thread_ref;
+  task_id_t reload_config_task_id;
 
   const task_info_t *tasks_info;
   const message_info_t *messages_info;
@@ -764,6 +765,11 @@ void itti_receive_msg(task_id_t task_id, MessageDef **received_msg)
     __sync_or_and_fetch(&itti_desc.vcd_receive_msg, 1L << task_id));
 }
 
+void itti_try_receive_msg(task_id_t task_id, MessageDef **received_msg)
+{
+  itti_receive_msg_internal_event_fd(task_id, 1, received_msg);
+}
+
 void itti_poll_msg(task_id_t task_id, MessageDef **received_msg)
 {
   AssertFatal(
@@ -981,6 +987,7 @@ int itti_init(
   itti_desc.thread_max = thread_max;
   itti_desc.messages_id_max = messages_id_max;
   itti_desc.thread_handling_signals = false;
+  itti_desc.reload_config_task_id = TASK_UNKNOWN;
   itti_desc.tasks_info = tasks_info;
   itti_desc.messages_info = messages_info;
   /*
@@ -1205,3 +1212,21 @@ void itti_send_terminate_message(task_id_t task_id)
   terminate_message_p = itti_alloc_new_message(task_id, TERMINATE_MESSAGE);
   itti_send_broadcast_message(terminate_message_p);
 }
+
+void itti_set_reload_config_task(task_id_t task_id)
+{
+  itti_desc.reload_config_task_id = task_id;
+}
+
+void itti_send_reload_config_message(task_id_t task_id)
+{
+  MessageDef *reload_message_p;
+
+  if (itti_desc.reload_config_task_id == TASK_UNKNOWN) {
+    ITTI_DEBUG(ITTI_DEBUG_ISSUES, " No task reloads the configuration\n");
+    return;
+  }
+  reload_message_p = itti_alloc_new_message(task_id, RELOAD_CONFIG_MESSAGE);
+  itti_send_msg_to_task(
+    itti_desc.reload_config_task_id, INSTANCE_DEFAULT, reload_message_p);
+}
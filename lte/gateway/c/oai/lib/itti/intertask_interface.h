@@ -148,6 +148,14 @@ int itti_get_events(task_id_t task_id, struct epoll_event **events);
  **/
 void itti_receive_msg(task_id_t task_id, MessageDef **received_msg);
 
+/** \brief Non blocking version of itti_receive_msg, received_msg is set to NULL
+ * when the queue is empty. Unlike itti_poll_msg, it consumes the task event fd
+ * so it can be mixed with itti_receive_msg.
+ \param task_id Task ID of the receiving task
+ \param received_msg Pointer to the allocated message
+ **/
+void itti_try_receive_msg(task_id_t task_id, MessageDef **received_msg);
+
 /** \brief Try to retrieves a message in the queue associated to task_id.
  \param task_id Task ID of the receiving task
  \param received_msg Pointer to the allocated message
@@ -231,6 +239,17 @@ void itti_wait_tasks_end(void);
  **/
 void itti_send_terminate_message(task_id_t task_id);
 
+/** \brief Select the task reloading the configuration on SIGHUP.
+ * \param task_id task that will receive RELOAD_CONFIG_MESSAGE.
+ **/
+void itti_set_reload_config_task(task_id_t task_id);
+
+/** \brief Send a configuration reload message to the task selected with
+ * itti_set_reload_config_task(), if any.
+ * \param task_id task that is sending the message.
+ **/
+void itti_send_reload_config_message(task_id_t task_id);
+
 void *itti_malloc(
   task_id_t origin_task_id,
   task_id_t destination_task_id,
@@ -55,6 +55,13 @@ MESSAGE_DEF(
   IttiMsgEmpty,
   terminate_message)
 
+/* This message asks for a configuration reload */
+MESSAGE_DEF(
+  RELOAD_CONFIG_MESSAGE,
+  MESSAGE_PRIORITY_MED,
+  IttiMsgEmpty,
+  reload_config_message)
+
 /* Test message used for debug */
 MESSAGE_DEF(MESSAGE_TEST, MESSAGE_PRIORITY_MED, IttiMsgEmpty, message_test)
 
@@ -133,6 +133,7 @@ int signal_mask(void)
   sigaddset(&set, SIGSEGV);
   sigaddset(&set, SIGINT);
   sigaddset(&set, SIGTERM);
+  sigaddset(&set, SIGHUP);
 
   if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) {
     perror("sigprocmask");
@@ -154,6 +155,7 @@ int signal_handle(int *end)
   sigaddset(&set, SIGSEGV);
   sigaddset(&set, SIGINT);
   sigaddset(&set, SIGTERM);
+  sigaddset(&set, SIGHUP);
 
   if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) {
     perror("sigprocmask");
@@ -203,6 +205,11 @@ int signal_handle(int *end)
         *end = 1;
         break;
 
+      case SIGHUP:
+        SIG_DEBUG("Received SIGHUP\n");
+        itti_send_reload_config_message(TASK_UNKNOWN);
+        break;
+
       default: SIG_ERROR("Received unknown signal %d\n", info.si_signo); break;
     }
   }
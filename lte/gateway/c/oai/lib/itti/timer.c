@@ -292,6 +292,25 @@ bool timer_exists(long timer_id)
   return _find_timer(timer_id) != NULL;
 }
 
+int timer_copy_arg(long timer_id, void *arg, size_t arg_size)
+{
+  struct timer_elm_s *timer_p;
+  int rc = -1;
+
+  /*
+   * The argument is freed once the timer is removed, copy it while the timer
+   * cannot be removed
+   */
+  pthread_mutex_lock(&timer_desc.timer_list_mutex);
+  TIMER_SEARCH(timer_p, timer, ((timer_t) timer_id), &timer_desc.timer_queue);
+  if ((timer_p) && (timer_p->timer_arg)) {
+    memcpy(arg, timer_p->timer_arg, arg_size);
+    rc = 0;
+  }
+  pthread_mutex_unlock(&timer_desc.timer_list_mutex);
+  return rc;
+}
+
 int timer_remove(long timer_id, void **arg)
 {
   int rc = 0;
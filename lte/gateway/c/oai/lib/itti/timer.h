@@ -73,6 +73,15 @@ int timer_handle_expired(long timer_id);
 
 bool timer_exists(long timer_id);
 
+/** \brief Copy the argument saved with a timer, that may be removed by
+ *  another thread meanwhile
+ *  \param timer_id unique timer id
+ *  \param arg      where to copy the argument
+ *  \param arg_size size of the data saved with the timer
+ *  @returns -1 if the timer has been removed or has no argument, 0 otherwise
+ **/
+int timer_copy_arg(long timer_id, void *arg, size_t arg_size);
+
 /** \brief Remove the timer from list
  *  \param timer_id unique timer id
  *  @returns -1 on failure, 0 otherwise
@@ -22,6 +22,7 @@
 #include <stdio.h>
 
 #include "BaseApplication.h"
+#include "GTPFlowShadow.h"
 #include "service303.h"
 
 extern "C" {
@@ -62,9 +63,11 @@ void BaseApplication::remove_all_flows(
 {
   of13::FlowMod fm =
     messenger.create_default_flow_mod(0, of13::OFPFC_DELETE, 0);
-  // match all
+  // match all but the GTP flows, resynchronized by the GTP application
   fm.out_port(of13::OFPP_ANY);
   fm.out_group(of13::OFPG_ANY);
+  fm.cookie(0);
+  fm.cookie_mask(GTP_COOKIE_TAG_MASK);
   messenger.send_of_msg(fm, ofconn);
   return;
 }
@@ -53,6 +53,10 @@ class BaseApplication : public Application {
     fluid_base::OFConnection *ofconn,
     const OpenflowMessenger &messenger);
 
+  /**
+   * Removes the flows of table 0, except the GTP flows that are kept across
+   * reconnections and resynchronized by the GTP application
+   */
   void remove_all_flows(
     fluid_base::OFConnection *ofconn,
     const OpenflowMessenger &messenger);
@@ -91,6 +91,15 @@ SwitchUpEvent::SwitchUpEvent(
 {
 }
 
+MultipartReplyEvent::MultipartReplyEvent(
+  fluid_base::OFConnection *ofconn,
+  fluid_base::OFHandler &ofhandler,
+  const void *data,
+  const size_t len):
+  DataEvent(ofconn, ofhandler, data, len, EVENT_MULTIPART_REPLY)
+{
+}
+
 SwitchDownEvent::SwitchDownEvent(fluid_base::OFConnection *ofconn):
   ControllerEvent(ofconn, EVENT_SWITCH_DOWN)
 {
@@ -38,6 +38,9 @@ enum ControllerEventType {
   EVENT_DELETE_GTP_TUNNEL,
   EVENT_DISCARD_DATA_ON_GTP_TUNNEL,
   EVENT_FORWARD_DATA_ON_GTP_TUNNEL,
+  EVENT_MULTIPART_REPLY,
+  EVENT_POLL_GTP_TUNNEL_USAGE,
+  NB_CONTROLLER_EVENT_TYPES,
 };
 
 /**
@@ -111,6 +114,19 @@ class SwitchUpEvent : public DataEvent {
     const size_t len);
 };
 
+/**
+ * Event triggered when the switch answers a multipart request, like a flow
+ * stats dump. Long answers come in several events.
+ */
+class MultipartReplyEvent : public DataEvent {
+ public:
+  MultipartReplyEvent(
+    fluid_base::OFConnection *ofconn,
+    fluid_base::OFHandler &ofhandler,
+    const void *data,
+    const size_t len);
+};
+
 /**
  * Event triggered when the controller loses connection with the switch
  */
@@ -209,4 +225,20 @@ class HandleDataOnGTPTunnelEvent : public ExternalEvent {
   const uint32_t in_tei_;
 };
 
+// Up to 15 digits, and the terminating null
+#define EXTERNAL_COMMAND_IMSI_SIZE 16
+
+/*
+ * External event as queued by the other threads for the event loop: a plain
+ * struct, copied into the queue, from which the event is made
+ */
+struct ExternalCommand {
+  ControllerEventType type;
+  struct in_addr ue_ip;
+  struct in_addr enb_ip;
+  uint32_t in_tei;
+  uint32_t out_tei;
+  char imsi[EXTERNAL_COMMAND_IMSI_SIZE];
+};
+
 } // namespace openflow
@@ -24,6 +24,9 @@
 #include "BaseApplication.h"
 #include "ControllerMain.h"
 #include "GTPApplication.h"
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
 extern "C" {
 #include "log.h"
 #include "spgw_config.h"
@@ -32,6 +35,16 @@ extern "C" {
 namespace {
 openflow::OpenflowController
   ctrl(CONTROLLER_ADDR, CONTROLLER_PORT, NUM_WORKERS, false);
+
+// Usage of the last poll, until the SPGW takes it
+std::mutex usage_lock;
+std::vector<struct gtp_tunnel_usage> polled_usage;
+
+void publish_tunnel_usage(std::vector<struct gtp_tunnel_usage> &usages)
+{
+  std::lock_guard<std::mutex> lock(usage_lock);
+  polled_usage.swap(usages);
+}
 }
 
 int start_of_controller(void)
@@ -40,7 +53,8 @@ int start_of_controller(void)
   static openflow::BaseApplication base_app;
   static openflow::GTPApplication gtp_app(
     std::string(bdata(spgw_config.sgw_config.ovs_config.uplink_mac)),
-    spgw_config.sgw_config.ovs_config.gtp_port_num);
+    spgw_config.sgw_config.ovs_config.gtp_port_num,
+    publish_tunnel_usage);
   // Base app registers first, because it deletes/creates default flow
   ctrl.register_for_event(&base_app, openflow::EVENT_SWITCH_UP);
   ctrl.register_for_event(&base_app, openflow::EVENT_ERROR);
@@ -50,6 +64,10 @@ int start_of_controller(void)
   ctrl.register_for_event(&gtp_app, openflow::EVENT_DELETE_GTP_TUNNEL);
   ctrl.register_for_event(&gtp_app, openflow::EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
   ctrl.register_for_event(&gtp_app, openflow::EVENT_FORWARD_DATA_ON_GTP_TUNNEL);
+  // After the base app, which keeps the GTP flows in place on reconnect
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_SWITCH_UP);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_MULTIPART_REPLY);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_POLL_GTP_TUNNEL_USAGE);
   ctrl.start();
   OAILOG_INFO(LOG_GTPV1U, "Started openflow controller\n");
   return 0;
@@ -63,13 +81,33 @@ int stop_of_controller(void)
 }
 
 /**
- * This callback is called from the event loop itself to dispatch an external
- * event to all registered applications
+ * Queue a command for the event loop, which dispatches the event made from it
+ * to all registered applications
  */
-static void *external_event_callback(std::shared_ptr<void> data)
+static int inject_command(const openflow::ExternalCommand &cmd)
 {
-  auto external_event = std::static_pointer_cast<openflow::ExternalEvent>(data);
-  ctrl.dispatch_event(*external_event);
+  if (!ctrl.inject_external_event(cmd)) {
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Openflow controller queue full, event %d dropped\n",
+      cmd.type);
+    return -1;
+  }
+  return 0;
+}
+
+static openflow::ExternalCommand make_command(
+  openflow::ControllerEventType type,
+  struct in_addr ue,
+  uint32_t i_tei)
+{
+  openflow::ExternalCommand cmd;
+
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.type = type;
+  cmd.ue_ip = ue;
+  cmd.in_tei = i_tei;
+  return cmd;
 }
 
 int openflow_controller_add_gtp_tunnel(
@@ -79,35 +117,52 @@ int openflow_controller_add_gtp_tunnel(
   uint32_t o_tei,
   const char *imsi)
 {
-  auto add_tunnel =
-    std::make_shared<openflow::AddGTPTunnelEvent>(ue, enb, i_tei, o_tei, imsi);
-  ctrl.inject_external_event(add_tunnel, external_event_callback);
-  return 0;
+  auto cmd = make_command(openflow::EVENT_ADD_GTP_TUNNEL, ue, i_tei);
+  cmd.enb_ip = enb;
+  cmd.out_tei = o_tei;
+  snprintf(cmd.imsi, sizeof(cmd.imsi), "%s", imsi);
+  return inject_command(cmd);
 }
 
 int openflow_controller_del_gtp_tunnel(struct in_addr ue, uint32_t i_tei)
 {
-  auto del_tunnel = std::make_shared<openflow::DeleteGTPTunnelEvent>(ue, i_tei);
-  ctrl.inject_external_event(del_tunnel, external_event_callback);
-  return 0;
+  return inject_command(
+    make_command(openflow::EVENT_DELETE_GTP_TUNNEL, ue, i_tei));
 }
 
 int openflow_controller_discard_data_on_tunnel(
   struct in_addr ue,
   uint32_t i_tei)
 {
-  auto gtp_tunnel = std::make_shared<openflow::HandleDataOnGTPTunnelEvent>(
-    ue, i_tei, openflow::EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
-  ctrl.inject_external_event(gtp_tunnel, external_event_callback);
-  return 0;
+  return inject_command(
+    make_command(openflow::EVENT_DISCARD_DATA_ON_GTP_TUNNEL, ue, i_tei));
 }
 
 int openflow_controller_forward_data_on_tunnel(
   struct in_addr ue,
   uint32_t i_tei)
 {
-  auto gtp_tunnel = std::make_shared<openflow::HandleDataOnGTPTunnelEvent>(
-    ue, i_tei, openflow::EVENT_FORWARD_DATA_ON_GTP_TUNNEL);
-  ctrl.inject_external_event(gtp_tunnel, external_event_callback);
-  return 0;
+  return inject_command(
+    make_command(openflow::EVENT_FORWARD_DATA_ON_GTP_TUNNEL, ue, i_tei));
+}
+
+int openflow_controller_poll_tunnel_usage(
+  void (*cb)(const struct gtp_tunnel_usage *usages, uint32_t nb_usages))
+{
+  std::vector<struct gtp_tunnel_usage> usages;
+  struct in_addr no_ue = {.s_addr = INADDR_ANY};
+
+  {
+    std::lock_guard<std::mutex> lock(usage_lock);
+    usages.swap(polled_usage);
+  }
+  if (!usages.empty()) {
+    cb(usages.data(), usages.size());
+  }
+  if (
+    inject_command(
+      make_command(openflow::EVENT_POLL_GTP_TUNNEL_USAGE, no_ue, 0)) < 0) {
+    return -1;
+  }
+  return usages.size();
 }
@@ -25,6 +25,8 @@
 extern "C" {
 #endif
 
+struct gtp_tunnel_usage;
+
 #define CONTROLLER_ADDR "127.0.0.1"
 #define CONTROLLER_PORT 6654
 #define NUM_WORKERS 2
@@ -48,6 +50,14 @@ int openflow_controller_forward_data_on_tunnel(
   struct in_addr ue,
   uint32_t i_tei);
 
+/*
+ * Report the usage of the last poll of the tunnel counters through cb, then
+ * request a new poll. Returns the number of tunnels reported, -1 if the
+ * poll could not be queued.
+ */
+int openflow_controller_poll_tunnel_usage(
+  void (*cb)(const struct gtp_tunnel_usage *usages, uint32_t nb_usages));
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,7 @@
 
 #include <netinet/ip.h>
 #include <arpa/inet.h>
+#include <time.h>
 #include <string>
 
 #include "GTPApplication.h"
@@ -39,37 +40,115 @@ const std::string GTPApplication::GTP_PORT_MAC = "02:00:00:00:00:01";
 
 GTPApplication::GTPApplication(
   const std::string &uplink_mac,
-  uint32_t gtp_port_num):
+  uint32_t gtp_port_num,
+  TunnelUsageCallback usage_cb):
   uplink_mac_(uplink_mac),
-  gtp_port_num_(gtp_port_num)
+  gtp_port_num_(gtp_port_num),
+  usage_cb_(usage_cb)
 {
 }
 
+const GTPFlowShadow &GTPApplication::get_shadow() const
+{
+  return shadow_;
+}
+
 void GTPApplication::event_callback(
   const ControllerEvent &ev,
   const OpenflowMessenger &messenger)
 {
+  // The shadow is updated first, the flows are made from it
   if (ev.get_type() == EVENT_ADD_GTP_TUNNEL) {
     auto add_tunnel_event = static_cast<const AddGTPTunnelEvent &>(ev);
+    shadow_.add_tunnel(
+      add_tunnel_event.get_ue_ip().s_addr,
+      add_tunnel_event.get_enb_ip().s_addr,
+      add_tunnel_event.get_in_tei(),
+      add_tunnel_event.get_out_tei(),
+      IMSIEncoder::compact_imsi(add_tunnel_event.get_imsi()));
+    stats_.add_tunnel(
+      add_tunnel_event.get_ue_ip().s_addr, add_tunnel_event.get_in_tei());
     add_uplink_tunnel_flow(add_tunnel_event, messenger);
     add_downlink_tunnel_flow(add_tunnel_event, messenger);
   } else if (ev.get_type() == EVENT_DELETE_GTP_TUNNEL) {
     auto del_tunnel_event = static_cast<const DeleteGTPTunnelEvent &>(ev);
+    shadow_.delete_tunnel(
+      del_tunnel_event.get_ue_ip().s_addr, del_tunnel_event.get_in_tei());
+    stats_.delete_tunnel(
+      del_tunnel_event.get_ue_ip().s_addr, del_tunnel_event.get_in_tei());
     delete_uplink_tunnel_flow(del_tunnel_event, messenger);
     delete_downlink_tunnel_flow(del_tunnel_event, messenger);
   } else if (ev.get_type() == EVENT_DISCARD_DATA_ON_GTP_TUNNEL) {
     auto discard_tunnel_flow =
       static_cast<const HandleDataOnGTPTunnelEvent &>(ev);
+    shadow_.set_discard(
+      discard_tunnel_flow.get_ue_ip().s_addr,
+      discard_tunnel_flow.get_in_tei(),
+      true);
     discard_uplink_tunnel_flow(discard_tunnel_flow, messenger);
     discard_downlink_tunnel_flow(discard_tunnel_flow, messenger);
   } else if (ev.get_type() == EVENT_FORWARD_DATA_ON_GTP_TUNNEL) {
     auto forward_tunnel_flow =
       static_cast<const HandleDataOnGTPTunnelEvent &>(ev);
+    shadow_.set_discard(
+      forward_tunnel_flow.get_ue_ip().s_addr,
+      forward_tunnel_flow.get_in_tei(),
+      false);
     forward_uplink_tunnel_flow(forward_tunnel_flow, messenger);
     forward_downlink_tunnel_flow(forward_tunnel_flow, messenger);
+  } else if (ev.get_type() == EVENT_SWITCH_UP) {
+    start_resync(ev.get_connection(), messenger);
+  } else if (ev.get_type() == EVENT_POLL_GTP_TUNNEL_USAGE) {
+    start_usage_poll(ev.get_connection(), messenger);
+  } else if (ev.get_type() == EVENT_MULTIPART_REPLY) {
+    auto reply_event = static_cast<const MultipartReplyEvent &>(ev);
+    uint8_t *data = const_cast<uint8_t *>(reply_event.get_data());
+    of13::MultipartReply header;
+    of13::MultipartReplyFlow reply;
+
+    // Only the flow dumps, told apart by transaction
+    header.unpack(data);
+    if (header.mpart_type() != of13::OFPMP_FLOW) {
+      return;
+    }
+    reply.unpack(data);
+    if (reply.xid() == RESYNC_XID) {
+      handle_resync_reply(reply, ev.get_connection(), messenger);
+    } else if ((reply.xid() & USAGE_XID_MASK) == USAGE_XID_PREFIX) {
+      handle_usage_reply(reply);
+    }
   }
 }
 
+/*
+ * Helper method to tell which GTP flow a flow of the dump is
+ */
+static bool get_gtp_flow(
+  of13::FlowStats &stats,
+  uint16_t tunnel_priority,
+  GTPFlow &flow)
+{
+  of13::Match match = stats.match();
+  auto tunnel_id = static_cast<of13::TUNNELId *>(
+    match.oxm_field(of13::OFPXMT_OFB_TUNNEL_ID));
+  auto ipv4_dst =
+    static_cast<of13::IPv4Dst *>(match.oxm_field(of13::OFPXMT_OFB_IPV4_DST));
+  // Discard flows have a higher priority than the tunnel flows
+  bool discard = (stats.priority() > tunnel_priority);
+
+  if (tunnel_id) {
+    flow.type = discard ? GTP_FLOW_UPLINK_DISCARD : GTP_FLOW_UPLINK;
+    flow.key = tunnel_id->value();
+  } else if (ipv4_dst) {
+    flow.type = discard ? GTP_FLOW_DOWNLINK_DISCARD : GTP_FLOW_DOWNLINK;
+    flow.key = ipv4_dst->value().getIPv4();
+  } else {
+    return false;
+  }
+  flow.cookie = stats.cookie();
+  return true;
+}
+
 /*
  * Helper method to add matching for adding/deleting the uplink flow
  */
@@ -88,42 +167,140 @@ void add_uplink_match(
 /*
  * Helper method to add imsi as metadata to the packet
  */
-void add_imsi_metadata(
-  of13::ApplyActions &apply_actions,
-  const std::string &imsi)
+void add_imsi_metadata(of13::ApplyActions &apply_actions, uint64_t imsi)
 {
-  auto metadata_field = new of13::Metadata(IMSIEncoder::compact_imsi(imsi));
+  auto metadata_field = new of13::Metadata(imsi);
   of13::SetFieldAction set_metadata(metadata_field);
   apply_actions.add_action(set_metadata);
 }
 
-void GTPApplication::add_uplink_tunnel_flow(
-  const AddGTPTunnelEvent &ev,
-  const OpenflowMessenger &messenger)
+/*
+ * Helper method to add matching for adding/deleting the downlink flow
+ */
+void add_downlink_match(of13::FlowMod &downlink_fm, const struct in_addr &ue_ip)
 {
-  of13::FlowMod uplink_fm =
-    messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY);
-  add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
+  // Set match on uplink port and IP eth type
+  of13::InPort uplink_port_match(of13::OFPP_LOCAL);
+  downlink_fm.add_oxm_field(uplink_port_match);
+  of13::EthType ip_type(0x0800);
+  downlink_fm.add_oxm_field(ip_type);
 
-  // Set eth src and dst
-  of13::ApplyActions apply_ul_inst;
-  EthAddress gtp_port(GTP_PORT_MAC);
-  // libfluid handles memory freeing of fields
-  of13::SetFieldAction set_eth_src(new of13::EthSrc(gtp_port));
-  apply_ul_inst.add_action(set_eth_src);
+  // Match UE IP destination
+  of13::IPv4Dst ip_match(ue_ip.s_addr);
+  downlink_fm.add_oxm_field(ip_match);
+}
 
-  EthAddress uplink_port(uplink_mac_);
-  of13::SetFieldAction set_eth_dst(new of13::EthDst(uplink_port));
-  apply_ul_inst.add_action(set_eth_dst);
+of13::FlowMod GTPApplication::create_flow_mod(
+  const GTPFlow &flow,
+  const OpenflowMessenger &messenger) const
+{
+  struct in_addr ue_ip;
+
+  ue_ip.s_addr = flow.key;
+  if (flow.type == GTP_FLOW_UPLINK) {
+    const GTPUplinkState *uplink = shadow_.get_uplink(flow.key);
+    of13::FlowMod uplink_fm =
+      messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY);
+    uplink_fm.cookie(flow.cookie);
+    add_uplink_match(uplink_fm, gtp_port_num_, flow.key);
+
+    // Set eth src and dst
+    of13::ApplyActions apply_ul_inst;
+    EthAddress gtp_port(GTP_PORT_MAC);
+    // libfluid handles memory freeing of fields
+    of13::SetFieldAction set_eth_src(new of13::EthSrc(gtp_port));
+    apply_ul_inst.add_action(set_eth_src);
+
+    EthAddress uplink_port(uplink_mac_);
+    of13::SetFieldAction set_eth_dst(new of13::EthDst(uplink_port));
+    apply_ul_inst.add_action(set_eth_dst);
+
+    // add imsi to packet metadata to pass to other tables
+    add_imsi_metadata(apply_ul_inst, uplink->imsi);
+
+    uplink_fm.add_instruction(apply_ul_inst);
+
+    // Output to inout table
+    of13::GoToTable goto_inst(NEXT_TABLE);
+    uplink_fm.add_instruction(goto_inst);
+    return uplink_fm;
+  } else if (flow.type == GTP_FLOW_DOWNLINK) {
+    const GTPDownlinkState *downlink = shadow_.get_downlink(flow.key);
+    of13::FlowMod downlink_fm =
+      messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY);
+    downlink_fm.cookie(flow.cookie);
+    add_downlink_match(downlink_fm, ue_ip);
+
+    of13::ApplyActions apply_dl_inst;
+
+    // Set outgoing tunnel id and tunnel destination ip
+    of13::SetFieldAction set_out_tunnel(new of13::TUNNELId(downlink->out_tei));
+    apply_dl_inst.add_action(set_out_tunnel);
+    of13::SetFieldAction set_tunnel_dst(
+      new of13::TunnelIPv4Dst(downlink->enb_ip));
+    apply_dl_inst.add_action(set_tunnel_dst);
+
+    // add imsi to packet metadata to pass to other tables
+    add_imsi_metadata(apply_dl_inst, downlink->imsi);
+
+    // Output to inout table
+    of13::GoToTable goto_inst(NEXT_TABLE);
+
+    downlink_fm.add_instruction(apply_dl_inst);
+    downlink_fm.add_instruction(goto_inst);
+    return downlink_fm;
+  }
 
-  // add imsi to packet metadata to pass to other tables
-  add_imsi_metadata(apply_ul_inst, ev.get_imsi());
+  // Discard flows: no instruction, the packets are dropped
+  of13::FlowMod discard_fm =
+    messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY + 1);
+  // match all ports and groups
+  discard_fm.out_port(of13::OFPP_ANY);
+  discard_fm.out_group(of13::OFPG_ANY);
+  discard_fm.cookie(flow.cookie);
+  if (flow.type == GTP_FLOW_UPLINK_DISCARD) {
+    add_uplink_match(discard_fm, gtp_port_num_, flow.key);
+  } else {
+    add_downlink_match(discard_fm, ue_ip);
+  }
+  return discard_fm;
+}
 
-  uplink_fm.add_instruction(apply_ul_inst);
+of13::FlowMod GTPApplication::create_strict_delete_flow_mod(
+  const GTPFlow &flow,
+  const OpenflowMessenger &messenger) const
+{
+  bool discard = (flow.type == GTP_FLOW_UPLINK_DISCARD) ||
+                 (flow.type == GTP_FLOW_DOWNLINK_DISCARD);
+  struct in_addr ue_ip;
+  ue_ip.s_addr = flow.key;
+  of13::FlowMod fm = messenger.create_default_flow_mod(
+    0,
+    of13::OFPFC_DELETE_STRICT,
+    discard ? DEFAULT_PRIORITY + 1 : DEFAULT_PRIORITY);
+  // match all ports and groups
+  fm.out_port(of13::OFPP_ANY);
+  fm.out_group(of13::OFPG_ANY);
+  fm.cookie(flow.cookie);
+
+  if (
+    (flow.type == GTP_FLOW_UPLINK) ||
+    (flow.type == GTP_FLOW_UPLINK_DISCARD)) {
+    add_uplink_match(fm, gtp_port_num_, flow.key);
+  } else {
+    add_downlink_match(fm, ue_ip);
+  }
+  return fm;
+}
 
-  // Output to inout table
-  of13::GoToTable goto_inst(NEXT_TABLE);
-  uplink_fm.add_instruction(goto_inst);
+void GTPApplication::add_uplink_tunnel_flow(
+  const AddGTPTunnelEvent &ev,
+  const OpenflowMessenger &messenger)
+{
+  GTPFlow flow = {GTP_FLOW_UPLINK,
+                  ev.get_in_tei(),
+                  shadow_.get_cookie(GTP_FLOW_UPLINK, ev.get_in_tei())};
+  of13::FlowMod uplink_fm = create_flow_mod(flow, messenger);
 
   // Finally, send flow mod
   messenger.send_of_msg(uplink_fm, ev.get_connection());
@@ -139,54 +316,24 @@ void GTPApplication::delete_uplink_tunnel_flow(
   // match all ports and groups
   uplink_fm.out_port(of13::OFPP_ANY);
   uplink_fm.out_group(of13::OFPG_ANY);
+  // and all the GTP flows of the tunnel, discard flow included
+  uplink_fm.cookie(GTP_COOKIE_TAG);
+  uplink_fm.cookie_mask(GTP_COOKIE_TAG_MASK);
 
   add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
 
   messenger.send_of_msg(uplink_fm, ev.get_connection());
 }
 
-/*
- * Helper method to add matching for adding/deleting the downlink flow
- */
-void add_downlink_match(of13::FlowMod &downlink_fm, const struct in_addr &ue_ip)
-{
-  // Set match on uplink port and IP eth type
-  of13::InPort uplink_port_match(of13::OFPP_LOCAL);
-  downlink_fm.add_oxm_field(uplink_port_match);
-  of13::EthType ip_type(0x0800);
-  downlink_fm.add_oxm_field(ip_type);
-
-  // Match UE IP destination
-  of13::IPv4Dst ip_match(ue_ip.s_addr);
-  downlink_fm.add_oxm_field(ip_match);
-}
-
 void GTPApplication::add_downlink_tunnel_flow(
   const AddGTPTunnelEvent &ev,
   const OpenflowMessenger &messenger)
 {
-  of13::FlowMod downlink_fm =
-    messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY);
-
-  add_downlink_match(downlink_fm, ev.get_ue_ip());
-
-  of13::ApplyActions apply_dl_inst;
-
-  // Set outgoing tunnel id and tunnel destination ip
-  of13::SetFieldAction set_out_tunnel(new of13::TUNNELId(ev.get_out_tei()));
-  apply_dl_inst.add_action(set_out_tunnel);
-  of13::SetFieldAction set_tunnel_dst(
-    new of13::TunnelIPv4Dst(ev.get_enb_ip().s_addr));
-  apply_dl_inst.add_action(set_tunnel_dst);
-
-  // add imsi to packet metadata to pass to other tables
-  add_imsi_metadata(apply_dl_inst, ev.get_imsi());
-
-  // Output to inout table
-  of13::GoToTable goto_inst(NEXT_TABLE);
-
-  downlink_fm.add_instruction(apply_dl_inst);
-  downlink_fm.add_instruction(goto_inst);
+  GTPFlow flow = {
+    GTP_FLOW_DOWNLINK,
+    ev.get_ue_ip().s_addr,
+    shadow_.get_cookie(GTP_FLOW_DOWNLINK, ev.get_ue_ip().s_addr)};
+  of13::FlowMod downlink_fm = create_flow_mod(flow, messenger);
 
   // Finally, send flow mod
   messenger.send_of_msg(downlink_fm, ev.get_connection());
@@ -202,6 +349,9 @@ void GTPApplication::delete_downlink_tunnel_flow(
   // match all ports and groups
   downlink_fm.out_port(of13::OFPP_ANY);
   downlink_fm.out_group(of13::OFPG_ANY);
+  // and all the GTP flows of the UE, discard flow included
+  downlink_fm.cookie(GTP_COOKIE_TAG);
+  downlink_fm.cookie_mask(GTP_COOKIE_TAG_MASK);
 
   add_downlink_match(downlink_fm, ev.get_ue_ip());
 
@@ -212,15 +362,10 @@ void GTPApplication::discard_uplink_tunnel_flow(
   const HandleDataOnGTPTunnelEvent &ev,
   const OpenflowMessenger &messenger)
 {
-  of13::FlowMod uplink_fm =
-    messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY + 1);
-  // match all ports and groups
-  uplink_fm.out_port(of13::OFPP_ANY);
-  uplink_fm.out_group(of13::OFPG_ANY);
-  uplink_fm.cookie(cookie);
-  uplink_fm.cookie_mask(cookie);
-
-  add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
+  GTPFlow flow = {GTP_FLOW_UPLINK_DISCARD,
+                  ev.get_in_tei(),
+                  GTP_COOKIE_TAG | GTP_COOKIE_UPLINK_DISCARD};
+  of13::FlowMod uplink_fm = create_flow_mod(flow, messenger);
 
   messenger.send_of_msg(uplink_fm, ev.get_connection());
 }
@@ -229,15 +374,10 @@ void GTPApplication::discard_downlink_tunnel_flow(
   const HandleDataOnGTPTunnelEvent &ev,
   const OpenflowMessenger &messenger)
 {
-  of13::FlowMod downlink_fm =
-    messenger.create_default_flow_mod(0, of13::OFPFC_ADD, DEFAULT_PRIORITY + 1);
-  // match all ports and groups
-  downlink_fm.out_port(of13::OFPP_ANY);
-  downlink_fm.out_group(of13::OFPG_ANY);
-  downlink_fm.cookie(cookie + 1);
-  downlink_fm.cookie_mask(cookie + 1);
-
-  add_downlink_match(downlink_fm, ev.get_ue_ip());
+  GTPFlow flow = {GTP_FLOW_DOWNLINK_DISCARD,
+                  ev.get_ue_ip().s_addr,
+                  GTP_COOKIE_TAG | GTP_COOKIE_DOWNLINK_DISCARD};
+  of13::FlowMod downlink_fm = create_flow_mod(flow, messenger);
 
   messenger.send_of_msg(downlink_fm, ev.get_connection());
 }
@@ -251,8 +391,8 @@ void GTPApplication::forward_uplink_tunnel_flow(
   // match all ports and groups
   uplink_fm.out_port(of13::OFPP_ANY);
   uplink_fm.out_group(of13::OFPG_ANY);
-  uplink_fm.cookie(cookie);
-  uplink_fm.cookie_mask(cookie);
+  uplink_fm.cookie(GTP_COOKIE_UPLINK_DISCARD);
+  uplink_fm.cookie_mask(GTP_COOKIE_UPLINK_DISCARD);
 
   add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
 
@@ -268,12 +408,146 @@ void GTPApplication::forward_downlink_tunnel_flow(
   // match all ports and groups
   downlink_fm.out_port(of13::OFPP_ANY);
   downlink_fm.out_group(of13::OFPG_ANY);
-  downlink_fm.cookie(cookie + 1);
-  downlink_fm.cookie_mask(cookie + 1);
+  downlink_fm.cookie(GTP_COOKIE_DOWNLINK_DISCARD);
+  downlink_fm.cookie_mask(GTP_COOKIE_DOWNLINK_DISCARD);
 
   add_downlink_match(downlink_fm, ev.get_ue_ip());
 
   messenger.send_of_msg(downlink_fm, ev.get_connection());
 }
 
+void GTPApplication::start_resync(
+  fluid_base::OFConnection *ofconn,
+  const OpenflowMessenger &messenger)
+{
+  // Only the flows tagged by this application
+  of13::MultipartRequestFlow dump_request(
+    RESYNC_XID,
+    0,
+    0,
+    of13::OFPP_ANY,
+    of13::OFPG_ANY,
+    GTP_COOKIE_TAG,
+    GTP_COOKIE_TAG_MASK);
+
+  shadow_.start_resync();
+  messenger.send_of_msg(dump_request, ofconn);
+  OAILOG_INFO(
+    LOG_GTPV1U,
+    "Resynchronizing %lu GTP flows with the switch\n",
+    shadow_.get_nb_flows());
+}
+
+void GTPApplication::handle_resync_reply(
+  of13::MultipartReplyFlow &reply,
+  fluid_base::OFConnection *ofconn,
+  const OpenflowMessenger &messenger)
+{
+  std::vector<GTPFlow> flows_to_add;
+  std::vector<GTPFlow> flows_to_delete;
+  std::vector<of13::FlowMod> flow_mods;
+
+  if (!shadow_.is_resyncing()) {
+    return;
+  }
+  for (auto &stats : reply.flow_stats()) {
+    GTPFlow flow;
+    if (get_gtp_flow(stats, DEFAULT_PRIORITY, flow)) {
+      shadow_.add_switch_flow(flow);
+    }
+  }
+  if (reply.flags() & of13::OFPMPF_REPLY_MORE) {
+    return;
+  }
+
+  shadow_.finish_resync(flows_to_add, flows_to_delete);
+  flow_mods.reserve(flows_to_add.size() + flows_to_delete.size());
+  for (auto &flow : flows_to_delete) {
+    flow_mods.push_back(create_strict_delete_flow_mod(flow, messenger));
+  }
+  for (auto &flow : flows_to_add) {
+    flow_mods.push_back(create_flow_mod(flow, messenger));
+  }
+  send_in_batches(flow_mods, ofconn, messenger);
+  OAILOG_INFO(
+    LOG_GTPV1U,
+    "GTP flows resynchronized: %lu added, %lu deleted\n",
+    flows_to_add.size(),
+    flows_to_delete.size());
+}
+
+void GTPApplication::start_usage_poll(
+  fluid_base::OFConnection *ofconn,
+  const OpenflowMessenger &messenger)
+{
+  usage_xid_ = USAGE_XID_PREFIX | ((usage_xid_ + 1) & ~USAGE_XID_MASK);
+  of13::MultipartRequestFlow dump_request(
+    usage_xid_,
+    0,
+    0,
+    of13::OFPP_ANY,
+    of13::OFPG_ANY,
+    GTP_COOKIE_TAG,
+    GTP_COOKIE_TAG_MASK);
+
+  if (stats_.is_polling()) {
+    OAILOG_DEBUG(LOG_GTPV1U, "Previous GTP usage poll left unanswered\n");
+  }
+  stats_.start_poll();
+  messenger.send_of_msg(dump_request, ofconn);
+}
+
+void GTPApplication::handle_usage_reply(of13::MultipartReplyFlow &reply)
+{
+  if (!stats_.is_polling()) {
+    return;
+  }
+  if (reply.xid() != usage_xid_) {
+    OAILOG_DEBUG(
+      LOG_GTPV1U, "Dropping reply of older GTP usage poll %x\n", reply.xid());
+    return;
+  }
+  for (auto &stats : reply.flow_stats()) {
+    GTPFlow flow;
+    if (get_gtp_flow(stats, DEFAULT_PRIORITY, flow)) {
+      stats_.add_flow_stats(flow, stats.packet_count(), stats.byte_count());
+    }
+  }
+  if (reply.flags() & of13::OFPMPF_REPLY_MORE) {
+    return;
+  }
+
+  stats_.finish_poll(time(NULL), usages_);
+  OAILOG_DEBUG(LOG_GTPV1U, "Polled usage of %lu tunnels\n", usages_.size());
+  if (usage_cb_) {
+    usage_cb_(usages_);
+  }
+}
+
+void GTPApplication::send_in_batches(
+  std::vector<of13::FlowMod> &flow_mods,
+  fluid_base::OFConnection *ofconn,
+  const OpenflowMessenger &messenger)
+{
+  std::vector<OFMsg *> batch;
+
+  batch.reserve(RESYNC_BATCH_SIZE + 1);
+  for (size_t first = 0; first < flow_mods.size();
+       first += RESYNC_BATCH_SIZE) {
+    size_t last = first + RESYNC_BATCH_SIZE;
+    // The switch applies the batch before answering the barrier
+    of13::BarrierRequest barrier(RESYNC_XID);
+
+    if (last > flow_mods.size()) {
+      last = flow_mods.size();
+    }
+    batch.clear();
+    for (size_t i = first; i < last; i++) {
+      batch.push_back(&flow_mods[i]);
+    }
+    batch.push_back(&barrier);
+    messenger.send_of_msgs(batch, ofconn);
+  }
+}
+
 } // namespace openflow
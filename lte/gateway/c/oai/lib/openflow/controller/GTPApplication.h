@@ -21,9 +21,13 @@
 
 #pragma once
 
+#include <functional>
+
 #include <gmp.h> // gross but necessary to link spgw_config.h
 
 #include "OpenflowController.h"
+#include "GTPFlowShadow.h"
+#include "GTPTunnelStats.h"
 
 namespace openflow {
 
@@ -33,7 +37,23 @@ namespace openflow {
  */
 class GTPApplication : public Application {
  public:
-  GTPApplication(const std::string &uplink_mac, uint32_t gtp_port_num);
+  /*
+   * Called from the event loop with the usage of every tunnel, at the end of
+   * each poll
+   */
+  typedef std::function<void(std::vector<struct gtp_tunnel_usage> &usages)>
+    TunnelUsageCallback;
+
+  GTPApplication(
+    const std::string &uplink_mac,
+    uint32_t gtp_port_num,
+    TunnelUsageCallback usage_cb = nullptr);
+
+  /*
+   * The GTP flows the switch should have, kept to resynchronize it when it
+   * reconnects
+   */
+  const GTPFlowShadow &get_shadow() const;
 
  private:
   /**
@@ -109,17 +129,77 @@ class GTPApplication : public Application {
     const HandleDataOnGTPTunnelEvent &ev,
     const OpenflowMessenger &messenger);
 
+  /*
+   * Dump the GTP flows of the switch that just connected, to compare them
+   * with the shadow. The flows stay in place meanwhile.
+   */
+  void start_resync(
+    fluid_base::OFConnection *ofconn,
+    const OpenflowMessenger &messenger);
+
+  /*
+   * Compare a part of the dump with the shadow. After the last part, add the
+   * missing or outdated flows and delete the unknown ones, in batches.
+   * @param reply - part of the dump
+   */
+  void handle_resync_reply(
+    fluid_msg::of13::MultipartReplyFlow &reply,
+    fluid_base::OFConnection *ofconn,
+    const OpenflowMessenger &messenger);
+
+  /*
+   * Dump the counters of the GTP flows. A poll still waiting for its reply,
+   * the switch having reconnected meanwhile, is started again.
+   */
+  void start_usage_poll(
+    fluid_base::OFConnection *ofconn,
+    const OpenflowMessenger &messenger);
+
+  /*
+   * Account a part of the counters dump. After the last part, report the
+   * usage of the tunnels. A part of an older poll is dropped.
+   * @param reply - part of the dump
+   */
+  void handle_usage_reply(fluid_msg::of13::MultipartReplyFlow &reply);
+
+  /*
+   * Create the flow mod installing a flow of the shadow
+   */
+  fluid_msg::of13::FlowMod create_flow_mod(
+    const GTPFlow &flow,
+    const OpenflowMessenger &messenger) const;
+
+  /*
+   * Create the flow mod deleting exactly a flow found on the switch
+   */
+  fluid_msg::of13::FlowMod create_strict_delete_flow_mod(
+    const GTPFlow &flow,
+    const OpenflowMessenger &messenger) const;
+
+  void send_in_batches(
+    std::vector<fluid_msg::of13::FlowMod> &flow_mods,
+    fluid_base::OFConnection *ofconn,
+    const OpenflowMessenger &messenger);
+
  private:
   static const uint32_t DEFAULT_PRIORITY = 10;
   static const std::string GTP_PORT_MAC;
   static const uint16_t NEXT_TABLE = 1;
+  // Transactions of the flow dumps, the replies carry them
+  static const uint32_t RESYNC_XID = 0x47545200;
+  // Every usage poll has its own, the replies of an older one are dropped
+  static const uint32_t USAGE_XID_PREFIX = 0x47550000;
+  static const uint32_t USAGE_XID_MASK = 0xffff0000;
+  // Flow mods written at once, followed by a barrier
+  static const size_t RESYNC_BATCH_SIZE = 1024;
 
   const std::string uplink_mac_;
   const uint32_t gtp_port_num_;
-  /* cookie is added to identify the rules enforced for the flow controller
-   * Initialising with 1
-   */
-  const uint64_t cookie = 1;
+  GTPFlowShadow shadow_;
+  GTPTunnelStats stats_;
+  TunnelUsageCallback usage_cb_;
+  std::vector<struct gtp_tunnel_usage> usages_;
+  uint32_t usage_xid_ = USAGE_XID_PREFIX;
 };
 
 } // namespace openflow
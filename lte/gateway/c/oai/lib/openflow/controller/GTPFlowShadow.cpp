@@ -0,0 +1,185 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include "GTPFlowShadow.h"
+
+namespace openflow {
+
+void GTPFlowShadow::add_tunnel(
+  uint32_t ue_ip,
+  uint32_t enb_ip,
+  uint32_t in_tei,
+  uint32_t out_tei,
+  uint64_t imsi)
+{
+  // Replaces the flows with the same match, the discard flows stay
+  GTPUplinkState &uplink = uplinks_[in_tei];
+  GTPDownlinkState &downlink = downlinks_[ue_ip];
+
+  uplink.imsi = imsi;
+  downlink.enb_ip = enb_ip;
+  downlink.out_tei = out_tei;
+  downlink.imsi = imsi;
+}
+
+void GTPFlowShadow::delete_tunnel(uint32_t ue_ip, uint32_t in_tei)
+{
+  // Non strict deletes: the discard flows go as well
+  uplinks_.erase(in_tei);
+  downlinks_.erase(ue_ip);
+}
+
+void GTPFlowShadow::set_discard(uint32_t ue_ip, uint32_t in_tei, bool discard)
+{
+  auto uplink = uplinks_.find(in_tei);
+  auto downlink = downlinks_.find(ue_ip);
+
+  if (uplink != uplinks_.end()) {
+    uplink->second.discard = discard;
+  }
+  if (downlink != downlinks_.end()) {
+    downlink->second.discard = discard;
+  }
+}
+
+uint64_t GTPFlowShadow::fingerprint(uint64_t a, uint64_t b, uint64_t c)
+{
+  // splitmix64 finalizer over the fields
+  uint64_t h = a * 0x9e3779b97f4a7c15ULL ^ b;
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL ^ c;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return GTP_COOKIE_TAG | (h & GTP_COOKIE_FINGERPRINT_MASK);
+}
+
+uint64_t GTPFlowShadow::flow_id(GTPFlowType type, uint32_t key)
+{
+  return ((uint64_t) type << 32) | key;
+}
+
+uint64_t GTPFlowShadow::get_cookie(GTPFlowType type, uint32_t key) const
+{
+  if (type == GTP_FLOW_UPLINK || type == GTP_FLOW_UPLINK_DISCARD) {
+    auto uplink = uplinks_.find(key);
+    if (uplink == uplinks_.end()) {
+      return 0;
+    }
+    if (type == GTP_FLOW_UPLINK) {
+      return fingerprint(key, uplink->second.imsi, 0);
+    }
+    return uplink->second.discard ? GTP_COOKIE_TAG | GTP_COOKIE_UPLINK_DISCARD :
+                                    0;
+  }
+  auto downlink = downlinks_.find(key);
+  if (downlink == downlinks_.end()) {
+    return 0;
+  }
+  if (type == GTP_FLOW_DOWNLINK) {
+    return fingerprint(
+      key,
+      downlink->second.imsi,
+      ((uint64_t) downlink->second.enb_ip << 32) | downlink->second.out_tei);
+  }
+  return downlink->second.discard ?
+           GTP_COOKIE_TAG | GTP_COOKIE_DOWNLINK_DISCARD :
+           0;
+}
+
+const GTPUplinkState *GTPFlowShadow::get_uplink(uint32_t in_tei) const
+{
+  auto uplink = uplinks_.find(in_tei);
+  return uplink == uplinks_.end() ? NULL : &uplink->second;
+}
+
+const GTPDownlinkState *GTPFlowShadow::get_downlink(uint32_t ue_ip) const
+{
+  auto downlink = downlinks_.find(ue_ip);
+  return downlink == downlinks_.end() ? NULL : &downlink->second;
+}
+
+size_t GTPFlowShadow::get_nb_flows() const
+{
+  size_t nb_flows = uplinks_.size() + downlinks_.size();
+
+  for (auto &uplink : uplinks_) {
+    nb_flows += uplink.second.discard;
+  }
+  for (auto &downlink : downlinks_) {
+    nb_flows += downlink.second.discard;
+  }
+  return nb_flows;
+}
+
+void GTPFlowShadow::start_resync()
+{
+  resyncing_ = true;
+  in_sync_.clear();
+  stale_.clear();
+}
+
+void GTPFlowShadow::add_switch_flow(const GTPFlow &flow)
+{
+  uint64_t cookie = get_cookie(flow.type, flow.key);
+
+  if (cookie == flow.cookie) {
+    in_sync_.insert(flow_id(flow.type, flow.key));
+  } else if (!cookie) {
+    // Installed before a restart of the controller, or missed a delete
+    stale_.push_back(flow);
+  }
+  // Otherwise outdated, the add of the current flow replaces it
+}
+
+void GTPFlowShadow::finish_resync(
+  std::vector<GTPFlow> &flows_to_add,
+  std::vector<GTPFlow> &flows_to_delete)
+{
+  auto add_if_missing = [&](GTPFlowType type, uint32_t key) {
+    if (!in_sync_.count(flow_id(type, key))) {
+      flows_to_add.push_back(GTPFlow{type, key, get_cookie(type, key)});
+    }
+  };
+
+  flows_to_add.clear();
+  for (auto &uplink : uplinks_) {
+    add_if_missing(GTP_FLOW_UPLINK, uplink.first);
+    if (uplink.second.discard) {
+      add_if_missing(GTP_FLOW_UPLINK_DISCARD, uplink.first);
+    }
+  }
+  for (auto &downlink : downlinks_) {
+    add_if_missing(GTP_FLOW_DOWNLINK, downlink.first);
+    if (downlink.second.discard) {
+      add_if_missing(GTP_FLOW_DOWNLINK_DISCARD, downlink.first);
+    }
+  }
+  flows_to_delete.swap(stale_);
+  stale_.clear();
+  in_sync_.clear();
+  resyncing_ = false;
+}
+
+bool GTPFlowShadow::is_resyncing() const
+{
+  return resyncing_;
+}
+
+} // namespace openflow
@@ -0,0 +1,136 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace openflow {
+
+/*
+ * Layout of the cookie of the GTP flows. The tag tells them apart from the
+ * flows of the other applications, the fingerprint of the content of the flow
+ * tells a stale flow from a current one without comparing actions. The two
+ * low bits are the discard flows, removed by cookie on forward.
+ */
+#define GTP_COOKIE_TAG (0x4754ULL << 48)
+#define GTP_COOKIE_TAG_MASK (0xffffULL << 48)
+#define GTP_COOKIE_FINGERPRINT_MASK (0xffffffffffffULL & ~0x3ULL)
+#define GTP_COOKIE_UPLINK_DISCARD 0x1ULL
+#define GTP_COOKIE_DOWNLINK_DISCARD 0x2ULL
+
+enum GTPFlowType : uint8_t {
+  GTP_FLOW_UPLINK,           // key is the incoming TEID
+  GTP_FLOW_DOWNLINK,         // key is the UE IP address
+  GTP_FLOW_UPLINK_DISCARD,   // key is the incoming TEID
+  GTP_FLOW_DOWNLINK_DISCARD, // key is the UE IP address
+};
+
+/*
+ * Table 0 flow of a tunnel, as installed or as dumped from the switch
+ */
+struct GTPFlow {
+  GTPFlowType type;
+  uint32_t key;
+  uint64_t cookie;
+};
+
+struct GTPUplinkState {
+  uint64_t imsi; // compacted
+  bool discard;
+};
+
+struct GTPDownlinkState {
+  uint32_t enb_ip;
+  uint32_t out_tei;
+  uint64_t imsi; // compacted
+  bool discard;
+};
+
+/**
+ * GTPFlowShadow mirrors the GTP flows the controller installed in table 0, to
+ * bring the switch back in line after it reconnected: the flows dumped from
+ * the switch are compared with the shadow, and only the missing or stale ones
+ * are pushed again. It holds the state the flows are made from, a few tens of
+ * bytes per tunnel, and is only used from the event loop.
+ */
+class GTPFlowShadow {
+ public:
+  /*
+   * Record the flows of a tunnel. As on the switch, the downlink flow of the
+   * UE is the one of the last tunnel added for its IP address.
+   */
+  void add_tunnel(
+    uint32_t ue_ip,
+    uint32_t enb_ip,
+    uint32_t in_tei,
+    uint32_t out_tei,
+    uint64_t imsi);
+
+  void delete_tunnel(uint32_t ue_ip, uint32_t in_tei);
+
+  void set_discard(uint32_t ue_ip, uint32_t in_tei, bool discard);
+
+  /*
+   * Cookie the flow must be installed with, 0 if the flow is not in the
+   * shadow
+   */
+  uint64_t get_cookie(GTPFlowType type, uint32_t key) const;
+
+  const GTPUplinkState *get_uplink(uint32_t in_tei) const;
+  const GTPDownlinkState *get_downlink(uint32_t ue_ip) const;
+
+  size_t get_nb_flows() const;
+
+  /*
+   * Resynchronization: start it, feed it the GTP flows dumped from the switch,
+   * then get the flows to add or replace, and those to delete
+   */
+  void start_resync();
+
+  void add_switch_flow(const GTPFlow &flow);
+
+  void finish_resync(
+    std::vector<GTPFlow> &flows_to_add,
+    std::vector<GTPFlow> &flows_to_delete);
+
+  bool is_resyncing() const;
+
+ private:
+  static uint64_t fingerprint(uint64_t a, uint64_t b, uint64_t c);
+
+  static uint64_t flow_id(GTPFlowType type, uint32_t key);
+
+ private:
+  std::unordered_map<uint32_t, GTPUplinkState> uplinks_;
+  std::unordered_map<uint32_t, GTPDownlinkState> downlinks_;
+  bool resyncing_ = false;
+  // Flows found up to date on the switch, and flows to delete from it
+  std::unordered_set<uint64_t> in_sync_;
+  std::vector<GTPFlow> stale_;
+};
+
+} // namespace openflow
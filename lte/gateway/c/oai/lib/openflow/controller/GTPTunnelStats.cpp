@@ -0,0 +1,164 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <algorithm>
+
+#include "GTPTunnelStats.h"
+
+namespace openflow {
+
+void GTPTunnelStats::add_tunnel(uint32_t ue_ip, uint32_t in_tei)
+{
+  uint32_t slot = find_slot(uplink_slots_, in_tei);
+
+  if (slot == NO_SLOT) {
+    if (free_slots_.empty()) {
+      slot = tunnels_.size();
+      tunnels_.push_back(Tunnel());
+      in_use_.push_back(false);
+      polled_.push_back(Counters());
+      seen_.push_back(0);
+    } else {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    }
+    uplink_slots_[in_tei] = slot;
+    in_use_[slot] = true;
+    tunnels_[slot] = Tunnel{in_tei, ue_ip, 0, Counters()};
+    polled_[slot] = Counters();
+    seen_[slot] = 0;
+  }
+  // Modified tunnel: the uplink flow and its counters stay
+  tunnels_[slot].ue_ip = ue_ip;
+  downlink_slots_[ue_ip] = slot;
+}
+
+void GTPTunnelStats::delete_tunnel(uint32_t ue_ip, uint32_t in_tei)
+{
+  uint32_t slot = find_slot(uplink_slots_, in_tei);
+
+  // Non strict delete on the switch: the downlink flow of the UE goes anyway
+  downlink_slots_.erase(ue_ip);
+  if (slot == NO_SLOT) {
+    return;
+  }
+  uplink_slots_.erase(in_tei);
+  in_use_[slot] = false;
+  free_slots_.push_back(slot);
+}
+
+size_t GTPTunnelStats::get_nb_tunnels() const
+{
+  return uplink_slots_.size();
+}
+
+void GTPTunnelStats::start_poll()
+{
+  polling_ = true;
+  std::fill(polled_.begin(), polled_.end(), Counters());
+  std::fill(seen_.begin(), seen_.end(), 0);
+}
+
+void GTPTunnelStats::add_flow_stats(
+  const GTPFlow &flow,
+  uint64_t packets,
+  uint64_t bytes)
+{
+  uint32_t slot = NO_SLOT;
+
+  if (flow.type == GTP_FLOW_UPLINK) {
+    slot = find_slot(uplink_slots_, flow.key);
+    if (slot != NO_SLOT) {
+      polled_[slot].ul_packets = packets;
+      polled_[slot].ul_bytes = bytes;
+      seen_[slot] |= SEEN_UPLINK;
+    }
+  } else if (flow.type == GTP_FLOW_DOWNLINK) {
+    slot = find_slot(downlink_slots_, flow.key);
+    if (slot != NO_SLOT) {
+      polled_[slot].dl_packets = packets;
+      polled_[slot].dl_bytes = bytes;
+      seen_[slot] |= SEEN_DOWNLINK;
+    }
+  }
+  // The discard flows count the packets dropped, not the usage
+}
+
+void GTPTunnelStats::finish_poll(
+  time_t now,
+  std::vector<struct gtp_tunnel_usage> &usages)
+{
+  usages.clear();
+  usages.reserve(uplink_slots_.size());
+  for (uint32_t slot = 0; slot < tunnels_.size(); slot++) {
+    if (!in_use_[slot]) {
+      continue;
+    }
+    Tunnel &tunnel = tunnels_[slot];
+    Counters &polled = polled_[slot];
+    struct gtp_tunnel_usage usage;
+
+    // Not in the dump: no usage, the next dump is compared to the last seen
+    if (!(seen_[slot] & SEEN_UPLINK)) {
+      polled.ul_packets = tunnel.total.ul_packets;
+      polled.ul_bytes = tunnel.total.ul_bytes;
+    }
+    if (!(seen_[slot] & SEEN_DOWNLINK)) {
+      polled.dl_packets = tunnel.total.dl_packets;
+      polled.dl_bytes = tunnel.total.dl_bytes;
+    }
+
+    usage.i_tei = tunnel.in_tei;
+    usage.ue.s_addr = tunnel.ue_ip;
+    usage.ul_packets = delta(polled.ul_packets, tunnel.total.ul_packets);
+    usage.ul_bytes = delta(polled.ul_bytes, tunnel.total.ul_bytes);
+    usage.dl_packets = delta(polled.dl_packets, tunnel.total.dl_packets);
+    usage.dl_bytes = delta(polled.dl_bytes, tunnel.total.dl_bytes);
+    if (usage.ul_packets || usage.dl_packets || !tunnel.last_active) {
+      tunnel.last_active = now;
+    }
+    usage.idle_sec = now - tunnel.last_active;
+    tunnel.total = polled;
+    usages.push_back(usage);
+  }
+  polling_ = false;
+}
+
+bool GTPTunnelStats::is_polling() const
+{
+  return polling_;
+}
+
+uint32_t GTPTunnelStats::find_slot(
+  const std::unordered_map<uint32_t, uint32_t> &slots,
+  uint32_t key) const
+{
+  auto it = slots.find(key);
+
+  return (it == slots.end()) ? NO_SLOT : it->second;
+}
+
+uint64_t GTPTunnelStats::delta(uint64_t current, uint64_t previous)
+{
+  return (current >= previous) ? current - previous : current;
+}
+
+} // namespace openflow
@@ -0,0 +1,113 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include <gmp.h> // C++ aware, must come before the C headers including it
+
+#include "GTPFlowShadow.h"
+
+extern "C" {
+#include "gtpv1u.h"
+}
+
+namespace openflow {
+
+/**
+ * GTPTunnelStats turns the counters of the table 0 flows of the tunnels,
+ * dumped periodically from the switch, into the usage of every tunnel since
+ * the previous poll. The tunnels are kept in a flat array, indexed by TEID
+ * and UE IP address, so that a poll of a hundred thousand flows is a lookup
+ * and a subtraction per flow. It is only used from the event loop.
+ */
+class GTPTunnelStats {
+ public:
+  /*
+   * Track the counters of a tunnel. As on the switch, the downlink flow of
+   * the UE is the one of the last tunnel added for its IP address.
+   */
+  void add_tunnel(uint32_t ue_ip, uint32_t in_tei);
+
+  void delete_tunnel(uint32_t ue_ip, uint32_t in_tei);
+
+  size_t get_nb_tunnels() const;
+
+  /*
+   * Poll: start it, feed it the counters of the uplink and downlink flows
+   * dumped from the switch, then get the usage of every tunnel. A counter
+   * lower than at the previous poll belongs to a flow installed again, its
+   * whole value is counted. A flow missing from the dump, being installed
+   * again for instance, has no usage and keeps its previous counters.
+   */
+  void start_poll();
+
+  void add_flow_stats(const GTPFlow &flow, uint64_t packets, uint64_t bytes);
+
+  void finish_poll(time_t now, std::vector<struct gtp_tunnel_usage> &usages);
+
+  bool is_polling() const;
+
+ private:
+  static const uint32_t NO_SLOT = UINT32_MAX;
+  // Flows of a tunnel seen in the dump
+  static const uint8_t SEEN_UPLINK = 0x01;
+  static const uint8_t SEEN_DOWNLINK = 0x02;
+
+  struct Counters {
+    uint64_t ul_packets;
+    uint64_t ul_bytes;
+    uint64_t dl_packets;
+    uint64_t dl_bytes;
+  };
+
+  struct Tunnel {
+    uint32_t in_tei;
+    uint32_t ue_ip;
+    time_t last_active; // 0 until the first poll
+    Counters total;     // at the previous poll
+  };
+
+  uint32_t find_slot(
+    const std::unordered_map<uint32_t, uint32_t> &slots,
+    uint32_t key) const;
+
+  static uint64_t delta(uint64_t current, uint64_t previous);
+
+ private:
+  std::vector<Tunnel> tunnels_;
+  std::vector<bool> in_use_;
+  std::vector<uint32_t> free_slots_;
+  std::unordered_map<uint32_t, uint32_t> uplink_slots_;   // by TEID
+  std::unordered_map<uint32_t, uint32_t> downlink_slots_; // by UE IP
+  bool polling_ = false;
+  // Counters dumped during the poll, same slots as the tunnels
+  std::vector<Counters> polled_;
+  std::vector<uint8_t> seen_;
+};
+
+} // namespace openflow
@@ -0,0 +1,138 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+namespace openflow {
+
+/**
+ * MPSCRing is a bounded queue written by any number of threads and read by
+ * a single one, without locks: a producer claims a cell with a compare and
+ * swap on the head, then publishes it through the sequence number of the
+ * cell, which the consumer waits for. Items are copied in and out, so they
+ * should be small plain structs.
+ */
+template<typename T>
+class MPSCRing {
+ public:
+  /*
+   * @param capacity - rounded up to a power of two
+   */
+  explicit MPSCRing(size_t capacity): mask_(round_up(capacity) - 1)
+  {
+    cells_.reset(new Cell[mask_ + 1]);
+    for (size_t i = 0; i <= mask_; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+
+  /*
+   * Any thread. Returns false when the ring is full.
+   */
+  bool push(const T &item)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+
+    while (true) {
+      Cell &cell = cells_[head & mask_];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) sequence - (intptr_t) head;
+
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(
+              head, head + 1, std::memory_order_relaxed)) {
+          cell.item = item;
+          cell.sequence.store(head + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // Not read yet since the previous turn
+        return false;
+      } else {
+        head = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /*
+   * Consumer thread only. Returns false when there is nothing to read, or
+   * when the next item is still being written.
+   */
+  bool pop(T &item)
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    Cell &cell = cells_[tail & mask_];
+
+    if (cell.sequence.load(std::memory_order_acquire) != tail + 1) {
+      return false;
+    }
+    item = cell.item;
+    cell.sequence.store(tail + mask_ + 1, std::memory_order_release);
+    tail_.store(tail + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /*
+   * Whether the consumer would find nothing to read
+   */
+  bool empty() const
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+
+    return cells_[tail & mask_].sequence.load(std::memory_order_acquire) !=
+           tail + 1;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T item;
+  };
+
+  static size_t round_up(size_t capacity)
+  {
+    size_t size = 2;
+
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+ private:
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  // Apart, producers and consumer do not share a cache line
+  alignas(64) std::atomic<size_t> head_;
+  alignas(64) std::atomic<size_t> tail_;
+};
+
+} // namespace openflow
@@ -45,7 +45,11 @@ OpenflowController::OpenflowController(
       .use_hello_elements(true)         // bitmask version negotiation
       .keep_data_ownership(false)),
   running_(true),
-  messenger_(messenger)
+  messenger_(messenger),
+  latest_ofconn_(NULL),
+  external_events_(EXTERNAL_EVENT_RING_SIZE),
+  drain_scheduled_(false),
+  self_(this, [](void *) {})
 {
 }
 
@@ -90,6 +94,10 @@ void OpenflowController::message_callback(
     // Save OF connection for external events
     latest_ofconn_ = ofconn;
     dispatch_event(SwitchUpEvent(ofconn, *this, data, len));
+    // Including the ones injected while disconnected
+    drain_external_events();
+  } else if (type == OFPT_MULTIPART_REPLY_TYPE) {
+    dispatch_event(MultipartReplyEvent(ofconn, *this, data, len));
   } else if (type == OFPT_ERROR) {
     dispatch_event(
       ErrorEvent(ofconn, reinterpret_cast<struct ofp_error_msg *>(data)));
@@ -102,6 +110,10 @@ void OpenflowController::connection_callback(
 {
   if (type == OFConnection::EVENT_CLOSED || type == OFConnection::EVENT_DEAD) {
     OAILOG_ERROR(LOG_GTPV1U, "Openflow controller lost connection to switch\n");
+    OFConnection *closed = ofconn;
+
+    // Unless a new connection already replaced it
+    latest_ofconn_.compare_exchange_strong(closed, NULL);
     dispatch_event(SwitchDownEvent(ofconn));
   }
 }
@@ -113,21 +125,95 @@ void OpenflowController::dispatch_event(const ControllerEvent &ev)
       "Openflow controller needs to be running beforehandling an event\n");
     return;
   }
-  std::vector<Application *> listeners = event_listeners[ev.get_type()];
+  // Applications register before the controller starts, no copy needed
+  const std::vector<Application *> &listeners = event_listeners[ev.get_type()];
   for (auto it = listeners.begin(); it != listeners.end(); it++) {
     ((Application *) (*it))->event_callback(ev, *messenger_);
   }
 }
 
-void OpenflowController::inject_external_event(
-  std::shared_ptr<ExternalEvent> ev,
-  void *(*cb)(std::shared_ptr<void>) )
+bool OpenflowController::inject_external_event(const ExternalCommand &cmd)
+{
+  if (!external_events_.push(cmd)) {
+    return false;
+  }
+  schedule_drain();
+  return true;
+}
+
+static void *drain_external_events_callback(std::shared_ptr<void> data)
+{
+  static_cast<OpenflowController *>(data.get())->drain_external_events();
+  return NULL;
+}
+
+void OpenflowController::schedule_drain()
+{
+  OFConnection *ofconn = latest_ofconn_;
+
+  // Without switch, the commands wait for the switch up
+  if (ofconn == NULL || drain_scheduled_.exchange(true)) {
+    return;
+  }
+  ofconn->add_immediate_event(drain_external_events_callback, self_);
+}
+
+void OpenflowController::drain_external_events()
+{
+  std::unique_lock<std::mutex> consumer(drain_lock_, std::try_to_lock);
+  OFConnection *ofconn = latest_ofconn_;
+  ExternalCommand cmd;
+
+  if (!consumer.owns_lock()) {
+    // The loop draining checks for more once done
+    return;
+  }
+  for (uint32_t i = 0; i < EXTERNAL_EVENT_BATCH_SIZE; i++) {
+    if (!external_events_.pop(cmd)) {
+      break;
+    }
+    dispatch_external_command(cmd, ofconn);
+  }
+  consumer.unlock();
+  /*
+   * Only now, a drain scheduled meanwhile may have given up on the lock.
+   * Commands injected from now on schedule a new drain, the ones before are
+   * seen here. Let the switch messages in before the next batch.
+   */
+  drain_scheduled_ = false;
+  if (!external_events_.empty()) {
+    schedule_drain();
+  }
+}
+
+void OpenflowController::dispatch_external_command(
+  const ExternalCommand &cmd,
+  OFConnection *ofconn)
 {
-  if (latest_ofconn_ == NULL) {
-    throw std::runtime_error("Controller not connected to switch\n");
+  switch (cmd.type) {
+    case EVENT_ADD_GTP_TUNNEL: {
+      AddGTPTunnelEvent ev(
+        cmd.ue_ip, cmd.enb_ip, cmd.in_tei, cmd.out_tei, cmd.imsi);
+      ev.set_of_connection(ofconn);
+      dispatch_event(ev);
+    } break;
+    case EVENT_DELETE_GTP_TUNNEL: {
+      DeleteGTPTunnelEvent ev(cmd.ue_ip, cmd.in_tei);
+      ev.set_of_connection(ofconn);
+      dispatch_event(ev);
+    } break;
+    case EVENT_DISCARD_DATA_ON_GTP_TUNNEL:
+    case EVENT_FORWARD_DATA_ON_GTP_TUNNEL: {
+      HandleDataOnGTPTunnelEvent ev(cmd.ue_ip, cmd.in_tei, cmd.type);
+      ev.set_of_connection(ofconn);
+      dispatch_event(ev);
+    } break;
+    default: {
+      ExternalEvent ev(cmd.type);
+      ev.set_of_connection(ofconn);
+      dispatch_event(ev);
+    } break;
   }
-  ev->set_of_connection(latest_ofconn_);
-  latest_ofconn_->add_immediate_event(cb, ev);
 }
 
 } // namespace openflow
@@ -21,6 +21,9 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <list>
 
@@ -28,6 +31,7 @@
 
 #include "ControllerEvents.h"
 #include "OpenflowMessenger.h"
+#include "MPSCRing.h"
 
 namespace openflow {
 
@@ -46,12 +50,16 @@ class Application {
 enum OF_MESSAGE_TYPES {
   OFPT_ERROR = 1,
   OFPT_FEATURES_REPLY_TYPE = 6,
-  OFPT_PACKET_IN_TYPE = 10
+  OFPT_PACKET_IN_TYPE = 10,
+  OFPT_MULTIPART_REPLY_TYPE = 19
 };
 
 class OpenflowController : public fluid_base::OFServer {
  public:
   static const uint8_t OF_13_VERSION = 4;
+  // External events waiting for the event loop, and handled per turn
+  static const size_t EXTERNAL_EVENT_RING_SIZE = 65536;
+  static const uint32_t EXTERNAL_EVENT_BATCH_SIZE = 256;
 
  public:
   OpenflowController(
@@ -120,25 +128,41 @@ class OpenflowController : public fluid_base::OFServer {
   void dispatch_event(const ControllerEvent &ev);
 
   /**
-   * This function can be called by another thread to inject an external event
+   * This function can be called by any thread to inject an external event
    * into the main event loop. This can be used for non-standard openflow events
-   * like adding a gtp tunnel flow
-   * @param ev - shared_ptr to ExternalEvent subclass that is to be handled by
-   *             the event loop. This needs to be a pointer because it will be
-   *             handled indirectly by another thread.
-   * @param cb - A callback function to be called by the event loop when the
-   *             event is handled.
-   *
+   * like adding a gtp tunnel flow. The command is queued without locking, the
+   * event loop handles the queued commands in batches, in order. Commands
+   * injected before the switch connects are handled once it has.
+   * @param cmd - ExternalCommand the event is made from, copied
+   * @return false if too many commands are waiting
+   */
+  bool inject_external_event(const ExternalCommand &cmd);
+
+  /**
+   * Dispatch a batch of the injected commands, then schedule the next batch
+   * if more are waiting. Called from the event loop.
    */
-  void inject_external_event(
-    std::shared_ptr<ExternalEvent> ev,
-    void *(*cb)(std::shared_ptr<void>) );
+  void drain_external_events();
+
+ private:
+  void schedule_drain();
+
+  void dispatch_external_command(
+    const ExternalCommand &cmd,
+    fluid_base::OFConnection *ofconn);
 
  private:
   std::shared_ptr<OpenflowMessenger> messenger_;
-  std::unordered_map<uint32_t, std::vector<Application *>> event_listeners;
+  std::array<std::vector<Application *>, NB_CONTROLLER_EVENT_TYPES>
+    event_listeners;
   bool running_;
-  fluid_base::OFConnection *latest_ofconn_;
+  std::atomic<fluid_base::OFConnection *> latest_ofconn_;
+  MPSCRing<ExternalCommand> external_events_;
+  std::atomic<bool> drain_scheduled_;
+  // Only one event loop drains at a time
+  std::mutex drain_lock_;
+  // Argument of the drain callback, does not own the controller
+  std::shared_ptr<void> self_;
 };
 
 } // namespace openflow
@@ -56,4 +56,19 @@ void DefaultMessenger::send_of_msg(
   fluid_msg::OFMsg::free_buffer(buffer);
 }
 
+void DefaultMessenger::send_of_msgs(
+  const std::vector<fluid_msg::OFMsg *> &of_msgs,
+  fluid_base::OFConnection *ofconn) const
+{
+  std::vector<uint8_t> batch;
+  for (auto of_msg : of_msgs) {
+    uint8_t *buffer = of_msg->pack();
+    batch.insert(batch.end(), buffer, buffer + of_msg->length());
+    fluid_msg::OFMsg::free_buffer(buffer);
+  }
+  if (!batch.empty()) {
+    ofconn->send(batch.data(), batch.size());
+  }
+}
+
 } // namespace openflow
@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <fluid/of10msg.hh>
 #include <fluid/of13msg.hh>
 #include <fluid/OFServer.hh>
@@ -58,6 +60,21 @@ class OpenflowMessenger {
     fluid_base::OFConnection *ofconn) const
   {
   }
+
+  /**
+   * Sends a batch of messages to OVS, in order
+   *
+   * @param of_msgs - the messages to send
+   * @param ofconn - the connection to send the messages to
+   */
+  virtual void send_of_msgs(
+    const std::vector<fluid_msg::OFMsg *> &of_msgs,
+    fluid_base::OFConnection *ofconn) const
+  {
+    for (auto of_msg : of_msgs) {
+      send_of_msg(*of_msg, ofconn);
+    }
+  }
 };
 
 /**
@@ -72,6 +89,13 @@ class DefaultMessenger : public OpenflowMessenger {
 
   void send_of_msg(fluid_msg::OFMsg &of_msg, fluid_base::OFConnection *ofconn)
     const;
+
+  /**
+   * Packs the batch in a single buffer, written to the connection at once
+   */
+  void send_of_msgs(
+    const std::vector<fluid_msg::OFMsg *> &of_msgs,
+    fluid_base::OFConnection *ofconn) const;
 };
 
 } // namespace openflow
@@ -20,6 +20,7 @@
  */
 
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
@@ -35,12 +36,13 @@ void convert_proto_msg_to_itti_s6a_auth_info_ans(
   AuthenticationInformationAnswer msg,
   s6a_auth_info_ans_t *itti_msg)
 {
-  if (msg.eutran_vectors_size() > MAX_EPS_AUTH_VECTORS) {
-    std::cout << "[ERROR] Number of eutran auth vectors received is:"
-                 << msg.eutran_vectors_size() << std::endl;
-    return;
+  if (msg.eutran_vectors_size() > MAX_EPS_AUTH_VECTORS_PER_AIR) {
+    std::cout << "[WARNING] Number of eutran auth vectors received is:"
+                 << msg.eutran_vectors_size() << ", using the first "
+                 << MAX_EPS_AUTH_VECTORS_PER_AIR << std::endl;
   }
-  itti_msg->auth_info.nb_of_vectors = msg.eutran_vectors_size();
+  itti_msg->auth_info.nb_of_vectors =
+    std::min(msg.eutran_vectors_size(), MAX_EPS_AUTH_VECTORS_PER_AIR);
   uint8_t idx = 0;
   while (idx < itti_msg->auth_info.nb_of_vectors) {
     auto eutran_vector = msg.eutran_vectors(idx);
@@ -66,6 +66,7 @@ bool s6a_purge_ue(const char *imsi)
 static void _s6a_handle_authentication_info_ans(
   const std::string &imsi,
   uint8_t imsi_length,
+  bool prefetch,
   const grpc::Status &status,
   feg::AuthenticationInformationAnswer response)
 {
@@ -76,6 +77,7 @@ static void _s6a_handle_authentication_info_ans(
   itti_msg = &message_p->ittiMsg.s6a_auth_info_ans;
   strncpy(itti_msg->imsi, imsi.c_str(), imsi_length);
   itti_msg->imsi_length = imsi_length;
+  itti_msg->prefetch = prefetch;
 
   if (status.ok()) {
     if (response.error_code() < feg::ErrorCode::COMMAND_UNSUPORTED) {
@@ -113,9 +115,12 @@ bool s6a_authentication_info_req(const s6a_auth_info_req_t *const air_p)
 
   magma::S6aClient::authentication_info_req(
     air_p,
-    [imsiStr = std::string(air_p->imsi), imsi_len](
+    [imsiStr = std::string(air_p->imsi),
+     imsi_len,
+     prefetch = (bool) air_p->prefetch](
       grpc::Status status, feg::AuthenticationInformationAnswer response) {
-      _s6a_handle_authentication_info_ans(imsiStr, imsi_len, status, response);
+      _s6a_handle_authentication_info_ans(
+        imsiStr, imsi_len, prefetch, status, response);
     });
   return true;
 }
@@ -19,13 +19,21 @@
  *      contact@openairinterface.org
  */
 
+#define _GNU_SOURCE
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
 #include <arpa/inet.h>
 #include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/gtp.h>
 
 #include <libgtpnl/gtp.h>
 #include <libgtpnl/gtpnl.h>
@@ -37,15 +45,328 @@
 #include "gtpv1u.h"
 #include "gtpv1u_sgw_defs.h"
 
+#ifndef NETLINK_CAP_ACK
+#define NETLINK_CAP_ACK 10
+#endif
+
 extern struct gtp_tunnel_ops gtp_tunnel_ops;
 
+#define GTP_DEVNAME "gtp0"
+
+// A GTP_CMD_NEWPDP message with its 6 attributes fits easily
+#define GTP_NL_MSG_MAX_SIZE 128
+#define GTP_NL_BATCH_BUFFER_SIZE (64 * 1024)
+// Changes waiting for their acknowledgement, must be a power of two
+#define GTP_NL_MAX_PENDING 4096
+#define GTP_NL_ACKS_PER_READ 64
+#define GTP_NL_ACK_SIZE 64
+#define GTP_NL_RCVBUF_SIZE (4 * 1024 * 1024)
+#define GTP_NL_RECV_TIMEOUT_SEC 2
+
+typedef struct gtp_nl_change_s {
+  bool add;
+  // The caller waits for the acknowledgement and handles the error itself
+  bool wait;
+  int error;
+  struct in_addr ue;
+  struct in_addr enb;
+  uint32_t i_tei;
+  uint32_t o_tei;
+} gtp_nl_change_t;
+
 static struct {
   int genl_id;
   struct mnl_socket *nl;
   bool is_enabled;
-} gtp_nl;
+  // Looked up once, the device lives as long as the backend
+  unsigned int ifindex;
+  // Socket of the batched changes, libgtpnl is only used to set up the device
+  int fd;
+  gtp_tunnel_failure_cb_t failure_cb;
+  /* Sequence numbers of the changes: [acked_seq, sent_seq) are waiting for
+   * their acknowledgement, [sent_seq, next_seq) are queued in the buffer */
+  uint32_t acked_seq;
+  uint32_t sent_seq;
+  uint32_t next_seq;
+  gtp_nl_change_t pending[GTP_NL_MAX_PENDING];
+  uint8_t buffer[GTP_NL_BATCH_BUFFER_SIZE] __attribute__((aligned(4)));
+  size_t length;
+  uint8_t acks[GTP_NL_ACKS_PER_READ][GTP_NL_ACK_SIZE] __attribute__((
+    aligned(4)));
+} gtp_nl = {.fd = -1};
+
+//------------------------------------------------------------------------------
+static void gtp_nl_attr_put_u32(
+  struct nlmsghdr *nlh,
+  uint16_t type,
+  uint32_t value)
+{
+  struct nlattr *attr =
+    (struct nlattr *) ((uint8_t *) nlh + NLMSG_ALIGN(nlh->nlmsg_len));
 
-#define GTP_DEVNAME "gtp0"
+  attr->nla_type = type;
+  attr->nla_len = NLA_HDRLEN + sizeof(value);
+  memcpy((uint8_t *) attr + NLA_HDRLEN, &value, sizeof(value));
+  nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + NLA_ALIGN(attr->nla_len);
+}
+
+//------------------------------------------------------------------------------
+static void gtp_nl_report_failure(gtp_nl_change_t *change, int error)
+{
+  char ue[INET_ADDRSTRLEN];
+
+  change->error = error;
+
+  inet_ntop(AF_INET, &change->ue, ue, sizeof(ue));
+  OAILOG_ERROR(
+    LOG_GTPV1U,
+    "Failed to %s GTP tunnel of UE %s, i_tei %u o_tei %u: %s\n",
+    change->add ? "add" : "delete",
+    ue,
+    change->i_tei,
+    change->o_tei,
+    strerror(error));
+  if (gtp_nl.failure_cb && !change->wait) {
+    gtp_nl.failure_cb(
+      change->add, change->ue, change->i_tei, change->o_tei, error);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int gtp_nl_send(void)
+{
+  int nb_failed = 0;
+  ssize_t rc = 0;
+
+  if (!gtp_nl.length) {
+    return 0;
+  }
+  // The kernel handles every message of the buffer and acknowledges each one
+  do {
+    rc = send(gtp_nl.fd, gtp_nl.buffer, gtp_nl.length, 0);
+  } while ((rc < 0) && (errno == EINTR));
+  if (rc < 0) {
+    int error = errno;
+
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Failed to send %u GTP tunnel changes: %s\n",
+      gtp_nl.next_seq - gtp_nl.sent_seq,
+      strerror(error));
+    for (uint32_t seq = gtp_nl.sent_seq; seq != gtp_nl.next_seq; seq++) {
+      gtp_nl_report_failure(
+        &gtp_nl.pending[seq & (GTP_NL_MAX_PENDING - 1)], error);
+      nb_failed++;
+    }
+    // Never seen by the kernel, the sequence numbers can be used again
+    gtp_nl.next_seq = gtp_nl.sent_seq;
+  } else {
+    gtp_nl.sent_seq = gtp_nl.next_seq;
+  }
+  gtp_nl.length = 0;
+  return nb_failed;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Read the acknowledgements until the socket is empty, waiting for the first
+ * one if wait is set and changes are in flight. Also drains the late
+ * acknowledgements of the changes given up on: left in the socket, they would
+ * keep it readable.
+ */
+static int gtp_nl_read_acks(bool wait)
+{
+  struct mmsghdr msgs[GTP_NL_ACKS_PER_READ];
+  struct iovec iovs[GTP_NL_ACKS_PER_READ];
+  int nb_failed = 0;
+
+  while (true) {
+    int nb_msgs = 0;
+
+    if (gtp_nl.acked_seq == gtp_nl.sent_seq) {
+      // Nothing to wait for
+      wait = false;
+    }
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < GTP_NL_ACKS_PER_READ; i++) {
+      iovs[i].iov_base = gtp_nl.acks[i];
+      iovs[i].iov_len = GTP_NL_ACK_SIZE;
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    nb_msgs = recvmmsg(
+      gtp_nl.fd,
+      msgs,
+      GTP_NL_ACKS_PER_READ,
+      wait ? MSG_WAITFORONE : MSG_DONTWAIT,
+      NULL);
+    if (nb_msgs < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == ENOBUFS) {
+        // Acknowledgements were dropped, the changes in flight are unknown
+        OAILOG_ERROR(
+          LOG_GTPV1U,
+          "Lost the acknowledgements of up to %u GTP tunnel changes\n",
+          gtp_nl.sent_seq - gtp_nl.acked_seq);
+        for (uint32_t seq = gtp_nl.acked_seq; seq != gtp_nl.sent_seq; seq++) {
+          gtp_nl_change_t *change =
+            &gtp_nl.pending[seq & (GTP_NL_MAX_PENDING - 1)];
+
+          // A waiting addition is not reported as set up
+          if (change->wait) {
+            change->error = ENOBUFS;
+          }
+        }
+        gtp_nl.acked_seq = gtp_nl.sent_seq;
+        // What is still queued in the socket has to be drained
+        continue;
+      }
+      // EAGAIN: drained, or timed out waiting
+      break;
+    }
+    for (int i = 0; i < nb_msgs; i++) {
+      struct nlmsghdr *nlh = (struct nlmsghdr *) gtp_nl.acks[i];
+      struct nlmsgerr *err = NLMSG_DATA(nlh);
+      uint32_t seq = nlh->nlmsg_seq;
+
+      if (
+        (msgs[i].msg_len < NLMSG_LENGTH(sizeof(struct nlmsgerr))) ||
+        (nlh->nlmsg_type != NLMSG_ERROR)) {
+        continue;
+      }
+      if ((seq - gtp_nl.acked_seq) >= (gtp_nl.sent_seq - gtp_nl.acked_seq)) {
+        // Stale: late acknowledgement of a change given up on
+        continue;
+      }
+      if (err->error) {
+        gtp_nl_report_failure(
+          &gtp_nl.pending[seq & (GTP_NL_MAX_PENDING - 1)], -err->error);
+        nb_failed++;
+      }
+      // Acknowledged in order, anything before was lost
+      gtp_nl.acked_seq = seq + 1;
+    }
+    // Only the first read waits, the rest is drained
+    wait = false;
+  }
+  return nb_failed;
+}
+
+//------------------------------------------------------------------------------
+static int gtp_nl_queue(const gtp_nl_change_t *change)
+{
+  struct nlmsghdr *nlh = NULL;
+  struct genlmsghdr *genl = NULL;
+
+  if (gtp_nl.length + GTP_NL_MSG_MAX_SIZE > sizeof(gtp_nl.buffer)) {
+    // The kernel applies the changes in send(), their acks are already there
+    gtp_nl_send();
+    gtp_nl_read_acks(false);
+  }
+  // Too many changes in flight: wait for the kernel to catch up
+  while ((gtp_nl.next_seq - gtp_nl.acked_seq) >= GTP_NL_MAX_PENDING) {
+    uint32_t acked_seq = gtp_nl.acked_seq;
+
+    gtp_nl_send();
+    gtp_nl_read_acks(true);
+    if (gtp_nl.acked_seq == acked_seq) {
+      OAILOG_ERROR(
+        LOG_GTPV1U,
+        "No acknowledgement of %u GTP tunnel changes, giving up on them\n",
+        gtp_nl.sent_seq - gtp_nl.acked_seq);
+      gtp_nl.acked_seq = gtp_nl.sent_seq;
+    }
+  }
+
+  nlh = (struct nlmsghdr *) (gtp_nl.buffer + gtp_nl.length);
+  nlh->nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+  nlh->nlmsg_type = gtp_nl.genl_id;
+  nlh->nlmsg_flags =
+    NLM_F_REQUEST | NLM_F_ACK | (change->add ? NLM_F_EXCL : 0);
+  nlh->nlmsg_seq = gtp_nl.next_seq;
+  nlh->nlmsg_pid = 0;
+  genl = NLMSG_DATA(nlh);
+  genl->cmd = change->add ? GTP_CMD_NEWPDP : GTP_CMD_DELPDP;
+  genl->version = 0;
+  genl->reserved = 0;
+  gtp_nl_attr_put_u32(nlh, GTPA_VERSION, GTP_V1);
+  gtp_nl_attr_put_u32(nlh, GTPA_LINK, gtp_nl.ifindex);
+  if (change->add) {
+    gtp_nl_attr_put_u32(nlh, GTPA_PEER_ADDRESS, change->enb.s_addr);
+    gtp_nl_attr_put_u32(nlh, GTPA_MS_ADDRESS, change->ue.s_addr);
+  }
+  gtp_nl_attr_put_u32(nlh, GTPA_I_TEI, change->i_tei);
+  gtp_nl_attr_put_u32(nlh, GTPA_O_TEI, change->o_tei);
+  gtp_nl.length += NLMSG_ALIGN(nlh->nlmsg_len);
+
+  gtp_nl.pending[gtp_nl.next_seq & (GTP_NL_MAX_PENDING - 1)] = *change;
+  gtp_nl.next_seq++;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Send the queued changes and wait for the acknowledgement of the last one,
+ * the changes queued before it are acknowledged on the way. Returns its error.
+ */
+static int gtp_nl_wait_last(void)
+{
+  const uint32_t seq = gtp_nl.next_seq - 1;
+  gtp_nl_change_t *change = &gtp_nl.pending[seq & (GTP_NL_MAX_PENDING - 1)];
+
+  gtp_nl_send();
+  // Until acked_seq moves past seq, unless the send failed
+  while ((seq - gtp_nl.acked_seq) < (gtp_nl.sent_seq - gtp_nl.acked_seq)) {
+    uint32_t acked_seq = gtp_nl.acked_seq;
+
+    gtp_nl_read_acks(true);
+    if (gtp_nl.acked_seq == acked_seq) {
+      gtp_nl_report_failure(change, ETIMEDOUT);
+      break;
+    }
+  }
+  return change->error;
+}
+
+//------------------------------------------------------------------------------
+static int gtp_nl_open(void)
+{
+  struct sockaddr_nl addr = {.nl_family = AF_NETLINK};
+  struct timeval timeout = {.tv_sec = GTP_NL_RECV_TIMEOUT_SEC};
+  int rcvbuf = GTP_NL_RCVBUF_SIZE;
+  int one = 1;
+
+  gtp_nl.fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+  if (gtp_nl.fd < 0) {
+    OAILOG_ERROR(
+      LOG_GTPV1U, "Failed to open genetlink socket: %s\n", strerror(errno));
+    return RETURNerror;
+  }
+  if (bind(gtp_nl.fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    OAILOG_ERROR(
+      LOG_GTPV1U, "Failed to bind genetlink socket: %s\n", strerror(errno));
+    close(gtp_nl.fd);
+    gtp_nl.fd = -1;
+    return RETURNerror;
+  }
+  // Acknowledgements do not need to echo the whole request
+  setsockopt(gtp_nl.fd, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one));
+  // Room for the acknowledgements of all the changes in flight
+  if (
+    setsockopt(
+      gtp_nl.fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0) {
+    setsockopt(gtp_nl.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  }
+  setsockopt(gtp_nl.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  gtp_nl.next_seq = (uint32_t) time(NULL);
+  gtp_nl.sent_seq = gtp_nl.next_seq;
+  gtp_nl.acked_seq = gtp_nl.next_seq;
+  gtp_nl.length = 0;
+  return RETURNok;
+}
 
 int libgtpnl_init(
   struct in_addr *ue_net,
@@ -89,7 +410,12 @@ int libgtpnl_init(
       LOG_GTPV1U, "Cannot create GTP tunnel device: %s\n", strerror(errno));
     return RETURNerror;
   }
-  gtp_nl.is_enabled = true;
+  gtp_nl.ifindex = if_nametoindex(GTP_DEVNAME);
+  if (!gtp_nl.ifindex) {
+    OAILOG_ERROR(
+      LOG_GTPV1U, "Cannot find GTP tunnel device: %s\n", strerror(errno));
+    return RETURNerror;
+  }
 
   gtp_nl.nl = genl_socket_open();
   if (gtp_nl.nl == NULL) {
@@ -101,6 +427,10 @@ int libgtpnl_init(
     OAILOG_ERROR(LOG_GTPV1U, "Cannot lookup GTP genetlink ID\n");
     return RETURNerror;
   }
+  if (gtp_nl_open() != RETURNok) {
+    return RETURNerror;
+  }
+  gtp_nl.is_enabled = true;
   OAILOG_NOTICE(
     LOG_GTPV1U, "Using the GTP kernel mode (genl ID is %d)\n", gtp_nl.genl_id);
 
@@ -157,6 +487,21 @@ int libgtpnl_uninit(void)
 {
   if (!gtp_nl.is_enabled) return -1;
 
+  if (gtp_nl.fd >= 0) {
+    gtp_nl_send();
+    while (gtp_nl.acked_seq != gtp_nl.sent_seq) {
+      uint32_t acked_seq = gtp_nl.acked_seq;
+
+      gtp_nl_read_acks(true);
+      if (gtp_nl.acked_seq == acked_seq) {
+        break;
+      }
+    }
+    close(gtp_nl.fd);
+    gtp_nl.fd = -1;
+  }
+  gtp_nl.ifindex = 0;
+  gtp_nl.is_enabled = false;
   return gtp_dev_destroy(GTP_DEVNAME);
 }
 
@@ -168,58 +513,75 @@ int libgtpnl_reset(void)
   return rv;
 }
 
+/*
+ * Deletions are queued, sent together when the buffer is full or on commit,
+ * and acknowledged asynchronously: the return value only tells whether the
+ * deletion was queued, failures go to the failure callback.
+ * Additions are answered to the MME as soon as add_tunnel returns, they are
+ * sent with the deletions queued so far and wait for their acknowledgement.
+ */
 int libgtpnl_add_tunnel(
   struct in_addr ue,
   struct in_addr enb,
   uint32_t i_tei,
   uint32_t o_tei,
-  Imsi_t imsi)
+  __attribute__((unused)) Imsi_t imsi)
 {
-  struct gtp_tunnel *t;
-  int ret;
+  gtp_nl_change_t change = {
+    .add = true,
+    .wait = true,
+    .ue = ue,
+    .enb = enb,
+    .i_tei = i_tei,
+    .o_tei = o_tei,
+  };
 
   if (!gtp_nl.is_enabled) return RETURNok;
 
-  t = gtp_tunnel_alloc();
-  if (t == NULL) return RETURNerror;
+  if (gtp_nl_queue(&change) != RETURNok) {
+    return RETURNerror;
+  }
+  return gtp_nl_wait_last() ? RETURNerror : RETURNok;
+}
 
-  gtp_tunnel_set_ifidx(t, if_nametoindex(GTP_DEVNAME));
-  gtp_tunnel_set_version(t, 1);
-  gtp_tunnel_set_ms_ip4(t, &ue);
-  gtp_tunnel_set_sgsn_ip4(t, &enb);
-  gtp_tunnel_set_i_tei(t, i_tei);
-  gtp_tunnel_set_o_tei(t, o_tei);
+int libgtpnl_del_tunnel(struct in_addr ue, uint32_t i_tei, uint32_t o_tei)
+{
+  // looking at kernel/drivers/net/gtp.c: the UE and eNB are not needed, the
+  // UE is only kept for the failure reports
+  gtp_nl_change_t change = {
+    .add = false,
+    .ue = ue,
+    .i_tei = i_tei,
+    .o_tei = o_tei,
+  };
 
-  ret = gtp_add_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
-  gtp_tunnel_free(t);
+  if (!gtp_nl.is_enabled) return RETURNok;
 
-  return ret;
+  return gtp_nl_queue(&change);
 }
 
-int libgtpnl_del_tunnel(
-  __attribute__((unused)) struct in_addr ue,
-  uint32_t i_tei,
-  uint32_t o_tei)
+int libgtpnl_commit(void)
 {
-  struct gtp_tunnel *t;
-  int ret;
+  if (!gtp_nl.is_enabled) return 0;
 
-  if (!gtp_nl.is_enabled) return RETURNok;
+  return gtp_nl_send();
+}
 
-  t = gtp_tunnel_alloc();
-  if (t == NULL) return RETURNerror;
+int libgtpnl_process_acks(void)
+{
+  if (!gtp_nl.is_enabled) return 0;
 
-  gtp_tunnel_set_ifidx(t, if_nametoindex(GTP_DEVNAME));
-  gtp_tunnel_set_version(t, 1);
-  // looking at kernel/drivers/net/gtp.c: not needed gtp_tunnel_set_ms_ip4(t, &ue);
-  // looking at kernel/drivers/net/gtp.c: not needed gtp_tunnel_set_sgsn_ip4(t, &enb);
-  gtp_tunnel_set_i_tei(t, i_tei);
-  gtp_tunnel_set_o_tei(t, o_tei);
+  return gtp_nl_read_acks(false);
+}
 
-  ret = gtp_del_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
-  gtp_tunnel_free(t);
+int libgtpnl_get_ack_fd(void)
+{
+  return gtp_nl.fd;
+}
 
-  return ret;
+void libgtpnl_set_failure_cb(gtp_tunnel_failure_cb_t cb)
+{
+  gtp_nl.failure_cb = cb;
 }
 
 static const struct gtp_tunnel_ops libgtpnl_ops = {
@@ -228,6 +590,10 @@ static const struct gtp_tunnel_ops libgtpnl_ops = {
   .reset = libgtpnl_reset,
   .add_tunnel = libgtpnl_add_tunnel,
   .del_tunnel = libgtpnl_del_tunnel,
+  .commit = libgtpnl_commit,
+  .process_acks = libgtpnl_process_acks,
+  .get_ack_fd = libgtpnl_get_ack_fd,
+  .set_failure_cb = libgtpnl_set_failure_cb,
 };
 
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init_libgtpnl(void)
@@ -89,6 +89,11 @@ int openflow_forward_data_on_tunnel(struct in_addr ue, uint32_t i_tei)
   return openflow_controller_forward_data_on_tunnel(ue, i_tei);
 }
 
+int openflow_poll_usage(gtp_tunnel_usage_cb_t cb)
+{
+  return openflow_controller_poll_tunnel_usage(cb);
+}
+
 static const struct gtp_tunnel_ops openflow_ops = {
   .init = openflow_init,
   .uninit = openflow_uninit,
@@ -97,6 +102,7 @@ static const struct gtp_tunnel_ops openflow_ops = {
   .del_tunnel = openflow_del_tunnel,
   .discard_data_on_tunnel = openflow_discard_data_on_tunnel,
   .forward_data_on_tunnel = openflow_forward_data_on_tunnel,
+  .poll_usage = openflow_poll_usage,
 };
 
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init_openflow(void)
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "gtpv1u.h"
+#include "gtpv1u_sgw_defs.h"
+#include "gtpu_userspace.h"
+
+// Same name as the kernel device: the PGW rules match on it
+#define GTP_USERSPACE_DEVNAME "gtp0"
+#define GTP_USERSPACE_MAX_TUNNELS (64 * 1024)
+#define GTP_USERSPACE_MAX_WORKERS 4
+
+int userspace_init(
+  struct in_addr *ue_net,
+  uint32_t mask,
+  int mtu,
+  int *fd0,
+  int *fd1u)
+{
+  gtpu_us_config_t config = {
+    .ue_net = *ue_net,
+    .ue_mask = mask,
+    .mtu = mtu,
+    .s1u_addr = {.s_addr = INADDR_ANY},
+    .s1u_port = GTPV1U_UDP_PORT,
+    .nb_workers = GTP_USERSPACE_MAX_WORKERS,
+    .first_cpu = 0,
+  };
+  long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  strncpy(config.tun_name, GTP_USERSPACE_DEVNAME, IFNAMSIZ - 1);
+  if ((nb_cpus > 0) && (nb_cpus < config.nb_workers)) {
+    config.nb_workers = nb_cpus;
+  }
+  if (
+    (gtpu_us_init(GTP_USERSPACE_MAX_TUNNELS) != RETURNok) ||
+    (gtpu_us_start(&config) != RETURNok)) {
+    OAILOG_ERROR(LOG_GTPV1U, "Cannot start the userspace GTP-U forwarder\n");
+    return RETURNerror;
+  }
+  // The workers own the S1-U sockets
+  *fd0 = -1;
+  *fd1u = -1;
+  return RETURNok;
+}
+
+int userspace_uninit(void)
+{
+  gtpu_us_exit();
+  return RETURNok;
+}
+
+int userspace_reset(void)
+{
+  return RETURNok;
+}
+
+int userspace_add_tunnel(
+  struct in_addr ue,
+  struct in_addr enb,
+  uint32_t i_tei,
+  uint32_t o_tei,
+  __attribute__((unused)) Imsi_t imsi)
+{
+  return gtpu_us_add_tunnel(ue, enb, i_tei, o_tei);
+}
+
+int userspace_del_tunnel(
+  __attribute__((unused)) struct in_addr ue,
+  uint32_t i_tei,
+  __attribute__((unused)) uint32_t o_tei)
+{
+  return gtpu_us_del_tunnel(i_tei);
+}
+
+int userspace_discard_data_on_tunnel(
+  __attribute__((unused)) struct in_addr ue,
+  uint32_t i_tei)
+{
+  return gtpu_us_set_forwarding(i_tei, false);
+}
+
+int userspace_forward_data_on_tunnel(
+  __attribute__((unused)) struct in_addr ue,
+  uint32_t i_tei)
+{
+  return gtpu_us_set_forwarding(i_tei, true);
+}
+
+static const struct gtp_tunnel_ops userspace_ops = {
+  .init = userspace_init,
+  .uninit = userspace_uninit,
+  .reset = userspace_reset,
+  .add_tunnel = userspace_add_tunnel,
+  .del_tunnel = userspace_del_tunnel,
+  .discard_data_on_tunnel = userspace_discard_data_on_tunnel,
+  .forward_data_on_tunnel = userspace_forward_data_on_tunnel,
+};
+
+const struct gtp_tunnel_ops *gtp_tunnel_ops_init_userspace(void)
+{
+  return &userspace_ops;
+}
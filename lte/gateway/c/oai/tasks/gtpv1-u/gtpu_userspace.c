@@ -0,0 +1,972 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtpu_userspace.c
+  \brief In-process GTP-U forwarder
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/if_tun.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "dynamic_memory_check.h"
+#include "gtpu_userspace.h"
+
+#define GTPU_US_FLAGS_V1_PT 0x30
+#define GTPU_US_FLAGS_E_S_PN 0x07
+#define GTPU_US_FLAG_S 0x02
+#define GTPU_US_IE_RECOVERY 14
+#define GTPU_US_SOCKET_BUFFER_SIZE (4 * 1024 * 1024)
+#define GTPU_US_HASH_MULTIPLIER 0x9e3779b1
+
+typedef struct gtpu_us_tunnel_s {
+  uint32_t i_tei;
+  uint32_t o_tei;
+  struct in_addr ue;
+  struct in_addr enb;
+  bool in_use;
+  bool forward;
+  uint32_t next_of_ue; // other tunnel of the UE, pool index + 1
+  uint64_t ul_packets;
+  uint64_t ul_bytes;
+  uint64_t dl_packets;
+  uint64_t dl_bytes;
+} gtpu_us_tunnel_t;
+
+typedef struct gtpu_us_worker_s {
+  int id;
+  pthread_t thread;
+  bool started;
+  int tun_fd;
+  int udp_fd;
+  int epoll_fd;
+  gtpu_us_stats_t stats;
+  // Uplink: GTP-U messages received on S1-U
+  uint8_t (*ul_buffers)[GTPU_US_PKT_BUFFER_SIZE];
+  struct mmsghdr ul_msgs[GTPU_US_BATCH_SIZE];
+  struct iovec ul_iovs[GTPU_US_BATCH_SIZE];
+  struct sockaddr_in ul_peers[GTPU_US_BATCH_SIZE];
+  gtpu_us_pkt_t ul_pkts[GTPU_US_BATCH_SIZE];
+  // Downlink: IP packets read from the TUN device
+  uint8_t (*dl_buffers)[GTPU_US_PKT_BUFFER_SIZE];
+  struct mmsghdr dl_msgs[GTPU_US_BATCH_SIZE];
+  struct iovec dl_iovs[GTPU_US_BATCH_SIZE][2];
+  struct sockaddr_in dl_peers[GTPU_US_BATCH_SIZE];
+  gtpu_us_pkt_t dl_pkts[GTPU_US_BATCH_SIZE];
+} gtpu_us_worker_t;
+
+static struct {
+  pthread_rwlock_t lock;
+  gtpu_us_tunnel_t *tunnels;
+  uint32_t *free_tunnels;
+  uint32_t nb_free;
+  uint32_t max_tunnels;
+  // Pool index + 1 of the tunnels, 0 for an empty slot
+  uint32_t *teid_slots;
+  uint32_t *ue_slots;
+  uint32_t slot_mask;
+  uint32_t slot_shift;
+
+  gtpu_us_config_t config;
+  int stop_fd;
+  int nb_workers;
+  gtpu_us_worker_t *workers;
+} gtpu_us = {.lock = PTHREAD_RWLOCK_INITIALIZER, .stop_fd = -1};
+
+//------------------------------------------------------------------------------
+static inline uint32_t gtpu_us_hash(uint32_t key)
+{
+  return (key * GTPU_US_HASH_MULTIPLIER) >> gtpu_us.slot_shift;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t gtpu_us_slot_key(uint32_t index, bool by_teid)
+{
+  const gtpu_us_tunnel_t *tunnel = &gtpu_us.tunnels[index - 1];
+
+  return by_teid ? tunnel->i_tei : tunnel->ue.s_addr;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t gtpu_us_slot_find(
+  const uint32_t *slots,
+  uint32_t key,
+  bool by_teid)
+{
+  uint32_t slot = gtpu_us_hash(key);
+
+  for (;; slot = (slot + 1) & gtpu_us.slot_mask) {
+    if (!slots[slot] || (gtpu_us_slot_key(slots[slot], by_teid) == key)) {
+      return slot;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_us_slot_remove(uint32_t *slots, uint32_t slot, bool by_teid)
+{
+  uint32_t next = slot;
+
+  // Backward shift: no tombstone, the probe sequences stay short
+  slots[slot] = 0;
+  for (;;) {
+    uint32_t home = 0;
+
+    next = (next + 1) & gtpu_us.slot_mask;
+    if (!slots[next]) {
+      return;
+    }
+    home = gtpu_us_hash(gtpu_us_slot_key(slots[next], by_teid));
+    // Move the entry back if the hole is between its home slot and itself
+    if (((next - home) & gtpu_us.slot_mask) >=
+        ((next - slot) & gtpu_us.slot_mask)) {
+      slots[slot] = slots[next];
+      slots[next] = 0;
+      slot = next;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_init(uint32_t max_tunnels)
+{
+  uint32_t nb_slots = 16;
+  uint32_t shift = 28;
+
+  gtpu_us_exit();
+  // At most half full
+  while (nb_slots < 2 * max_tunnels) {
+    nb_slots <<= 1;
+    shift--;
+  }
+  gtpu_us.tunnels = calloc(max_tunnels, sizeof(gtpu_us_tunnel_t));
+  gtpu_us.free_tunnels = calloc(max_tunnels, sizeof(uint32_t));
+  gtpu_us.teid_slots = calloc(nb_slots, sizeof(uint32_t));
+  gtpu_us.ue_slots = calloc(nb_slots, sizeof(uint32_t));
+  if (
+    !gtpu_us.tunnels || !gtpu_us.free_tunnels || !gtpu_us.teid_slots ||
+    !gtpu_us.ue_slots) {
+    OAILOG_ERROR(LOG_GTPV1U, "Failed to allocate %u tunnels\n", max_tunnels);
+    gtpu_us_exit();
+    return RETURNerror;
+  }
+  pthread_rwlock_wrlock(&gtpu_us.lock);
+  gtpu_us.max_tunnels = max_tunnels;
+  gtpu_us.slot_mask = nb_slots - 1;
+  gtpu_us.slot_shift = shift;
+  for (uint32_t i = 0; i < max_tunnels; i++) {
+    gtpu_us.free_tunnels[i] = max_tunnels - i;
+  }
+  gtpu_us.nb_free = max_tunnels;
+  pthread_rwlock_unlock(&gtpu_us.lock);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void gtpu_us_exit(void)
+{
+  gtpu_us_stop();
+  pthread_rwlock_wrlock(&gtpu_us.lock);
+  free_wrapper((void **) &gtpu_us.tunnels);
+  free_wrapper((void **) &gtpu_us.free_tunnels);
+  free_wrapper((void **) &gtpu_us.teid_slots);
+  free_wrapper((void **) &gtpu_us.ue_slots);
+  gtpu_us.nb_free = 0;
+  gtpu_us.max_tunnels = 0;
+  pthread_rwlock_unlock(&gtpu_us.lock);
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_add_tunnel(
+  struct in_addr ue,
+  struct in_addr enb,
+  uint32_t i_tei,
+  uint32_t o_tei)
+{
+  gtpu_us_tunnel_t *tunnel = NULL;
+  uint32_t teid_slot = 0;
+  uint32_t ue_slot = 0;
+  uint32_t index = 0;
+
+  pthread_rwlock_wrlock(&gtpu_us.lock);
+  if (!gtpu_us.teid_slots) {
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    return RETURNerror;
+  }
+  teid_slot = gtpu_us_slot_find(gtpu_us.teid_slots, i_tei, true);
+  if ((index = gtpu_us.teid_slots[teid_slot])) {
+    // Same TEID: the tunnel moves, to another eNB after a handover
+    tunnel = &gtpu_us.tunnels[index - 1];
+    if (tunnel->ue.s_addr == ue.s_addr) {
+      tunnel->enb = enb;
+      tunnel->o_tei = o_tei;
+      tunnel->forward = true;
+      pthread_rwlock_unlock(&gtpu_us.lock);
+      return RETURNok;
+    }
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    OAILOG_ERROR(
+      LOG_GTPV1U, "TEID %u already used by another UE\n", i_tei);
+    return RETURNerror;
+  }
+  if (!gtpu_us.nb_free) {
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    OAILOG_ERROR(LOG_GTPV1U, "No GTP-U tunnel left for TEID %u\n", i_tei);
+    return RETURNerror;
+  }
+  index = gtpu_us.free_tunnels[--gtpu_us.nb_free];
+  tunnel = &gtpu_us.tunnels[index - 1];
+  memset(tunnel, 0, sizeof(*tunnel));
+  tunnel->i_tei = i_tei;
+  tunnel->o_tei = o_tei;
+  tunnel->ue = ue;
+  tunnel->enb = enb;
+  tunnel->in_use = true;
+  tunnel->forward = true;
+  gtpu_us.teid_slots[teid_slot] = index;
+
+  ue_slot = gtpu_us_slot_find(gtpu_us.ue_slots, ue.s_addr, false);
+  if (gtpu_us.ue_slots[ue_slot]) {
+    // Dedicated bearer, chained after the default one
+    gtpu_us_tunnel_t *first = &gtpu_us.tunnels[gtpu_us.ue_slots[ue_slot] - 1];
+    tunnel->next_of_ue = first->next_of_ue;
+    first->next_of_ue = index;
+  } else {
+    gtpu_us.ue_slots[ue_slot] = index;
+  }
+  pthread_rwlock_unlock(&gtpu_us.lock);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_del_tunnel(uint32_t i_tei)
+{
+  gtpu_us_tunnel_t *tunnel = NULL;
+  uint32_t teid_slot = 0;
+  uint32_t ue_slot = 0;
+  uint32_t index = 0;
+
+  pthread_rwlock_wrlock(&gtpu_us.lock);
+  if (!gtpu_us.teid_slots) {
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    return RETURNerror;
+  }
+  teid_slot = gtpu_us_slot_find(gtpu_us.teid_slots, i_tei, true);
+  if (!(index = gtpu_us.teid_slots[teid_slot])) {
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    return RETURNerror;
+  }
+  tunnel = &gtpu_us.tunnels[index - 1];
+  gtpu_us_slot_remove(gtpu_us.teid_slots, teid_slot, true);
+
+  ue_slot = gtpu_us_slot_find(gtpu_us.ue_slots, tunnel->ue.s_addr, false);
+  if (gtpu_us.ue_slots[ue_slot] == index) {
+    if (tunnel->next_of_ue) {
+      gtpu_us.ue_slots[ue_slot] = tunnel->next_of_ue;
+    } else {
+      gtpu_us_slot_remove(gtpu_us.ue_slots, ue_slot, false);
+    }
+  } else if (gtpu_us.ue_slots[ue_slot]) {
+    gtpu_us_tunnel_t *prev = &gtpu_us.tunnels[gtpu_us.ue_slots[ue_slot] - 1];
+    while (prev->next_of_ue && (prev->next_of_ue != index)) {
+      prev = &gtpu_us.tunnels[prev->next_of_ue - 1];
+    }
+    prev->next_of_ue = tunnel->next_of_ue;
+  }
+  tunnel->in_use = false;
+  gtpu_us.free_tunnels[gtpu_us.nb_free++] = index;
+  pthread_rwlock_unlock(&gtpu_us.lock);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_set_forwarding(uint32_t i_tei, bool forward)
+{
+  uint32_t index = 0;
+
+  pthread_rwlock_wrlock(&gtpu_us.lock);
+  if (
+    gtpu_us.teid_slots &&
+    (index = gtpu_us.teid_slots[gtpu_us_slot_find(
+       gtpu_us.teid_slots, i_tei, true)])) {
+    gtpu_us.tunnels[index - 1].forward = forward;
+  }
+  pthread_rwlock_unlock(&gtpu_us.lock);
+  return index ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_get_tunnel_stats(uint32_t i_tei, gtpu_us_stats_t *stats)
+{
+  uint32_t index = 0;
+
+  memset(stats, 0, sizeof(*stats));
+  pthread_rwlock_rdlock(&gtpu_us.lock);
+  if (
+    gtpu_us.teid_slots &&
+    (index = gtpu_us.teid_slots[gtpu_us_slot_find(
+       gtpu_us.teid_slots, i_tei, true)])) {
+    gtpu_us_tunnel_t *tunnel = &gtpu_us.tunnels[index - 1];
+    stats->ul_packets = __atomic_load_n(&tunnel->ul_packets, __ATOMIC_RELAXED);
+    stats->ul_bytes = __atomic_load_n(&tunnel->ul_bytes, __ATOMIC_RELAXED);
+    stats->dl_packets = __atomic_load_n(&tunnel->dl_packets, __ATOMIC_RELAXED);
+    stats->dl_bytes = __atomic_load_n(&tunnel->dl_bytes, __ATOMIC_RELAXED);
+  }
+  pthread_rwlock_unlock(&gtpu_us.lock);
+  return index ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+uint32_t gtpu_us_count(void)
+{
+  uint32_t count = 0;
+
+  pthread_rwlock_rdlock(&gtpu_us.lock);
+  count = gtpu_us.max_tunnels - gtpu_us.nb_free;
+  pthread_rwlock_unlock(&gtpu_us.lock);
+  return count;
+}
+
+//------------------------------------------------------------------------------
+static gtpu_us_verdict_t gtpu_us_parse(
+  gtpu_us_pkt_t *pkt,
+  uint8_t *type,
+  uint32_t *teid)
+{
+  const uint8_t *data = pkt->data;
+  uint32_t end = 0;
+  uint32_t offset = GTPU_US_HEADER_LEN;
+
+  if (
+    (pkt->len < GTPU_US_HEADER_LEN) ||
+    ((data[0] & 0xf0) != GTPU_US_FLAGS_V1_PT)) {
+    return GTPU_US_DROP_MALFORMED;
+  }
+  *type = data[1];
+  end = GTPU_US_HEADER_LEN + ((data[2] << 8) | data[3]);
+  *teid = ((uint32_t) data[4] << 24) | (data[5] << 16) | (data[6] << 8) |
+          data[7];
+  if (end > pkt->len) {
+    return GTPU_US_DROP_MALFORMED;
+  }
+  if (data[0] & GTPU_US_FLAGS_E_S_PN) {
+    uint8_t next = 0;
+
+    // Sequence number, N-PDU number and next extension header type
+    if (offset + 4 > end) {
+      return GTPU_US_DROP_MALFORMED;
+    }
+    next = data[offset + 3];
+    offset += 4;
+    while (next) {
+      uint32_t ext_len = 0;
+
+      if (offset >= end) {
+        return GTPU_US_DROP_MALFORMED;
+      }
+      ext_len = data[offset] * 4;
+      if (!ext_len || (offset + ext_len > end)) {
+        return GTPU_US_DROP_MALFORMED;
+      }
+      next = data[offset + ext_len - 1];
+      offset += ext_len;
+    }
+  }
+  pkt->offset = offset;
+  pkt->len = end - offset;
+  return GTPU_US_FORWARD;
+}
+
+//------------------------------------------------------------------------------
+void gtpu_us_uplink_batch(gtpu_us_pkt_t *pkts, uint32_t nb_pkts)
+{
+  uint32_t teids[GTPU_US_BATCH_SIZE];
+
+  // First pass: headers, and the slots the lookups will touch
+  for (uint32_t i = 0; i < nb_pkts; i++) {
+    uint8_t type = 0;
+
+    pkts[i].verdict = gtpu_us_parse(&pkts[i], &type, &teids[i]);
+    if (pkts[i].verdict != GTPU_US_FORWARD) {
+      continue;
+    }
+    if (type == GTPU_US_MSG_ECHO_REQUEST) {
+      pkts[i].verdict = GTPU_US_ECHO_REQUEST;
+    } else if (type != GTPU_US_MSG_GPDU) {
+      pkts[i].verdict = GTPU_US_DROP_MALFORMED;
+    }
+  }
+
+  pthread_rwlock_rdlock(&gtpu_us.lock);
+  if (!gtpu_us.teid_slots) {
+    for (uint32_t i = 0; i < nb_pkts; i++) {
+      if (pkts[i].verdict == GTPU_US_FORWARD) {
+        pkts[i].verdict = GTPU_US_DROP_NO_TUNNEL;
+      }
+    }
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    return;
+  }
+  for (uint32_t i = 0; i < nb_pkts; i++) {
+    if (pkts[i].verdict == GTPU_US_FORWARD) {
+      __builtin_prefetch(&gtpu_us.teid_slots[gtpu_us_hash(teids[i])]);
+    }
+  }
+  // Second pass: lookups, anti-spoofing and counters
+  for (uint32_t i = 0; i < nb_pkts; i++) {
+    gtpu_us_pkt_t *pkt = &pkts[i];
+    const uint8_t *ip = pkt->data + pkt->offset;
+    gtpu_us_tunnel_t *tunnel = NULL;
+    uint32_t index = 0;
+
+    if (pkt->verdict != GTPU_US_FORWARD) {
+      continue;
+    }
+    index =
+      gtpu_us.teid_slots[gtpu_us_slot_find(gtpu_us.teid_slots, teids[i], true)];
+    if (!index) {
+      pkt->verdict = GTPU_US_DROP_NO_TUNNEL;
+      continue;
+    }
+    tunnel = &gtpu_us.tunnels[index - 1];
+    if ((pkt->len < 20) || ((ip[0] >> 4) != 4)) {
+      pkt->verdict = GTPU_US_DROP_MALFORMED;
+      continue;
+    }
+    if (memcmp(ip + 12, &tunnel->ue.s_addr, sizeof(tunnel->ue.s_addr))) {
+      pkt->verdict = GTPU_US_DROP_SPOOFED;
+      continue;
+    }
+    __atomic_fetch_add(&tunnel->ul_packets, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tunnel->ul_bytes, pkt->len, __ATOMIC_RELAXED);
+  }
+  pthread_rwlock_unlock(&gtpu_us.lock);
+}
+
+//------------------------------------------------------------------------------
+void gtpu_us_downlink_batch(gtpu_us_pkt_t *pkts, uint32_t nb_pkts)
+{
+  uint32_t ues[GTPU_US_BATCH_SIZE];
+
+  for (uint32_t i = 0; i < nb_pkts; i++) {
+    pkts[i].offset = 0;
+    if ((pkts[i].len < 20) || ((pkts[i].data[0] >> 4) != 4)) {
+      pkts[i].verdict = GTPU_US_DROP_MALFORMED;
+      continue;
+    }
+    pkts[i].verdict = GTPU_US_FORWARD;
+    memcpy(&ues[i], pkts[i].data + 16, sizeof(ues[i]));
+  }
+
+  pthread_rwlock_rdlock(&gtpu_us.lock);
+  if (!gtpu_us.ue_slots) {
+    for (uint32_t i = 0; i < nb_pkts; i++) {
+      if (pkts[i].verdict == GTPU_US_FORWARD) {
+        pkts[i].verdict = GTPU_US_DROP_NO_TUNNEL;
+      }
+    }
+    pthread_rwlock_unlock(&gtpu_us.lock);
+    return;
+  }
+  for (uint32_t i = 0; i < nb_pkts; i++) {
+    if (pkts[i].verdict == GTPU_US_FORWARD) {
+      __builtin_prefetch(&gtpu_us.ue_slots[gtpu_us_hash(ues[i])]);
+    }
+  }
+  for (uint32_t i = 0; i < nb_pkts; i++) {
+    gtpu_us_pkt_t *pkt = &pkts[i];
+    gtpu_us_tunnel_t *tunnel = NULL;
+    uint32_t index = 0;
+    uint8_t *header = pkt->header;
+
+    if (pkt->verdict != GTPU_US_FORWARD) {
+      continue;
+    }
+    index =
+      gtpu_us.ue_slots[gtpu_us_slot_find(gtpu_us.ue_slots, ues[i], false)];
+    if (!index) {
+      pkt->verdict = GTPU_US_DROP_NO_TUNNEL;
+      continue;
+    }
+    tunnel = &gtpu_us.tunnels[index - 1];
+    if (!tunnel->forward) {
+      pkt->verdict = GTPU_US_DROP_DISCARDED;
+      continue;
+    }
+    header[0] = GTPU_US_FLAGS_V1_PT;
+    header[1] = GTPU_US_MSG_GPDU;
+    header[2] = pkt->len >> 8;
+    header[3] = pkt->len & 0xff;
+    header[4] = tunnel->o_tei >> 24;
+    header[5] = (tunnel->o_tei >> 16) & 0xff;
+    header[6] = (tunnel->o_tei >> 8) & 0xff;
+    header[7] = tunnel->o_tei & 0xff;
+    pkt->peer = tunnel->enb;
+    __atomic_fetch_add(&tunnel->dl_packets, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tunnel->dl_bytes, pkt->len, __ATOMIC_RELAXED);
+  }
+  pthread_rwlock_unlock(&gtpu_us.lock);
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_echo_response(
+  const uint8_t *req,
+  uint32_t req_len,
+  uint8_t *resp,
+  uint32_t resp_size)
+{
+  // Header, sequence number, N-PDU number, next extension, Recovery IE
+  const uint32_t resp_len = GTPU_US_HEADER_LEN + 4 + 2;
+
+  if (
+    (req_len < GTPU_US_HEADER_LEN + 4) || !(req[0] & GTPU_US_FLAG_S) ||
+    (resp_size < resp_len)) {
+    return -1;
+  }
+  resp[0] = GTPU_US_FLAGS_V1_PT | GTPU_US_FLAG_S;
+  resp[1] = GTPU_US_MSG_ECHO_RESPONSE;
+  resp[2] = 0;
+  resp[3] = resp_len - GTPU_US_HEADER_LEN;
+  memset(resp + 4, 0, 4);
+  resp[8] = req[8];
+  resp[9] = req[9];
+  resp[10] = 0;
+  resp[11] = 0;
+  resp[12] = GTPU_US_IE_RECOVERY;
+  resp[13] = 0;
+  return resp_len;
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_us_worker_count(
+  gtpu_us_worker_t *worker,
+  const gtpu_us_stats_t *batch)
+{
+  // Read by gtpu_us_get_stats from other threads
+  gtpu_us_stats_t *stats = &worker->stats;
+
+  __atomic_fetch_add(&stats->ul_packets, batch->ul_packets, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->ul_bytes, batch->ul_bytes, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->dl_packets, batch->dl_packets, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->dl_bytes, batch->dl_bytes, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->drops, batch->drops, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_us_worker_uplink(gtpu_us_worker_t *worker)
+{
+  gtpu_us_stats_t batch = {0};
+  int nb_msgs = 0;
+
+  for (int i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+    worker->ul_msgs[i].msg_hdr.msg_namelen = sizeof(worker->ul_peers[i]);
+  }
+  nb_msgs = recvmmsg(
+    worker->udp_fd, worker->ul_msgs, GTPU_US_BATCH_SIZE, MSG_DONTWAIT, NULL);
+  if (nb_msgs <= 0) {
+    return;
+  }
+  for (int i = 0; i < nb_msgs; i++) {
+    worker->ul_pkts[i].data = worker->ul_buffers[i];
+    worker->ul_pkts[i].len = worker->ul_msgs[i].msg_len;
+  }
+  gtpu_us_uplink_batch(worker->ul_pkts, nb_msgs);
+
+  // A TUN device takes one packet per write
+  for (int i = 0; i < nb_msgs; i++) {
+    gtpu_us_pkt_t *pkt = &worker->ul_pkts[i];
+    uint8_t resp[GTPU_US_HEADER_LEN + 8];
+    int resp_len = 0;
+
+    switch (pkt->verdict) {
+      case GTPU_US_FORWARD:
+        if (write(worker->tun_fd, pkt->data + pkt->offset, pkt->len) < 0) {
+          batch.drops++;
+          break;
+        }
+        batch.ul_packets++;
+        batch.ul_bytes += pkt->len;
+        break;
+      case GTPU_US_ECHO_REQUEST:
+        resp_len = gtpu_us_echo_response(
+          pkt->data, worker->ul_msgs[i].msg_len, resp, sizeof(resp));
+        if (resp_len > 0) {
+          sendto(
+            worker->udp_fd,
+            resp,
+            resp_len,
+            0,
+            (struct sockaddr *) &worker->ul_peers[i],
+            sizeof(worker->ul_peers[i]));
+        }
+        break;
+      default: batch.drops++; break;
+    }
+  }
+  gtpu_us_worker_count(worker, &batch);
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_us_worker_downlink(gtpu_us_worker_t *worker)
+{
+  gtpu_us_stats_t batch = {0};
+  int nb_pkts = 0;
+  int nb_msgs = 0;
+  int nb_sent = 0;
+
+  // No recvmmsg on a TUN device, its queue is drained up to a batch
+  while (nb_pkts < GTPU_US_BATCH_SIZE) {
+    ssize_t len = read(
+      worker->tun_fd, worker->dl_buffers[nb_pkts], GTPU_US_PKT_BUFFER_SIZE);
+    if (len <= 0) {
+      break;
+    }
+    worker->dl_pkts[nb_pkts].data = worker->dl_buffers[nb_pkts];
+    worker->dl_pkts[nb_pkts].len = len;
+    nb_pkts++;
+  }
+  if (!nb_pkts) {
+    return;
+  }
+  gtpu_us_downlink_batch(worker->dl_pkts, nb_pkts);
+
+  for (int i = 0; i < nb_pkts; i++) {
+    gtpu_us_pkt_t *pkt = &worker->dl_pkts[i];
+    struct msghdr *hdr = &worker->dl_msgs[nb_msgs].msg_hdr;
+
+    if (pkt->verdict != GTPU_US_FORWARD) {
+      batch.drops++;
+      continue;
+    }
+    // The header is sent from where it was built, the packet is not moved
+    worker->dl_iovs[nb_msgs][0].iov_base = pkt->header;
+    worker->dl_iovs[nb_msgs][0].iov_len = GTPU_US_HEADER_LEN;
+    worker->dl_iovs[nb_msgs][1].iov_base = pkt->data;
+    worker->dl_iovs[nb_msgs][1].iov_len = pkt->len;
+    worker->dl_peers[nb_msgs].sin_family = AF_INET;
+    worker->dl_peers[nb_msgs].sin_port = htons(gtpu_us.config.s1u_port);
+    worker->dl_peers[nb_msgs].sin_addr = pkt->peer;
+    hdr->msg_name = &worker->dl_peers[nb_msgs];
+    hdr->msg_namelen = sizeof(worker->dl_peers[nb_msgs]);
+    hdr->msg_iov = worker->dl_iovs[nb_msgs];
+    hdr->msg_iovlen = 2;
+    nb_msgs++;
+  }
+  while (nb_sent < nb_msgs) {
+    int rc = sendmmsg(
+      worker->udp_fd, &worker->dl_msgs[nb_sent], nb_msgs - nb_sent, 0);
+    if (rc <= 0) {
+      if ((rc < 0) && (errno == EINTR)) {
+        continue;
+      }
+      batch.drops += nb_msgs - nb_sent;
+      break;
+    }
+    nb_sent += rc;
+  }
+  for (int i = 0; i < nb_sent; i++) {
+    batch.dl_bytes += worker->dl_iovs[i][1].iov_len;
+  }
+  batch.dl_packets = nb_sent;
+  gtpu_us_worker_count(worker, &batch);
+}
+
+//------------------------------------------------------------------------------
+static void *gtpu_us_worker_main(void *arg)
+{
+  gtpu_us_worker_t *worker = (gtpu_us_worker_t *) arg;
+  struct epoll_event events[3];
+
+  for (;;) {
+    int nb_events = epoll_wait(worker->epoll_fd, events, 3, -1);
+
+    for (int i = 0; i < nb_events; i++) {
+      if (events[i].data.fd == gtpu_us.stop_fd) {
+        return NULL;
+      }
+      if (events[i].data.fd == worker->udp_fd) {
+        gtpu_us_worker_uplink(worker);
+      } else if (events[i].data.fd == worker->tun_fd) {
+        gtpu_us_worker_downlink(worker);
+      }
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_us_open_tun(const char *name)
+{
+  struct ifreq ifr = {0};
+  int fd = open("/dev/net/tun", O_RDWR | O_CLOEXEC);
+
+  if (fd < 0) {
+    OAILOG_ERROR(LOG_GTPV1U, "Cannot open /dev/net/tun: %s\n", strerror(errno));
+    return -1;
+  }
+  // One queue per worker, the kernel spreads the downlink flows on them
+  ifr.ifr_flags = IFF_TUN | IFF_NO_PI | IFF_MULTI_QUEUE;
+  snprintf(ifr.ifr_name, IFNAMSIZ, "%s", name);
+  if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Cannot attach to TUN device %s: %s\n",
+      name,
+      strerror(errno));
+    close(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_us_configure_tun(const gtpu_us_config_t *config)
+{
+  struct ifreq ifr = {0};
+  struct sockaddr_in *addr = (struct sockaddr_in *) &ifr.ifr_addr;
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  int rc = RETURNok;
+
+  if (fd < 0) {
+    return RETURNerror;
+  }
+  snprintf(ifr.ifr_name, IFNAMSIZ, "%s", config->tun_name);
+  ifr.ifr_mtu = config->mtu;
+  if (ioctl(fd, SIOCSIFMTU, &ifr) < 0) {
+    rc = RETURNerror;
+  }
+  // The UE gateway address, its prefix routes the UE subnet to the device
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = config->ue_net.s_addr | htonl(1);
+  if (ioctl(fd, SIOCSIFADDR, &ifr) < 0) {
+    rc = RETURNerror;
+  }
+  addr->sin_addr.s_addr =
+    config->ue_mask ? htonl(~0u << (32 - config->ue_mask)) : 0;
+  if (ioctl(fd, SIOCSIFNETMASK, &ifr) < 0) {
+    rc = RETURNerror;
+  }
+  if (ioctl(fd, SIOCGIFFLAGS, &ifr) == 0) {
+    ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+    if (ioctl(fd, SIOCSIFFLAGS, &ifr) < 0) {
+      rc = RETURNerror;
+    }
+  } else {
+    rc = RETURNerror;
+  }
+  if (rc != RETURNok) {
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Cannot configure TUN device %s: %s\n",
+      config->tun_name,
+      strerror(errno));
+  }
+  close(fd);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_us_open_s1u(const gtpu_us_config_t *config)
+{
+  struct sockaddr_in addr = {
+    .sin_family = AF_INET,
+    .sin_port = htons(config->s1u_port),
+    .sin_addr = config->s1u_addr,
+  };
+  int size = GTPU_US_SOCKET_BUFFER_SIZE;
+  int one = 1;
+  int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+  if (fd < 0) {
+    return -1;
+  }
+  // One socket per worker, the kernel spreads the eNBs on them
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+  setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+  if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Cannot bind S1-U socket to port %u: %s\n",
+      config->s1u_port,
+      strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_us_worker_open(gtpu_us_worker_t *worker)
+{
+  struct epoll_event event = {.events = EPOLLIN};
+
+  worker->ul_buffers = calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  worker->dl_buffers = calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  if (!worker->ul_buffers || !worker->dl_buffers) {
+    return RETURNerror;
+  }
+  for (int i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+    worker->ul_iovs[i].iov_base = worker->ul_buffers[i];
+    worker->ul_iovs[i].iov_len = GTPU_US_PKT_BUFFER_SIZE;
+    worker->ul_msgs[i].msg_hdr.msg_iov = &worker->ul_iovs[i];
+    worker->ul_msgs[i].msg_hdr.msg_iovlen = 1;
+    worker->ul_msgs[i].msg_hdr.msg_name = &worker->ul_peers[i];
+  }
+  if (
+    ((worker->tun_fd = gtpu_us_open_tun(gtpu_us.config.tun_name)) < 0) ||
+    ((worker->udp_fd = gtpu_us_open_s1u(&gtpu_us.config)) < 0) ||
+    ((worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)) {
+    return RETURNerror;
+  }
+  event.data.fd = worker->tun_fd;
+  epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->tun_fd, &event);
+  event.data.fd = worker->udp_fd;
+  epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, worker->udp_fd, &event);
+  event.data.fd = gtpu_us.stop_fd;
+  epoll_ctl(worker->epoll_fd, EPOLL_CTL_ADD, gtpu_us.stop_fd, &event);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int gtpu_us_start(const gtpu_us_config_t *config)
+{
+  long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  gtpu_us_stop();
+  if ((config->nb_workers <= 0) || (config->nb_workers > GTPU_US_MAX_WORKERS)) {
+    return RETURNerror;
+  }
+  gtpu_us.config = *config;
+  gtpu_us.stop_fd = eventfd(0, EFD_CLOEXEC);
+  gtpu_us.workers = calloc(config->nb_workers, sizeof(gtpu_us_worker_t));
+  if ((gtpu_us.stop_fd < 0) || !gtpu_us.workers) {
+    gtpu_us_stop();
+    return RETURNerror;
+  }
+  gtpu_us.nb_workers = config->nb_workers;
+  for (int i = 0; i < gtpu_us.nb_workers; i++) {
+    gtpu_us.workers[i].id = i;
+    gtpu_us.workers[i].tun_fd = -1;
+    gtpu_us.workers[i].udp_fd = -1;
+    gtpu_us.workers[i].epoll_fd = -1;
+  }
+  for (int i = 0; i < gtpu_us.nb_workers; i++) {
+    if (gtpu_us_worker_open(&gtpu_us.workers[i]) != RETURNok) {
+      gtpu_us_stop();
+      return RETURNerror;
+    }
+  }
+  if (gtpu_us_configure_tun(config) != RETURNok) {
+    gtpu_us_stop();
+    return RETURNerror;
+  }
+
+  for (int i = 0; i < gtpu_us.nb_workers; i++) {
+    gtpu_us_worker_t *worker = &gtpu_us.workers[i];
+
+    if (pthread_create(&worker->thread, NULL, gtpu_us_worker_main, worker)) {
+      OAILOG_ERROR(LOG_GTPV1U, "Cannot start GTP-U worker %d\n", i);
+      gtpu_us_stop();
+      return RETURNerror;
+    }
+    worker->started = true;
+    if ((config->first_cpu >= 0) && (nb_cpus > 0)) {
+      cpu_set_t cpus;
+
+      CPU_ZERO(&cpus);
+      CPU_SET((config->first_cpu + i) % nb_cpus, &cpus);
+      pthread_setaffinity_np(worker->thread, sizeof(cpus), &cpus);
+    }
+  }
+  OAILOG_NOTICE(
+    LOG_GTPV1U,
+    "Userspace GTP-U on %s with %d workers\n",
+    config->tun_name,
+    gtpu_us.nb_workers);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void gtpu_us_stop(void)
+{
+  uint64_t one = 1;
+
+  if (gtpu_us.stop_fd >= 0) {
+    // Level triggered: every worker sees it
+    if (write(gtpu_us.stop_fd, &one, sizeof(one)) < 0) {
+      OAILOG_ERROR(LOG_GTPV1U, "Cannot stop the GTP-U workers\n");
+    }
+  }
+  for (int i = 0; i < gtpu_us.nb_workers; i++) {
+    gtpu_us_worker_t *worker = &gtpu_us.workers[i];
+
+    if (worker->started) {
+      pthread_join(worker->thread, NULL);
+    }
+    if (worker->epoll_fd >= 0) close(worker->epoll_fd);
+    if (worker->udp_fd >= 0) close(worker->udp_fd);
+    if (worker->tun_fd >= 0) close(worker->tun_fd);
+    free_wrapper((void **) &worker->ul_buffers);
+    free_wrapper((void **) &worker->dl_buffers);
+  }
+  free_wrapper((void **) &gtpu_us.workers);
+  gtpu_us.nb_workers = 0;
+  if (gtpu_us.stop_fd >= 0) {
+    close(gtpu_us.stop_fd);
+    gtpu_us.stop_fd = -1;
+  }
+}
+
+//------------------------------------------------------------------------------
+void gtpu_us_get_stats(gtpu_us_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  for (int i = 0; i < gtpu_us.nb_workers; i++) {
+    const gtpu_us_stats_t *worker = &gtpu_us.workers[i].stats;
+
+    stats->ul_packets += __atomic_load_n(&worker->ul_packets, __ATOMIC_RELAXED);
+    stats->ul_bytes += __atomic_load_n(&worker->ul_bytes, __ATOMIC_RELAXED);
+    stats->dl_packets += __atomic_load_n(&worker->dl_packets, __ATOMIC_RELAXED);
+    stats->dl_bytes += __atomic_load_n(&worker->dl_bytes, __ATOMIC_RELAXED);
+    stats->drops += __atomic_load_n(&worker->drops, __ATOMIC_RELAXED);
+  }
+}
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtpu_userspace.h
+  \brief In-process GTP-U forwarder: a TUN device on SGi, UDP sockets on S1-U
+  and worker threads forwarding the packets in batches.
+*/
+
+#ifndef FILE_GTPU_USERSPACE_SEEN
+#define FILE_GTPU_USERSPACE_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+#define GTPU_US_HEADER_LEN 8
+#define GTPU_US_MAX_WORKERS 16
+// Packets read from a socket or the TUN device in one go
+#define GTPU_US_BATCH_SIZE 32
+#define GTPU_US_PKT_BUFFER_SIZE 2048
+
+#define GTPU_US_MSG_ECHO_REQUEST 1
+#define GTPU_US_MSG_ECHO_RESPONSE 2
+#define GTPU_US_MSG_GPDU 255
+
+typedef struct gtpu_us_config_s {
+  char tun_name[IFNAMSIZ];
+  struct in_addr ue_net;
+  uint32_t ue_mask; // prefix length
+  int mtu;
+  struct in_addr s1u_addr;
+  uint16_t s1u_port; // local, and of the eNBs
+  int nb_workers;
+  int first_cpu; // worker i runs on CPU first_cpu + i, -1 leaves them unpinned
+} gtpu_us_config_t;
+
+typedef struct gtpu_us_stats_s {
+  uint64_t ul_packets;
+  uint64_t ul_bytes;
+  uint64_t dl_packets;
+  uint64_t dl_bytes;
+  uint64_t drops; // only counted per worker
+} gtpu_us_stats_t;
+
+typedef enum {
+  GTPU_US_FORWARD = 0,
+  GTPU_US_ECHO_REQUEST,
+  GTPU_US_DROP_MALFORMED,
+  GTPU_US_DROP_NO_TUNNEL,
+  GTPU_US_DROP_DISCARDED,
+  GTPU_US_DROP_SPOOFED,
+} gtpu_us_verdict_t;
+
+/*
+ * A packet of a batch. Uplink, data is the GTP-U message and offset, len
+ * locate the inner IP packet once decapsulated. Downlink, data is the IP
+ * packet read from the TUN device and header, peer are what to send it with.
+ */
+typedef struct gtpu_us_pkt_s {
+  uint8_t *data;
+  uint32_t len;
+  uint32_t offset;
+  gtpu_us_verdict_t verdict;
+  uint8_t header[GTPU_US_HEADER_LEN];
+  struct in_addr peer;
+} gtpu_us_pkt_t;
+
+/*
+ * The tunnels are kept in a pool of max_tunnels entries, indexed by their
+ * local TEID and by UE IP address in two flat open addressing tables. Workers
+ * look them up under a read lock taken once per batch.
+ */
+int gtpu_us_init(uint32_t max_tunnels);
+
+// Stops the workers if they run and frees the tunnels
+void gtpu_us_exit(void);
+
+// Creates the TUN device and the S1-U sockets, then starts the workers
+int gtpu_us_start(const gtpu_us_config_t *config);
+
+void gtpu_us_stop(void);
+
+/*
+ * The downlink packets of a UE with several tunnels go to the first one
+ * added, its default bearer.
+ */
+int gtpu_us_add_tunnel(
+  struct in_addr ue,
+  struct in_addr enb,
+  uint32_t i_tei,
+  uint32_t o_tei);
+
+int gtpu_us_del_tunnel(uint32_t i_tei);
+
+// Drops, or forwards again, the downlink packets of the tunnel
+int gtpu_us_set_forwarding(uint32_t i_tei, bool forward);
+
+int gtpu_us_get_tunnel_stats(uint32_t i_tei, gtpu_us_stats_t *stats);
+
+// Sum of the counters of the workers
+void gtpu_us_get_stats(gtpu_us_stats_t *stats);
+
+uint32_t gtpu_us_count(void);
+
+/*
+ * Batch processing of the workers, exposed for the tests: headers are parsed
+ * and the table slots prefetched for the whole batch before any lookup.
+ */
+void gtpu_us_uplink_batch(gtpu_us_pkt_t *pkts, uint32_t nb_pkts);
+
+void gtpu_us_downlink_batch(gtpu_us_pkt_t *pkts, uint32_t nb_pkts);
+
+// Echo Response to the Echo Request in req, returns its length or -1
+int gtpu_us_echo_response(
+  const uint8_t *req,
+  uint32_t req_len,
+  uint8_t *resp,
+  uint32_t resp_size);
+
+#endif /* FILE_GTPU_USERSPACE_SEEN */
@@ -28,6 +28,8 @@
 #ifndef FILE_GTPV1_U_SEEN
 #define FILE_GTPV1_U_SEEN
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <arpa/inet.h>
 #include <net/if.h>
 #include "sgw_ie_defs.h"
@@ -76,7 +78,59 @@
  * int (*forward_data_on_tunnel)(struct in_addr ue, uint32_t i_tei);
  *         @ue: UE IP address
  *         @i_tei: RX GTP Tunnel ID
+ *
+ * Backends programming the tunnels asynchronously only queue the deletions in
+ * del_tunnel, its return value then only tells whether the deletion could be
+ * queued. add_tunnel still returns once the tunnel is set up or has failed, the
+ * SGW answers the MME right after. They define the following hooks too:
+ *
+ * int (*commit)(void);
+ *     Send the queued changes, without waiting for them to be acknowledged.
+ *     Returns the number of changes that could not be sent.
+ *
+ * int (*process_acks)(void);
+ *     Process the acknowledgements available, without blocking. Returns the
+ *     number of changes reported as failed.
+ *
+ * int (*get_ack_fd)(void);
+ *     File descriptor that becomes readable when acknowledgements are
+ *     available, -1 if there is none.
+ *
+ * void (*set_failure_cb)(gtp_tunnel_failure_cb_t cb);
+ *     Callback invoked for every deletion that failed, from commit,
+ *     process_acks, add_tunnel or del_tunnel.
+ *
+ * Backends able to read the traffic counters of the tunnels define:
+ *
+ * int (*poll_usage)(gtp_tunnel_usage_cb_t cb);
+ *     Request fresh counters, and report the usage measured by the last
+ *     complete poll, if not reported yet, through cb on the calling thread.
+ *     Returns the number of tunnels reported, -1 if the counters can not be
+ *     requested.
  */
+typedef void (*gtp_tunnel_failure_cb_t)(
+  bool add,
+  struct in_addr ue,
+  uint32_t i_tei,
+  uint32_t o_tei,
+  int error);
+
+
+// Usage of a tunnel since the previous report
+struct gtp_tunnel_usage {
+  uint32_t i_tei;
+  struct in_addr ue;
+  uint64_t ul_packets;
+  uint64_t ul_bytes;
+  uint64_t dl_packets;
+  uint64_t dl_bytes;
+  uint32_t idle_sec; // since the last packet, in either direction
+};
+
+typedef void (*gtp_tunnel_usage_cb_t)(
+  const struct gtp_tunnel_usage *usages,
+  uint32_t nb_usages);
+
 struct gtp_tunnel_ops {
   int (
     *init)(struct in_addr *ue_net, uint32_t mask, int mtu, int *fd0, int *fd1u);
@@ -91,12 +145,17 @@ struct gtp_tunnel_ops {
   int (*del_tunnel)(struct in_addr ue, uint32_t i_tei, uint32_t o_tei);
   int (*discard_data_on_tunnel)(struct in_addr ue, uint32_t i_tei);
   int (*forward_data_on_tunnel)(struct in_addr ue, uint32_t i_tei);
+  int (*commit)(void);
+  int (*process_acks)(void);
+  int (*get_ack_fd)(void);
+  void (*set_failure_cb)(gtp_tunnel_failure_cb_t cb);
+  int (*poll_usage)(gtp_tunnel_usage_cb_t cb);
 };
 
-uint32_t gtpv1u_new_teid(void);
-
 #if ENABLE_OPENFLOW
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init_openflow(void);
+#elif ENABLE_USERSPACE_GTPU
+const struct gtp_tunnel_ops *gtp_tunnel_ops_init_userspace(void);
 #else
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init_libgtpnl(void);
 #endif
@@ -94,6 +94,9 @@ int gtpv1u_init(spgw_config_t *spgw_config)
 #if ENABLE_OPENFLOW
   OAILOG_DEBUG(LOG_GTPV1U, "Initializing gtp_tunnel_ops_openflow\n");
   gtp_tunnel_ops = gtp_tunnel_ops_init_openflow();
+#elif ENABLE_USERSPACE_GTPU
+  OAILOG_DEBUG(LOG_GTPV1U, "Initializing gtp_tunnel_ops_userspace\n");
+  gtp_tunnel_ops = gtp_tunnel_ops_init_userspace();
 #else
   OAILOG_DEBUG(LOG_GTPV1U, "Initializing gtp_tunnel_ops_libgtpnl\n");
   gtp_tunnel_ops = gtp_tunnel_ops_init_libgtpnl();
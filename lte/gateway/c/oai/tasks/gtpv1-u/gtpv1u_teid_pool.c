@@ -18,30 +18,166 @@
  * For more information about the OpenAirInterface (OAI) Software Alliance:
  *      contact@openairinterface.org
  */
-/*! \file gtpv1u_task.c
+/*! \file gtpv1u_teid_pool.c
   \brief
   \author Lionel Gauthier
   \company Eurecom
   \email: lionel.gauthier@eurecom.fr
 */
+#include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
 
-#include "gtpv1u.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "gtpv1u_teid_pool.h"
 
-//#define GTPV1U_LINEAR_TEID_ALLOCATION 1
+typedef struct gtpv1u_teid_released_s {
+  uint32_t offset;
+  uint32_t released_at; // seconds, wraps
+} gtpv1u_teid_released_t;
 
-#if GTPV1U_LINEAR_TEID_ALLOCATION
-static uint32_t g_gtpv1u_teid = 0;
-#endif
+struct gtpv1u_teid_pool_s {
+  gtpv1u_teid_range_t range;
+  uint32_t quarantine_sec;
+  uint32_t nb_allocated;
+  // The offsets from next_fresh on have never been allocated
+  uint32_t next_fresh;
+  // FIFO of the released offsets, in the order they were released
+  gtpv1u_teid_released_t *released;
+  uint32_t released_head;
+  uint32_t nb_released;
+  uint64_t *allocated; // bitmap of the offsets
+};
 
-// TODO (amar) Function is unused. See if we can remove.
-uint32_t gtpv1u_new_teid(void)
+//------------------------------------------------------------------------------
+static inline bool _gtpv1u_teid_is_allocated(
+  const gtpv1u_teid_pool_t *pool,
+  const uint32_t offset)
 {
-#if GTPV1U_LINEAR_TEID_ALLOCATION
-  g_gtpv1u_teid = g_gtpv1u_teid + 1;
-  return g_gtpv1u_teid;
-#else
-  return random() + random() % (RAND_MAX - 1) + 1;
-#endif
+  return pool->allocated[offset >> 6] & (1ULL << (offset & 63));
+}
+
+//------------------------------------------------------------------------------
+gtpv1u_teid_range_t gtpv1u_teid_shard(
+  const gtpv1u_teid_range_t range,
+  const uint32_t shard,
+  const uint32_t nb_shards)
+{
+  uint32_t size = range.size / nb_shards;
+  gtpv1u_teid_range_t part = {.first = range.first + shard * size,
+                              .size = size};
+
+  DevAssert(shard < nb_shards);
+  // The last shard also takes the remainder
+  if (shard == nb_shards - 1) {
+    part.size = range.size - shard * size;
+  }
+  return part;
+}
+
+//------------------------------------------------------------------------------
+gtpv1u_teid_pool_t *gtpv1u_teid_pool_create(
+  const gtpv1u_teid_range_t range,
+  const uint32_t quarantine_sec)
+{
+  gtpv1u_teid_pool_t *pool = NULL;
+
+  DevAssert(range.size > 0);
+  DevAssert(range.first != GTPV1U_TEID_INVALID);
+  DevAssert(range.first - 1 <= UINT32_MAX - range.size);
+
+  pool = calloc(1, sizeof(gtpv1u_teid_pool_t));
+  if (!pool) {
+    return NULL;
+  }
+  pool->range = range;
+  pool->quarantine_sec = quarantine_sec;
+  pool->released = calloc(range.size, sizeof(gtpv1u_teid_released_t));
+  pool->allocated = calloc((range.size + 63) / 64, sizeof(uint64_t));
+  if (!pool->released || !pool->allocated) {
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Failed to allocate a pool of %u TEIDs\n",
+      range.size);
+    gtpv1u_teid_pool_destroy(&pool);
+  }
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+void gtpv1u_teid_pool_destroy(gtpv1u_teid_pool_t **pool)
+{
+  if (*pool) {
+    free_wrapper((void **) &(*pool)->released);
+    free_wrapper((void **) &(*pool)->allocated);
+    free_wrapper((void **) pool);
+  }
+}
+
+//------------------------------------------------------------------------------
+teid_t gtpv1u_teid_alloc(gtpv1u_teid_pool_t *pool, const time_t now)
+{
+  uint32_t offset = 0;
+
+  if (pool->next_fresh < pool->range.size) {
+    offset = pool->next_fresh++;
+  } else if (
+    pool->nb_released &&
+    ((uint32_t) now - pool->released[pool->released_head].released_at >=
+     pool->quarantine_sec)) {
+    offset = pool->released[pool->released_head].offset;
+    if (++pool->released_head == pool->range.size) {
+      pool->released_head = 0;
+    }
+    pool->nb_released--;
+  } else {
+    OAILOG_WARNING(
+      LOG_GTPV1U,
+      "No TEID left in " TEID_FMT "-" TEID_FMT ", %u in quarantine\n",
+      pool->range.first,
+      pool->range.first + (pool->range.size - 1),
+      pool->nb_released);
+    return GTPV1U_TEID_INVALID;
+  }
+  pool->allocated[offset >> 6] |= 1ULL << (offset & 63);
+  pool->nb_allocated++;
+  return pool->range.first + offset;
+}
+
+//------------------------------------------------------------------------------
+int gtpv1u_teid_free(
+  gtpv1u_teid_pool_t *pool,
+  const teid_t teid,
+  const time_t now)
+{
+  uint32_t offset = teid - pool->range.first;
+  uint32_t tail = 0;
+
+  if (
+    (teid < pool->range.first) || (offset >= pool->range.size) ||
+    !_gtpv1u_teid_is_allocated(pool, offset)) {
+    OAILOG_WARNING(
+      LOG_GTPV1U, "Release of TEID " TEID_FMT " not allocated\n", teid);
+    return RETURNerror;
+  }
+  pool->allocated[offset >> 6] &= ~(1ULL << (offset & 63));
+  pool->nb_allocated--;
+  // At most range.size offsets are released at once, the FIFO never overflows
+  tail = pool->released_head + pool->nb_released;
+  if (tail >= pool->range.size) {
+    tail -= pool->range.size;
+  }
+  pool->released[tail].offset = offset;
+  pool->released[tail].released_at = (uint32_t) now;
+  pool->nb_released++;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+uint32_t gtpv1u_teid_count(const gtpv1u_teid_pool_t *pool)
+{
+  return pool->nb_allocated;
 }
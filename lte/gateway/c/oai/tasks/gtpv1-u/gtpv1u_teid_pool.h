@@ -0,0 +1,79 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtpv1u_teid_pool.h
+  \brief Allocation of local TEIDs, unique within a range, with a delay before
+  a released TEID is handed out again.
+*/
+
+#ifndef FILE_GTPV1U_TEID_POOL_SEEN
+#define FILE_GTPV1U_TEID_POOL_SEEN
+
+#include <stdint.h>
+#include <time.h>
+
+#include "common_types.h"
+
+// Never allocated, reserved by 3GPP TS 29.281 and TS 29.274
+#define GTPV1U_TEID_INVALID 0
+
+typedef struct gtpv1u_teid_range_s {
+  teid_t first;
+  uint32_t size;
+} gtpv1u_teid_range_t;
+
+typedef struct gtpv1u_teid_pool_s gtpv1u_teid_pool_t;
+
+/*
+ * Part shard of nb_shards of the range: the parts are disjoint and cover the
+ * whole range, so that every shard or thread can own a pool of its own.
+ */
+gtpv1u_teid_range_t gtpv1u_teid_shard(
+  const gtpv1u_teid_range_t range,
+  const uint32_t shard,
+  const uint32_t nb_shards);
+
+/*
+ * A pool hands out the TEIDs of its range, each at most once until it is
+ * released, in O(1) and without allocating. A released TEID is not handed out
+ * again before quarantine_sec seconds, so that the late packets of a session
+ * do not hit the next one, and the least recently released TEIDs are reused
+ * first. A pool is not locked: it belongs to a single thread.
+ */
+gtpv1u_teid_pool_t *gtpv1u_teid_pool_create(
+  const gtpv1u_teid_range_t range,
+  const uint32_t quarantine_sec);
+
+void gtpv1u_teid_pool_destroy(gtpv1u_teid_pool_t **pool);
+
+// GTPV1U_TEID_INVALID if every TEID is allocated or in quarantine
+teid_t gtpv1u_teid_alloc(gtpv1u_teid_pool_t *pool, const time_t now);
+
+// RETURNerror if the TEID is not allocated from this pool
+int gtpv1u_teid_free(
+  gtpv1u_teid_pool_t *pool,
+  const teid_t teid,
+  const time_t now);
+
+// Number of TEIDs allocated
+uint32_t gtpv1u_teid_count(const gtpv1u_teid_pool_t *pool);
+
+#endif /* FILE_GTPV1U_TEID_POOL_SEEN */
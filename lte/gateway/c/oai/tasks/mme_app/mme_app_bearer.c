@@ -42,6 +42,7 @@
 #include "common_types.h"
 #include "intertask_interface.h"
 #include "mme_config.h"
+#include "mme_config_snapshot.h"
 #include "mme_app_extern.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
@@ -447,6 +448,48 @@ void mme_app_handle_conn_est_cnf(
   OAILOG_FUNC_OUT(LOG_MME_APP);
 }
 
+//------------------------------------------------------------------------------
+static bool mme_app_initial_ue_message_guti(
+  const itti_s1ap_initial_ue_message_t *const initial_pP,
+  guti_t *const guti_p)
+{
+  plmn_t plmn = {.mcc_digit1 = initial_pP->tai.mcc_digit1,
+                 .mcc_digit2 = initial_pP->tai.mcc_digit2,
+                 .mcc_digit3 = initial_pP->tai.mcc_digit3,
+                 .mnc_digit1 = initial_pP->tai.mnc_digit1,
+                 .mnc_digit2 = initial_pP->tai.mnc_digit2,
+                 .mnc_digit3 = initial_pP->tai.mnc_digit3};
+
+  return mme_app_construct_guti(&plmn, &(initial_pP->opt_s_tmsi), guti_p);
+}
+
+//------------------------------------------------------------------------------
+mme_ue_s1ap_id_t mme_app_initial_ue_message_assign_ue_id(
+  itti_s1ap_initial_ue_message_t *const initial_pP)
+{
+  uint64_t mme_ue_s1ap_id64 = 0;
+
+  if (initial_pP->is_s_tmsi_valid) {
+    guti_t guti = {.gummei.plmn = {0},
+                   .gummei.mme_gid = 0,
+                   .gummei.mme_code = 0,
+                   .m_tmsi = INVALID_M_TMSI};
+
+    if (
+      mme_app_initial_ue_message_guti(initial_pP, &guti) &&
+      (obj_hashtable_uint64_ts_get(
+         mme_app_desc.mme_ue_contexts.guti_ue_context_htbl,
+         (const void *) &guti,
+         sizeof(guti),
+         &mme_ue_s1ap_id64) == HASH_TABLE_OK)) {
+      return (mme_ue_s1ap_id_t) mme_ue_s1ap_id64;
+    }
+  }
+  // Unknown UE, its context will be created with this id
+  initial_pP->mme_ue_s1ap_id = mme_app_ctx_get_new_ue_id();
+  return initial_pP->mme_ue_s1ap_id;
+}
+
 // sent by S1AP
 //------------------------------------------------------------------------------
 void mme_app_handle_initial_ue_message(
@@ -458,11 +501,11 @@ void mme_app_handle_initial_ue_message(
   bool is_mm_ctx_new = false;
   emm_context_t *ue_nas_ctx = NULL;
   enb_s1ap_id_key_t enb_s1ap_id_key = INVALID_ENB_UE_S1AP_ID_KEY;
+  // Allocated by mme_app_initial_ue_message_assign_ue_id() if any
+  mme_ue_s1ap_id_t new_mme_ue_s1ap_id = initial_pP->mme_ue_s1ap_id;
 
   OAILOG_DEBUG(LOG_MME_APP, "Received MME_APP_INITIAL_UE_MESSAGE from S1AP\n");
 
-  DevAssert(INVALID_MME_UE_S1AP_ID == initial_pP->mme_ue_s1ap_id);
-
   // Check if there is any existing UE context using S-TMSI/GUTI
   if (initial_pP->is_s_tmsi_valid) {
     OAILOG_DEBUG(
@@ -475,14 +518,7 @@ void mme_app_handle_initial_ue_message(
                    .gummei.mme_gid = 0,
                    .gummei.mme_code = 0,
                    .m_tmsi = INVALID_M_TMSI};
-    plmn_t plmn = {.mcc_digit1 = initial_pP->tai.mcc_digit1,
-                   .mcc_digit2 = initial_pP->tai.mcc_digit2,
-                   .mcc_digit3 = initial_pP->tai.mcc_digit3,
-                   .mnc_digit1 = initial_pP->tai.mnc_digit1,
-                   .mnc_digit2 = initial_pP->tai.mnc_digit2,
-                   .mnc_digit3 = initial_pP->tai.mnc_digit3};
-    is_guti_valid =
-      mme_app_construct_guti(&plmn, &(initial_pP->opt_s_tmsi), &guti);
+    is_guti_valid = mme_app_initial_ue_message_guti(initial_pP, &guti);
     if (is_guti_valid) {
       ue_nas_ctx = emm_context_get_by_guti(&_emm_data, &guti);
       if (ue_nas_ctx) {
@@ -588,8 +624,12 @@ void mme_app_handle_initial_ue_message(
     ue_context_p->ue_context_modification_timer.sec =
       MME_APP_UE_CONTEXT_MODIFICATION_TIMER_VALUE;
     is_mm_ctx_new = true;
-    // Allocate new mme_ue_s1ap_id
-    ue_context_p->mme_ue_s1ap_id = mme_app_ctx_get_new_ue_id();
+    // Allocate new mme_ue_s1ap_id, unless the dispatcher already did
+    if (new_mme_ue_s1ap_id != INVALID_MME_UE_S1AP_ID) {
+      ue_context_p->mme_ue_s1ap_id = new_mme_ue_s1ap_id;
+    } else {
+      ue_context_p->mme_ue_s1ap_id = mme_app_ctx_get_new_ue_id();
+    }
     if (ue_context_p->mme_ue_s1ap_id == INVALID_MME_UE_S1AP_ID) {
       OAILOG_CRITICAL(
         LOG_MME_APP,
@@ -1243,6 +1283,24 @@ void mme_app_handle_initial_context_setup_rsp(
   OAILOG_FUNC_OUT(LOG_MME_APP);
 }
 
+//------------------------------------------------------------------------------
+// Releases the S1 signaling of a UE whose access bearers the SGW released
+static void _mme_app_release_access_bearers_done(
+  struct ue_mm_context_s *const ue_context_p)
+{
+  // Send UE Context Release Command
+  mme_app_itti_ue_context_release(
+    ue_context_p, ue_context_p->ue_context_rel_cause);
+  if (
+    ue_context_p->ue_context_rel_cause == S1AP_SCTP_SHUTDOWN_OR_RESET ||
+    ue_context_p->ue_context_rel_cause ==
+      S1AP_INITIAL_CONTEXT_SETUP_TMR_EXPRD) {
+    // Just cleanup the MME APP state associated with s1.
+    mme_ue_context_update_ue_sig_connection_state(
+      &mme_app_desc.mme_ue_contexts, ue_context_p, ECM_IDLE);
+  }
+}
+
 //------------------------------------------------------------------------------
 void mme_app_handle_release_access_bearers_resp(
   const itti_s11_release_access_bearers_response_t
@@ -1282,21 +1340,48 @@ void mme_app_handle_release_access_bearers_resp(
    */
   update_mme_app_stats_s1u_bearer_sub();
 
-  // Send UE Context Release Command
-  mme_app_itti_ue_context_release(
-    ue_context_p, ue_context_p->ue_context_rel_cause);
-  if (
-    ue_context_p->ue_context_rel_cause == S1AP_SCTP_SHUTDOWN_OR_RESET ||
-    ue_context_p->ue_context_rel_cause ==
-      S1AP_INITIAL_CONTEXT_SETUP_TMR_EXPRD) {
-    // Just cleanup the MME APP state associated with s1.
-    mme_ue_context_update_ue_sig_connection_state(
-      &mme_app_desc.mme_ue_contexts, ue_context_p, ECM_IDLE);
-  }
+  _mme_app_release_access_bearers_done(ue_context_p);
   unlock_ue_contexts(ue_context_p);
   OAILOG_FUNC_OUT(LOG_MME_APP);
 }
 
+//------------------------------------------------------------------------------
+void mme_app_handle_release_access_bearers_bulk_resp(
+  const itti_s11_release_access_bearers_bulk_response_t *const bulk_rsp_p)
+{
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  struct ue_mm_context_s *ue_context_p = NULL;
+  uint32_t nb_released = 0;
+
+  MSC_LOG_RX_MESSAGE(
+    MSC_MMEAPP_MME,
+    MSC_S11_MME,
+    NULL,
+    0,
+    "0 RELEASE_ACCESS_BEARERS_BULK_RESPONSE num %u",
+    bulk_rsp_p->num_responses);
+  for (int i = 0; i < bulk_rsp_p->num_responses; i++) {
+    ue_context_p = mme_ue_context_exists_s11_teid(
+      &mme_app_desc.mme_ue_contexts, bulk_rsp_p->responses[i].teid);
+    if (ue_context_p == NULL) {
+      OAILOG_DEBUG(
+        LOG_MME_APP,
+        "We didn't find this teid in list of UE: %" PRIX32 "\n",
+        bulk_rsp_p->responses[i].teid);
+      continue;
+    }
+    nb_released++;
+    // Same handling as a single response, the cause may have changed since
+    _mme_app_release_access_bearers_done(ue_context_p);
+    unlock_ue_contexts(ue_context_p);
+  }
+  /*
+   * Updating statistics
+   */
+  update_mme_app_stats_s1u_bearer_sub_bulk(nb_released);
+  OAILOG_FUNC_OUT(LOG_MME_APP);
+}
+
 //------------------------------------------------------------------------------
 void mme_app_handle_s11_create_bearer_req(
   const itti_s11_create_bearer_request_t *const create_bearer_request_pP)
@@ -1820,43 +1905,38 @@ static bool mme_app_construct_guti(
     "from MME Conf: %u, %u \n",
     s_tmsi_p->m_tmsi,
     s_tmsi_p->mme_code);
-  mme_config_read_lock(&mme_config);
+  const mme_config_snapshot_t *config = mme_config_snapshot_get();
+  const gummei_config_t *gummei_config = &config->gummei;
   /*
    * Check number of MMEs in the pool.
    * At present it is assumed that one MME is supported in MME pool but in case there are more
    * than one MME configured then search the serving MME using MME code.
    * Assumption is that within one PLMN only one pool of MME will be configured
    */
-  if (mme_config.gummei.nb > 1) {
+  if (gummei_config->nb > 1) {
     OAILOG_DEBUG(LOG_MME_APP, "More than one MMEs are configured.");
   }
-  for (num_mme = 0; num_mme < mme_config.gummei.nb; num_mme++) {
+  for (num_mme = 0; num_mme < gummei_config->nb; num_mme++) {
     /*Verify that the MME code within S-TMSI is same as what is configured in MME conf*/
     if (
-      (plmn_p->mcc_digit2 ==
-       mme_config.gummei.gummei[num_mme].plmn.mcc_digit2) &&
-      (plmn_p->mcc_digit1 ==
-       mme_config.gummei.gummei[num_mme].plmn.mcc_digit1) &&
-      (plmn_p->mnc_digit3 ==
-       mme_config.gummei.gummei[num_mme].plmn.mnc_digit3) &&
-      (plmn_p->mcc_digit3 ==
-       mme_config.gummei.gummei[num_mme].plmn.mcc_digit3) &&
-      (plmn_p->mnc_digit2 ==
-       mme_config.gummei.gummei[num_mme].plmn.mnc_digit2) &&
-      (plmn_p->mnc_digit1 ==
-       mme_config.gummei.gummei[num_mme].plmn.mnc_digit1) &&
-      (guti_p->gummei.mme_code == mme_config.gummei.gummei[num_mme].mme_code)) {
+      (plmn_p->mcc_digit2 == gummei_config->gummei[num_mme].plmn.mcc_digit2) &&
+      (plmn_p->mcc_digit1 == gummei_config->gummei[num_mme].plmn.mcc_digit1) &&
+      (plmn_p->mnc_digit3 == gummei_config->gummei[num_mme].plmn.mnc_digit3) &&
+      (plmn_p->mcc_digit3 == gummei_config->gummei[num_mme].plmn.mcc_digit3) &&
+      (plmn_p->mnc_digit2 == gummei_config->gummei[num_mme].plmn.mnc_digit2) &&
+      (plmn_p->mnc_digit1 == gummei_config->gummei[num_mme].plmn.mnc_digit1) &&
+      (guti_p->gummei.mme_code == gummei_config->gummei[num_mme].mme_code)) {
       break;
     }
   }
-  if (num_mme >= mme_config.gummei.nb) {
+  if (num_mme >= gummei_config->nb) {
     OAILOG_DEBUG(LOG_MME_APP, "No MME serves this UE");
   } else {
-    guti_p->gummei.plmn = mme_config.gummei.gummei[num_mme].plmn;
-    guti_p->gummei.mme_gid = mme_config.gummei.gummei[num_mme].mme_gid;
+    guti_p->gummei.plmn = gummei_config->gummei[num_mme].plmn;
+    guti_p->gummei.mme_gid = gummei_config->gummei[num_mme].mme_gid;
     is_guti_valid = true;
   }
-  mme_config_unlock(&mme_config);
+  mme_config_snapshot_put(config);
   return is_guti_valid;
 }
 
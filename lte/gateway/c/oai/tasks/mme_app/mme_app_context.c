@@ -87,7 +87,8 @@ static void _mme_app_handle_s1ap_ue_context_release(
   const mme_ue_s1ap_id_t mme_ue_s1ap_id,
   const enb_ue_s1ap_id_t enb_ue_s1ap_id,
   uint32_t enb_id,
-  enum s1cause cause);
+  enum s1cause cause,
+  mme_app_s11_bulk_release_t *const bulk);
 
 static void _directoryd_report_location(uint64_t imsi, uint8_t imsi_len)
 {
@@ -2043,7 +2044,8 @@ void mme_app_handle_s1ap_ue_context_release_req(
     s1ap_ue_context_release_req->mme_ue_s1ap_id,
     s1ap_ue_context_release_req->enb_ue_s1ap_id,
     s1ap_ue_context_release_req->enb_id,
-    s1ap_ue_context_release_req->relCause);
+    s1ap_ue_context_release_req->relCause,
+    NULL);
 }
 
 void mme_app_handle_s1ap_ue_context_modification_fail(
@@ -2134,13 +2136,18 @@ void mme_app_handle_s1ap_ue_context_modification_resp(
 void mme_app_handle_enb_deregister_ind(
   const itti_s1ap_eNB_deregistered_ind_t const *eNB_deregistered_ind)
 {
+  mme_app_s11_bulk_release_t bulk = {0};
+
+  // Group the S11 signaling of all the UEs per SGW
   for (int i = 0; i < eNB_deregistered_ind->nb_ue_to_deregister; i++) {
     _mme_app_handle_s1ap_ue_context_release(
       eNB_deregistered_ind->mme_ue_s1ap_id[i],
       eNB_deregistered_ind->enb_ue_s1ap_id[i],
       eNB_deregistered_ind->enb_id,
-      S1AP_SCTP_SHUTDOWN_OR_RESET);
+      S1AP_SCTP_SHUTDOWN_OR_RESET,
+      &bulk);
   }
+  mme_app_s11_bulk_release_flush(&bulk);
 }
 
 //------------------------------------------------------------------------------
@@ -2148,6 +2155,7 @@ void mme_app_handle_enb_reset_req(
   const itti_s1ap_enb_initiated_reset_req_t const *enb_reset_req)
 {
   MessageDef *message_p;
+  mme_app_s11_bulk_release_t bulk = {0};
   OAILOG_DEBUG(
     LOG_MME_APP,
     " eNB Reset request received. eNB id = %d, reset_type  %d \n ",
@@ -2161,7 +2169,8 @@ void mme_app_handle_enb_reset_req(
         *(enb_reset_req->ue_to_reset_list[i].mme_ue_s1ap_id),
         *(enb_reset_req->ue_to_reset_list[i].enb_ue_s1ap_id),
         enb_reset_req->enb_id,
-        S1AP_SCTP_SHUTDOWN_OR_RESET);
+        S1AP_SCTP_SHUTDOWN_OR_RESET,
+        &bulk);
     }
 
   } else { // Partial Reset
@@ -2175,9 +2184,11 @@ void mme_app_handle_enb_reset_req(
           *(enb_reset_req->ue_to_reset_list[i].mme_ue_s1ap_id),
           *(enb_reset_req->ue_to_reset_list[i].enb_ue_s1ap_id),
           enb_reset_req->enb_id,
-          S1AP_SCTP_SHUTDOWN_OR_RESET);
+          S1AP_SCTP_SHUTDOWN_OR_RESET,
+          &bulk);
     }
   }
+  mme_app_s11_bulk_release_flush(&bulk);
   // Send Reset Ack to S1AP module
 
   message_p =
@@ -2345,7 +2356,8 @@ static void _mme_app_handle_s1ap_ue_context_release(
   const mme_ue_s1ap_id_t mme_ue_s1ap_id,
   const enb_ue_s1ap_id_t enb_ue_s1ap_id,
   uint32_t enb_id,
-  enum s1cause cause)
+  enum s1cause cause,
+  mme_app_s11_bulk_release_t *const bulk)
 //------------------------------------------------------------------------------
 {
   struct ue_mm_context_s *ue_mm_context = NULL;
@@ -2474,7 +2486,11 @@ static void _mme_app_handle_s1ap_ue_context_release(
     // release S1-U tunnel mapping in S_GW for all the active bearers for the UE
     for (pdn_cid_t i = 0; i < MAX_APN_PER_UE; i++) {
       if (ue_mm_context->pdn_contexts[i]) {
-        mme_app_send_s11_release_access_bearers_req(ue_mm_context, i);
+        if (bulk) {
+          mme_app_s11_bulk_release_add(bulk, ue_mm_context, i);
+        } else {
+          mme_app_send_s11_release_access_bearers_req(ue_mm_context, i);
+        }
       }
     }
   }
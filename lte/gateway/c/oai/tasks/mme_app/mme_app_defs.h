@@ -78,6 +78,14 @@ void mme_app_handle_conn_est_cnf(
 void mme_app_handle_initial_ue_message(
   itti_s1ap_initial_ue_message_t *const conn_est_ind_pP);
 
+/*
+ * Returns the id of the UE an Initial UE Message is for: the one of its
+ * S-TMSI when known, otherwise a new id, also stored in the message so that
+ * mme_app_handle_initial_ue_message() creates the UE context with it.
+ */
+mme_ue_s1ap_id_t mme_app_initial_ue_message_assign_ue_id(
+  itti_s1ap_initial_ue_message_t *const initial_pP);
+
 int mme_app_handle_create_sess_resp(
   itti_s11_create_session_response_t *const
     create_sess_resp_pP); //not const because we need to free internal stucts
@@ -98,6 +106,9 @@ void mme_app_handle_release_access_bearers_resp(
   const itti_s11_release_access_bearers_response_t
     *const rel_access_bearers_rsp_pP);
 
+void mme_app_handle_release_access_bearers_bulk_resp(
+  const itti_s11_release_access_bearers_bulk_response_t *const bulk_rsp_p);
+
 void mme_app_handle_s11_create_bearer_req(
   const itti_s11_create_bearer_request_t *const create_bearer_request_pP);
 
@@ -260,6 +271,8 @@ int mme_app_handle_sgsap_service_abort_request(
 void mme_app_handle_modify_ue_ambr_request(
   const itti_s11_modify_ue_ambr_request_t *const modify_ue_ambr_request_p);
 
+void mme_app_handle_itti_message(MessageDef *received_message_p);
+
 #define mme_stats_read_lock(mMEsTATS)                                          \
   pthread_rwlock_rdlock(&(mMEsTATS)->rw_lock)
 #define mme_stats_write_lock(mMEsTATS)                                         \
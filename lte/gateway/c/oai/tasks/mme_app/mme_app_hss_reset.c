@@ -30,75 +30,342 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "assertions.h"
 #include "common_types.h"
 #include "common_defs.h"
 #include "conversions.h"
+#include "dynamic_memory_check.h"
 #include "msc.h"
 #include "log.h"
 #include "intertask_interface.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
+#include "mme_app_hss_reset.h"
 #include "mme_config.h"
 #include "timer.h"
 
-int mme_app_handle_s6a_reset_req(const s6a_reset_req_t *const rsr_pP)
+#define MME_APP_USEC_PER_SEC 1000000ULL
+
+static mme_app_hss_reset_sweep_t _hss_reset_sweep = {0};
+
+//------------------------------------------------------------------------------
+static uint64_t _mme_app_hss_reset_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * MME_APP_USEC_PER_SEC) + (ts.tv_nsec / 1000);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_token_bucket_init(
+  mme_app_token_bucket_t *const bucket,
+  uint32_t rate,
+  uint32_t burst,
+  uint64_t now_usec)
+{
+  bucket->rate = rate;
+  bucket->burst = burst;
+  bucket->tokens_usec = (uint64_t) burst * MME_APP_USEC_PER_SEC;
+  bucket->last_refill_usec = now_usec;
+}
+
+//------------------------------------------------------------------------------
+uint32_t mme_app_token_bucket_take(
+  mme_app_token_bucket_t *const bucket,
+  uint64_t now_usec,
+  uint32_t wanted)
+{
+  const uint64_t depth = (uint64_t) bucket->burst * MME_APP_USEC_PER_SEC;
+  uint64_t available = 0;
+
+  if (now_usec > bucket->last_refill_usec) {
+    bucket->tokens_usec +=
+      (now_usec - bucket->last_refill_usec) * (uint64_t) bucket->rate;
+    if (bucket->tokens_usec > depth) {
+      bucket->tokens_usec = depth;
+    }
+    bucket->last_refill_usec = now_usec;
+  }
+  available = bucket->tokens_usec / MME_APP_USEC_PER_SEC;
+  if (wanted > available) {
+    wanted = (uint32_t) available;
+  }
+  bucket->tokens_usec -= (uint64_t) wanted * MME_APP_USEC_PER_SEC;
+  return wanted;
+}
+
+//------------------------------------------------------------------------------
+static void _mme_app_hss_reset_ulr_enqueue(
+  mme_app_hss_reset_sweep_t *const sweep,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id)
+{
+  if (sweep->ulr_queue_tail == sweep->ulr_queue_size) {
+    if (sweep->ulr_queue_head) {
+      // Reuse the room left by the UEs already dequeued
+      memmove(
+        sweep->ulr_queue,
+        &sweep->ulr_queue[sweep->ulr_queue_head],
+        (sweep->ulr_queue_tail - sweep->ulr_queue_head) *
+          sizeof(mme_ue_s1ap_id_t));
+      sweep->ulr_queue_tail -= sweep->ulr_queue_head;
+      sweep->ulr_queue_head = 0;
+    }
+    if (sweep->ulr_queue_tail == sweep->ulr_queue_size) {
+      uint32_t size = sweep->ulr_queue_size ? 2 * sweep->ulr_queue_size :
+                                              MME_APP_HSS_RESET_SWEEP_SLICE;
+      mme_ue_s1ap_id_t *queue =
+        realloc(sweep->ulr_queue, size * sizeof(mme_ue_s1ap_id_t));
+      if (!queue) {
+        OAILOG_ERROR(
+          LOG_MME_APP,
+          "Cannot queue ULR for UE " MME_UE_S1AP_ID_FMT " after HSS reset\n",
+          mme_ue_s1ap_id);
+        return;
+      }
+      sweep->ulr_queue = queue;
+      sweep->ulr_queue_size = size;
+    }
+  }
+  sweep->ulr_queue[sweep->ulr_queue_tail++] = mme_ue_s1ap_id;
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_hss_reset_ulr_dequeue(
+  mme_app_hss_reset_sweep_t *const sweep,
+  mme_ue_s1ap_id_t *const mme_ue_s1ap_id)
+{
+  if (sweep->ulr_queue_head == sweep->ulr_queue_tail) {
+    sweep->ulr_queue_head = 0;
+    sweep->ulr_queue_tail = 0;
+    return false;
+  }
+  *mme_ue_s1ap_id = sweep->ulr_queue[sweep->ulr_queue_head++];
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_hss_reset_sweep_start(
+  mme_app_hss_reset_sweep_t *const sweep,
+  uint64_t now_usec)
+{
+  sweep->in_progress = true;
+  sweep->next_bucket = 0;
+  // A new sweep queues every connected UE again
+  sweep->ulr_queue_head = 0;
+  sweep->ulr_queue_tail = 0;
+  mme_app_token_bucket_init(
+    &sweep->ulr_pacer,
+    MME_APP_HSS_RESET_ULR_RATE,
+    MME_APP_HSS_RESET_ULR_BURST,
+    now_usec);
+}
+
+//------------------------------------------------------------------------------
+static void _mme_app_hss_reset_ue(
+  mme_app_hss_reset_sweep_t *const sweep,
+  struct ue_mm_context_s *const ue_context_p)
+{
+  if (ue_context_p->mm_state != UE_REGISTERED) {
+    return;
+  }
+  /*
+   * set the flag: location_info_confirmed_in_hss to indicate that,
+   * hss has restarted and MME shall send ULR to hss
+   */
+  ue_context_p->location_info_confirmed_in_hss = true;
+  /*
+   * set the sgs context flag: neaf to indicate that,
+   * hss has restarted and MME shall send SGS Ue Activity Indication to MSC/VLR
+   * to indicate that activity from a UE has been detected
+   */
+  if (ue_context_p->sgs_context != NULL) {
+    ue_context_p->sgs_context->neaf = true;
+  }
+  if (ue_context_p->ecm_state == ECM_CONNECTED) {
+    /*
+     * hss has restarted and MME shall send ULR to hss for connected Ue,
+     * idle UEs send it on their next service request
+     */
+    _mme_app_hss_reset_ulr_enqueue(sweep, ue_context_p->mme_ue_s1ap_id);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint32_t mme_app_hss_reset_sweep_slice(
+  mme_app_hss_reset_sweep_t *const sweep,
+  hash_table_ts_t *const hashtblP,
+  uint32_t max_ues)
 {
-  int rc = RETURNok;
   struct ue_mm_context_s *ue_context_p = NULL;
   hash_node_t *node = NULL;
-  unsigned int i = 0;
-  unsigned int num_elements = 0;
-  hash_table_ts_t *hashtblP = NULL;
+  uint32_t visited = 0;
+  uint32_t nb_keys = 0;
+
+  while (sweep->in_progress && (visited < max_ues)) {
+    if (sweep->next_bucket >= hashtblP->size) {
+      sweep->in_progress = false;
+      break;
+    }
+    /*
+     * Only copy the keys under the bucket lock: UE contexts are locked before
+     * hashtable buckets everywhere else.
+     */
+    nb_keys = 0;
+    pthread_mutex_lock(&hashtblP->lock_nodes[sweep->next_bucket]);
+    for (node = hashtblP->nodes[sweep->next_bucket]; node; node = node->next) {
+      if (nb_keys == sweep->keys_size) {
+        uint32_t size = sweep->keys_size ? 2 * sweep->keys_size : 16;
+        hash_key_t *keys = realloc(sweep->keys, size * sizeof(hash_key_t));
+        if (!keys) {
+          break;
+        }
+        sweep->keys = keys;
+        sweep->keys_size = size;
+      }
+      sweep->keys[nb_keys++] = node->key;
+    }
+    if (node) {
+      /*
+       * Out of memory: the whole bucket is visited again on the next slice,
+       * none of its UEs may be left without the reset handling
+       */
+      pthread_mutex_unlock(&hashtblP->lock_nodes[sweep->next_bucket]);
+      OAILOG_ERROR(
+        LOG_MME_APP,
+        "Failed to grow HSS reset sweep keys past %u, retrying bucket %u\n",
+        sweep->keys_size,
+        sweep->next_bucket);
+      break;
+    }
+    pthread_mutex_unlock(&hashtblP->lock_nodes[sweep->next_bucket]);
+    sweep->next_bucket++;
+
+    for (uint32_t k = 0; k < nb_keys; k++) {
+      ue_context_p = NULL;
+      hashtable_ts_get(hashtblP, sweep->keys[k], (void **) &ue_context_p);
+      if (ue_context_p) {
+        lock_ue_contexts(ue_context_p);
+        _mme_app_hss_reset_ue(sweep, ue_context_p);
+        unlock_ue_contexts(ue_context_p);
+      }
+    }
+    visited += nb_keys;
+  }
+  return visited;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_hss_reset_sweep_free(mme_app_hss_reset_sweep_t *const sweep)
+{
+  free_wrapper((void **) &sweep->ulr_queue);
+  free_wrapper((void **) &sweep->keys);
+  memset(sweep, 0, sizeof(*sweep));
+}
+
+//------------------------------------------------------------------------------
+static void _mme_app_hss_reset_send_ulrs(
+  mme_app_hss_reset_sweep_t *const sweep,
+  uint32_t tokens)
+{
+  struct ue_mm_context_s *ue_context_p = NULL;
+  mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
+
+  while (tokens && mme_app_hss_reset_ulr_dequeue(sweep, &mme_ue_s1ap_id)) {
+    ue_context_p = mme_ue_context_exists_mme_ue_s1ap_id(
+      &mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id);
+    if (!ue_context_p) {
+      continue;
+    }
+    /*
+     * The UE may have gone idle, detached or already refreshed its location
+     * since it was queued; only the ones still waiting consume a token.
+     */
+    if (
+      (ue_context_p->mm_state == UE_REGISTERED) &&
+      (ue_context_p->ecm_state == ECM_CONNECTED) &&
+      ue_context_p->location_info_confirmed_in_hss) {
+      mme_app_send_s6a_update_location_req(ue_context_p);
+      tokens--;
+    }
+    unlock_ue_contexts(ue_context_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_app_handle_hss_reset_timer_expiry(void)
+{
+  mme_app_hss_reset_sweep_t *sweep = &_hss_reset_sweep;
+  hash_table_ts_t *hashtblP =
+    mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl;
 
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  if (sweep->in_progress && hashtblP) {
+    mme_app_hss_reset_sweep_slice(
+      sweep, hashtblP, MME_APP_HSS_RESET_SWEEP_SLICE);
+  }
+  if (sweep->ulr_queue_head != sweep->ulr_queue_tail) {
+    _mme_app_hss_reset_send_ulrs(
+      sweep,
+      mme_app_token_bucket_take(
+        &sweep->ulr_pacer,
+        _mme_app_hss_reset_now_usec(),
+        sweep->ulr_queue_tail - sweep->ulr_queue_head));
+  }
+
+  if (!sweep->in_progress && (sweep->ulr_queue_head == sweep->ulr_queue_tail)) {
+    OAILOG_INFO(LOG_MME_APP, "HSS reset handling complete\n");
+    timer_remove(mme_app_desc.hss_reset_timer_id, NULL);
+    mme_app_desc.hss_reset_timer_id = 0;
+    mme_app_hss_reset_sweep_free(sweep);
+  }
+  OAILOG_FUNC_OUT(LOG_MME_APP);
+}
+
+//------------------------------------------------------------------------------
+int mme_app_handle_s6a_reset_req(const s6a_reset_req_t *const rsr_pP)
+{
   OAILOG_FUNC_IN(LOG_MME_APP);
   DevAssert(rsr_pP);
 
   OAILOG_DEBUG(LOG_MME_APP, "%s S6a Reset Request recieved \n", __FUNCTION__);
 
-  hashtblP = mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl;
-  if (!hashtblP) {
+  if (!mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl) {
     OAILOG_INFO(LOG_MME_APP, "There is no Ue Context in the MME context \n");
     OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
   }
-  while ((num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-      pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    }
-    while (node) {
-      num_elements++;
-      hashtable_ts_get(
-        hashtblP, (const hash_key_t) node->key, (void **) &ue_context_p);
-      if (ue_context_p != NULL) {
-        if (ue_context_p->mm_state == UE_REGISTERED) {
-          /*
-          * set the flag: location_info_confirmed_in_hss to indicate that,
-          * hss has restarted and MME shall send ULR to hss
-          */
-          ue_context_p->location_info_confirmed_in_hss = true;
-          /*
-          * set the sgs context flag: neaf to indicate that,
-          * hss has restarted and MME shall send SGS Ue Activity Indication to MSC/VLR
-          * to indicate that activity from a UE has been detected
-          */
-          if (ue_context_p->sgs_context != NULL) {
-            ue_context_p->sgs_context->neaf = true;
-          }
-
-          if (ue_context_p->ecm_state == ECM_CONNECTED) {
-            /*
-            * hss has restarted and MME shall send ULR to hss for connected Ue
-            */
-            rc = mme_app_send_s6a_update_location_req(ue_context_p);
-          }
-        }
-      }
-      node = node->next;
-    }
-    i++;
+  /*
+   * The UE table is swept in slices from a periodic timer so that MME_APP
+   * keeps serving other messages, and the resulting ULRs are paced.
+   */
+  mme_app_hss_reset_sweep_start(
+    &_hss_reset_sweep, _mme_app_hss_reset_now_usec());
+  if (mme_app_desc.hss_reset_timer_id) {
+    OAILOG_INFO(
+      LOG_MME_APP, "HSS reset received during a sweep, restarting it\n");
+    OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
+  }
+  if (
+    timer_setup(
+      0,
+      MME_APP_HSS_RESET_TICK_USEC,
+      TASK_MME_APP,
+      INSTANCE_DEFAULT,
+      TIMER_PERIODIC,
+      NULL,
+      0,
+      &mme_app_desc.hss_reset_timer_id) < 0) {
+    OAILOG_ERROR(
+      LOG_MME_APP, "Failed to start HSS reset sweep timer, sweeping at once\n");
+    mme_app_desc.hss_reset_timer_id = 0;
+    mme_app_hss_reset_sweep_slice(
+      &_hss_reset_sweep,
+      mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl,
+      UINT32_MAX);
+    _mme_app_hss_reset_send_ulrs(&_hss_reset_sweep, UINT32_MAX);
+    mme_app_hss_reset_sweep_free(&_hss_reset_sweep);
   }
-  OAILOG_FUNC_RETURN(LOG_MME_APP, rc);
+  OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
 }
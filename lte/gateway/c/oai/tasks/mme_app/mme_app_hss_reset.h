@@ -0,0 +1,105 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_hss_reset.h
+  \brief Incremental UE sweep and ULR pacing triggered by an S6a Reset Request
+*/
+
+#ifndef FILE_MME_APP_HSS_RESET_SEEN
+#define FILE_MME_APP_HSS_RESET_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hashtable.h"
+#include "3gpp_36.401.h"
+
+/* The sweep runs from a periodic MME_APP timer: every tick visits at most
+ * MME_APP_HSS_RESET_SWEEP_SLICE UE contexts and sends the ULRs allowed by the
+ * token bucket, so other MME_APP messages queued behind a tick wait for one
+ * slice instead of the whole UE table. */
+#define MME_APP_HSS_RESET_TICK_USEC 10000
+#define MME_APP_HSS_RESET_SWEEP_SLICE 1000
+#define MME_APP_HSS_RESET_ULR_RATE 500 // ULR per second
+#define MME_APP_HSS_RESET_ULR_BURST 50
+
+typedef struct mme_app_token_bucket_s {
+  uint32_t rate;  // tokens per second
+  uint32_t burst; // bucket depth
+  uint64_t tokens_usec; // available tokens, scaled by 10^6
+  uint64_t last_refill_usec;
+} mme_app_token_bucket_t;
+
+typedef struct mme_app_hss_reset_sweep_s {
+  bool in_progress;
+  hash_size_t next_bucket; // next bucket of mme_ue_s1ap_id_ue_context_htbl
+  hash_key_t *keys;        // scratch copy of the keys of one bucket
+  uint32_t keys_size;
+  /* FIFO of connected UEs that still owe a ULR to the HSS */
+  mme_ue_s1ap_id_t *ulr_queue;
+  uint32_t ulr_queue_head;
+  uint32_t ulr_queue_tail;
+  uint32_t ulr_queue_size;
+  mme_app_token_bucket_t ulr_pacer;
+} mme_app_hss_reset_sweep_t;
+
+void mme_app_token_bucket_init(
+  mme_app_token_bucket_t *const bucket,
+  uint32_t rate,
+  uint32_t burst,
+  uint64_t now_usec);
+
+/** \brief Take up to wanted tokens from the bucket
+ * @returns the number of tokens granted
+ **/
+uint32_t mme_app_token_bucket_take(
+  mme_app_token_bucket_t *const bucket,
+  uint64_t now_usec,
+  uint32_t wanted);
+
+/** \brief (Re)start the sweep from the first bucket, dropping pending ULRs
+ **/
+void mme_app_hss_reset_sweep_start(
+  mme_app_hss_reset_sweep_t *const sweep,
+  uint64_t now_usec);
+
+/** \brief Visit about max_ues UE contexts of hashtblP, always finishing the
+ * last bucket started: mark registered UEs for a location update towards the
+ * restarted HSS and queue the connected ones for a ULR.
+ * @returns the number of UE contexts visited
+ **/
+uint32_t mme_app_hss_reset_sweep_slice(
+  mme_app_hss_reset_sweep_t *const sweep,
+  hash_table_ts_t *const hashtblP,
+  uint32_t max_ues);
+
+/** \brief Pop the next UE waiting for a ULR
+ * @returns false when the queue is empty
+ **/
+bool mme_app_hss_reset_ulr_dequeue(
+  mme_app_hss_reset_sweep_t *const sweep,
+  mme_ue_s1ap_id_t *const mme_ue_s1ap_id);
+
+void mme_app_hss_reset_sweep_free(mme_app_hss_reset_sweep_t *const sweep);
+
+void mme_app_handle_hss_reset_timer_expiry(void);
+
+#endif /* FILE_MME_APP_HSS_RESET_SEEN */
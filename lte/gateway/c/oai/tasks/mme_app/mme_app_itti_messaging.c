@@ -126,6 +126,78 @@ int mme_app_send_s11_release_access_bearers_req(
   OAILOG_FUNC_RETURN(LOG_MME_APP, rc);
 }
 
+//------------------------------------------------------------------------------
+static void _mme_app_s11_bulk_release_send(
+  mme_app_s11_bulk_release_t *const bulk,
+  const uint32_t index)
+{
+  MessageDef *message_p = bulk->message_p[index];
+
+  MSC_LOG_TX_MESSAGE(
+    MSC_MMEAPP_MME,
+    MSC_S11_MME,
+    NULL,
+    0,
+    "0 S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST num %u",
+    S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST(message_p).num_requests);
+  itti_send_msg_to_task(TASK_SPGW, INSTANCE_DEFAULT, message_p);
+  bulk->message_p[index] = bulk->message_p[--bulk->nb_sgw];
+  bulk->message_p[bulk->nb_sgw] = NULL;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_s11_bulk_release_add(
+  mme_app_s11_bulk_release_t *const bulk,
+  struct ue_mm_context_s *const ue_mm_context,
+  const pdn_cid_t pdn_index)
+{
+  pdn_context_t *pdn_connection = ue_mm_context->pdn_contexts[pdn_index];
+  struct in_addr peer_ip =
+    pdn_connection->s_gw_address_s11_s4.address.ipv4_address;
+  itti_s11_release_access_bearers_bulk_request_t *bulk_req_p = NULL;
+  uint32_t index = 0;
+
+  OAILOG_FUNC_IN(LOG_MME_APP);
+  for (index = 0; index < bulk->nb_sgw; index++) {
+    if (
+      S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST(bulk->message_p[index])
+        .peer_ip.s_addr == peer_ip.s_addr) {
+      break;
+    }
+  }
+  if (index == bulk->nb_sgw) {
+    if (bulk->nb_sgw == MME_APP_S11_BULK_RELEASE_MAX_SGW) {
+      _mme_app_s11_bulk_release_send(bulk, 0);
+      index = bulk->nb_sgw;
+    }
+    bulk->message_p[index] = itti_alloc_new_message(
+      TASK_MME_APP, S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST);
+    DevAssert(bulk->message_p[index] != NULL);
+    S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST(bulk->message_p[index]).peer_ip =
+      peer_ip;
+    bulk->nb_sgw++;
+  }
+  bulk_req_p =
+    &S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST(bulk->message_p[index]);
+  bulk_req_p->requests[bulk_req_p->num_requests].local_teid =
+    ue_mm_context->mme_teid_s11;
+  bulk_req_p->requests[bulk_req_p->num_requests].teid =
+    pdn_connection->s_gw_teid_s11_s4;
+  bulk_req_p->num_requests++;
+  if (bulk_req_p->num_requests == S11_RELEASE_ACCESS_BEARERS_PER_BULK_MESSAGE) {
+    _mme_app_s11_bulk_release_send(bulk, index);
+  }
+  OAILOG_FUNC_OUT(LOG_MME_APP);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_s11_bulk_release_flush(mme_app_s11_bulk_release_t *const bulk)
+{
+  while (bulk->nb_sgw) {
+    _mme_app_s11_bulk_release_send(bulk, bulk->nb_sgw - 1);
+  }
+}
+
 //------------------------------------------------------------------------------
 int mme_app_send_s11_create_session_req(
   struct ue_mm_context_s *const ue_mm_context,
@@ -43,6 +43,20 @@ int mme_app_send_s11_create_session_req(
   struct ue_mm_context_s *const ue_mm_context,
   const pdn_cid_t pdn_cid);
 
+/* Release Access Bearers Requests collected while releasing all the UEs of an
+ * eNB, one pending bulk message per SGW */
+#define MME_APP_S11_BULK_RELEASE_MAX_SGW 8
+typedef struct mme_app_s11_bulk_release_s {
+  uint32_t nb_sgw;
+  MessageDef *message_p[MME_APP_S11_BULK_RELEASE_MAX_SGW];
+} mme_app_s11_bulk_release_t;
+
+void mme_app_s11_bulk_release_add(
+  mme_app_s11_bulk_release_t *const bulk,
+  struct ue_mm_context_s *const ue_mm_context,
+  const pdn_cid_t pdn_index);
+void mme_app_s11_bulk_release_flush(mme_app_s11_bulk_release_t *const bulk);
+
 static inline void mme_app_itti_ue_context_mod_for_csfb(
   struct ue_mm_context_s *ue_context_p)
 {
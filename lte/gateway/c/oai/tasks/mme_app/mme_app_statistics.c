@@ -157,6 +157,18 @@ void update_mme_app_stats_s1u_bearer_sub(void)
   mme_stats_unlock(&mme_app_desc);
   return;
 }
+void update_mme_app_stats_s1u_bearer_sub_bulk(uint32_t nb_bearers)
+{
+  if (!nb_bearers) return;
+  mme_stats_write_lock(&mme_app_desc);
+  if (mme_app_desc.nb_s1u_bearers > nb_bearers)
+    mme_app_desc.nb_s1u_bearers -= nb_bearers;
+  else
+    mme_app_desc.nb_s1u_bearers = 0;
+  mme_app_desc.nb_s1u_bearers_released_since_last_stat += nb_bearers;
+  mme_stats_unlock(&mme_app_desc);
+  return;
+}
 
 /*****************************************************/
 // Number of Default EPS Bearers
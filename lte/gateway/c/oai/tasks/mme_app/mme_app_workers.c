@@ -0,0 +1,386 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_workers.c
+  \brief UE sharded processing of the MME_APP and NAS tasks, see
+  mme_app_workers.h.
+*/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "conversions.h"
+#include "intertask_interface.h"
+#include "itti_workers.h"
+#include "mme_config.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "nas_defs.h"
+#include "nas_timer.h"
+#include "timer.h"
+#include "mme_app_workers.h"
+
+static itti_workers_t *mme_app_workers = NULL;
+// Held for reading while dispatching, for writing while stopping the workers
+static pthread_rwlock_t mme_app_workers_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+//------------------------------------------------------------------------------
+static void mme_app_workers_handle_message(MessageDef *message_p)
+{
+  if (ITTI_MSG_DESTINATION_ID(message_p) == TASK_NAS_MME) {
+    nas_handle_itti_message(message_p);
+  } else {
+    mme_app_handle_itti_message(message_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool mme_app_workers_get_imsi_ue_id(
+  const char *const imsi,
+  mme_ue_s1ap_id_t *const ue_id)
+{
+  imsi64_t imsi64 = INVALID_IMSI64;
+  uint64_t mme_ue_s1ap_id64 = 0;
+
+  if ((!imsi) || (IMSI_STRING_TO_IMSI64(imsi, &imsi64) != 1)) {
+    return false;
+  }
+  if (
+    hashtable_uint64_ts_get(
+      mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl,
+      (const hash_key_t) imsi64,
+      &mme_ue_s1ap_id64) != HASH_TABLE_OK) {
+    return false;
+  }
+  *ue_id = (mme_ue_s1ap_id_t) mme_ue_s1ap_id64;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool mme_app_workers_get_s11_teid_ue_id(
+  const teid_t teid,
+  mme_ue_s1ap_id_t *const ue_id)
+{
+  uint64_t mme_ue_s1ap_id64 = 0;
+
+  if (
+    hashtable_uint64_ts_get(
+      mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl,
+      (const hash_key_t) teid,
+      &mme_ue_s1ap_id64) != HASH_TABLE_OK) {
+    return false;
+  }
+  *ue_id = (mme_ue_s1ap_id_t) mme_ue_s1ap_id64;
+  return true;
+}
+
+/*
+ * The NAS timers save the UE they have been started for with their callback,
+ * the UE timers of MME_APP save the mme_ue_s1ap_id. The argument of the
+ * expiry message is freed if the worker of the UE stops the timer meanwhile,
+ * so it is copied from the timer, if still running.
+ */
+//------------------------------------------------------------------------------
+static bool mme_app_workers_get_timer_ue_id(
+  MessageDef *message_p,
+  mme_ue_s1ap_id_t *const ue_id)
+{
+  const long timer_id = TIMER_HAS_EXPIRED(message_p).timer_id;
+  nas_itti_timer_arg_t nas_timer_arg = {0};
+
+  if (ITTI_MSG_DESTINATION_ID(message_p) == TASK_NAS_MME) {
+    if (timer_copy_arg(timer_id, &nas_timer_arg, sizeof(nas_timer_arg))) {
+      return false;
+    }
+    *ue_id = nas_timer_arg.ue_id;
+  } else if (timer_copy_arg(timer_id, ue_id, sizeof(*ue_id))) {
+    // Global timer (statistics, HSS reset) or already stopped
+    return false;
+  }
+  return (*ue_id != INVALID_MME_UE_S1AP_ID);
+}
+
+/*
+ * Find the UE a message is for. Returns false for the global messages and for
+ * the ones whose UE is unknown, they are run as a barrier.
+ */
+//------------------------------------------------------------------------------
+static bool mme_app_workers_get_ue_id(
+  MessageDef *message_p,
+  mme_ue_s1ap_id_t *const ue_id)
+{
+  *ue_id = INVALID_MME_UE_S1AP_ID;
+
+  switch (ITTI_MSG_ID(message_p)) {
+    /*
+     * Messages carrying the mme_ue_s1ap_id
+     */
+    case MME_APP_INITIAL_CONTEXT_SETUP_RSP:
+      *ue_id = message_p->ittiMsg.mme_app_initial_context_setup_rsp.ue_id;
+      break;
+    case MME_APP_INITIAL_CONTEXT_SETUP_FAILURE:
+      *ue_id =
+        message_p->ittiMsg.mme_app_initial_context_setup_failure.mme_ue_s1ap_id;
+      break;
+    case MME_APP_CREATE_DEDICATED_BEARER_REQ:
+      *ue_id = message_p->ittiMsg.mme_app_create_dedicated_bearer_req.ue_id;
+      break;
+    case MME_APP_CREATE_DEDICATED_BEARER_RSP:
+      *ue_id = message_p->ittiMsg.mme_app_create_dedicated_bearer_rsp.ue_id;
+      break;
+    case MME_APP_CREATE_DEDICATED_BEARER_REJ:
+      *ue_id = message_p->ittiMsg.mme_app_create_dedicated_bearer_rej.ue_id;
+      break;
+    case NAS_CONNECTION_ESTABLISHMENT_CNF:
+      *ue_id = message_p->ittiMsg.nas_conn_est_cnf.ue_id;
+      break;
+    case NAS_DETACH_REQ:
+      *ue_id = message_p->ittiMsg.nas_detach_req.ue_id;
+      break;
+    case NAS_ERAB_SETUP_REQ:
+      *ue_id = message_p->ittiMsg.itti_erab_setup_req.ue_id;
+      break;
+    case NAS_PDN_CONFIG_REQ:
+      *ue_id = message_p->ittiMsg.nas_pdn_config_req.ue_id;
+      break;
+    case NAS_PDN_CONFIG_RSP:
+      *ue_id = message_p->ittiMsg.nas_pdn_config_rsp.ue_id;
+      break;
+    case NAS_PDN_CONNECTIVITY_REQ:
+      *ue_id = message_p->ittiMsg.nas_pdn_connectivity_req.ue_id;
+      break;
+    case NAS_PDN_CONNECTIVITY_RSP:
+      *ue_id = message_p->ittiMsg.nas_pdn_connectivity_rsp.ue_id;
+      break;
+    case NAS_PDN_CONNECTIVITY_FAIL:
+      *ue_id = message_p->ittiMsg.nas_pdn_connectivity_fail.ue_id;
+      break;
+    case NAS_UPLINK_DATA_IND:
+      *ue_id = message_p->ittiMsg.nas_ul_data_ind.ue_id;
+      break;
+    case NAS_DOWNLINK_DATA_REQ:
+      *ue_id = message_p->ittiMsg.nas_dl_data_req.ue_id;
+      break;
+    case NAS_DOWNLINK_DATA_CNF:
+      *ue_id = message_p->ittiMsg.nas_dl_data_cnf.ue_id;
+      break;
+    case NAS_DOWNLINK_DATA_REJ:
+      *ue_id = message_p->ittiMsg.nas_dl_data_rej.ue_id;
+      break;
+    case NAS_EXTENDED_SERVICE_REQ:
+      *ue_id = message_p->ittiMsg.nas_extended_service_req.ue_id;
+      break;
+    case NAS_SGS_DETACH_REQ:
+      *ue_id = message_p->ittiMsg.nas_sgs_detach_req.ue_id;
+      break;
+    case NAS_IMPLICIT_DETACH_UE_IND:
+      *ue_id = message_p->ittiMsg.nas_implicit_detach_ue_ind.ue_id;
+      break;
+    case NAS_NW_INITIATED_DETACH_UE_REQ:
+      *ue_id = message_p->ittiMsg.nas_nw_initiated_detach_ue_req.ue_id;
+      break;
+    case NAS_CS_DOMAIN_LOCATION_UPDATE_REQ:
+      *ue_id = message_p->ittiMsg.nas_cs_domain_location_update_req.ue_id;
+      break;
+    case NAS_CS_DOMAIN_LOCATION_UPDATE_ACC:
+      *ue_id = message_p->ittiMsg.nas_cs_domain_location_update_acc.ue_id;
+      break;
+    case NAS_CS_DOMAIN_LOCATION_UPDATE_FAIL:
+      *ue_id = message_p->ittiMsg.nas_cs_domain_location_update_fail.ue_id;
+      break;
+    case NAS_CS_SERVICE_NOTIFICATION:
+      *ue_id = message_p->ittiMsg.nas_cs_service_notification.ue_id;
+      break;
+    case NAS_NOTIFY_SERVICE_REJECT:
+      *ue_id = message_p->ittiMsg.nas_notify_service_reject.ue_id;
+      break;
+    case NAS_TAU_COMPLETE:
+      *ue_id = message_p->ittiMsg.nas_tau_complete.ue_id;
+      break;
+    case S1AP_E_RAB_SETUP_RSP:
+      *ue_id = message_p->ittiMsg.s1ap_e_rab_setup_rsp.mme_ue_s1ap_id;
+      break;
+    case S1AP_UE_CAPABILITIES_IND:
+      *ue_id = message_p->ittiMsg.s1ap_ue_cap_ind.mme_ue_s1ap_id;
+      break;
+    case S1AP_UE_CONTEXT_RELEASE_REQ:
+      *ue_id = message_p->ittiMsg.s1ap_ue_context_release_req.mme_ue_s1ap_id;
+      break;
+    case S1AP_UE_CONTEXT_RELEASE_COMPLETE:
+      *ue_id =
+        message_p->ittiMsg.s1ap_ue_context_release_complete.mme_ue_s1ap_id;
+      break;
+    case S1AP_UE_CONTEXT_MODIFICATION_RESPONSE:
+      *ue_id = message_p->ittiMsg.s1ap_ue_context_mod_response.mme_ue_s1ap_id;
+      break;
+    case S1AP_UE_CONTEXT_MODIFICATION_FAILURE:
+      *ue_id = message_p->ittiMsg.s1ap_ue_context_mod_failure.mme_ue_s1ap_id;
+      break;
+    case S1AP_DEREGISTER_UE_REQ:
+      *ue_id = message_p->ittiMsg.s1ap_deregister_ue_req.mme_ue_s1ap_id;
+      break;
+
+    case S1AP_INITIAL_UE_MESSAGE:
+      *ue_id = mme_app_initial_ue_message_assign_ue_id(
+        &message_p->ittiMsg.s1ap_initial_ue_message);
+      break;
+
+    case TIMER_HAS_EXPIRED:
+      return mme_app_workers_get_timer_ue_id(message_p, ue_id);
+
+    /*
+     * Messages carrying the MME S11 TEID of the UE
+     */
+    case S11_CREATE_SESSION_RESPONSE:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_create_session_response.teid, ue_id);
+    case S11_MODIFY_BEARER_RESPONSE:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_modify_bearer_response.teid, ue_id);
+    case S11_RELEASE_ACCESS_BEARERS_RESPONSE:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_release_access_bearers_response.teid, ue_id);
+    case S11_DELETE_SESSION_RESPONSE:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_delete_session_response.teid, ue_id);
+    case S11_SUSPEND_ACKNOWLEDGE:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_suspend_acknowledge.teid, ue_id);
+    case S11_CREATE_BEARER_REQUEST:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_create_bearer_request.teid, ue_id);
+    case S11_MODIFY_UE_AMBR_REQUEST:
+      return mme_app_workers_get_s11_teid_ue_id(
+        message_p->ittiMsg.s11_modify_ue_ambr_request.teid, ue_id);
+
+    /*
+     * Messages carrying the IMSI of the UE
+     */
+    case S11_PAGING_REQUEST:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.s11_paging_request.imsi, ue_id);
+    case S6A_AUTH_INFO_ANS:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.s6a_auth_info_ans.imsi, ue_id);
+    case S6A_UPDATE_LOCATION_ANS:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.s6a_update_location_ans.imsi, ue_id);
+    case S6A_CANCEL_LOCATION_REQ:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.s6a_cancel_location_req.imsi, ue_id);
+    case S6A_PURGE_UE_ANS:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.s6a_purge_ue_ans.imsi, ue_id);
+    case SGSAP_LOCATION_UPDATE_ACC:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_location_update_acc.imsi, ue_id);
+    case SGSAP_LOCATION_UPDATE_REJ:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_location_update_rej.imsi, ue_id);
+    case SGSAP_ALERT_REQUEST:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_alert_request.imsi, ue_id);
+    case SGSAP_PAGING_REQUEST:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_paging_request.imsi, ue_id);
+    case SGSAP_SERVICE_ABORT_REQ:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_service_abort_req.imsi, ue_id);
+    case SGSAP_EPS_DETACH_ACK:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_eps_detach_ack.imsi, ue_id);
+    case SGSAP_IMSI_DETACH_ACK:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_imsi_detach_ack.imsi, ue_id);
+    case SGSAP_DOWNLINK_UNITDATA:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_downlink_unitdata.imsi, ue_id);
+    case SGSAP_RELEASE_REQ:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_release_req.imsi, ue_id);
+    case SGSAP_MM_INFORMATION_REQ:
+      return mme_app_workers_get_imsi_ue_id(
+        message_p->ittiMsg.sgsap_mm_information_req.imsi, ue_id);
+
+    /*
+     * Control shard: S6A_RESET_REQ, S1AP_ENB_INITIATED_RESET_REQ,
+     * S1AP_ENB_DEREGISTERED_IND, S11_RELEASE_ACCESS_BEARERS_BULK_RESPONSE,
+     * SGSAP_VLR_RESET_INDICATION, global timers, ACTIVATE_MESSAGE...
+     */
+    default:
+      return false;
+  }
+  return (*ue_id != INVALID_MME_UE_S1AP_ID);
+}
+
+//------------------------------------------------------------------------------
+int mme_app_workers_init(const mme_config_t *mme_config_p)
+{
+  itti_workers_t *workers = NULL;
+
+  if (mme_config_p->nb_ue_workers <= 1) {
+    return RETURNok;
+  }
+  workers = itti_workers_create(
+    "MME_APP", mme_config_p->nb_ue_workers, mme_app_workers_handle_message);
+  if (!workers) {
+    OAILOG_ERROR(
+      LOG_MME_APP,
+      "Failed to start %u UE workers\n",
+      mme_config_p->nb_ue_workers);
+    return RETURNerror;
+  }
+  pthread_rwlock_wrlock(&mme_app_workers_lock);
+  mme_app_workers = workers;
+  pthread_rwlock_unlock(&mme_app_workers_lock);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_workers_dispatch(MessageDef *message_p)
+{
+  mme_ue_s1ap_id_t ue_id = INVALID_MME_UE_S1AP_ID;
+
+  pthread_rwlock_rdlock(&mme_app_workers_lock);
+  if (!mme_app_workers) {
+    pthread_rwlock_unlock(&mme_app_workers_lock);
+    return false;
+  }
+  if (mme_app_workers_get_ue_id(message_p, &ue_id)) {
+    itti_workers_dispatch(mme_app_workers, ue_id, false, message_p);
+  } else {
+    itti_workers_dispatch_barrier(mme_app_workers, message_p);
+  }
+  pthread_rwlock_unlock(&mme_app_workers_lock);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_workers_exit(void)
+{
+  pthread_rwlock_wrlock(&mme_app_workers_lock);
+  itti_workers_destroy(&mme_app_workers);
+  pthread_rwlock_unlock(&mme_app_workers_lock);
+}
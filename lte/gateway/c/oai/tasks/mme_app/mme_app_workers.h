@@ -0,0 +1,58 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_workers.h
+  \brief UE sharded processing of the MME_APP and NAS tasks.
+
+  With more than one UE worker, the MME_APP and NAS task threads only
+  dispatch: the messages of a UE, whichever of the two tasks they are sent
+  to, are run by the worker owning its mme_ue_s1ap_id. The procedures of
+  different UEs run in parallel, those of a UE keep their order.
+  Timer expiries go to the worker of the UE the timer has been started for.
+  Global events (HSS reset, eNB reset or deregistration, SGs VLR reset,
+  global timers...) and messages whose UE cannot be resolved form the control
+  shard: they are dispatched as a barrier, run once all the messages
+  dispatched before them have been processed and while no worker runs
+  anything.
+*/
+
+#ifndef FILE_MME_APP_WORKERS_SEEN
+#define FILE_MME_APP_WORKERS_SEEN
+
+#include <stdbool.h>
+
+#include "intertask_interface.h"
+#include "mme_config.h"
+
+// Start the UE workers if mme_config_p->nb_ue_workers > 1
+int mme_app_workers_init(const mme_config_t *mme_config_p);
+
+/*
+ * Hand the message of the MME_APP or NAS task over to the workers, that will
+ * free it. Returns false when sharding is disabled: the caller has to process
+ * the message itself.
+ */
+bool mme_app_workers_dispatch(MessageDef *message_p);
+
+// Process the queued messages then stop the UE workers
+void mme_app_workers_exit(void);
+
+#endif /* FILE_MME_APP_WORKERS_SEEN */
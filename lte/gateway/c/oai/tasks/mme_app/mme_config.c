@@ -57,6 +57,7 @@
 #include "common_types.h"
 #include "common_defs.h"
 #include "mme_config.h"
+#include "mme_config_snapshot.h"
 #include "spgw_config.h"
 #include "3gpp_33.401.h"
 #include "intertask_interface_conf.h"
@@ -75,7 +76,9 @@ int mme_config_find_mnc_length(
   uint16_t mcc = 100 * mcc_digit1P + 10 * mcc_digit2P + mcc_digit3P;
   uint16_t mnc3 = 100 * mnc_digit1P + 10 * mnc_digit2P + mnc_digit3P;
   uint16_t mnc2 = 10 * mnc_digit1P + mnc_digit2P;
+  const mme_config_snapshot_t *snapshot = NULL;
   int plmn_index = 0;
+  int mnc_length = 0;
 
   AssertFatal(
     (mcc_digit1P >= 0) && (mcc_digit1P <= 9) && (mcc_digit2P >= 0) &&
@@ -92,23 +95,25 @@ int mme_config_find_mnc_length(
     mnc_digit2P,
     mnc_digit3P);
 
-  while (plmn_index < mme_config.served_tai.nb_tai) {
-    if (mme_config.served_tai.plmn_mcc[plmn_index] == mcc) {
-      if (
-        (mme_config.served_tai.plmn_mnc[plmn_index] == mnc2) &&
-        (mme_config.served_tai.plmn_mnc_len[plmn_index] == 2)) {
-        return 2;
-      } else if (
-        (mme_config.served_tai.plmn_mnc[plmn_index] == mnc3) &&
-        (mme_config.served_tai.plmn_mnc_len[plmn_index] == 3)) {
-        return 3;
+  // Follows the reloads of the served TAIs
+  snapshot = mme_config_snapshot_get();
+  if (!snapshot) {
+    return 0;
+  }
+  for (plmn_index = 0; (plmn_index < snapshot->nb_served_plmn) && !mnc_length;
+       plmn_index++) {
+    const mme_config_served_plmn_t *plmn = &snapshot->served_plmn[plmn_index];
+
+    if (plmn->mcc == mcc) {
+      if ((plmn->mnc == mnc2) && (plmn->mnc_len == 2)) {
+        mnc_length = 2;
+      } else if ((plmn->mnc == mnc3) && (plmn->mnc_len == 3)) {
+        mnc_length = 3;
       }
     }
-
-    plmn_index += 1;
   }
-
-  return 0;
+  mme_config_snapshot_put(snapshot);
+  return mnc_length;
 }
 
 void log_config_init(log_config_t *log_conf)
@@ -162,6 +167,7 @@ void s1ap_config_init(s1ap_config_t *s1ap_conf)
 {
   s1ap_conf->port_number = S1AP_PORT_NUMBER;
   s1ap_conf->outcome_drop_timer_sec = S1AP_OUTCOME_TIMER_DEFAULT;
+  s1ap_conf->nb_workers = S1AP_WORKERS_DEFAULT;
 }
 
 void s6a_config_init(s6a_config_t *s6a_conf)
@@ -197,6 +203,11 @@ void nas_config_init(nas_config_t *nas_conf)
   nas_conf->force_reject_tau = true;
   nas_conf->force_reject_sr = true;
   nas_conf->disable_esm_information = false;
+  nas_conf->zero_copy_decode = false;
+  nas_conf->auth_vector_prefetch = MAX_EPS_AUTH_VECTORS;
+  nas_conf->auth_vector_low_water_mark = 1;
+  nas_conf->auth_vector_lifetime_sec = 3600;
+  nas_conf->auth_vector_cache_max_ue = 100000;
 }
 
 void gummei_config_init(gummei_config_t *gummei_conf)
@@ -244,6 +255,7 @@ void mme_config_init(mme_config_t *config)
   config->unauthenticated_imsi_supported = 0;
   config->relative_capacity = RELATIVE_CAPACITY;
   config->mme_statistic_timer = MME_STATISTIC_TIMER_S;
+  config->nb_ue_workers = MME_UE_WORKERS_DEFAULT;
 
   log_config_init(&config->log_config);
   eps_network_feature_config_init(&config->eps_network_feature_support);
@@ -285,7 +297,50 @@ void mme_config_exit(void)
 }
 
 //------------------------------------------------------------------------------
-int mme_config_parse_file(mme_config_t *config_pP)
+static void mme_config_free(mme_config_t *config_pP)
+{
+  pthread_rwlock_destroy(&config_pP->rw_lock);
+  bdestroy_wrapper(&config_pP->config_file);
+  bdestroy_wrapper(&config_pP->pid_dir);
+  bdestroy_wrapper(&config_pP->realm);
+  bdestroy_wrapper(&config_pP->full_network_name);
+  bdestroy_wrapper(&config_pP->short_network_name);
+  bdestroy_wrapper(&config_pP->ip_capability);
+  bdestroy_wrapper(&config_pP->non_eps_service_control);
+  bdestroy_wrapper(&config_pP->log_config.output);
+  bdestroy_wrapper(&config_pP->ipv4.if_name_s1_mme);
+  bdestroy_wrapper(&config_pP->ipv4.if_name_s11);
+  bdestroy_wrapper(&config_pP->s6a_config.conf_file);
+  bdestroy_wrapper(&config_pP->s6a_config.hss_host_name);
+  bdestroy_wrapper(&config_pP->itti_config.log_file);
+  bdestroy_wrapper(&config_pP->service303_config.name);
+  bdestroy_wrapper(&config_pP->service303_config.version);
+
+  free_wrapper((void **) &config_pP->served_tai.plmn_mcc);
+  free_wrapper((void **) &config_pP->served_tai.plmn_mnc);
+  free_wrapper((void **) &config_pP->served_tai.plmn_mnc_len);
+  free_wrapper((void **) &config_pP->served_tai.tac);
+
+  for (int i = 0; i < config_pP->e_dns_emulation.nb_sgw_entries; i++) {
+    bdestroy_wrapper(&config_pP->e_dns_emulation.sgw_id[i]);
+  }
+}
+
+/*
+ * Invalid values stop the MME at boot. On a reload the file is rejected and
+ * the running configuration is kept, mme_config_parse() returns -1.
+ */
+#define MME_CONFIG_CHECK(cOND, ...)                                            \
+  do {                                                                         \
+    if (!(cOND)) {                                                             \
+      AssertFatal(!fatal, __VA_ARGS__);                                        \
+      OAILOG_ERROR(LOG_CONFIG, __VA_ARGS__);                                   \
+      goto error;                                                              \
+    }                                                                          \
+  } while (0)
+
+//------------------------------------------------------------------------------
+static int mme_config_parse(mme_config_t *config_pP, const bool fatal)
 {
   config_t cfg = {0};
   config_setting_t *setting_mme = NULL;
@@ -307,6 +362,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
   bstring address = NULL;
   bstring cidr = NULL;
   bstring mask = NULL;
+  struct bstrList *list = NULL;
   struct in_addr in_addr_var = {0};
   const char *csfb_mcc = NULL;
   const char *csfb_mnc = NULL;
@@ -327,14 +383,16 @@ int mme_config_parse_file(mme_config_t *config_pP)
         config_error_text(&cfg));
       config_destroy(&cfg);
       AssertFatal(
-        1 == 0,
+        !fatal,
         "Failed to parse MME configuration file %s!\n",
         bdata(config_pP->config_file));
+      return -1;
     }
   } else {
     OAILOG_ERROR(LOG_CONFIG, " No MME configuration file provided!\n");
     config_destroy(&cfg);
-    AssertFatal(0, "No MME configuration file provided!\n");
+    AssertFatal(!fatal, "No MME configuration file provided!\n");
+    return -1;
   }
 
   setting_mme = config_lookup(&cfg, MME_CONFIG_STRING_MME_CONFIG);
@@ -525,6 +583,16 @@ int mme_config_parse_file(mme_config_t *config_pP)
       config_pP->mme_statistic_timer = (uint32_t) aint;
     }
 
+    if ((config_setting_lookup_int(
+          setting_mme, MME_CONFIG_STRING_UE_WORKERS, &aint))) {
+      MME_CONFIG_CHECK(
+        (aint >= 1) && (aint <= MME_UE_WORKERS_MAX),
+        "UE_WORKERS must be in [1..%d], got %d\n",
+        MME_UE_WORKERS_MAX,
+        aint);
+      config_pP->nb_ue_workers = (uint8_t) aint;
+    }
+
     if ((config_setting_lookup_string(
           setting_mme,
           MME_CONFIG_STRING_IP_CAPABILITY,
@@ -623,8 +691,8 @@ int mme_config_parse_file(mme_config_t *config_pP)
             config_pP->s6a_config.hss_host_name = bfromcstr(astring);
           }
         } else
-          AssertFatal(
-            1 == 0,
+          MME_CONFIG_CHECK(
+            0,
             "You have to provide a valid HSS hostname %s=...\n",
             MME_CONFIG_STRING_S6A_HSS_HOSTNAME);
       }
@@ -659,6 +727,16 @@ int mme_config_parse_file(mme_config_t *config_pP)
             setting, MME_CONFIG_STRING_S1AP_PORT, &aint))) {
         config_pP->s1ap_config.port_number = (uint16_t) aint;
       }
+
+      if ((config_setting_lookup_int(
+            setting, MME_CONFIG_STRING_S1AP_WORKERS, &aint))) {
+        MME_CONFIG_CHECK(
+          (aint >= 1) && (aint <= S1AP_WORKERS_MAX),
+          "S1AP_WORKERS must be in [1..%d], got %d\n",
+          S1AP_WORKERS_MAX,
+          aint);
+        config_pP->s1ap_config.nb_workers = (uint8_t) aint;
+      }
     }
     // TAI list setting
     setting =
@@ -690,7 +768,8 @@ int mme_config_parse_file(mme_config_t *config_pP)
       }
 
       config_pP->served_tai.nb_tai = num;
-      AssertFatal(16 >= num, "Too many TAIs configured %d", num);
+      MME_CONFIG_CHECK(
+        MME_CONFIG_MAX_TAI >= num, "Too many TAIs configured %d", num);
 
       for (i = 0; i < num; i++) {
         sub2setting = config_setting_get_elem(setting, i);
@@ -705,7 +784,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
                 sub2setting, MME_CONFIG_STRING_MNC, &mnc))) {
             config_pP->served_tai.plmn_mnc[i] = (uint16_t) atoi(mnc);
             config_pP->served_tai.plmn_mnc_len[i] = strlen(mnc);
-            AssertFatal(
+            MME_CONFIG_CHECK(
               (config_pP->served_tai.plmn_mnc_len[i] == 2) ||
                 (config_pP->served_tai.plmn_mnc_len[i] == 3),
               "Bad MNC length %u, must be 2 or 3",
@@ -715,7 +794,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
           if ((config_setting_lookup_string(
                 sub2setting, MME_CONFIG_STRING_TAC, &tac))) {
             config_pP->served_tai.tac[i] = (uint16_t) atoi(tac);
-            AssertFatal(
+            MME_CONFIG_CHECK(
               TAC_IS_VALID(config_pP->served_tai.tac[i]),
               "Invalid TAC value " TAC_FMT,
               config_pP->served_tai.tac[i]);
@@ -761,6 +840,11 @@ int mme_config_parse_file(mme_config_t *config_pP)
               config_pP->served_tai.plmn_mnc[i];
             config_pP->served_tai.plmn_mnc[i] = swap16;
 
+            swap16 = config_pP->served_tai.plmn_mnc_len[i - 1];
+            config_pP->served_tai.plmn_mnc_len[i - 1] =
+              config_pP->served_tai.plmn_mnc_len[i];
+            config_pP->served_tai.plmn_mnc_len[i] = swap16;
+
             swap16 = config_pP->served_tai.tac[i - 1];
             config_pP->served_tai.tac[i - 1] = config_pP->served_tai.tac[i];
             config_pP->served_tai.tac[i] = swap16;
@@ -806,7 +890,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
     config_pP->gummei.nb = 0;
     if (setting != NULL) {
       num = config_setting_length(setting);
-      AssertFatal(
+      MME_CONFIG_CHECK(
         num == 1, "Only one GUMMEI supported for this version of MME");
       for (i = 0; i < num; i++) {
         sub2setting = config_setting_get_elem(setting, i);
@@ -814,7 +898,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
         if (sub2setting != NULL) {
           if ((config_setting_lookup_string(
                 sub2setting, MME_CONFIG_STRING_MCC, &mcc))) {
-            AssertFatal(
+            MME_CONFIG_CHECK(
               3 == strlen(mcc), "Bad MCC length, it must be 3 digit ex: 001");
             char c[2] = {mcc[0], 0};
             config_pP->gummei.gummei[i].plmn.mcc_digit1 = (uint8_t) atoi(c);
@@ -826,7 +910,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
 
           if ((config_setting_lookup_string(
                 sub2setting, MME_CONFIG_STRING_MNC, &mnc))) {
-            AssertFatal(
+            MME_CONFIG_CHECK(
               (3 == strlen(mnc)) || (2 == strlen(mnc)),
               "Bad MCC length, it must be 3 digit ex: 001");
             char c[2] = {mnc[0], 0};
@@ -880,16 +964,16 @@ int mme_config_parse_file(mme_config_t *config_pP)
 
         config_pP->ipv4.if_name_s1_mme = bfromcstr(if_name_s1_mme);
         cidr = bfromcstr(s1_mme);
-        struct bstrList *list = bsplit(cidr, '/');
-        AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
+        list = bsplit(cidr, '/');
+        MME_CONFIG_CHECK(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
         address = list->entry[0];
         mask = list->entry[1];
-        IPV4_STR_ADDR_TO_INADDR(
-          bdata(address),
-          config_pP->ipv4.s1_mme,
+        MME_CONFIG_CHECK(
+          inet_aton(bdata(address), &config_pP->ipv4.s1_mme) > 0,
           "BAD IP ADDRESS FORMAT FOR S1-MME !\n");
         config_pP->ipv4.netmask_s1_mme = atoi((const char *) mask->data);
         bstrListDestroy(list);
+        list = NULL;
         in_addr_var.s_addr = config_pP->ipv4.s1_mme.s_addr;
         OAILOG_INFO(
           LOG_MME_APP,
@@ -903,15 +987,15 @@ int mme_config_parse_file(mme_config_t *config_pP)
         config_pP->ipv4.if_name_s11 = bfromcstr(if_name_s11);
         cidr = bfromcstr(s11);
         list = bsplit(cidr, '/');
-        AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
+        MME_CONFIG_CHECK(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
         address = list->entry[0];
         mask = list->entry[1];
-        IPV4_STR_ADDR_TO_INADDR(
-          bdata(address),
-          config_pP->ipv4.s11,
+        MME_CONFIG_CHECK(
+          inet_aton(bdata(address), &config_pP->ipv4.s11) > 0,
           "BAD IP ADDRESS FORMAT FOR S11 !\n");
         config_pP->ipv4.netmask_s11 = atoi((const char *) mask->data);
         bstrListDestroy(list);
+        list = NULL;
         bdestroy_wrapper(&cidr);
         in_addr_var.s_addr = config_pP->ipv4.s11.s_addr;
         OAILOG_INFO(
@@ -943,7 +1027,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
         // Check CSFB MCC. MNC and LAC only if NON-EPS feature is enabled.
         if ((config_setting_lookup_string(
               setting, MME_CONFIG_STRING_CSFB_MCC, &csfb_mcc))) {
-          AssertFatal(
+          MME_CONFIG_CHECK(
             3 == strlen(csfb_mcc),
             "Bad MCC length, it must be 3 digit ex: 001");
           char c[2] = {csfb_mcc[0], 0};
@@ -955,7 +1039,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
         }
         if ((config_setting_lookup_string(
               setting, MME_CONFIG_STRING_CSFB_MNC, &csfb_mnc))) {
-          AssertFatal(
+          MME_CONFIG_CHECK(
             (3 == strlen(csfb_mnc)) || (2 == strlen(csfb_mnc)),
             "Bad MNC length, it must be 2 or 3 digit");
           char c[2] = {csfb_mnc[0], 0};
@@ -1108,6 +1192,52 @@ int mme_config_parse_file(mme_config_t *config_pP)
         else
           config_pP->nas_config.disable_esm_information = false;
       }
+      if ((config_setting_lookup_string(
+            setting,
+            MME_CONFIG_STRING_NAS_ZERO_COPY_DECODE,
+            (const char **) &astring))) {
+        if (strcasecmp(astring, "yes") == 0)
+          config_pP->nas_config.zero_copy_decode = true;
+        else
+          config_pP->nas_config.zero_copy_decode = false;
+      }
+      if ((config_setting_lookup_int(
+            setting, MME_CONFIG_STRING_NAS_AUTH_VECTOR_PREFETCH, &aint))) {
+        MME_CONFIG_CHECK(
+          (aint >= 1) && (aint <= MAX_EPS_AUTH_VECTORS_PER_AIR),
+          "AUTH_VECTOR_PREFETCH must be in [1..%d], got %d\n",
+          MAX_EPS_AUTH_VECTORS_PER_AIR,
+          aint);
+        config_pP->nas_config.auth_vector_prefetch = (uint8_t) aint;
+      }
+      if ((config_setting_lookup_int(
+            setting,
+            MME_CONFIG_STRING_NAS_AUTH_VECTOR_LOW_WATER_MARK,
+            &aint))) {
+        MME_CONFIG_CHECK(
+          (aint >= 0) &&
+            ((aint < config_pP->nas_config.auth_vector_prefetch) ||
+             (config_pP->nas_config.auth_vector_prefetch <=
+              MAX_EPS_AUTH_VECTORS)),
+          "AUTH_VECTOR_LOW_WATER_MARK must be below AUTH_VECTOR_PREFETCH, "
+          "got %d\n",
+          aint);
+        config_pP->nas_config.auth_vector_low_water_mark = (uint8_t) aint;
+      }
+      if ((config_setting_lookup_int(
+            setting, MME_CONFIG_STRING_NAS_AUTH_VECTOR_LIFETIME, &aint))) {
+        MME_CONFIG_CHECK(
+          aint > 0, "AUTH_VECTOR_LIFETIME must be positive, got %d\n", aint);
+        config_pP->nas_config.auth_vector_lifetime_sec = (uint32_t) aint;
+      }
+      if ((config_setting_lookup_int(
+            setting, MME_CONFIG_STRING_NAS_AUTH_VECTOR_CACHE_MAX_UE, &aint))) {
+        MME_CONFIG_CHECK(
+          aint > 0,
+          "AUTH_VECTOR_CACHE_MAX_UE must be positive, got %d\n",
+          aint);
+        config_pP->nas_config.auth_vector_cache_max_ue = (uint32_t) aint;
+      }
     }
 
     //SGS TIMERS
@@ -1143,7 +1273,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
   if (setting != NULL) {
     num = config_setting_length(setting);
 
-    AssertFatal(
+    MME_CONFIG_CHECK(
       num <= MME_CONFIG_MAX_SGW,
       "Too many SGW entries defined (%d>%d)",
       num,
@@ -1170,14 +1300,15 @@ int mme_config_parse_file(mme_config_t *config_pP)
               SGW_CONFIG_STRING_SGW_IPV4_ADDRESS_FOR_S11,
               (const char **) &sgw_ip_address_for_s11))) {
           cidr = bfromcstr(sgw_ip_address_for_s11);
-          struct bstrList *list = bsplit(cidr, '/');
-          AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
+          list = bsplit(cidr, '/');
+          MME_CONFIG_CHECK(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
           address = list->entry[0];
-          IPV4_STR_ADDR_TO_INADDR(
-            bdata(address),
-            config_pP->e_dns_emulation.sgw_ip_addr[i],
+          MME_CONFIG_CHECK(
+            inet_aton(
+              bdata(address), &config_pP->e_dns_emulation.sgw_ip_addr[i]) > 0,
             "BAD IP ADDRESS FORMAT FOR SGW S11 !\n");
           bstrListDestroy(list);
+          list = NULL;
           bdestroy_wrapper(&cidr);
           OAILOG_INFO(
             LOG_SPGW_APP,
@@ -1191,6 +1322,18 @@ int mme_config_parse_file(mme_config_t *config_pP)
 
   config_destroy(&cfg);
   return 0;
+
+error:
+  bstrListDestroy(list);
+  bdestroy_wrapper(&cidr);
+  config_destroy(&cfg);
+  return -1;
+}
+
+//------------------------------------------------------------------------------
+int mme_config_parse_file(mme_config_t *config_pP)
+{
+  return mme_config_parse(config_pP, true);
 }
 
 //------------------------------------------------------------------------------
@@ -1316,6 +1459,10 @@ void mme_config_display(mme_config_t *config_pP)
     LOG_CONFIG,
     "- Statistics timer .....................: %u (seconds)\n\n",
     config_pP->mme_statistic_timer);
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "- UE workers ...........................: %u\n",
+    config_pP->nb_ue_workers);
   OAILOG_INFO(
     LOG_CONFIG,
     "- IP Capability ........................: %s\n\n",
@@ -1330,6 +1477,10 @@ void mme_config_display(mme_config_t *config_pP)
     LOG_CONFIG,
     "    port number ......: %d\n",
     config_pP->s1ap_config.port_number);
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "    workers ..........: %d\n",
+    config_pP->s1ap_config.nb_workers);
   OAILOG_INFO(LOG_CONFIG, "- IP:\n");
   OAILOG_INFO(
     LOG_CONFIG,
@@ -1459,6 +1610,22 @@ void mme_config_display(mme_config_t *config_pP)
     LOG_CONFIG,
     "      Disable Esm information .....: %s\n",
     (config_pP->nas_config.disable_esm_information) ? "true" : "false");
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "      Zero-copy decode ............: %s\n",
+    (config_pP->nas_config.zero_copy_decode) ? "true" : "false");
+  if (config_pP->nas_config.auth_vector_prefetch > MAX_EPS_AUTH_VECTORS) {
+    OAILOG_INFO(
+      LOG_CONFIG,
+      "    Auth vector cache .: %u per AIR, prefetch below %u, %u s, "
+      "%u UEs\n",
+      config_pP->nas_config.auth_vector_prefetch,
+      config_pP->nas_config.auth_vector_low_water_mark,
+      config_pP->nas_config.auth_vector_lifetime_sec,
+      config_pP->nas_config.auth_vector_cache_max_ue);
+  } else {
+    OAILOG_INFO(LOG_CONFIG, "    Auth vector cache .: disabled\n");
+  }
 
   OAILOG_INFO(LOG_CONFIG, "- S6A:\n");
   OAILOG_INFO(
@@ -1628,3 +1795,34 @@ int mme_config_parse_opt_line(int argc, char *argv[], mme_config_t *config_pP)
   mme_config_display(config_pP);
   return 0;
 }
+
+//------------------------------------------------------------------------------
+int mme_config_reload(void)
+{
+  mme_config_t config = {0};
+  int rc = RETURNerror;
+
+  mme_config_init(&config);
+  mme_config_read_lock(&mme_config);
+  config.config_file = bstrcpy(mme_config.config_file);
+  mme_config_unlock(&mme_config);
+
+  // A bad edit is reported and rejected, it does not stop the running MME
+  if (mme_config_parse(&config, false) == 0) {
+    rc = mme_config_snapshot_publish(&config);
+  }
+  if (rc == RETURNok) {
+    OAILOG_INFO(
+      LOG_CONFIG,
+      "Reloaded %s, only the served TAIs, the relative capacity and the "
+      "maximum number of eNBs are applied without a restart\n",
+      bdata(config.config_file));
+  } else {
+    OAILOG_ERROR(
+      LOG_CONFIG,
+      "Not reloading %s, keeping the current configuration\n",
+      bdata(config.config_file));
+  }
+  mme_config_free(&config);
+  return rc;
+}
@@ -0,0 +1,319 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_config_snapshot.c
+  \brief Immutable views of the MME configuration, see mme_config_snapshot.h.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "conversions.h"
+#include "dynamic_memory_check.h"
+#include "TrackingAreaIdentity.h"
+#include "mme_api.h"
+#include "mme_config.h"
+#include "mme_config_snapshot.h"
+
+static mme_config_snapshot_t *mme_config_snapshot = NULL;
+// Serializes the publishers, readers never take it
+static pthread_mutex_t mme_config_snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+// Readers between their load of the current snapshot and their reference
+static uint32_t mme_config_snapshot_loading = 0;
+
+//------------------------------------------------------------------------------
+static bool mme_config_gummei_equal(
+  const gummei_config_t *const a,
+  const gummei_config_t *const b)
+{
+  if (a->nb != b->nb) {
+    return false;
+  }
+  for (int i = 0; i < a->nb; i++) {
+    const gummei_t *ga = &a->gummei[i];
+    const gummei_t *gb = &b->gummei[i];
+
+    if (
+      (ga->mme_gid != gb->mme_gid) || (ga->mme_code != gb->mme_code) ||
+      (ga->plmn.mcc_digit1 != gb->plmn.mcc_digit1) ||
+      (ga->plmn.mcc_digit2 != gb->plmn.mcc_digit2) ||
+      (ga->plmn.mcc_digit3 != gb->plmn.mcc_digit3) ||
+      (ga->plmn.mnc_digit1 != gb->plmn.mnc_digit1) ||
+      (ga->plmn.mnc_digit2 != gb->plmn.mnc_digit2) ||
+      (ga->plmn.mnc_digit3 != gb->plmn.mnc_digit3)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static int mme_config_snapshot_validate(
+  const mme_config_t *const config_pP,
+  const mme_config_snapshot_t *const current)
+{
+  const served_tai_t *served_tai = &config_pP->served_tai;
+
+  if ((served_tai->nb_tai < 1) || (served_tai->nb_tai > MME_CONFIG_MAX_TAI)) {
+    OAILOG_ERROR(
+      LOG_CONFIG,
+      "%u TAIs configured, must be in [1..%d]\n",
+      served_tai->nb_tai,
+      MME_CONFIG_MAX_TAI);
+    return RETURNerror;
+  }
+  if (
+    (served_tai->list_type !=
+     TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_NON_CONSECUTIVE_TACS) &&
+    (served_tai->list_type !=
+     TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_CONSECUTIVE_TACS) &&
+    (served_tai->list_type != TRACKING_AREA_IDENTITY_LIST_TYPE_MANY_PLMNS)) {
+    OAILOG_ERROR(
+      LOG_CONFIG, "Unknown TAI list type %u\n", served_tai->list_type);
+    return RETURNerror;
+  }
+  for (int i = 0; i < served_tai->nb_tai; i++) {
+    if (
+      (served_tai->plmn_mnc_len[i] != 2) &&
+      (served_tai->plmn_mnc_len[i] != 3)) {
+      OAILOG_ERROR(
+        LOG_CONFIG,
+        "Bad MNC length %u, must be 2 or 3\n",
+        served_tai->plmn_mnc_len[i]);
+      return RETURNerror;
+    }
+    if (!TAC_IS_VALID(served_tai->tac[i])) {
+      OAILOG_ERROR(
+        LOG_CONFIG, "Invalid TAC value " TAC_FMT "\n", served_tai->tac[i]);
+      return RETURNerror;
+    }
+  }
+  if ((config_pP->gummei.nb < 1) || (config_pP->gummei.nb > MAX_GUMMEI)) {
+    OAILOG_ERROR(
+      LOG_CONFIG,
+      "%d GUMMEIs configured, must be in [1..%d]\n",
+      config_pP->gummei.nb,
+      MAX_GUMMEI);
+    return RETURNerror;
+  }
+  if (
+    current && !mme_config_gummei_equal(&current->gummei, &config_pP->gummei)) {
+    OAILOG_ERROR(
+      LOG_CONFIG, "The GUMMEI list can not be changed without a restart\n");
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static void mme_config_snapshot_free(mme_config_snapshot_t **snapshot)
+{
+  if (!(*snapshot)) {
+    return;
+  }
+  free_wrapper((void **) &(*snapshot)->served_tai.plmn_mcc);
+  free_wrapper((void **) &(*snapshot)->served_tai.plmn_mnc);
+  free_wrapper((void **) &(*snapshot)->served_tai.plmn_mnc_len);
+  free_wrapper((void **) &(*snapshot)->served_tai.tac);
+  free_wrapper((void **) snapshot);
+}
+
+//------------------------------------------------------------------------------
+static void mme_config_snapshot_add_served_tai(
+  mme_config_snapshot_t *const snapshot,
+  const int i)
+{
+  const served_tai_t *served_tai = &snapshot->served_tai;
+  const uint16_t mcc = served_tai->plmn_mcc[i];
+  const uint16_t mnc = served_tai->plmn_mnc[i];
+  const uint16_t mnc_len = served_tai->plmn_mnc_len[i];
+  uint8_t *tbcd = snapshot->encoded_tai[i].plmn;
+
+  tbcd[0] = (MCC_MNC_DECIMAL(mcc) << 4) | MCC_HUNDREDS(mcc);
+  tbcd[1] = (MNC_HUNDREDS(mnc, mnc_len) << 4) | MCC_MNC_DIGIT(mcc);
+  tbcd[2] = (MCC_MNC_DIGIT(mnc) << 4) | MCC_MNC_DECIMAL(mnc);
+  INT16_TO_BUFFER(served_tai->tac[i], snapshot->encoded_tai[i].tac);
+
+  for (int p = 0; p < snapshot->nb_served_plmn; p++) {
+    if (memcmp(snapshot->served_plmn[p].tbcd, tbcd, 3) == 0) {
+      return;
+    }
+  }
+  mme_config_served_plmn_t *plmn =
+    &snapshot->served_plmn[snapshot->nb_served_plmn++];
+  plmn->mcc = mcc;
+  plmn->mnc = mnc;
+  plmn->mnc_len = mnc_len;
+  memcpy(plmn->tbcd, tbcd, 3);
+}
+
+//------------------------------------------------------------------------------
+static mme_config_snapshot_t *mme_config_snapshot_create(
+  const mme_config_t *const config_pP)
+{
+  const served_tai_t *served_tai = &config_pP->served_tai;
+  const uint8_t nb_tai = served_tai->nb_tai;
+  mme_config_snapshot_t *snapshot = calloc(1, sizeof(*snapshot));
+
+  if (!snapshot) {
+    OAILOG_ERROR(LOG_CONFIG, "Failed to allocate the configuration snapshot\n");
+    return NULL;
+  }
+  snapshot->max_enbs = config_pP->max_enbs;
+  snapshot->relative_capacity = config_pP->relative_capacity;
+  snapshot->gummei = config_pP->gummei;
+
+  snapshot->served_tai.list_type = served_tai->list_type;
+  snapshot->served_tai.nb_tai = nb_tai;
+  snapshot->served_tai.plmn_mcc = calloc(nb_tai, sizeof(uint16_t));
+  snapshot->served_tai.plmn_mnc = calloc(nb_tai, sizeof(uint16_t));
+  snapshot->served_tai.plmn_mnc_len = calloc(nb_tai, sizeof(uint16_t));
+  snapshot->served_tai.tac = calloc(nb_tai, sizeof(uint16_t));
+  if (
+    (!snapshot->served_tai.plmn_mcc) || (!snapshot->served_tai.plmn_mnc) ||
+    (!snapshot->served_tai.plmn_mnc_len) || (!snapshot->served_tai.tac)) {
+    OAILOG_ERROR(LOG_CONFIG, "Failed to allocate the served TAIs snapshot\n");
+    mme_config_snapshot_free(&snapshot);
+    return NULL;
+  }
+  memcpy(
+    snapshot->served_tai.plmn_mcc,
+    served_tai->plmn_mcc,
+    nb_tai * sizeof(uint16_t));
+  memcpy(
+    snapshot->served_tai.plmn_mnc,
+    served_tai->plmn_mnc,
+    nb_tai * sizeof(uint16_t));
+  memcpy(
+    snapshot->served_tai.plmn_mnc_len,
+    served_tai->plmn_mnc_len,
+    nb_tai * sizeof(uint16_t));
+  memcpy(snapshot->served_tai.tac, served_tai->tac, nb_tai * sizeof(uint16_t));
+
+  for (int i = 0; i < nb_tai; i++) {
+    mme_config_snapshot_add_served_tai(snapshot, i);
+  }
+  if (
+    mme_api_get_tai_list(&snapshot->served_tai, &snapshot->nas_tai_list) !=
+    RETURNok) {
+    mme_config_snapshot_free(&snapshot);
+    return NULL;
+  }
+  return snapshot;
+}
+
+//------------------------------------------------------------------------------
+static void mme_config_snapshot_unref(mme_config_snapshot_t *snapshot)
+{
+  if (!__atomic_sub_fetch(&snapshot->refcount, 1, __ATOMIC_ACQ_REL)) {
+    mme_config_snapshot_free(&snapshot);
+  }
+}
+
+/*
+ * Called with mme_config_snapshot_lock held. Once the new snapshot is stored,
+ * a reader can only load the replaced one if it has announced itself before,
+ * so waiting for the announced readers guarantees they all hold their
+ * reference before the one of the current snapshot is released.
+ */
+//------------------------------------------------------------------------------
+static void mme_config_snapshot_replace(mme_config_snapshot_t *snapshot)
+{
+  mme_config_snapshot_t *previous = mme_config_snapshot;
+
+  __atomic_store_n(&mme_config_snapshot, snapshot, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&mme_config_snapshot_loading, __ATOMIC_SEQ_CST)) {
+    sched_yield();
+  }
+  if (previous) {
+    mme_config_snapshot_unref(previous);
+  }
+}
+
+//------------------------------------------------------------------------------
+int mme_config_snapshot_publish(const mme_config_t *config_pP)
+{
+  mme_config_snapshot_t *current = NULL;
+  mme_config_snapshot_t *snapshot = NULL;
+
+  pthread_mutex_lock(&mme_config_snapshot_lock);
+  current = mme_config_snapshot;
+  if (mme_config_snapshot_validate(config_pP, current) != RETURNok) {
+    pthread_mutex_unlock(&mme_config_snapshot_lock);
+    return RETURNerror;
+  }
+  snapshot = mme_config_snapshot_create(config_pP);
+  if (!snapshot) {
+    pthread_mutex_unlock(&mme_config_snapshot_lock);
+    return RETURNerror;
+  }
+  snapshot->generation = current ? (current->generation + 1) : 0;
+  snapshot->refcount = 1;
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "MME configuration generation %u: %u TAIs in %u PLMNs, capacity %u, "
+    "%u eNBs max\n",
+    snapshot->generation,
+    snapshot->served_tai.nb_tai,
+    snapshot->nb_served_plmn,
+    snapshot->relative_capacity,
+    snapshot->max_enbs);
+  // The snapshot is complete before readers can see it
+  mme_config_snapshot_replace(snapshot);
+  pthread_mutex_unlock(&mme_config_snapshot_lock);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+const mme_config_snapshot_t *mme_config_snapshot_get(void)
+{
+  mme_config_snapshot_t *snapshot = NULL;
+
+  __atomic_add_fetch(&mme_config_snapshot_loading, 1, __ATOMIC_SEQ_CST);
+  snapshot = __atomic_load_n(&mme_config_snapshot, __ATOMIC_SEQ_CST);
+  if (snapshot) {
+    __atomic_add_fetch(&snapshot->refcount, 1, __ATOMIC_RELAXED);
+  }
+  __atomic_sub_fetch(&mme_config_snapshot_loading, 1, __ATOMIC_RELEASE);
+  return snapshot;
+}
+
+//------------------------------------------------------------------------------
+void mme_config_snapshot_put(const mme_config_snapshot_t *snapshot)
+{
+  if (snapshot) {
+    mme_config_snapshot_unref((mme_config_snapshot_t *) snapshot);
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_config_snapshot_exit(void)
+{
+  pthread_mutex_lock(&mme_config_snapshot_lock);
+  mme_config_snapshot_replace(NULL);
+  pthread_mutex_unlock(&mme_config_snapshot_lock);
+}
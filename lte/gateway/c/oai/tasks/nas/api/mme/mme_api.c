@@ -68,6 +68,7 @@
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
 #include "mme_config.h"
+#include "mme_config_snapshot.h"
 #include "emm_data.h"
 
 /****************************************************************************/
@@ -104,167 +105,186 @@ static int _mme_api_pdn_id = 0;
 
 /****************************************************************************
  **                                                                        **
- ** Name:    mme_api_get_emm_config()                                  **
+ ** Name:    mme_api_get_tai_list()                                    **
  **                                                                        **
- ** Description: Retreives MME configuration data related to EPS mobility  **
- **      management                                                **
+ ** Description: Builds the partial TAI lists advertised to the UEs from   **
+ **      the served TAIs of the MME configuration                  **
  **                                                                        **
- ** Inputs:  None                                                      **
+ ** Inputs:  served_tai:    Served TAIs, sorted in ascending order     **
  **      Others:    None                                       **
  **                                                                        **
- ** Outputs:     None                                                      **
+ ** Outputs:     tai_list:  The TAI lists                              **
  **      Return:    RETURNok, RETURNerror                      **
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-int mme_api_get_emm_config(
-  mme_api_emm_config_t *config,
-  struct mme_config_s *mme_config_p)
+int mme_api_get_tai_list(
+  const served_tai_t *const served_tai,
+  tai_list_t *const tai_list)
 {
   OAILOG_FUNC_IN(LOG_NAS);
-  AssertFatal(mme_config_p->served_tai.nb_tai >= 1, "No TAI configured");
-  AssertFatal(mme_config_p->gummei.nb >= 1, "No GUMMEI configured");
-
-  config->tai_list.numberoflists = 0;
+  tai_list->numberoflists = 0;
   // TODO actually we support only one partial TAI list.
-  // reminder mme_config_p->served_tai is sorted in ascending order of TAIs
-  switch (mme_config_p->served_tai.list_type) {
+  // reminder served_tai is sorted in ascending order of TAIs
+  switch (served_tai->list_type) {
     case TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_CONSECUTIVE_TACS:
-      config->tai_list.numberoflists = 1;
-      config->tai_list.partial_tai_list[0].typeoflist =
-        mme_config_p->served_tai.list_type;
+      tai_list->numberoflists = 1;
+      tai_list->partial_tai_list[0].typeoflist = served_tai->list_type;
       // LW: number of elements is coded as N-1 (0 -> 1 element, 1 -> 2 elements...), see 3GPP TS 24.301, section 9.9.3.33.1
-      config->tai_list.partial_tai_list[0].numberofelements = 0;
-      config->tai_list.partial_tai_list[0]
-        .u.tai_one_plmn_consecutive_tacs.mcc_digit1 =
-        (mme_config_p->served_tai.plmn_mcc[0] / 100) % 10;
-      config->tai_list.partial_tai_list[0]
-        .u.tai_one_plmn_consecutive_tacs.mcc_digit2 =
-        (mme_config_p->served_tai.plmn_mcc[0] / 10) % 10;
-      config->tai_list.partial_tai_list[0]
-        .u.tai_one_plmn_consecutive_tacs.mcc_digit3 =
-        mme_config_p->served_tai.plmn_mcc[0] % 10;
-      if (mme_config_p->served_tai.plmn_mnc_len[0] == 2) {
-        config->tai_list.partial_tai_list[0]
+      tai_list->partial_tai_list[0].numberofelements = 0;
+      tai_list->partial_tai_list[0].u.tai_one_plmn_consecutive_tacs.mcc_digit1 =
+        (served_tai->plmn_mcc[0] / 100) % 10;
+      tai_list->partial_tai_list[0].u.tai_one_plmn_consecutive_tacs.mcc_digit2 =
+        (served_tai->plmn_mcc[0] / 10) % 10;
+      tai_list->partial_tai_list[0].u.tai_one_plmn_consecutive_tacs.mcc_digit3 =
+        served_tai->plmn_mcc[0] % 10;
+      if (served_tai->plmn_mnc_len[0] == 2) {
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_consecutive_tacs.mnc_digit1 =
-          (mme_config_p->served_tai.plmn_mnc[0] / 10) % 10;
-        config->tai_list.partial_tai_list[0]
+          (served_tai->plmn_mnc[0] / 10) % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_consecutive_tacs.mnc_digit2 =
-          mme_config_p->served_tai.plmn_mnc[0] % 10;
-        config->tai_list.partial_tai_list[0]
+          served_tai->plmn_mnc[0] % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_consecutive_tacs.mnc_digit3 = 0xf;
-      } else if (mme_config_p->served_tai.plmn_mnc_len[0] == 3) {
-        config->tai_list.partial_tai_list[0]
+      } else if (served_tai->plmn_mnc_len[0] == 3) {
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_consecutive_tacs.mnc_digit1 =
-          (mme_config_p->served_tai.plmn_mnc[0] / 100) % 10;
-        config->tai_list.partial_tai_list[0]
+          (served_tai->plmn_mnc[0] / 100) % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_consecutive_tacs.mnc_digit2 =
-          (mme_config_p->served_tai.plmn_mnc[0] / 10) % 10;
-        config->tai_list.partial_tai_list[0]
+          (served_tai->plmn_mnc[0] / 10) % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_consecutive_tacs.mnc_digit3 =
-          mme_config_p->served_tai.plmn_mnc[0] % 10;
+          served_tai->plmn_mnc[0] % 10;
       } else {
         AssertFatal(
-          (mme_config_p->served_tai.plmn_mnc_len[0] >= 2) &&
-            (mme_config_p->served_tai.plmn_mnc_len[0] <= 3),
+          (served_tai->plmn_mnc_len[0] >= 2) &&
+            (served_tai->plmn_mnc_len[0] <= 3),
           "BAD MNC length for GUMMEI");
       }
-      config->tai_list.partial_tai_list[0].u.tai_one_plmn_consecutive_tacs.tac =
-        mme_config_p->served_tai.tac[0];
+      tai_list->partial_tai_list[0].u.tai_one_plmn_consecutive_tacs.tac =
+        served_tai->tac[0];
       break;
 
     case TRACKING_AREA_IDENTITY_LIST_TYPE_MANY_PLMNS:
-      config->tai_list.numberoflists = 1;
-      config->tai_list.partial_tai_list[0].typeoflist =
-        mme_config_p->served_tai.list_type;
-      config->tai_list.partial_tai_list[0].numberofelements =
-        mme_config_p->served_tai.nb_tai - 1;
-      for (int i = 0; i < mme_config_p->served_tai.nb_tai; i++) {
-        config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mcc_digit1 =
-          (mme_config_p->served_tai.plmn_mcc[i] / 100) % 10;
-        config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mcc_digit2 =
-          (mme_config_p->served_tai.plmn_mcc[i] / 10) % 10;
-        config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mcc_digit3 =
-          mme_config_p->served_tai.plmn_mcc[i] % 10;
-        if (mme_config_p->served_tai.plmn_mnc_len[0] == 2) {
-          config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mnc_digit1 =
-            (mme_config_p->served_tai.plmn_mnc[i] / 10) % 10;
-          config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mnc_digit2 =
-            mme_config_p->served_tai.plmn_mnc[i] % 10;
-          config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mnc_digit3 =
+      tai_list->numberoflists = 1;
+      tai_list->partial_tai_list[0].typeoflist = served_tai->list_type;
+      tai_list->partial_tai_list[0].numberofelements = served_tai->nb_tai - 1;
+      for (int i = 0; i < served_tai->nb_tai; i++) {
+        tai_list->partial_tai_list[0].u.tai_many_plmn[i].mcc_digit1 =
+          (served_tai->plmn_mcc[i] / 100) % 10;
+        tai_list->partial_tai_list[0].u.tai_many_plmn[i].mcc_digit2 =
+          (served_tai->plmn_mcc[i] / 10) % 10;
+        tai_list->partial_tai_list[0].u.tai_many_plmn[i].mcc_digit3 =
+          served_tai->plmn_mcc[i] % 10;
+        if (served_tai->plmn_mnc_len[0] == 2) {
+          tai_list->partial_tai_list[0].u.tai_many_plmn[i].mnc_digit1 =
+            (served_tai->plmn_mnc[i] / 10) % 10;
+          tai_list->partial_tai_list[0].u.tai_many_plmn[i].mnc_digit2 =
+            served_tai->plmn_mnc[i] % 10;
+          tai_list->partial_tai_list[0].u.tai_many_plmn[i].mnc_digit3 =
             0xf;
-        } else if (mme_config_p->served_tai.plmn_mnc_len[0] == 3) {
-          config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mnc_digit1 =
-            (mme_config_p->served_tai.plmn_mnc[i] / 100) % 10;
-          config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mnc_digit2 =
-            (mme_config_p->served_tai.plmn_mnc[i] / 10) % 10;
-          config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].mnc_digit3 =
-            mme_config_p->served_tai.plmn_mnc[i] % 10;
+        } else if (served_tai->plmn_mnc_len[0] == 3) {
+          tai_list->partial_tai_list[0].u.tai_many_plmn[i].mnc_digit1 =
+            (served_tai->plmn_mnc[i] / 100) % 10;
+          tai_list->partial_tai_list[0].u.tai_many_plmn[i].mnc_digit2 =
+            (served_tai->plmn_mnc[i] / 10) % 10;
+          tai_list->partial_tai_list[0].u.tai_many_plmn[i].mnc_digit3 =
+            served_tai->plmn_mnc[i] % 10;
         } else {
           AssertFatal(
-            (mme_config_p->served_tai.plmn_mnc_len[0] >= 2) &&
-              (mme_config_p->served_tai.plmn_mnc_len[i] <= 3),
+            (served_tai->plmn_mnc_len[0] >= 2) &&
+              (served_tai->plmn_mnc_len[i] <= 3),
             "BAD MNC length for GUMMEI");
         }
-        config->tai_list.partial_tai_list[0].u.tai_many_plmn[i].tac =
-          mme_config_p->served_tai.tac[i];
+        tai_list->partial_tai_list[0].u.tai_many_plmn[i].tac =
+          served_tai->tac[i];
         // LW: number of elements is coded as N-1 (0 -> 1 element, 1 -> 2 elements...), see 3GPP TS 24.301, section 9.9.3.33.1
       }
       break;
 
     case TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_NON_CONSECUTIVE_TACS:
-      config->tai_list.numberoflists = 1;
-      config->tai_list.partial_tai_list[0].typeoflist =
-        mme_config_p->served_tai.list_type;
-      config->tai_list.partial_tai_list[0]
+      tai_list->numberoflists = 1;
+      tai_list->partial_tai_list[0].typeoflist = served_tai->list_type;
+      tai_list->partial_tai_list[0]
         .u.tai_one_plmn_non_consecutive_tacs.mcc_digit1 =
-        (mme_config_p->served_tai.plmn_mcc[0] / 100) % 10;
-      config->tai_list.partial_tai_list[0]
+        (served_tai->plmn_mcc[0] / 100) % 10;
+      tai_list->partial_tai_list[0]
         .u.tai_one_plmn_non_consecutive_tacs.mcc_digit2 =
-        (mme_config_p->served_tai.plmn_mcc[0] / 10) % 10;
-      config->tai_list.partial_tai_list[0]
+        (served_tai->plmn_mcc[0] / 10) % 10;
+      tai_list->partial_tai_list[0]
         .u.tai_one_plmn_non_consecutive_tacs.mcc_digit3 =
-        mme_config_p->served_tai.plmn_mcc[0] % 10;
-      if (mme_config_p->served_tai.plmn_mnc_len[0] == 2) {
-        config->tai_list.partial_tai_list[0]
+        served_tai->plmn_mcc[0] % 10;
+      if (served_tai->plmn_mnc_len[0] == 2) {
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_non_consecutive_tacs.mnc_digit1 =
-          (mme_config_p->served_tai.plmn_mnc[0] / 10) % 10;
-        config->tai_list.partial_tai_list[0]
+          (served_tai->plmn_mnc[0] / 10) % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_non_consecutive_tacs.mnc_digit2 =
-          mme_config_p->served_tai.plmn_mnc[0] % 10;
-        config->tai_list.partial_tai_list[0]
+          served_tai->plmn_mnc[0] % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_non_consecutive_tacs.mnc_digit3 = 0xf;
-      } else if (mme_config_p->served_tai.plmn_mnc_len[0] == 3) {
-        config->tai_list.partial_tai_list[0]
+      } else if (served_tai->plmn_mnc_len[0] == 3) {
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_non_consecutive_tacs.mnc_digit1 =
-          (mme_config_p->served_tai.plmn_mnc[0] / 100) % 10;
-        config->tai_list.partial_tai_list[0]
+          (served_tai->plmn_mnc[0] / 100) % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_non_consecutive_tacs.mnc_digit2 =
-          (mme_config_p->served_tai.plmn_mnc[0] / 10) % 10;
-        config->tai_list.partial_tai_list[0]
+          (served_tai->plmn_mnc[0] / 10) % 10;
+        tai_list->partial_tai_list[0]
           .u.tai_one_plmn_non_consecutive_tacs.mnc_digit3 =
-          mme_config_p->served_tai.plmn_mnc[0] % 10;
+          served_tai->plmn_mnc[0] % 10;
       } else {
         AssertFatal(
-          (mme_config_p->served_tai.plmn_mnc_len[0] >= 2) &&
-            (mme_config_p->served_tai.plmn_mnc_len[0] <= 3),
+          (served_tai->plmn_mnc_len[0] >= 2) &&
+            (served_tai->plmn_mnc_len[0] <= 3),
           "BAD MNC length for GUMMEI");
       }
-      for (int i = 0; i < mme_config_p->served_tai.nb_tai; i++) {
-        config->tai_list.partial_tai_list[0]
-          .u.tai_one_plmn_non_consecutive_tacs.tac[i] =
-          mme_config_p->served_tai.tac[i];
+      for (int i = 0; i < served_tai->nb_tai; i++) {
+        tai_list->partial_tai_list[0]
+          .u.tai_one_plmn_non_consecutive_tacs.tac[i] = served_tai->tac[i];
       }
       // LW: number of elements is coded as N-1 (0 -> 1 element, 1 -> 2 elements...), see 3GPP TS 24.301, section 9.9.3.33.1
-      config->tai_list.partial_tai_list[0].numberofelements =
-        mme_config_p->served_tai.nb_tai - 1;
+      tai_list->partial_tai_list[0].numberofelements = served_tai->nb_tai - 1;
       break;
     default:
-      AssertFatal(
-        0,
-        "BAD TAI list configuration, unknown TAI list type %u",
-        mme_config_p->served_tai.list_type);
+      OAILOG_ERROR(
+        LOG_NAS,
+        "BAD TAI list configuration, unknown TAI list type %u\n",
+        served_tai->list_type);
+      OAILOG_FUNC_RETURN(LOG_NAS, RETURNerror);
   }
+  OAILOG_FUNC_RETURN(LOG_NAS, RETURNok);
+}
+
+/****************************************************************************
+ **                                                                        **
+ ** Name:    mme_api_get_emm_config()                                  **
+ **                                                                        **
+ ** Description: Retreives MME configuration data related to EPS mobility  **
+ **      management                                                **
+ **                                                                        **
+ ** Inputs:  None                                                      **
+ **      Others:    None                                       **
+ **                                                                        **
+ ** Outputs:     None                                                      **
+ **      Return:    RETURNok, RETURNerror                      **
+ **      Others:    None                                       **
+ **                                                                        **
+ ***************************************************************************/
+int mme_api_get_emm_config(
+  mme_api_emm_config_t *config,
+  struct mme_config_s *mme_config_p)
+{
+  OAILOG_FUNC_IN(LOG_NAS);
+  AssertFatal(mme_config_p->served_tai.nb_tai >= 1, "No TAI configured");
+  AssertFatal(mme_config_p->gummei.nb >= 1, "No GUMMEI configured");
+  AssertFatal(
+    mme_api_get_tai_list(&mme_config_p->served_tai, &config->tai_list) ==
+      RETURNok,
+    "BAD TAI list configuration, unknown TAI list type %u",
+    mme_config_p->served_tai.list_type);
 
   config->gummei = mme_config_p->gummei.gummei[0];
 
@@ -510,33 +530,36 @@ int mme_api_new_guti(
     OAILOG_FUNC_RETURN(LOG_NAS, RETURNerror);
   }
 
+  // The served TAIs may be reloaded, the GUMMEI may not
+  const mme_config_snapshot_t *config_snapshot = mme_config_snapshot_get();
+  const tai_list_t *served_tai_list = &config_snapshot->nas_tai_list;
   int j = 0;
-  for (int i = 0; i < _emm_data.conf.tai_list.numberoflists; i++) {
-    switch (_emm_data.conf.tai_list.partial_tai_list[i].typeoflist) {
+  for (int i = 0; i < served_tai_list->numberoflists; i++) {
+    switch (served_tai_list->partial_tai_list[i].typeoflist) {
       case TRACKING_AREA_IDENTITY_LIST_ONE_PLMN_NON_CONSECUTIVE_TACS:
         if (
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mcc_digit1 ==
            guti->gummei.plmn.mcc_digit1) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mcc_digit2 ==
            guti->gummei.plmn.mcc_digit2) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mcc_digit3 ==
            guti->gummei.plmn.mcc_digit3) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mnc_digit1 ==
            guti->gummei.plmn.mnc_digit1) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mnc_digit2 ==
            guti->gummei.plmn.mnc_digit2) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mnc_digit3 ==
            guti->gummei.plmn.mnc_digit3)) {
           tai_list->partial_tai_list[j].numberofelements =
-            _emm_data.conf.tai_list.partial_tai_list[i].numberofelements;
+            served_tai_list->partial_tai_list[i].numberofelements;
           tai_list->partial_tai_list[j].typeoflist =
-            _emm_data.conf.tai_list.partial_tai_list[i].typeoflist;
+            served_tai_list->partial_tai_list[i].typeoflist;
 
           tai_list->partial_tai_list[j]
             .u.tai_one_plmn_non_consecutive_tacs.mcc_digit1 =
@@ -556,13 +579,13 @@ int mme_api_new_guti(
           tai_list->partial_tai_list[j]
             .u.tai_one_plmn_non_consecutive_tacs.mnc_digit3 =
             guti->gummei.plmn.mnc_digit3;
-          // _emm_data.conf.tai_list is sorted
+          // served_tai_list is sorted
           for (int t = 0;
                t < (tai_list->partial_tai_list[j].numberofelements + 1);
                t++) {
             tai_list->partial_tai_list[j]
               .u.tai_one_plmn_non_consecutive_tacs.tac[t] =
-              _emm_data.conf.tai_list.partial_tai_list[i]
+              served_tai_list->partial_tai_list[i]
                 .u.tai_one_plmn_non_consecutive_tacs.tac[t];
           }
           j += 1;
@@ -570,28 +593,28 @@ int mme_api_new_guti(
         break;
       case TRACKING_AREA_IDENTITY_LIST_ONE_PLMN_CONSECUTIVE_TACS:
         if (
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_consecutive_tacs.mcc_digit1 ==
            guti->gummei.plmn.mcc_digit1) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_consecutive_tacs.mcc_digit2 ==
            guti->gummei.plmn.mcc_digit2) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_consecutive_tacs.mcc_digit3 ==
            guti->gummei.plmn.mcc_digit3) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_consecutive_tacs.mnc_digit1 ==
            guti->gummei.plmn.mnc_digit1) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_consecutive_tacs.mnc_digit2 ==
            guti->gummei.plmn.mnc_digit2) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_consecutive_tacs.mnc_digit3 ==
            guti->gummei.plmn.mnc_digit3)) {
           tai_list->partial_tai_list[j].numberofelements =
-            _emm_data.conf.tai_list.partial_tai_list[i].numberofelements;
+            served_tai_list->partial_tai_list[i].numberofelements;
           tai_list->partial_tai_list[j].typeoflist =
-            _emm_data.conf.tai_list.partial_tai_list[i].typeoflist;
+            served_tai_list->partial_tai_list[i].typeoflist;
 
           tai_list->partial_tai_list[j]
             .u.tai_one_plmn_consecutive_tacs.mcc_digit1 =
@@ -611,37 +634,37 @@ int mme_api_new_guti(
           tai_list->partial_tai_list[j]
             .u.tai_one_plmn_consecutive_tacs.mnc_digit3 =
             guti->gummei.plmn.mnc_digit3;
-          // _emm_data.conf.tai_list is sorted
+          // served_tai_list is sorted
           tai_list->partial_tai_list[j].u.tai_one_plmn_consecutive_tacs.tac =
-            _emm_data.conf.tai_list.partial_tai_list[i]
+            served_tai_list->partial_tai_list[i]
               .u.tai_one_plmn_consecutive_tacs.tac;
           j += 1;
         }
         break;
       case TRACKING_AREA_IDENTITY_LIST_MANY_PLMNS:
         if (
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mcc_digit1 ==
            guti->gummei.plmn.mcc_digit1) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mcc_digit2 ==
            guti->gummei.plmn.mcc_digit2) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mcc_digit3 ==
            guti->gummei.plmn.mcc_digit3) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mnc_digit1 ==
            guti->gummei.plmn.mnc_digit1) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mnc_digit2 ==
            guti->gummei.plmn.mnc_digit2) &&
-          (_emm_data.conf.tai_list.partial_tai_list[i]
+          (served_tai_list->partial_tai_list[i]
              .u.tai_one_plmn_non_consecutive_tacs.mnc_digit3 ==
            guti->gummei.plmn.mnc_digit3)) {
           tai_list->partial_tai_list[j].numberofelements =
-            _emm_data.conf.tai_list.partial_tai_list[i].numberofelements;
+            served_tai_list->partial_tai_list[i].numberofelements;
           tai_list->partial_tai_list[j].typeoflist =
-            _emm_data.conf.tai_list.partial_tai_list[i].typeoflist;
+            served_tai_list->partial_tai_list[i].typeoflist;
 
           for (int t = 0;
                t < (tai_list->partial_tai_list[j].numberofelements + 1);
@@ -658,9 +681,9 @@ int mme_api_new_guti(
               guti->gummei.plmn.mnc_digit2;
             tai_list->partial_tai_list[j].u.tai_many_plmn[t].mnc_digit3 =
               guti->gummei.plmn.mnc_digit3;
-            // _emm_data.conf.tai_list is sorted
+            // served_tai_list is sorted
             tai_list->partial_tai_list[j].u.tai_many_plmn[t].tac =
-              _emm_data.conf.tai_list.partial_tai_list[i]
+              served_tai_list->partial_tai_list[i]
                 .u.tai_many_plmn[t]
                 .tac;
           }
@@ -671,10 +694,11 @@ int mme_api_new_guti(
         AssertFatal(
           0,
           "BAD TAI list configuration, unknown TAI list type %u",
-          _emm_data.conf.tai_list.partial_tai_list[i].typeoflist);
+          served_tai_list->partial_tai_list[i].typeoflist);
     }
   }
   tai_list->numberoflists = j;
+  mme_config_snapshot_put(config_snapshot);
   OAILOG_INFO(
     LOG_NAS,
     "UE " MME_UE_S1AP_ID_FMT "  Got GUTI " GUTI_FMT "\n",
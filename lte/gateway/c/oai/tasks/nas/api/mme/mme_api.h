@@ -129,6 +129,11 @@ typedef struct mme_api_tft_s {
 /******************  E X P O R T E D    F U N C T I O N S  ******************/
 /****************************************************************************/
 struct mme_config_s;
+struct served_tai_s;
+
+int mme_api_get_tai_list(
+  const struct served_tai_s *const served_tai,
+  tai_list_t *const tai_list);
 
 int mme_api_get_emm_config(
   mme_api_emm_config_t *config,
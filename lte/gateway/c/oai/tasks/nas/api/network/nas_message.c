@@ -915,8 +915,13 @@ static int _nas_message_protected_decode(
 {
   OAILOG_FUNC_IN(LOG_NAS);
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char *const plain_msg = (unsigned char *) calloc(1, length);
+  // In zero-copy mode, the IEs are views into the deciphered message
+  unsigned char *plain_msg = tlv_decode_arena_alloc(length);
+  const bool is_arena_msg = (plain_msg != NULL);
 
+  if (!is_arena_msg) {
+    plain_msg = (unsigned char *) calloc(1, length);
+  }
   if (plain_msg) {
     /*
      * Decrypt the security protected NAS message
@@ -934,7 +939,9 @@ static int _nas_message_protected_decode(
      * Decode the decrypted message as plain NAS message
      */
     bytes = _nas_message_plain_decode(plain_msg, header, msg, length);
-    free_wrapper((void **) &plain_msg);
+    if (!is_arena_msg) {
+      free_wrapper((void **) &plain_msg);
+    }
   }
 
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
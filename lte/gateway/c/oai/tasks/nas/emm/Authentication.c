@@ -75,6 +75,7 @@
 #include "emm_sap.h"
 #include "emm_cause.h"
 #include "nas_itti_messaging.h"
+#include "nas_auth_vector_cache.h"
 #include "service303.h"
 #include "mme_app_defs.h"
 #include "EmmCommon.h"
@@ -110,6 +111,12 @@ static int _authentication_abort(
   struct emm_context_s *emm_context,
   struct nas_base_proc_s *base_proc);
 
+static void _auth_info_visited_plmn(
+  const struct emm_context_s *const emm_context,
+  plmn_t *const visited_plmn);
+static bool _auth_vector_cache_load(
+  struct emm_context_s *emm_context,
+  ksi_t *const eksi);
 static int _start_authentication_information_procedure(
   struct emm_context_s *emm_context,
   nas_emm_auth_proc_t *const auth_proc,
@@ -314,6 +321,18 @@ int emm_proc_authentication(
       // Ask upper layer to fetch new security context
       nas_auth_info_proc_t *auth_info_proc =
         get_nas_cn_procedure_auth_info(emm_context);
+      ksi_t eksi = 0;
+      if ((!auth_info_proc) && _auth_vector_cache_load(emm_context, &eksi)) {
+        rc = emm_proc_authentication_ksi(
+          emm_context,
+          emm_specific_proc,
+          eksi,
+          emm_context->_vector[eksi % MAX_EPS_AUTH_VECTORS].rand,
+          emm_context->_vector[eksi % MAX_EPS_AUTH_VECTORS].autn,
+          success,
+          failure);
+        OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
+      }
       if (!auth_info_proc) {
         auth_info_proc = nas_new_cn_auth_info_procedure(emm_context);
       }
@@ -358,6 +377,85 @@ int emm_proc_authentication(
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
 }
 
+//------------------------------------------------------------------------------
+static void _auth_info_visited_plmn(
+  const struct emm_context_s *const emm_context,
+  plmn_t *const visited_plmn)
+{
+  visited_plmn->mcc_digit1 = emm_context->originating_tai.mcc_digit1;
+  visited_plmn->mcc_digit2 = emm_context->originating_tai.mcc_digit2;
+  visited_plmn->mcc_digit3 = emm_context->originating_tai.mcc_digit3;
+  visited_plmn->mnc_digit1 = emm_context->originating_tai.mnc_digit1;
+  visited_plmn->mnc_digit2 = emm_context->originating_tai.mnc_digit2;
+  visited_plmn->mnc_digit3 = emm_context->originating_tai.mnc_digit3;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Take a vector of the subscriber from the authentication vector cache and
+ * install it in the EMM context for the next eKSI, so that the procedure can
+ * start without an S6a round trip. Prefetches more vectors in the background
+ * when the subscriber runs low.
+ */
+static bool _auth_vector_cache_load(
+  struct emm_context_s *emm_context,
+  ksi_t *const eksi)
+{
+  OAILOG_FUNC_IN(LOG_NAS_EMM);
+  mme_ue_s1ap_id_t ue_id =
+    PARENT_STRUCT(emm_context, struct ue_mm_context_s, emm_context)
+      ->mme_ue_s1ap_id;
+  eutran_vector_t vector = {0};
+  bool prefetch = false;
+
+  if (
+    (nas_auth_vector_cache_vectors_per_air() <= MAX_EPS_AUTH_VECTORS) ||
+    (!IS_EMM_CTXT_VALID_IMSI(emm_context))) {
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, false);
+  }
+  if (!nas_auth_vector_cache_get(emm_context->_imsi64, &vector, &prefetch)) {
+    increment_counter("mme_auth_vector_cache", 1, 1, "result", "miss");
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, false);
+  }
+  increment_counter("mme_auth_vector_cache", 1, 1, "result", "hit");
+
+  *eksi = 0;
+  if (emm_context->_security.eksi < KSI_NO_KEY_AVAILABLE) {
+    REQUIREMENT_3GPP_24_301(R10_5_4_2_4__2);
+    *eksi = (emm_context->_security.eksi + 1) % (EKSI_MAX_VALUE + 1);
+  }
+  int index = *eksi % MAX_EPS_AUTH_VECTORS;
+  memcpy(emm_context->_vector[index].kasme, vector.kasme, AUTH_KASME_SIZE);
+  memcpy(emm_context->_vector[index].autn, vector.autn, AUTH_AUTN_SIZE);
+  memcpy(emm_context->_vector[index].rand, vector.rand, AUTH_RAND_SIZE);
+  memcpy(emm_context->_vector[index].xres, vector.xres.data, vector.xres.size);
+  emm_context->_vector[index].xres_size = vector.xres.size;
+  memset(&vector, 0, sizeof(vector));
+  emm_ctx_set_attribute_valid(
+    emm_context, EMM_CTXT_MEMBER_AUTH_VECTOR0 + index);
+  emm_ctx_set_attribute_present(emm_context, EMM_CTXT_MEMBER_AUTH_VECTORS);
+  OAILOG_DEBUG(
+    LOG_NAS_EMM,
+    "ue_id=" MME_UE_S1AP_ID_FMT
+    " EMM-PROC  - Using cached authentication vector for eKSI %d\n",
+    ue_id,
+    *eksi);
+
+  if (prefetch) {
+    plmn_t visited_plmn = {0};
+    _auth_info_visited_plmn(emm_context, &visited_plmn);
+    nas_itti_auth_info_req(
+      ue_id,
+      &emm_context->_imsi,
+      true,
+      true,
+      &visited_plmn,
+      nas_auth_vector_cache_vectors_per_air(),
+      NULL);
+  }
+  OAILOG_FUNC_RETURN(LOG_NAS_EMM, true);
+}
+
 //------------------------------------------------------------------------------
 static int _start_authentication_information_procedure(
   struct emm_context_s *emm_context,
@@ -388,14 +486,13 @@ static int _start_authentication_information_procedure(
   auth_info_proc->resync = auth_info_proc->request_sent;
 
   plmn_t visited_plmn = {0};
-  visited_plmn.mcc_digit1 = emm_context->originating_tai.mcc_digit1;
-  visited_plmn.mcc_digit2 = emm_context->originating_tai.mcc_digit2;
-  visited_plmn.mcc_digit3 = emm_context->originating_tai.mcc_digit3;
-  visited_plmn.mnc_digit1 = emm_context->originating_tai.mnc_digit1;
-  visited_plmn.mnc_digit2 = emm_context->originating_tai.mnc_digit2;
-  visited_plmn.mnc_digit3 = emm_context->originating_tai.mnc_digit3;
+  _auth_info_visited_plmn(emm_context, &visited_plmn);
 
   bool is_initial_req = !(auth_info_proc->request_sent);
+  if (!is_initial_req) {
+    // The SQN of the USIM is being re-synchronised, cached vectors are stale
+    nas_auth_vector_cache_flush(emm_context->_imsi64);
+  }
   auth_info_proc->request_sent = true;
   nas_start_Ts6a_auth_info(
     auth_info_proc->ue_id,
@@ -407,8 +504,9 @@ static int _start_authentication_information_procedure(
     ue_id,
     &emm_context->_imsi,
     is_initial_req,
+    false,
     &visited_plmn,
-    MAX_EPS_AUTH_VECTORS,
+    nas_auth_vector_cache_vectors_per_air(),
     auts);
 
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, RETURNok);
@@ -744,6 +842,8 @@ int emm_proc_authentication_failure(
         REQUIREMENT_3GPP_24_301(R10_5_4_2_7_c__2);
         auth_proc->mac_fail_count++;
         auth_proc->sync_fail_count = 0;
+        // Do not try the other vectors fetched along with the rejected one
+        nas_auth_vector_cache_flush(emm_ctx->_imsi64);
         if (!IS_EMM_CTXT_PRESENT_IMSI(
               emm_ctx)) { // VALID means received in IDENTITY RESPONSE
           if (1 == auth_proc->mac_fail_count) {
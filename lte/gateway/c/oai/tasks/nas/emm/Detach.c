@@ -606,7 +606,7 @@ int emm_proc_nw_initiated_detach_request(
       nw_detach_data_t *data = (nw_detach_data_t *) emm_ctx->t3422_arg;
       ;
       emm_ctx->T3422.id = nas_timer_start(
-        emm_ctx->T3422.sec, 0, _detach_t3422_handler, (void *) data);
+        emm_ctx->T3422.sec, 0, ue_id, _detach_t3422_handler, (void *) data);
     } else {
       /*
        * Start T3422 timer
@@ -618,7 +618,7 @@ int emm_proc_nw_initiated_detach_request(
       data->retransmission_count = 0;
       data->detach_type = detach_type;
       emm_ctx->T3422.id = nas_timer_start(
-        emm_ctx->T3422.sec, 0, _detach_t3422_handler, (void *) data);
+        emm_ctx->T3422.sec, 0, ue_id, _detach_t3422_handler, (void *) data);
       emm_ctx->t3422_arg = (void *) data;
     }
   }
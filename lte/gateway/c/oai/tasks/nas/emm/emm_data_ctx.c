@@ -977,8 +977,8 @@ void nas_start_T3450(
   void *timer_callback_args)
 {
   if ((T3450) && (T3450->id == NAS_TIMER_INACTIVE_ID)) {
-    T3450->id =
-      nas_timer_start(T3450->sec, 0, time_out_cb, timer_callback_args);
+    T3450->id = nas_timer_start(
+      T3450->sec, 0, ue_id, time_out_cb, timer_callback_args);
     if (NAS_TIMER_INACTIVE_ID != T3450->id) {
       MSC_LOG_EVENT(
         MSC_NAS_EMM_MME, "0 T3450 started UE " MME_UE_S1AP_ID_FMT " ", ue_id);
@@ -998,8 +998,8 @@ void nas_start_T3460(
   void *timer_callback_args)
 {
   if ((T3460) && (T3460->id == NAS_TIMER_INACTIVE_ID)) {
-    T3460->id =
-      nas_timer_start(T3460->sec, 0, time_out_cb, timer_callback_args);
+    T3460->id = nas_timer_start(
+      T3460->sec, 0, ue_id, time_out_cb, timer_callback_args);
     if (NAS_TIMER_INACTIVE_ID != T3460->id) {
       MSC_LOG_EVENT(
         MSC_NAS_EMM_MME, "0 T3460 started UE " MME_UE_S1AP_ID_FMT " ", ue_id);
@@ -1019,8 +1019,8 @@ void nas_start_T3470(
   void *timer_callback_args)
 {
   if ((T3470) && (T3470->id == NAS_TIMER_INACTIVE_ID)) {
-    T3470->id =
-      nas_timer_start(T3470->sec, 0, time_out_cb, timer_callback_args);
+    T3470->id = nas_timer_start(
+      T3470->sec, 0, ue_id, time_out_cb, timer_callback_args);
     if (NAS_TIMER_INACTIVE_ID != T3470->id) {
       MSC_LOG_EVENT(
         MSC_NAS_EMM_MME, "0 T3470 started UE " MME_UE_S1AP_ID_FMT " ", ue_id);
@@ -1040,8 +1040,8 @@ void nas_start_Ts6a_auth_info(
   void *timer_callback_args)
 {
   if ((Ts6a_auth_info) && (Ts6a_auth_info->id == NAS_TIMER_INACTIVE_ID)) {
-    Ts6a_auth_info->id =
-      nas_timer_start(Ts6a_auth_info->sec, 0, time_out_cb, timer_callback_args);
+    Ts6a_auth_info->id = nas_timer_start(
+      Ts6a_auth_info->sec, 0, ue_id, time_out_cb, timer_callback_args);
     if (NAS_TIMER_INACTIVE_ID != Ts6a_auth_info->id) {
       MSC_LOG_EVENT(
         MSC_NAS_EMM_MME,
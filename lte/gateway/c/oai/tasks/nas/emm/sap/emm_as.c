@@ -72,6 +72,8 @@
 #include "service303.h"
 #include "conversions.h"
 #include "common_ies.h"
+#include "mme_config.h"
+#include "TLVDecoder.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -116,6 +118,13 @@ static int _emm_as_recv(
   int *emm_cause,
   nas_message_decode_status_t *decode_status);
 
+static int _emm_as_decode(
+  const_bstring pdu,
+  size_t len,
+  nas_message_t *nas_msg,
+  emm_security_context_t *emm_security_context,
+  nas_message_decode_status_t *decode_status,
+  tlv_decode_arena_t *arena);
 static int _emm_as_establish_req(emm_as_establish_t *msg, int *emm_cause);
 static int _emm_as_data_ind(emm_as_data_t *msg, int *emm_cause);
 static int _emm_as_release_ind(
@@ -229,6 +238,8 @@ int emm_as_send(emm_as_t *msg)
     case _EMMAS_ESTABLISH_REQ:
       rc = _emm_as_establish_req(&msg->u.establish, &emm_cause);
       ue_id = msg->u.establish.ue_id;
+      // Released once processed, the decoded IEs may point into it
+      bdestroy_wrapper(&msg->u.establish.nas_msg);
       break;
 
     case _EMMAS_RELEASE_IND:
@@ -349,6 +360,7 @@ static int _emm_as_recv(
                            .security_protected.plain.esm.header = {0}};
   emm_security_context_t *emm_security_context =
     NULL; /* Current EPS NAS security context     */
+  tlv_decode_arena_t arena;
 
   if (decode_status) {
     OAILOG_INFO(
@@ -388,8 +400,8 @@ static int _emm_as_recv(
   /*
    * Decode the received message
    */
-  decoder_rc = nas_message_decode(
-    msg->data, &nas_msg, len, emm_security_context, decode_status);
+  decoder_rc = _emm_as_decode(
+    msg, len, &nas_msg, emm_security_context, decode_status, &arena);
 
   if (decoder_rc < 0) {
     OAILOG_WARNING(
@@ -828,6 +840,7 @@ static int _emm_as_establish_req(emm_as_establish_t *msg, int *emm_cause)
   int decoder_rc = 0;
   int rc = RETURNerror;
   tai_t originating_tai = {0};
+  tlv_decode_arena_t arena;
 
   OAILOG_INFO(
     LOG_NAS_EMM, "EMMAS-SAP - Received AS connection establish request\n");
@@ -851,13 +864,13 @@ static int _emm_as_establish_req(emm_as_establish_t *msg, int *emm_cause)
   /*
    * Decode initial NAS message
    */
-  decoder_rc = nas_message_decode(
-    msg->nas_msg->data,
-    &nas_msg,
+  decoder_rc = _emm_as_decode(
+    msg->nas_msg,
     blength(msg->nas_msg),
+    &nas_msg,
     emm_security_context,
-    &decode_status);
-  bdestroy_wrapper(&msg->nas_msg);
+    &decode_status,
+    &arena);
 
   // TODO conditional IE error
   if (decoder_rc < 0) {
@@ -1050,6 +1063,59 @@ static int _emm_as_establish_req(emm_as_establish_t *msg, int *emm_cause)
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
 }
 
+//------------------------------------------------------------------------------
+/* Decode a NAS message received from the UE. With ZERO_COPY_DECODE, the
+ * variable length IEs are views into pdu or into the arena, which must both
+ * outlive the processing of nas_msg. The IEs that the EMM procedures keep
+ * afterwards are copied out here. */
+static int _emm_as_decode(
+  const_bstring pdu,
+  size_t len,
+  nas_message_t *nas_msg,
+  emm_security_context_t *emm_security_context,
+  nas_message_decode_status_t *decode_status,
+  tlv_decode_arena_t *arena)
+{
+  EMM_msg *emm_msg = &nas_msg->plain.emm;
+  int decoder_rc = RETURNerror;
+
+  if (!mme_config.nas_config.zero_copy_decode) {
+    return nas_message_decode(
+      pdu->data, nas_msg, len, emm_security_context, decode_status);
+  }
+
+  tlv_decode_arena_begin(arena);
+  decoder_rc = nas_message_decode(
+    pdu->data, nas_msg, len, emm_security_context, decode_status);
+  tlv_decode_arena_end(arena);
+
+  switch (emm_msg->header.message_type) {
+    case ATTACH_REQUEST:
+      // Moved into the attach procedure
+      emm_msg->attach_request.esmmessagecontainer =
+        tlv_decode_bstring_own(emm_msg->attach_request.esmmessagecontainer);
+      break;
+
+    case TRACKING_AREA_UPDATE_REQUEST:
+      // Referenced by the IEs of the TAU procedure
+      emm_msg->tracking_area_update_request.supportedcodecs =
+        tlv_decode_bstring_own(
+          emm_msg->tracking_area_update_request.supportedcodecs);
+      break;
+
+    case UPLINK_NAS_TRANSPORT:
+      // Forwarded to the SGS task
+      emm_msg->uplink_nas_transport.nasmessagecontainer =
+        tlv_decode_bstring_own(
+          emm_msg->uplink_nas_transport.nasmessagecontainer);
+      break;
+
+    default:
+      break;
+  }
+  return decoder_rc;
+}
+
 //------------------------------------------------------------------------------
 static int _emm_as_release_ind(
   const emm_as_release_t *const release,
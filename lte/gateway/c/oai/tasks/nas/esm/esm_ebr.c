@@ -318,8 +318,12 @@ int esm_ebr_start_timer(
      */
     ebr_ctx->timer.id =
       nas_timer_stop(ebr_ctx->timer.id, (void **) &esm_ebr_timer_data);
-    ebr_ctx->timer.id =
-      nas_timer_start(sec, 0 /* usec */, cb, esm_ebr_timer_data);
+    ebr_ctx->timer.id = nas_timer_start(
+      sec,
+      0 /* usec */,
+      ue_mm_context->mme_ue_s1ap_id,
+      cb,
+      esm_ebr_timer_data);
     MSC_LOG_EVENT(
       MSC_NAS_ESM_MME, "0 Timer %x ebi %u restarted", ebr_ctx->timer.id, ebi);
   } else {
@@ -352,8 +356,12 @@ int esm_ebr_start_timer(
        * Setup the retransmission timer to expire at the given
        * * * * time interval
        */
-      ebr_ctx->timer.id =
-        nas_timer_start(sec, 0 /* usec */, cb, esm_ebr_timer_data);
+      ebr_ctx->timer.id = nas_timer_start(
+        sec,
+        0 /* usec */,
+        ue_mm_context->mme_ue_s1ap_id,
+        cb,
+        esm_ebr_timer_data);
       MSC_LOG_EVENT(
         MSC_NAS_ESM_MME, "0 Timer %x ebi %u started", ebr_ctx->timer.id, ebi);
       ebr_ctx->timer.sec = sec;
@@ -307,6 +307,7 @@ static int _esm_information(
     ue_context->esm_ctx.T3489.id = nas_timer_start(
       ue_context->esm_ctx.T3489.sec,
       0 /*usec*/,
+      ue_id,
       _esm_information_t3489_handler,
       data);
     MSC_LOG_EVENT(
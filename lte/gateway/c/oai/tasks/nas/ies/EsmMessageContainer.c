@@ -44,6 +44,9 @@ int decode_esm_message_container(
 
   OAILOG_FUNC_IN(LOG_NAS_ESM);
 
+  CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+    buffer, ESM_MESSAGE_CONTAINER_MINIMUM_LENGTH + (iei > 0), len);
+
   if (iei > 0) {
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
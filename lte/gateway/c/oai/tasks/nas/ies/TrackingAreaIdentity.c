@@ -30,6 +30,7 @@
 #include "TLVEncoder.h"
 #include "TLVDecoder.h"
 #include "TrackingAreaIdentity.h"
+#include "log.h"
 
 //------------------------------------------------------------------------------
 int decode_tracking_area_identity(
@@ -40,6 +41,10 @@ int decode_tracking_area_identity(
 {
   int decoded = 0;
 
+  // The minimum length includes the IEI
+  CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+    buffer, TRACKING_AREA_IDENTITY_MINIMUM_LENGTH - (iei == 0), len);
+
   if (iei > 0) {
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
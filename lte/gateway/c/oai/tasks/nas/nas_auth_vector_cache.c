@@ -0,0 +1,494 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_auth_vector_cache.c
+   \brief Per subscriber cache of the unused EPS authentication vectors
+
+   The cache is split in shards, each one with its own lock, hash table and
+   list of entries ordered by last refill. The UE workers only contend when
+   they handle subscribers of the same shard. Expired entries are reclaimed
+   a few at a time from the tail of that list by every operation, so that no
+   timer is needed.
+*/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "3gpp_33.401.h"
+#include "nas_auth_vector_cache.h"
+
+#define NAS_AUTH_VECTOR_CACHE_SHARDS 16
+#define NAS_AUTH_VECTOR_CACHE_MIN_BUCKETS 16
+// Expired entries reclaimed by each operation on a shard
+#define NAS_AUTH_VECTOR_CACHE_SWEEP 2
+
+typedef struct nas_auth_vector_cache_slot_s {
+  uint64_t fetched_sec;
+  eutran_vector_t vector;
+} nas_auth_vector_cache_slot_t;
+
+typedef struct nas_auth_vector_cache_entry_s {
+  imsi64_t imsi64;
+  struct nas_auth_vector_cache_entry_s *hash_next;
+  struct nas_auth_vector_cache_entry_s *lru_prev; // more recently refilled
+  struct nas_auth_vector_cache_entry_s *lru_next; // less recently refilled
+  uint64_t refilled_sec;
+  bool prefetch_pending;
+  uint8_t first;
+  uint8_t nb_vectors;
+  // ring of _cache.capacity vectors, oldest (lowest SQN) first
+  nas_auth_vector_cache_slot_t slot[];
+} nas_auth_vector_cache_entry_t;
+
+typedef struct nas_auth_vector_cache_shard_s {
+  pthread_mutex_t lock;
+  nas_auth_vector_cache_entry_t **buckets;
+  uint32_t bucket_mask;
+  uint32_t nb_entries;
+  uint32_t max_entries;
+  nas_auth_vector_cache_entry_t *lru_head;
+  nas_auth_vector_cache_entry_t *lru_tail;
+  nas_auth_vector_cache_stats_t stats;
+} nas_auth_vector_cache_shard_t;
+
+static struct {
+  bool enabled;
+  nas_auth_vector_cache_config_t config;
+  uint8_t capacity;
+  nas_auth_vector_cache_shard_t shards[NAS_AUTH_VECTOR_CACHE_SHARDS];
+} _cache = {0};
+
+//------------------------------------------------------------------------------
+static uint64_t _nas_auth_vector_cache_monotonic_sec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t _nas_auth_vector_cache_hash(const imsi64_t imsi64)
+{
+  // IMSIs of a network mostly differ by their last digits, spread them
+  uint64_t h = imsi64 ^ (imsi64 >> 29);
+
+  h *= 0x9E3779B97F4A7C15ULL;
+  return h ^ (h >> 32);
+}
+
+//------------------------------------------------------------------------------
+static inline nas_auth_vector_cache_shard_t *_nas_auth_vector_cache_shard(
+  const uint64_t hash)
+{
+  return &_cache.shards[hash % NAS_AUTH_VECTOR_CACHE_SHARDS];
+}
+
+//------------------------------------------------------------------------------
+static inline nas_auth_vector_cache_entry_t **_nas_auth_vector_cache_bucket(
+  nas_auth_vector_cache_shard_t *const shard,
+  const uint64_t hash)
+{
+  return &shard->buckets
+            [(hash / NAS_AUTH_VECTOR_CACHE_SHARDS) & shard->bucket_mask];
+}
+
+//------------------------------------------------------------------------------
+static nas_auth_vector_cache_entry_t *_nas_auth_vector_cache_find(
+  nas_auth_vector_cache_shard_t *const shard,
+  const uint64_t hash,
+  const imsi64_t imsi64)
+{
+  nas_auth_vector_cache_entry_t *entry =
+    *_nas_auth_vector_cache_bucket(shard, hash);
+
+  while (entry && (entry->imsi64 != imsi64)) {
+    entry = entry->hash_next;
+  }
+  return entry;
+}
+
+//------------------------------------------------------------------------------
+static void _nas_auth_vector_cache_lru_unlink(
+  nas_auth_vector_cache_shard_t *const shard,
+  nas_auth_vector_cache_entry_t *const entry)
+{
+  if (entry->lru_prev) {
+    entry->lru_prev->lru_next = entry->lru_next;
+  } else {
+    shard->lru_head = entry->lru_next;
+  }
+  if (entry->lru_next) {
+    entry->lru_next->lru_prev = entry->lru_prev;
+  } else {
+    shard->lru_tail = entry->lru_prev;
+  }
+  entry->lru_prev = NULL;
+  entry->lru_next = NULL;
+}
+
+//------------------------------------------------------------------------------
+static void _nas_auth_vector_cache_lru_push(
+  nas_auth_vector_cache_shard_t *const shard,
+  nas_auth_vector_cache_entry_t *const entry)
+{
+  entry->lru_next = shard->lru_head;
+  if (shard->lru_head) {
+    shard->lru_head->lru_prev = entry;
+  } else {
+    shard->lru_tail = entry;
+  }
+  shard->lru_head = entry;
+}
+
+//------------------------------------------------------------------------------
+static void _nas_auth_vector_cache_remove(
+  nas_auth_vector_cache_shard_t *const shard,
+  nas_auth_vector_cache_entry_t *const entry)
+{
+  nas_auth_vector_cache_entry_t **link = _nas_auth_vector_cache_bucket(
+    shard, _nas_auth_vector_cache_hash(entry->imsi64));
+
+  while (*link != entry) {
+    link = &(*link)->hash_next;
+  }
+  *link = entry->hash_next;
+  _nas_auth_vector_cache_lru_unlink(shard, entry);
+  shard->nb_entries--;
+  // Do not leave key material behind in the heap
+  memset(
+    entry,
+    0,
+    sizeof(*entry) + _cache.capacity * sizeof(nas_auth_vector_cache_slot_t));
+  free(entry);
+}
+
+//------------------------------------------------------------------------------
+static void _nas_auth_vector_cache_sweep(
+  nas_auth_vector_cache_shard_t *const shard,
+  const uint64_t now)
+{
+  for (int i = 0; i < NAS_AUTH_VECTOR_CACHE_SWEEP; i++) {
+    nas_auth_vector_cache_entry_t *entry = shard->lru_tail;
+
+    if (
+      (!entry) ||
+      ((entry->refilled_sec + _cache.config.lifetime_sec) > now)) {
+      return;
+    }
+    shard->stats.expired += entry->nb_vectors;
+    _nas_auth_vector_cache_remove(shard, entry);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void _nas_auth_vector_cache_drop_expired(
+  nas_auth_vector_cache_shard_t *const shard,
+  nas_auth_vector_cache_entry_t *const entry,
+  const uint64_t now)
+{
+  while (
+    (entry->nb_vectors > 0) &&
+    ((entry->slot[entry->first].fetched_sec + _cache.config.lifetime_sec) <=
+     now)) {
+    memset(&entry->slot[entry->first], 0, sizeof(entry->slot[0]));
+    entry->first = (entry->first + 1) % _cache.capacity;
+    entry->nb_vectors--;
+    shard->stats.expired++;
+  }
+}
+
+//------------------------------------------------------------------------------
+int nas_auth_vector_cache_init(const nas_auth_vector_cache_config_t *config)
+{
+  uint32_t nb_buckets = NAS_AUTH_VECTOR_CACHE_MIN_BUCKETS;
+
+  memset(&_cache, 0, sizeof(_cache));
+  if (config->vectors_per_air <= MAX_EPS_AUTH_VECTORS) {
+    OAILOG_INFO(LOG_NAS, "Authentication vector cache disabled\n");
+    return RETURNok;
+  }
+  if (
+    (config->vectors_per_air > MAX_EPS_AUTH_VECTORS_PER_AIR) ||
+    (config->low_water_mark >= config->vectors_per_air) ||
+    (config->lifetime_sec == 0) || (config->max_ues == 0)) {
+    OAILOG_ERROR(
+      LOG_NAS,
+      "Invalid authentication vector cache config: %u vectors per AIR "
+      "(max %u), low water mark %u, lifetime %u s, %u UEs\n",
+      config->vectors_per_air,
+      MAX_EPS_AUTH_VECTORS_PER_AIR,
+      config->low_water_mark,
+      config->lifetime_sec,
+      config->max_ues);
+    return RETURNerror;
+  }
+
+  _cache.config = *config;
+  if (!_cache.config.now_sec) {
+    _cache.config.now_sec = _nas_auth_vector_cache_monotonic_sec;
+  }
+  // room for a batch fetched on a miss and a prefetched one
+  _cache.capacity = 2 * config->vectors_per_air;
+
+  uint32_t max_entries =
+    (config->max_ues + NAS_AUTH_VECTOR_CACHE_SHARDS - 1) /
+    NAS_AUTH_VECTOR_CACHE_SHARDS;
+  while (nb_buckets < max_entries) {
+    nb_buckets <<= 1;
+  }
+  for (int i = 0; i < NAS_AUTH_VECTOR_CACHE_SHARDS; i++) {
+    nas_auth_vector_cache_shard_t *shard = &_cache.shards[i];
+
+    pthread_mutex_init(&shard->lock, NULL);
+    shard->max_entries = max_entries;
+    shard->bucket_mask = nb_buckets - 1;
+    shard->buckets = calloc(nb_buckets, sizeof(*shard->buckets));
+    if (!shard->buckets) {
+      nas_auth_vector_cache_exit();
+      return RETURNerror;
+    }
+  }
+  _cache.enabled = true;
+  OAILOG_INFO(
+    LOG_NAS,
+    "Authentication vector cache: %u vectors per AIR, prefetch below %u, "
+    "lifetime %u s, %u UEs\n",
+    config->vectors_per_air,
+    config->low_water_mark,
+    config->lifetime_sec,
+    config->max_ues);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void nas_auth_vector_cache_exit(void)
+{
+  for (int i = 0; i < NAS_AUTH_VECTOR_CACHE_SHARDS; i++) {
+    nas_auth_vector_cache_shard_t *shard = &_cache.shards[i];
+
+    if (!shard->buckets) {
+      continue;
+    }
+    while (shard->lru_head) {
+      _nas_auth_vector_cache_remove(shard, shard->lru_head);
+    }
+    free(shard->buckets);
+    shard->buckets = NULL;
+    pthread_mutex_destroy(&shard->lock);
+  }
+  _cache.enabled = false;
+}
+
+//------------------------------------------------------------------------------
+uint8_t nas_auth_vector_cache_vectors_per_air(void)
+{
+  return _cache.enabled ? _cache.config.vectors_per_air : MAX_EPS_AUTH_VECTORS;
+}
+
+//------------------------------------------------------------------------------
+bool nas_auth_vector_cache_get(
+  const imsi64_t imsi64,
+  eutran_vector_t *const vector,
+  bool *const prefetch)
+{
+  bool hit = false;
+
+  *prefetch = false;
+  if (!_cache.enabled) {
+    return false;
+  }
+  uint64_t hash = _nas_auth_vector_cache_hash(imsi64);
+  nas_auth_vector_cache_shard_t *shard = _nas_auth_vector_cache_shard(hash);
+  uint64_t now = _cache.config.now_sec();
+
+  pthread_mutex_lock(&shard->lock);
+  _nas_auth_vector_cache_sweep(shard, now);
+  nas_auth_vector_cache_entry_t *entry =
+    _nas_auth_vector_cache_find(shard, hash, imsi64);
+  if (entry) {
+    _nas_auth_vector_cache_drop_expired(shard, entry, now);
+  }
+  if (entry && entry->nb_vectors) {
+    *vector = entry->slot[entry->first].vector;
+    memset(&entry->slot[entry->first], 0, sizeof(entry->slot[0]));
+    entry->first = (entry->first + 1) % _cache.capacity;
+    entry->nb_vectors--;
+    shard->stats.hits++;
+    hit = true;
+    if (
+      (entry->nb_vectors < _cache.config.low_water_mark) &&
+      (!entry->prefetch_pending)) {
+      entry->prefetch_pending = true;
+      shard->stats.prefetches++;
+      *prefetch = true;
+    }
+  } else {
+    shard->stats.misses++;
+  }
+  if (entry && (entry->nb_vectors == 0) && (!entry->prefetch_pending)) {
+    _nas_auth_vector_cache_remove(shard, entry);
+  }
+  pthread_mutex_unlock(&shard->lock);
+  return hit;
+}
+
+//------------------------------------------------------------------------------
+void nas_auth_vector_cache_put(
+  const imsi64_t imsi64,
+  const eutran_vector_t *const vectors,
+  const uint8_t nb_vectors,
+  const bool prefetch)
+{
+  if (!_cache.enabled) {
+    return;
+  }
+  uint64_t hash = _nas_auth_vector_cache_hash(imsi64);
+  nas_auth_vector_cache_shard_t *shard = _nas_auth_vector_cache_shard(hash);
+  uint64_t now = _cache.config.now_sec();
+
+  pthread_mutex_lock(&shard->lock);
+  _nas_auth_vector_cache_sweep(shard, now);
+  nas_auth_vector_cache_entry_t *entry =
+    _nas_auth_vector_cache_find(shard, hash, imsi64);
+  if (prefetch) {
+    if ((!entry) || (!entry->prefetch_pending)) {
+      // flushed while the request was in flight, the vectors may be stale
+      shard->stats.dropped += nb_vectors;
+      pthread_mutex_unlock(&shard->lock);
+      return;
+    }
+    entry->prefetch_pending = false;
+  }
+  if ((!entry) && (nb_vectors > 0)) {
+    if (shard->nb_entries >= shard->max_entries) {
+      shard->stats.evicted += shard->lru_tail->nb_vectors;
+      _nas_auth_vector_cache_remove(shard, shard->lru_tail);
+    }
+    entry = calloc(
+      1,
+      sizeof(*entry) + _cache.capacity * sizeof(nas_auth_vector_cache_slot_t));
+    if (!entry) {
+      shard->stats.dropped += nb_vectors;
+      pthread_mutex_unlock(&shard->lock);
+      return;
+    }
+    entry->imsi64 = imsi64;
+    nas_auth_vector_cache_entry_t **bucket =
+      _nas_auth_vector_cache_bucket(shard, hash);
+    entry->hash_next = *bucket;
+    *bucket = entry;
+    shard->nb_entries++;
+  } else if (entry) {
+    _nas_auth_vector_cache_lru_unlink(shard, entry);
+  }
+  if (entry) {
+    for (int i = 0; i < nb_vectors; i++) {
+      if (entry->nb_vectors == _cache.capacity) {
+        // keep the newest vectors, the HSS has moved their SQN forward
+        entry->first = (entry->first + 1) % _cache.capacity;
+        entry->nb_vectors--;
+        shard->stats.dropped++;
+      }
+      nas_auth_vector_cache_slot_t *slot =
+        &entry->slot[(entry->first + entry->nb_vectors) % _cache.capacity];
+      slot->fetched_sec = now;
+      slot->vector = vectors[i];
+      entry->nb_vectors++;
+    }
+    shard->stats.stored += nb_vectors;
+    entry->refilled_sec = now;
+    _nas_auth_vector_cache_lru_push(shard, entry);
+    if (entry->nb_vectors == 0) {
+      _nas_auth_vector_cache_remove(shard, entry);
+    }
+  }
+  pthread_mutex_unlock(&shard->lock);
+}
+
+//------------------------------------------------------------------------------
+void nas_auth_vector_cache_prefetch_failed(const imsi64_t imsi64)
+{
+  if (!_cache.enabled) {
+    return;
+  }
+  uint64_t hash = _nas_auth_vector_cache_hash(imsi64);
+  nas_auth_vector_cache_shard_t *shard = _nas_auth_vector_cache_shard(hash);
+
+  pthread_mutex_lock(&shard->lock);
+  nas_auth_vector_cache_entry_t *entry =
+    _nas_auth_vector_cache_find(shard, hash, imsi64);
+  if (entry) {
+    entry->prefetch_pending = false;
+    if (entry->nb_vectors == 0) {
+      _nas_auth_vector_cache_remove(shard, entry);
+    }
+  }
+  pthread_mutex_unlock(&shard->lock);
+}
+
+//------------------------------------------------------------------------------
+void nas_auth_vector_cache_flush(const imsi64_t imsi64)
+{
+  if (!_cache.enabled) {
+    return;
+  }
+  uint64_t hash = _nas_auth_vector_cache_hash(imsi64);
+  nas_auth_vector_cache_shard_t *shard = _nas_auth_vector_cache_shard(hash);
+
+  pthread_mutex_lock(&shard->lock);
+  nas_auth_vector_cache_entry_t *entry =
+    _nas_auth_vector_cache_find(shard, hash, imsi64);
+  if (entry) {
+    shard->stats.flushed += entry->nb_vectors;
+    _nas_auth_vector_cache_remove(shard, entry);
+  }
+  pthread_mutex_unlock(&shard->lock);
+}
+
+//------------------------------------------------------------------------------
+void nas_auth_vector_cache_get_stats(nas_auth_vector_cache_stats_t *const stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if (!_cache.enabled) {
+    return;
+  }
+  for (int i = 0; i < NAS_AUTH_VECTOR_CACHE_SHARDS; i++) {
+    nas_auth_vector_cache_shard_t *shard = &_cache.shards[i];
+
+    pthread_mutex_lock(&shard->lock);
+    stats->hits += shard->stats.hits;
+    stats->misses += shard->stats.misses;
+    stats->prefetches += shard->stats.prefetches;
+    stats->stored += shard->stats.stored;
+    stats->dropped += shard->stats.dropped;
+    stats->expired += shard->stats.expired;
+    stats->evicted += shard->stats.evicted;
+    stats->flushed += shard->stats.flushed;
+    pthread_mutex_unlock(&shard->lock);
+  }
+}
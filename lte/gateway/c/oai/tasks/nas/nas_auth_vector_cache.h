@@ -0,0 +1,106 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_auth_vector_cache.h
+   \brief Per subscriber cache of the unused EPS authentication vectors
+
+   When enabled, every Authentication Information Request asks the HSS for a
+   batch of vectors: the first one is used right away, the others are kept
+   here keyed by IMSI so that the next attach of the subscriber authenticates
+   without an S6a round trip. A prefetch request is sent in the background
+   when a subscriber runs below the low water mark.
+*/
+
+#ifndef FILE_NAS_AUTH_VECTOR_CACHE_SEEN
+#define FILE_NAS_AUTH_VECTOR_CACHE_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common_types.h"
+
+typedef struct nas_auth_vector_cache_config_s {
+  uint8_t vectors_per_air; // <= 1 disables the cache
+  uint8_t low_water_mark;  // prefetch when fewer vectors are left, 0 never
+  uint32_t lifetime_sec;   // vectors older than that are never used
+  uint32_t max_ues;        // least recently refilled subscribers are evicted
+  uint64_t (*now_sec)(void); // monotonic clock, NULL for CLOCK_MONOTONIC
+} nas_auth_vector_cache_config_t;
+
+typedef struct nas_auth_vector_cache_stats_s {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t prefetches;
+  uint64_t stored;
+  uint64_t dropped;  // prefetched after a flush, or beyond an entry capacity
+  uint64_t expired;
+  uint64_t evicted;
+  uint64_t flushed;
+} nas_auth_vector_cache_stats_t;
+
+/** \brief Allocate the cache, does nothing if it is disabled by the config
+ * \return RETURNok or RETURNerror
+ **/
+int nas_auth_vector_cache_init(const nas_auth_vector_cache_config_t *config);
+
+/** \brief Free the cache and all the vectors it holds */
+void nas_auth_vector_cache_exit(void);
+
+/** \brief Number of vectors to ask for in an Authentication Information
+ * Request, MAX_EPS_AUTH_VECTORS when the cache is disabled
+ **/
+uint8_t nas_auth_vector_cache_vectors_per_air(void);
+
+/** \brief Take the oldest valid vector of a subscriber
+ * \param imsi64    Subscriber
+ * \param vector    Filled on a hit
+ * \param prefetch  Set when the caller has to send a prefetch request for
+ *                  the subscriber, the cache then considers it pending
+ * \return true on a hit
+ **/
+bool nas_auth_vector_cache_get(
+  const imsi64_t imsi64,
+  eutran_vector_t *const vector,
+  bool *const prefetch);
+
+/** \brief Store the vectors received for a subscriber
+ * \param prefetch  The vectors answer a prefetch request. They are dropped
+ *                  when the subscriber has been flushed since the request.
+ **/
+void nas_auth_vector_cache_put(
+  const imsi64_t imsi64,
+  const eutran_vector_t *const vectors,
+  const uint8_t nb_vectors,
+  const bool prefetch);
+
+/** \brief Forget a failed prefetch request so that a new one can be sent */
+void nas_auth_vector_cache_prefetch_failed(const imsi64_t imsi64);
+
+/** \brief Drop the vectors of a subscriber, e.g. after a SQN
+ * re-synchronisation made them stale
+ **/
+void nas_auth_vector_cache_flush(const imsi64_t imsi64);
+
+/** \brief Copy the counters of the cache */
+void nas_auth_vector_cache_get_stats(
+  nas_auth_vector_cache_stats_t *const stats);
+
+#endif /* FILE_NAS_AUTH_VECTOR_CACHE_SEEN */
@@ -22,6 +22,10 @@
 #ifndef FILE_NAS_DEFS_SEEN
 #define FILE_NAS_DEFS_SEEN
 
+#include "intertask_interface.h"
+
 int nas_init(mme_config_t *mme_config_p);
 
+void nas_handle_itti_message(MessageDef *received_message_p);
+
 #endif /* FILE_NAS_DEFS_SEEN */
@@ -294,6 +294,7 @@ void nas_itti_auth_info_req(
   const mme_ue_s1ap_id_t ue_idP,
   const imsi_t *const imsiP,
   const bool is_initial_reqP,
+  const bool is_prefetchP,
   plmn_t *const visited_plmnP,
   const uint8_t num_vectorsP,
   const_bstring const auts_pP)
@@ -316,6 +317,7 @@ void nas_itti_auth_info_req(
 
   auth_info_req->visited_plmn = *visited_plmnP;
   auth_info_req->nb_of_vectors = num_vectorsP;
+  auth_info_req->prefetch = is_prefetchP;
 
   if (is_initial_reqP) {
     auth_info_req->re_synchronization = 0;
@@ -68,6 +68,7 @@ void nas_itti_auth_info_req(
   const mme_ue_s1ap_id_t ue_idP,
   const imsi_t *const imsiP,
   const bool is_initial_reqP,
+  const bool is_prefetchP,
   plmn_t *const visited_plmnP,
   const uint8_t num_vectorsP,
   const_bstring const auts_pP);
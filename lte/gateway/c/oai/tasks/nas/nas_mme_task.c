@@ -46,9 +46,154 @@
 #include "nas_proc.h"
 #include "emm_main.h"
 #include "nas_timer.h"
+#include "mme_app_workers.h"
 
 static void nas_exit(void);
 
+//------------------------------------------------------------------------------
+void nas_handle_itti_message(MessageDef *received_message_p)
+{
+  switch (ITTI_MSG_ID(received_message_p)) {
+    case MESSAGE_TEST: {
+      OAI_FPRINTF_INFO("TASK_NAS_MME received MESSAGE_TEST\n");
+    } break;
+
+    case MME_APP_CREATE_DEDICATED_BEARER_REQ:
+      nas_proc_create_dedicated_bearer(
+        &MME_APP_CREATE_DEDICATED_BEARER_REQ(received_message_p));
+      break;
+
+    case NAS_DOWNLINK_DATA_CNF: {
+      nas_proc_dl_transfer_cnf(
+        NAS_DL_DATA_CNF(received_message_p).ue_id,
+        NAS_DL_DATA_CNF(received_message_p).err_code,
+        &NAS_DL_DATA_REJ(received_message_p).nas_msg);
+    } break;
+
+    case NAS_DOWNLINK_DATA_REJ: {
+      nas_proc_dl_transfer_rej(
+        NAS_DL_DATA_REJ(received_message_p).ue_id,
+        NAS_DL_DATA_REJ(received_message_p).err_code,
+        &NAS_DL_DATA_REJ(received_message_p).nas_msg);
+    } break;
+
+    case NAS_PDN_CONFIG_RSP: {
+      nas_proc_pdn_config_res(&NAS_PDN_CONFIG_RSP(received_message_p));
+    } break;
+
+    case NAS_PDN_CONNECTIVITY_FAIL: {
+      nas_proc_pdn_connectivity_fail(
+        &NAS_PDN_CONNECTIVITY_FAIL(received_message_p));
+    } break;
+
+    case NAS_PDN_CONNECTIVITY_RSP: {
+      nas_proc_pdn_connectivity_res(
+        &NAS_PDN_CONNECTIVITY_RSP(received_message_p));
+    } break;
+
+    case NAS_IMPLICIT_DETACH_UE_IND: {
+      nas_proc_implicit_detach_ue_ind(
+        NAS_IMPLICIT_DETACH_UE_IND(received_message_p).ue_id);
+    } break;
+
+    case NAS_UPLINK_DATA_IND: {
+      nas_proc_ul_transfer_ind(
+        NAS_UL_DATA_IND(received_message_p).ue_id,
+        NAS_UL_DATA_IND(received_message_p).tai,
+        NAS_UL_DATA_IND(received_message_p).cgi,
+        &NAS_UL_DATA_IND(received_message_p).nas_msg);
+    } break;
+
+    case S1AP_DEREGISTER_UE_REQ: {
+      nas_proc_deregister_ue(
+        S1AP_DEREGISTER_UE_REQ(received_message_p).mme_ue_s1ap_id);
+    } break;
+
+    case NAS_NW_INITIATED_DETACH_UE_REQ: {
+      nas_proc_nw_initiated_detach_ue_request(
+        &NAS_NW_INITIATED_DETACH_UE_REQ(received_message_p));
+    } break;
+
+    case S6A_AUTH_INFO_ANS: {
+      /*
+       * We received the authentication vectors from HSS, trigger a ULR
+       * for now. Normaly should trigger an authentication procedure with UE.
+       */
+      nas_proc_authentication_info_answer(
+        &S6A_AUTH_INFO_ANS(received_message_p));
+    } break;
+
+    case NAS_CS_DOMAIN_LOCATION_UPDATE_ACC: {
+      itti_nas_cs_domain_location_update_acc_t
+        *itti_nas_location_update_acc_p = NULL;
+      itti_nas_location_update_acc_p =
+        &received_message_p->ittiMsg.nas_cs_domain_location_update_acc;
+      nas_proc_cs_domain_location_updt_acc(itti_nas_location_update_acc_p);
+    } break;
+
+    case NAS_CS_DOMAIN_LOCATION_UPDATE_FAIL: {
+      itti_nas_cs_domain_location_update_fail_t
+        *itti_nas_location_update_fail_p = NULL;
+      itti_nas_location_update_fail_p =
+        &received_message_p->ittiMsg.nas_cs_domain_location_update_fail;
+      nas_proc_cs_domain_location_updt_fail(itti_nas_location_update_fail_p);
+    } break;
+
+    case SGSAP_DOWNLINK_UNITDATA: {
+      /*
+       * We received the Downlink Unitdata from MSC, trigger a
+       * Downlink Nas Transport message to UE.
+       */
+      nas_proc_downlink_unitdata(
+        &SGSAP_DOWNLINK_UNITDATA(received_message_p));
+    } break;
+
+    case SGSAP_RELEASE_REQ: {
+      /*
+       * We received the SGS Release request from MSC,to indicate that there are no more NAS messages to be exchanged
+       * between the VLR and the UE, or when a further exchange of NAS messages for the specified UE is not possible
+       * due to an error.
+       */
+      nas_proc_sgs_release_req(&SGSAP_RELEASE_REQ(received_message_p));
+    } break;
+    case SGSAP_MM_INFORMATION_REQ: {
+      /*Received SGSAP MM Information Request message from SGS task*/
+      nas_proc_cs_domain_mm_information_request(
+        &SGSAP_MM_INFORMATION_REQ(received_message_p));
+    } break;
+    case NAS_CS_SERVICE_NOTIFICATION: {
+      nas_proc_cs_service_notification(
+        &NAS_CS_SERVICE_NOTIFICATION(received_message_p));
+    } break;
+
+    case NAS_NOTIFY_SERVICE_REJECT: {
+      nas_proc_notify_service_reject(
+        &NAS_NOTIFY_SERVICE_REJECT(received_message_p));
+    } break;
+
+    case TIMER_HAS_EXPIRED: {
+      /*
+       * Call the NAS timer api
+       */
+      nas_timer_handle_signal_expiry(
+        TIMER_HAS_EXPIRED(received_message_p).timer_id,
+        TIMER_HAS_EXPIRED(received_message_p).arg);
+    } break;
+
+    default: {
+      OAILOG_DEBUG(
+        LOG_NAS,
+        "Unkwnon message ID %d:%s from %s\n",
+        ITTI_MSG_ID(received_message_p),
+        ITTI_MSG_NAME(received_message_p),
+        ITTI_MSG_ORIGIN_NAME(received_message_p));
+    } break;
+  }
+
+  itti_free_msg_content(received_message_p);
+  itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
+}
+
 //------------------------------------------------------------------------------
 static void *nas_intertask_interface(void *args_p)
 {
@@ -59,154 +204,15 @@ static void *nas_intertask_interface(void *args_p)
 
     itti_receive_msg(TASK_NAS_MME, &received_message_p);
 
-    switch (ITTI_MSG_ID(received_message_p)) {
-      case MESSAGE_TEST: {
-        OAI_FPRINTF_INFO("TASK_NAS_MME received MESSAGE_TEST\n");
-      } break;
-
-      case MME_APP_CREATE_DEDICATED_BEARER_REQ:
-        nas_proc_create_dedicated_bearer(
-          &MME_APP_CREATE_DEDICATED_BEARER_REQ(received_message_p));
-        break;
-
-      case NAS_DOWNLINK_DATA_CNF: {
-        nas_proc_dl_transfer_cnf(
-          NAS_DL_DATA_CNF(received_message_p).ue_id,
-          NAS_DL_DATA_CNF(received_message_p).err_code,
-          &NAS_DL_DATA_REJ(received_message_p).nas_msg);
-      } break;
-
-      case NAS_DOWNLINK_DATA_REJ: {
-        nas_proc_dl_transfer_rej(
-          NAS_DL_DATA_REJ(received_message_p).ue_id,
-          NAS_DL_DATA_REJ(received_message_p).err_code,
-          &NAS_DL_DATA_REJ(received_message_p).nas_msg);
-      } break;
-
-      case NAS_PDN_CONFIG_RSP: {
-        nas_proc_pdn_config_res(&NAS_PDN_CONFIG_RSP(received_message_p));
-      } break;
-
-      case NAS_PDN_CONNECTIVITY_FAIL: {
-        nas_proc_pdn_connectivity_fail(
-          &NAS_PDN_CONNECTIVITY_FAIL(received_message_p));
-      } break;
-
-      case NAS_PDN_CONNECTIVITY_RSP: {
-        nas_proc_pdn_connectivity_res(
-          &NAS_PDN_CONNECTIVITY_RSP(received_message_p));
-      } break;
-
-      case NAS_IMPLICIT_DETACH_UE_IND: {
-        nas_proc_implicit_detach_ue_ind(
-          NAS_IMPLICIT_DETACH_UE_IND(received_message_p).ue_id);
-      } break;
-
-      case NAS_UPLINK_DATA_IND: {
-        nas_proc_ul_transfer_ind(
-          NAS_UL_DATA_IND(received_message_p).ue_id,
-          NAS_UL_DATA_IND(received_message_p).tai,
-          NAS_UL_DATA_IND(received_message_p).cgi,
-          &NAS_UL_DATA_IND(received_message_p).nas_msg);
-      } break;
-
-      case S1AP_DEREGISTER_UE_REQ: {
-        nas_proc_deregister_ue(
-          S1AP_DEREGISTER_UE_REQ(received_message_p).mme_ue_s1ap_id);
-      } break;
-
-      case NAS_NW_INITIATED_DETACH_UE_REQ: {
-        nas_proc_nw_initiated_detach_ue_request(
-          &NAS_NW_INITIATED_DETACH_UE_REQ(received_message_p));
-      } break;
-
-      case S6A_AUTH_INFO_ANS: {
-        /*
-         * We received the authentication vectors from HSS, trigger a ULR
-         * for now. Normaly should trigger an authentication procedure with UE.
-         */
-        nas_proc_authentication_info_answer(
-          &S6A_AUTH_INFO_ANS(received_message_p));
-      } break;
-
-      case NAS_CS_DOMAIN_LOCATION_UPDATE_ACC: {
-        itti_nas_cs_domain_location_update_acc_t
-          *itti_nas_location_update_acc_p = NULL;
-        itti_nas_location_update_acc_p =
-          &received_message_p->ittiMsg.nas_cs_domain_location_update_acc;
-        nas_proc_cs_domain_location_updt_acc(itti_nas_location_update_acc_p);
-      } break;
-
-      case NAS_CS_DOMAIN_LOCATION_UPDATE_FAIL: {
-        itti_nas_cs_domain_location_update_fail_t
-          *itti_nas_location_update_fail_p = NULL;
-        itti_nas_location_update_fail_p =
-          &received_message_p->ittiMsg.nas_cs_domain_location_update_fail;
-        nas_proc_cs_domain_location_updt_fail(itti_nas_location_update_fail_p);
-      } break;
-
-      case SGSAP_DOWNLINK_UNITDATA: {
-        /*
-         * We received the Downlink Unitdata from MSC, trigger a
-         * Downlink Nas Transport message to UE.
-         */
-        nas_proc_downlink_unitdata(
-          &SGSAP_DOWNLINK_UNITDATA(received_message_p));
-      } break;
-
-      case SGSAP_RELEASE_REQ: {
-        /*
-         * We received the SGS Release request from MSC,to indicate that there are no more NAS messages to be exchanged
-         * between the VLR and the UE, or when a further exchange of NAS messages for the specified UE is not possible
-         * due to an error.
-         */
-        nas_proc_sgs_release_req(&SGSAP_RELEASE_REQ(received_message_p));
-      } break;
-      case SGSAP_MM_INFORMATION_REQ: {
-        /*Received SGSAP MM Information Request message from SGS task*/
-        nas_proc_cs_domain_mm_information_request(
-          &SGSAP_MM_INFORMATION_REQ(received_message_p));
-      } break;
-      case NAS_CS_SERVICE_NOTIFICATION: {
-        nas_proc_cs_service_notification(
-          &NAS_CS_SERVICE_NOTIFICATION(received_message_p));
-      } break;
-
-      case NAS_NOTIFY_SERVICE_REJECT: {
-        nas_proc_notify_service_reject(
-          &NAS_NOTIFY_SERVICE_REJECT(received_message_p));
-      } break;
-
-      case TERMINATE_MESSAGE: {
-        nas_exit();
-        OAI_FPRINTF_INFO("TASK_NAS_MME terminated\n");
-        itti_free_msg_content(received_message_p);
-        itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
-        itti_exit_task();
-      } break;
-
-      case TIMER_HAS_EXPIRED: {
-        /*
-         * Call the NAS timer api
-         */
-        nas_timer_handle_signal_expiry(
-          TIMER_HAS_EXPIRED(received_message_p).timer_id,
-          TIMER_HAS_EXPIRED(received_message_p).arg);
-      } break;
-
-      default: {
-        OAILOG_DEBUG(
-          LOG_NAS,
-          "Unkwnon message ID %d:%s from %s\n",
-          ITTI_MSG_ID(received_message_p),
-          ITTI_MSG_NAME(received_message_p),
-          ITTI_MSG_ORIGIN_NAME(received_message_p));
-      } break;
+    if (ITTI_MSG_ID(received_message_p) == TERMINATE_MESSAGE) {
+      nas_exit();
+      OAI_FPRINTF_INFO("TASK_NAS_MME terminated\n");
+      itti_free_msg_content(received_message_p);
+      itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
+      itti_exit_task();
+    } else if (!mme_app_workers_dispatch(received_message_p)) {
+      nas_handle_itti_message(received_message_p);
     }
-
-    itti_free_msg_content(received_message_p);
-    itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
-    received_message_p = NULL;
   }
 
   return NULL;
@@ -46,6 +46,7 @@
 #include "assertions.h"
 #include "conversions.h"
 #include "nas_proc.h"
+#include "nas_auth_vector_cache.h"
 #include "emm_proc.h"
 #include "emm_main.h"
 #include "emm_sap.h"
@@ -91,6 +92,18 @@ void nas_proc_initialize(mme_config_t *mme_config_p)
    * Initialize the EMM procedure manager
    */
   emm_main_initialize(mme_config_p);
+  /*
+   * Initialize the authentication vector cache
+   */
+  nas_auth_vector_cache_config_t auth_vector_cache_config = {
+    .vectors_per_air = mme_config_p->nas_config.auth_vector_prefetch,
+    .low_water_mark = mme_config_p->nas_config.auth_vector_low_water_mark,
+    .lifetime_sec = mme_config_p->nas_config.auth_vector_lifetime_sec,
+    .max_ues = mme_config_p->nas_config.auth_vector_cache_max_ue,
+  };
+  AssertFatal(
+    nas_auth_vector_cache_init(&auth_vector_cache_config) == RETURNok,
+    "Failed to initialize the authentication vector cache");
   /*
    * Initialize the ESM procedure manager
    */
@@ -119,6 +132,7 @@ void nas_proc_cleanup(void)
    * Perform the EPS Mobility Manager's clean up procedure
    */
   emm_main_cleanup();
+  nas_auth_vector_cache_exit();
   /*
    * Perform the EPS Session Manager's clean up procedure
    */
@@ -420,6 +434,22 @@ int nas_proc_authentication_info_answer(s6a_auth_info_ans_t *aia)
 
   OAILOG_DEBUG(LOG_NAS_EMM, "Handling imsi " IMSI_64_FMT "\n", imsi64);
 
+  if (aia->prefetch) {
+    // No procedure waits for these vectors, they only refill the cache
+    if (
+      (aia->result.present == S6A_RESULT_BASE) &&
+      (aia->result.choice.base == DIAMETER_SUCCESS)) {
+      nas_auth_vector_cache_put(
+        imsi64,
+        aia->auth_info.eutran_vector,
+        aia->auth_info.nb_of_vectors,
+        true);
+    } else {
+      nas_auth_vector_cache_prefetch_failed(imsi64);
+    }
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, RETURNok);
+  }
+
   ue_mm_context = mme_ue_context_exists_imsi(
     &mme_app_desc.mme_ue_contexts, (const hash_key_t) imsi64);
   if (ue_mm_context) {
@@ -441,12 +471,13 @@ int nas_proc_authentication_info_answer(s6a_auth_info_ans_t *aia)
     (aia->result.present == S6A_RESULT_BASE) &&
     (aia->result.choice.base == DIAMETER_SUCCESS)) {
     /*
-      * Check that list is not empty and contain at most MAX_EPS_AUTH_VECTORS elements
+      * Check that list is not empty and contain at most
+      * MAX_EPS_AUTH_VECTORS_PER_AIR elements
       */
     DevCheck(
-      aia->auth_info.nb_of_vectors <= MAX_EPS_AUTH_VECTORS,
+      aia->auth_info.nb_of_vectors <= MAX_EPS_AUTH_VECTORS_PER_AIR,
       aia->auth_info.nb_of_vectors,
-      MAX_EPS_AUTH_VECTORS,
+      MAX_EPS_AUTH_VECTORS_PER_AIR,
       0);
     DevCheck(
       aia->auth_info.nb_of_vectors > 0, aia->auth_info.nb_of_vectors, 1, 0);
@@ -455,10 +486,21 @@ int nas_proc_authentication_info_answer(s6a_auth_info_ans_t *aia)
       LOG_NAS_EMM,
       "INFORMING NAS ABOUT AUTH RESP SUCCESS got %u vector(s)\n",
       aia->auth_info.nb_of_vectors);
+    /*
+     * The EMM context holds MAX_EPS_AUTH_VECTORS, the others are kept for the
+     * next authentications of the subscriber
+     */
+    uint8_t nb_vectors = aia->auth_info.nb_of_vectors;
+    if (nb_vectors > MAX_EPS_AUTH_VECTORS) {
+      nas_auth_vector_cache_put(
+        imsi64,
+        &aia->auth_info.eutran_vector[MAX_EPS_AUTH_VECTORS],
+        nb_vectors - MAX_EPS_AUTH_VECTORS,
+        false);
+      nb_vectors = MAX_EPS_AUTH_VECTORS;
+    }
     rc = nas_proc_auth_param_res(
-      mme_ue_s1ap_id,
-      aia->auth_info.nb_of_vectors,
-      aia->auth_info.eutran_vector);
+      mme_ue_s1ap_id, nb_vectors, aia->auth_info.eutran_vector);
   } else {
     OAILOG_ERROR(LOG_NAS_EMM, "INFORMING NAS ABOUT AUTH RESP ERROR CODE\n");
     MSC_LOG_EVENT(
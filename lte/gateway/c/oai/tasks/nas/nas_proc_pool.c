@@ -0,0 +1,112 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_proc_pool.c
+   \brief Typed free-list pools for the NAS procedure objects
+
+   NAS procedures are created and deleted several times per attach. Keeping
+   released objects on a per type free list avoids going through malloc and
+   free for each of them during attach storms.
+*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nas_proc_pool.h"
+
+//------------------------------------------------------------------------------
+void *nas_proc_pool_alloc(nas_proc_pool_t *const pool)
+{
+  nas_proc_pool_obj_t *obj = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  obj = pool->free_list;
+  if (obj) {
+    pool->free_list = obj->next;
+    pool->nb_free--;
+  }
+  pool->nb_allocs++;
+  pool->nb_in_use++;
+  if (!obj) {
+    pool->nb_heap_allocs++;
+  }
+  pthread_mutex_unlock(&pool->lock);
+
+  if (obj) {
+    memset(obj + 1, 0, pool->object_size);
+  } else {
+    obj = calloc(1, sizeof(*obj) + pool->object_size);
+    if (!obj) {
+      pthread_mutex_lock(&pool->lock);
+      pool->nb_in_use--;
+      pthread_mutex_unlock(&pool->lock);
+      return NULL;
+    }
+  }
+  obj->pool = pool;
+  obj->next = NULL;
+  return obj + 1;
+}
+
+//------------------------------------------------------------------------------
+void nas_proc_pool_release(void **const object)
+{
+  nas_proc_pool_obj_t *obj = NULL;
+  nas_proc_pool_t *pool = NULL;
+
+  if (!object || !*object) {
+    return;
+  }
+  obj = ((nas_proc_pool_obj_t *) *object) - 1;
+  pool = obj->pool;
+  *object = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->nb_in_use--;
+  if (pool->nb_free < pool->max_free) {
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    pool->nb_free++;
+    obj = NULL;
+  }
+  pthread_mutex_unlock(&pool->lock);
+  free(obj);
+}
+
+//------------------------------------------------------------------------------
+void nas_proc_pool_trim(nas_proc_pool_t *const pool)
+{
+  nas_proc_pool_obj_t *obj = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  obj = pool->free_list;
+  pool->free_list = NULL;
+  pool->nb_free = 0;
+  pthread_mutex_unlock(&pool->lock);
+
+  while (obj) {
+    nas_proc_pool_obj_t *next = obj->next;
+    free(obj);
+    obj = next;
+  }
+}
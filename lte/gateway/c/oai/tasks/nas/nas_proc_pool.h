@@ -0,0 +1,75 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_proc_pool.h
+   \brief Typed free-list pools for the NAS procedure objects
+*/
+
+#ifndef FILE_NAS_PROC_POOL_SEEN
+#define FILE_NAS_PROC_POOL_SEEN
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Every pooled object is preceded by this header, so that it can be given
+ * back to its pool without the caller knowing its type */
+typedef struct nas_proc_pool_obj_s {
+  struct nas_proc_pool_s *pool;
+  struct nas_proc_pool_obj_s *next;
+} nas_proc_pool_obj_t;
+
+typedef struct nas_proc_pool_s {
+  const char *name;
+  size_t object_size;
+  uint32_t max_free; // released objects beyond this go back to the heap
+  pthread_mutex_t lock;
+  nas_proc_pool_obj_t *free_list;
+  uint32_t nb_free;
+  uint32_t nb_in_use;
+  uint64_t nb_allocs;
+  uint64_t nb_heap_allocs;
+} nas_proc_pool_t;
+
+#define NAS_PROC_POOL_MAX_FREE_DEFAULT 4096
+
+#define NAS_PROC_POOL_INITIALIZER(nAmE, tYpE)                                  \
+  {                                                                            \
+    .name = nAmE, .object_size = sizeof(tYpE),                                 \
+    .max_free = NAS_PROC_POOL_MAX_FREE_DEFAULT,                                \
+    .lock = PTHREAD_MUTEX_INITIALIZER,                                         \
+  }
+
+/** \brief Get a zeroed object from the pool, falling back to the heap when
+ * the pool is empty
+ * \return the object or NULL if the heap is exhausted
+ **/
+void *nas_proc_pool_alloc(nas_proc_pool_t *const pool);
+
+/** \brief Give an object back to the pool it was allocated from
+ * \param object Pointer to the object, set to NULL on return. NULL is ignored
+ **/
+void nas_proc_pool_release(void **const object);
+
+/** \brief Free the objects kept by the pool, objects in use are left alone */
+void nas_proc_pool_trim(nas_proc_pool_t *const pool);
+
+#endif /* FILE_NAS_PROC_POOL_SEEN */
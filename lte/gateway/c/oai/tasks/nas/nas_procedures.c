@@ -62,6 +62,7 @@
 #include "NasSecurityAlgorithms.h"
 #include "mme_config.h"
 #include "nas_itti_messaging.h"
+#include "nas_proc_pool.h"
 #include "mme_app_defs.h"
 #include "digest.h"
 #include "nas_procedures.h"
@@ -89,6 +90,41 @@ static nas_emm_proc_t *nas_emm_find_procedure_by_puid(
 
 static uint64_t nas_puid = 1;
 
+static nas_proc_pool_t nas_emm_procedures_pool =
+  NAS_PROC_POOL_INITIALIZER("emm_procedures", emm_procedures_t);
+static nas_proc_pool_t nas_attach_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("attach", nas_emm_attach_proc_t);
+static nas_proc_pool_t nas_tau_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("tau", nas_emm_tau_proc_t);
+static nas_proc_pool_t nas_sr_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("service_request", nas_sr_proc_t);
+static nas_proc_pool_t nas_ident_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("identification", nas_emm_ident_proc_t);
+static nas_proc_pool_t nas_auth_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("authentication", nas_emm_auth_proc_t);
+static nas_proc_pool_t nas_smc_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("smc", nas_emm_smc_proc_t);
+static nas_proc_pool_t nas_auth_info_proc_pool =
+  NAS_PROC_POOL_INITIALIZER("auth_info", nas_auth_info_proc_t);
+static nas_proc_pool_t nas_emm_common_procedure_pool =
+  NAS_PROC_POOL_INITIALIZER("emm_common_wrapper", nas_emm_common_procedure_t);
+static nas_proc_pool_t nas_cn_procedure_pool =
+  NAS_PROC_POOL_INITIALIZER("cn_wrapper", nas_cn_procedure_t);
+
+//------------------------------------------------------------------------------
+static void nas_emm_puid_index_add(
+  emm_procedures_t *const emm_procedures,
+  nas_emm_proc_t *const proc)
+{
+  const uint64_t puid = proc->base_proc.nas_puid;
+
+  if (!nas_puid_index_add(emm_procedures->puid_index, puid, proc)) {
+    // Lookups fall back on walking the procedures
+    OAILOG_WARNING(
+      LOG_NAS_EMM, "No room to index proc UID 0x%" PRIx64 "\n", puid);
+  }
+}
+
 //------------------------------------------------------------------------------
 static nas_emm_common_proc_t *get_nas_common_procedure(
   const struct emm_context_s *const ctxt,
@@ -338,7 +374,7 @@ static void nas_emm_procedure_gc(struct emm_context_s *const emm_context)
     LIST_EMPTY(&emm_context->emm_procedures->cn_procs) &&
     (!emm_context->emm_procedures->emm_con_mngt_proc) &&
     (!emm_context->emm_procedures->emm_specific_proc)) {
-    free_wrapper((void **) &emm_context->emm_procedures);
+    nas_proc_pool_release((void **) &emm_context->emm_procedures);
   }
 }
 //-----------------------------------------------------------------------------
@@ -356,7 +392,7 @@ static void nas_delete_child_procedures(
       if (((nas_base_proc_t *) p1->proc)->parent == parent_proc) {
         nas_delete_common_procedure(emm_context, &p1->proc);
         // Done by nas_delete_common_procedure: LIST_REMOVE(p1, entries);
-        //Done by nas_delete_common_procedure: free_wrapper((void**)&p1);
+        //Done by nas_delete_common_procedure: nas_proc_pool_release((void**)&p1);
       }
       p1 = p2;
     }
@@ -377,7 +413,7 @@ static void nas_delete_con_mngt_procedure(nas_emm_con_mngt_proc_t **proc)
 {
   if (*proc) {
     AssertFatal(0, "TODO");
-    free_wrapper((void **) proc);
+    nas_proc_pool_release((void **) proc);
   }
 }
 //-----------------------------------------------------------------------------
@@ -410,13 +446,16 @@ void nas_delete_common_procedure(
       nas_emm_common_procedure_t *p1 =
         LIST_FIRST(&emm_context->emm_procedures->emm_common_procs);
       nas_emm_common_procedure_t *p2 = NULL;
+      nas_puid_index_remove(
+        emm_context->emm_procedures->puid_index,
+        (*proc)->emm_proc.base_proc.nas_puid);
       // 2 methods: this one, the other: use parent struct macro and LIST_REMOVE without searching matching element in the list
       while (p1) {
         p2 = LIST_NEXT(p1, entries);
         if (p1->proc == (nas_emm_common_proc_t *) (*proc)) {
           LIST_REMOVE(p1, entries);
-          free_wrapper((void **) &p1->proc);
-          free_wrapper((void **) &p1);
+          nas_proc_pool_release((void **) &p1->proc);
+          nas_proc_pool_release((void **) &p1);
           return;
         }
         p1 = p2;
@@ -425,7 +464,7 @@ void nas_delete_common_procedure(
     }
     // if not found in list, free it anyway
     if (*proc) {
-      free_wrapper((void **) proc);
+      nas_proc_pool_release((void **) proc);
     }
   }
 }
@@ -462,8 +501,11 @@ static void nas_delete_common_procedures(struct emm_context_s *emm_context)
         default:;
       }
 
-      free_wrapper((void **) &p1->proc);
-      free_wrapper((void **) &p1);
+      nas_puid_index_remove(
+        emm_context->emm_procedures->puid_index,
+        p1->proc->emm_proc.base_proc.nas_puid);
+      nas_proc_pool_release((void **) &p1->proc);
+      nas_proc_pool_release((void **) &p1);
 
       p1 = p2;
     }
@@ -492,7 +534,12 @@ void nas_delete_attach_procedure(struct emm_context_s *emm_context)
 
     nas_delete_child_procedures(emm_context, (nas_base_proc_t *) proc);
 
-    free_wrapper((void **) &emm_context->emm_procedures->emm_specific_proc);
+    nas_puid_index_remove(
+      emm_context->emm_procedures->puid_index,
+      emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc
+        .nas_puid);
+    nas_proc_pool_release(
+      (void **) &emm_context->emm_procedures->emm_specific_proc);
     nas_emm_procedure_gc(emm_context);
   }
 }
@@ -516,7 +563,12 @@ void nas_delete_tau_procedure(struct emm_context_s *emm_context)
 
     nas_delete_child_procedures(emm_context, (nas_base_proc_t *) proc);
 
-    free_wrapper((void **) &emm_context->emm_procedures->emm_specific_proc);
+    nas_puid_index_remove(
+      emm_context->emm_procedures->puid_index,
+      emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc
+        .nas_puid);
+    nas_proc_pool_release(
+      (void **) &emm_context->emm_procedures->emm_specific_proc);
     nas_emm_procedure_gc(emm_context);
   }
 }
@@ -532,7 +584,12 @@ void nas_delete_detach_procedure(struct emm_context_s *emm_context)
 
     nas_delete_child_procedures(emm_context, (nas_base_proc_t *) proc);
 
-    free_wrapper((void **) &emm_context->emm_procedures->emm_specific_proc);
+    nas_puid_index_remove(
+      emm_context->emm_procedures->puid_index,
+      emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc
+        .nas_puid);
+    nas_proc_pool_release(
+      (void **) &emm_context->emm_procedures->emm_specific_proc);
     nas_emm_procedure_gc(emm_context);
   }
 }
@@ -546,7 +603,7 @@ static void nas_delete_auth_info_procedure(
     if ((*auth_info_proc)->cn_proc.base_proc.parent) {
       (*auth_info_proc)->cn_proc.base_proc.parent->child = NULL;
     }
-    free_wrapper((void **) auth_info_proc);
+    nas_proc_pool_release((void **) auth_info_proc);
   }
 }
 
@@ -567,11 +624,11 @@ void nas_delete_cn_procedure(
             nas_delete_auth_info_procedure(
               emm_context, (nas_auth_info_proc_t **) &cn_proc);
             break;
-          case CN_PROC_NONE: free_wrapper((void **) &cn_proc); break;
+          case CN_PROC_NONE: nas_proc_pool_release((void **) &cn_proc); break;
           default:;
         }
         LIST_REMOVE(p1, entries);
-        free_wrapper((void **) &p1);
+        nas_proc_pool_release((void **) &p1);
         return;
       }
       p1 = p2;
@@ -594,10 +651,10 @@ static void nas_delete_cn_procedures(struct emm_context_s *emm_context)
             emm_context, (nas_auth_info_proc_t **) &p1->proc);
           break;
 
-        default: free_wrapper((void **) &p1->proc);
+        default: nas_proc_pool_release((void **) &p1->proc);
       }
       LIST_REMOVE(p1, entries);
-      free_wrapper((void **) &p1);
+      nas_proc_pool_release((void **) &p1);
       p1 = p2;
     }
     nas_emm_procedure_gc(emm_context);
@@ -618,7 +675,10 @@ void nas_delete_all_emm_procedures(struct emm_context_s *const emm_context)
 
     // gc
     if (emm_context->emm_procedures) {
-      free_wrapper((void **) &emm_context->emm_procedures);
+      // Connection management procedures own no resource
+      nas_proc_pool_release(
+        (void **) &emm_context->emm_procedures->emm_con_mngt_proc);
+      nas_proc_pool_release((void **) &emm_context->emm_procedures);
     }
   }
   OAILOG_FUNC_OUT(LOG_NAS_EMM);
@@ -629,7 +689,7 @@ static emm_procedures_t *_nas_new_emm_procedures(
   struct emm_context_s *const emm_context)
 {
   emm_procedures_t *emm_procedures =
-    calloc(1, sizeof(*emm_context->emm_procedures));
+    nas_proc_pool_alloc(&nas_emm_procedures_pool);
   LIST_INIT(&emm_procedures->emm_common_procs);
   return emm_procedures;
 }
@@ -651,7 +711,7 @@ nas_emm_attach_proc_t *nas_new_attach_procedure(
     return NULL;
   }
   emm_context->emm_procedures->emm_specific_proc =
-    calloc(1, sizeof(nas_emm_attach_proc_t));
+    nas_proc_pool_alloc(&nas_attach_proc_pool);
   emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
   emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc.type =
@@ -666,6 +726,8 @@ nas_emm_attach_proc_t *nas_new_attach_procedure(
 
   proc->T3450.sec = mme_config.nas_config.t3450_sec;
   proc->T3450.id = NAS_TIMER_INACTIVE_ID;
+  nas_emm_puid_index_add(
+    emm_context->emm_procedures, &proc->emm_spec_proc.emm_proc);
 
   OAILOG_TRACE(LOG_NAS_EMM, "New EMM_SPEC_PROC_TYPE_ATTACH\n");
   return proc;
@@ -688,7 +750,7 @@ nas_emm_tau_proc_t *nas_new_tau_procedure(
     return NULL;
   }
   emm_context->emm_procedures->emm_specific_proc =
-    calloc(1, sizeof(nas_emm_tau_proc_t));
+    nas_proc_pool_alloc(&nas_tau_proc_pool);
   emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
   emm_context->emm_procedures->emm_specific_proc->emm_proc.base_proc.type =
@@ -702,6 +764,8 @@ nas_emm_tau_proc_t *nas_new_tau_procedure(
 
   proc->T3450.sec = mme_config.nas_config.t3450_sec;
   proc->T3450.id = NAS_TIMER_INACTIVE_ID;
+  nas_emm_puid_index_add(
+    emm_context->emm_procedures, &proc->emm_spec_proc.emm_proc);
 
   return proc;
 }
@@ -723,7 +787,7 @@ nas_sr_proc_t *nas_new_service_request_procedure(
     return NULL;
   }
   emm_context->emm_procedures->emm_con_mngt_proc =
-    calloc(1, sizeof(nas_sr_proc_t));
+    nas_proc_pool_alloc(&nas_sr_proc_pool);
   emm_context->emm_procedures->emm_con_mngt_proc->emm_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
   emm_context->emm_procedures->emm_con_mngt_proc->emm_proc.base_proc.type =
@@ -735,6 +799,8 @@ nas_sr_proc_t *nas_new_service_request_procedure(
 
   nas_sr_proc_t *proc =
     (nas_sr_proc_t *) emm_context->emm_procedures->emm_con_mngt_proc;
+  nas_emm_puid_index_add(
+    emm_context->emm_procedures, &proc->con_mngt_proc.emm_proc);
 
   return proc;
 }
@@ -747,7 +813,7 @@ nas_emm_ident_proc_t *nas_new_identification_procedure(
     emm_context->emm_procedures = _nas_new_emm_procedures(emm_context);
   }
 
-  nas_emm_ident_proc_t *ident_proc = calloc(1, sizeof(nas_emm_ident_proc_t));
+  nas_emm_ident_proc_t *ident_proc = nas_proc_pool_alloc(&nas_ident_proc_pool);
 
   ident_proc->emm_com_proc.emm_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
@@ -758,15 +824,18 @@ nas_emm_ident_proc_t *nas_new_identification_procedure(
   ident_proc->T3470.sec = mme_config.nas_config.t3470_sec;
   ident_proc->T3470.id = NAS_TIMER_INACTIVE_ID;
 
-  nas_emm_common_procedure_t *wrapper = calloc(1, sizeof(*wrapper));
+  nas_emm_common_procedure_t *wrapper =
+    nas_proc_pool_alloc(&nas_emm_common_procedure_pool);
   if (wrapper) {
     wrapper->proc = &ident_proc->emm_com_proc;
     LIST_INSERT_HEAD(
       &emm_context->emm_procedures->emm_common_procs, wrapper, entries);
+    nas_emm_puid_index_add(
+      emm_context->emm_procedures, &ident_proc->emm_com_proc.emm_proc);
     OAILOG_TRACE(LOG_NAS_EMM, "New EMM_COMM_PROC_IDENT\n");
     return ident_proc;
   } else {
-    free_wrapper((void **) &ident_proc);
+    nas_proc_pool_release((void **) &ident_proc);
   }
   return ident_proc;
 }
@@ -779,7 +848,7 @@ nas_emm_auth_proc_t *nas_new_authentication_procedure(
     emm_context->emm_procedures = _nas_new_emm_procedures(emm_context);
   }
 
-  nas_emm_auth_proc_t *auth_proc = calloc(1, sizeof(nas_emm_auth_proc_t));
+  nas_emm_auth_proc_t *auth_proc = nas_proc_pool_alloc(&nas_auth_proc_pool);
 
   auth_proc->emm_com_proc.emm_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
@@ -790,15 +859,18 @@ nas_emm_auth_proc_t *nas_new_authentication_procedure(
   auth_proc->T3460.sec = mme_config.nas_config.t3460_sec;
   auth_proc->T3460.id = NAS_TIMER_INACTIVE_ID;
 
-  nas_emm_common_procedure_t *wrapper = calloc(1, sizeof(*wrapper));
+  nas_emm_common_procedure_t *wrapper =
+    nas_proc_pool_alloc(&nas_emm_common_procedure_pool);
   if (wrapper) {
     wrapper->proc = &auth_proc->emm_com_proc;
     LIST_INSERT_HEAD(
       &emm_context->emm_procedures->emm_common_procs, wrapper, entries);
+    nas_emm_puid_index_add(
+      emm_context->emm_procedures, &auth_proc->emm_com_proc.emm_proc);
     OAILOG_TRACE(LOG_NAS_EMM, "New EMM_COMM_PROC_AUTH\n");
     return auth_proc;
   } else {
-    free_wrapper((void **) &auth_proc);
+    nas_proc_pool_release((void **) &auth_proc);
   }
   return NULL;
 }
@@ -811,7 +883,7 @@ nas_emm_smc_proc_t *nas_new_smc_procedure(
     emm_context->emm_procedures = _nas_new_emm_procedures(emm_context);
   }
 
-  nas_emm_smc_proc_t *smc_proc = calloc(1, sizeof(nas_emm_smc_proc_t));
+  nas_emm_smc_proc_t *smc_proc = nas_proc_pool_alloc(&nas_smc_proc_pool);
 
   smc_proc->emm_com_proc.emm_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
@@ -822,15 +894,18 @@ nas_emm_smc_proc_t *nas_new_smc_procedure(
   smc_proc->T3460.sec = mme_config.nas_config.t3460_sec;
   smc_proc->T3460.id = NAS_TIMER_INACTIVE_ID;
 
-  nas_emm_common_procedure_t *wrapper = calloc(1, sizeof(*wrapper));
+  nas_emm_common_procedure_t *wrapper =
+    nas_proc_pool_alloc(&nas_emm_common_procedure_pool);
   if (wrapper) {
     wrapper->proc = &smc_proc->emm_com_proc;
     LIST_INSERT_HEAD(
       &emm_context->emm_procedures->emm_common_procs, wrapper, entries);
+    nas_emm_puid_index_add(
+      emm_context->emm_procedures, &smc_proc->emm_com_proc.emm_proc);
     OAILOG_TRACE(LOG_NAS_EMM, "New EMM_COMM_PROC_SMC\n");
     return smc_proc;
   } else {
-    free_wrapper((void **) &smc_proc);
+    nas_proc_pool_release((void **) &smc_proc);
   }
   return NULL;
 }
@@ -844,20 +919,20 @@ nas_auth_info_proc_t *nas_new_cn_auth_info_procedure(
   }
 
   nas_auth_info_proc_t *auth_info_proc =
-    calloc(1, sizeof(nas_auth_info_proc_t));
+    nas_proc_pool_alloc(&nas_auth_info_proc_pool);
   auth_info_proc->cn_proc.base_proc.nas_puid =
     __sync_fetch_and_add(&nas_puid, 1);
   auth_info_proc->cn_proc.base_proc.type = NAS_PROC_TYPE_CN;
   auth_info_proc->cn_proc.type = CN_PROC_AUTH_INFO;
 
-  nas_cn_procedure_t *wrapper = calloc(1, sizeof(*wrapper));
+  nas_cn_procedure_t *wrapper = nas_proc_pool_alloc(&nas_cn_procedure_pool);
   if (wrapper) {
     wrapper->proc = &auth_info_proc->cn_proc;
     LIST_INSERT_HEAD(&emm_context->emm_procedures->cn_procs, wrapper, entries);
     OAILOG_TRACE(LOG_NAS_EMM, "New EMM_COMM_PROC_SMC\n");
     return auth_info_proc;
   } else {
-    free_wrapper((void **) &auth_info_proc);
+    nas_proc_pool_release((void **) &auth_info_proc);
   }
   return NULL;
 }
@@ -887,6 +962,12 @@ static nas_emm_proc_t *nas_emm_find_procedure_by_puid(
   uint64_t puid)
 {
   if ((emm_context) && (emm_context->emm_procedures)) {
+    nas_emm_proc_t *emm_proc =
+      nas_puid_index_get(emm_context->emm_procedures->puid_index, puid);
+    if (emm_proc) {
+      OAILOG_TRACE(LOG_NAS_EMM, "Found proc UID 0x%" PRIx64 "\n", puid);
+      return emm_proc;
+    }
     // start with common procedures
     nas_emm_common_procedure_t *p1 =
       LIST_FIRST(&emm_context->emm_procedures->emm_common_procs);
@@ -29,6 +29,7 @@
 #ifndef FILE_NAS_PROCEDURES_SEEN
 #define FILE_NAS_PROCEDURES_SEEN
 #include "3gpp_24.008.h"
+#include "nas_puid_index.h"
 
 struct emm_context_s;
 struct nas_base_proc_s;
@@ -373,6 +374,8 @@ typedef struct emm_procedures_s {
   int nas_proc_mess_sign_next_location; // next index in array
 #define MAX_NAS_PROC_MESS_SIGN 3
   nas_proc_mess_sign_t nas_proc_mess_sign[MAX_NAS_PROC_MESS_SIGN];
+
+  nas_emm_puid_entry_t puid_index[NAS_EMM_PUID_INDEX_SIZE];
 } emm_procedures_t;
 
 bool is_nas_common_procedure_guti_realloc_running(
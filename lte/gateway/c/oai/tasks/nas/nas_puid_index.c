@@ -0,0 +1,104 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_puid_index.c
+   \brief Open addressing index of the running EMM procedures of a UE by UID
+
+   Procedures are looked up by UID each time a NAS message is sent for them.
+   The index saves walking the procedure lists of the UE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nas_puid_index.h"
+
+#define NAS_EMM_PUID_INDEX_MASK (NAS_EMM_PUID_INDEX_SIZE - 1)
+
+//------------------------------------------------------------------------------
+bool nas_puid_index_add(
+  nas_emm_puid_entry_t *const index,
+  const uint64_t puid,
+  struct nas_emm_proc_s *const proc)
+{
+  for (int n = 0; n < NAS_EMM_PUID_INDEX_SIZE; n++) {
+    nas_emm_puid_entry_t *entry =
+      &index[(puid + n) & NAS_EMM_PUID_INDEX_MASK];
+    if (!entry->puid) {
+      entry->puid = puid;
+      entry->proc = proc;
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+struct nas_emm_proc_s *nas_puid_index_get(
+  const nas_emm_puid_entry_t *const index,
+  const uint64_t puid)
+{
+  for (int n = 0; n < NAS_EMM_PUID_INDEX_SIZE; n++) {
+    const nas_emm_puid_entry_t *entry =
+      &index[(puid + n) & NAS_EMM_PUID_INDEX_MASK];
+    if (entry->puid == puid) {
+      return entry->proc;
+    }
+    if (!entry->puid) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+void nas_puid_index_remove(
+  nas_emm_puid_entry_t *const index,
+  const uint64_t puid)
+{
+  const int mask = NAS_EMM_PUID_INDEX_MASK;
+  int i = -1;
+
+  for (int n = 0; n < NAS_EMM_PUID_INDEX_SIZE; n++) {
+    int slot = (puid + n) & mask;
+    if (index[slot].puid == puid) {
+      i = slot;
+      break;
+    }
+    if (!index[slot].puid) {
+      return;
+    }
+  }
+  if (i < 0) {
+    return;
+  }
+  for (int j = (i + 1) & mask; index[j].puid && j != i; j = (j + 1) & mask) {
+    int home = index[j].puid & mask;
+    // Entry j may move to i only if i lies between its home slot and j
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      index[i] = index[j];
+      i = j;
+    }
+  }
+  index[i].puid = 0;
+  index[i].proc = NULL;
+}
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_puid_index.h
+   \brief Open addressing index of the running EMM procedures of a UE by UID
+*/
+
+#ifndef FILE_NAS_PUID_INDEX_SEEN
+#define FILE_NAS_PUID_INDEX_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct nas_emm_proc_s;
+
+/* A UE runs a handful of procedures at once */
+#define NAS_EMM_PUID_INDEX_SIZE 8 // power of 2
+
+typedef struct nas_emm_puid_entry_s {
+  uint64_t puid; // 0 for a free slot
+  struct nas_emm_proc_s *proc;
+} nas_emm_puid_entry_t;
+
+/** \brief Index a procedure by its UID, probing from the slot of the UID
+ * \return false if every slot is taken
+ **/
+bool nas_puid_index_add(
+  nas_emm_puid_entry_t *const index,
+  const uint64_t puid,
+  struct nas_emm_proc_s *const proc);
+
+/** \brief Look up a procedure by its UID
+ * \return the procedure or NULL if it is not indexed
+ **/
+struct nas_emm_proc_s *nas_puid_index_get(
+  const nas_emm_puid_entry_t *const index,
+  const uint64_t puid);
+
+/** \brief Remove a procedure from the index. The following entries of its
+ * probe sequence are shifted back, so that no tombstone is needed
+ **/
+void nas_puid_index_remove(
+  nas_emm_puid_entry_t *const index,
+  const uint64_t puid);
+
+#endif /* FILE_NAS_PUID_INDEX_SEEN */
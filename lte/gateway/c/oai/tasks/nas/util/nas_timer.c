@@ -66,6 +66,7 @@ void nas_timer_cleanup(void) {}
 long int nas_timer_start(
   long sec,
   long usec,
+  mme_ue_s1ap_id_t ue_id,
   nas_timer_callback_t nas_timer_callback,
   void *nas_timer_callback_args)
 {
@@ -80,6 +81,7 @@ long int nas_timer_start(
   memset(&cb, 0, sizeof(cb));
   cb.nas_timer_callback = nas_timer_callback;
   cb.nas_timer_callback_arg = nas_timer_callback_args;
+  cb.ue_id = ue_id;
 
   if (
     timer_setup(
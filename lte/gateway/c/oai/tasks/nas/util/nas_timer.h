@@ -38,6 +38,10 @@ Description Timer utilities
 #ifndef FILE_NAS_TIMER_SEEN
 #define FILE_NAS_TIMER_SEEN
 
+#include <stdint.h>
+
+#include "3gpp_36.401.h"
+
 /****************************************************************************/
 /*********************  G L O B A L    C O N S T A N T S  *******************/
 /****************************************************************************/
@@ -64,6 +68,8 @@ typedef void (*nas_timer_callback_t)(void *);
 typedef struct nas_itti_timer_arg_s {
   nas_timer_callback_t nas_timer_callback;
   void *nas_timer_callback_arg;
+  /* The UE the expiry is processed for, by the worker of the UE */
+  mme_ue_s1ap_id_t ue_id;
 } nas_itti_timer_arg_t;
 
 /****************************************************************************/
@@ -79,6 +85,7 @@ void nas_timer_cleanup(void);
 long int nas_timer_start(
   long sec,
   long usec,
+  mme_ue_s1ap_id_t ue_id,
   nas_timer_callback_t nas_timer_callback,
   void *nas_timer_callback_args);
 long int nas_timer_stop(long int timer_id, void **nas_timer_callback_arg);
@@ -52,6 +52,17 @@
 
 extern hash_table_ts_t *s11_mme_teid_2_gtv2c_teid_handle;
 
+/*
+ * Parser templates of the bearer messages received from the S-GW, built once
+ * at S11 init and shared by all the messages
+ */
+static nw_gtpv2c_msg_parser_template_t
+  *s11_mme_release_access_bearers_response_template = NULL;
+static nw_gtpv2c_msg_parser_template_t
+  *s11_mme_modify_bearer_response_template = NULL;
+static nw_gtpv2c_msg_parser_template_t
+  *s11_mme_create_bearer_request_template = NULL;
+
 //------------------------------------------------------------------------------
 int s11_mme_release_access_bearers_request(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -112,6 +123,30 @@ int s11_mme_release_access_bearers_request(
   return RETURNok;
 }
 
+//------------------------------------------------------------------------------
+static nw_gtpv2c_msg_parser_template_t *
+s11_mme_release_access_bearers_response_template_new(void)
+{
+  nw_rc_t rc = NW_OK;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
+
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_RELEASE_ACCESS_BEARERS_RSP, s11_ie_indication_generic, &tmpl);
+  DevAssert(NW_OK == rc);
+  /*
+   * Cause IE
+   */
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
+    NW_GTPV2C_IE_CAUSE,
+    NW_GTPV2C_IE_INSTANCE_ZERO,
+    NW_GTPV2C_IE_PRESENCE_MANDATORY,
+    gtpv2c_cause_ie_get,
+    offsetof(itti_s11_release_access_bearers_response_t, cause));
+  DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
 //------------------------------------------------------------------------------
 int s11_mme_handle_release_access_bearer_response(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -122,49 +157,22 @@ int s11_mme_handle_release_access_bearer_response(
   uint16_t offendingIeLength;
   itti_s11_release_access_bearers_response_t *resp_p;
   MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
 
   DevAssert(stack_p);
+  DevAssert(s11_mme_release_access_bearers_response_template);
   message_p =
     itti_alloc_new_message(TASK_S11, S11_RELEASE_ACCESS_BEARERS_RESPONSE);
   resp_p = &message_p->ittiMsg.s11_release_access_bearers_response;
 
   resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_RELEASE_ACCESS_BEARERS_RSP,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
-  DevAssert(NW_OK == rc);
-  /*
-   * Cause IE
-   */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
-    NW_GTPV2C_IE_CAUSE,
-    NW_GTPV2C_IE_INSTANCE_ZERO,
-    NW_GTPV2C_IE_PRESENCE_MANDATORY,
-    gtpv2c_cause_ie_get,
-    &resp_p->cause);
-  DevAssert(NW_OK == rc);
-  /*
-   * Recovery IE
-   */
-  /*rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_RECOVERY, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, s11_fteid_ie_get,
-		  &resp_p->recovery);
-  DevAssert (NW_OK == rc);*/
-
   /*
    * Run the parser
    */
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
-    (pUlpApi->hMsg),
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_mme_release_access_bearers_response_template,
+    pUlpApi->hMsg,
+    resp_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -182,8 +190,6 @@ int s11_mme_handle_release_access_bearer_response(
      */
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNerror;
@@ -198,8 +204,6 @@ int s11_mme_handle_release_access_bearer_response(
     resp_p->teid,
     resp_p->cause);
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
   return itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
@@ -345,6 +349,30 @@ int s11_mme_create_bearer_response(
   return RETURNok;
 }
 
+//------------------------------------------------------------------------------
+static nw_gtpv2c_msg_parser_template_t *
+s11_mme_modify_bearer_response_template_new(void)
+{
+  nw_rc_t rc = NW_OK;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
+
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_MODIFY_BEARER_RSP, s11_ie_indication_generic, &tmpl);
+  DevAssert(NW_OK == rc);
+  /*
+   * Cause IE
+   */
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
+    NW_GTPV2C_IE_CAUSE,
+    NW_GTPV2C_IE_INSTANCE_ZERO,
+    NW_GTPV2C_IE_PRESENCE_MANDATORY,
+    gtpv2c_cause_ie_get,
+    offsetof(itti_s11_modify_bearer_response_t, cause));
+  DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
 //------------------------------------------------------------------------------
 int s11_mme_handle_modify_bearer_response(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -355,48 +383,21 @@ int s11_mme_handle_modify_bearer_response(
   uint16_t offendingIeLength;
   itti_s11_modify_bearer_response_t *resp_p;
   MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
 
   DevAssert(stack_p);
+  DevAssert(s11_mme_modify_bearer_response_template);
   message_p = itti_alloc_new_message(TASK_S11, S11_MODIFY_BEARER_RESPONSE);
   resp_p = &message_p->ittiMsg.s11_modify_bearer_response;
 
   resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_MODIFY_BEARER_RSP,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
-  DevAssert(NW_OK == rc);
-  /*
-   * Cause IE
-   */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
-    NW_GTPV2C_IE_CAUSE,
-    NW_GTPV2C_IE_INSTANCE_ZERO,
-    NW_GTPV2C_IE_PRESENCE_MANDATORY,
-    gtpv2c_cause_ie_get,
-    &resp_p->cause);
-  DevAssert(NW_OK == rc);
-  /*
-   * Recovery IE
-   */
-  /*rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_RECOVERY, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, s11_fteid_ie_get,
-		  &resp_p->recovery);
-  DevAssert (NW_OK == rc);*/
-
   /*
    * Run the parser
    */
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
-    (pUlpApi->hMsg),
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_mme_modify_bearer_response_template,
+    pUlpApi->hMsg,
+    resp_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -414,8 +415,6 @@ int s11_mme_handle_modify_bearer_response(
      */
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNerror;
@@ -429,13 +428,48 @@ int s11_mme_handle_modify_bearer_response(
     "0 MODIFY_BEARER_RESPONSE local S11 teid " TEID_FMT " cause %u",
     resp_p->teid,
     resp_p->cause);
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
   return itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
 }
 
+//------------------------------------------------------------------------------
+static nw_gtpv2c_msg_parser_template_t *
+s11_mme_create_bearer_request_template_new(void)
+{
+  nw_rc_t rc = NW_OK;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
+
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_CREATE_BEARER_REQ, s11_ie_indication_generic, &tmpl);
+  DevAssert(NW_OK == rc);
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
+    NW_GTPV2C_IE_EBI,
+    NW_GTPV2C_IE_INSTANCE_ZERO,
+    NW_GTPV2C_IE_PRESENCE_MANDATORY,
+    gtpv2c_ebi_ie_get,
+    offsetof(itti_s11_create_bearer_request_t, linked_eps_bearer_id));
+  DevAssert(NW_OK == rc);
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
+    NW_GTPV2C_IE_PCO,
+    NW_GTPV2C_IE_INSTANCE_ZERO,
+    NW_GTPV2C_IE_PRESENCE_OPTIONAL,
+    gtpv2c_pco_ie_get,
+    offsetof(itti_s11_create_bearer_request_t, pco));
+  DevAssert(NW_OK == rc);
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
+    NW_GTPV2C_IE_BEARER_CONTEXT,
+    NW_GTPV2C_IE_INSTANCE_ZERO,
+    NW_GTPV2C_IE_PRESENCE_MANDATORY,
+    gtpv2c_bearer_context_to_be_created_within_create_bearer_request_ie_get,
+    offsetof(itti_s11_create_bearer_request_t, bearer_contexts));
+  DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
 //------------------------------------------------------------------------------
 int s11_mme_handle_create_bearer_request(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -446,9 +480,9 @@ int s11_mme_handle_create_bearer_request(
   uint16_t offendingIeLength;
   itti_s11_create_bearer_request_t *req_p;
   MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
 
   DevAssert(stack_p);
+  DevAssert(s11_mme_create_bearer_request_template);
   message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_BEARER_REQUEST);
 
   if (message_p) {
@@ -457,50 +491,13 @@ int s11_mme_handle_create_bearer_request(
     req_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
     req_p->trxn = (void *) pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
 
-    /*
-     * Create a new message parser
-     */
-    rc = nwGtpv2cMsgParserNew(
-      *stack_p,
-      NW_GTP_CREATE_BEARER_REQ,
-      s11_ie_indication_generic,
-      NULL,
-      &pMsgParser);
-    DevAssert(NW_OK == rc);
-
-    rc = nwGtpv2cMsgParserAddIe(
-      pMsgParser,
-      NW_GTPV2C_IE_EBI,
-      NW_GTPV2C_IE_INSTANCE_ZERO,
-      NW_GTPV2C_IE_PRESENCE_MANDATORY,
-      gtpv2c_ebi_ie_get,
-      &req_p->linked_eps_bearer_id);
-    DevAssert(NW_OK == rc);
-
-    rc = nwGtpv2cMsgParserAddIe(
-      pMsgParser,
-      NW_GTPV2C_IE_PCO,
-      NW_GTPV2C_IE_INSTANCE_ZERO,
-      NW_GTPV2C_IE_PRESENCE_OPTIONAL,
-      gtpv2c_pco_ie_get,
-      &req_p->pco);
-    DevAssert(NW_OK == rc);
-
-    rc = nwGtpv2cMsgParserAddIe(
-      pMsgParser,
-      NW_GTPV2C_IE_BEARER_CONTEXT,
-      NW_GTPV2C_IE_INSTANCE_ZERO,
-      NW_GTPV2C_IE_PRESENCE_MANDATORY,
-      gtpv2c_bearer_context_to_be_created_within_create_bearer_request_ie_get,
-      &req_p->bearer_contexts);
-    DevAssert(NW_OK == rc);
-
     /*
      * Run the parser
      */
-    rc = nwGtpv2cMsgParserRun(
-      pMsgParser,
-      (pUlpApi->hMsg),
+    rc = nwGtpv2cMsgParserTemplateRun(
+      s11_mme_create_bearer_request_template,
+      pUlpApi->hMsg,
+      req_p,
       &offendingIeType,
       &offendingIeInstance,
       &offendingIeLength);
@@ -518,8 +515,6 @@ int s11_mme_handle_create_bearer_request(
        */
       itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
       message_p = NULL;
-      rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-      DevAssert(NW_OK == rc);
       rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
       DevAssert(NW_OK == rc);
       return RETURNerror;
@@ -533,11 +528,32 @@ int s11_mme_handle_create_bearer_request(
       "0 CREATE_BEARER_REQUEST local S11 teid " TEID_FMT " lebi %u",
       req_p->teid,
       req_p->linked_eps_bearer_id);
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
   }
   return RETURNerror;
 }
+
+//------------------------------------------------------------------------------
+void s11_mme_bearer_manager_init(void)
+{
+  s11_mme_release_access_bearers_response_template =
+    s11_mme_release_access_bearers_response_template_new();
+  s11_mme_modify_bearer_response_template =
+    s11_mme_modify_bearer_response_template_new();
+  s11_mme_create_bearer_request_template =
+    s11_mme_create_bearer_request_template_new();
+}
+
+//------------------------------------------------------------------------------
+void s11_mme_bearer_manager_exit(void)
+{
+  nwGtpv2cMsgParserTemplateDelete(
+    s11_mme_release_access_bearers_response_template);
+  s11_mme_release_access_bearers_response_template = NULL;
+  nwGtpv2cMsgParserTemplateDelete(s11_mme_modify_bearer_response_template);
+  s11_mme_modify_bearer_response_template = NULL;
+  nwGtpv2cMsgParserTemplateDelete(s11_mme_create_bearer_request_template);
+  s11_mme_create_bearer_request_template = NULL;
+}
@@ -29,6 +29,11 @@
 #ifndef FILE_S11_MME_BEARER_MANAGER_SEEN
 #define FILE_S11_MME_BEARER_MANAGER_SEEN
 
+/* @brief Build the parser templates of the bearer messages, to be called
+ * once before the S11 task handles its first message. */
+void s11_mme_bearer_manager_init(void);
+void s11_mme_bearer_manager_exit(void);
+
 /* @brief Create a new Release Access Bearers Request and send it to provided S-GW. */
 int s11_mme_release_access_bearers_request(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -53,6 +53,15 @@
 
 extern hash_table_ts_t *s11_mme_teid_2_gtv2c_teid_handle;
 
+/*
+ * Parser templates of the session responses received from the S-GW, built
+ * once at S11 init and shared by all the responses
+ */
+static nw_gtpv2c_msg_parser_template_t
+  *s11_mme_create_session_response_template = NULL;
+static nw_gtpv2c_msg_parser_template_t
+  *s11_mme_delete_session_response_template = NULL;
+
 //------------------------------------------------------------------------------
 int s11_mme_create_session_request(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -149,116 +158,120 @@ int s11_mme_create_session_request(
 }
 
 //------------------------------------------------------------------------------
-int s11_mme_handle_create_session_response(
-  nw_gtpv2c_stack_handle_t *stack_p,
-  nw_gtpv2c_ulp_api_t *pUlpApi)
+static nw_gtpv2c_msg_parser_template_t *
+s11_mme_create_session_response_template_new(void)
 {
   nw_rc_t rc = NW_OK;
-  uint8_t offendingIeType, offendingIeInstance;
-  uint16_t offendingIeLength;
-  itti_s11_create_session_response_t *resp_p;
-  MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
-
-  DevAssert(stack_p);
-  message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_SESSION_RESPONSE);
-  resp_p = &message_p->ittiMsg.s11_create_session_response;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
 
-  resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
-
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_CREATE_SESSION_RSP,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_CREATE_SESSION_RSP, s11_ie_indication_generic, &tmpl);
   DevAssert(NW_OK == rc);
   /*
    * Cause IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_CAUSE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_cause_ie_get,
-    &resp_p->cause);
+    offsetof(itti_s11_create_session_response_t, cause));
   DevAssert(NW_OK == rc);
   /*
    * Sender FTEID for CP IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_FTEID,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_fteid_ie_get,
-    &resp_p->s11_sgw_fteid);
+    offsetof(itti_s11_create_session_response_t, s11_sgw_fteid));
   DevAssert(NW_OK == rc);
   /*
    * Sender FTEID for PGW S5/S8 IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_FTEID,
     NW_GTPV2C_IE_INSTANCE_ONE,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_fteid_ie_get,
-    &resp_p->s5_s8_pgw_fteid);
+    offsetof(itti_s11_create_session_response_t, s5_s8_pgw_fteid));
   DevAssert(NW_OK == rc);
   /*
    * PAA IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PAA,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_paa_ie_get,
-    &resp_p->paa);
+    offsetof(itti_s11_create_session_response_t, paa));
   DevAssert(NW_OK == rc);
   /*
    * APN RESTRICTION
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_APN_RESTRICTION,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_apn_restriction_ie_get,
-    &resp_p->apn_restriction);
+    offsetof(itti_s11_create_session_response_t, apn_restriction));
   DevAssert(NW_OK == rc);
   /*
    * PCO IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PCO,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_pco_ie_get,
-    &resp_p->pco);
+    offsetof(itti_s11_create_session_response_t, pco));
   DevAssert(NW_OK == rc);
   /*
    * Bearer Contexts Created IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_BEARER_CONTEXT,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_bearer_context_created_ie_get,
-    &resp_p->bearer_contexts_created);
+    offsetof(itti_s11_create_session_response_t, bearer_contexts_created));
   DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
+//------------------------------------------------------------------------------
+int s11_mme_handle_create_session_response(
+  nw_gtpv2c_stack_handle_t *stack_p,
+  nw_gtpv2c_ulp_api_t *pUlpApi)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t offendingIeType, offendingIeInstance;
+  uint16_t offendingIeLength;
+  itti_s11_create_session_response_t *resp_p;
+  MessageDef *message_p;
+
+  DevAssert(stack_p);
+  DevAssert(s11_mme_create_session_response_template);
+  message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_SESSION_RESPONSE);
+  resp_p = &message_p->ittiMsg.s11_create_session_response;
+
+  resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
+
   /*
    * Run the parser
    */
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
-    (pUlpApi->hMsg),
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_mme_create_session_response_template,
+    pUlpApi->hMsg,
+    resp_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -276,15 +289,11 @@ int s11_mme_handle_create_session_response(
      */
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNerror;
   }
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
 
@@ -368,69 +377,72 @@ int s11_mme_delete_session_request(
 }
 
 //------------------------------------------------------------------------------
-int s11_mme_handle_delete_session_response(
-  nw_gtpv2c_stack_handle_t *stack_p,
-  nw_gtpv2c_ulp_api_t *pUlpApi)
+static nw_gtpv2c_msg_parser_template_t *
+s11_mme_delete_session_response_template_new(void)
 {
   nw_rc_t rc = NW_OK;
-  uint8_t offendingIeType, offendingIeInstance;
-  uint16_t offendingIeLength;
-  itti_s11_delete_session_response_t *resp_p = NULL;
-  MessageDef *message_p = NULL;
-  nw_gtpv2c_msg_parser_t *pMsgParser = NULL;
-  hashtable_rc_t hash_rc = HASH_TABLE_OK;
-
-  DevAssert(stack_p);
-  message_p = itti_alloc_new_message(TASK_S11, S11_DELETE_SESSION_RESPONSE);
-  resp_p = &message_p->ittiMsg.s11_delete_session_response;
-
-  resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
 
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_DELETE_SESSION_RSP,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_DELETE_SESSION_RSP, s11_ie_indication_generic, &tmpl);
   DevAssert(NW_OK == rc);
   /*
    * Cause IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_CAUSE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_cause_ie_get,
-    &resp_p->cause);
+    offsetof(itti_s11_delete_session_response_t, cause));
   DevAssert(NW_OK == rc);
   /*
    * Recovery IE
    */
-  /* TODO rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_RECOVERY, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_fteid_ie_get,
-		  &resp_p->recovery);
+  /* TODO rc = nwGtpv2cMsgParserTemplateAddIe (tmpl, NW_GTPV2C_IE_RECOVERY, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, s11_fteid_ie_get,
+           offsetof(itti_s11_delete_session_response_t, recovery));
   DevAssert (NW_OK == rc); */
   /*
    * PCO IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PCO,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_pco_ie_get,
-    &resp_p->pco);
+    offsetof(itti_s11_delete_session_response_t, pco));
   DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
+//------------------------------------------------------------------------------
+int s11_mme_handle_delete_session_response(
+  nw_gtpv2c_stack_handle_t *stack_p,
+  nw_gtpv2c_ulp_api_t *pUlpApi)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t offendingIeType, offendingIeInstance;
+  uint16_t offendingIeLength;
+  itti_s11_delete_session_response_t *resp_p = NULL;
+  MessageDef *message_p = NULL;
+  hashtable_rc_t hash_rc = HASH_TABLE_OK;
+
+  DevAssert(stack_p);
+  DevAssert(s11_mme_delete_session_response_template);
+  message_p = itti_alloc_new_message(TASK_S11, S11_DELETE_SESSION_RESPONSE);
+  resp_p = &message_p->ittiMsg.s11_delete_session_response;
+
+  resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
   /*
    * Run the parser
    */
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
-    (pUlpApi->hMsg),
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_mme_delete_session_response_template,
+    pUlpApi->hMsg,
+    resp_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -448,15 +460,11 @@ int s11_mme_handle_delete_session_response(
      */
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNerror;
   }
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
 
@@ -496,3 +504,21 @@ int s11_mme_handle_delete_session_response(
 
   return itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
 }
+
+//------------------------------------------------------------------------------
+void s11_mme_session_manager_init(void)
+{
+  s11_mme_create_session_response_template =
+    s11_mme_create_session_response_template_new();
+  s11_mme_delete_session_response_template =
+    s11_mme_delete_session_response_template_new();
+}
+
+//------------------------------------------------------------------------------
+void s11_mme_session_manager_exit(void)
+{
+  nwGtpv2cMsgParserTemplateDelete(s11_mme_create_session_response_template);
+  s11_mme_create_session_response_template = NULL;
+  nwGtpv2cMsgParserTemplateDelete(s11_mme_delete_session_response_template);
+  s11_mme_delete_session_response_template = NULL;
+}
@@ -29,6 +29,11 @@
 #ifndef FILE_S11_MME_SESSION_MANAGER_SEEN
 #define FILE_S11_MME_SESSION_MANAGER_SEEN
 
+/* @brief Build the parser templates of the session responses, to be called
+ * once before the S11 task handles its first message. */
+void s11_mme_session_manager_init(void);
+void s11_mme_session_manager_exit(void);
+
 /* @brief Create a new Create Session Request and send it to provided S-GW. */
 int s11_mme_create_session_request(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -249,6 +249,25 @@ static void *s11_mme_thread(void *args)
           &received_message_p->ittiMsg.s11_release_access_bearers_request);
       } break;
 
+      case S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST: {
+        /*
+         * GTPv2-C has no bulk form of this message, send one request per UE
+         */
+        const itti_s11_release_access_bearers_bulk_request_t *const bulk_p =
+          &received_message_p->ittiMsg.s11_release_access_bearers_bulk_request;
+        itti_s11_release_access_bearers_request_t request = {0};
+
+        request.peer_ip = bulk_p->peer_ip;
+        request.originating_node = NODE_TYPE_MME;
+        for (int i = 0; i < bulk_p->num_requests; i++) {
+          request.local_teid = bulk_p->requests[i].local_teid;
+          request.teid = bulk_p->requests[i].teid;
+          request.trxn = NULL;
+          s11_mme_release_access_bearers_request(
+            &s11_mme_stack_handle, &request);
+        }
+      } break;
+
       case TERMINATE_MESSAGE: {
         s11_mme_exit();
         OAI_FPRINTF_INFO("TASK_S11 terminated\n");
@@ -344,6 +363,9 @@ int s11_mme_init(const mme_config_t *const mme_config_p)
     goto fail;
   }
 
+  s11_mme_session_manager_init();
+  s11_mme_bearer_manager_init();
+
   /*
    * Set ULP entity
    */
@@ -395,6 +417,8 @@ static void s11_mme_exit(void)
   if (nwGtpv2cFinalize(s11_mme_stack_handle) != NW_OK) {
     OAI_FPRINTF_ERR("An error occurred during tear down of nwGtp s11 stack.\n");
   }
+  s11_mme_session_manager_exit();
+  s11_mme_bearer_manager_exit();
   if (hashtable_ts_destroy(s11_mme_teid_2_gtv2c_teid_handle) != HASH_TABLE_OK) {
     OAI_FPRINTF_ERR("An error occured while destroying s11 teid hash table");
   }
@@ -374,6 +374,9 @@ int s11_sgw_init(sgw_config_t *config_p)
     goto fail;
   }
 
+  s11_sgw_session_manager_init();
+  s11_sgw_bearer_manager_init();
+
   /*
    * Set ULP entity
    */
@@ -422,5 +425,7 @@ fail:
 static void s11_sgw_exit(void)
 {
   nwGtpv2cFinalize(s11_sgw_stack_handle);
+  s11_sgw_session_manager_exit();
+  s11_sgw_bearer_manager_exit();
   hashtable_ts_destroy(s11_sgw_teid_2_gtv2c_teid_handle);
 }
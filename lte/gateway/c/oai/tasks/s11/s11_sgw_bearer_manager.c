@@ -51,91 +51,107 @@
 
 extern hash_table_ts_t *s11_sgw_teid_2_gtv2c_teid_handle;
 
+/*
+ * Parser templates of the bearer messages received from the MME, built once
+ * at S11 init and shared by all the messages
+ */
+static nw_gtpv2c_msg_parser_template_t
+  *s11_sgw_modify_bearer_request_template = NULL;
+static nw_gtpv2c_msg_parser_template_t
+  *s11_sgw_release_access_bearers_request_template = NULL;
+static nw_gtpv2c_msg_parser_template_t
+  *s11_sgw_create_bearer_response_template = NULL;
+
 //------------------------------------------------------------------------------
-int s11_sgw_handle_modify_bearer_request(
-  nw_gtpv2c_stack_handle_t *stack_p,
-  nw_gtpv2c_ulp_api_t *pUlpApi)
+static nw_gtpv2c_msg_parser_template_t *
+s11_sgw_modify_bearer_request_template_new(void)
 {
   nw_rc_t rc = NW_OK;
-  uint8_t offendingIeType, offendingIeInstance;
-  uint16_t offendingIeLength;
-  itti_s11_modify_bearer_request_t *request_p;
-  MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
 
-  DevAssert(stack_p);
-  message_p = itti_alloc_new_message(TASK_S11, S11_MODIFY_BEARER_REQUEST);
-  request_p = &message_p->ittiMsg.s11_modify_bearer_request;
-  request_p->trxn = (void *) pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
-  request_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_MODIFY_BEARER_REQ,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_MODIFY_BEARER_REQ, s11_ie_indication_generic, &tmpl);
   DevAssert(NW_OK == rc);
   /*
    * Indication Flags IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_INDICATION,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_indication_flags_ie_get,
-    &request_p->indication_flags);
+    offsetof(itti_s11_modify_bearer_request_t, indication_flags));
   DevAssert(NW_OK == rc);
   /*
    * MME-FQ-CSID IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_FQ_CSID,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_fqcsid_ie_get,
-    &request_p->mme_fq_csid);
+    offsetof(itti_s11_modify_bearer_request_t, mme_fq_csid));
   DevAssert(NW_OK == rc);
   /*
    * RAT Type IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_RAT_TYPE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_rat_type_ie_get,
-    &request_p->rat_type);
+    offsetof(itti_s11_modify_bearer_request_t, rat_type));
   DevAssert(NW_OK == rc);
   /*
    * Delay Value IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_DELAY_VALUE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_delay_value_ie_get,
-    &request_p->delay_dl_packet_notif_req);
+    offsetof(itti_s11_modify_bearer_request_t, delay_dl_packet_notif_req));
   DevAssert(NW_OK == rc);
   /*
    * Bearer Context to be modified IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_BEARER_CONTEXT,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_bearer_context_to_be_modified_within_modify_bearer_request_ie_get,
-    &request_p->bearer_contexts_to_be_modified);
+    offsetof(itti_s11_modify_bearer_request_t, bearer_contexts_to_be_modified));
   DevAssert(NW_OK == rc);
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
+  return tmpl;
+}
+
+//------------------------------------------------------------------------------
+int s11_sgw_handle_modify_bearer_request(
+  nw_gtpv2c_stack_handle_t *stack_p,
+  nw_gtpv2c_ulp_api_t *pUlpApi)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t offendingIeType, offendingIeInstance;
+  uint16_t offendingIeLength;
+  itti_s11_modify_bearer_request_t *request_p;
+  MessageDef *message_p;
+
+  DevAssert(stack_p);
+  DevAssert(s11_sgw_modify_bearer_request_template);
+  message_p = itti_alloc_new_message(TASK_S11, S11_MODIFY_BEARER_REQUEST);
+  request_p = &message_p->ittiMsg.s11_modify_bearer_request;
+  request_p->trxn = (void *) pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
+  request_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
+
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_sgw_modify_bearer_request_template,
     pUlpApi->hMsg,
+    request_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -187,15 +203,11 @@ int s11_sgw_handle_modify_bearer_request(
     DevAssert(NW_OK == rc);
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return NW_OK;
   }
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
   return itti_send_msg_to_task(TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
@@ -236,6 +248,27 @@ int s11_sgw_handle_modify_bearer_response(
   return RETURNok;
 }
 
+//------------------------------------------------------------------------------
+static nw_gtpv2c_msg_parser_template_t *
+s11_sgw_release_access_bearers_request_template_new(void)
+{
+  nw_rc_t rc = NW_OK;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
+
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_RELEASE_ACCESS_BEARERS_REQ, s11_ie_indication_generic, &tmpl);
+  DevAssert(NW_OK == rc);
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
+    NW_GTPV2C_IE_NODE_TYPE,
+    NW_GTPV2C_IE_INSTANCE_ZERO,
+    NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+    gtpv2c_node_type_ie_get,
+    offsetof(itti_s11_release_access_bearers_request_t, originating_node));
+  DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
 //------------------------------------------------------------------------------
 int s11_sgw_handle_release_access_bearers_request(
   nw_gtpv2c_stack_handle_t *stack_p,
@@ -246,37 +279,20 @@ int s11_sgw_handle_release_access_bearers_request(
   uint16_t offendingIeLength;
   itti_s11_release_access_bearers_request_t *request_p = NULL;
   MessageDef *message_p = NULL;
-  nw_gtpv2c_msg_parser_t *pMsgParser = NULL;
 
   DevAssert(stack_p);
+  DevAssert(s11_sgw_release_access_bearers_request_template);
   message_p =
     itti_alloc_new_message(TASK_S11, S11_RELEASE_ACCESS_BEARERS_REQUEST);
   request_p = &message_p->ittiMsg.s11_release_access_bearers_request;
 
   request_p->trxn = (void *) pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
   request_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_RELEASE_ACCESS_BEARERS_REQ,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
-  DevAssert(NW_OK == rc);
 
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
-    NW_GTPV2C_IE_NODE_TYPE,
-    NW_GTPV2C_IE_INSTANCE_ZERO,
-    NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
-    gtpv2c_node_type_ie_get,
-    &request_p->originating_node);
-
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_sgw_release_access_bearers_request_template,
     pUlpApi->hMsg,
+    request_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -329,15 +345,11 @@ int s11_sgw_handle_release_access_bearers_request(
     DevAssert(NW_OK == rc);
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNok;
   }
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
 
@@ -450,69 +462,70 @@ int s11_sgw_handle_create_bearer_request(
 }
 
 //------------------------------------------------------------------------------
-int s11_sgw_handle_create_bearer_response(
-  nw_gtpv2c_stack_handle_t *stack_p,
-  nw_gtpv2c_ulp_api_t *pUlpApi)
+static nw_gtpv2c_msg_parser_template_t *
+s11_sgw_create_bearer_response_template_new(void)
 {
   nw_rc_t rc = NW_OK;
-  uint8_t offendingIeType, offendingIeInstance;
-  uint16_t offendingIeLength;
-  itti_s11_create_bearer_response_t *resp_p;
-  MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
-
-  DevAssert(stack_p);
-  message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_BEARER_RESPONSE);
-  resp_p = &message_p->ittiMsg.s11_create_bearer_response;
-
-  resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
 
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_CREATE_BEARER_RSP,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_CREATE_BEARER_RSP, s11_ie_indication_generic, &tmpl);
   DevAssert(NW_OK == rc);
   /*
    * Cause IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_CAUSE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_cause_ie_get,
-    &resp_p->cause);
+    offsetof(itti_s11_create_bearer_response_t, cause));
   DevAssert(NW_OK == rc);
-
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_BEARER_CONTEXT,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_bearer_context_within_create_bearer_response_ie_get,
-    &resp_p->bearer_contexts);
+    offsetof(itti_s11_create_bearer_response_t, bearer_contexts));
   DevAssert(NW_OK == rc);
-
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PCO,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_OPTIONAL,
     gtpv2c_pco_ie_get,
-    &resp_p->pco);
+    offsetof(itti_s11_create_bearer_response_t, pco));
   DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
+//------------------------------------------------------------------------------
+int s11_sgw_handle_create_bearer_response(
+  nw_gtpv2c_stack_handle_t *stack_p,
+  nw_gtpv2c_ulp_api_t *pUlpApi)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t offendingIeType, offendingIeInstance;
+  uint16_t offendingIeLength;
+  itti_s11_create_bearer_response_t *resp_p;
+  MessageDef *message_p;
+
+  DevAssert(stack_p);
+  DevAssert(s11_sgw_create_bearer_response_template);
+  message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_BEARER_RESPONSE);
+  resp_p = &message_p->ittiMsg.s11_create_bearer_response;
+
+  resp_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
 
   /*
    * Run the parser
    */
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
-    (pUlpApi->hMsg),
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_sgw_create_bearer_response_template,
+    pUlpApi->hMsg,
+    resp_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -530,8 +543,6 @@ int s11_sgw_handle_create_bearer_response(
      */
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNerror;
@@ -546,9 +557,30 @@ int s11_sgw_handle_create_bearer_response(
     resp_p->teid,
     resp_p->cause);
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
   return itti_send_msg_to_task(TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
 }
+
+//------------------------------------------------------------------------------
+void s11_sgw_bearer_manager_init(void)
+{
+  s11_sgw_modify_bearer_request_template =
+    s11_sgw_modify_bearer_request_template_new();
+  s11_sgw_release_access_bearers_request_template =
+    s11_sgw_release_access_bearers_request_template_new();
+  s11_sgw_create_bearer_response_template =
+    s11_sgw_create_bearer_response_template_new();
+}
+
+//------------------------------------------------------------------------------
+void s11_sgw_bearer_manager_exit(void)
+{
+  nwGtpv2cMsgParserTemplateDelete(s11_sgw_modify_bearer_request_template);
+  s11_sgw_modify_bearer_request_template = NULL;
+  nwGtpv2cMsgParserTemplateDelete(
+    s11_sgw_release_access_bearers_request_template);
+  s11_sgw_release_access_bearers_request_template = NULL;
+  nwGtpv2cMsgParserTemplateDelete(s11_sgw_create_bearer_response_template);
+  s11_sgw_create_bearer_response_template = NULL;
+}
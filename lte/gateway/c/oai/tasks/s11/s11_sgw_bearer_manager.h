@@ -29,6 +29,12 @@
 #ifndef FILE_S11_SGW_BEARER_MANAGER_SEEN
 #define FILE_S11_SGW_BEARER_MANAGER_SEEN
 
+/** \brief Build the parser templates of the bearer messages, to be called
+ * once before the S11 task handles its first message
+ **/
+void s11_sgw_bearer_manager_init(void);
+void s11_sgw_bearer_manager_exit(void);
+
 int s11_sgw_handle_modify_bearer_request(
   nw_gtpv2c_stack_handle_t *stack_p,
   nw_gtpv2c_ulp_api_t *pUlpApi);
@@ -26,6 +26,7 @@
   \email: lionel.gauthier@eurecom.fr
 */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -51,243 +52,256 @@
 
 extern hash_table_ts_t *s11_sgw_teid_2_gtv2c_teid_handle;
 
+/*
+ * Parser templates of the requests received from the MME, built once at S11
+ * init and shared by all the requests
+ */
+static nw_gtpv2c_msg_parser_template_t
+  *s11_sgw_create_session_request_template = NULL;
+static nw_gtpv2c_msg_parser_template_t
+  *s11_sgw_delete_session_request_template = NULL;
+
 //------------------------------------------------------------------------------
-int s11_sgw_handle_create_session_request(
-  nw_gtpv2c_stack_handle_t *stack_p,
-  nw_gtpv2c_ulp_api_t *pUlpApi)
+static nw_gtpv2c_msg_parser_template_t *
+s11_sgw_create_session_request_template_new(void)
 {
   nw_rc_t rc = NW_OK;
-  uint8_t offendingIeType, offendingIeInstance;
-  uint16_t offendingIeLength;
-  itti_s11_create_session_request_t *create_session_request_p;
-  MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
 
-  DevAssert(stack_p);
-  message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_SESSION_REQUEST);
-  create_session_request_p = &message_p->ittiMsg.s11_create_session_request;
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_CREATE_SESSION_REQ,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_CREATE_SESSION_REQ, s11_ie_indication_generic, &tmpl);
   DevAssert(NW_OK == rc);
   /*
    * Imsi IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_IMSI,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_imsi_ie_get,
-    &create_session_request_p->imsi);
+    offsetof(itti_s11_create_session_request_t, imsi));
   DevAssert(NW_OK == rc);
   /*
    * MSISDN IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_MSISDN,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_msisdn_ie_get,
-    &create_session_request_p->msisdn);
+    offsetof(itti_s11_create_session_request_t, msisdn));
   DevAssert(NW_OK == rc);
   /*
    * MEI IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_MEI,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_mei_ie_get,
-    &create_session_request_p->mei);
+    offsetof(itti_s11_create_session_request_t, mei));
   DevAssert(NW_OK == rc);
   /*
    * ULI IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_ULI,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_uli_ie_get,
-    &create_session_request_p->uli);
+    offsetof(itti_s11_create_session_request_t, uli));
   DevAssert(NW_OK == rc);
   /*
    * Serving Network IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_SERVING_NETWORK,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_serving_network_ie_get,
-    &create_session_request_p->serving_network);
+    offsetof(itti_s11_create_session_request_t, serving_network));
   DevAssert(NW_OK == rc);
   /*
    * RAT Type IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_RAT_TYPE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_rat_type_ie_get,
-    &create_session_request_p->rat_type);
+    offsetof(itti_s11_create_session_request_t, rat_type));
   DevAssert(NW_OK == rc);
   /*
    * Indication Flags IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_INDICATION,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_indication_flags_ie_get,
-    &create_session_request_p->indication_flags);
+    offsetof(itti_s11_create_session_request_t, indication_flags));
   DevAssert(NW_OK == rc);
   /*
    * APN IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_APN,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_apn_ie_get,
-    &create_session_request_p->apn);
+    offsetof(itti_s11_create_session_request_t, apn));
   DevAssert(NW_OK == rc);
   /*
    * Selection Mode IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_SELECTION_MODE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     s11_ie_indication_generic,
-    NULL);
+    NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG);
   DevAssert(NW_OK == rc);
   /*
    * PDN Type IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PDN_TYPE,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_pdn_type_ie_get,
-    &create_session_request_p->pdn_type);
+    offsetof(itti_s11_create_session_request_t, pdn_type));
   DevAssert(NW_OK == rc);
   /*
    * PAA IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PAA,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_paa_ie_get,
-    &create_session_request_p->paa);
+    offsetof(itti_s11_create_session_request_t, paa));
   DevAssert(NW_OK == rc);
   /*
    * Sender FTEID for CP IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_FTEID,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_fteid_ie_get,
-    &create_session_request_p->sender_fteid_for_cp);
+    offsetof(itti_s11_create_session_request_t, sender_fteid_for_cp));
   DevAssert(NW_OK == rc);
   /*
    * PGW FTEID for CP IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_FTEID,
     NW_GTPV2C_IE_INSTANCE_ONE,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_fteid_ie_get,
-    &create_session_request_p->pgw_address_for_cp);
+    offsetof(itti_s11_create_session_request_t, pgw_address_for_cp));
   DevAssert(NW_OK == rc);
   /*
    * APN Restriction IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_APN_RESTRICTION,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     s11_ie_indication_generic,
-    NULL);
+    NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG);
   DevAssert(NW_OK == rc);
   /*
    * Bearer Context IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_BEARER_CONTEXT,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     gtpv2c_bearer_context_to_be_created_within_create_session_request_ie_get,
-    &create_session_request_p->bearer_contexts_to_be_created);
+    offsetof(itti_s11_create_session_request_t, bearer_contexts_to_be_created));
   DevAssert(NW_OK == rc);
 
   /*
    * Protocol Configuration Options IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_PCO,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_pco_ie_get,
-    &create_session_request_p->pco);
+    offsetof(itti_s11_create_session_request_t, pco));
   DevAssert(NW_OK == rc);
 
-  /*TODO rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_BEARER_CONTEXT, NW_GTPV2C_IE_INSTANCE_ONE, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
-           s11_bearer_context_to_be_removed_ie_get, &create_session_request_p->bearer_contexts_to_be_removed);
+  /*TODO rc = nwGtpv2cMsgParserTemplateAddIe (tmpl, NW_GTPV2C_IE_BEARER_CONTEXT, NW_GTPV2C_IE_INSTANCE_ONE, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+           s11_bearer_context_to_be_removed_ie_get, offsetof(itti_s11_create_session_request_t, bearer_contexts_to_be_removed));
   DevAssert (NW_OK == rc);*/
 
   /*
    * AMBR IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_AMBR,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_ambr_ie_get,
-    &create_session_request_p->ambr);
+    offsetof(itti_s11_create_session_request_t, ambr));
   DevAssert(NW_OK == rc);
   /*
    * Recovery IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_RECOVERY,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_MANDATORY,
     s11_ie_indication_generic,
-    NULL);
+    NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG);
   DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
+//------------------------------------------------------------------------------
+int s11_sgw_handle_create_session_request(
+  nw_gtpv2c_stack_handle_t *stack_p,
+  nw_gtpv2c_ulp_api_t *pUlpApi)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t offendingIeType, offendingIeInstance;
+  uint16_t offendingIeLength;
+  itti_s11_create_session_request_t *create_session_request_p;
+  MessageDef *message_p;
+
+  DevAssert(stack_p);
+  DevAssert(s11_sgw_create_session_request_template);
+  message_p = itti_alloc_new_message(TASK_S11, S11_CREATE_SESSION_REQUEST);
+  create_session_request_p = &message_p->ittiMsg.s11_create_session_request;
   create_session_request_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
   create_session_request_p->trxn =
     (void *) pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
   create_session_request_p->peer_ip =
     pUlpApi->u_api_info.initialReqIndInfo.peerIp;
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_sgw_create_session_request_template,
     pUlpApi->hMsg,
+    create_session_request_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -340,15 +354,11 @@ int s11_sgw_handle_create_session_request(
     DevAssert(NW_OK == rc);
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return RETURNok;
   }
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
   return itti_send_msg_to_task(TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
@@ -458,75 +468,79 @@ int s11_sgw_handle_create_session_response(
 }
 
 //------------------------------------------------------------------------------
-int s11_sgw_handle_delete_session_request(
-  nw_gtpv2c_stack_handle_t *stack_p,
-  nw_gtpv2c_ulp_api_t *pUlpApi)
+static nw_gtpv2c_msg_parser_template_t *
+s11_sgw_delete_session_request_template_new(void)
 {
   nw_rc_t rc = NW_OK;
-  uint8_t offendingIeType, offendingIeInstance;
-  uint16_t offendingIeLength;
-  itti_s11_delete_session_request_t *delete_session_request_p;
-  MessageDef *message_p;
-  nw_gtpv2c_msg_parser_t *pMsgParser;
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
 
-  DevAssert(stack_p);
-  message_p = itti_alloc_new_message(TASK_S11, S11_DELETE_SESSION_REQUEST);
-  delete_session_request_p = &message_p->ittiMsg.s11_delete_session_request;
-  /*
-   * Create a new message parser
-   */
-  rc = nwGtpv2cMsgParserNew(
-    *stack_p,
-    NW_GTP_DELETE_SESSION_REQ,
-    s11_ie_indication_generic,
-    NULL,
-    &pMsgParser);
+  rc = nwGtpv2cMsgParserTemplateNew(
+    NW_GTP_DELETE_SESSION_REQ, s11_ie_indication_generic, &tmpl);
   DevAssert(NW_OK == rc);
   /*
    * MME FTEID for CP IE
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_FTEID,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_OPTIONAL,
     gtpv2c_fteid_ie_get,
-    &delete_session_request_p->sender_fteid_for_cp);
+    offsetof(itti_s11_delete_session_request_t, sender_fteid_for_cp));
   DevAssert(NW_OK == rc);
   /*
    * Linked EPS Bearer Id IE
    * * * * This information element shall not be present for TAU/RAU/Handover with
    * * * * S-GW relocation procedures.
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_EBI,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_OPTIONAL,
     gtpv2c_ebi_ie_get,
-    &delete_session_request_p->lbi);
+    offsetof(itti_s11_delete_session_request_t, lbi));
   DevAssert(NW_OK == rc);
   /*
    * Indication Flags IE
    * * * * For a Delete Session Request on S11 interface,
    * * * * only the Operation Indication flag might be present.
    */
-  rc = nwGtpv2cMsgParserAddIe(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateAddIe(
+    tmpl,
     NW_GTPV2C_IE_INDICATION,
     NW_GTPV2C_IE_INSTANCE_ZERO,
     NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
     gtpv2c_indication_flags_ie_get,
-    &delete_session_request_p->indication_flags);
+    offsetof(itti_s11_delete_session_request_t, indication_flags));
   DevAssert(NW_OK == rc);
+  return tmpl;
+}
+
+//------------------------------------------------------------------------------
+int s11_sgw_handle_delete_session_request(
+  nw_gtpv2c_stack_handle_t *stack_p,
+  nw_gtpv2c_ulp_api_t *pUlpApi)
+{
+  nw_rc_t rc = NW_OK;
+  uint8_t offendingIeType, offendingIeInstance;
+  uint16_t offendingIeLength;
+  itti_s11_delete_session_request_t *delete_session_request_p;
+  MessageDef *message_p;
+
+  DevAssert(stack_p);
+  DevAssert(s11_sgw_delete_session_request_template);
+  message_p = itti_alloc_new_message(TASK_S11, S11_DELETE_SESSION_REQUEST);
+  delete_session_request_p = &message_p->ittiMsg.s11_delete_session_request;
   delete_session_request_p->teid = nwGtpv2cMsgGetTeid(pUlpApi->hMsg);
   delete_session_request_p->trxn =
     (void *) pUlpApi->u_api_info.initialReqIndInfo.hTrxn;
   delete_session_request_p->peer_ip =
     pUlpApi->u_api_info.initialReqIndInfo.peerIp;
-  rc = nwGtpv2cMsgParserRun(
-    pMsgParser,
+  rc = nwGtpv2cMsgParserTemplateRun(
+    s11_sgw_delete_session_request_template,
     pUlpApi->hMsg,
+    delete_session_request_p,
     &offendingIeType,
     &offendingIeInstance,
     &offendingIeLength);
@@ -581,15 +595,11 @@ int s11_sgw_handle_delete_session_request(
     DevAssert(NW_OK == rc);
     itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
     message_p = NULL;
-    rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-    DevAssert(NW_OK == rc);
     rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
     DevAssert(NW_OK == rc);
     return NW_OK;
   }
 
-  rc = nwGtpv2cMsgParserDelete(*stack_p, pMsgParser);
-  DevAssert(NW_OK == rc);
   rc = nwGtpv2cMsgDelete(*stack_p, (pUlpApi->hMsg));
   DevAssert(NW_OK == rc);
   return itti_send_msg_to_task(TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
@@ -630,3 +640,21 @@ int s11_sgw_handle_delete_session_response(
   DevAssert(NW_OK == rc);
   return RETURNok;
 }
+
+//------------------------------------------------------------------------------
+void s11_sgw_session_manager_init(void)
+{
+  s11_sgw_create_session_request_template =
+    s11_sgw_create_session_request_template_new();
+  s11_sgw_delete_session_request_template =
+    s11_sgw_delete_session_request_template_new();
+}
+
+//------------------------------------------------------------------------------
+void s11_sgw_session_manager_exit(void)
+{
+  nwGtpv2cMsgParserTemplateDelete(s11_sgw_create_session_request_template);
+  s11_sgw_create_session_request_template = NULL;
+  nwGtpv2cMsgParserTemplateDelete(s11_sgw_delete_session_request_template);
+  s11_sgw_delete_session_request_template = NULL;
+}
@@ -29,6 +29,12 @@
 #ifndef FILE_S11_SGW_SESSION_MANAGER_SEEN
 #define FILE_S11_SGW_SESSION_MANAGER_SEEN
 
+/** \brief Build the parser templates of the session requests, to be called
+ * once before the S11 task handles its first message
+ **/
+void s11_sgw_session_manager_init(void);
+void s11_sgw_session_manager_exit(void);
+
 int s11_sgw_handle_create_session_request(
   nw_gtpv2c_stack_handle_t *stack_p,
   nw_gtpv2c_ulp_api_t *pUlpApi);
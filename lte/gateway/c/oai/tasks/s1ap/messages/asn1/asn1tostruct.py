@@ -256,6 +256,7 @@ f.write("typedef struct %s_message_s {\n" % (fileprefix))
 f.write("    %s_ProcedureCode_t procedureCode;\n" % (fileprefix_first_upper))
 f.write("    %s_Criticality_t   criticality;\n" % (fileprefix_first_upper))
 f.write("    uint8_t            direction;\n")
+f.write("    uint8_t            fast_decoded; ///< IEs are views into the received buffer, nothing to free\n")
 f.write("    union {\n")
 
 messageList = list(iesDefs.keys())
@@ -57,6 +57,7 @@
 #include "mme_config.h"
 #include "timer.h"
 #include "itti_free_defined_msg.h"
+#include "itti_workers.h"
 
 #if S1AP_DEBUG_LIST
 #define eNB_LIST_OUT(x, args...)                                               \
@@ -77,6 +78,13 @@ hash_table_ts_t g_s1ap_enb_coll = {
 hash_table_ts_t g_s1ap_mme_id2assoc_id_coll = {
   .mutex = PTHREAD_MUTEX_INITIALIZER,
   0}; // contains sctp association id, key is mme_ue_s1ap_id;
+// Associations closed or reset, their messages may remove the eNB. Only used
+// by the S1AP task thread, when there are workers.
+static hash_table_ts_t s1ap_closing_assoc_coll = {
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  0}; // contains sctp association id, key is sctp association id;
+// NULL when the S1AP task thread processes the messages itself
+static itti_workers_t *s1ap_workers = NULL;
 
 static int indent = 0;
 void *s1ap_mme_thread(void *args);
@@ -104,6 +112,374 @@ static int s1ap_send_init_sctp(void)
   return itti_send_msg_to_task(TASK_SCTP, INSTANCE_DEFAULT, message_p);
 }
 
+//------------------------------------------------------------------------------
+// Process a message of the S1AP task queue, and free it
+static void s1ap_mme_handle_itti_message(MessageDef *received_message_p)
+{
+  MessagesIds message_id = MESSAGES_ID_MAX;
+
+  switch (ITTI_MSG_ID(received_message_p)) {
+    case ACTIVATE_MESSAGE: {
+      hss_associated = true;
+    } break;
+
+    case MESSAGE_TEST:
+      OAILOG_DEBUG(LOG_S1AP, "Received MESSAGE_TEST\n");
+      break;
+
+    case SCTP_DATA_IND: {
+      /*
+       * New message received from SCTP layer.
+       * * * * Decode and handle it.
+       */
+      s1ap_message message = {0};
+
+      /*
+       * Invoke S1AP message decoder
+       */
+      if (
+        s1ap_mme_decode_pdu(
+          &message, SCTP_DATA_IND(received_message_p).payload, &message_id) <
+        0) {
+        // TODO: Notify eNB of failure with right cause
+        OAILOG_ERROR(LOG_S1AP, "Failed to decode new buffer\n");
+      } else {
+        s1ap_mme_handle_message(
+          SCTP_DATA_IND(received_message_p).assoc_id,
+          SCTP_DATA_IND(received_message_p).stream,
+          &message);
+      }
+
+      if (message_id != MESSAGES_ID_MAX) {
+        s1ap_free_mme_decode_pdu(&message, message_id);
+      }
+
+      /*
+       * Free received PDU array
+       */
+      bdestroy_wrapper(&SCTP_DATA_IND(received_message_p).payload);
+    } break;
+
+    case SCTP_DATA_CNF:
+      s1ap_mme_itti_nas_downlink_cnf(
+        SCTP_DATA_CNF(received_message_p).mme_ue_s1ap_id,
+        SCTP_DATA_CNF(received_message_p).is_success);
+      break;
+      /*
+     * SCTP layer notifies S1AP of disconnection of a peer.
+     */
+    case SCTP_CLOSE_ASSOCIATION: {
+      s1ap_handle_sctp_disconnection(
+        SCTP_CLOSE_ASSOCIATION(received_message_p).assoc_id,
+        SCTP_CLOSE_ASSOCIATION(received_message_p).reset);
+    } break;
+
+    case SCTP_NEW_ASSOCIATION: {
+      increment_counter("mme_new_association", 1, NO_LABELS);
+      if (s1ap_handle_new_association(
+            &received_message_p->ittiMsg.sctp_new_peer)) {
+        increment_counter("mme_new_association", 1, 1, "result", "failure");
+      } else {
+        increment_counter("mme_new_association", 1, 1, "result", "success");
+      }
+    } break;
+
+    case S1AP_NAS_DL_DATA_REQ: {
+      /*
+       * New message received from NAS task.
+       * * * * This corresponds to a S1AP downlink nas transport message.
+       */
+      s1ap_generate_downlink_nas_transport(
+        S1AP_NAS_DL_DATA_REQ(received_message_p).enb_ue_s1ap_id,
+        S1AP_NAS_DL_DATA_REQ(received_message_p).mme_ue_s1ap_id,
+        &S1AP_NAS_DL_DATA_REQ(received_message_p).nas_msg);
+    } break;
+
+    case S1AP_E_RAB_SETUP_REQ: {
+      s1ap_generate_s1ap_e_rab_setup_req(
+        &S1AP_E_RAB_SETUP_REQ(received_message_p));
+    } break;
+
+    // From MME_APP task
+    case S1AP_UE_CONTEXT_RELEASE_COMMAND: {
+      s1ap_handle_ue_context_release_command(
+        &received_message_p->ittiMsg.s1ap_ue_context_release_command);
+    } break;
+
+    case MME_APP_CONNECTION_ESTABLISHMENT_CNF: {
+      s1ap_handle_conn_est_cnf(
+        &MME_APP_CONNECTION_ESTABLISHMENT_CNF(received_message_p));
+    } break;
+
+    case MME_APP_S1AP_MME_UE_ID_NOTIFICATION: {
+      s1ap_handle_mme_ue_id_notification(
+        &MME_APP_S1AP_MME_UE_ID_NOTIFICATION(received_message_p));
+    } break;
+
+    case S1AP_ENB_INITIATED_RESET_ACK: {
+      s1ap_handle_enb_initiated_reset_ack(
+        &S1AP_ENB_INITIATED_RESET_ACK(received_message_p));
+    } break;
+
+    case S1AP_PAGING_REQUEST: {
+      if (
+        s1ap_handle_paging_request(
+          &S1AP_PAGING_REQUEST(received_message_p)) != RETURNok) {
+        OAILOG_ERROR(LOG_S1AP, "Failed to send paging message\n");
+      }
+    } break;
+    case S1AP_UE_CONTEXT_MODIFICATION_REQUEST: {
+      s1ap_handle_ue_context_mod_req(
+        &received_message_p->ittiMsg.s1ap_ue_context_mod_request);
+    } break;
+
+    case TIMER_HAS_EXPIRED: {
+      if (!timer_exists(
+            received_message_p->ittiMsg.timer_has_expired.timer_id)) {
+        break;
+      }
+      ue_description_t *ue_ref_p = NULL;
+      enb_description_t *enb_ref_p = NULL;
+      if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) {
+        // check whether timer is related to eNB procedure or UE procedure
+        s1ap_timer_arg_t timer_arg =
+          *((s1ap_timer_arg_t *) (received_message_p->ittiMsg
+                                    .timer_has_expired.arg));
+        if (timer_arg.timer_class == S1AP_UE_TIMER) {
+          mme_ue_s1ap_id_t mme_ue_s1ap_id = timer_arg.instance_id;
+          if (
+            (ue_ref_p = s1ap_is_ue_mme_id_in_list(mme_ue_s1ap_id)) == NULL) {
+            OAILOG_WARNING(
+              LOG_S1AP,
+              "Timer expired but no assoicated UE context for UE id %d\n",
+              mme_ue_s1ap_id);
+            timer_handle_expired(
+              received_message_p->ittiMsg.timer_has_expired.timer_id);
+            break;
+          }
+          if (
+            received_message_p->ittiMsg.timer_has_expired.timer_id ==
+            ue_ref_p->s1ap_ue_context_rel_timer.id) {
+            // UE context release complete timer expiry handler
+            OAILOG_INFO(
+              LOG_S1AP,
+              "ue_context_release_command_timer_expired for UE id %d\n",
+              mme_ue_s1ap_id);
+            increment_counter(
+              "ue_context_release_command_timer_expired", 1, NO_LABELS);
+            s1ap_mme_handle_ue_context_rel_comp_timer_expiry(ue_ref_p);
+          }
+        } else if (timer_arg.timer_class == S1AP_ENB_TIMER) {
+          sctp_assoc_id_t assoc_id = timer_arg.instance_id;
+          if ((enb_ref_p = s1ap_is_enb_assoc_id_in_list(assoc_id)) == NULL) {
+            OAILOG_WARNING(
+              LOG_S1AP,
+              "Timer expired but no assoicated eNB context for eNB assoc_id "
+              "%d\n",
+              assoc_id);
+            timer_handle_expired(
+              received_message_p->ittiMsg.timer_has_expired.timer_id);
+            break;
+          }
+          if (
+            received_message_p->ittiMsg.timer_has_expired.timer_id ==
+            enb_ref_p->s1ap_enb_assoc_clean_up_timer.id) {
+            OAILOG_INFO(
+              LOG_S1AP,
+              "enb_sctp_shutdown_ue_clean_up_timer_expired for enb assoc_id "
+              "%d\n",
+              assoc_id);
+            increment_counter(
+              "enb_sctp_shutdown_ue_clean_up_timer_expired", 1, NO_LABELS);
+            s1ap_enb_assoc_clean_up_timer_expiry(enb_ref_p);
+          }
+        } else {
+          OAILOG_WARNING(
+            LOG_S1AP,
+            " S1AP Timer expired with invalid timer class  %u \n",
+            timer_arg.timer_class);
+        }
+      }
+      timer_handle_expired(
+        received_message_p->ittiMsg.timer_has_expired.timer_id);
+
+      /* TODO - Commenting out below function as it is not used as of now.
+       * Need to handle it when we support other timers in S1AP
+       */
+
+      //s1ap_handle_timer_expiry (&received_message_p->ittiMsg.timer_has_expired);
+    } break;
+
+    default: {
+      OAILOG_ERROR(
+        LOG_S1AP,
+        "Unknown message ID %d:%s\n",
+        ITTI_MSG_ID(received_message_p),
+        ITTI_MSG_NAME(received_message_p));
+    } break;
+  }
+
+  itti_free_msg_content(received_message_p);
+  itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
+}
+
+//------------------------------------------------------------------------------
+// Looked up in the APER header (initiatingMessage, procedure code), before
+// any decoding
+static bool s1ap_mme_is_s1_setup_request(const_bstring const raw)
+{
+  return (blength(raw) >= 2) && (raw->data[0] == 0x00) &&
+         (raw->data[1] == S1ap_ProcedureCode_id_S1Setup);
+}
+
+//------------------------------------------------------------------------------
+static bool s1ap_mme_ue_assoc_id(
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  sctp_assoc_id_t *const assoc_id)
+{
+  void *id = NULL;
+
+  if (
+    (mme_ue_s1ap_id == INVALID_MME_UE_S1AP_ID) ||
+    (HASH_TABLE_OK != hashtable_ts_get(
+                        &g_s1ap_mme_id2assoc_id_coll,
+                        (const hash_key_t) mme_ue_s1ap_id,
+                        &id))) {
+    return false;
+  }
+  *assoc_id = (sctp_assoc_id_t)(uintptr_t) id;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Runs on the S1AP task thread when there are workers: the messages of an eNB
+ * association and of its UEs go to the worker of the association.
+ * S1 Setup (checks the other eNBs, the number of eNBs) and the messages of a
+ * closing association (may remove the eNB) are run while no other worker runs.
+ * Messages not bound to a known association are run as a barrier, once the
+ * messages dispatched before them have been processed.
+ */
+static void s1ap_mme_dispatch_itti_message(MessageDef *received_message_p)
+{
+  sctp_assoc_id_t assoc_id = 0;
+  bool routed = false;
+  bool exclusive = false;
+
+  switch (ITTI_MSG_ID(received_message_p)) {
+    case SCTP_DATA_IND: {
+      assoc_id = SCTP_DATA_IND(received_message_p).assoc_id;
+      routed = true;
+      exclusive =
+        s1ap_mme_is_s1_setup_request(SCTP_DATA_IND(received_message_p).payload);
+    } break;
+
+    case SCTP_NEW_ASSOCIATION: {
+      assoc_id = received_message_p->ittiMsg.sctp_new_peer.assoc_id;
+      routed = true;
+      hashtable_ts_free(&s1ap_closing_assoc_coll, (const hash_key_t) assoc_id);
+    } break;
+
+    case SCTP_CLOSE_ASSOCIATION: {
+      assoc_id = SCTP_CLOSE_ASSOCIATION(received_message_p).assoc_id;
+      routed = true;
+      hashtable_ts_insert(
+        &s1ap_closing_assoc_coll,
+        (const hash_key_t) assoc_id,
+        (void *) (uintptr_t) assoc_id);
+    } break;
+
+    case S1AP_ENB_INITIATED_RESET_ACK: {
+      assoc_id = S1AP_ENB_INITIATED_RESET_ACK(received_message_p).sctp_assoc_id;
+      routed = true;
+    } break;
+
+    case S1AP_PAGING_REQUEST: {
+      assoc_id = S1AP_PAGING_REQUEST(received_message_p).sctp_assoc_id;
+      routed = true;
+    } break;
+
+    case MME_APP_S1AP_MME_UE_ID_NOTIFICATION: {
+      const itti_mme_app_s1ap_mme_ue_id_notification_t *const notification_p =
+        &MME_APP_S1AP_MME_UE_ID_NOTIFICATION(received_message_p);
+      assoc_id = notification_p->sctp_assoc_id;
+      routed = true;
+      /*
+       * Recorded now (again by the worker), for the next messages of the UE to
+       * be queued behind this one on the same worker.
+       */
+      hashtable_ts_insert(
+        &g_s1ap_mme_id2assoc_id_coll,
+        (const hash_key_t) notification_p->mme_ue_s1ap_id,
+        (void *) (uintptr_t) assoc_id);
+    } break;
+
+    case SCTP_DATA_CNF: {
+      assoc_id = SCTP_DATA_CNF(received_message_p).assoc_id;
+      routed = true;
+    } break;
+
+    case S1AP_NAS_DL_DATA_REQ: {
+      routed = s1ap_mme_ue_assoc_id(
+        S1AP_NAS_DL_DATA_REQ(received_message_p).mme_ue_s1ap_id, &assoc_id);
+    } break;
+
+    case S1AP_E_RAB_SETUP_REQ: {
+      routed = s1ap_mme_ue_assoc_id(
+        S1AP_E_RAB_SETUP_REQ(received_message_p).mme_ue_s1ap_id, &assoc_id);
+    } break;
+
+    case S1AP_UE_CONTEXT_RELEASE_COMMAND: {
+      routed = s1ap_mme_ue_assoc_id(
+        received_message_p->ittiMsg.s1ap_ue_context_release_command
+          .mme_ue_s1ap_id,
+        &assoc_id);
+    } break;
+
+    case MME_APP_CONNECTION_ESTABLISHMENT_CNF: {
+      routed = s1ap_mme_ue_assoc_id(
+        MME_APP_CONNECTION_ESTABLISHMENT_CNF(received_message_p).ue_id,
+        &assoc_id);
+    } break;
+
+    case S1AP_UE_CONTEXT_MODIFICATION_REQUEST: {
+      routed = s1ap_mme_ue_assoc_id(
+        received_message_p->ittiMsg.s1ap_ue_context_mod_request.mme_ue_s1ap_id,
+        &assoc_id);
+    } break;
+
+    case TIMER_HAS_EXPIRED: {
+      if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) {
+        s1ap_timer_arg_t timer_arg =
+          *((s1ap_timer_arg_t *) (received_message_p->ittiMsg.timer_has_expired
+                                    .arg));
+        if (timer_arg.timer_class == S1AP_UE_TIMER) {
+          routed = s1ap_mme_ue_assoc_id(timer_arg.instance_id, &assoc_id);
+        } else if (timer_arg.timer_class == S1AP_ENB_TIMER) {
+          assoc_id = timer_arg.instance_id;
+          routed = true;
+        }
+      }
+    } break;
+
+    default: {
+      // ACTIVATE_MESSAGE, MESSAGE_TEST, unknown messages
+    } break;
+  }
+
+  if (!routed) {
+    itti_workers_dispatch_barrier(s1ap_workers, received_message_p);
+    return;
+  }
+  if (
+    HASH_TABLE_OK == hashtable_ts_is_key_exists(
+                       &s1ap_closing_assoc_coll, (const hash_key_t) assoc_id)) {
+    exclusive = true;
+  }
+  itti_workers_dispatch(
+    s1ap_workers, (uint32_t) assoc_id, exclusive, received_message_p);
+}
+
 //------------------------------------------------------------------------------
 void *s1ap_mme_thread(__attribute__((unused)) void *args)
 {
@@ -111,7 +487,6 @@ void *s1ap_mme_thread(__attribute__((unused)) void *args)
 
   while (1) {
     MessageDef *received_message_p = NULL;
-    MessagesIds message_id = MESSAGES_ID_MAX;
     /*
      * Trying to fetch a message from the message queue.
      * * * * If the queue is empty, this function will block till a
@@ -120,217 +495,17 @@ void *s1ap_mme_thread(__attribute__((unused)) void *args)
     itti_receive_msg(TASK_S1AP, &received_message_p);
     DevAssert(received_message_p != NULL);
 
-    switch (ITTI_MSG_ID(received_message_p)) {
-      case ACTIVATE_MESSAGE: {
-        hss_associated = true;
-      } break;
-
-      case MESSAGE_TEST:
-        OAILOG_DEBUG(LOG_S1AP, "Received MESSAGE_TEST\n");
-        break;
-
-      case SCTP_DATA_IND: {
-        /*
-         * New message received from SCTP layer.
-         * * * * Decode and handle it.
-         */
-        s1ap_message message = {0};
-
-        /*
-         * Invoke S1AP message decoder
-         */
-        if (
-          s1ap_mme_decode_pdu(
-            &message, SCTP_DATA_IND(received_message_p).payload, &message_id) <
-          0) {
-          // TODO: Notify eNB of failure with right cause
-          OAILOG_ERROR(LOG_S1AP, "Failed to decode new buffer\n");
-        } else {
-          s1ap_mme_handle_message(
-            SCTP_DATA_IND(received_message_p).assoc_id,
-            SCTP_DATA_IND(received_message_p).stream,
-            &message);
-        }
-
-        if (message_id != MESSAGES_ID_MAX) {
-          s1ap_free_mme_decode_pdu(&message, message_id);
-        }
-
-        /*
-         * Free received PDU array
-         */
-        bdestroy_wrapper(&SCTP_DATA_IND(received_message_p).payload);
-      } break;
-
-      case SCTP_DATA_CNF:
-        s1ap_mme_itti_nas_downlink_cnf(
-          SCTP_DATA_CNF(received_message_p).mme_ue_s1ap_id,
-          SCTP_DATA_CNF(received_message_p).is_success);
-        break;
-        /*
-       * SCTP layer notifies S1AP of disconnection of a peer.
-       */
-      case SCTP_CLOSE_ASSOCIATION: {
-        s1ap_handle_sctp_disconnection(
-          SCTP_CLOSE_ASSOCIATION(received_message_p).assoc_id,
-          SCTP_CLOSE_ASSOCIATION(received_message_p).reset);
-      } break;
-
-      case SCTP_NEW_ASSOCIATION: {
-        increment_counter("mme_new_association", 1, NO_LABELS);
-        if (s1ap_handle_new_association(
-              &received_message_p->ittiMsg.sctp_new_peer)) {
-          increment_counter("mme_new_association", 1, 1, "result", "failure");
-        } else {
-          increment_counter("mme_new_association", 1, 1, "result", "success");
-        }
-      } break;
-
-      case S1AP_NAS_DL_DATA_REQ: {
-        /*
-         * New message received from NAS task.
-         * * * * This corresponds to a S1AP downlink nas transport message.
-         */
-        s1ap_generate_downlink_nas_transport(
-          S1AP_NAS_DL_DATA_REQ(received_message_p).enb_ue_s1ap_id,
-          S1AP_NAS_DL_DATA_REQ(received_message_p).mme_ue_s1ap_id,
-          &S1AP_NAS_DL_DATA_REQ(received_message_p).nas_msg);
-      } break;
-
-      case S1AP_E_RAB_SETUP_REQ: {
-        s1ap_generate_s1ap_e_rab_setup_req(
-          &S1AP_E_RAB_SETUP_REQ(received_message_p));
-      } break;
-
-      // From MME_APP task
-      case S1AP_UE_CONTEXT_RELEASE_COMMAND: {
-        s1ap_handle_ue_context_release_command(
-          &received_message_p->ittiMsg.s1ap_ue_context_release_command);
-      } break;
-
-      case MME_APP_CONNECTION_ESTABLISHMENT_CNF: {
-        s1ap_handle_conn_est_cnf(
-          &MME_APP_CONNECTION_ESTABLISHMENT_CNF(received_message_p));
-      } break;
-
-      case MME_APP_S1AP_MME_UE_ID_NOTIFICATION: {
-        s1ap_handle_mme_ue_id_notification(
-          &MME_APP_S1AP_MME_UE_ID_NOTIFICATION(received_message_p));
-      } break;
-
-      case S1AP_ENB_INITIATED_RESET_ACK: {
-        s1ap_handle_enb_initiated_reset_ack(
-          &S1AP_ENB_INITIATED_RESET_ACK(received_message_p));
-      } break;
-
-      case S1AP_PAGING_REQUEST: {
-        if (
-          s1ap_handle_paging_request(
-            &S1AP_PAGING_REQUEST(received_message_p)) != RETURNok) {
-          OAILOG_ERROR(LOG_S1AP, "Failed to send paging message\n");
-        }
-      } break;
-      case S1AP_UE_CONTEXT_MODIFICATION_REQUEST: {
-        s1ap_handle_ue_context_mod_req(
-          &received_message_p->ittiMsg.s1ap_ue_context_mod_request);
-      } break;
-
-      case TIMER_HAS_EXPIRED: {
-        if (!timer_exists(
-              received_message_p->ittiMsg.timer_has_expired.timer_id)) {
-          break;
-        }
-        ue_description_t *ue_ref_p = NULL;
-        enb_description_t *enb_ref_p = NULL;
-        if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) {
-          // check whether timer is related to eNB procedure or UE procedure
-          s1ap_timer_arg_t timer_arg =
-            *((s1ap_timer_arg_t *) (received_message_p->ittiMsg
-                                      .timer_has_expired.arg));
-          if (timer_arg.timer_class == S1AP_UE_TIMER) {
-            mme_ue_s1ap_id_t mme_ue_s1ap_id = timer_arg.instance_id;
-            if (
-              (ue_ref_p = s1ap_is_ue_mme_id_in_list(mme_ue_s1ap_id)) == NULL) {
-              OAILOG_WARNING(
-                LOG_S1AP,
-                "Timer expired but no assoicated UE context for UE id %d\n",
-                mme_ue_s1ap_id);
-              timer_handle_expired(
-                received_message_p->ittiMsg.timer_has_expired.timer_id);
-              break;
-            }
-            if (
-              received_message_p->ittiMsg.timer_has_expired.timer_id ==
-              ue_ref_p->s1ap_ue_context_rel_timer.id) {
-              // UE context release complete timer expiry handler
-              OAILOG_INFO(
-                LOG_S1AP,
-                "ue_context_release_command_timer_expired for UE id %d\n",
-                mme_ue_s1ap_id);
-              increment_counter(
-                "ue_context_release_command_timer_expired", 1, NO_LABELS);
-              s1ap_mme_handle_ue_context_rel_comp_timer_expiry(ue_ref_p);
-            }
-          } else if (timer_arg.timer_class == S1AP_ENB_TIMER) {
-            sctp_assoc_id_t assoc_id = timer_arg.instance_id;
-            if ((enb_ref_p = s1ap_is_enb_assoc_id_in_list(assoc_id)) == NULL) {
-              OAILOG_WARNING(
-                LOG_S1AP,
-                "Timer expired but no assoicated eNB context for eNB assoc_id "
-                "%d\n",
-                assoc_id);
-              timer_handle_expired(
-                received_message_p->ittiMsg.timer_has_expired.timer_id);
-              break;
-            }
-            if (
-              received_message_p->ittiMsg.timer_has_expired.timer_id ==
-              enb_ref_p->s1ap_enb_assoc_clean_up_timer.id) {
-              OAILOG_INFO(
-                LOG_S1AP,
-                "enb_sctp_shutdown_ue_clean_up_timer_expired for enb assoc_id "
-                "%d\n",
-                assoc_id);
-              increment_counter(
-                "enb_sctp_shutdown_ue_clean_up_timer_expired", 1, NO_LABELS);
-              s1ap_enb_assoc_clean_up_timer_expiry(enb_ref_p);
-            }
-          } else {
-            OAILOG_WARNING(
-              LOG_S1AP,
-              " S1AP Timer expired with invalid timer class  %u \n",
-              timer_arg.timer_class);
-          }
-        }
-        timer_handle_expired(
-          received_message_p->ittiMsg.timer_has_expired.timer_id);
-
-        /* TODO - Commenting out below function as it is not used as of now.
-         * Need to handle it when we support other timers in S1AP
-         */
-
-        //s1ap_handle_timer_expiry (&received_message_p->ittiMsg.timer_has_expired);
-      } break;
-
-      case TERMINATE_MESSAGE: {
-        s1ap_mme_exit();
-        itti_free_msg_content(received_message_p);
-        itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
-        OAI_FPRINTF_INFO("TASK_S1AP terminated\n");
-        itti_exit_task();
-      } break;
-
-      default: {
-        OAILOG_ERROR(
-          LOG_S1AP,
-          "Unknown message ID %d:%s\n",
-          ITTI_MSG_ID(received_message_p),
-          ITTI_MSG_NAME(received_message_p));
-      } break;
+    if (ITTI_MSG_ID(received_message_p) == TERMINATE_MESSAGE) {
+      s1ap_mme_exit();
+      itti_free_msg_content(received_message_p);
+      itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
+      OAI_FPRINTF_INFO("TASK_S1AP terminated\n");
+      itti_exit_task();
+    } else if (s1ap_workers) {
+      s1ap_mme_dispatch_itti_message(received_message_p);
+    } else {
+      s1ap_mme_handle_itti_message(received_message_p);
     }
-
-    itti_free_msg_content(received_message_p);
-    itti_free(ITTI_MSG_ORIGIN_ID(received_message_p), received_message_p);
     received_message_p = NULL;
   }
 
@@ -372,6 +547,27 @@ int s1ap_mme_init(void)
   bdestroy_wrapper(&bs2);
   if (!h) return RETURNerror;
 
+  if (mme_config.s1ap_config.nb_workers > 1) {
+    bstring bs3 = bfromcstr("s1ap_closing_assoc_coll");
+    h = hashtable_ts_init(
+      &s1ap_closing_assoc_coll,
+      mme_config.max_enbs,
+      NULL,
+      hash_free_int_func,
+      bs3);
+    bdestroy_wrapper(&bs3);
+    if (!h) return RETURNerror;
+
+    s1ap_workers = itti_workers_create(
+      "S1AP",
+      mme_config.s1ap_config.nb_workers,
+      s1ap_mme_handle_itti_message);
+    if (!s1ap_workers) {
+      OAILOG_ERROR(LOG_S1AP, "Error while starting S1AP workers\n");
+      return RETURNerror;
+    }
+  }
+
   if (itti_create_task(TASK_S1AP, &s1ap_mme_thread, NULL) < 0) {
     OAILOG_ERROR(LOG_S1AP, "Error while creating S1AP task\n");
     return RETURNerror;
@@ -390,6 +586,10 @@ int s1ap_mme_init(void)
 void s1ap_mme_exit(void)
 {
   OAILOG_DEBUG(LOG_S1AP, "Cleaning S1AP\n");
+  if (s1ap_workers) {
+    itti_workers_destroy(&s1ap_workers);
+    hashtable_ts_destroy(&s1ap_closing_assoc_coll);
+  }
   if (hashtable_ts_destroy(&g_s1ap_enb_coll) != HASH_TABLE_OK) {
     OAI_FPRINTF_ERR("An error occured while destroying s1 eNB hash table");
   }
@@ -635,8 +835,23 @@ ue_description_t *s1ap_is_ue_mme_id_in_list(
   const mme_ue_s1ap_id_t mme_ue_s1ap_id)
 {
   ue_description_t *ue_ref = NULL;
+  enb_description_t *enb_ref = NULL;
   mme_ue_s1ap_id_t *mme_ue_s1ap_id_p = (mme_ue_s1ap_id_t *) &mme_ue_s1ap_id;
-
+  void *id = NULL;
+
+  // Look first in the eNB the UE has been associated with
+  if (
+    (HASH_TABLE_OK == hashtable_ts_get(
+                        &g_s1ap_mme_id2assoc_id_coll,
+                        (const hash_key_t) mme_ue_s1ap_id,
+                        &id)) &&
+    (enb_ref = s1ap_is_enb_assoc_id_in_list((sctp_assoc_id_t)(uintptr_t) id))) {
+    if (s1ap_enb_find_ue_by_mme_ue_id_cb(
+          0, enb_ref, (void *) mme_ue_s1ap_id_p, (void **) &ue_ref)) {
+      OAILOG_TRACE(LOG_S1AP, "Return ue_ref %p \n", ue_ref);
+      return ue_ref;
+    }
+  }
   hashtable_ts_apply_callback_on_elements(
     &g_s1ap_enb_coll,
     s1ap_enb_find_ue_by_mme_ue_id_cb,
@@ -661,6 +876,25 @@ ue_description_t *s1ap_is_s11_sgw_teid_in_list(const s11_teid_t teid)
   return ue_ref;
 }
 
+//------------------------------------------------------------------------------
+// Drop the association recorded when the notification has been dispatched
+static void s1ap_forget_ue_mme_s1ap_id_association(
+  const sctp_assoc_id_t sctp_assoc_id,
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id)
+{
+  void *id = NULL;
+
+  if (
+    (HASH_TABLE_OK == hashtable_ts_get(
+                        &g_s1ap_mme_id2assoc_id_coll,
+                        (const hash_key_t) mme_ue_s1ap_id,
+                        &id)) &&
+    ((sctp_assoc_id_t)(uintptr_t) id == sctp_assoc_id)) {
+    hashtable_ts_free(
+      &g_s1ap_mme_id2assoc_id_coll, (const hash_key_t) mme_ue_s1ap_id);
+  }
+}
+
 //------------------------------------------------------------------------------
 void s1ap_notified_new_ue_mme_s1ap_id_association(
   const sctp_assoc_id_t sctp_assoc_id,
@@ -691,10 +925,12 @@ void s1ap_notified_new_ue_mme_s1ap_id_association(
       LOG_S1AP,
       "Could not find  ue  with enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT "\n",
       enb_ue_s1ap_id);
+    s1ap_forget_ue_mme_s1ap_id_association(sctp_assoc_id, mme_ue_s1ap_id);
     return;
   }
   OAILOG_DEBUG(
     LOG_S1AP, "Could not find  eNB with sctp_assoc_id %d \n", sctp_assoc_id);
+  s1ap_forget_ue_mme_s1ap_id_association(sctp_assoc_id, mme_ue_s1ap_id);
 }
 
 //------------------------------------------------------------------------------
@@ -709,8 +945,8 @@ enb_description_t *s1ap_new_enb(void)
    * * * * TODO: Notify eNB with a cause like Hardware Failure.
    */
   DevAssert(enb_ref != NULL);
-  // Update number of eNB associated
-  nb_enb_associated++;
+  // Update number of eNB associated, also done by the other S1AP workers
+  __sync_fetch_and_add(&nb_enb_associated, 1);
   bstring bs = bfromcstr("s1ap_ue_coll");
   hashtable_ts_init(
     &enb_ref->ue_coll, mme_config.max_ues, NULL, free_wrapper, bs);
@@ -843,5 +1079,5 @@ void s1ap_remove_enb(enb_description_t *enb_ref)
   enb_ref->s1_state = S1AP_INIT;
   hashtable_ts_destroy(&enb_ref->ue_coll);
   hashtable_ts_free(&g_s1ap_enb_coll, enb_ref->sctp_assoc_id);
-  nb_enb_associated--;
+  __sync_fetch_and_sub(&nb_enb_associated, 1);
 }
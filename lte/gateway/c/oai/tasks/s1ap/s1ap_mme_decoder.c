@@ -41,6 +41,7 @@
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme.h"
 #include "s1ap_mme_decoder.h"
+#include "s1ap_mme_fast_decoder.h"
 #include "s1ap_mme_handlers.h"
 #include "dynamic_memory_check.h"
 
@@ -224,7 +225,7 @@ static int s1ap_mme_decode_unsuccessfull_outcome(
   return ret;
 }
 
-int s1ap_mme_decode_pdu(
+int s1ap_mme_asn1c_decode_pdu(
   s1ap_message *message,
   const_bstring const raw,
   MessagesIds *message_id)
@@ -245,6 +246,7 @@ int s1ap_mme_decode_pdu(
   }
 
   message->direction = pdu_p->present;
+  message->fast_decoded = false;
 
   switch (pdu_p->present) {
     case S1AP_PDU_PR_initiatingMessage:
@@ -274,8 +276,29 @@ int s1ap_mme_decode_pdu(
   return ret;
 }
 
+int s1ap_mme_decode_pdu(
+  s1ap_message *message,
+  const_bstring const raw,
+  MessagesIds *message_id)
+{
+  DevAssert(raw != NULL);
+
+  /*
+   * UE associated NAS transport first, without allocation
+   */
+  if (s1ap_mme_fast_decode_pdu(message, raw, message_id) == RETURNok) {
+    return RETURNok;
+  }
+  return s1ap_mme_asn1c_decode_pdu(message, raw, message_id);
+}
+
 int s1ap_free_mme_decode_pdu(s1ap_message *message, MessagesIds message_id)
 {
+  if (message->fast_decoded) {
+    // The IEs are views into the received buffer
+    return RETURNok;
+  }
+
   switch (message_id) {
     case S1AP_UPLINK_NAS_LOG:
       return free_s1ap_uplinknastransport(
@@ -0,0 +1,440 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_fast_decoder.c
+  \brief Hand written APER decoder for the UE associated NAS transport
+  messages, see s1ap_mme_fast_decoder.h.
+  The encodings follow X.691 (ALIGNED variant) for the S1AP r10.5 grammar.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "common_defs.h"
+#include "intertask_interface_types.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_fast_decoder.h"
+
+#define S1AP_FAST_ENB_UE_S1AP_ID_MAX_BYTES 3
+#define S1AP_FAST_MME_UE_S1AP_ID_MAX_BYTES 4
+#define S1AP_FAST_PLMN_SIZE 3
+#define S1AP_FAST_TAC_SIZE 2
+#define S1AP_FAST_CELL_ID_SIZE 4
+#define S1AP_FAST_CELL_ID_BITS_UNUSED 4
+#define S1AP_FAST_RRC_CAUSE_ROOT_MAX 4 // mo-Data
+#define S1AP_FAST_CRITICALITY_MAX S1ap_Criticality_notify
+
+#define S1AP_FAST_IE_MME_UE_S1AP_ID (1 << 0)
+#define S1AP_FAST_IE_ENB_UE_S1AP_ID (1 << 1)
+#define S1AP_FAST_IE_NAS_PDU (1 << 2)
+#define S1AP_FAST_IE_TAI (1 << 3)
+#define S1AP_FAST_IE_EUTRAN_CGI (1 << 4)
+#define S1AP_FAST_IE_RRC_ESTABLISHMENT_CAUSE (1 << 5)
+
+#define S1AP_FAST_UPLINK_NAS_TRANSPORT_IES                                     \
+  (S1AP_FAST_IE_MME_UE_S1AP_ID | S1AP_FAST_IE_ENB_UE_S1AP_ID |                 \
+   S1AP_FAST_IE_NAS_PDU | S1AP_FAST_IE_TAI | S1AP_FAST_IE_EUTRAN_CGI)
+#define S1AP_FAST_INITIAL_UE_MESSAGE_IES                                       \
+  (S1AP_FAST_IE_ENB_UE_S1AP_ID | S1AP_FAST_IE_NAS_PDU | S1AP_FAST_IE_TAI |     \
+   S1AP_FAST_IE_EUTRAN_CGI | S1AP_FAST_IE_RRC_ESTABLISHMENT_CAUSE)
+
+typedef struct s1ap_aper_reader_s {
+  const uint8_t *buf;
+  uint32_t size; // in octets
+  uint32_t bit_pos;
+} s1ap_aper_reader_t;
+
+/* Fields of the IEs, all pointers are views into the received buffer */
+typedef struct s1ap_fast_ies_s {
+  uint32_t present;
+  uint32_t mme_ue_s1ap_id;
+  uint32_t enb_ue_s1ap_id;
+  const uint8_t *nas_pdu;
+  uint32_t nas_pdu_size;
+  const uint8_t *tai_plmn;
+  const uint8_t *tac;
+  const uint8_t *ecgi_plmn;
+  const uint8_t *cell_id;
+  uint32_t rrc_establishment_cause;
+} s1ap_fast_ies_t;
+
+//------------------------------------------------------------------------------
+static inline void s1ap_aper_reader_init(
+  s1ap_aper_reader_t *reader,
+  const uint8_t *buf,
+  uint32_t size)
+{
+  reader->buf = buf;
+  reader->size = size;
+  reader->bit_pos = 0;
+}
+
+//------------------------------------------------------------------------------
+static inline void s1ap_aper_align(s1ap_aper_reader_t *reader)
+{
+  reader->bit_pos = (reader->bit_pos + 7) & ~7U;
+}
+
+//------------------------------------------------------------------------------
+static inline bool s1ap_aper_get_bits(
+  s1ap_aper_reader_t *reader,
+  uint32_t nbits,
+  uint32_t *value)
+{
+  uint32_t v = 0;
+
+  if (reader->bit_pos + nbits > reader->size * 8) {
+    return false;
+  }
+  for (uint32_t i = 0; i < nbits; i++, reader->bit_pos++) {
+    v = (v << 1) |
+        ((reader->buf[reader->bit_pos >> 3] >> (7 - (reader->bit_pos & 7))) &
+         1);
+  }
+  *value = v;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static inline bool s1ap_aper_get_octets(
+  s1ap_aper_reader_t *reader,
+  uint32_t size,
+  const uint8_t **octets)
+{
+  s1ap_aper_align(reader);
+  if ((reader->bit_pos >> 3) + size > reader->size) {
+    return false;
+  }
+  *octets = &reader->buf[reader->bit_pos >> 3];
+  reader->bit_pos += size * 8;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool s1ap_aper_get_uint(
+  s1ap_aper_reader_t *reader,
+  uint32_t nbits,
+  uint32_t *value)
+{
+  const uint8_t *octets = NULL;
+  uint32_t v = 0;
+
+  if (!s1ap_aper_get_octets(reader, nbits / 8, &octets)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < nbits / 8; i++) {
+    v = (v << 8) | octets[i];
+  }
+  *value = v;
+  return true;
+}
+
+/*
+ * Length determinant of an unconstrained length (X.691 10.9.3.5-7), the
+ * fragmented form is left to asn1c.
+ */
+//------------------------------------------------------------------------------
+static bool s1ap_aper_get_length(s1ap_aper_reader_t *reader, uint32_t *length)
+{
+  uint32_t first = 0;
+  uint32_t second = 0;
+
+  if (!s1ap_aper_get_uint(reader, 8, &first)) {
+    return false;
+  }
+  if (!(first & 0x80)) {
+    *length = first;
+    return true;
+  }
+  if ((first & 0xc0) == 0x80) {
+    if (!s1ap_aper_get_uint(reader, 8, &second)) {
+      return false;
+    }
+    *length = ((first & 0x3f) << 8) | second;
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Constrained whole number with a range above 64K (X.691 10.5.7.4): octet
+ * count on 2 bits, then the octets aligned.
+ */
+//------------------------------------------------------------------------------
+static bool s1ap_aper_get_ue_s1ap_id(
+  s1ap_aper_reader_t *reader,
+  uint32_t max_bytes,
+  uint32_t *value)
+{
+  uint32_t nbytes = 0;
+
+  if (!s1ap_aper_get_bits(reader, 2, &nbytes)) {
+    return false;
+  }
+  nbytes += 1;
+  if (nbytes > max_bytes) {
+    return false;
+  }
+  return s1ap_aper_get_uint(reader, nbytes * 8, value);
+}
+
+/*
+ * Extension bit and iE-Extensions presence bit of TAI, EUTRAN-CGI, ...
+ * Only the root encoding without iE-Extensions is handled.
+ */
+//------------------------------------------------------------------------------
+static inline bool s1ap_aper_get_sequence_preamble(s1ap_aper_reader_t *reader)
+{
+  uint32_t bits = 0;
+
+  return s1ap_aper_get_bits(reader, 2, &bits) && (bits == 0);
+}
+
+//------------------------------------------------------------------------------
+static bool s1ap_fast_decode_ie(
+  uint32_t id,
+  s1ap_aper_reader_t *reader,
+  s1ap_fast_ies_t *ies)
+{
+  uint32_t flag = 0;
+  bool ok = false;
+
+  switch (id) {
+    case S1ap_ProtocolIE_ID_id_MME_UE_S1AP_ID:
+      flag = S1AP_FAST_IE_MME_UE_S1AP_ID;
+      ok = s1ap_aper_get_ue_s1ap_id(
+        reader, S1AP_FAST_MME_UE_S1AP_ID_MAX_BYTES, &ies->mme_ue_s1ap_id);
+      break;
+
+    case S1ap_ProtocolIE_ID_id_eNB_UE_S1AP_ID:
+      flag = S1AP_FAST_IE_ENB_UE_S1AP_ID;
+      ok = s1ap_aper_get_ue_s1ap_id(
+        reader, S1AP_FAST_ENB_UE_S1AP_ID_MAX_BYTES, &ies->enb_ue_s1ap_id);
+      break;
+
+    case S1ap_ProtocolIE_ID_id_NAS_PDU:
+      flag = S1AP_FAST_IE_NAS_PDU;
+      ok = s1ap_aper_get_length(reader, &ies->nas_pdu_size) &&
+           s1ap_aper_get_octets(reader, ies->nas_pdu_size, &ies->nas_pdu);
+      break;
+
+    case S1ap_ProtocolIE_ID_id_TAI:
+      flag = S1AP_FAST_IE_TAI;
+      ok = s1ap_aper_get_sequence_preamble(reader) &&
+           s1ap_aper_get_octets(reader, S1AP_FAST_PLMN_SIZE, &ies->tai_plmn) &&
+           s1ap_aper_get_octets(reader, S1AP_FAST_TAC_SIZE, &ies->tac);
+      break;
+
+    case S1ap_ProtocolIE_ID_id_EUTRAN_CGI:
+      flag = S1AP_FAST_IE_EUTRAN_CGI;
+      ok =
+        s1ap_aper_get_sequence_preamble(reader) &&
+        s1ap_aper_get_octets(reader, S1AP_FAST_PLMN_SIZE, &ies->ecgi_plmn) &&
+        s1ap_aper_get_octets(reader, S1AP_FAST_CELL_ID_SIZE, &ies->cell_id) &&
+        /* asn1c zeroes the unused bits, a view can't */
+        !(ies->cell_id[S1AP_FAST_CELL_ID_SIZE - 1] &
+          ((1 << S1AP_FAST_CELL_ID_BITS_UNUSED) - 1));
+      break;
+
+    case S1ap_ProtocolIE_ID_id_RRC_Establishment_Cause: {
+      uint32_t extension = 0;
+
+      flag = S1AP_FAST_IE_RRC_ESTABLISHMENT_CAUSE;
+      ok = s1ap_aper_get_bits(reader, 1, &extension) && !extension &&
+           s1ap_aper_get_bits(reader, 3, &ies->rrc_establishment_cause) &&
+           (ies->rrc_establishment_cause <= S1AP_FAST_RRC_CAUSE_ROOT_MAX);
+    } break;
+
+    default: return false;
+  }
+
+  if (!ok || (ies->present & flag)) {
+    return false;
+  }
+  ies->present |= flag;
+  return true;
+}
+
+/*
+ * ProtocolIE-Container of a message value (open type contents).
+ */
+//------------------------------------------------------------------------------
+static bool s1ap_fast_decode_ies(
+  const uint8_t *value,
+  uint32_t value_size,
+  s1ap_fast_ies_t *ies)
+{
+  s1ap_aper_reader_t reader;
+  uint32_t extension = 0;
+  uint32_t count = 0;
+
+  s1ap_aper_reader_init(&reader, value, value_size);
+  if (!s1ap_aper_get_bits(&reader, 1, &extension) || extension) {
+    return false;
+  }
+  if (!s1ap_aper_get_uint(&reader, 16, &count)) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    s1ap_aper_reader_t ie_reader;
+    const uint8_t *ie_value = NULL;
+    uint32_t id = 0;
+    uint32_t criticality = 0;
+    uint32_t ie_size = 0;
+
+    if (
+      !s1ap_aper_get_uint(&reader, 16, &id) ||
+      !s1ap_aper_get_bits(&reader, 2, &criticality) ||
+      (criticality > S1AP_FAST_CRITICALITY_MAX) ||
+      !s1ap_aper_get_length(&reader, &ie_size) ||
+      !s1ap_aper_get_octets(&reader, ie_size, &ie_value)) {
+      return false;
+    }
+    s1ap_aper_reader_init(&ie_reader, ie_value, ie_size);
+    if (!s1ap_fast_decode_ie(id, &ie_reader, ies)) {
+      return false;
+    }
+    // The open type must be exactly the padded IE encoding
+    s1ap_aper_align(&ie_reader);
+    if (ie_reader.bit_pos != ie_size * 8) {
+      return false;
+    }
+  }
+  s1ap_aper_align(&reader);
+  return reader.bit_pos == value_size * 8;
+}
+
+//------------------------------------------------------------------------------
+static inline void s1ap_fast_octet_string_view(
+  OCTET_STRING_t *octet_string,
+  const uint8_t *buf,
+  uint32_t size)
+{
+  octet_string->buf = (uint8_t *) buf;
+  octet_string->size = size;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_fast_tai_view(S1ap_TAI_t *tai, const s1ap_fast_ies_t *ies)
+{
+  s1ap_fast_octet_string_view(
+    &tai->pLMNidentity, ies->tai_plmn, S1AP_FAST_PLMN_SIZE);
+  s1ap_fast_octet_string_view(&tai->tAC, ies->tac, S1AP_FAST_TAC_SIZE);
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_fast_ecgi_view(
+  S1ap_EUTRAN_CGI_t *ecgi,
+  const s1ap_fast_ies_t *ies)
+{
+  s1ap_fast_octet_string_view(
+    &ecgi->pLMNidentity, ies->ecgi_plmn, S1AP_FAST_PLMN_SIZE);
+  ecgi->cell_ID.buf = (uint8_t *) ies->cell_id;
+  ecgi->cell_ID.size = S1AP_FAST_CELL_ID_SIZE;
+  ecgi->cell_ID.bits_unused = S1AP_FAST_CELL_ID_BITS_UNUSED;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_fast_decode_pdu(
+  s1ap_message *message,
+  const_bstring const raw,
+  MessagesIds *message_id)
+{
+  s1ap_aper_reader_t reader;
+  s1ap_fast_ies_t ies = {0};
+  const uint8_t *value = NULL;
+  uint32_t choice = 0;
+  uint32_t procedure_code = 0;
+  uint32_t criticality = 0;
+  uint32_t value_size = 0;
+
+  s1ap_aper_reader_init(&reader, (const uint8_t *) bdata(raw), blength(raw));
+
+  /*
+   * S1AP-PDU: extension bit and choice index, then InitiatingMessage
+   */
+  if (
+    !s1ap_aper_get_bits(&reader, 3, &choice) ||
+    (choice != S1AP_PDU_PR_initiatingMessage - 1) ||
+    !s1ap_aper_get_uint(&reader, 8, &procedure_code)) {
+    return RETURNerror;
+  }
+  if (
+    (procedure_code != S1ap_ProcedureCode_id_uplinkNASTransport) &&
+    (procedure_code != S1ap_ProcedureCode_id_initialUEMessage)) {
+    return RETURNerror;
+  }
+  if (
+    !s1ap_aper_get_bits(&reader, 2, &criticality) ||
+    (criticality > S1AP_FAST_CRITICALITY_MAX) ||
+    !s1ap_aper_get_length(&reader, &value_size) ||
+    !s1ap_aper_get_octets(&reader, value_size, &value) ||
+    (reader.bit_pos != reader.size * 8)) {
+    return RETURNerror;
+  }
+  if (!s1ap_fast_decode_ies(value, value_size, &ies)) {
+    return RETURNerror;
+  }
+
+  if (procedure_code == S1ap_ProcedureCode_id_uplinkNASTransport) {
+    S1ap_UplinkNASTransportIEs_t *uplink_nas_transport =
+      &message->msg.s1ap_UplinkNASTransportIEs;
+
+    if (ies.present != S1AP_FAST_UPLINK_NAS_TRANSPORT_IES) {
+      return RETURNerror;
+    }
+    memset(uplink_nas_transport, 0, sizeof(*uplink_nas_transport));
+    uplink_nas_transport->mme_ue_s1ap_id = ies.mme_ue_s1ap_id;
+    uplink_nas_transport->eNB_UE_S1AP_ID = ies.enb_ue_s1ap_id;
+    s1ap_fast_octet_string_view(
+      &uplink_nas_transport->nas_pdu, ies.nas_pdu, ies.nas_pdu_size);
+    s1ap_fast_ecgi_view(&uplink_nas_transport->eutran_cgi, &ies);
+    s1ap_fast_tai_view(&uplink_nas_transport->tai, &ies);
+    *message_id = S1AP_UPLINK_NAS_LOG;
+  } else {
+    S1ap_InitialUEMessageIEs_t *initial_ue_message =
+      &message->msg.s1ap_InitialUEMessageIEs;
+
+    if (ies.present != S1AP_FAST_INITIAL_UE_MESSAGE_IES) {
+      return RETURNerror;
+    }
+    memset(initial_ue_message, 0, sizeof(*initial_ue_message));
+    initial_ue_message->eNB_UE_S1AP_ID = ies.enb_ue_s1ap_id;
+    s1ap_fast_octet_string_view(
+      &initial_ue_message->nas_pdu, ies.nas_pdu, ies.nas_pdu_size);
+    s1ap_fast_tai_view(&initial_ue_message->tai, &ies);
+    s1ap_fast_ecgi_view(&initial_ue_message->eutran_cgi, &ies);
+    initial_ue_message->rrC_Establishment_Cause = ies.rrc_establishment_cause;
+    *message_id = S1AP_INITIAL_UE_MESSAGE_LOG;
+  }
+
+  message->procedureCode = procedure_code;
+  message->criticality = criticality;
+  message->direction = S1AP_PDU_PR_initiatingMessage;
+  message->fast_decoded = true;
+  return RETURNok;
+}
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_fast_decoder.h
+  \brief Hand written APER decoder for the UE associated NAS transport
+  messages (Initial UE Message, Uplink NAS Transport).
+
+  Only the mandatory IEs are decoded. The NAS-PDU, PLMN, TAC and cell
+  identity are views into the received buffer, nothing is allocated: the
+  buffer must outlive the decoded message, and the message must not be given
+  to the asn1c free functions (fast_decoded is set).
+  Any PDU the fast path is not sure about (other procedure, optional or
+  unknown IE, extension, fragmented length...) is left to asn1c.
+*/
+
+#ifndef FILE_S1AP_MME_FAST_DECODER_SEEN
+#define FILE_S1AP_MME_FAST_DECODER_SEEN
+
+#include "bstrlib.h"
+#include "intertask_interface_types.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+
+/*
+ * Returns RETURNok when the PDU has been decoded in message, RETURNerror when
+ * it has to be decoded by asn1c.
+ */
+int s1ap_mme_fast_decode_pdu(
+  s1ap_message *message,
+  const_bstring const raw,
+  MessagesIds *message_id) __attribute__((warn_unused_result));
+
+#endif /* FILE_S1AP_MME_FAST_DECODER_SEEN */
@@ -0,0 +1,327 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_fast_encoder.c
+  \brief Template based APER encoder, see s1ap_mme_fast_encoder.h.
+  The encodings follow X.691 (ALIGNED variant) for the S1AP r10.5 grammar,
+  the same way the asn1c runtime produces them.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bstrlib.h"
+
+#include "assertions.h"
+#include "common_defs.h"
+#include "s1ap_common.h"
+#include "s1ap_mme_fast_encoder.h"
+
+#define S1AP_FAST_ENB_UE_S1AP_ID_MAX 0x00ffffff
+// Above, asn1c uses the fragmented length form
+#define S1AP_FAST_LENGTH_MAX 16383
+#define S1AP_FAST_CRITICALITY(cRiT) ((uint8_t)((cRiT) << 6))
+#define S1AP_FAST_CAUSE_CHOICE_BITS 3
+#define S1AP_FAST_PDU_HEADER_SIZE 3
+#define S1AP_FAST_IE_HEADER_SIZE 3
+
+#define S1AP_FAST_IE_HEADER(iD, cRiT)                                          \
+  {                                                                            \
+    (uint8_t)((iD) >> 8), (uint8_t)((iD) &0xff), S1AP_FAST_CRITICALITY(cRiT)   \
+  }
+
+/*
+ * Precomputed parts of the PDUs: S1AP-PDU choice (initiatingMessage, no
+ * extension) with the procedure code and criticality, then the IE id and
+ * criticality of every IE, in the order asn1c encodes them.
+ */
+static const uint8_t
+  s1ap_fast_downlink_nas_transport_pdu[S1AP_FAST_PDU_HEADER_SIZE] = {
+  0x00,
+  S1ap_ProcedureCode_id_downlinkNASTransport,
+  S1AP_FAST_CRITICALITY(S1ap_Criticality_ignore)};
+static const uint8_t
+  s1ap_fast_ue_context_release_command_pdu[S1AP_FAST_PDU_HEADER_SIZE] = {
+  0x00,
+  S1ap_ProcedureCode_id_UEContextRelease,
+  S1AP_FAST_CRITICALITY(S1ap_Criticality_reject)};
+
+static const uint8_t s1ap_fast_mme_ue_s1ap_id_ie[S1AP_FAST_IE_HEADER_SIZE] =
+  S1AP_FAST_IE_HEADER(
+    S1ap_ProtocolIE_ID_id_MME_UE_S1AP_ID,
+    S1ap_Criticality_reject);
+static const uint8_t s1ap_fast_enb_ue_s1ap_id_ie[S1AP_FAST_IE_HEADER_SIZE] =
+  S1AP_FAST_IE_HEADER(
+    S1ap_ProtocolIE_ID_id_eNB_UE_S1AP_ID,
+    S1ap_Criticality_reject);
+static const uint8_t s1ap_fast_nas_pdu_ie[S1AP_FAST_IE_HEADER_SIZE] =
+  S1AP_FAST_IE_HEADER(S1ap_ProtocolIE_ID_id_NAS_PDU, S1ap_Criticality_reject);
+static const uint8_t s1ap_fast_ue_s1ap_ids_ie[S1AP_FAST_IE_HEADER_SIZE] =
+  S1AP_FAST_IE_HEADER(
+    S1ap_ProtocolIE_ID_id_UE_S1AP_IDs,
+    S1ap_Criticality_reject);
+static const uint8_t s1ap_fast_cause_ie[S1AP_FAST_IE_HEADER_SIZE] =
+  S1AP_FAST_IE_HEADER(S1ap_ProtocolIE_ID_id_Cause, S1ap_Criticality_ignore);
+
+/* Number of values in the extension root of every Cause alternative */
+static const long s1ap_fast_cause_root_size[] = {
+  [S1ap_Cause_PR_radioNetwork] =
+    S1ap_CauseRadioNetwork_x2_handover_triggered + 1,
+  [S1ap_Cause_PR_transport] = S1ap_CauseTransport_unspecified + 1,
+  [S1ap_Cause_PR_nas] = S1ap_CauseNas_unspecified + 1,
+  [S1ap_Cause_PR_protocol] = S1ap_CauseProtocol_unspecified + 1,
+  [S1ap_Cause_PR_misc] = S1ap_CauseMisc_unknown_PLMN + 1,
+};
+
+//------------------------------------------------------------------------------
+static inline uint32_t s1ap_fast_length_size(const uint32_t length)
+{
+  return (length < 128) ? 1 : 2;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t s1ap_fast_ie_size(const uint32_t value_size)
+{
+  return S1AP_FAST_IE_HEADER_SIZE + s1ap_fast_length_size(value_size) +
+         value_size;
+}
+
+/*
+ * Octets of a constrained whole number with a range above 64K (X.691
+ * 10.5.7.4): the minimum needed, at least one.
+ */
+//------------------------------------------------------------------------------
+static inline uint32_t s1ap_fast_id_octets(const uint32_t id)
+{
+  if (id < 0x100) return 1;
+  if (id < 0x10000) return 2;
+  if (id < 0x1000000) return 3;
+  return 4;
+}
+
+//------------------------------------------------------------------------------
+static inline uint8_t *s1ap_fast_put(
+  uint8_t *p,
+  const uint8_t *const template,
+  const uint32_t size)
+{
+  memcpy(p, template, size);
+  return p + size;
+}
+
+/*
+ * Unconstrained length determinant, short and long forms (X.691 10.9.3.6-7)
+ */
+//------------------------------------------------------------------------------
+static inline uint8_t *s1ap_fast_put_length(uint8_t *p, const uint32_t length)
+{
+  if (length < 128) {
+    *p++ = (uint8_t) length;
+  } else {
+    *p++ = (uint8_t)(0x80 | (length >> 8));
+    *p++ = (uint8_t)(length & 0xff);
+  }
+  return p;
+}
+
+/*
+ * UE S1AP id preceded by lead_bits zero bits (extension and presence bits of
+ * the enclosing types): octet count on 2 bits, then the octets aligned.
+ */
+//------------------------------------------------------------------------------
+static inline uint8_t *s1ap_fast_put_ue_s1ap_id(
+  uint8_t *p,
+  const uint32_t lead_bits,
+  const uint32_t id)
+{
+  const uint32_t octets = s1ap_fast_id_octets(id);
+
+  *p++ = (uint8_t)((octets - 1) << (6 - lead_bits));
+  for (uint32_t i = octets; i > 0; i--) {
+    *p++ = (uint8_t)(id >> (8 * (i - 1)));
+  }
+  return p;
+}
+
+/*
+ * Start of a PDU with an IE container of nb_ies IEs
+ */
+//------------------------------------------------------------------------------
+static inline uint8_t *s1ap_fast_put_pdu_header(
+  uint8_t *p,
+  const uint8_t *const template,
+  const uint32_t value_size,
+  const uint16_t nb_ies)
+{
+  p = s1ap_fast_put(p, template, S1AP_FAST_PDU_HEADER_SIZE);
+  p = s1ap_fast_put_length(p, value_size);
+  *p++ = 0x00; // no extension
+  *p++ = (uint8_t)(nb_ies >> 8);
+  *p++ = (uint8_t)(nb_ies & 0xff);
+  return p;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t s1ap_fast_pdu_size(const uint32_t value_size)
+{
+  return S1AP_FAST_PDU_HEADER_SIZE +
+         s1ap_fast_length_size(value_size) + value_size;
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_fast_alloc(const uint32_t size, bstring *pdu, uint8_t **p)
+{
+  *pdu = bfromcstralloc(size, "");
+  if (!*pdu) {
+    return RETURNerror;
+  }
+  *p = (*pdu)->data;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_fast_encode_downlink_nas_transport(
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  const enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const_bstring const nas_pdu,
+  bstring *pdu)
+{
+  const uint32_t nas_pdu_size = blength(nas_pdu);
+  uint32_t mme_ue_s1ap_id_size = 0;
+  uint32_t enb_ue_s1ap_id_size = 0;
+  uint32_t nas_pdu_ie_size = 0;
+  uint32_t value_size = 0;
+  uint32_t size = 0;
+  uint8_t *p = NULL;
+
+  if (
+    (enb_ue_s1ap_id > S1AP_FAST_ENB_UE_S1AP_ID_MAX) ||
+    (nas_pdu_size > S1AP_FAST_LENGTH_MAX)) {
+    return RETURNerror;
+  }
+  mme_ue_s1ap_id_size = 1 + s1ap_fast_id_octets(mme_ue_s1ap_id);
+  enb_ue_s1ap_id_size = 1 + s1ap_fast_id_octets(enb_ue_s1ap_id);
+  nas_pdu_ie_size = s1ap_fast_length_size(nas_pdu_size) + nas_pdu_size;
+  if (nas_pdu_ie_size > S1AP_FAST_LENGTH_MAX) {
+    return RETURNerror;
+  }
+  value_size = 3 + s1ap_fast_ie_size(mme_ue_s1ap_id_size) +
+               s1ap_fast_ie_size(enb_ue_s1ap_id_size) +
+               s1ap_fast_ie_size(nas_pdu_ie_size);
+  if (value_size > S1AP_FAST_LENGTH_MAX) {
+    return RETURNerror;
+  }
+  size = s1ap_fast_pdu_size(value_size);
+  if (s1ap_fast_alloc(size, pdu, &p) != RETURNok) {
+    return RETURNerror;
+  }
+
+  p = s1ap_fast_put_pdu_header(
+    p, s1ap_fast_downlink_nas_transport_pdu, value_size, 3);
+  p = s1ap_fast_put(
+    p, s1ap_fast_mme_ue_s1ap_id_ie, S1AP_FAST_IE_HEADER_SIZE);
+  p = s1ap_fast_put_length(p, mme_ue_s1ap_id_size);
+  p = s1ap_fast_put_ue_s1ap_id(p, 0, mme_ue_s1ap_id);
+  p = s1ap_fast_put(
+    p, s1ap_fast_enb_ue_s1ap_id_ie, S1AP_FAST_IE_HEADER_SIZE);
+  p = s1ap_fast_put_length(p, enb_ue_s1ap_id_size);
+  p = s1ap_fast_put_ue_s1ap_id(p, 0, enb_ue_s1ap_id);
+  p = s1ap_fast_put(p, s1ap_fast_nas_pdu_ie, S1AP_FAST_IE_HEADER_SIZE);
+  p = s1ap_fast_put_length(p, nas_pdu_ie_size);
+  p = s1ap_fast_put_length(p, nas_pdu_size);
+  if (nas_pdu_size) {
+    p = s1ap_fast_put(p, nas_pdu->data, nas_pdu_size);
+  }
+
+  (*pdu)->slen = p - (*pdu)->data;
+  DevAssert((*pdu)->slen == size);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_fast_encode_ue_context_release_command(
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  const enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const S1ap_Cause_PR cause_type,
+  const long cause_value,
+  bstring *pdu)
+{
+  uint32_t ue_s1ap_ids_size = 0;
+  uint32_t cause_bits = 0;
+  uint32_t cause_value_bits = 0;
+  uint32_t cause_size = 0;
+  uint16_t cause = 0;
+  uint32_t value_size = 0;
+  uint32_t size = 0;
+  uint8_t *p = NULL;
+
+  if (
+    (enb_ue_s1ap_id > S1AP_FAST_ENB_UE_S1AP_ID_MAX) ||
+    (cause_type <= S1ap_Cause_PR_NOTHING) ||
+    (cause_type > S1ap_Cause_PR_misc) || (cause_value < 0) ||
+    (cause_value >= s1ap_fast_cause_root_size[cause_type])) {
+    return RETURNerror;
+  }
+  /*
+   * Cause: extension bit, choice index, extension bit, enumerated value on
+   * the bits needed by the extension root
+   */
+  while ((1L << cause_value_bits) < s1ap_fast_cause_root_size[cause_type]) {
+    cause_value_bits++;
+  }
+  cause_bits = 1 + S1AP_FAST_CAUSE_CHOICE_BITS + 1 + cause_value_bits;
+  cause_size = (cause_bits + 7) / 8;
+  cause = (uint16_t)(
+    ((((uint32_t)(cause_type - 1)) << (cause_value_bits + 1)) |
+     (uint32_t) cause_value)
+    << (16 - cause_bits));
+
+  /*
+   * UE-S1AP-IDs: extension bit and choice index of uE-S1AP-ID-pair,
+   * extension and iE-Extensions presence bits of the pair, then the ids
+   */
+  ue_s1ap_ids_size = 1 + s1ap_fast_id_octets(mme_ue_s1ap_id) + 1 +
+                     s1ap_fast_id_octets(enb_ue_s1ap_id);
+  value_size = 3 + s1ap_fast_ie_size(ue_s1ap_ids_size) +
+               s1ap_fast_ie_size(cause_size);
+  size = s1ap_fast_pdu_size(value_size);
+  if (s1ap_fast_alloc(size, pdu, &p) != RETURNok) {
+    return RETURNerror;
+  }
+
+  p = s1ap_fast_put_pdu_header(
+    p, s1ap_fast_ue_context_release_command_pdu, value_size, 2);
+  p = s1ap_fast_put(
+    p, s1ap_fast_ue_s1ap_ids_ie, S1AP_FAST_IE_HEADER_SIZE);
+  p = s1ap_fast_put_length(p, ue_s1ap_ids_size);
+  p = s1ap_fast_put_ue_s1ap_id(p, 4, mme_ue_s1ap_id);
+  p = s1ap_fast_put_ue_s1ap_id(p, 0, enb_ue_s1ap_id);
+  p = s1ap_fast_put(p, s1ap_fast_cause_ie, S1AP_FAST_IE_HEADER_SIZE);
+  p = s1ap_fast_put_length(p, cause_size);
+  *p++ = (uint8_t)(cause >> 8);
+  if (cause_size > 1) {
+    *p++ = (uint8_t)(cause & 0xff);
+  }
+
+  (*pdu)->slen = p - (*pdu)->data;
+  DevAssert((*pdu)->slen == size);
+  return RETURNok;
+}
@@ -0,0 +1,57 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_fast_encoder.h
+  \brief Template based APER encoder for the most frequent UE associated
+  downlink messages (Downlink NAS Transport, UE Context Release Command).
+
+  The PDUs are written directly into a bstring sized from the IEs, that is
+  handed as is to SCTP: no asn1c structure, no intermediate encode buffer.
+  The encoded octets are identical to the asn1c ones. Anything out of the
+  template (optional IE, extension value, NAS-PDU needing a fragmented
+  length...) is left to s1ap_mme_encode_pdu.
+*/
+
+#ifndef FILE_S1AP_MME_FAST_ENCODER_SEEN
+#define FILE_S1AP_MME_FAST_ENCODER_SEEN
+
+#include "bstrlib.h"
+#include "3gpp_36.401.h"
+#include "s1ap_common.h"
+
+/*
+ * Returns RETURNok with the PDU in *pdu (to be released with
+ * bdestroy), RETURNerror when the PDU has to be encoded by asn1c.
+ */
+int s1ap_mme_fast_encode_downlink_nas_transport(
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  const enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const_bstring const nas_pdu,
+  bstring *pdu) __attribute__((warn_unused_result));
+
+int s1ap_mme_fast_encode_ue_context_release_command(
+  const mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  const enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const S1ap_Cause_PR cause_type,
+  const long cause_value,
+  bstring *pdu) __attribute__((warn_unused_result));
+
+#endif /* FILE_S1AP_MME_FAST_ENCODER_SEEN */
@@ -44,9 +44,11 @@
 #include "timer.h"
 #include "dynamic_memory_check.h"
 #include "mme_config.h"
+#include "mme_config_snapshot.h"
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_encoder.h"
+#include "s1ap_mme_fast_encoder.h"
 #include "s1ap_mme_nas_procedures.h"
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
@@ -281,6 +283,7 @@ int s1ap_mme_handle_s1_setup_request(
   char *enb_name = NULL;
   int ta_ret = 0;
   uint16_t max_enb_connected = 0;
+  const mme_config_snapshot_t *config = NULL;
 
   OAILOG_FUNC_IN(LOG_S1AP);
   increment_counter("s1_setup", 1, NO_LABELS);
@@ -420,11 +423,11 @@ int s1ap_mme_handle_s1_setup_request(
 
   OAILOG_MESSAGE_FINISH((void *) context);
 
-  mme_config_read_lock(&mme_config);
-  max_enb_connected = mme_config.max_enbs;
-  mme_config_unlock(&mme_config);
+  config = mme_config_snapshot_get();
+  max_enb_connected = config->max_enbs;
+  mme_config_snapshot_put(config);
 
-  if (nb_enb_associated == max_enb_connected) {
+  if (nb_enb_associated >= max_enb_connected) {
     OAILOG_ERROR(
       LOG_S1AP,
       "There is too much eNB connected to MME, rejecting the association\n");
@@ -499,7 +502,8 @@ int s1ap_mme_handle_s1_setup_request(
 //------------------------------------------------------------------------------
 static int s1ap_generate_s1_setup_response(enb_description_t *enb_association)
 {
-  int i, j;
+  const mme_config_snapshot_t *config = NULL;
+  int i;
   int enc_rval = 0;
   S1ap_S1SetupResponseIEs_t *s1_setup_response_p = NULL;
   S1ap_ServedGUMMEIsItem_t *servedGUMMEI = NULL;
@@ -514,53 +518,34 @@ static int s1ap_generate_s1_setup_response(enb_description_t *enb_association)
   servedGUMMEI = calloc(1, sizeof *servedGUMMEI);
   // Generating response
   s1_setup_response_p = &message.msg.s1ap_S1SetupResponseIEs;
-  mme_config_read_lock(&mme_config);
-  s1_setup_response_p->relativeMMECapacity = mme_config.relative_capacity;
+  config = mme_config_snapshot_get();
+  s1_setup_response_p->relativeMMECapacity = config->relative_capacity;
 
   /*
    * Use the gummei parameters provided by configuration
    * that should be sorted
    */
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    bool plmn_added = false;
-    for (j = 0; j < i; j++) {
-      if (
-        (mme_config.served_tai.plmn_mcc[j] ==
-         mme_config.served_tai.plmn_mcc[i]) &&
-        (mme_config.served_tai.plmn_mnc[j] ==
-         mme_config.served_tai.plmn_mnc[i]) &&
-        (mme_config.served_tai.plmn_mnc_len[j] ==
-         mme_config.served_tai.plmn_mnc_len[i])) {
-        plmn_added = true;
-        break;
-      }
-    }
-    if (false == plmn_added) {
-      S1ap_PLMNidentity_t *plmn = NULL;
-      plmn = calloc(1, sizeof(*plmn));
-      MCC_MNC_TO_PLMNID(
-        mme_config.served_tai.plmn_mcc[i],
-        mme_config.served_tai.plmn_mnc[i],
-        mme_config.served_tai.plmn_mnc_len[i],
-        plmn);
-      ASN_SEQUENCE_ADD(&servedGUMMEI->servedPLMNs.list, plmn);
-    }
+  for (i = 0; i < config->nb_served_plmn; i++) {
+    S1ap_PLMNidentity_t *plmn = NULL;
+    plmn = calloc(1, sizeof(*plmn));
+    OCTET_STRING_fromBuf(plmn, (const char *) config->served_plmn[i].tbcd, 3);
+    ASN_SEQUENCE_ADD(&servedGUMMEI->servedPLMNs.list, plmn);
   }
 
-  for (i = 0; i < mme_config.gummei.nb; i++) {
+  for (i = 0; i < config->gummei.nb; i++) {
     S1ap_MME_Group_ID_t *mme_gid = NULL;
     S1ap_MME_Code_t *mmec = NULL;
 
     mme_gid = calloc(1, sizeof(*mme_gid));
-    INT16_TO_OCTET_STRING(mme_config.gummei.gummei[i].mme_gid, mme_gid);
+    INT16_TO_OCTET_STRING(config->gummei.gummei[i].mme_gid, mme_gid);
     ASN_SEQUENCE_ADD(&servedGUMMEI->servedGroupIDs.list, mme_gid);
 
     mmec = calloc(1, sizeof(*mmec));
-    INT8_TO_OCTET_STRING(mme_config.gummei.gummei[i].mme_code, mmec);
+    INT8_TO_OCTET_STRING(config->gummei.gummei[i].mme_code, mmec);
     ASN_SEQUENCE_ADD(&servedGUMMEI->servedMMECs.list, mmec);
   }
+  mme_config_snapshot_put(config);
 
-  mme_config_unlock(&mme_config);
   /*
    * The MME is only serving E-UTRAN RAT, so the list contains only one element
    */
@@ -993,6 +978,7 @@ static int s1ap_mme_generate_ue_context_release_command(
   uint32_t length = 0;
   s1ap_message message = {0};
   S1ap_UEContextReleaseCommandIEs_t *ueContextReleaseCommandIEs_p = NULL;
+  bstring b = NULL;
   int rc = RETURNok;
   S1ap_Cause_PR cause_type;
   long cause_value;
@@ -1045,18 +1031,30 @@ static int s1ap_mme_generate_ue_context_release_command(
       break;
     default: AssertFatal(false, "Unknown cause for context release"); break;
   }
-  s1ap_mme_set_cause(
-    &ueContextReleaseCommandIEs_p->cause, cause_type, cause_value);
 
-  if (s1ap_mme_encode_pdu(&message, &buffer, &length) < 0) {
-    MSC_LOG_EVENT(
-      MSC_S1AP_MME,
-      "0 UEContextRelease/initiatingMessage enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT
-      " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " encoding failed",
+  if (
+    s1ap_mme_fast_encode_ue_context_release_command(
+      ue_ref_p->mme_ue_s1ap_id,
       ue_ref_p->enb_ue_s1ap_id,
-      ue_ref_p->mme_ue_s1ap_id);
-    free_s1ap_uecontextreleasecommand(ueContextReleaseCommandIEs_p);
-    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+      cause_type,
+      cause_value,
+      &b) != RETURNok) {
+    s1ap_mme_set_cause(
+      &ueContextReleaseCommandIEs_p->cause, cause_type, cause_value);
+
+    if (s1ap_mme_encode_pdu(&message, &buffer, &length) < 0) {
+      MSC_LOG_EVENT(
+        MSC_S1AP_MME,
+        "0 UEContextRelease/initiatingMessage enb_ue_s1ap_id "
+        ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT
+        " encoding failed",
+        ue_ref_p->enb_ue_s1ap_id,
+        ue_ref_p->mme_ue_s1ap_id);
+      free_s1ap_uecontextreleasecommand(ueContextReleaseCommandIEs_p);
+      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+    }
+    b = blk2bstr(buffer, length);
+    free(buffer);
   }
 
   MSC_LOG_TX_MESSAGE(
@@ -1069,8 +1067,6 @@ static int s1ap_mme_generate_ue_context_release_command(
     ue_ref_p->enb_ue_s1ap_id,
     ue_ref_p->mme_ue_s1ap_id);
 
-  bstring b = blk2bstr(buffer, length);
-  free(buffer);
   rc = s1ap_mme_itti_send_sctp_request(
     &b,
     ue_ref_p->enb->sctp_assoc_id,
@@ -2666,23 +2662,22 @@ int s1ap_handle_paging_request(const itti_s1ap_paging_request_t *paging_request)
       paging_request->imsi_length,
       &paging_message->uePagingID.choice.iMSI);
   }
-  // Set TAI list
-  mme_config_read_lock(&mme_config);
+  // Set TAI list, from the TAIs encoded once per configuration
+  const mme_config_snapshot_t *config = mme_config_snapshot_get();
 
-  for (int i = 0; i < mme_config.served_tai.nb_tai; i++) {
+  for (int i = 0; i < config->served_tai.nb_tai; i++) {
     S1ap_TAIItem_t *tai_item = calloc(1, sizeof(S1ap_TAIItem_t));
-    MCC_MNC_TO_PLMNID(
-      mme_config.served_tai.plmn_mcc[i],
-      mme_config.served_tai.plmn_mnc[i],
-      mme_config.served_tai.plmn_mnc_len[i],
-      &tai_item->tAI.pLMNidentity);
-    TAC_TO_ASN1(mme_config.served_tai.tac[i], &tai_item->tAI.tAC);
+    OCTET_STRING_fromBuf(
+      &tai_item->tAI.pLMNidentity,
+      (const char *) config->encoded_tai[i].plmn,
+      3);
+    OCTET_STRING_fromBuf(
+      &tai_item->tAI.tAC, (const char *) config->encoded_tai[i].tac, 2);
     tai_item->iE_Extensions = NULL;
     tai_item->tAI.iE_Extensions = NULL;
     ASN_SEQUENCE_ADD(&paging_message->taiList, tai_item);
   }
-
-  mme_config_unlock(&mme_config);
+  mme_config_snapshot_put(config);
 
   uint8_t *buffer = NULL;
   uint32_t length = 0;
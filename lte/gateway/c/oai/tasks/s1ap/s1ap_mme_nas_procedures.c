@@ -43,6 +43,7 @@
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_encoder.h"
+#include "s1ap_mme_fast_encoder.h"
 #include "s1ap_mme.h"
 #include "s1ap_mme_handlers.h"
 #include "s1ap_mme_nas_procedures.h"
@@ -464,35 +465,46 @@ int s1ap_generate_downlink_nas_transport(
       ue_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
-    /*
-     * We have fount the UE in the list.
-     * * * * Create new IE list message and encode it.
-     */
-    S1ap_DownlinkNASTransportIEs_t *downlinkNasTransport = NULL;
-    s1ap_message message = {0};
+    bstring b = NULL;
 
-    message.procedureCode = S1ap_ProcedureCode_id_downlinkNASTransport;
-    message.direction = S1AP_PDU_PR_initiatingMessage;
     ue_ref->s1_ue_state = S1AP_UE_CONNECTED;
-    downlinkNasTransport = &message.msg.s1ap_DownlinkNASTransportIEs;
     /*
-     * Setting UE informations with the ones fount in ue_ref
+     * Write the PDU straight into a send buffer, asn1c is only needed for
+     * what the template does not cover.
      */
-    downlinkNasTransport->mme_ue_s1ap_id = ue_ref->mme_ue_s1ap_id;
-    downlinkNasTransport->eNB_UE_S1AP_ID = ue_ref->enb_ue_s1ap_id;
-    /*eNB
-     * Fill in the NAS pdu
-     */
-    OCTET_STRING_fromBuf(
-      &downlinkNasTransport->nas_pdu,
-      (char *) bdata(*payload),
-      blength(*payload));
-    bdestroy_wrapper(payload);
-
-    if (s1ap_mme_encode_pdu(&message, &buffer_p, &length) < 0) {
+    if (
+      s1ap_mme_fast_encode_downlink_nas_transport(
+        ue_ref->mme_ue_s1ap_id, ue_ref->enb_ue_s1ap_id, *payload, &b) !=
+      RETURNok) {
+      S1ap_DownlinkNASTransportIEs_t *downlinkNasTransport = NULL;
+      s1ap_message message = {0};
+
+      message.procedureCode = S1ap_ProcedureCode_id_downlinkNASTransport;
+      message.direction = S1AP_PDU_PR_initiatingMessage;
+      downlinkNasTransport = &message.msg.s1ap_DownlinkNASTransportIEs;
+      /*
+       * Setting UE informations with the ones fount in ue_ref
+       */
+      downlinkNasTransport->mme_ue_s1ap_id = ue_ref->mme_ue_s1ap_id;
+      downlinkNasTransport->eNB_UE_S1AP_ID = ue_ref->enb_ue_s1ap_id;
+      /*eNB
+       * Fill in the NAS pdu
+       */
+      OCTET_STRING_fromBuf(
+        &downlinkNasTransport->nas_pdu,
+        (char *) bdata(*payload),
+        blength(*payload));
+      bdestroy_wrapper(payload);
+
+      if (s1ap_mme_encode_pdu(&message, &buffer_p, &length) < 0) {
+        free_s1ap_downlinknastransport(downlinkNasTransport);
+        OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+      }
+      b = blk2bstr(buffer_p, length);
+      free(buffer_p);
       free_s1ap_downlinknastransport(downlinkNasTransport);
-      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
     }
+    bdestroy_wrapper(payload);
 
     OAILOG_NOTICE(
       LOG_S1AP,
@@ -500,8 +512,8 @@ int s1ap_generate_downlink_nas_transport(
       " MME_UE_S1AP_ID = " MME_UE_S1AP_ID_FMT
       " eNB_UE_S1AP_ID = " ENB_UE_S1AP_ID_FMT "\n",
       ue_id,
-      (mme_ue_s1ap_id_t) downlinkNasTransport->mme_ue_s1ap_id,
-      (enb_ue_s1ap_id_t) downlinkNasTransport->eNB_UE_S1AP_ID);
+      ue_ref->mme_ue_s1ap_id,
+      ue_ref->enb_ue_s1ap_id);
     MSC_LOG_TX_MESSAGE(
       MSC_S1AP_MME,
       MSC_S1AP_ENB,
@@ -511,17 +523,14 @@ int s1ap_generate_downlink_nas_transport(
       " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " enb_ue_s1ap_id" ENB_UE_S1AP_ID_FMT
       " nas length %u",
       ue_id,
-      (mme_ue_s1ap_id_t) downlinkNasTransport->mme_ue_s1ap_id,
-      (enb_ue_s1ap_id_t) downlinkNasTransport->eNB_UE_S1AP_ID,
-      length);
-    bstring b = blk2bstr(buffer_p, length);
-    free(buffer_p);
+      ue_ref->mme_ue_s1ap_id,
+      ue_ref->enb_ue_s1ap_id,
+      blength(b));
     s1ap_mme_itti_send_sctp_request(
       &b,
       ue_ref->enb->sctp_assoc_id,
       ue_ref->sctp_stream_send,
       ue_ref->mme_ue_s1ap_id);
-    free_s1ap_downlinknastransport(downlinkNasTransport);
   }
 
   OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
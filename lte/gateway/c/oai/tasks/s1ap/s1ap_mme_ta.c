@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <pthread.h>
 
 #include "bstrlib.h"
@@ -38,43 +39,37 @@
 #include "assertions.h"
 #include "conversions.h"
 #include "mme_config.h"
+#include "mme_config_snapshot.h"
 #include "s1ap_common.h"
 #include "s1ap_mme_ta.h"
 
 static int s1ap_mme_compare_plmn(const S1ap_PLMNidentity_t *const plmn)
 {
-  int i = 0;
-  uint16_t mcc = 0;
-  uint16_t mnc = 0;
-  uint16_t mnc_len = 0;
+  const mme_config_snapshot_t *config = NULL;
+  int rc = TA_LIST_NO_MATCH;
 
   DevAssert(plmn != NULL);
-  TBCD_TO_MCC_MNC(plmn, mcc, mnc, mnc_len);
-  mme_config_read_lock(&mme_config);
+  DevAssert(plmn->size == 3);
 
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
+  config = mme_config_snapshot_get();
+  for (int i = 0; i < config->nb_served_plmn; i++) {
     OAILOG_TRACE(
       LOG_S1AP,
-      "Comparing plmn_mcc %d/%d, plmn_mnc %d/%d plmn_mnc_len %d/%d\n",
-      mme_config.served_tai.plmn_mcc[i],
-      mcc,
-      mme_config.served_tai.plmn_mnc[i],
-      mnc,
-      mme_config.served_tai.plmn_mnc_len[i],
-      mnc_len);
+      "Comparing plmn_mcc %d, plmn_mnc %d plmn_mnc_len %d\n",
+      config->served_plmn[i].mcc,
+      config->served_plmn[i].mnc,
+      config->served_plmn[i].mnc_len);
 
-    if (
-      (mme_config.served_tai.plmn_mcc[i] == mcc) &&
-      (mme_config.served_tai.plmn_mnc[i] == mnc) &&
-      (mme_config.served_tai.plmn_mnc_len[i] == mnc_len))
+    if (memcmp(config->served_plmn[i].tbcd, plmn->buf, 3) == 0) {
       /*
        * There is a matching plmn
        */
-      return TA_LIST_AT_LEAST_ONE_MATCH;
+      rc = TA_LIST_AT_LEAST_ONE_MATCH;
+      break;
+    }
   }
-
-  mme_config_unlock(&mme_config);
-  return TA_LIST_NO_MATCH;
+  mme_config_snapshot_put(config);
+  return rc;
 }
 
 /* @brief compare a list of broadcasted plmns against the MME configured.
@@ -105,26 +100,28 @@ static int s1ap_mme_compare_plmns(S1ap_BPLMNs_t *b_plmns)
 */
 static int s1ap_mme_compare_tac(const S1ap_TAC_t *const tac)
 {
-  int i = 0;
+  const mme_config_snapshot_t *config = NULL;
   uint16_t tac_value = 0;
+  int rc = TA_LIST_NO_MATCH;
 
   DevAssert(tac != NULL);
   OCTET_STRING_TO_TAC(tac, tac_value);
-  mme_config_read_lock(&mme_config);
 
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
+  config = mme_config_snapshot_get();
+  for (int i = 0; i < config->served_tai.nb_tai; i++) {
     OAILOG_TRACE(
       LOG_S1AP,
       "Comparing config tac %d, received tac = %d\n",
-      mme_config.served_tai.tac[i],
+      config->served_tai.tac[i],
       tac_value);
 
-    if (mme_config.served_tai.tac[i] == tac_value)
-      return TA_LIST_AT_LEAST_ONE_MATCH;
+    if (config->served_tai.tac[i] == tac_value) {
+      rc = TA_LIST_AT_LEAST_ONE_MATCH;
+      break;
+    }
   }
-
-  mme_config_unlock(&mme_config);
-  return TA_LIST_NO_MATCH;
+  mme_config_snapshot_put(config);
+  return rc;
 }
 
 /* @brief compare a given ta list against the one provided by mme configuration.
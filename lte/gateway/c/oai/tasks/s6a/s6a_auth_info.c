@@ -191,7 +191,14 @@ static inline int s6a_parse_authentication_info_avp(
 
     switch (hdr->avp_code) {
       case AVP_CODE_E_UTRAN_VECTOR: {
-        DevAssert(MAX_EPS_AUTH_VECTORS > authentication_info->nb_of_vectors);
+        if (
+          authentication_info->nb_of_vectors >= MAX_EPS_AUTH_VECTORS_PER_AIR) {
+          OAILOG_WARNING(
+            LOG_S6A,
+            "Ignoring E-UTRAN vector beyond the %d requested at most\n",
+            MAX_EPS_AUTH_VECTORS_PER_AIR);
+          break;
+        }
         CHECK_FCT(s6a_parse_e_utran_vector(
           avp,
           &authentication_info
@@ -216,6 +223,29 @@ static inline int s6a_parse_authentication_info_avp(
   return RETURNok;
 }
 
+/* Prefetch requests are the ones sent without Immediate-Response-Preferred */
+static inline int s6a_air_is_prefetch(struct msg *qry, bool *prefetch)
+{
+  struct avp *avp = NULL;
+  struct avp_hdr *hdr = NULL;
+
+  *prefetch = true;
+  CHECK_FCT(
+    fd_msg_search_avp(qry, s6a_fd_cnf.dataobj_s6a_req_eutran_auth_info, &avp));
+  if (avp) {
+    CHECK_FCT(fd_msg_browse(avp, MSG_BRW_FIRST_CHILD, &avp, NULL));
+  }
+  while (avp) {
+    CHECK_FCT(fd_msg_avp_hdr(avp, &hdr));
+    if (hdr->avp_code == AVP_CODE_IMMEDIATE_RESPONSE_PREFERRED) {
+      *prefetch = false;
+      break;
+    }
+    CHECK_FCT(fd_msg_browse(avp, MSG_BRW_NEXT, &avp, NULL));
+  }
+  return RETURNok;
+}
+
 int s6a_aia_cb(
   struct msg **msg,
   struct avp *paramavp,
@@ -256,6 +286,10 @@ int s6a_aia_cb(
     DevMessage("Query has been freed before we received the answer\n");
   }
 
+  bool prefetch = false;
+  CHECK_FCT(s6a_air_is_prefetch(qry, &prefetch));
+  s6a_auth_info_ans_p->prefetch = prefetch;
+
   /*
    * Retrieve the result-code
    */
@@ -487,12 +521,16 @@ int s6a_generate_authentication_info_req(s6a_auth_info_req_t *air_p)
      * We want to use the vectors immediately in HSS so we have to add
      * * * * the Immediate-Response-Preferred AVP.
      * * * * Value of this AVP is not significant.
+     * * * * Prefetched vectors are not needed right away, the absence of
+     * * * * this AVP also tells their answer apart in s6a_aia_cb.
      */
-    CHECK_FCT(fd_msg_avp_new(
-      s6a_fd_cnf.dataobj_s6a_immediate_response_pref, 0, &child_avp));
-    value.u32 = 0;
-    CHECK_FCT(fd_msg_avp_setvalue(child_avp, &value));
-    CHECK_FCT(fd_msg_avp_add(avp, MSG_BRW_LAST_CHILD, child_avp));
+    if (!air_p->prefetch) {
+      CHECK_FCT(fd_msg_avp_new(
+        s6a_fd_cnf.dataobj_s6a_immediate_response_pref, 0, &child_avp));
+      value.u32 = 0;
+      CHECK_FCT(fd_msg_avp_setvalue(child_avp, &value));
+      CHECK_FCT(fd_msg_avp_add(avp, MSG_BRW_LAST_CHILD, child_avp));
+    }
 
     /*
      * Re-synchronization information containing the AUTS computed at USIM
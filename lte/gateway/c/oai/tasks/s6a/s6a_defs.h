@@ -165,6 +165,8 @@ extern s6a_fd_cnf_t s6a_fd_cnf;
 #define AVP_CODE_PRE_EMPTION_CAPABILITY (1047)
 #define AVP_CODE_PRE_EMPTION_VULNERABILITY (1048)
 #define AVP_CODE_SUBSCRIPTION_DATA (1400)
+#define AVP_CODE_REQUESTED_EUTRAN_AUTHENTICATION_INFO (1408)
+#define AVP_CODE_IMMEDIATE_RESPONSE_PREFERRED (1412)
 #define AVP_CODE_AUTHENTICATION_INFO (1413)
 #define AVP_CODE_E_UTRAN_VECTOR (1414)
 #define AVP_CODE_NETWORK_ACCESS_MODE (1417)
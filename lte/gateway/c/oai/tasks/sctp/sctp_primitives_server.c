@@ -326,7 +326,7 @@ static int sctp_send_msg(
       stream,
       0,
       0) < 0) {
-    bdestroy(*payload);
+    bdestroy_wrapper(payload);
     OAILOG_ERROR(LOG_SCTP, "send: %s:%d\n", strerror(errno), errno);
     return -1;
   }
@@ -335,8 +335,7 @@ static int sctp_send_msg(
     "Successfully sent %d bytes on stream %d\n",
     blength(*payload),
     stream);
-  bdestroy(*payload);
-  *payload = NULL;
+  bdestroy_wrapper(payload);
 
   assoc_desc->messages_sent++;
   return 0;
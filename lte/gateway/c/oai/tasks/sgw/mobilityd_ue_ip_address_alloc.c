@@ -26,6 +26,7 @@
 #include "pgw_ue_ip_address_alloc.h"
 #include "rpc_client.h"
 #include "service303.h"
+#include "sgw_paging.h"
 
 int allocate_ue_ipv4_address(const char *imsi, struct in_addr *addr)
 {
@@ -54,6 +55,8 @@ int allocate_ue_ipv4_address(const char *imsi, struct in_addr *addr)
       LOG_SPGW_APP,
       "Failed to allocate IPv4 PAA for PDN type IPv4. IP alloc status = %d \n",
       ip_alloc_status);
+  } else {
+    sgw_paging_add_ue(addr, imsi);
   }
   return ip_alloc_status;
 }
@@ -68,6 +71,7 @@ int release_ue_ipv4_address(const char *imsi, struct in_addr *addr)
     "ipv4",
     "result",
     "ip_address_released");
+  sgw_paging_remove_ue(addr);
   // Release IP address back to PGW IP Address allocator
   return release_ipv4_address(imsi, addr);
 }
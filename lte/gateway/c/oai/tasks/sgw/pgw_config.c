@@ -471,6 +471,17 @@ int pgw_config_parse_file(pgw_config_t *config_pP)
         config_pP->enable_loading_gtp_kernel_module = false;
       }
     }
+    if (config_setting_lookup_string(
+          setting_pgw,
+          PGW_CONFIG_STRING_RULE_BACKEND,
+          (const char **) &astring)) {
+      if (
+        strcasecmp(astring, PGW_CONFIG_STRING_RULE_BACKEND_NFTABLES) == 0) {
+        config_pP->use_nftables_rules = true;
+      } else {
+        config_pP->use_nftables_rules = false;
+      }
+    }
 
     subsetting = config_setting_get_member(setting_pgw, PGW_CONFIG_STRING_PCEF);
     if (subsetting) {
@@ -637,6 +648,11 @@ void pgw_config_display(pgw_config_t *config_p)
   } else {
     OAILOG_INFO(LOG_SPGW_APP, "- GTPv1U .................: Disabled\n");
   }
+  OAILOG_INFO(
+    LOG_SPGW_APP,
+    "- Bearer marking rules ...: %s\n",
+    config_p->use_nftables_rules ? PGW_CONFIG_STRING_RULE_BACKEND_NFTABLES :
+                                   PGW_CONFIG_STRING_RULE_BACKEND_IPTABLES);
   OAILOG_INFO(
     LOG_SPGW_APP,
     "- PCEF support ...........: %s (in development)\n",
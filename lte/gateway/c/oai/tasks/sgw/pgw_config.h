@@ -58,6 +58,9 @@
 #define PGW_CONFIG_STRING_NO_GTP_KERNEL_AVAILABLE "NO_GTP_KERNEL_AVAILABLE"
 #define PGW_CONFIG_STRING_GTP_KERNEL_MODULE "GTP_KERNEL_MODULE"
 #define PGW_CONFIG_STRING_GTP_KERNEL "GTP_KERNEL"
+#define PGW_CONFIG_STRING_RULE_BACKEND "RULE_BACKEND"
+#define PGW_CONFIG_STRING_RULE_BACKEND_IPTABLES "iptables"
+#define PGW_CONFIG_STRING_RULE_BACKEND_NFTABLES "nftables"
 
 #define PGW_CONFIG_STRING_INTERFACE_DISABLED "none"
 
@@ -120,6 +123,7 @@ typedef struct pgw_config_s {
   bool relay_enabled;
   bool use_gtp_kernel_module;
   bool enable_loading_gtp_kernel_module;
+  bool use_nftables_rules; // bearer marking rules through nftables netlink
 
   struct {
     bool enabled;
@@ -145,7 +145,16 @@ void pgw_delete_procedure_create_bearer(
 //------------------------------------------------------------------------------
 void pgw_free_procedure_create_bearer(pgw_ni_cbr_proc_t **ni_cbr_proc)
 {
-  // DO here specific releases (memory,etc)
-  // nothing to do actually
+  if ((*ni_cbr_proc)->pending_eps_bearers) {
+    struct sgw_eps_bearer_entry_wrapper_s *wrapper = NULL;
+
+    // Bearers the MME never answered for, their S1-U TEIDs go back too
+    while ((wrapper = LIST_FIRST((*ni_cbr_proc)->pending_eps_bearers))) {
+      LIST_REMOVE(wrapper, entries);
+      sgw_free_sgw_eps_bearer_context(&wrapper->sgw_eps_bearer_entry);
+      free_wrapper((void **) &wrapper);
+    }
+    free_wrapper((void **) &(*ni_cbr_proc)->pending_eps_bearers);
+  }
   free_wrapper((void **) ni_cbr_proc);
 }
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pgw_rules.c
+  \brief Selection of the packet marking rule backend
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <netinet/in.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "pgw_rules.h"
+
+static const struct pgw_rule_ops *pgw_rule_ops = NULL;
+
+//------------------------------------------------------------------------------
+int pgw_rules_init(bool use_nftables, const char *gtp_ifname)
+{
+  if (use_nftables) {
+    pgw_rule_ops = pgw_rule_ops_init_nftables();
+    if (pgw_rule_ops->init(gtp_ifname) == RETURNok) {
+      OAILOG_INFO(LOG_SPGW_APP, "Bearer marking rules: nftables\n");
+      return RETURNok;
+    }
+    OAILOG_WARNING(
+      LOG_SPGW_APP, "nftables not available, falling back on iptables\n");
+  }
+  pgw_rule_ops = pgw_rule_ops_init_iptables();
+  if (pgw_rule_ops->init(gtp_ifname) == RETURNok) {
+    OAILOG_INFO(LOG_SPGW_APP, "Bearer marking rules: iptables\n");
+    return RETURNok;
+  }
+  pgw_rule_ops = NULL;
+  return RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+void pgw_rules_exit(void)
+{
+  if (pgw_rule_ops) {
+    pgw_rule_ops->commit();
+    pgw_rule_ops->uninit();
+    pgw_rule_ops = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+int pgw_rules_add_bearer_mark(struct in_addr ue, uint32_t sdf_id, ebi_t ebi)
+{
+  if (!pgw_rule_ops) {
+    return RETURNerror;
+  }
+  return pgw_rule_ops->add_bearer_mark(ue, sdf_id, ebi);
+}
+
+//------------------------------------------------------------------------------
+int pgw_rules_del_bearer_mark(struct in_addr ue, uint32_t sdf_id, ebi_t ebi)
+{
+  if (!pgw_rule_ops) {
+    return RETURNerror;
+  }
+  return pgw_rule_ops->del_bearer_mark(ue, sdf_id, ebi);
+}
+
+//------------------------------------------------------------------------------
+int pgw_rules_commit(void)
+{
+  if (!pgw_rule_ops) {
+    return 0;
+  }
+  return pgw_rule_ops->commit();
+}
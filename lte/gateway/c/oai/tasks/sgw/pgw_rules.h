@@ -0,0 +1,88 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pgw_rules.h
+  \brief Packet marking rules of the dedicated bearers
+
+  Downlink packets of a dedicated bearer are marked with the bearer EBI when
+  their destination is the UE and they carry the SDF mark set by the PCEF
+  filters. Two backends program these rules:
+  - iptables: one forked iptables command per rule, through TASK_ASYNC_SYSTEM,
+  - nftables: one nftables map element per rule, sent over netlink by the
+    SPGW task itself. Changes are queued and committed as one nftables
+    transaction when the SPGW task has drained its ITTI queue.
+  All functions are called from the SPGW task only.
+*/
+
+#ifndef FILE_PGW_RULES_SEEN
+#define FILE_PGW_RULES_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+#include "bstrlib.h"
+#include "3gpp_24.007.h"
+
+#define PGW_RULES_GTP_IFNAME "gtp0"
+
+/* nftables objects owned by the nftables backend */
+#define PGW_RULES_NFT_TABLE "magma_pgw"
+#define PGW_RULES_NFT_CHAIN "bearer_mark"
+#define PGW_RULES_NFT_MAP "bearer_marks"
+
+struct pgw_rule_ops {
+  int (*init)(const char *gtp_ifname);
+  void (*uninit)(void);
+  int (*add_bearer_mark)(struct in_addr ue, uint32_t sdf_id, ebi_t ebi);
+  int (*del_bearer_mark)(struct in_addr ue, uint32_t sdf_id, ebi_t ebi);
+  /* Push the queued changes, returns the number of changes that failed */
+  int (*commit)(void);
+};
+
+const struct pgw_rule_ops *pgw_rule_ops_init_iptables(void);
+const struct pgw_rule_ops *pgw_rule_ops_init_nftables(void);
+
+/** \brief Select and initialize the rule backend
+ * \param use_nftables Use the nftables backend, iptables is used when false or
+ *        when nftables is not available on the host
+ **/
+int pgw_rules_init(bool use_nftables, const char *gtp_ifname);
+void pgw_rules_exit(void);
+
+int pgw_rules_add_bearer_mark(struct in_addr ue, uint32_t sdf_id, ebi_t ebi);
+int pgw_rules_del_bearer_mark(struct in_addr ue, uint32_t sdf_id, ebi_t ebi);
+
+/** \brief Commit the changes queued since the last call, to be called when the
+ * SPGW task has no more pending message
+ **/
+int pgw_rules_commit(void);
+
+/** \brief Format the iptables command adding (or deleting) a bearer mark rule
+ **/
+bstring pgw_rules_iptables_bearer_mark_command(
+  bool add,
+  const char *gtp_ifname,
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi);
+
+#endif /* FILE_PGW_RULES_SEEN */
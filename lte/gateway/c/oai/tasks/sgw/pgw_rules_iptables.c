@@ -0,0 +1,125 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pgw_rules_iptables.c
+  \brief Bearer marking rules programmed with iptables commands
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "common_defs.h"
+#include "intertask_interface.h"
+#include "async_system.h"
+#include "pgw_rules.h"
+
+static bstring iptables_gtp_ifname = NULL;
+
+//------------------------------------------------------------------------------
+bstring pgw_rules_iptables_bearer_mark_command(
+  bool add,
+  const char *gtp_ifname,
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  return bformat(
+    "iptables %s POSTROUTING -t mangle --out-interface %s "
+    "--dest %" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8
+    "/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
+    add ? "-A" : "-D",
+    gtp_ifname,
+    NIPADDR(ue.s_addr),
+    sdf_id,
+    ebi);
+}
+
+//------------------------------------------------------------------------------
+static int iptables_init(const char *gtp_ifname)
+{
+  iptables_gtp_ifname = bfromcstr(gtp_ifname);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static void iptables_uninit(void)
+{
+  bdestroy_wrapper(&iptables_gtp_ifname);
+}
+
+//------------------------------------------------------------------------------
+static int iptables_bearer_mark(
+  bool add,
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  bstring marking_command = pgw_rules_iptables_bearer_mark_command(
+    add, bdata(iptables_gtp_ifname), ue, sdf_id, ebi);
+  int rv =
+    async_system_command(TASK_SPGW_APP, false, bdata(marking_command));
+  bdestroy_wrapper(&marking_command);
+  return rv;
+}
+
+//------------------------------------------------------------------------------
+static int iptables_add_bearer_mark(
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  return iptables_bearer_mark(true, ue, sdf_id, ebi);
+}
+
+//------------------------------------------------------------------------------
+static int iptables_del_bearer_mark(
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  return iptables_bearer_mark(false, ue, sdf_id, ebi);
+}
+
+//------------------------------------------------------------------------------
+static int iptables_commit(void)
+{
+  // Every command has already been handed over to TASK_ASYNC_SYSTEM
+  return 0;
+}
+
+static const struct pgw_rule_ops iptables_ops = {
+  .init = iptables_init,
+  .uninit = iptables_uninit,
+  .add_bearer_mark = iptables_add_bearer_mark,
+  .del_bearer_mark = iptables_del_bearer_mark,
+  .commit = iptables_commit,
+};
+
+//------------------------------------------------------------------------------
+const struct pgw_rule_ops *pgw_rule_ops_init_iptables(void)
+{
+  return &iptables_ops;
+}
@@ -0,0 +1,599 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pgw_rules_nftables.c
+  \brief Bearer marking rules programmed through nftables netlink messages
+
+  At init the backend owns the table PGW_RULES_NFT_TABLE, holding a single
+  rule equivalent to
+    oifname "gtp0" meta mark set ip daddr . meta mark map @bearer_marks
+  so that adding or deleting the marking of a dedicated bearer is a map
+  element change, instead of a rule insertion in a chain. Changes are queued
+  in a netlink batch and committed as one nftables transaction. The kernel
+  aborts a transaction as soon as one of its messages fails, the changes of a
+  failed batch are then replayed one by one so that only the faulty ones are
+  lost.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netfilter/nf_tables.h>
+
+#include "log.h"
+#include "common_defs.h"
+#include "conversions.h"
+#include "pgw_rules.h"
+
+#ifndef NETLINK_CAP_ACK
+#define NETLINK_CAP_ACK 10
+#endif
+
+// nftables data types, only used by the nft tool to display the map
+#define NFT_DATATYPE_IPADDR 7
+#define NFT_DATATYPE_MARK 19
+#define NFT_DATATYPE_BITS 6
+
+#define NFT_NF_IP_PRI_MANGLE (-150)
+#define NFT_MAP_SET_ID 1
+#define NFT_MAP_KEY_LEN (sizeof(uint32_t) + sizeof(uint32_t))
+
+#define NFT_BATCH_MAX_CHANGES 512
+#define NFT_BATCH_BUFFER_SIZE (128 * 1024)
+#define NFT_RECV_BUFFER_SIZE (64 * 1024)
+#define NFT_RECV_TIMEOUT_SEC 2
+
+typedef struct nft_change_s {
+  bool add;
+  struct in_addr ue;
+  uint32_t sdf_id;
+  ebi_t ebi;
+} nft_change_t;
+
+static struct {
+  int fd;
+  uint32_t seq;
+  char gtp_ifname[IFNAMSIZ];
+  // Netlink batch being built, begins with NFNL_MSG_BATCH_BEGIN
+  uint8_t buffer[NFT_BATCH_BUFFER_SIZE];
+  size_t length;
+  uint32_t first_seq;
+  int nb_msgs;
+  // Changes of the batch, kept for replay and error reporting
+  nft_change_t changes[NFT_BATCH_MAX_CHANGES];
+  int nb_changes;
+  uint8_t recv_buffer[NFT_RECV_BUFFER_SIZE];
+} nft = {.fd = -1};
+
+//------------------------------------------------------------------------------
+static struct nlmsghdr *nft_msg_start(
+  uint16_t type,
+  uint16_t flags,
+  uint8_t family,
+  uint16_t res_id)
+{
+  struct nlmsghdr *nlh = (struct nlmsghdr *) (nft.buffer + nft.length);
+  struct nfgenmsg *nfg = NULL;
+
+  nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct nfgenmsg));
+  nlh->nlmsg_type = type;
+  nlh->nlmsg_flags = NLM_F_REQUEST | flags;
+  nlh->nlmsg_seq = ++nft.seq;
+  nlh->nlmsg_pid = 0;
+  nfg = NLMSG_DATA(nlh);
+  nfg->nfgen_family = family;
+  nfg->version = NFNETLINK_V0;
+  nfg->res_id = htons(res_id);
+  return nlh;
+}
+
+//------------------------------------------------------------------------------
+static void nft_msg_end(struct nlmsghdr *nlh)
+{
+  nft.length += NLMSG_ALIGN(nlh->nlmsg_len);
+}
+
+//------------------------------------------------------------------------------
+static struct nlattr *nft_attr_put(
+  struct nlmsghdr *nlh,
+  uint16_t type,
+  const void *data,
+  uint16_t len)
+{
+  struct nlattr *attr =
+    (struct nlattr *) ((uint8_t *) nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+
+  attr->nla_type = type;
+  attr->nla_len = NLA_HDRLEN + len;
+  if (len) {
+    memcpy((uint8_t *) attr + NLA_HDRLEN, data, len);
+  }
+  memset(
+    (uint8_t *) attr + attr->nla_len,
+    0,
+    NLA_ALIGN(attr->nla_len) - attr->nla_len);
+  nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + NLA_ALIGN(attr->nla_len);
+  return attr;
+}
+
+//------------------------------------------------------------------------------
+static void nft_attr_put_u32(
+  struct nlmsghdr *nlh,
+  uint16_t type,
+  uint32_t value)
+{
+  uint32_t be_value = htonl(value);
+  nft_attr_put(nlh, type, &be_value, sizeof(be_value));
+}
+
+//------------------------------------------------------------------------------
+static void nft_attr_put_str(
+  struct nlmsghdr *nlh,
+  uint16_t type,
+  const char *value)
+{
+  nft_attr_put(nlh, type, value, strlen(value) + 1);
+}
+
+//------------------------------------------------------------------------------
+static struct nlattr *nft_nest_start(struct nlmsghdr *nlh, uint16_t type)
+{
+  return nft_attr_put(nlh, type | NLA_F_NESTED, NULL, 0);
+}
+
+//------------------------------------------------------------------------------
+static void nft_nest_end(struct nlmsghdr *nlh, struct nlattr *nest)
+{
+  nest->nla_len = (uint8_t *) nlh + nlh->nlmsg_len - (uint8_t *) nest;
+}
+
+//------------------------------------------------------------------------------
+static void nft_put_data(
+  struct nlmsghdr *nlh,
+  uint16_t type,
+  const void *data,
+  uint16_t len)
+{
+  struct nlattr *nest = nft_nest_start(nlh, type);
+  nft_attr_put(nlh, NFTA_DATA_VALUE, data, len);
+  nft_nest_end(nlh, nest);
+}
+
+//------------------------------------------------------------------------------
+static struct nlattr *nft_expr_start(
+  struct nlmsghdr *nlh,
+  const char *name,
+  struct nlattr **data)
+{
+  struct nlattr *elem = nft_nest_start(nlh, NFTA_LIST_ELEM);
+  nft_attr_put_str(nlh, NFTA_EXPR_NAME, name);
+  *data = nft_nest_start(nlh, NFTA_EXPR_DATA);
+  return elem;
+}
+
+//------------------------------------------------------------------------------
+static void nft_expr_end(
+  struct nlmsghdr *nlh,
+  struct nlattr *elem,
+  struct nlattr *data)
+{
+  nft_nest_end(nlh, data);
+  nft_nest_end(nlh, elem);
+}
+
+//------------------------------------------------------------------------------
+static struct nlmsghdr *nft_batch_msg_start(uint16_t type, uint16_t flags)
+{
+  if (!nft.length) {
+    struct nlmsghdr *begin =
+      nft_msg_start(NFNL_MSG_BATCH_BEGIN, 0, AF_UNSPEC, NFNL_SUBSYS_NFTABLES);
+    nft_msg_end(begin);
+    nft.first_seq = nft.seq + 1;
+    nft.nb_msgs = 0;
+  }
+  nft.nb_msgs++;
+  return nft_msg_start(
+    (NFNL_SUBSYS_NFTABLES << 8) | type,
+    NLM_F_ACK | flags,
+    NFPROTO_IPV4,
+    0);
+}
+
+//------------------------------------------------------------------------------
+static void nft_batch_reset(void)
+{
+  nft.length = 0;
+  nft.nb_msgs = 0;
+  nft.nb_changes = 0;
+}
+
+//------------------------------------------------------------------------------
+static void nft_queue_setelem(const nft_change_t *const change)
+{
+  struct nlmsghdr *nlh = nft_batch_msg_start(
+    change->add ? NFT_MSG_NEWSETELEM : NFT_MSG_DELSETELEM,
+    change->add ? NLM_F_CREATE : 0);
+  struct nlattr *elements = NULL;
+  struct nlattr *elem = NULL;
+  uint8_t key[NFT_MAP_KEY_LEN];
+  uint32_t mark = change->ebi;
+
+  // ip daddr is in network order, meta mark in host order
+  memcpy(key, &change->ue.s_addr, sizeof(uint32_t));
+  memcpy(key + sizeof(uint32_t), &change->sdf_id, sizeof(uint32_t));
+
+  nft_attr_put_str(nlh, NFTA_SET_ELEM_LIST_TABLE, PGW_RULES_NFT_TABLE);
+  nft_attr_put_str(nlh, NFTA_SET_ELEM_LIST_SET, PGW_RULES_NFT_MAP);
+  elements = nft_nest_start(nlh, NFTA_SET_ELEM_LIST_ELEMENTS);
+  elem = nft_nest_start(nlh, NFTA_LIST_ELEM);
+  nft_put_data(nlh, NFTA_SET_ELEM_KEY, key, sizeof(key));
+  if (change->add) {
+    nft_put_data(nlh, NFTA_SET_ELEM_DATA, &mark, sizeof(mark));
+  }
+  nft_nest_end(nlh, elem);
+  nft_nest_end(nlh, elements);
+  nft_msg_end(nlh);
+}
+
+//------------------------------------------------------------------------------
+/* Send the batch and collect one acknowledgement per message, returns the
+ * number of messages that were not acknowledged successfully */
+static int nft_batch_send(void)
+{
+  struct nlmsghdr *end = NULL;
+  uint32_t last_seq = 0;
+  int nb_acks = 0;
+  int nb_errors = 0;
+
+  if (!nft.nb_msgs) {
+    nft.length = 0;
+    return 0;
+  }
+  last_seq = nft.seq;
+  end = nft_msg_start(NFNL_MSG_BATCH_END, 0, AF_UNSPEC, NFNL_SUBSYS_NFTABLES);
+  nft_msg_end(end);
+
+  if (send(nft.fd, nft.buffer, nft.length, 0) < 0) {
+    OAILOG_ERROR(
+      LOG_SPGW_APP, "Failed to send nftables batch: %s\n", strerror(errno));
+    return nft.nb_msgs;
+  }
+
+  while (nb_acks < nft.nb_msgs) {
+    ssize_t len = recv(nft.fd, nft.recv_buffer, sizeof(nft.recv_buffer), 0);
+    struct nlmsghdr *nlh = (struct nlmsghdr *) nft.recv_buffer;
+
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      OAILOG_ERROR(
+        LOG_SPGW_APP,
+        "Missing %d nftables acknowledgements: %s\n",
+        nft.nb_msgs - nb_acks,
+        strerror(errno));
+      return nb_errors + nft.nb_msgs - nb_acks;
+    }
+    for (; NLMSG_OK(nlh, (size_t) len); nlh = NLMSG_NEXT(nlh, len)) {
+      struct nlmsgerr *err = NULL;
+
+      if (nlh->nlmsg_type != NLMSG_ERROR) {
+        continue;
+      }
+      err = NLMSG_DATA(nlh);
+      if (
+        (nlh->nlmsg_seq == nft.first_seq - 1) ||
+        (nlh->nlmsg_seq == last_seq + 1)) {
+        // Error on the batch begin or end: the batch itself was refused
+        OAILOG_ERROR(
+          LOG_SPGW_APP,
+          "nftables batch refused: %s\n",
+          strerror(-err->error));
+        return nft.nb_msgs;
+      }
+      if ((nlh->nlmsg_seq < nft.first_seq) || (nlh->nlmsg_seq > last_seq)) {
+        // Late acknowledgement of a batch that timed out
+        continue;
+      }
+      nb_acks++;
+      if (err->error) {
+        nb_errors++;
+        OAILOG_DEBUG(
+          LOG_SPGW_APP,
+          "nftables message %u failed: %s\n",
+          nlh->nlmsg_seq - nft.first_seq,
+          strerror(-err->error));
+      }
+    }
+  }
+  return nb_errors;
+}
+
+//------------------------------------------------------------------------------
+static int nftables_commit(void)
+{
+  int nb_changes = nft.nb_changes;
+  int nb_failed = 0;
+
+  if (!nft.nb_msgs) {
+    return 0;
+  }
+  if (!nft_batch_send()) {
+    nft_batch_reset();
+    return 0;
+  }
+  // The whole transaction was aborted, replay the changes one by one
+  for (int i = 0; i < nb_changes; i++) {
+    nft_change_t change = nft.changes[i];
+
+    nft_batch_reset();
+    nft_queue_setelem(&change);
+    if (nft_batch_send()) {
+      nb_failed++;
+      OAILOG_ERROR(
+        LOG_SPGW_APP,
+        "Failed to %s bearer mark " IN_ADDR_FMT " mark 0x%04X ebi %u\n",
+        change.add ? "add" : "delete",
+        NIPADDR(change.ue.s_addr),
+        change.sdf_id,
+        change.ebi);
+    }
+  }
+  nft_batch_reset();
+  return nb_failed;
+}
+
+//------------------------------------------------------------------------------
+static int nftables_queue_change(
+  bool add,
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  nft_change_t *change = NULL;
+
+  if (nft.fd < 0) {
+    return RETURNerror;
+  }
+  if (nft.nb_changes == NFT_BATCH_MAX_CHANGES) {
+    nftables_commit();
+  }
+  change = &nft.changes[nft.nb_changes++];
+  change->add = add;
+  change->ue = ue;
+  change->sdf_id = sdf_id;
+  change->ebi = ebi;
+  nft_queue_setelem(change);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static int nftables_add_bearer_mark(
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  return nftables_queue_change(true, ue, sdf_id, ebi);
+}
+
+//------------------------------------------------------------------------------
+static int nftables_del_bearer_mark(
+  struct in_addr ue,
+  uint32_t sdf_id,
+  ebi_t ebi)
+{
+  return nftables_queue_change(false, ue, sdf_id, ebi);
+}
+
+//------------------------------------------------------------------------------
+static void nft_queue_table(uint16_t type, uint16_t flags)
+{
+  struct nlmsghdr *nlh = nft_batch_msg_start(type, flags);
+  nft_attr_put_str(nlh, NFTA_TABLE_NAME, PGW_RULES_NFT_TABLE);
+  nft_msg_end(nlh);
+}
+
+//------------------------------------------------------------------------------
+static void nft_queue_chain(void)
+{
+  struct nlmsghdr *nlh = nft_batch_msg_start(NFT_MSG_NEWCHAIN, NLM_F_CREATE);
+  struct nlattr *hook = NULL;
+
+  nft_attr_put_str(nlh, NFTA_CHAIN_TABLE, PGW_RULES_NFT_TABLE);
+  nft_attr_put_str(nlh, NFTA_CHAIN_NAME, PGW_RULES_NFT_CHAIN);
+  hook = nft_nest_start(nlh, NFTA_CHAIN_HOOK);
+  nft_attr_put_u32(nlh, NFTA_HOOK_HOOKNUM, NF_INET_POST_ROUTING);
+  nft_attr_put_u32(nlh, NFTA_HOOK_PRIORITY, (uint32_t) NFT_NF_IP_PRI_MANGLE);
+  nft_nest_end(nlh, hook);
+  nft_attr_put_u32(nlh, NFTA_CHAIN_POLICY, NF_ACCEPT);
+  nft_attr_put_str(nlh, NFTA_CHAIN_TYPE, "filter");
+  nft_msg_end(nlh);
+}
+
+//------------------------------------------------------------------------------
+static void nft_queue_map(void)
+{
+  struct nlmsghdr *nlh = nft_batch_msg_start(NFT_MSG_NEWSET, NLM_F_CREATE);
+
+  nft_attr_put_str(nlh, NFTA_SET_TABLE, PGW_RULES_NFT_TABLE);
+  nft_attr_put_str(nlh, NFTA_SET_NAME, PGW_RULES_NFT_MAP);
+  nft_attr_put_u32(nlh, NFTA_SET_FLAGS, NFT_SET_MAP);
+  nft_attr_put_u32(
+    nlh,
+    NFTA_SET_KEY_TYPE,
+    (NFT_DATATYPE_IPADDR << NFT_DATATYPE_BITS) | NFT_DATATYPE_MARK);
+  nft_attr_put_u32(nlh, NFTA_SET_KEY_LEN, NFT_MAP_KEY_LEN);
+  nft_attr_put_u32(nlh, NFTA_SET_DATA_TYPE, NFT_DATATYPE_MARK);
+  nft_attr_put_u32(nlh, NFTA_SET_DATA_LEN, sizeof(uint32_t));
+  nft_attr_put_u32(nlh, NFTA_SET_ID, NFT_MAP_SET_ID);
+  nft_msg_end(nlh);
+}
+
+//------------------------------------------------------------------------------
+static void nft_queue_rule(void)
+{
+  struct nlmsghdr *nlh =
+    nft_batch_msg_start(NFT_MSG_NEWRULE, NLM_F_CREATE | NLM_F_APPEND);
+  struct nlattr *exprs = NULL;
+  struct nlattr *elem = NULL;
+  struct nlattr *data = NULL;
+  char ifname[IFNAMSIZ] = {0};
+
+  memcpy(ifname, nft.gtp_ifname, sizeof(ifname));
+  nft_attr_put_str(nlh, NFTA_RULE_TABLE, PGW_RULES_NFT_TABLE);
+  nft_attr_put_str(nlh, NFTA_RULE_CHAIN, PGW_RULES_NFT_CHAIN);
+  exprs = nft_nest_start(nlh, NFTA_RULE_EXPRESSIONS);
+
+  // oifname "gtp0"
+  elem = nft_expr_start(nlh, "meta", &data);
+  nft_attr_put_u32(nlh, NFTA_META_DREG, NFT_REG_1);
+  nft_attr_put_u32(nlh, NFTA_META_KEY, NFT_META_OIFNAME);
+  nft_expr_end(nlh, elem, data);
+  elem = nft_expr_start(nlh, "cmp", &data);
+  nft_attr_put_u32(nlh, NFTA_CMP_SREG, NFT_REG_1);
+  nft_attr_put_u32(nlh, NFTA_CMP_OP, NFT_CMP_EQ);
+  nft_put_data(nlh, NFTA_CMP_DATA, ifname, sizeof(ifname));
+  nft_expr_end(nlh, elem, data);
+
+  // ip daddr . meta mark
+  elem = nft_expr_start(nlh, "payload", &data);
+  nft_attr_put_u32(nlh, NFTA_PAYLOAD_DREG, NFT_REG_1);
+  nft_attr_put_u32(nlh, NFTA_PAYLOAD_BASE, NFT_PAYLOAD_NETWORK_HEADER);
+  nft_attr_put_u32(
+    nlh, NFTA_PAYLOAD_OFFSET, offsetof(struct iphdr, daddr));
+  nft_attr_put_u32(nlh, NFTA_PAYLOAD_LEN, sizeof(uint32_t));
+  nft_expr_end(nlh, elem, data);
+  elem = nft_expr_start(nlh, "meta", &data);
+  nft_attr_put_u32(nlh, NFTA_META_DREG, NFT_REG32_01);
+  nft_attr_put_u32(nlh, NFTA_META_KEY, NFT_META_MARK);
+  nft_expr_end(nlh, elem, data);
+
+  // map @bearer_marks
+  elem = nft_expr_start(nlh, "lookup", &data);
+  nft_attr_put_str(nlh, NFTA_LOOKUP_SET, PGW_RULES_NFT_MAP);
+  nft_attr_put_u32(nlh, NFTA_LOOKUP_SET_ID, NFT_MAP_SET_ID);
+  nft_attr_put_u32(nlh, NFTA_LOOKUP_SREG, NFT_REG_1);
+  nft_attr_put_u32(nlh, NFTA_LOOKUP_DREG, NFT_REG_1);
+  nft_expr_end(nlh, elem, data);
+
+  // meta mark set
+  elem = nft_expr_start(nlh, "meta", &data);
+  nft_attr_put_u32(nlh, NFTA_META_KEY, NFT_META_MARK);
+  nft_attr_put_u32(nlh, NFTA_META_SREG, NFT_REG_1);
+  nft_expr_end(nlh, elem, data);
+
+  nft_nest_end(nlh, exprs);
+  nft_msg_end(nlh);
+}
+
+//------------------------------------------------------------------------------
+static int nftables_init(const char *gtp_ifname)
+{
+  struct sockaddr_nl addr = {.nl_family = AF_NETLINK};
+  struct timeval timeout = {.tv_sec = NFT_RECV_TIMEOUT_SEC};
+  int rcvbuf = 1024 * 1024;
+  int one = 1;
+
+  nft.fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_NETFILTER);
+  if (nft.fd < 0) {
+    OAILOG_ERROR(
+      LOG_SPGW_APP, "Failed to open nfnetlink socket: %s\n", strerror(errno));
+    return RETURNerror;
+  }
+  if (bind(nft.fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+    OAILOG_ERROR(
+      LOG_SPGW_APP, "Failed to bind nfnetlink socket: %s\n", strerror(errno));
+    close(nft.fd);
+    nft.fd = -1;
+    return RETURNerror;
+  }
+  // Acknowledgements do not need to echo the whole request
+  setsockopt(nft.fd, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one));
+  setsockopt(nft.fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  setsockopt(nft.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  memset(nft.gtp_ifname, 0, sizeof(nft.gtp_ifname));
+  strncpy(nft.gtp_ifname, gtp_ifname, IFNAMSIZ - 1);
+  nft.seq = (uint32_t) time(NULL);
+  nft_batch_reset();
+
+  // Start from an empty table: create it if needed, delete it and create again
+  nft_queue_table(NFT_MSG_NEWTABLE, NLM_F_CREATE);
+  nft_queue_table(NFT_MSG_DELTABLE, 0);
+  nft_queue_table(NFT_MSG_NEWTABLE, NLM_F_CREATE);
+  nft_queue_chain();
+  nft_queue_map();
+  nft_queue_rule();
+  if (nft_batch_send()) {
+    OAILOG_ERROR(
+      LOG_SPGW_APP,
+      "Failed to create nftables table %s\n",
+      PGW_RULES_NFT_TABLE);
+    nft_batch_reset();
+    close(nft.fd);
+    nft.fd = -1;
+    return RETURNerror;
+  }
+  nft_batch_reset();
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static void nftables_uninit(void)
+{
+  if (nft.fd < 0) {
+    return;
+  }
+  nft_batch_reset();
+  nft_queue_table(NFT_MSG_DELTABLE, 0);
+  nft_batch_send();
+  nft_batch_reset();
+  close(nft.fd);
+  nft.fd = -1;
+}
+
+static const struct pgw_rule_ops nftables_ops = {
+  .init = nftables_init,
+  .uninit = nftables_uninit,
+  .add_bearer_mark = nftables_add_bearer_mark,
+  .del_bearer_mark = nftables_del_bearer_mark,
+  .commit = nftables_commit,
+};
+
+//------------------------------------------------------------------------------
+const struct pgw_rule_ops *pgw_rule_ops_init_nftables(void)
+{
+  return &nftables_ops;
+}
@@ -39,8 +39,19 @@
 #include "common_types.h"
 #include "sgw_context_manager.h"
 #include "gtpv1u_sgw_defs.h"
+#include "gtpv1u_teid_pool.h"
 #include "pgw_pcef_emulation.h"
 
+// Local TEIDs of the S-GW, allocated on the SPGW task
+#define SGW_S11_TEID_POOL_SIZE (1 << 18)
+#define SGW_S1U_TEID_POOL_SIZE (1 << 20)
+// Longer than the GTP-C retransmissions and the in-flight user plane packets
+#define SGW_TEID_QUARANTINE_SEC 10
+// Poll of the tunnel counters, when the GTP backend has them
+#define SGW_TUNNEL_USAGE_POLL_SEC 10
+// Bearers without traffic for longer are counted as idle
+#define SGW_IDLE_BEARER_SEC 60
+
 typedef struct sgw_app_s {
   bstring sgw_if_name_S1u_S12_S4_up;
   struct in_addr sgw_ip_address_S1u_S12_S4_up;
@@ -50,6 +61,11 @@ typedef struct sgw_app_s {
 
   struct in_addr sgw_ip_address_S5_S8_up; // unused now
 
+  gtpv1u_teid_pool_t *s11_teid_pool;
+  gtpv1u_teid_pool_t *s1u_teid_pool;
+
+  long tunnel_usage_timer_id;
+
   // key is S11 S-GW local teid
   hash_table_ts_t *s11teid2mme_hashtable;
 
@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 #include <netinet/in.h>
 
 #include "bstrlib.h"
@@ -199,11 +200,7 @@ void pgw_lite_cm_free_apn(pgw_apn_t **apnP)
 teid_t sgw_get_new_S11_tunnel_id(void)
 //-----------------------------------------------------------------------------
 {
-  // TO DO: RANDOM
-  static teid_t tunnel_id = 0;
-
-  tunnel_id += 1;
-  return tunnel_id;
+  return gtpv1u_teid_alloc(sgw_app.s11_teid_pool, time(NULL));
 }
 
 //-----------------------------------------------------------------------------
@@ -224,6 +221,7 @@ mme_sgw_tunnel_t *sgw_cm_create_s11_tunnel(
       LOG_SPGW_APP,
       "Failed to create tunnel for remote_teid " TEID_FMT "\n",
       remote_teid);
+    gtpv1u_teid_free(sgw_app.s11_teid_pool, local_teid, time(NULL));
     return NULL;
   }
 
@@ -244,6 +242,9 @@ int sgw_cm_remove_s11_tunnel(teid_t local_teid)
   int temp = 0;
 
   temp = hashtable_ts_free(sgw_app.s11teid2mme_hashtable, local_teid);
+  if (temp == HASH_TABLE_OK) {
+    gtpv1u_teid_free(sgw_app.s11_teid_pool, local_teid, time(NULL));
+  }
   return temp;
 }
 
@@ -299,7 +300,14 @@ void sgw_free_sgw_eps_bearer_context(
   sgw_eps_bearer_ctxt_t **sgw_eps_bearer_ctxt)
 {
   if (*sgw_eps_bearer_ctxt) {
-    // nothing to do actually
+    if (
+      sgw_app.s1u_teid_pool &&
+      (*sgw_eps_bearer_ctxt)->s_gw_teid_S1u_S12_S4_up) {
+      gtpv1u_teid_free(
+        sgw_app.s1u_teid_pool,
+        (*sgw_eps_bearer_ctxt)->s_gw_teid_S1u_S12_S4_up,
+        time(NULL));
+    }
     free_wrapper((void **) sgw_eps_bearer_ctxt);
   }
 }
@@ -31,8 +31,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 #include <netinet/in.h>
 
 #include "bstrlib.h"
@@ -58,18 +60,20 @@
 #include "spgw_config.h"
 #include "gtpv1u.h"
 #include "pgw_ue_ip_address_alloc.h"
+#include "sgw_paging.h"
 #include "pgw_pcef_emulation.h"
 #include "sgw_context_manager.h"
 #include "pgw_procedures.h"
 #include "service303.h"
 #include "pcef_handlers.h"
-#include "async_system.h"
+#include "pgw_rules.h"
 
 extern sgw_app_t sgw_app;
 extern spgw_config_t spgw_config;
 extern struct gtp_tunnel_ops *gtp_tunnel_ops;
 
-static uint32_t g_gtpv1u_teid = 0;
+static void sgw_release_all_enb_related_information(
+  sgw_eps_bearer_ctxt_t *const eps_bearer_ctxt);
 
 #if EMBEDDED_SGW
 #define TASK_MME TASK_MME_APP
@@ -80,8 +84,7 @@ static uint32_t g_gtpv1u_teid = 0;
 //------------------------------------------------------------------------------
 uint32_t sgw_get_new_s1u_teid(void)
 {
-  __sync_fetch_and_add(&g_gtpv1u_teid, 1);
-  return g_gtpv1u_teid;
+  return gtpv1u_teid_alloc(sgw_app.s1u_teid_pool, time(NULL));
 }
 
 //------------------------------------------------------------------------------
@@ -133,8 +136,11 @@ int sgw_handle_create_session_request(
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
   }
 
-  new_endpoint_p = sgw_cm_create_s11_tunnel(
-    session_req_pP->sender_fteid_for_cp.teid, sgw_get_new_S11_tunnel_id());
+  teid_t s11_teid = sgw_get_new_S11_tunnel_id();
+  if (s11_teid != GTPV1U_TEID_INVALID) {
+    new_endpoint_p = sgw_cm_create_s11_tunnel(
+      session_req_pP->sender_fteid_for_cp.teid, s11_teid);
+  }
 
   if (new_endpoint_p == NULL) {
     OAILOG_ERROR(
@@ -316,12 +322,26 @@ int sgw_handle_create_session_request(
        * asynchronously through sgw_handle_s5_create_bearer_response()
        */
       MessageDef *message_p = NULL;
+      teid_t s1u_teid = sgw_get_new_s1u_teid();
+
+      if (s1u_teid == GTPV1U_TEID_INVALID) {
+        increment_counter(
+          "spgw_create_session",
+          1,
+          2,
+          "result",
+          "failure",
+          "cause",
+          "s1u_teid_exhausted");
+        sgw_cm_remove_bearer_context_information(new_endpoint_p->local_teid);
+        sgw_cm_remove_s11_tunnel(new_endpoint_p->local_teid);
+        OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
+      }
       message_p =
         itti_alloc_new_message(TASK_PGW_APP, S5_CREATE_BEARER_REQUEST);
       message_p->ittiMsg.s5_create_bearer_request.context_teid =
         new_endpoint_p->local_teid;
-      message_p->ittiMsg.s5_create_bearer_request.S1u_teid =
-        sgw_get_new_s1u_teid();
+      message_p->ittiMsg.s5_create_bearer_request.S1u_teid = s1u_teid;
       message_p->ittiMsg.s5_create_bearer_request.eps_bearer_id =
         session_req_pP->bearer_contexts_to_be_created.bearer_contexts[0]
           .eps_bearer_id;
@@ -955,22 +975,19 @@ int sgw_handle_sgi_endpoint_updated(
 
       struct in_addr ue = {.s_addr = 0};
       ue.s_addr = eps_bearer_ctxt_p->paa.ipv4_address.s_addr;
+      sgw_paging_done(&ue);
+      Imsi_t imsi =
+        new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.imsi;
+      int tunnel_rv = RETURNok;
       if (spgw_config.pgw_config.use_gtp_kernel_module) {
-        Imsi_t imsi =
-          new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.imsi;
-        rv = gtp_tunnel_ops->add_tunnel(
+        tunnel_rv = gtp_tunnel_ops->add_tunnel(
           ue,
           enb,
           eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up,
           eps_bearer_ctxt_p->enb_teid_S1u,
           imsi);
-        if (rv < 0) {
-          OAILOG_ERROR(LOG_SPGW_APP, "ERROR in setting up TUNNEL err=%d\n", rv);
-        }
       }
 
-      Imsi_t imsi =
-        new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.imsi;
       /* UE is switching back to EPS services after the CS Fallback
        * If Modify bearer Request is received in UE suspended mode, Resume PS data
        */
@@ -982,16 +999,28 @@ int sgw_handle_sgi_endpoint_updated(
           OAILOG_ERROR(
             LOG_SPGW_APP, "ERROR in forwarding data on TUNNEL err=%d\n", rv);
         }
-      } else {
-        rv = gtp_tunnel_ops->add_tunnel(
+      } else if (!spgw_config.pgw_config.use_gtp_kernel_module) {
+        // The kernel tunnel is already added, a second add would fail
+        tunnel_rv = gtp_tunnel_ops->add_tunnel(
           ue,
           enb,
           eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up,
           eps_bearer_ctxt_p->enb_teid_S1u,
           imsi);
-        if (rv < 0) {
-          OAILOG_ERROR(LOG_SPGW_APP, "ERROR in setting up TUNNEL err=%d\n", rv);
-        }
+      }
+      if (tunnel_rv < 0) {
+        OAILOG_ERROR(
+          LOG_SPGW_APP, "ERROR in setting up TUNNEL err=%d\n", tunnel_rv);
+        // No user plane: the MME is not told the bearer was modified
+        sgw_release_all_enb_related_information(eps_bearer_ctxt_p);
+        modify_response_p->bearer_contexts_modified.num_bearer_context -= 1;
+        modify_response_p->bearer_contexts_marked_for_removal.bearer_contexts[0]
+          .eps_bearer_id = resp_pP->eps_bearer_id;
+        modify_response_p->bearer_contexts_marked_for_removal.bearer_contexts[0]
+          .cause.cause_value = SYSTEM_FAILURE;
+        modify_response_p->bearer_contexts_marked_for_removal
+          .num_bearer_context += 1;
+        modify_response_p->cause.cause_value = SYSTEM_FAILURE;
       }
     }
     // may be removed
@@ -1383,16 +1412,10 @@ int sgw_handle_delete_session_request(
 #if ENABLE_SDF_MARKING
             for (int sdfx = 0; sdfx < eps_bearer_ctxt_p->num_sdf; sdfx++) {
               if (eps_bearer_ctxt_p->sdf_id[sdfx]) {
-                bstring marking_command = bformat(
-                  "iptables -D POSTROUTING -t mangle --out-interface gtp0 "
-                  "--dest %" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8
-                  "/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-                  NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr),
+                pgw_rules_del_bearer_mark(
+                  eps_bearer_ctxt_p->paa.ipv4_address,
                   eps_bearer_ctxt_p->sdf_id[sdfx],
                   eps_bearer_ctxt_p->eps_bearer_id);
-                async_system_command(
-                  TASK_SPGW_APP, false, bdata(marking_command));
-                bdestroy_wrapper(&marking_command);
               }
             }
 #endif
@@ -1421,16 +1444,10 @@ int sgw_handle_delete_session_request(
 #if ENABLE_SDF_MARKING
           for (int sdfx = 0; sdfx < eps_bearer_ctxt_p->num_sdf; sdfx++) {
             if (eps_bearer_ctxt_p->sdf_id[sdfx]) {
-              bstring marking_command = bformat(
-                "iptables -D POSTROUTING -t mangle --out-interface gtp0 --dest "
-                "%" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8
-                "/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-                NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr),
+              pgw_rules_del_bearer_mark(
+                eps_bearer_ctxt_p->paa.ipv4_address,
                 eps_bearer_ctxt_p->sdf_id[sdfx],
                 eps_bearer_ctxt_p->eps_bearer_id);
-              async_system_command(
-                TASK_SPGW_APP, false, bdata(marking_command));
-              bdestroy_wrapper(&marking_command);
             }
           }
 #endif
@@ -1548,17 +1565,46 @@ static void sgw_release_all_enb_related_information(
    downlink packets received for the UE and initiating the "Network Triggered Service Request" procedure,
    described in clause 5.3.4.3, if downlink packets arrive for the UE.
 */
+//------------------------------------------------------------------------------
+static gtpv2c_cause_value_t _sgw_release_access_bearers(
+  const teid_t sgw_s11_teid,
+  teid_t *const mme_s11_teid)
+{
+  s_plus_p_gw_eps_bearer_context_information_t *ctx_p = NULL;
+
+  if (
+    hashtable_ts_get(
+      sgw_app.s11_bearer_context_information_hashtable,
+      sgw_s11_teid,
+      (void **) &ctx_p) != HASH_TABLE_OK) {
+    *mme_s11_teid = 0;
+    return CONTEXT_NOT_FOUND;
+  }
+  *mme_s11_teid = ctx_p->sgw_eps_bearer_context_information.mme_teid_S11;
+  //#pragma message  "TODO Here the release (sgw_handle_release_access_bearers_request)"
+  // TODO iterator
+  for (int ebx = 0; ebx < BEARERS_PER_UE; ebx++) {
+    sgw_eps_bearer_ctxt_t *eps_bearer_ctxt =
+      ctx_p->sgw_eps_bearer_context_information.pdn_connection
+        .sgw_eps_bearers_array[ebx];
+    if (eps_bearer_ctxt) {
+      sgw_release_all_enb_related_information(eps_bearer_ctxt);
+    }
+  }
+  // TODO The S-GW starts buffering downlink packets received for the UE
+  // (set target on GTPUSP to order the buffering)
+  return REQUEST_ACCEPTED;
+}
+
 //------------------------------------------------------------------------------
 int sgw_handle_release_access_bearers_request(
   const itti_s11_release_access_bearers_request_t
     *const release_access_bearers_req_pP)
 {
   OAILOG_FUNC_IN(LOG_SPGW_APP);
-  hashtable_rc_t hash_rc = HASH_TABLE_OK;
   itti_s11_release_access_bearers_response_t *release_access_bearers_resp_p =
     NULL;
   MessageDef *message_p = NULL;
-  s_plus_p_gw_eps_bearer_context_information_t *ctx_p = NULL;
   int rv = RETURNok;
 
   OAILOG_DEBUG(LOG_SPGW_APP, "Release Access Bearer Request Received in SGW\n");
@@ -1573,28 +1619,13 @@ int sgw_handle_release_access_bearers_request(
   release_access_bearers_resp_p =
     &message_p->ittiMsg.s11_release_access_bearers_response;
 
-  hash_rc = hashtable_ts_get(
-    sgw_app.s11_bearer_context_information_hashtable,
-    release_access_bearers_req_pP->teid,
-    (void **) &ctx_p);
+  release_access_bearers_resp_p->cause.cause_value =
+    _sgw_release_access_bearers(
+      release_access_bearers_req_pP->teid,
+      &release_access_bearers_resp_p->teid);
 
-  if (HASH_TABLE_OK == hash_rc) {
-    release_access_bearers_resp_p->cause.cause_value = REQUEST_ACCEPTED;
-    release_access_bearers_resp_p->teid =
-      ctx_p->sgw_eps_bearer_context_information.mme_teid_S11;
+  if (release_access_bearers_resp_p->cause.cause_value == REQUEST_ACCEPTED) {
     release_access_bearers_resp_p->trxn = release_access_bearers_req_pP->trxn;
-    //#pragma message  "TODO Here the release (sgw_handle_release_access_bearers_request)"
-    // TODO iterator
-    for (int ebx = 0; ebx < BEARERS_PER_UE; ebx++) {
-      sgw_eps_bearer_ctxt_t *eps_bearer_ctxt =
-        ctx_p->sgw_eps_bearer_context_information.pdn_connection
-          .sgw_eps_bearers_array[ebx];
-      if (eps_bearer_ctxt) {
-        sgw_release_all_enb_related_information(eps_bearer_ctxt);
-      }
-    }
-    // TODO The S-GW starts buffering downlink packets received for the UE
-    // (set target on GTPUSP to order the buffering)
     MSC_LOG_TX_MESSAGE(
       MSC_SP_GWAPP_MME,
       MSC_S11_MME,
@@ -1608,8 +1639,6 @@ int sgw_handle_release_access_bearers_request(
     OAILOG_DEBUG(LOG_SPGW_APP, "Release Access Bearer Respone sent to SGW\n");
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
   } else {
-    release_access_bearers_resp_p->cause.cause_value = CONTEXT_NOT_FOUND;
-    release_access_bearers_resp_p->teid = 0;
     MSC_LOG_TX_MESSAGE(
       MSC_SP_GWAPP_MME,
       MSC_S11_MME,
@@ -1621,6 +1650,44 @@ int sgw_handle_release_access_bearers_request(
   }
 }
 
+//------------------------------------------------------------------------------
+int sgw_handle_release_access_bearers_bulk_request(
+  const itti_s11_release_access_bearers_bulk_request_t *const bulk_req_p)
+{
+  OAILOG_FUNC_IN(LOG_SPGW_APP);
+  itti_s11_release_access_bearers_bulk_response_t *bulk_resp_p = NULL;
+  MessageDef *message_p = NULL;
+  int rv = RETURNok;
+
+  OAILOG_DEBUG(
+    LOG_SPGW_APP,
+    "Release Access Bearer Bulk Request Received in SGW for %u UEs\n",
+    bulk_req_p->num_requests);
+
+  message_p = itti_alloc_new_message(
+    TASK_SPGW_APP, S11_RELEASE_ACCESS_BEARERS_BULK_RESPONSE);
+
+  if (message_p == NULL) {
+    OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
+  }
+
+  bulk_resp_p = &message_p->ittiMsg.s11_release_access_bearers_bulk_response;
+  bulk_resp_p->num_responses = bulk_req_p->num_requests;
+  for (int i = 0; i < bulk_req_p->num_requests; i++) {
+    bulk_resp_p->responses[i].cause.cause_value = _sgw_release_access_bearers(
+      bulk_req_p->requests[i].teid, &bulk_resp_p->responses[i].teid);
+  }
+  MSC_LOG_TX_MESSAGE(
+    MSC_SP_GWAPP_MME,
+    MSC_S11_MME,
+    NULL,
+    0,
+    "0 S11_RELEASE_ACCESS_BEARERS_BULK_RESPONSE num %u",
+    bulk_resp_p->num_responses);
+  rv = itti_send_msg_to_task(TASK_MME, INSTANCE_DEFAULT, message_p);
+  OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
+}
+
 //-------------------------------------------------------------------------
 int sgw_handle_s5_create_bearer_response(
   const itti_s5_create_bearer_response_t *const bearer_resp_p)
@@ -1903,6 +1970,12 @@ int sgw_no_pcef_create_dedicated_bearer(s11_teid_t teid)
       eps_bearer_ctxt_p->tft.numberofpacketfilters = number_of_packet_filters;
 
       eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up = sgw_get_new_s1u_teid();
+      if (
+        eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up == GTPV1U_TEID_INVALID) {
+        free_wrapper((void **) &eps_bearer_ctxt_p);
+        itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
+        OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
+      }
       eps_bearer_ctxt_p->s_gw_ip_address_S1u_S12_S4_up.pdn_type = IPv4;
       eps_bearer_ctxt_p->s_gw_ip_address_S1u_S12_S4_up.address.ipv4_address
         .s_addr = sgw_app.sgw_ip_address_S1u_S12_S4_up.s_addr;
@@ -1967,6 +2040,29 @@ int sgw_no_pcef_create_dedicated_bearer(s11_teid_t teid)
   OAILOG_FUNC_RETURN(LOG_SPGW_APP, rc);
 }
 
+//------------------------------------------------------------------------------
+// Releases a dedicated bearer the MME did not set up, with its S1-U TEID
+static void sgw_release_pending_bearer(
+  pgw_ni_cbr_proc_t *const pgw_ni_cbr_proc,
+  const teid_t s1u_teid)
+{
+  struct sgw_eps_bearer_entry_wrapper_s *sgw_eps_bearer_entry_wrapper = NULL;
+
+  LIST_FOREACH(
+    sgw_eps_bearer_entry_wrapper, pgw_ni_cbr_proc->pending_eps_bearers, entries)
+  {
+    if (
+      sgw_eps_bearer_entry_wrapper->sgw_eps_bearer_entry
+        ->s_gw_teid_S1u_S12_S4_up == s1u_teid) {
+      LIST_REMOVE(sgw_eps_bearer_entry_wrapper, entries);
+      sgw_free_sgw_eps_bearer_context(
+        &sgw_eps_bearer_entry_wrapper->sgw_eps_bearer_entry);
+      free_wrapper((void **) &sgw_eps_bearer_entry_wrapper);
+      return;
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 int sgw_handle_create_bearer_response(
   const itti_s11_create_bearer_response_t *const create_bearer_response_pP)
@@ -2070,17 +2166,14 @@ int sgw_handle_create_bearer_response(
                         eps_bearer_ctxt_p->eps_bearer_id,
                         eps_bearer_ctxt_p->enb_teid_S1u,
                         eps_bearer_ctxt_p->s_gw_teid_S1u_S12_S4_up);
+                      sgw_release_all_enb_related_information(
+                        eps_bearer_ctxt_p);
                     } else {
 #if ENABLE_SDF_MARKING
-                      bstring marking_command = bformat(
-                        "iptables -A POSTROUTING -t mangle --out-interface "
-                        "gtp0 --dest %" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8
-                        "/32 -m mark --mark 0x%04X -j MARK --set-mark %d",
-                        NIPADDR(eps_bearer_ctxt_p->paa.ipv4_address.s_addr),
+                      pgw_rules_add_bearer_mark(
+                        eps_bearer_ctxt_p->paa.ipv4_address,
                         pgw_ni_cbr_proc->sdf_id,
                         eps_bearer_ctxt_p->eps_bearer_id);
-                      async_system_command(
-                        TASK_SPGW_APP, false, bdata(marking_command));
 
                       AssertFatal(
                         (TRAFFIC_FLOW_TEMPLATE_NB_PACKET_FILTERS_MAX >
@@ -2094,8 +2187,6 @@ int sgw_handle_create_bearer_response(
                           pgw_ni_cbr_proc->sdf_id;
                         eps_bearer_ctxt_p->num_sdf += 1;
                       }
-
-                      bdestroy_wrapper(&marking_command);
 #endif
                       OAILOG_INFO(
                         LOG_SPGW_APP,
@@ -2117,15 +2208,7 @@ int sgw_handle_create_bearer_response(
 
                 break;
               }
-            }
-            sgw_eps_bearer_entry_wrapper =
-              LIST_FIRST(pgw_ni_cbr_proc->pending_eps_bearers);
-            if (!sgw_eps_bearer_entry_wrapper) {
-              LIST_INIT(pgw_ni_cbr_proc->pending_eps_bearers);
-              free_wrapper((void **) &pgw_ni_cbr_proc->pending_eps_bearers);
-
-              LIST_REMOVE((pgw_base_proc_t *) pgw_ni_cbr_proc, entries);
-              pgw_free_procedure_create_bearer(&pgw_ni_cbr_proc);
+              sgw_eps_bearer_entry_wrapper = sgw_eps_bearer_entry_wrapper2;
             }
           }
         } else {
@@ -2133,8 +2216,31 @@ int sgw_handle_create_bearer_response(
             LOG_SPGW_APP,
             "Creation of bearer " TEID_FMT "\n",
             create_bearer_response_pP->teid);
+          pgw_ni_cbr_proc_t *pgw_ni_cbr_proc =
+            pgw_get_procedure_create_bearer(ctx_p);
+          if (pgw_ni_cbr_proc) {
+            sgw_release_pending_bearer(
+              pgw_ni_cbr_proc,
+              create_bearer_response_pP->bearer_contexts.bearer_contexts[i]
+                .s1u_sgw_fteid.teid);
+          }
         }
       }
+      pgw_ni_cbr_proc_t *pgw_ni_cbr_proc =
+        pgw_get_procedure_create_bearer(ctx_p);
+      if (
+        pgw_ni_cbr_proc &&
+        LIST_EMPTY(pgw_ni_cbr_proc->pending_eps_bearers)) {
+        LIST_REMOVE((pgw_base_proc_t *) pgw_ni_cbr_proc, entries);
+        pgw_free_procedure_create_bearer(&pgw_ni_cbr_proc);
+      }
+    } else {
+      // Rejected as a whole, the bearers still pending are released
+      OAILOG_DEBUG(
+        LOG_SPGW_APP,
+        "Creation of bearers rejected " TEID_FMT "\n",
+        create_bearer_response_pP->teid);
+      pgw_delete_procedure_create_bearer(ctx_p);
     }
   } else {
     // context not found
@@ -2207,3 +2313,123 @@ int sgw_handle_modify_ue_ambr_request(
 
   OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNok);
 }
+
+typedef struct sgw_gtp_tunnel_owner_s {
+  teid_t s1u_teid;
+  s_plus_p_gw_eps_bearer_context_information_t *ctx_p;
+  sgw_eps_bearer_ctxt_t *eps_bearer_ctxt;
+} sgw_gtp_tunnel_owner_t;
+
+//------------------------------------------------------------------------------
+static bool sgw_find_gtp_tunnel_owner_cb(
+  __attribute__((unused)) const hash_key_t keyP,
+  void *const elementP,
+  void *parameterP,
+  __attribute__((unused)) void **resultP)
+{
+  s_plus_p_gw_eps_bearer_context_information_t *ctx_p =
+    (s_plus_p_gw_eps_bearer_context_information_t *) elementP;
+  sgw_gtp_tunnel_owner_t *owner = (sgw_gtp_tunnel_owner_t *) parameterP;
+
+  for (int ebx = 0; ebx < BEARERS_PER_UE; ebx++) {
+    sgw_eps_bearer_ctxt_t *eps_bearer_ctxt =
+      ctx_p->sgw_eps_bearer_context_information.pdn_connection
+        .sgw_eps_bearers_array[ebx];
+    if (
+      eps_bearer_ctxt &&
+      (eps_bearer_ctxt->s_gw_teid_S1u_S12_S4_up == owner->s1u_teid)) {
+      owner->ctx_p = ctx_p;
+      owner->eps_bearer_ctxt = eps_bearer_ctxt;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Failure of a GTP tunnel change acknowledged after its handler returned,
+ * additions are waited for by their handler and answered to the MME there.
+ * Failures are rare: the bearer owning the tunnel is looked up by its S1-U
+ * TEID rather than indexed for every tunnel.
+ */
+void sgw_handle_gtp_tunnel_failure(
+  bool add,
+  struct in_addr ue,
+  uint32_t i_tei,
+  uint32_t o_tei,
+  int error)
+{
+  sgw_gtp_tunnel_owner_t owner = {.s1u_teid = i_tei};
+
+  increment_counter(
+    "spgw_gtp_tunnel",
+    1,
+    2,
+    "operation",
+    add ? "add" : "delete",
+    "result",
+    "failure");
+  hashtable_ts_apply_callback_on_elements(
+    sgw_app.s11_bearer_context_information_hashtable,
+    sgw_find_gtp_tunnel_owner_cb,
+    &owner,
+    NULL);
+  if (!owner.eps_bearer_ctxt) {
+    // Deletions usually come with the removal of the bearer
+    OAILOG_WARNING(
+      LOG_SPGW_APP,
+      "Failed to %s GTP tunnel of UE %s, S1-U TEID %u (no bearer): %s\n",
+      add ? "add" : "delete",
+      inet_ntoa(ue),
+      i_tei,
+      strerror(error));
+    return;
+  }
+  OAILOG_ERROR(
+    LOG_SPGW_APP,
+    "Failed to %s GTP tunnel of IMSI %s EBI %u, S1-U TEID %u, eNB TEID %u: "
+    "%s\n",
+    add ? "add" : "delete",
+    (char *) owner.ctx_p->sgw_eps_bearer_context_information.imsi.digit,
+    owner.eps_bearer_ctxt->eps_bearer_id,
+    i_tei,
+    o_tei,
+    strerror(error));
+  // The kernel state of the tunnel is unknown, the S1-U path is not usable
+  sgw_release_all_enb_related_information(owner.eps_bearer_ctxt);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Usage of the tunnels since the previous poll. Only the totals and the
+ * number of idle bearers are exported, per bearer metrics would not scale.
+ */
+void sgw_handle_gtp_tunnel_usage(
+  const struct gtp_tunnel_usage *usages,
+  uint32_t nb_usages)
+{
+  uint64_t ul_bytes = 0;
+  uint64_t dl_bytes = 0;
+  uint32_t nb_idle = 0;
+
+  for (uint32_t i = 0; i < nb_usages; i++) {
+    ul_bytes += usages[i].ul_bytes;
+    dl_bytes += usages[i].dl_bytes;
+    if (usages[i].idle_sec >= SGW_IDLE_BEARER_SEC) {
+      nb_idle++;
+    }
+  }
+  increment_counter(
+    "spgw_gtp_tunnel_bytes", ul_bytes, 1, "direction", "uplink");
+  increment_counter(
+    "spgw_gtp_tunnel_bytes", dl_bytes, 1, "direction", "downlink");
+  set_gauge("spgw_idle_bearers", nb_idle, NO_LABELS);
+  OAILOG_DEBUG(
+    LOG_SPGW_APP,
+    "Usage of %u GTP tunnels: %" PRIu64 " bytes up, %" PRIu64
+    " bytes down, %u idle\n",
+    nb_usages,
+    ul_bytes,
+    dl_bytes,
+    nb_idle);
+}
@@ -29,6 +29,8 @@
 #ifndef FILE_SGW_HANDLERS_SEEN
 #define FILE_SGW_HANDLERS_SEEN
 
+#include "gtpv1u.h"
+
 int sgw_handle_create_session_request(
   const itti_s11_create_session_request_t *const session_req_p);
 int sgw_handle_sgi_endpoint_created(
@@ -48,6 +50,8 @@ int sgw_handle_delete_session_request(
 int sgw_handle_release_access_bearers_request(
   const itti_s11_release_access_bearers_request_t
     *const release_access_bearers_req_pP);
+int sgw_handle_release_access_bearers_bulk_request(
+  const itti_s11_release_access_bearers_bulk_request_t *const bulk_req_p);
 int sgw_handle_s5_create_bearer_response(
   const itti_s5_create_bearer_response_t *const bearer_resp_p);
 int sgw_handle_suspend_notification(
@@ -59,4 +63,13 @@ int sgw_handle_modify_ue_ambr_request(
   teid_t teid,
   bitrate_t mbr_ul,
   bitrate_t mbr_dl);
+void sgw_handle_gtp_tunnel_failure(
+  bool add,
+  struct in_addr ue,
+  uint32_t i_tei,
+  uint32_t o_tei,
+  int error);
+void sgw_handle_gtp_tunnel_usage(
+  const struct gtp_tunnel_usage *usages,
+  uint32_t nb_usages);
 #endif /* FILE_SGW_HANDLERS_SEEN */
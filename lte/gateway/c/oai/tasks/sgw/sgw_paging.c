@@ -21,23 +21,170 @@
 
 #include <netinet/ip.h>
 #include <arpa/inet.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "hashtable.h"
+#include "dynamic_memory_check.h"
 #include "intertask_interface.h"
 #include "log.h"
 #include "rpc_client.h"
+#include "service303.h"
 #include "sgw_paging.h"
 
+typedef struct sgw_paging_ue_s {
+  char imsi[IMSI_BCD_DIGITS_MAX + 1];
+  bool paging;
+  time_t paging_start;
+} sgw_paging_ue_t;
+
+// Written by the SPGW task, read by the OpenFlow controller thread
+static pthread_mutex_t sgw_paging_lock = PTHREAD_MUTEX_INITIALIZER;
+static hash_table_t *sgw_paging_ues = NULL; // key is the UE IP, host order
+
+//------------------------------------------------------------------------------
+int sgw_paging_init(const uint32_t size)
+{
+  bstring b = bfromcstr("sgw_paging_ue_ip2imsi_hashtable");
+
+  pthread_mutex_lock(&sgw_paging_lock);
+  if (!sgw_paging_ues) {
+    sgw_paging_ues = hashtable_create(size, NULL, free_wrapper, b);
+  }
+  pthread_mutex_unlock(&sgw_paging_lock);
+  bdestroy_wrapper(&b);
+  if (!sgw_paging_ues) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Failed to create the UE IP index\n");
+    return RETURNerror;
+  }
+  sgw_paging_ues->log_enabled = false;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void sgw_paging_exit(void)
+{
+  pthread_mutex_lock(&sgw_paging_lock);
+  if (sgw_paging_ues) {
+    hashtable_destroy(sgw_paging_ues);
+    sgw_paging_ues = NULL;
+  }
+  pthread_mutex_unlock(&sgw_paging_lock);
+}
+
+//------------------------------------------------------------------------------
+void sgw_paging_add_ue(const struct in_addr *ue_ip, const char *imsi)
+{
+  sgw_paging_ue_t *ue = NULL;
+  hash_key_t key = ntohl(ue_ip->s_addr);
+
+  pthread_mutex_lock(&sgw_paging_lock);
+  if (sgw_paging_ues) {
+    if (HASH_TABLE_OK != hashtable_get(sgw_paging_ues, key, (void **) &ue)) {
+      ue = calloc(1, sizeof(*ue));
+      if (ue && HASH_TABLE_OK != hashtable_insert(sgw_paging_ues, key, ue)) {
+        free_wrapper((void **) &ue);
+      }
+    }
+    if (ue) {
+      // The address may have been given to another UE
+      strncpy(ue->imsi, imsi, IMSI_BCD_DIGITS_MAX);
+      ue->imsi[IMSI_BCD_DIGITS_MAX] = '\0';
+      ue->paging = false;
+    }
+  }
+  pthread_mutex_unlock(&sgw_paging_lock);
+}
+
+//------------------------------------------------------------------------------
+void sgw_paging_remove_ue(const struct in_addr *ue_ip)
+{
+  pthread_mutex_lock(&sgw_paging_lock);
+  if (sgw_paging_ues) {
+    hashtable_free(sgw_paging_ues, ntohl(ue_ip->s_addr));
+  }
+  pthread_mutex_unlock(&sgw_paging_lock);
+}
+
+//------------------------------------------------------------------------------
+sgw_paging_trigger_t sgw_paging_trigger(
+  const struct in_addr *ue_ip,
+  const time_t now,
+  char imsi[IMSI_BCD_DIGITS_MAX + 1])
+{
+  sgw_paging_ue_t *ue = NULL;
+  sgw_paging_trigger_t trigger = SGW_PAGING_UNKNOWN_UE;
+
+  pthread_mutex_lock(&sgw_paging_lock);
+  if (
+    sgw_paging_ues &&
+    HASH_TABLE_OK ==
+      hashtable_get(sgw_paging_ues, ntohl(ue_ip->s_addr), (void **) &ue)) {
+    if (ue->paging && (now - ue->paging_start) < SGW_PAGING_OUTSTANDING_SEC) {
+      trigger = SGW_PAGING_OUTSTANDING;
+    } else {
+      ue->paging = true;
+      ue->paging_start = now;
+      memcpy(imsi, ue->imsi, sizeof(ue->imsi));
+      trigger = SGW_PAGING_SEND;
+    }
+  }
+  pthread_mutex_unlock(&sgw_paging_lock);
+  return trigger;
+}
+
+//------------------------------------------------------------------------------
+void sgw_paging_done(const struct in_addr *ue_ip)
+{
+  sgw_paging_ue_t *ue = NULL;
+
+  pthread_mutex_lock(&sgw_paging_lock);
+  if (
+    sgw_paging_ues &&
+    HASH_TABLE_OK ==
+      hashtable_get(sgw_paging_ues, ntohl(ue_ip->s_addr), (void **) &ue)) {
+    ue->paging = false;
+  }
+  pthread_mutex_unlock(&sgw_paging_lock);
+}
+
+//------------------------------------------------------------------------------
 int sgw_send_paging_request(const struct in_addr *dest_ip)
 {
-  char *imsi;
-  int ret = get_subscriber_id_from_ipv4(dest_ip, &imsi);
-  if (ret > 0) {
-    char ip_str[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &(dest_ip->s_addr), ip_str, INET_ADDRSTRLEN);
-    OAILOG_ERROR(
-      TASK_SPGW_APP, "Subscriber could not be found for ip %s\n", ip_str);
-    return ret;
+  char imsi[IMSI_BCD_DIGITS_MAX + 1] = {0};
+  sgw_paging_trigger_t trigger = SGW_PAGING_UNKNOWN_UE;
+
+  increment_counter("spgw_paging_packet_in", 1, NO_LABELS);
+  trigger = sgw_paging_trigger(dest_ip, time(NULL), imsi);
+  if (trigger == SGW_PAGING_OUTSTANDING) {
+    increment_counter(
+      "spgw_paging_request", 1, 1, "result", "already_paging");
+    return RETURNok;
+  }
+  if (trigger == SGW_PAGING_UNKNOWN_UE) {
+    // Address not allocated through this SPGW, ask mobilityd
+    char *subscriber_id = NULL;
+    int ret = get_subscriber_id_from_ipv4(dest_ip, &subscriber_id);
+    if (ret > 0) {
+      char ip_str[INET_ADDRSTRLEN];
+      inet_ntop(AF_INET, &(dest_ip->s_addr), ip_str, INET_ADDRSTRLEN);
+      OAILOG_ERROR(
+        TASK_SPGW_APP, "Subscriber could not be found for ip %s\n", ip_str);
+      increment_counter(
+        "spgw_paging_request", 1, 1, "result", "subscriber_not_found");
+      return ret;
+    }
+    sgw_paging_add_ue(dest_ip, subscriber_id);
+    free(subscriber_id);
+    if (sgw_paging_trigger(dest_ip, time(NULL), imsi) != SGW_PAGING_SEND) {
+      increment_counter(
+        "spgw_paging_request", 1, 1, "result", "already_paging");
+      return RETURNok;
+    }
   }
   OAILOG_DEBUG(TASK_SPGW_APP, "Paging procedure initiated for IMSI%s\n", imsi);
   MessageDef *message_p = NULL;
@@ -47,8 +194,7 @@ int sgw_send_paging_request(const struct in_addr *dest_ip)
   paging_request_p = &message_p->ittiMsg.s11_paging_request;
   memset((void *) paging_request_p, 0, sizeof(itti_s11_paging_request_t));
   paging_request_p->imsi = strdup(imsi);
-  free(imsi);
+  increment_counter("spgw_paging_request", 1, 1, "result", "sent");
 
-  ret = itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
-  return ret;
+  return itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
 }
@@ -21,6 +21,49 @@
 #ifndef FILE_SGW_PAGING_SEEN
 #define FILE_SGW_PAGING_SEEN
 #include <netinet/ip.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "3gpp_23.003.h"
+
+/*
+ * Time a paging procedure is considered outstanding: the downlink data of the
+ * UE does not trigger any other paging meanwhile. Same as the hard timeout of
+ * the clamping flow of the paging application, after which a UE that did not
+ * answer is paged again.
+ */
+#define SGW_PAGING_OUTSTANDING_SEC 30
+
+typedef enum sgw_paging_trigger_e {
+  SGW_PAGING_SEND = 0,     // page the UE
+  SGW_PAGING_OUTSTANDING,  // the UE is being paged
+  SGW_PAGING_UNKNOWN_UE    // no UE uses the IP address in the index
+} sgw_paging_trigger_t;
+
+/*
+ * Index of the UE IPv4 addresses allocated by the SPGW to the IMSI of their
+ * UE, with the paging state of the UE. It is fed on PDN connection setup and
+ * release and read by the OpenFlow controller thread on downlink data.
+ */
+int sgw_paging_init(const uint32_t size);
+
+void sgw_paging_exit(void);
+
+void sgw_paging_add_ue(const struct in_addr *ue_ip, const char *imsi);
+
+void sgw_paging_remove_ue(const struct in_addr *ue_ip);
+
+/*
+ * Downlink data for an idle UE: returns SGW_PAGING_SEND and the IMSI of the
+ * UE if no paging procedure of the UE is outstanding at now, and starts one.
+ */
+sgw_paging_trigger_t sgw_paging_trigger(
+  const struct in_addr *ue_ip,
+  const time_t now,
+  char imsi[IMSI_BCD_DIGITS_MAX + 1]);
+
+// The UE is connected again, its paging procedure is over
+void sgw_paging_done(const struct in_addr *ue_ip);
 
 int sgw_send_paging_request(const struct in_addr *dest_ip);
 
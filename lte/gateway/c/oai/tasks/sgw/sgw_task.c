@@ -48,6 +48,7 @@
 #include "common_defs.h"
 #include "intertask_interface.h"
 #include "itti_free_defined_msg.h"
+#include "timer.h"
 #include "sgw_ie_defs.h"
 #include "3gpp_23.401.h"
 #include "mme_config.h"
@@ -56,11 +57,15 @@
 #include "sgw.h"
 #include "spgw_config.h"
 #include "pgw_ue_ip_address_alloc.h"
+#include "sgw_paging.h"
+#include "pgw_rules.h"
+#include "gtpv1u.h"
 
 spgw_config_t spgw_config;
 sgw_app_t sgw_app;
 
 extern __pid_t g_pid;
+extern const struct gtp_tunnel_ops *gtp_tunnel_ops;
 
 static void sgw_exit(void);
 
@@ -72,7 +77,22 @@ static void *sgw_intertask_interface(void *args_p)
   while (1) {
     MessageDef *received_message_p = NULL;
 
-    itti_receive_msg(TASK_SPGW_APP, &received_message_p);
+    itti_try_receive_msg(TASK_SPGW_APP, &received_message_p);
+    if (!received_message_p) {
+      // Queue drained: push the rule and tunnel changes handled so far
+      pgw_rules_commit();
+      if (gtp_tunnel_ops->commit) {
+        gtp_tunnel_ops->commit();
+      }
+      itti_receive_msg(TASK_SPGW_APP, &received_message_p);
+      if (!received_message_p) {
+        // Woken up by the acknowledgements of the tunnel changes
+        if (gtp_tunnel_ops->process_acks) {
+          gtp_tunnel_ops->process_acks();
+        }
+        continue;
+      }
+    }
 
     switch (ITTI_MSG_ID(received_message_p)) {
       case GTPV1U_CREATE_TUNNEL_RESP: {
@@ -122,6 +142,11 @@ static void *sgw_intertask_interface(void *args_p)
           &received_message_p->ittiMsg.s11_release_access_bearers_request);
       } break;
 
+      case S11_RELEASE_ACCESS_BEARERS_BULK_REQUEST: {
+        sgw_handle_release_access_bearers_bulk_request(
+          &received_message_p->ittiMsg.s11_release_access_bearers_bulk_request);
+      } break;
+
       case S11_SUSPEND_NOTIFICATION: {
         sgw_handle_suspend_notification(
           &received_message_p->ittiMsg.s11_suspend_notification);
@@ -137,6 +162,14 @@ static void *sgw_intertask_interface(void *args_p)
           &received_message_p->ittiMsg.sgi_create_end_point_response);
       } break;
 
+      case TIMER_HAS_EXPIRED: {
+        if (
+          received_message_p->ittiMsg.timer_has_expired.timer_id ==
+          sgw_app.tunnel_usage_timer_id) {
+          gtp_tunnel_ops->poll_usage(sgw_handle_gtp_tunnel_usage);
+        }
+      } break;
+
       case SGI_UPDATE_ENDPOINT_RESPONSE: {
         sgw_handle_sgi_endpoint_updated(
           &received_message_p->ittiMsg.sgi_update_end_point_response);
@@ -174,13 +207,36 @@ int sgw_init(spgw_config_t *spgw_config_pP)
 {
   OAILOG_DEBUG(LOG_SPGW_APP, "Initializing SPGW-APP  task interface\n");
 
+  // Before GTPv1-U, the OpenFlow controller looks up UEs to page in it
+  if (sgw_paging_init(4096) != RETURNok) {
+    OAILOG_ALERT(LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
+    return RETURNerror;
+  }
+
   if (gtpv1u_init(spgw_config_pP) < 0) {
     OAILOG_ALERT(LOG_SPGW_APP, "Initializing GTPv1-U ERROR\n");
     return RETURNerror;
   }
 
+  // Tunnel changes are acknowledged asynchronously, on the SPGW task
+  if (gtp_tunnel_ops->get_ack_fd && (gtp_tunnel_ops->get_ack_fd() >= 0)) {
+    gtp_tunnel_ops->set_failure_cb(sgw_handle_gtp_tunnel_failure);
+    itti_subscribe_event_fd(TASK_SPGW_APP, gtp_tunnel_ops->get_ack_fd());
+  }
+
   pgw_ip_address_pool_init();
 
+  sgw_app.s11_teid_pool = gtpv1u_teid_pool_create(
+    (gtpv1u_teid_range_t){.first = 1, .size = SGW_S11_TEID_POOL_SIZE},
+    SGW_TEID_QUARANTINE_SEC);
+  sgw_app.s1u_teid_pool = gtpv1u_teid_pool_create(
+    (gtpv1u_teid_range_t){.first = 1, .size = SGW_S1U_TEID_POOL_SIZE},
+    SGW_TEID_QUARANTINE_SEC);
+  if (!sgw_app.s11_teid_pool || !sgw_app.s1u_teid_pool) {
+    OAILOG_ALERT(LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
+    return RETURNerror;
+  }
+
   bstring b = bfromcstr("sgw_s11teid2mme_hashtable");
   sgw_app.s11teid2mme_hashtable = hashtable_ts_create(512, NULL, NULL, b);
   btrunc(b, 0);
@@ -230,12 +286,38 @@ int sgw_init(spgw_config_t *spgw_config_pP)
     return RETURNerror;
   }
 
+#if ENABLE_SDF_MARKING
+  if (
+    RETURNerror == pgw_rules_init(
+                     spgw_config_pP->pgw_config.use_nftables_rules,
+                     PGW_RULES_GTP_IFNAME)) {
+    return RETURNerror;
+  }
+#endif
+
   if (itti_create_task(TASK_SPGW_APP, &sgw_intertask_interface, NULL) < 0) {
     perror("pthread_create");
     OAILOG_ALERT(LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
     return RETURNerror;
   }
 
+  // Usage and idle bearers, from the counters of the tunnels
+  sgw_app.tunnel_usage_timer_id = -1;
+  if (
+    gtp_tunnel_ops->poll_usage &&
+    (timer_setup(
+       SGW_TUNNEL_USAGE_POLL_SEC,
+       0,
+       TASK_SPGW_APP,
+       INSTANCE_DEFAULT,
+       TIMER_PERIODIC,
+       NULL,
+       0,
+       &sgw_app.tunnel_usage_timer_id) < 0)) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Failed to start the tunnel usage timer\n");
+    sgw_app.tunnel_usage_timer_id = -1;
+  }
+
   FILE *fp = NULL;
   bstring filename = bformat("/tmp/spgw_%d.status", g_pid);
   fp = fopen(bdata(filename), "w+");
@@ -251,6 +333,15 @@ int sgw_init(spgw_config_t *spgw_config_pP)
 //------------------------------------------------------------------------------
 static void sgw_exit(void)
 {
+  if (sgw_app.tunnel_usage_timer_id != -1) {
+    timer_remove(sgw_app.tunnel_usage_timer_id, NULL);
+    sgw_app.tunnel_usage_timer_id = -1;
+  }
+  // GTPv1-U may still flush tunnel changes after the bearer contexts are gone
+  if (gtp_tunnel_ops->set_failure_cb) {
+    gtp_tunnel_ops->set_failure_cb(NULL);
+  }
+  pgw_rules_exit();
   if (sgw_app.s11teid2mme_hashtable) {
     hashtable_ts_destroy(sgw_app.s11teid2mme_hashtable);
   }
@@ -260,4 +351,8 @@ static void sgw_exit(void)
   if (sgw_app.s11_bearer_context_information_hashtable) {
     hashtable_ts_destroy(sgw_app.s11_bearer_context_information_hashtable);
   }
+  // Released by the contexts above
+  gtpv1u_teid_pool_destroy(&sgw_app.s11_teid_pool);
+  gtpv1u_teid_pool_destroy(&sgw_app.s1u_teid_pool);
+  sgw_paging_exit();
 }
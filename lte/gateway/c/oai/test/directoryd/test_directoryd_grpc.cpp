@@ -0,0 +1,236 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <grpc++/grpc++.h>
+#include <gtest/gtest.h>
+
+#include "orc8r/protos/directoryd.grpc.pb.h"
+
+#include "DirectoryUpdateQueue.h"
+
+using grpc::ClientContext;
+using grpc::Server;
+using grpc::ServerBuilder;
+using grpc::ServerContext;
+using grpc::Status;
+using magma::orc8r::DeleteLocationRequest;
+using magma::orc8r::DirectoryService;
+using magma::orc8r::GetLocationRequest;
+using magma::orc8r::LocationRecord;
+using magma::orc8r::TableID;
+using magma::orc8r::UpdateDirectoryLocationRequest;
+using magma::orc8r::Void;
+using ::testing::Test;
+
+namespace magma {
+
+const std::chrono::milliseconds WINDOW(20);
+const std::chrono::milliseconds TIMEOUT(5000);
+
+/*
+ * directoryd keeping its records in memory, answering like the real one
+ */
+class FakeDirectoryService final : public DirectoryService::Service {
+ public:
+  FakeDirectoryService(): nb_updates_(0), nb_deletes_(0) {}
+
+  Status GetLocation(
+    ServerContext *context,
+    const GetLocationRequest *request,
+    LocationRecord *response) override
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = records_.find({request->table(), request->id()});
+    if (it == records_.end()) {
+      return Status(grpc::UNKNOWN, "No location for " + request->id());
+    }
+    response->set_location(it->second);
+    return Status::OK;
+  }
+
+  Status UpdateLocation(
+    ServerContext *context,
+    const UpdateDirectoryLocationRequest *request,
+    Void *response) override
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    nb_updates_++;
+    records_[{request->table(), request->id()}] = request->record().location();
+    return Status::OK;
+  }
+
+  Status DeleteLocation(
+    ServerContext *context,
+    const DeleteLocationRequest *request,
+    Void *response) override
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    nb_deletes_++;
+    if (!records_.erase({request->table(), request->id()})) {
+      return Status(grpc::UNKNOWN, "No location for " + request->id());
+    }
+    return Status::OK;
+  }
+
+  // Record left by a previous run of the MME
+  void add_record(table_id_t table, const std::string &id, std::string location)
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    records_[{table, id}] = std::move(location);
+  }
+
+  bool get_record(table_id_t table, const std::string &id, std::string *loc)
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = records_.find({table, id});
+    if (it == records_.end()) {
+      return false;
+    }
+    *loc = it->second;
+    return true;
+  }
+
+  int get_nb_updates()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    return nb_updates_;
+  }
+
+  int get_nb_deletes()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    return nb_deletes_;
+  }
+
+ private:
+  std::mutex lock_;
+  std::map<std::pair<int, std::string>, std::string> records_;
+  int nb_updates_;
+  int nb_deletes_;
+};
+
+/*
+ * Runs the fake directoryd on a local port and sends the queued updates to it
+ */
+class DirectorydGrpcTest : public Test {
+ protected:
+  virtual void SetUp()
+  {
+    int port = 0;
+    ServerBuilder builder;
+    builder.AddListeningPort(
+      "127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    ASSERT_TRUE(server_ != nullptr);
+    ASSERT_GT(port, 0);
+    stub_ = DirectoryService::NewStub(grpc::CreateChannel(
+      "127.0.0.1:" + std::to_string(port),
+      grpc::InsecureChannelCredentials()));
+  }
+
+  virtual void TearDown() { server_->Shutdown(); }
+
+  DirectoryUpdateQueue::Sender get_sender()
+  {
+    return [this](
+             const DirectoryUpdate &update,
+             std::function<void(bool ok)> done) {
+      // Answered from another thread, like the gRPC response loop
+      std::thread([this, update, done]() {
+        Status status;
+        {
+          ClientContext context;
+          Void response;
+          if (update.remove) {
+            DeleteLocationRequest request;
+            request.set_table(static_cast<TableID>(update.table));
+            request.set_id(update.id);
+            status = stub_->DeleteLocation(&context, request, &response);
+          } else {
+            UpdateDirectoryLocationRequest request;
+            request.set_table(static_cast<TableID>(update.table));
+            request.set_id(update.id);
+            request.mutable_record()->set_location(update.location);
+            status = stub_->UpdateLocation(&context, request, &response);
+          }
+        }
+        // The test may end once the last update is answered
+        done(status.ok());
+      }).detach();
+    };
+  }
+
+  FakeDirectoryService service_;
+  std::unique_ptr<Server> server_;
+  std::unique_ptr<DirectoryService::Stub> stub_;
+};
+
+TEST_F(DirectorydGrpcTest, test_add_remove_clears_previous_run)
+{
+  std::string location;
+
+  service_.add_record(IMSI_TO_HWID, "IMSI1", "GW_ID");
+  {
+    DirectoryUpdateQueue queue(get_sender(), WINDOW, 32);
+    // Attached and detached within the window
+    queue.update_location(IMSI_TO_HWID, "IMSI1", "enb1");
+    queue.delete_location(IMSI_TO_HWID, "IMSI1");
+    ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+  }
+  EXPECT_FALSE(service_.get_record(IMSI_TO_HWID, "IMSI1", &location));
+  EXPECT_EQ(service_.get_nb_updates(), 0);
+  EXPECT_EQ(service_.get_nb_deletes(), 1);
+}
+
+TEST_F(DirectorydGrpcTest, test_latest_location_stored)
+{
+  std::string location;
+
+  service_.add_record(HWID_TO_HOSTNAME, "IMSI2", "host");
+  {
+    DirectoryUpdateQueue queue(get_sender(), WINDOW, 32);
+    queue.update_location(IMSI_TO_HWID, "IMSI2", "GW_ID");
+    queue.update_location(IMSI_TO_HWID, "IMSI2", "enb1");
+    queue.update_location(IMSI_TO_HWID, "IMSI3", "GW_ID");
+    queue.update_location(IMSI_TO_HWID, "IMSI2", "enb2");
+    ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+  }
+  EXPECT_EQ(service_.get_nb_updates(), 2);
+  ASSERT_TRUE(service_.get_record(IMSI_TO_HWID, "IMSI2", &location));
+  EXPECT_EQ(location, "enb2");
+  ASSERT_TRUE(service_.get_record(IMSI_TO_HWID, "IMSI3", &location));
+  EXPECT_EQ(location, "GW_ID");
+  // Other tables are left alone
+  ASSERT_TRUE(service_.get_record(HWID_TO_HOSTNAME, "IMSI2", &location));
+  EXPECT_EQ(location, "host");
+}
+
+} // namespace magma
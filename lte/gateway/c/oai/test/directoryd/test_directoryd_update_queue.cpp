@@ -0,0 +1,298 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DirectoryUpdateQueue.h"
+
+using ::testing::Test;
+
+namespace magma {
+
+const std::chrono::milliseconds WINDOW(20);
+const std::chrono::milliseconds TIMEOUT(5000);
+
+/*
+ * Stands for directoryd: records the updates sent, and answers them either
+ * right away or when the test releases them
+ */
+class FakeDirectory {
+ public:
+  explicit FakeDirectory(bool hold = false):
+    hold_(hold),
+    nb_in_flight_(0),
+    max_in_flight_(0),
+    concurrent_same_key_(false)
+  {
+  }
+
+  DirectoryUpdateQueue::Sender get_sender()
+  {
+    return [this](
+             const DirectoryUpdate &update,
+             std::function<void(bool ok)> done) {
+      std::lock_guard<std::mutex> guard(lock_);
+      if (!in_flight_keys_.insert(update.id).second) {
+        concurrent_same_key_ = true;
+      }
+      sent_.push_back(update);
+      nb_in_flight_++;
+      if (nb_in_flight_ > max_in_flight_) {
+        max_in_flight_ = nb_in_flight_;
+      }
+      auto answer = [this, update, done]() {
+        {
+          std::lock_guard<std::mutex> guard(lock_);
+          in_flight_keys_.erase(update.id);
+          nb_in_flight_--;
+        }
+        done(true);
+      };
+      if (hold_) {
+        held_.push_back(answer);
+      } else {
+        // Answered from another thread, like the gRPC response loop
+        std::thread(answer).detach();
+      }
+    };
+  }
+
+  // Answers the held updates until none is sent anymore
+  void release_all(DirectoryUpdateQueue &queue)
+  {
+    while (!queue.wait_idle(std::chrono::milliseconds(10))) {
+      std::vector<std::function<void()>> held;
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        held.swap(held_);
+      }
+      for (auto &answer : held) {
+        answer();
+      }
+    }
+  }
+
+  std::vector<DirectoryUpdate> get_sent()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    return sent_;
+  }
+
+  size_t get_nb_held()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    return held_.size();
+  }
+
+  int get_max_in_flight()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    return max_in_flight_;
+  }
+
+  bool had_concurrent_same_key()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    return concurrent_same_key_;
+  }
+
+ private:
+  std::mutex lock_;
+  bool hold_;
+  std::vector<DirectoryUpdate> sent_;
+  std::vector<std::function<void()>> held_;
+  std::set<std::string> in_flight_keys_;
+  int nb_in_flight_;
+  int max_in_flight_;
+  bool concurrent_same_key_;
+};
+
+TEST(test_directoryd_update_queue, test_latest_wins)
+{
+  FakeDirectory directory;
+  std::vector<DirectoryUpdateQueue::flush_stats_t> flushes;
+  std::mutex lock;
+  DirectoryUpdateQueue queue(
+    directory.get_sender(),
+    WINDOW,
+    32,
+    [&](const DirectoryUpdateQueue::flush_stats_t &stats) {
+      std::lock_guard<std::mutex> guard(lock);
+      flushes.push_back(stats);
+    });
+
+  queue.update_location(IMSI_TO_HWID, "IMSI1", "GW_ID");
+  queue.update_location(IMSI_TO_HWID, "IMSI2", "GW_ID");
+  queue.update_location(IMSI_TO_HWID, "IMSI1", "enb1");
+  queue.update_location(IMSI_TO_HWID, "IMSI1", "enb2");
+  ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+
+  auto sent = directory.get_sent();
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_EQ(sent[0].id, "IMSI1");
+  EXPECT_EQ(sent[0].location, "enb2");
+  EXPECT_FALSE(sent[0].remove);
+  EXPECT_EQ(sent[1].id, "IMSI2");
+
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_EQ(flushes.size(), 1);
+  EXPECT_EQ(flushes[0].queue_depth, 2);
+  EXPECT_EQ(flushes[0].batch_size, 2);
+  EXPECT_EQ(flushes[0].coalesced, 2);
+}
+
+TEST(test_directoryd_update_queue, test_add_remove_deletes)
+{
+  FakeDirectory directory;
+  DirectoryUpdateQueue queue(directory.get_sender(), WINDOW, 32);
+
+  // Attached and detached within the window, a single removal clears what a
+  // previous run may have left in the directory
+  queue.update_location(IMSI_TO_HWID, "IMSI1", "GW_ID");
+  queue.delete_location(IMSI_TO_HWID, "IMSI1");
+  queue.update_location(IMSI_TO_HWID, "IMSI2", "GW_ID");
+  ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+  auto sent = directory.get_sent();
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_EQ(sent[0].id, "IMSI1");
+  EXPECT_TRUE(sent[0].remove);
+  EXPECT_EQ(sent[1].id, "IMSI2");
+  EXPECT_FALSE(sent[1].remove);
+
+  // Removed then added again, the last location is kept
+  queue.delete_location(IMSI_TO_HWID, "IMSI2");
+  queue.update_location(IMSI_TO_HWID, "IMSI2", "enb1");
+  ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+  sent = directory.get_sent();
+  ASSERT_EQ(sent.size(), 3);
+  EXPECT_FALSE(sent[2].remove);
+  EXPECT_EQ(sent[2].location, "enb1");
+
+  // Same id in another table
+  queue.delete_location(HWID_TO_HOSTNAME, "IMSI2");
+  ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+  sent = directory.get_sent();
+  ASSERT_EQ(sent.size(), 4);
+  EXPECT_EQ(sent[3].table, HWID_TO_HOSTNAME);
+}
+
+TEST(test_directoryd_update_queue, test_one_rpc_per_key)
+{
+  FakeDirectory directory(true);
+  DirectoryUpdateQueue queue(directory.get_sender(), WINDOW, 32);
+
+  queue.update_location(IMSI_TO_HWID, "IMSI1", "enb1");
+  while (directory.get_nb_held() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  // Waits for the answer to the first update
+  queue.update_location(IMSI_TO_HWID, "IMSI1", "enb2");
+  std::this_thread::sleep_for(WINDOW * 3);
+  EXPECT_EQ(directory.get_sent().size(), 1);
+
+  directory.release_all(queue);
+  auto sent = directory.get_sent();
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_EQ(sent[1].location, "enb2");
+  EXPECT_FALSE(directory.had_concurrent_same_key());
+}
+
+TEST(test_directoryd_update_queue, test_max_in_flight)
+{
+  const int nb_imsis = 100;
+  FakeDirectory directory(true);
+  DirectoryUpdateQueue queue(directory.get_sender(), WINDOW, 8);
+
+  for (int i = 0; i < nb_imsis; i++) {
+    queue.update_location(IMSI_TO_HWID, "IMSI" + std::to_string(i), "GW_ID");
+  }
+  directory.release_all(queue);
+  EXPECT_EQ(directory.get_sent().size(), nb_imsis);
+  EXPECT_EQ(directory.get_max_in_flight(), 8);
+}
+
+TEST(test_directoryd_update_queue, test_flush_on_destruction)
+{
+  FakeDirectory directory;
+  {
+    DirectoryUpdateQueue queue(
+      directory.get_sender(), std::chrono::milliseconds(60000), 32);
+    queue.update_location(IMSI_TO_HWID, "IMSI1", "GW_ID");
+  }
+  EXPECT_EQ(directory.get_sent().size(), 1);
+}
+
+/*
+ * Attach storm: every UE reports its IMSI then its eNB, and 1 in 10 detaches
+ * right away, as seen when an eNB comes back with all its UEs
+ */
+TEST(test_directoryd_update_queue, test_storm_benchmark)
+{
+  const int nb_ues = 10000;
+  const int nb_threads = 4;
+  FakeDirectory directory;
+  std::atomic<size_t> nb_flushes(0);
+  DirectoryUpdateQueue queue(
+    directory.get_sender(),
+    WINDOW,
+    32,
+    [&](const DirectoryUpdateQueue::flush_stats_t &stats) { nb_flushes++; });
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nb_threads; t++) {
+    threads.emplace_back([&queue, t]() {
+      for (int i = t; i < nb_ues; i += nb_threads) {
+        std::string imsi = "IMSI" + std::to_string(i);
+        queue.update_location(IMSI_TO_HWID, imsi, "GW_ID");
+        queue.update_location(IMSI_TO_HWID, imsi, "enb1");
+        if (i % 10 == 0) {
+          queue.delete_location(IMSI_TO_HWID, imsi);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_TRUE(queue.wait_idle(TIMEOUT));
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+  auto sent = directory.get_sent();
+  EXPECT_GE(sent.size(), nb_ues - nb_ues / 10);
+  EXPECT_LE(sent.size(), nb_ues + nb_ues / 10);
+  EXPECT_LE(directory.get_max_in_flight(), 32);
+  std::cout << nb_ues * 2 + nb_ues / 10 << " updates: " << sent.size()
+            << " RPCs in " << nb_flushes << " flushes, "
+            << elapsed.count() / 1000000 << " ms" << std::endl;
+}
+
+} // namespace magma
@@ -0,0 +1,320 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtp_tunnel_bench.c
+  \brief GTP tunnels programmed per second in a kernel gtp device, batched
+  libgtpnl backend against one synchronous libgtpnl request per tunnel. Runs
+  in its own network namespace; needs CAP_SYS_ADMIN, CAP_NET_ADMIN and the
+  gtp kernel module.
+*/
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <time.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <libgtpnl/gtp.h>
+#include <libgtpnl/gtpnl.h>
+#include <libmnl/libmnl.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "gtpv1u.h"
+
+#define GTP_TUNNEL_BENCH_UE_NET 0x0a800000 // 10.128.0.0/16
+#define GTP_TUNNEL_BENCH_UE_MASK 16
+#define GTP_TUNNEL_BENCH_ENB 0xc0a83c8e // 192.168.60.142
+#define GTP_TUNNEL_BENCH_MTU 1400
+#define GTP_TUNNEL_BENCH_I_TEI 0x100000
+#define GTP_TUNNEL_BENCH_O_TEI 0x200000
+
+typedef struct gtp_tunnel_bench_config_s {
+  int nb_tunnels;
+  int batch;
+  int nb_sync_tunnels;
+  bool netns;
+} gtp_tunnel_bench_config_t;
+
+static gtp_tunnel_bench_config_t config = {
+  .nb_tunnels = 10000,
+  .batch = 256,
+  .nb_sync_tunnels = 10000,
+  .netns = true,
+};
+
+static int nb_failures = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t gtp_tunnel_bench_now_usec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static struct in_addr gtp_tunnel_bench_ue(int i)
+{
+  struct in_addr ue = {.s_addr = htonl(GTP_TUNNEL_BENCH_UE_NET + 2 + i)};
+  return ue;
+}
+
+//------------------------------------------------------------------------------
+static void gtp_tunnel_bench_failure(
+  __attribute__((unused)) bool add,
+  __attribute__((unused)) struct in_addr ue,
+  __attribute__((unused)) uint32_t i_tei,
+  __attribute__((unused)) uint32_t o_tei,
+  __attribute__((unused)) int error)
+{
+  nb_failures++;
+}
+
+//------------------------------------------------------------------------------
+static void gtp_tunnel_bench_report(
+  const char *name,
+  int nb_tunnels,
+  int nb_failed,
+  uint64_t usec)
+{
+  printf(
+    "%-28s %8d tunnels %6d failed %10.0f tunnels/s\n",
+    name,
+    nb_tunnels,
+    nb_failed,
+    usec ? nb_tunnels * 1e6 / usec : 0.0);
+}
+
+//------------------------------------------------------------------------------
+static int gtp_tunnel_bench_batched(
+  const struct gtp_tunnel_ops *ops,
+  const char *name,
+  bool add)
+{
+  struct in_addr enb = {.s_addr = htonl(GTP_TUNNEL_BENCH_ENB)};
+  Imsi_t imsi = {0};
+  uint64_t start = 0;
+
+  nb_failures = 0;
+  start = gtp_tunnel_bench_now_usec();
+  for (int i = 0; i < config.nb_tunnels; i++) {
+    if (add) {
+      // Additions wait for their acknowledgement, the MME is answered after
+      if (
+        ops->add_tunnel(
+          gtp_tunnel_bench_ue(i),
+          enb,
+          GTP_TUNNEL_BENCH_I_TEI + i,
+          GTP_TUNNEL_BENCH_O_TEI + i,
+          imsi) < 0) {
+        nb_failures++;
+      }
+    } else {
+      ops->del_tunnel(
+        gtp_tunnel_bench_ue(i),
+        GTP_TUNNEL_BENCH_I_TEI + i,
+        GTP_TUNNEL_BENCH_O_TEI + i);
+    }
+    // As the SPGW task does when its message queue is drained
+    if (!((i + 1) % config.batch)) {
+      ops->commit();
+      ops->process_acks();
+    }
+  }
+  ops->commit();
+  ops->process_acks();
+  gtp_tunnel_bench_report(
+    name, config.nb_tunnels, nb_failures, gtp_tunnel_bench_now_usec() - start);
+  return nb_failures;
+}
+
+//------------------------------------------------------------------------------
+static void gtp_tunnel_bench_sync(void)
+{
+  struct in_addr enb = {.s_addr = htonl(GTP_TUNNEL_BENCH_ENB)};
+  struct mnl_socket *nl = NULL;
+  uint64_t start = 0;
+  int genl_id = 0;
+  int nb_failed = 0;
+
+  nl = genl_socket_open();
+  if (!nl || ((genl_id = genl_lookup_family(nl, "gtp")) < 0)) {
+    fprintf(stderr, "Cannot open the gtp genetlink family\n");
+    return;
+  }
+
+  // What the backend used to do for every tunnel
+  start = gtp_tunnel_bench_now_usec();
+  for (int i = 0; i < config.nb_sync_tunnels; i++) {
+    struct gtp_tunnel *t = gtp_tunnel_alloc();
+    struct in_addr ue = gtp_tunnel_bench_ue(i);
+
+    gtp_tunnel_set_ifidx(t, if_nametoindex("gtp0"));
+    gtp_tunnel_set_version(t, 1);
+    gtp_tunnel_set_ms_ip4(t, &ue);
+    gtp_tunnel_set_sgsn_ip4(t, &enb);
+    gtp_tunnel_set_i_tei(t, GTP_TUNNEL_BENCH_I_TEI + i);
+    gtp_tunnel_set_o_tei(t, GTP_TUNNEL_BENCH_O_TEI + i);
+    if (gtp_add_tunnel(genl_id, nl, t) < 0) {
+      nb_failed++;
+    }
+    gtp_tunnel_free(t);
+  }
+  gtp_tunnel_bench_report(
+    "libgtpnl add (per tunnel)",
+    config.nb_sync_tunnels,
+    nb_failed,
+    gtp_tunnel_bench_now_usec() - start);
+
+  nb_failed = 0;
+  start = gtp_tunnel_bench_now_usec();
+  for (int i = 0; i < config.nb_sync_tunnels; i++) {
+    struct gtp_tunnel *t = gtp_tunnel_alloc();
+
+    gtp_tunnel_set_ifidx(t, if_nametoindex("gtp0"));
+    gtp_tunnel_set_version(t, 1);
+    gtp_tunnel_set_i_tei(t, GTP_TUNNEL_BENCH_I_TEI + i);
+    gtp_tunnel_set_o_tei(t, GTP_TUNNEL_BENCH_O_TEI + i);
+    if (gtp_del_tunnel(genl_id, nl, t) < 0) {
+      nb_failed++;
+    }
+    gtp_tunnel_free(t);
+  }
+  gtp_tunnel_bench_report(
+    "libgtpnl delete (per tunnel)",
+    config.nb_sync_tunnels,
+    nb_failed,
+    gtp_tunnel_bench_now_usec() - start);
+  genl_socket_close(nl);
+}
+
+//------------------------------------------------------------------------------
+static int gtp_tunnel_bench_run(void)
+{
+  const struct gtp_tunnel_ops *ops = gtp_tunnel_ops_init_libgtpnl();
+  struct in_addr ue_net = {.s_addr = htonl(GTP_TUNNEL_BENCH_UE_NET)};
+  int fd0 = -1;
+  int fd1u = -1;
+  bool ok = true;
+
+  if (
+    ops->init(
+      &ue_net,
+      GTP_TUNNEL_BENCH_UE_MASK,
+      GTP_TUNNEL_BENCH_MTU,
+      &fd0,
+      &fd1u) != RETURNok) {
+    fprintf(stderr, "Cannot create the gtp device\n");
+    return RETURNerror;
+  }
+  ops->set_failure_cb(gtp_tunnel_bench_failure);
+
+  ok &= (gtp_tunnel_bench_batched(ops, "add", true) == 0);
+  ok &= (gtp_tunnel_bench_batched(ops, "batched delete", false) == 0);
+  // Every change fails and must be reported one by one
+  ok &=
+    (gtp_tunnel_bench_batched(ops, "batched delete (unknown)", false) ==
+     config.nb_tunnels);
+
+  if (config.nb_sync_tunnels > 0) {
+    gtp_tunnel_bench_sync();
+  }
+
+  ops->uninit();
+  return ok ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+static void gtp_tunnel_bench_usage(const char *name)
+{
+  fprintf(
+    stderr,
+    "Usage: %s [options]\n"
+    "  -n, --tunnels <n>        Tunnels to program in batches (default 10000)\n"
+    "  -b, --batch <n>          Tunnels per commit (default 256)\n"
+    "  -s, --sync <n>           Tunnels to program one by one, 0 = skip "
+    "(10000)\n"
+    "  -N, --no-netns           Run in the current network namespace\n",
+    name);
+}
+
+//------------------------------------------------------------------------------
+static int gtp_tunnel_bench_parse_args(int argc, char *argv[])
+{
+  static const struct option long_options[] = {
+    {"tunnels", required_argument, NULL, 'n'},
+    {"batch", required_argument, NULL, 'b'},
+    {"sync", required_argument, NULL, 's'},
+    {"no-netns", no_argument, NULL, 'N'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0},
+  };
+  int c = 0;
+
+  while ((c = getopt_long(argc, argv, "n:b:s:Nh", long_options, NULL)) != -1) {
+    switch (c) {
+      case 'n': config.nb_tunnels = atoi(optarg); break;
+      case 'b': config.batch = atoi(optarg); break;
+      case 's': config.nb_sync_tunnels = atoi(optarg); break;
+      case 'N': config.netns = false; break;
+      default: return RETURNerror;
+    }
+  }
+  // The UEs of the benchmark must fit in its /16
+  if (
+    (config.nb_tunnels <= 0) || (config.nb_tunnels > 65000) ||
+    (config.nb_sync_tunnels > 65000) || (config.batch <= 0)) {
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  if (gtp_tunnel_bench_parse_args(argc, argv) != RETURNok) {
+    gtp_tunnel_bench_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (
+    OAILOG_INIT("GTP_TUNNEL_BENCH", OAILOG_LEVEL_CRITICAL, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    fprintf(stderr, "Failed to initialize logging\n");
+    return EXIT_FAILURE;
+  }
+  if (config.netns && unshare(CLONE_NEWNET)) {
+    fprintf(
+      stderr, "Failed to create a network namespace: %s\n", strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  return (gtp_tunnel_bench_run() == RETURNok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
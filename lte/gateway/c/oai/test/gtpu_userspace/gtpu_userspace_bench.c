@@ -0,0 +1,516 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtpu_userspace_bench.c
+  \brief Userspace GTP-U forwarding throughput, in Mpps and Gbps of inner
+  packets. The gateway runs in its own network namespace, the eNB in another
+  one behind a veth pair: uplink G-PDUs are sent by the eNB and written to the
+  TUN device, downlink packets are routed to the TUN device and received by
+  the eNB. Needs CAP_SYS_ADMIN and CAP_NET_ADMIN.
+*/
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "gtpu_userspace.h"
+
+#define GTPU_BENCH_UE_NET 0x0a800000 // 10.128.0.0/16
+#define GTPU_BENCH_UE_MASK 16
+#define GTPU_BENCH_SGW 0xc0a83c01 // 192.168.60.1
+#define GTPU_BENCH_ENB 0xc0a83c8e // 192.168.60.142
+#define GTPU_BENCH_LO_SGW 0x7f000001
+#define GTPU_BENCH_LO_ENB 0x7f000002
+#define GTPU_BENCH_SERVER 0xc6336401 // 198.51.100.1
+#define GTPU_BENCH_PORT 2152
+#define GTPU_BENCH_SINK_PORT 9
+#define GTPU_BENCH_I_TEI 1000
+#define GTPU_BENCH_O_TEI 500000
+
+typedef struct gtpu_bench_config_s {
+  int nb_tunnels;
+  int nb_workers;
+  int first_cpu;
+  int pkt_size;
+  int duration_sec;
+  bool loopback;
+} gtpu_bench_config_t;
+
+static gtpu_bench_config_t config = {
+  .nb_tunnels = 1000,
+  .nb_workers = 2,
+  .first_cpu = -1,
+  .pkt_size = 512,
+  .duration_sec = 5,
+  .loopback = false,
+};
+
+static struct {
+  int enb_ns_fd;
+  struct in_addr sgw;
+  struct in_addr enb;
+  volatile bool stop;
+  uint64_t enb_rx_packets;
+  uint64_t enb_rx_bytes;
+} bench = {.enb_ns_fd = -1};
+
+//------------------------------------------------------------------------------
+static struct in_addr gtpu_bench_ue(int i)
+{
+  struct in_addr ue = {.s_addr = htonl(GTPU_BENCH_UE_NET + 2 + i)};
+  return ue;
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_bench_system(const char *command)
+{
+  int rc = system(command);
+
+  if (rc) {
+    fprintf(stderr, "Failed (%d): %s\n", rc, command);
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_bench_report(const char *name, uint64_t pkts, uint64_t bytes)
+{
+  uint64_t usec = (uint64_t) config.duration_sec * 1000000;
+
+  printf(
+    "%-10s %12lu packets %8.3f Mpps %8.3f Gbps\n",
+    name,
+    pkts,
+    pkts / (double) usec,
+    bytes * 8 / (usec * 1e3));
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_bench_enter_enb_ns(void)
+{
+  // Threads of the eNB, the namespace is per thread
+  if ((bench.enb_ns_fd >= 0) && setns(bench.enb_ns_fd, CLONE_NEWNET)) {
+    fprintf(stderr, "Cannot enter the eNB namespace: %s\n", strerror(errno));
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *gtpu_bench_enb_ns_main(void *arg)
+{
+  int *rc = (int *) arg;
+  char command[256];
+
+  *rc = RETURNerror;
+  if (unshare(CLONE_NEWNET)) {
+    fprintf(stderr, "Cannot create the eNB namespace: %s\n", strerror(errno));
+    return NULL;
+  }
+  bench.enb_ns_fd = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+  // Commands forked from this thread run in the eNB namespace
+  snprintf(
+    command,
+    sizeof(command),
+    "ip link set lo up && "
+    "ip link add enb0 type veth peer name s1u0 netns %d && "
+    "ip addr add %s/24 dev enb0 && ip link set enb0 up",
+    getpid(),
+    inet_ntoa(bench.enb));
+  *rc = gtpu_bench_system(command);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_bench_setup_netns(void)
+{
+  char command[256];
+  pthread_t thread;
+  int rc = RETURNerror;
+
+  if (unshare(CLONE_NEWNET)) {
+    fprintf(
+      stderr, "Failed to create a network namespace: %s\n", strerror(errno));
+    return RETURNerror;
+  }
+  if (gtpu_bench_system("ip link set lo up") != RETURNok) {
+    return RETURNerror;
+  }
+  if (config.loopback) {
+    bench.sgw.s_addr = htonl(GTPU_BENCH_LO_SGW);
+    bench.enb.s_addr = htonl(GTPU_BENCH_LO_ENB);
+    return RETURNok;
+  }
+  bench.sgw.s_addr = htonl(GTPU_BENCH_SGW);
+  bench.enb.s_addr = htonl(GTPU_BENCH_ENB);
+  pthread_create(&thread, NULL, gtpu_bench_enb_ns_main, &rc);
+  pthread_join(thread, NULL);
+  if ((rc != RETURNok) || (bench.enb_ns_fd < 0)) {
+    return RETURNerror;
+  }
+  snprintf(
+    command,
+    sizeof(command),
+    "ip addr add %s/24 dev s1u0 && ip link set s1u0 up",
+    inet_ntoa(bench.sgw));
+  return gtpu_bench_system(command);
+}
+
+//------------------------------------------------------------------------------
+static uint32_t gtpu_bench_ip_packet(
+  uint8_t *data,
+  uint32_t len,
+  struct in_addr src,
+  struct in_addr dst)
+{
+  memset(data, 0, len);
+  data[0] = 0x45;
+  data[2] = len >> 8;
+  data[3] = len & 0xff;
+  data[8] = 64;
+  data[9] = IPPROTO_UDP;
+  memcpy(data + 12, &src, sizeof(src));
+  memcpy(data + 16, &dst, sizeof(dst));
+  // UDP header, no checksum
+  data[20] = GTPU_BENCH_SINK_PORT >> 8;
+  data[21] = GTPU_BENCH_SINK_PORT & 0xff;
+  data[22] = GTPU_BENCH_SINK_PORT >> 8;
+  data[23] = GTPU_BENCH_SINK_PORT & 0xff;
+  data[24] = (len - 20) >> 8;
+  data[25] = (len - 20) & 0xff;
+  return len;
+}
+
+//------------------------------------------------------------------------------
+static void *gtpu_bench_uplink_main(void *arg)
+{
+  int first = *(int *) arg;
+  struct in_addr server = {.s_addr = htonl(GTPU_BENCH_SERVER)};
+  struct sockaddr_in sgw = {
+    .sin_family = AF_INET,
+    .sin_port = htons(GTPU_BENCH_PORT),
+    .sin_addr = bench.sgw,
+  };
+  uint8_t(*gpdus)[GTPU_US_PKT_BUFFER_SIZE] =
+    calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  struct mmsghdr msgs[GTPU_US_BATCH_SIZE];
+  struct iovec iovs[GTPU_US_BATCH_SIZE];
+  int fd = -1;
+
+  gtpu_bench_enter_enb_ns();
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if ((fd < 0) || !gpdus) {
+    free(gpdus);
+    return NULL;
+  }
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+    int tunnel = (first + i) % config.nb_tunnels;
+    uint32_t teid = GTPU_BENCH_I_TEI + tunnel;
+    uint8_t *gpdu = gpdus[i];
+
+    gpdu[0] = 0x30;
+    gpdu[1] = GTPU_US_MSG_GPDU;
+    gpdu[2] = config.pkt_size >> 8;
+    gpdu[3] = config.pkt_size & 0xff;
+    gpdu[4] = teid >> 24;
+    gpdu[5] = (teid >> 16) & 0xff;
+    gpdu[6] = (teid >> 8) & 0xff;
+    gpdu[7] = teid & 0xff;
+    gtpu_bench_ip_packet(
+      gpdu + GTPU_US_HEADER_LEN,
+      config.pkt_size,
+      gtpu_bench_ue(tunnel),
+      server);
+    iovs[i].iov_base = gpdu;
+    iovs[i].iov_len = GTPU_US_HEADER_LEN + config.pkt_size;
+    msgs[i].msg_hdr.msg_name = &sgw;
+    msgs[i].msg_hdr.msg_namelen = sizeof(sgw);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  while (!bench.stop) {
+    sendmmsg(fd, msgs, GTPU_US_BATCH_SIZE, 0);
+  }
+  close(fd);
+  free(gpdus);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *gtpu_bench_downlink_main(void *arg)
+{
+  int first = *(int *) arg;
+  struct in_addr server = {.s_addr = htonl(GTPU_BENCH_SERVER)};
+  uint8_t(*ips)[GTPU_US_PKT_BUFFER_SIZE] =
+    calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  struct sockaddr_in ues[GTPU_US_BATCH_SIZE];
+  struct mmsghdr msgs[GTPU_US_BATCH_SIZE];
+  struct iovec iovs[GTPU_US_BATCH_SIZE];
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+  if ((fd < 0) || !ips) {
+    free(ips);
+    return NULL;
+  }
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+    int tunnel = (first + i) % config.nb_tunnels;
+
+    // The kernel adds the IP and UDP headers
+    gtpu_bench_ip_packet(
+      ips[i], config.pkt_size, server, gtpu_bench_ue(tunnel));
+    ues[i].sin_family = AF_INET;
+    ues[i].sin_port = htons(GTPU_BENCH_SINK_PORT);
+    ues[i].sin_addr = gtpu_bench_ue(tunnel);
+    iovs[i].iov_base = ips[i] + 28;
+    iovs[i].iov_len = config.pkt_size - 28;
+    msgs[i].msg_hdr.msg_name = &ues[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(ues[i]);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  while (!bench.stop) {
+    sendmmsg(fd, msgs, GTPU_US_BATCH_SIZE, 0);
+  }
+  close(fd);
+  free(ips);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void *gtpu_bench_enb_rx_main(void *arg)
+{
+  uint8_t(*buffers)[GTPU_US_PKT_BUFFER_SIZE] =
+    calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  struct sockaddr_in addr = {
+    .sin_family = AF_INET,
+    .sin_port = htons(GTPU_BENCH_PORT),
+    .sin_addr = bench.enb,
+  };
+  struct timeval timeout = {.tv_usec = 100000};
+  struct mmsghdr msgs[GTPU_US_BATCH_SIZE];
+  struct iovec iovs[GTPU_US_BATCH_SIZE];
+  int *rc = (int *) arg;
+  int size = 4 * 1024 * 1024;
+  int fd = -1;
+
+  gtpu_bench_enter_enb_ns();
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (
+    (fd < 0) || !buffers ||
+    bind(fd, (struct sockaddr *) &addr, sizeof(addr))) {
+    fprintf(stderr, "Cannot bind the eNB socket: %s\n", strerror(errno));
+    free(buffers);
+    *rc = RETURNerror;
+    return NULL;
+  }
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  memset(msgs, 0, sizeof(msgs));
+  for (int i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+    iovs[i].iov_base = buffers[i];
+    iovs[i].iov_len = GTPU_US_PKT_BUFFER_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+  *rc = RETURNok;
+  while (!bench.stop) {
+    int nb_msgs = recvmmsg(fd, msgs, GTPU_US_BATCH_SIZE, MSG_WAITFORONE, NULL);
+
+    for (int i = 0; i < nb_msgs; i++) {
+      if (
+        (msgs[i].msg_len > GTPU_US_HEADER_LEN) &&
+        (buffers[i][1] == GTPU_US_MSG_GPDU)) {
+        bench.enb_rx_packets++;
+        bench.enb_rx_bytes += msgs[i].msg_len - GTPU_US_HEADER_LEN;
+      }
+    }
+  }
+  close(fd);
+  free(buffers);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_bench_run_senders(void *(*sender)(void *) )
+{
+  pthread_t threads[GTPU_US_MAX_WORKERS];
+  int firsts[GTPU_US_MAX_WORKERS];
+
+  bench.stop = false;
+  for (int i = 0; i < config.nb_workers; i++) {
+    firsts[i] = i * GTPU_US_BATCH_SIZE;
+    pthread_create(&threads[i], NULL, sender, &firsts[i]);
+  }
+  sleep(config.duration_sec);
+  bench.stop = true;
+  for (int i = 0; i < config.nb_workers; i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_bench_run(void)
+{
+  gtpu_us_config_t us_config = {
+    .ue_net = {.s_addr = htonl(GTPU_BENCH_UE_NET)},
+    .ue_mask = GTPU_BENCH_UE_MASK,
+    .mtu = 1500,
+    .s1u_addr = bench.sgw,
+    .s1u_port = GTPU_BENCH_PORT,
+    .nb_workers = config.nb_workers,
+    .first_cpu = config.first_cpu,
+  };
+  gtpu_us_stats_t before;
+  gtpu_us_stats_t after;
+  pthread_t enb_rx;
+  int enb_rx_rc = RETURNerror;
+
+  snprintf(us_config.tun_name, IFNAMSIZ, "gtpu0");
+  if (
+    (gtpu_us_init(config.nb_tunnels) != RETURNok) ||
+    (gtpu_us_start(&us_config) != RETURNok)) {
+    fprintf(stderr, "Cannot start the forwarder\n");
+    return RETURNerror;
+  }
+  for (int i = 0; i < config.nb_tunnels; i++) {
+    gtpu_us_add_tunnel(
+      gtpu_bench_ue(i),
+      bench.enb,
+      GTPU_BENCH_I_TEI + i,
+      GTPU_BENCH_O_TEI + i);
+  }
+
+  gtpu_us_get_stats(&before);
+  gtpu_bench_run_senders(gtpu_bench_uplink_main);
+  gtpu_us_get_stats(&after);
+  gtpu_bench_report(
+    "uplink",
+    after.ul_packets - before.ul_packets,
+    after.ul_bytes - before.ul_bytes);
+
+  bench.stop = false;
+  pthread_create(&enb_rx, NULL, gtpu_bench_enb_rx_main, &enb_rx_rc);
+  // Let the receiver bind before the first packet
+  usleep(100000);
+  gtpu_us_get_stats(&before);
+  gtpu_bench_run_senders(gtpu_bench_downlink_main);
+  pthread_join(enb_rx, NULL);
+  gtpu_us_get_stats(&after);
+  gtpu_bench_report(
+    "downlink",
+    after.dl_packets - before.dl_packets,
+    after.dl_bytes - before.dl_bytes);
+  gtpu_bench_report("eNB rx", bench.enb_rx_packets, bench.enb_rx_bytes);
+  printf("dropped    %12lu packets\n", after.drops);
+
+  gtpu_us_exit();
+  return (enb_rx_rc == RETURNok) ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+static void gtpu_bench_usage(const char *name)
+{
+  fprintf(
+    stderr,
+    "Usage: %s [options]\n"
+    "  -t, --tunnels <n>        Tunnels, one UE each (default 1000)\n"
+    "  -w, --workers <n>        Forwarder workers and senders (default 2)\n"
+    "  -c, --cpu <n>            Pin the workers from this CPU (default no)\n"
+    "  -s, --size <n>           Inner packet size in bytes (default 512)\n"
+    "  -d, --duration <sec>     Duration of each direction (default 5)\n"
+    "  -l, --loopback           eNB on the loopback, without veth pair\n",
+    name);
+}
+
+//------------------------------------------------------------------------------
+static int gtpu_bench_parse_args(int argc, char *argv[])
+{
+  static const struct option long_options[] = {
+    {"tunnels", required_argument, NULL, 't'},
+    {"workers", required_argument, NULL, 'w'},
+    {"cpu", required_argument, NULL, 'c'},
+    {"size", required_argument, NULL, 's'},
+    {"duration", required_argument, NULL, 'd'},
+    {"loopback", no_argument, NULL, 'l'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0},
+  };
+  int c = 0;
+
+  while ((c = getopt_long(argc, argv, "t:w:c:s:d:lh", long_options, NULL)) !=
+         -1) {
+    switch (c) {
+      case 't': config.nb_tunnels = atoi(optarg); break;
+      case 'w': config.nb_workers = atoi(optarg); break;
+      case 'c': config.first_cpu = atoi(optarg); break;
+      case 's': config.pkt_size = atoi(optarg); break;
+      case 'd': config.duration_sec = atoi(optarg); break;
+      case 'l': config.loopback = true; break;
+      default: return RETURNerror;
+    }
+  }
+  // The UEs must fit in the /16, the packets in an MTU of 1500
+  if (
+    (config.nb_tunnels <= 0) || (config.nb_tunnels > 65000) ||
+    (config.nb_workers <= 0) || (config.nb_workers > GTPU_US_MAX_WORKERS) ||
+    (config.pkt_size < 28) || (config.pkt_size > 1500) ||
+    (config.duration_sec <= 0)) {
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  if (gtpu_bench_parse_args(argc, argv) != RETURNok) {
+    gtpu_bench_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (
+    OAILOG_INIT("GTPU_US_BENCH", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    fprintf(stderr, "Failed to initialize logging\n");
+    return EXIT_FAILURE;
+  }
+  if (gtpu_bench_setup_netns() != RETURNok) {
+    return EXIT_FAILURE;
+  }
+  return (gtpu_bench_run() == RETURNok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <chrono>
+#include <thread>
+
+#include "FakeS6aProxy.h"
+#include "mme_load_auth.h"
+
+namespace {
+constexpr uint32_t DEFAULT_CONTEXT_ID = 1;
+constexpr uint32_t MAX_BANDWIDTH_UL = 200000000;
+constexpr uint32_t MAX_BANDWIDTH_DL = 100000000;
+constexpr int32_t QCI = 9;
+constexpr uint32_t PRIORITY_LEVEL = 15;
+} // namespace
+
+namespace magma {
+
+FakeS6aProxy::FakeS6aProxy(const std::string &apn, uint32_t auth_delay_ms):
+  apn_(apn),
+  auth_delay_ms_(auth_delay_ms),
+  sequence_(0)
+{
+}
+
+Status FakeS6aProxy::AuthenticationInformation(
+  ServerContext *context,
+  const AuthenticationInformationRequest *request,
+  AuthenticationInformationAnswer *response)
+{
+  if (auth_delay_ms_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(auth_delay_ms_));
+  }
+  uint32_t n_vectors = request->num_requested_eutran_vectors();
+  if (n_vectors == 0) {
+    n_vectors = 1;
+  }
+  for (uint32_t i = 0; i < n_vectors; i++) {
+    mme_load_auth_vector_t vector;
+    mme_load_auth_generate_vector(
+      request->user_name().c_str(), sequence_++, &vector);
+    auto eutran_vector = response->add_eutran_vectors();
+    eutran_vector->set_rand(vector.rand, sizeof(vector.rand));
+    eutran_vector->set_xres(vector.xres, sizeof(vector.xres));
+    eutran_vector->set_autn(vector.autn, sizeof(vector.autn));
+    eutran_vector->set_kasme(vector.kasme, sizeof(vector.kasme));
+  }
+  response->set_error_code(ErrorCode::SUCCESS);
+  return Status::OK;
+}
+
+Status FakeS6aProxy::UpdateLocation(
+  ServerContext *context,
+  const UpdateLocationRequest *request,
+  UpdateLocationAnswer *response)
+{
+  response->set_error_code(ErrorCode::SUCCESS);
+  response->set_default_context_id(DEFAULT_CONTEXT_ID);
+  response->set_all_apns_included(true);
+  response->mutable_total_ambr()->set_max_bandwidth_ul(MAX_BANDWIDTH_UL);
+  response->mutable_total_ambr()->set_max_bandwidth_dl(MAX_BANDWIDTH_DL);
+
+  auto apn = response->add_apn();
+  apn->set_context_id(DEFAULT_CONTEXT_ID);
+  apn->set_service_selection(apn_);
+  apn->set_pdn(UpdateLocationAnswer::APNConfiguration::IPV4);
+  apn->mutable_qos_profile()->set_class_id(QCI);
+  apn->mutable_qos_profile()->set_priority_level(PRIORITY_LEVEL);
+  apn->mutable_qos_profile()->set_preemption_capability(false);
+  apn->mutable_qos_profile()->set_preemption_vulnerability(true);
+  apn->mutable_ambr()->set_max_bandwidth_ul(MAX_BANDWIDTH_UL);
+  apn->mutable_ambr()->set_max_bandwidth_dl(MAX_BANDWIDTH_DL);
+  return Status::OK;
+}
+
+Status FakeS6aProxy::PurgeUE(
+  ServerContext *context,
+  const PurgeUERequest *request,
+  PurgeUEAnswer *response)
+{
+  response->set_error_code(ErrorCode::SUCCESS);
+  return Status::OK;
+}
+
+} // namespace magma
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include <grpc++/grpc++.h>
+#include "feg/protos/s6a_proxy.grpc.pb.h"
+
+using grpc::ServerContext;
+using grpc::Status;
+
+namespace magma {
+using namespace feg;
+
+/*
+ * S6a proxy answering every subscriber without a database, for driving the
+ * MME with the load generator. Authentication vectors are derived from the
+ * IMSI the same way the simulated UEs derive them (see mme_load_auth.h).
+ */
+class FakeS6aProxy final : public S6aProxy::Service {
+ public:
+  /*
+   * @param apn: APN of the subscription returned by Update Location
+   * @param auth_delay_ms: delay before answering an Authentication
+   *   Information Request, to emulate the round trip to a remote HSS
+   */
+  FakeS6aProxy(const std::string &apn, uint32_t auth_delay_ms = 0);
+
+  /*
+   * Authentication Information Request
+   * S6a Command Code: 318
+   *
+   * @param context: the grpc Server context
+   * @param request: AuthenticationInformationRequest
+   * @param response (out): AuthenticationInformationAnswer
+   * @return grpc Status instance
+   */
+  Status AuthenticationInformation(
+    ServerContext *context,
+    const AuthenticationInformationRequest *request,
+    AuthenticationInformationAnswer *response) override;
+
+  /*
+   * Update Location Request
+   * S6a Command Code: 316
+   *
+   * @param context: the grpc Server context
+   * @param request: UpdateLocationRequest
+   * @param response (out): UpdateLocationAnswer
+   * @return grpc Status instance
+   */
+  Status UpdateLocation(
+    ServerContext *context,
+    const UpdateLocationRequest *request,
+    UpdateLocationAnswer *response) override;
+
+  /*
+   * Purge UE Request
+   * S6a Command Code: 321
+   *
+   * @param context: the grpc Server context
+   * @param request: PurgeUERequest
+   * @param response (out): PurgeUEAnswer
+   * @return grpc Status instance
+   */
+  Status PurgeUE(
+    ServerContext *context,
+    const PurgeUERequest *request,
+    PurgeUEAnswer *response) override;
+
+ private:
+  const std::string apn_;
+  const uint32_t auth_delay_ms_;
+  std::atomic<uint32_t> sequence_;
+};
+
+} // namespace magma
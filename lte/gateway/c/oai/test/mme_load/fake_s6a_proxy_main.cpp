@@ -0,0 +1,54 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "FakeS6aProxy.h"
+
+using grpc::Server;
+using grpc::ServerBuilder;
+using magma::FakeS6aProxy;
+
+// The MME reaches the HSS through the local subscriberdb endpoint
+static const char *DEFAULT_LISTEN_ADDRESS = "0.0.0.0:50051";
+static const char *DEFAULT_APN = "oai.ipv4";
+
+int main(int argc, char *argv[])
+{
+  std::string address = (argc > 1) ? argv[1] : DEFAULT_LISTEN_ADDRESS;
+  std::string apn = (argc > 2) ? argv[2] : DEFAULT_APN;
+  // Emulated HSS round trip of the Authentication Information Requests
+  uint32_t auth_delay_ms = (argc > 3) ? std::stoul(argv[3]) : 0;
+
+  FakeS6aProxy s6a_proxy(apn, auth_delay_ms);
+  ServerBuilder builder;
+  builder.AddListeningPort(address, grpc::InsecureServerCredentials());
+  builder.RegisterService(&s6a_proxy);
+  std::unique_ptr<Server> server = builder.BuildAndStart();
+  if (!server) {
+    std::cerr << "Failed to listen on " << address << std::endl;
+    return 1;
+  }
+  std::cout << "Fake S6a proxy listening on " << address << std::endl;
+  server->Wait();
+  return 0;
+}
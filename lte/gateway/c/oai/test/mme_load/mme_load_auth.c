@@ -0,0 +1,126 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_auth.c
+  \brief Deterministic EPS authentication vectors shared by the load generator
+  and the fake S6a proxy
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "secu_defs.h"
+#include "mme_load_auth.h"
+
+/* Function codes private to the load generator, outside of the 3GPP range */
+#define MME_LOAD_AUTH_FC_RAND 0xF0
+#define MME_LOAD_AUTH_FC_RES 0xF1
+#define MME_LOAD_AUTH_FC_AUTN 0xF2
+#define MME_LOAD_AUTH_FC_KASME 0xF3
+
+#define MME_LOAD_AUTH_IMSI_MAX_LENGTH 15
+
+static const uint8_t mme_load_auth_key[32] = {
+  0x8b, 0xaf, 0x47, 0x3f, 0x2f, 0x8f, 0xd0, 0x94, 0x87, 0xcc, 0xcb,
+  0xd7, 0x09, 0x7c, 0x68, 0x62, 0x1c, 0xd9, 0xb6, 0x2d, 0x94, 0x65,
+  0x3c, 0x3b, 0x46, 0x7a, 0x1e, 0x80, 0x65, 0x3d, 0x5c, 0x7e,
+};
+
+//------------------------------------------------------------------------------
+static void mme_load_auth_kdf(
+  uint8_t fc,
+  const char *imsi,
+  const uint8_t *param,
+  size_t param_length,
+  uint8_t *out,
+  size_t out_length)
+{
+  uint8_t s[1 + MME_LOAD_AUTH_IMSI_MAX_LENGTH + MME_LOAD_AUTH_RAND_LENGTH];
+  size_t imsi_length = strnlen(imsi, MME_LOAD_AUTH_IMSI_MAX_LENGTH);
+  size_t s_length = 0;
+
+  s[s_length++] = fc;
+  memcpy(&s[s_length], imsi, imsi_length);
+  s_length += imsi_length;
+  memcpy(&s[s_length], param, param_length);
+  s_length += param_length;
+  kdf(
+    mme_load_auth_key,
+    sizeof(mme_load_auth_key),
+    s,
+    s_length,
+    out,
+    out_length);
+}
+
+//------------------------------------------------------------------------------
+void mme_load_auth_generate_vector(
+  const char *imsi,
+  uint32_t sequence,
+  mme_load_auth_vector_t *vector)
+{
+  uint8_t seq[4];
+
+  seq[0] = (sequence >> 24) & 0xff;
+  seq[1] = (sequence >> 16) & 0xff;
+  seq[2] = (sequence >> 8) & 0xff;
+  seq[3] = sequence & 0xff;
+  mme_load_auth_kdf(
+    MME_LOAD_AUTH_FC_RAND,
+    imsi,
+    seq,
+    sizeof(seq),
+    vector->rand,
+    MME_LOAD_AUTH_RAND_LENGTH);
+  mme_load_auth_derive_vector(imsi, vector->rand, vector);
+}
+
+//------------------------------------------------------------------------------
+void mme_load_auth_derive_vector(
+  const char *imsi,
+  const uint8_t rand[MME_LOAD_AUTH_RAND_LENGTH],
+  mme_load_auth_vector_t *vector)
+{
+  if (vector->rand != rand) {
+    memcpy(vector->rand, rand, MME_LOAD_AUTH_RAND_LENGTH);
+  }
+  mme_load_auth_kdf(
+    MME_LOAD_AUTH_FC_RES,
+    imsi,
+    rand,
+    MME_LOAD_AUTH_RAND_LENGTH,
+    vector->xres,
+    MME_LOAD_AUTH_XRES_LENGTH);
+  mme_load_auth_kdf(
+    MME_LOAD_AUTH_FC_AUTN,
+    imsi,
+    rand,
+    MME_LOAD_AUTH_RAND_LENGTH,
+    vector->autn,
+    MME_LOAD_AUTH_AUTN_LENGTH);
+  mme_load_auth_kdf(
+    MME_LOAD_AUTH_FC_KASME,
+    imsi,
+    rand,
+    MME_LOAD_AUTH_RAND_LENGTH,
+    vector->kasme,
+    MME_LOAD_AUTH_KASME_LENGTH);
+}
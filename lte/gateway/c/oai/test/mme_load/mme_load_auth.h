@@ -0,0 +1,70 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_auth.h
+  \brief Deterministic EPS authentication vectors shared by the load generator
+  and the fake S6a proxy
+*/
+
+#ifndef FILE_MME_LOAD_AUTH_SEEN
+#define FILE_MME_LOAD_AUTH_SEEN
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MME_LOAD_AUTH_RAND_LENGTH 16
+#define MME_LOAD_AUTH_XRES_LENGTH 8
+#define MME_LOAD_AUTH_AUTN_LENGTH 16
+#define MME_LOAD_AUTH_KASME_LENGTH 32
+
+/* Both ends derive the vector from the IMSI and the RAND only, so the
+ * simulated UEs never need a real USIM (Milenage) and the fake HSS needs no
+ * subscriber database. */
+typedef struct mme_load_auth_vector_s {
+  uint8_t rand[MME_LOAD_AUTH_RAND_LENGTH];
+  uint8_t xres[MME_LOAD_AUTH_XRES_LENGTH];
+  uint8_t autn[MME_LOAD_AUTH_AUTN_LENGTH];
+  uint8_t kasme[MME_LOAD_AUTH_KASME_LENGTH];
+} mme_load_auth_vector_t;
+
+/** \brief Generate a fresh RAND for imsi and derive the vector from it
+ * \param imsi      IMSI digits, NULL terminated
+ * \param sequence  Per-subscriber counter making every RAND unique
+ **/
+void mme_load_auth_generate_vector(
+  const char *imsi,
+  uint32_t sequence,
+  mme_load_auth_vector_t *vector);
+
+/** \brief Derive XRES, AUTN and KASME of an already known RAND (UE side) */
+void mme_load_auth_derive_vector(
+  const char *imsi,
+  const uint8_t rand[MME_LOAD_AUTH_RAND_LENGTH],
+  mme_load_auth_vector_t *vector);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILE_MME_LOAD_AUTH_SEEN */
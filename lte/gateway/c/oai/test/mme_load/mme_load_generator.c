@@ -0,0 +1,1212 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_generator.c
+  \brief S1AP/NAS load generator for benchmarking the MME
+
+  Emulates a configurable number of eNBs, each one an SCTP association towards
+  the MME, and drives simulated UEs through attach, UE context release,
+  service request, TAU and detach. Paging received for an idle UE is answered
+  with a service request. With --reset each eNB resets its S1 interface once
+  all of its UEs are attached, which measures how long the MME takes to
+  release every UE of an eNB in one go. The run ends when every UE has gone through its
+  procedures and a per-procedure latency report is printed.
+
+  Everything runs in a single thread around epoll, so the generator itself
+  stays cheap compared to the MME under test.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "hashtable.h"
+#include "mme_load_nas.h"
+#include "mme_load_s1ap.h"
+#include "mme_load_stats.h"
+
+#define S1AP_PORT_NUMBER 36412
+#define S1AP_SCTP_PPID 18
+#define MME_LOAD_MAX_PDU_LENGTH 8192
+#define MME_LOAD_MAX_EPOLL_EVENTS 64
+#define MME_LOAD_PROC_NONE MME_LOAD_PROC_MAX
+
+typedef struct mme_load_config_s {
+  struct sockaddr_in mme_addr;
+  uint32_t n_enbs;
+  uint32_t n_ues;
+  uint32_t concurrency;
+  uint32_t rate; // UE starts per second, 0 for no pacing
+  uint32_t cycles;
+  bool tau;
+  bool detach;
+  bool reset;
+  uint32_t hold_ms;
+  uint32_t timeout_ms;
+  uint16_t mcc;
+  uint16_t mnc;
+  uint8_t mnc_digit_length;
+  uint16_t tac;
+  uint64_t imsi_base;
+  uint32_t enb_id_base;
+  uint16_t streams;
+  uint32_t s1u_ipv4;
+} mme_load_config_t;
+
+typedef struct mme_load_enb_s {
+  mme_load_enb_config_t config;
+  int fd;
+  uint16_t out_streams;
+  bool setup_done;
+  uint64_t setup_start_us;
+  uint32_t pending_ues; // UEs still to reach the reset step
+  uint32_t parked_ues; // UEs waiting for the Reset Acknowledge
+  uint64_t reset_start_us;
+} mme_load_enb_t;
+
+typedef struct mme_load_ue_s {
+  uint32_t index; // also used as eNB UE S1AP ID
+  mme_load_enb_t *enb;
+  uint16_t stream;
+  mme_load_nas_context_t nas;
+  bool has_mme_ue_s1ap_id;
+  uint32_t mme_ue_s1ap_id;
+  bool connected;
+  bool done;
+  bool parked;
+  bool reset_done;
+  uint32_t step;
+  mme_load_proc_t proc;
+  uint32_t proc_seq;
+  uint64_t proc_start_us;
+} mme_load_ue_t;
+
+/* FIFO of UE timers. Every timer of a queue has the same delay, so appending
+ * keeps the queue sorted by expiry. Entries made stale by the UE moving on
+ * are recognised by their sequence number and dropped. */
+typedef struct mme_load_timer_s {
+  mme_load_ue_t *ue;
+  uint32_t seq;
+  uint64_t expiry_us;
+  struct mme_load_timer_s *next;
+} mme_load_timer_t;
+
+typedef struct mme_load_timer_queue_s {
+  mme_load_timer_t *head;
+  mme_load_timer_t *tail;
+} mme_load_timer_queue_t;
+
+typedef struct mme_load_s {
+  mme_load_config_t config;
+  mme_load_enb_t *enbs;
+  mme_load_ue_t *ues;
+  hash_table_t *m_tmsi_htbl; // M-TMSI -> UE, for paging
+  mme_load_proc_t *steps;
+  uint32_t n_steps;
+  uint32_t next_ue;
+  uint32_t active_ues;
+  uint32_t finished_ues;
+  uint64_t next_start_us;
+  mme_load_timer_queue_t hold_queue;
+  mme_load_timer_queue_t timeout_queue;
+  mme_load_stats_t stats;
+  int epoll_fd;
+} mme_load_t;
+
+static mme_load_t mme_load = {0};
+static volatile sig_atomic_t mme_load_stop = 0;
+
+static void mme_load_ue_run_step(mme_load_ue_t *ue);
+static void mme_load_enb_start_reset(mme_load_enb_t *enb);
+
+//------------------------------------------------------------------------------
+static uint64_t mme_load_now_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_signal_handler(int signum)
+{
+  mme_load_stop = 1;
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_no_free(void **memory)
+{
+  // UEs are owned by mme_load.ues
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_timer_push(
+  mme_load_timer_queue_t *queue,
+  mme_load_ue_t *ue,
+  uint64_t expiry_us)
+{
+  mme_load_timer_t *timer = calloc(1, sizeof(*timer));
+
+  timer->ue = ue;
+  timer->seq = ue->proc_seq;
+  timer->expiry_us = expiry_us;
+  if (queue->tail) {
+    queue->tail->next = timer;
+  } else {
+    queue->head = timer;
+  }
+  queue->tail = timer;
+}
+
+//------------------------------------------------------------------------------
+static mme_load_timer_t *mme_load_timer_pop_expired(
+  mme_load_timer_queue_t *queue,
+  uint64_t now_us)
+{
+  mme_load_timer_t *timer = queue->head;
+
+  if (!timer || timer->expiry_us > now_us) {
+    return NULL;
+  }
+  queue->head = timer->next;
+  if (!queue->head) {
+    queue->tail = NULL;
+  }
+  return timer;
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_send(
+  mme_load_enb_t *enb,
+  uint16_t stream,
+  uint8_t *buffer,
+  uint32_t length)
+{
+  int rc = 0;
+
+  if (
+    sctp_sendmsg(
+      enb->fd,
+      buffer,
+      length,
+      NULL,
+      0,
+      htonl(S1AP_SCTP_PPID),
+      0,
+      stream,
+      0,
+      0) < 0) {
+    fprintf(
+      stderr,
+      "eNB %u: sctp_sendmsg failed: %s\n",
+      enb->config.enb_id,
+      strerror(errno));
+    rc = -1;
+  } else {
+    mme_load.stats.s1ap_tx++;
+  }
+  free(buffer);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_proc_start(mme_load_ue_t *ue, mme_load_proc_t proc)
+{
+  ue->proc = proc;
+  ue->proc_seq++;
+  ue->proc_start_us = mme_load_now_us();
+  mme_load_stats_proc_start(&mme_load.stats, proc);
+  mme_load_timer_push(
+    &mme_load.timeout_queue,
+    ue,
+    ue->proc_start_us + (uint64_t) mme_load.config.timeout_ms * 1000);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_finish(mme_load_ue_t *ue)
+{
+  if (ue->done) {
+    return;
+  }
+  ue->done = true;
+  ue->proc = MME_LOAD_PROC_NONE;
+  ue->proc_seq++;
+  mme_load.active_ues--;
+  mme_load.finished_ues++;
+  if (mme_load.config.reset && !ue->reset_done) {
+    // The eNB does not wait for UEs which will never reach the reset
+    ue->reset_done = true;
+    ue->enb->pending_ues--;
+    mme_load_enb_start_reset(ue->enb);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_proc_fail(mme_load_ue_t *ue, bool timed_out)
+{
+  if (ue->proc != MME_LOAD_PROC_NONE) {
+    mme_load_stats_proc_fail(&mme_load.stats, ue->proc, timed_out);
+  }
+  mme_load_ue_finish(ue);
+}
+
+/* End the running procedure and schedule the next step of the UE script */
+//------------------------------------------------------------------------------
+static void mme_load_ue_proc_end(mme_load_ue_t *ue)
+{
+  mme_load_stats_proc_end(
+    &mme_load.stats, ue->proc, mme_load_now_us() - ue->proc_start_us);
+  ue->proc = MME_LOAD_PROC_NONE;
+  ue->proc_seq++;
+  mme_load_timer_push(
+    &mme_load.hold_queue,
+    ue,
+    mme_load_now_us() + (uint64_t) mme_load.config.hold_ms * 1000);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_send_initial(
+  mme_load_ue_t *ue,
+  uint8_t *nas,
+  size_t nas_length)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  ue->has_mme_ue_s1ap_id = false;
+  if (
+    mme_load_s1ap_initial_ue_message(
+      &ue->enb->config,
+      ue->index,
+      nas,
+      nas_length,
+      &ue->nas,
+      &buffer,
+      &length) < 0) {
+    mme_load_ue_proc_fail(ue, false);
+    return;
+  }
+  ue->connected = true;
+  if (mme_load_send(ue->enb, ue->stream, buffer, length) < 0) {
+    mme_load_ue_proc_fail(ue, false);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_send_uplink(
+  mme_load_ue_t *ue,
+  uint8_t *nas,
+  size_t nas_length)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  if (
+    mme_load_s1ap_uplink_nas_transport(
+      &ue->enb->config,
+      ue->mme_ue_s1ap_id,
+      ue->index,
+      nas,
+      nas_length,
+      &buffer,
+      &length) < 0) {
+    return;
+  }
+  mme_load_send(ue->enb, ue->stream, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_update_guti(
+  mme_load_ue_t *ue,
+  const mme_load_nas_downlink_t *msg)
+{
+  void *unused = NULL;
+
+  if (!msg->has_guti) {
+    return;
+  }
+  if (ue->nas.has_guti) {
+    hashtable_remove(
+      mme_load.m_tmsi_htbl, mme_load_nas_m_tmsi(&ue->nas), &unused);
+  }
+  memcpy(ue->nas.guti, msg->guti, MME_LOAD_NAS_GUTI_LENGTH);
+  ue->nas.has_guti = true;
+  hashtable_insert(mme_load.m_tmsi_htbl, mme_load_nas_m_tmsi(&ue->nas), ue);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_start_service_request(
+  mme_load_ue_t *ue,
+  mme_load_proc_t proc)
+{
+  uint8_t nas[MME_LOAD_NAS_MAX_LENGTH];
+  size_t nas_length = 0;
+
+  mme_load_ue_proc_start(ue, proc);
+  nas_length = mme_load_nas_service_request(&ue->nas, nas);
+  mme_load_ue_send_initial(ue, nas, nas_length);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_start_release(mme_load_ue_t *ue)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  mme_load_ue_proc_start(ue, MME_LOAD_PROC_UE_CONTEXT_RELEASE);
+  if (
+    mme_load_s1ap_ue_context_release_request(
+      ue->mme_ue_s1ap_id, ue->index, &buffer, &length) < 0 ||
+    mme_load_send(ue->enb, ue->stream, buffer, length) < 0) {
+    mme_load_ue_proc_fail(ue, false);
+  }
+}
+
+/* The UE stays connected and leaves the concurrency window until its eNB is
+ * reset, so that the reset always covers every UE of the eNB */
+//------------------------------------------------------------------------------
+static void mme_load_ue_park(mme_load_ue_t *ue)
+{
+  ue->parked = true;
+  ue->reset_done = true;
+  ue->proc_seq++;
+  mme_load.active_ues--;
+  ue->enb->pending_ues--;
+  ue->enb->parked_ues++;
+  mme_load_enb_start_reset(ue->enb);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_enb_start_reset(mme_load_enb_t *enb)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  if (enb->pending_ues || !enb->parked_ues || enb->reset_start_us) {
+    return;
+  }
+  enb->reset_start_us = mme_load_now_us();
+  mme_load_stats_proc_start(&mme_load.stats, MME_LOAD_PROC_ENB_RESET);
+  if (mme_load_s1ap_reset(&buffer, &length) == 0) {
+    mme_load_send(enb, 0, buffer, length);
+  }
+}
+
+/* Resume the script of the parked UEs of the eNB, as idle UEs when the reset
+ * was acknowledged or ending them when it timed out */
+//------------------------------------------------------------------------------
+static void mme_load_enb_end_reset(mme_load_enb_t *enb, bool acknowledged)
+{
+  uint32_t first = (uint32_t)(enb - mme_load.enbs);
+
+  if (acknowledged) {
+    mme_load_stats_proc_end(
+      &mme_load.stats,
+      MME_LOAD_PROC_ENB_RESET,
+      mme_load_now_us() - enb->reset_start_us);
+  } else {
+    mme_load_stats_proc_fail(&mme_load.stats, MME_LOAD_PROC_ENB_RESET, true);
+  }
+  enb->parked_ues = 0;
+  for (uint32_t i = first; i < mme_load.next_ue; i += mme_load.config.n_enbs) {
+    mme_load_ue_t *ue = &mme_load.ues[i];
+    if (!ue->parked) {
+      continue;
+    }
+    ue->parked = false;
+    mme_load.active_ues++;
+    if (!acknowledged) {
+      mme_load_ue_finish(ue);
+      continue;
+    }
+    ue->connected = false;
+    ue->has_mme_ue_s1ap_id = false;
+    mme_load_timer_push(
+      &mme_load.hold_queue,
+      ue,
+      mme_load_now_us() + (uint64_t) mme_load.config.hold_ms * 1000);
+  }
+}
+
+/* Run the current step of the UE script, steps starting from idle are
+ * preceded by a UE context release if the UE is still connected */
+//------------------------------------------------------------------------------
+static void mme_load_ue_run_step(mme_load_ue_t *ue)
+{
+  uint8_t nas[MME_LOAD_NAS_MAX_LENGTH];
+  size_t nas_length = 0;
+  mme_load_proc_t step = MME_LOAD_PROC_NONE;
+
+  if (ue->step >= mme_load.n_steps) {
+    mme_load_ue_finish(ue);
+    return;
+  }
+  step = mme_load.steps[ue->step];
+  if (step == MME_LOAD_PROC_ENB_RESET) {
+    ue->step++;
+    mme_load_ue_park(ue);
+    return;
+  }
+  if (step == MME_LOAD_PROC_UE_CONTEXT_RELEASE && !ue->connected) {
+    ue->step++;
+    mme_load_ue_run_step(ue);
+    return;
+  }
+  if (step != MME_LOAD_PROC_UE_CONTEXT_RELEASE && ue->connected) {
+    if (!ue->has_mme_ue_s1ap_id) {
+      mme_load_ue_proc_fail(ue, false);
+      return;
+    }
+    mme_load_ue_start_release(ue);
+    return;
+  }
+  ue->step++;
+
+  switch (step) {
+    case MME_LOAD_PROC_ATTACH:
+      mme_load_ue_proc_start(ue, MME_LOAD_PROC_ATTACH);
+      nas_length = mme_load_nas_attach_request(&ue->nas, nas);
+      mme_load_ue_send_initial(ue, nas, nas_length);
+      break;
+    case MME_LOAD_PROC_UE_CONTEXT_RELEASE:
+      mme_load_ue_start_release(ue);
+      break;
+    case MME_LOAD_PROC_SERVICE_REQUEST:
+      mme_load_ue_start_service_request(ue, MME_LOAD_PROC_SERVICE_REQUEST);
+      break;
+    case MME_LOAD_PROC_TAU:
+      mme_load_ue_proc_start(ue, MME_LOAD_PROC_TAU);
+      nas_length = mme_load_nas_tau_request(&ue->nas, nas);
+      mme_load_ue_send_initial(ue, nas, nas_length);
+      break;
+    case MME_LOAD_PROC_DETACH:
+      mme_load_ue_proc_start(ue, MME_LOAD_PROC_DETACH);
+      nas_length = mme_load_nas_detach_request(&ue->nas, nas);
+      mme_load_ue_send_initial(ue, nas, nas_length);
+      break;
+    default:
+      mme_load_ue_finish(ue);
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_handle_nas(
+  mme_load_ue_t *ue,
+  const uint8_t *pdu,
+  size_t pdu_length)
+{
+  mme_load_nas_downlink_t msg;
+  uint8_t nas[MME_LOAD_NAS_MAX_LENGTH];
+  uint8_t res[MME_LOAD_AUTH_XRES_LENGTH];
+  size_t nas_length = 0;
+
+  if (mme_load_nas_decode(pdu, pdu_length, &msg) < 0) {
+    mme_load.stats.nas_unexpected++;
+    return;
+  }
+
+  switch (msg.type) {
+    case MME_LOAD_NAS_MSG_AUTHENTICATION_REQUEST:
+      mme_load_nas_authenticate(&ue->nas, &msg, res);
+      nas_length = mme_load_nas_authentication_response(&ue->nas, res, nas);
+      mme_load_ue_send_uplink(ue, nas, nas_length);
+      break;
+
+    case MME_LOAD_NAS_MSG_IDENTITY_REQUEST:
+      nas_length = mme_load_nas_identity_response(&ue->nas, nas);
+      mme_load_ue_send_uplink(ue, nas, nas_length);
+      break;
+
+    case MME_LOAD_NAS_MSG_SECURITY_MODE_COMMAND:
+      mme_load_nas_activate_security(&ue->nas, &msg);
+      nas_length = mme_load_nas_security_mode_complete(
+        &ue->nas, msg.imeisv_requested, nas);
+      mme_load_ue_send_uplink(ue, nas, nas_length);
+      break;
+
+    case MME_LOAD_NAS_MSG_ESM_INFORMATION_REQUEST:
+      nas_length =
+        mme_load_nas_esm_information_response(&ue->nas, msg.pti, nas);
+      mme_load_ue_send_uplink(ue, nas, nas_length);
+      break;
+
+    case MME_LOAD_NAS_MSG_ATTACH_ACCEPT:
+      ue->nas.ebi = msg.ebi;
+      mme_load_ue_update_guti(ue, &msg);
+      nas_length = mme_load_nas_attach_complete(&ue->nas, nas);
+      mme_load_ue_send_uplink(ue, nas, nas_length);
+      if (ue->proc == MME_LOAD_PROC_ATTACH) {
+        mme_load_ue_proc_end(ue);
+      }
+      break;
+
+    case MME_LOAD_NAS_MSG_TAU_ACCEPT:
+      if (msg.has_guti) {
+        mme_load_ue_update_guti(ue, &msg);
+        nas_length = mme_load_nas_tau_complete(&ue->nas, nas);
+        mme_load_ue_send_uplink(ue, nas, nas_length);
+      }
+      if (ue->proc == MME_LOAD_PROC_TAU) {
+        mme_load_ue_proc_end(ue);
+      }
+      break;
+
+    case MME_LOAD_NAS_MSG_DETACH_ACCEPT:
+      if (ue->proc == MME_LOAD_PROC_DETACH) {
+        mme_load_ue_proc_end(ue);
+      }
+      break;
+
+    case MME_LOAD_NAS_MSG_DETACH_REQUEST:
+      // Network initiated detach, the UE leaves the run
+      mme_load.stats.nas_unexpected++;
+      nas_length = mme_load_nas_detach_accept(&ue->nas, nas);
+      mme_load_ue_send_uplink(ue, nas, nas_length);
+      mme_load_ue_proc_fail(ue, false);
+      break;
+
+    case MME_LOAD_NAS_MSG_AUTHENTICATION_REJECT:
+    case MME_LOAD_NAS_MSG_ATTACH_REJECT:
+    case MME_LOAD_NAS_MSG_TAU_REJECT:
+    case MME_LOAD_NAS_MSG_SERVICE_REJECT:
+      mme_load_ue_proc_fail(ue, false);
+      break;
+
+    case MME_LOAD_NAS_MSG_EMM_INFORMATION:
+      break;
+
+    default:
+      mme_load.stats.nas_unexpected++;
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_handle_initial_context_setup(
+  mme_load_ue_t *ue,
+  const mme_load_s1ap_downlink_t *msg)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  if (
+    mme_load_s1ap_initial_context_setup_response(
+      &ue->enb->config,
+      ue->mme_ue_s1ap_id,
+      ue->index,
+      msg->e_rab_id,
+      ue->index + 1,
+      &buffer,
+      &length) == 0) {
+    mme_load_send(ue->enb, ue->stream, buffer, length);
+  }
+  if (msg->nas_length) {
+    mme_load_ue_handle_nas(ue, msg->nas, msg->nas_length);
+  } else if (
+    ue->proc == MME_LOAD_PROC_SERVICE_REQUEST ||
+    ue->proc == MME_LOAD_PROC_PAGING) {
+    mme_load_ue_proc_end(ue);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_ue_handle_release_command(
+  mme_load_ue_t *ue,
+  const mme_load_s1ap_downlink_t *msg)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  if (
+    mme_load_s1ap_ue_context_release_complete(
+      msg->mme_ue_s1ap_id, ue->index, &buffer, &length) == 0) {
+    mme_load_send(ue->enb, ue->stream, buffer, length);
+  }
+  ue->connected = false;
+  ue->has_mme_ue_s1ap_id = false;
+  if (ue->proc == MME_LOAD_PROC_UE_CONTEXT_RELEASE) {
+    mme_load_ue_proc_end(ue);
+  } else if (ue->proc != MME_LOAD_PROC_NONE && !ue->done) {
+    // Released in the middle of a procedure
+    mme_load_ue_proc_fail(ue, false);
+  }
+}
+
+//------------------------------------------------------------------------------
+static mme_load_ue_t *mme_load_find_ue(
+  mme_load_enb_t *enb,
+  const mme_load_s1ap_downlink_t *msg)
+{
+  if (msg->has_enb_ue_s1ap_id) {
+    if (
+      msg->enb_ue_s1ap_id < mme_load.config.n_ues &&
+      mme_load.ues[msg->enb_ue_s1ap_id].enb == enb) {
+      return &mme_load.ues[msg->enb_ue_s1ap_id];
+    }
+    return NULL;
+  }
+  // Only the MME UE S1AP ID is known, this is not on the fast path
+  for (uint32_t i = 0; i < mme_load.next_ue; i++) {
+    mme_load_ue_t *ue = &mme_load.ues[i];
+    if (
+      ue->enb == enb && ue->has_mme_ue_s1ap_id &&
+      ue->mme_ue_s1ap_id == msg->mme_ue_s1ap_id) {
+      return ue;
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_handle_paging(const mme_load_s1ap_downlink_t *msg)
+{
+  mme_load_ue_t *ue = NULL;
+
+  if (
+    hashtable_get(mme_load.m_tmsi_htbl, msg->m_tmsi, (void **) &ue) !=
+    HASH_TABLE_OK) {
+    return;
+  }
+  // The same paging is received on every eNB serving the TAI
+  if (ue->done || ue->connected || ue->proc != MME_LOAD_PROC_NONE) {
+    return;
+  }
+  mme_load_ue_start_service_request(ue, MME_LOAD_PROC_PAGING);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_handle_pdu(
+  mme_load_enb_t *enb,
+  const uint8_t *buffer,
+  uint32_t length)
+{
+  mme_load_s1ap_downlink_t msg;
+  mme_load_ue_t *ue = NULL;
+
+  mme_load.stats.s1ap_rx++;
+  if (mme_load_s1ap_decode(buffer, length, &msg) < 0) {
+    mme_load.stats.s1ap_decode_errors++;
+    return;
+  }
+
+  switch (msg.type) {
+    case MME_LOAD_S1AP_MSG_S1_SETUP_RESPONSE:
+      if (!enb->setup_done) {
+        enb->setup_done = true;
+        mme_load_stats_proc_end(
+          &mme_load.stats,
+          MME_LOAD_PROC_S1_SETUP,
+          mme_load_now_us() - enb->setup_start_us);
+      }
+      return;
+    case MME_LOAD_S1AP_MSG_S1_SETUP_FAILURE:
+      mme_load_stats_proc_fail(&mme_load.stats, MME_LOAD_PROC_S1_SETUP, false);
+      fprintf(stderr, "eNB %u: S1 Setup failure\n", enb->config.enb_id);
+      mme_load_stop = 1;
+      return;
+    case MME_LOAD_S1AP_MSG_PAGING:
+      mme_load_handle_paging(&msg);
+      return;
+    case MME_LOAD_S1AP_MSG_RESET_ACKNOWLEDGE:
+      if (enb->parked_ues) {
+        mme_load_enb_end_reset(enb, true);
+      }
+      return;
+    default:
+      break;
+  }
+
+  ue = mme_load_find_ue(enb, &msg);
+  if (!ue) {
+    return;
+  }
+  // UEs which left the run only answer to the release of their context
+  if (ue->done && msg.type != MME_LOAD_S1AP_MSG_UE_CONTEXT_RELEASE_COMMAND) {
+    return;
+  }
+  if (msg.type != MME_LOAD_S1AP_MSG_UE_CONTEXT_RELEASE_COMMAND) {
+    ue->mme_ue_s1ap_id = msg.mme_ue_s1ap_id;
+    ue->has_mme_ue_s1ap_id = true;
+  }
+
+  switch (msg.type) {
+    case MME_LOAD_S1AP_MSG_DOWNLINK_NAS_TRANSPORT:
+      mme_load_ue_handle_nas(ue, msg.nas, msg.nas_length);
+      break;
+    case MME_LOAD_S1AP_MSG_INITIAL_CONTEXT_SETUP_REQUEST:
+      mme_load_ue_handle_initial_context_setup(ue, &msg);
+      break;
+    case MME_LOAD_S1AP_MSG_UE_CONTEXT_RELEASE_COMMAND:
+      mme_load_ue_handle_release_command(ue, &msg);
+      break;
+    default:
+      break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_enb_receive(mme_load_enb_t *enb)
+{
+  uint8_t buffer[MME_LOAD_MAX_PDU_LENGTH];
+  struct sctp_sndrcvinfo sinfo;
+  int flags = 0;
+  int n = 0;
+
+  for (;;) {
+    flags = 0;
+    n = sctp_recvmsg(
+      enb->fd, buffer, sizeof(buffer), NULL, NULL, &sinfo, &flags);
+    if (n < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+        fprintf(
+          stderr,
+          "eNB %u: sctp_recvmsg failed: %s\n",
+          enb->config.enb_id,
+          strerror(errno));
+        mme_load_stop = 1;
+      }
+      return;
+    }
+    if (n == 0) {
+      fprintf(stderr, "eNB %u: association closed\n", enb->config.enb_id);
+      epoll_ctl(mme_load.epoll_fd, EPOLL_CTL_DEL, enb->fd, NULL);
+      mme_load_stop = 1;
+      return;
+    }
+    if (flags & MSG_NOTIFICATION) {
+      continue;
+    }
+    mme_load_handle_pdu(enb, buffer, (uint32_t) n);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_enb_connect(mme_load_enb_t *enb)
+{
+  struct sctp_initmsg init;
+  struct sctp_status status;
+  struct epoll_event event;
+  socklen_t optlen = sizeof(status);
+
+  enb->fd = socket(AF_INET, SOCK_STREAM, IPPROTO_SCTP);
+  if (enb->fd < 0) {
+    perror("socket");
+    return -1;
+  }
+  memset(&init, 0, sizeof(init));
+  init.sinit_num_ostreams = mme_load.config.streams;
+  init.sinit_max_instreams = mme_load.config.streams;
+  if (setsockopt(enb->fd, IPPROTO_SCTP, SCTP_INITMSG, &init, sizeof(init))) {
+    perror("setsockopt SCTP_INITMSG");
+    return -1;
+  }
+  if (
+    connect(
+      enb->fd,
+      (struct sockaddr *) &mme_load.config.mme_addr,
+      sizeof(mme_load.config.mme_addr)) < 0) {
+    perror("connect");
+    return -1;
+  }
+  memset(&status, 0, sizeof(status));
+  if (getsockopt(enb->fd, IPPROTO_SCTP, SCTP_STATUS, &status, &optlen) == 0) {
+    enb->out_streams = status.sstat_outstrm;
+  }
+  if (enb->out_streams < 2) {
+    // Stream 0 is reserved to non UE associated signalling
+    fprintf(
+      stderr,
+      "eNB %u: MME accepted %u outbound streams, at least 2 are needed\n",
+      enb->config.enb_id,
+      enb->out_streams);
+    return -1;
+  }
+
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.ptr = enb;
+  return epoll_ctl(mme_load.epoll_fd, EPOLL_CTL_ADD, enb->fd, &event);
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_enb_setup(mme_load_enb_t *enb)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  if (mme_load_s1ap_s1_setup_request(&enb->config, &buffer, &length) < 0) {
+    return -1;
+  }
+  enb->setup_start_us = mme_load_now_us();
+  mme_load_stats_proc_start(&mme_load.stats, MME_LOAD_PROC_S1_SETUP);
+  return mme_load_send(enb, 0, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_poll(int timeout_ms)
+{
+  struct epoll_event events[MME_LOAD_MAX_EPOLL_EVENTS];
+  int n = epoll_wait(
+    mme_load.epoll_fd, events, MME_LOAD_MAX_EPOLL_EVENTS, timeout_ms);
+
+  for (int i = 0; i < n; i++) {
+    mme_load_enb_receive((mme_load_enb_t *) events[i].data.ptr);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_process_timers(uint64_t now_us)
+{
+  mme_load_timer_t *timer = NULL;
+
+  while ((timer = mme_load_timer_pop_expired(&mme_load.timeout_queue, now_us))) {
+    mme_load_ue_t *ue = timer->ue;
+    if (
+      timer->seq == ue->proc_seq && !ue->done &&
+      ue->proc != MME_LOAD_PROC_NONE) {
+      mme_load_ue_proc_fail(ue, true);
+    }
+    free(timer);
+  }
+  while ((timer = mme_load_timer_pop_expired(&mme_load.hold_queue, now_us))) {
+    mme_load_ue_t *ue = timer->ue;
+    if (timer->seq == ue->proc_seq && !ue->done) {
+      mme_load_ue_run_step(ue);
+    }
+    free(timer);
+  }
+  for (uint32_t i = 0; mme_load.config.reset && i < mme_load.config.n_enbs;
+       i++) {
+    mme_load_enb_t *enb = &mme_load.enbs[i];
+    if (
+      enb->parked_ues && enb->reset_start_us &&
+      now_us - enb->reset_start_us >
+        (uint64_t) mme_load.config.timeout_ms * 1000) {
+      mme_load_enb_end_reset(enb, false);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_start_ues(uint64_t now_us)
+{
+  while (mme_load.next_ue < mme_load.config.n_ues &&
+         mme_load.active_ues < mme_load.config.concurrency) {
+    mme_load_ue_t *ue = NULL;
+    char imsi[16];
+
+    if (mme_load.config.rate) {
+      if (now_us < mme_load.next_start_us) {
+        return;
+      }
+      mme_load.next_start_us += 1000000 / mme_load.config.rate;
+    }
+    ue = &mme_load.ues[mme_load.next_ue];
+    ue->index = mme_load.next_ue;
+    ue->enb = &mme_load.enbs[ue->index % mme_load.config.n_enbs];
+    ue->stream = 1 + (ue->index / mme_load.config.n_enbs) %
+                       (ue->enb->out_streams - 1);
+    ue->proc = MME_LOAD_PROC_NONE;
+    snprintf(
+      imsi,
+      sizeof(imsi),
+      "%015" PRIu64,
+      mme_load.config.imsi_base + ue->index);
+    mme_load_nas_context_init(&ue->nas, imsi);
+    mme_load.next_ue++;
+    mme_load.active_ues++;
+    mme_load_ue_run_step(ue);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_next_timeout_ms(uint64_t now_us)
+{
+  uint64_t next_us = now_us + 100000;
+
+  if (
+    mme_load.hold_queue.head && mme_load.hold_queue.head->expiry_us < next_us) {
+    next_us = mme_load.hold_queue.head->expiry_us;
+  }
+  if (
+    mme_load.timeout_queue.head &&
+    mme_load.timeout_queue.head->expiry_us < next_us) {
+    next_us = mme_load.timeout_queue.head->expiry_us;
+  }
+  if (
+    mme_load.config.rate && mme_load.next_ue < mme_load.config.n_ues &&
+    mme_load.next_start_us < next_us) {
+    next_us = mme_load.next_start_us;
+  }
+  if (next_us <= now_us) {
+    return 0;
+  }
+  return (int) ((next_us - now_us + 999) / 1000);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_build_steps(void)
+{
+  const mme_load_config_t *config = &mme_load.config;
+  uint32_t n = 0;
+
+  mme_load.steps = calloc(
+    5 + 2 * config->cycles + 2, sizeof(mme_load_proc_t));
+  mme_load.steps[n++] = MME_LOAD_PROC_ATTACH;
+  if (config->reset) {
+    // The UEs are idle after the reset, the release below is skipped
+    mme_load.steps[n++] = MME_LOAD_PROC_ENB_RESET;
+  }
+  for (uint32_t i = 0; i < config->cycles; i++) {
+    mme_load.steps[n++] = MME_LOAD_PROC_UE_CONTEXT_RELEASE;
+    mme_load.steps[n++] = MME_LOAD_PROC_SERVICE_REQUEST;
+  }
+  mme_load.steps[n++] = MME_LOAD_PROC_UE_CONTEXT_RELEASE;
+  if (config->tau) {
+    mme_load.steps[n++] = MME_LOAD_PROC_TAU;
+    mme_load.steps[n++] = MME_LOAD_PROC_UE_CONTEXT_RELEASE;
+  }
+  if (config->detach) {
+    mme_load.steps[n++] = MME_LOAD_PROC_DETACH;
+  }
+  mme_load.n_steps = n;
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_usage(const char *name)
+{
+  fprintf(
+    stderr,
+    "Usage: %s [options]\n"
+    "  -m, --mme <ipv4>         MME S1-MME address (default 127.0.0.1)\n"
+    "  -e, --enbs <n>           Number of simulated eNBs (default 1)\n"
+    "  -u, --ues <n>            Number of simulated UEs (default 100)\n"
+    "  -c, --concurrency <n>    UEs running procedures at once (default 10)\n"
+    "  -r, --rate <n>           UE arrivals per second, 0 = no pacing\n"
+    "  -n, --cycles <n>         Release/service request cycles per UE (1)\n"
+    "  -t, --tau                Run a periodic TAU from idle\n"
+    "  -d, --detach             Detach the UEs at the end of their script\n"
+    "  -R, --reset              Reset each eNB once all its UEs are attached\n"
+    "  -H, --hold-ms <ms>       Time between two procedures of a UE (0)\n"
+    "  -T, --timeout-ms <ms>    Per procedure timeout (default 10000)\n"
+    "  -p, --plmn <mcc:mnc>     Served PLMN (default 001:01)\n"
+    "  -a, --tac <tac>          Tracking area code (default 1)\n"
+    "  -i, --imsi <imsi>        IMSI of the first UE (default 001010000000001)\n"
+    "  -b, --enb-id <id>        Macro eNB ID of the first eNB (default 1)\n"
+    "  -s, --streams <n>        SCTP streams per association (default 32)\n",
+    name);
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_parse_args(int argc, char *argv[])
+{
+  static const struct option long_options[] = {
+    {"mme", required_argument, NULL, 'm'},
+    {"enbs", required_argument, NULL, 'e'},
+    {"ues", required_argument, NULL, 'u'},
+    {"concurrency", required_argument, NULL, 'c'},
+    {"rate", required_argument, NULL, 'r'},
+    {"cycles", required_argument, NULL, 'n'},
+    {"tau", no_argument, NULL, 't'},
+    {"detach", no_argument, NULL, 'd'},
+    {"reset", no_argument, NULL, 'R'},
+    {"hold-ms", required_argument, NULL, 'H'},
+    {"timeout-ms", required_argument, NULL, 'T'},
+    {"plmn", required_argument, NULL, 'p'},
+    {"tac", required_argument, NULL, 'a'},
+    {"imsi", required_argument, NULL, 'i'},
+    {"enb-id", required_argument, NULL, 'b'},
+    {"streams", required_argument, NULL, 's'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0},
+  };
+  mme_load_config_t *config = &mme_load.config;
+  char mnc[4] = {0};
+  int c = 0;
+
+  config->mme_addr.sin_family = AF_INET;
+  config->mme_addr.sin_port = htons(S1AP_PORT_NUMBER);
+  config->mme_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  config->n_enbs = 1;
+  config->n_ues = 100;
+  config->concurrency = 10;
+  config->cycles = 1;
+  config->timeout_ms = 10000;
+  config->mcc = 1;
+  config->mnc = 1;
+  config->mnc_digit_length = 2;
+  config->tac = 1;
+  config->imsi_base = 1010000000001ULL;
+  config->enb_id_base = 1;
+  config->streams = 32;
+  config->s1u_ipv4 = htonl(INADDR_LOOPBACK);
+
+  while ((c = getopt_long(
+            argc, argv, "m:e:u:c:r:n:tdRH:T:p:a:i:b:s:h", long_options, NULL)) !=
+         -1) {
+    switch (c) {
+      case 'm':
+        if (inet_pton(AF_INET, optarg, &config->mme_addr.sin_addr) != 1) {
+          fprintf(stderr, "Invalid MME address %s\n", optarg);
+          return -1;
+        }
+        break;
+      case 'e': config->n_enbs = strtoul(optarg, NULL, 10); break;
+      case 'u': config->n_ues = strtoul(optarg, NULL, 10); break;
+      case 'c': config->concurrency = strtoul(optarg, NULL, 10); break;
+      case 'r': config->rate = strtoul(optarg, NULL, 10); break;
+      case 'n': config->cycles = strtoul(optarg, NULL, 10); break;
+      case 't': config->tau = true; break;
+      case 'd': config->detach = true; break;
+      case 'R': config->reset = true; break;
+      case 'H': config->hold_ms = strtoul(optarg, NULL, 10); break;
+      case 'T': config->timeout_ms = strtoul(optarg, NULL, 10); break;
+      case 'p': {
+        unsigned int mcc_value = 0;
+        if (sscanf(optarg, "%3u:%3[0-9]", &mcc_value, mnc) != 2) {
+          fprintf(stderr, "Invalid PLMN %s\n", optarg);
+          return -1;
+        }
+        config->mcc = mcc_value;
+        config->mnc = strtoul(mnc, NULL, 10);
+        config->mnc_digit_length = strlen(mnc);
+      } break;
+      case 'a': config->tac = strtoul(optarg, NULL, 10); break;
+      case 'i': config->imsi_base = strtoull(optarg, NULL, 10); break;
+      case 'b': config->enb_id_base = strtoul(optarg, NULL, 10); break;
+      case 's': config->streams = strtoul(optarg, NULL, 10); break;
+      default: return -1;
+    }
+  }
+  if (
+    !config->n_enbs || !config->n_ues || !config->concurrency ||
+    config->streams < 2 || config->mnc_digit_length < 2) {
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  uint64_t start_us = 0;
+  uint64_t now_us = 0;
+  bstring name = NULL;
+
+  if (mme_load_parse_args(argc, argv) < 0) {
+    mme_load_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (
+    OAILOG_INIT("MME_LOAD", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    fprintf(stderr, "Failed to initialize logging\n");
+    return EXIT_FAILURE;
+  }
+  signal(SIGINT, mme_load_signal_handler);
+  signal(SIGTERM, mme_load_signal_handler);
+  signal(SIGPIPE, SIG_IGN);
+
+  mme_load_build_steps();
+  mme_load.enbs = calloc(mme_load.config.n_enbs, sizeof(mme_load_enb_t));
+  mme_load.ues = calloc(mme_load.config.n_ues, sizeof(mme_load_ue_t));
+  name = bfromcstr("mme_load_m_tmsi_htbl");
+  mme_load.m_tmsi_htbl =
+    hashtable_create(mme_load.config.n_ues, NULL, mme_load_no_free, name);
+  bdestroy(name);
+  mme_load.epoll_fd = epoll_create1(0);
+  if (
+    !mme_load.enbs || !mme_load.ues || !mme_load.m_tmsi_htbl ||
+    mme_load.epoll_fd < 0) {
+    fprintf(stderr, "Failed to allocate the load generator state\n");
+    return EXIT_FAILURE;
+  }
+
+  start_us = mme_load_now_us();
+  for (uint32_t i = 0; i < mme_load.config.n_enbs; i++) {
+    mme_load_enb_t *enb = &mme_load.enbs[i];
+    enb->config.enb_id = mme_load.config.enb_id_base + i;
+    enb->config.mcc = mme_load.config.mcc;
+    enb->config.mnc = mme_load.config.mnc;
+    enb->config.mnc_digit_length = mme_load.config.mnc_digit_length;
+    enb->config.tac = mme_load.config.tac;
+    enb->config.s1u_ipv4 = mme_load.config.s1u_ipv4;
+    // UEs are spread round robin over the eNBs
+    enb->pending_ues = mme_load.config.n_ues / mme_load.config.n_enbs +
+                       (i < mme_load.config.n_ues % mme_load.config.n_enbs);
+    if (mme_load_enb_connect(enb) < 0 || mme_load_enb_setup(enb) < 0) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Wait for every eNB to be set up before the UEs show up
+  while (!mme_load_stop &&
+         mme_load.stats.proc[MME_LOAD_PROC_S1_SETUP].succeeded <
+           mme_load.config.n_enbs) {
+    mme_load_poll(100);
+    if (
+      mme_load_now_us() - start_us >
+      (uint64_t) mme_load.config.timeout_ms * 1000) {
+      fprintf(stderr, "Timeout waiting for S1 Setup\n");
+      mme_load_stop = 1;
+    }
+  }
+
+  mme_load.next_start_us = mme_load_now_us();
+  while (!mme_load_stop &&
+         mme_load.finished_ues < mme_load.config.n_ues) {
+    now_us = mme_load_now_us();
+    mme_load_start_ues(now_us);
+    mme_load_process_timers(now_us);
+    mme_load_poll(mme_load_next_timeout_ms(mme_load_now_us()));
+  }
+
+  mme_load_stats_report(stdout, &mme_load.stats, mme_load_now_us() - start_us);
+
+  for (uint32_t i = 0; i < mme_load.config.n_enbs; i++) {
+    if (mme_load.enbs[i].fd > 0) {
+      close(mme_load.enbs[i].fd);
+    }
+  }
+  return (mme_load.stats.proc[MME_LOAD_PROC_ATTACH].succeeded ==
+          mme_load.config.n_ues) ?
+           EXIT_SUCCESS :
+           EXIT_FAILURE;
+}
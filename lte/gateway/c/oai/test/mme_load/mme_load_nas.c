@@ -0,0 +1,604 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_nas.c
+  \brief Minimal UE side NAS (TS 24.301) codec used by the MME load generator
+
+  Only the message layouts the simulated UEs need are supported. Uplink
+  messages are integrity protected once a security context is active, EEA0 is
+  the only ciphering algorithm advertised so no message is ever ciphered.
+  The MAC of downlink messages is not checked.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "secu_defs.h"
+#include "security_types.h"
+#include "NasSecurityAlgorithms.h"
+#include "mme_load_auth.h"
+#include "mme_load_nas.h"
+
+#define PD_EMM 0x07
+#define PD_ESM 0x02
+
+#define SHT_PLAIN 0x0
+#define SHT_INTEGRITY 0x1
+#define SHT_INTEGRITY_CIPHERED 0x2
+#define SHT_INTEGRITY_NEW_CTX 0x3
+#define SHT_INTEGRITY_CIPHERED_NEW_CTX 0x4
+#define SHT_SERVICE_REQUEST 0xC
+
+#define SECURITY_HEADER_LENGTH 6 // SHT/PD, MAC, SQN
+
+#define EMM_ATTACH_REQUEST 0x41
+#define EMM_ATTACH_ACCEPT 0x42
+#define EMM_ATTACH_COMPLETE 0x43
+#define EMM_ATTACH_REJECT 0x44
+#define EMM_DETACH_REQUEST 0x45
+#define EMM_DETACH_ACCEPT 0x46
+#define EMM_TAU_REQUEST 0x48
+#define EMM_TAU_ACCEPT 0x49
+#define EMM_TAU_COMPLETE 0x4a
+#define EMM_TAU_REJECT 0x4b
+#define EMM_SERVICE_REJECT 0x4e
+#define EMM_AUTHENTICATION_REQUEST 0x52
+#define EMM_AUTHENTICATION_RESPONSE 0x53
+#define EMM_AUTHENTICATION_REJECT 0x54
+#define EMM_IDENTITY_REQUEST 0x55
+#define EMM_IDENTITY_RESPONSE 0x56
+#define EMM_SECURITY_MODE_COMMAND 0x5d
+#define EMM_SECURITY_MODE_COMPLETE 0x5e
+#define EMM_INFORMATION 0x61
+
+#define ESM_ACTIVATE_DEFAULT_BEARER_REQUEST 0xc1
+#define ESM_ACTIVATE_DEFAULT_BEARER_ACCEPT 0xc2
+#define ESM_PDN_CONNECTIVITY_REQUEST 0xd0
+#define ESM_INFORMATION_REQUEST 0xd9
+#define ESM_INFORMATION_RESPONSE 0xda
+
+#define IEI_GUTI 0x50
+#define IEI_UE_NETWORK_CAPABILITY 0x58
+#define IEI_IMEISV 0x23
+#define IEI_IMEISV_REQUEST 0xc0
+
+#define MOBILE_IDENTITY_IMSI 0x1
+#define MOBILE_IDENTITY_IMEISV 0x3
+#define MOBILE_IDENTITY_GUTI 0x6
+
+/* EEA0 only, EIA1 and EIA2 */
+#define UE_NETWORK_CAPABILITY_EEA 0x80
+#define UE_NETWORK_CAPABILITY_EIA 0x60
+
+static const char mme_load_nas_imeisv[] = "3534900698733190";
+
+//------------------------------------------------------------------------------
+static size_t mme_load_nas_encode_digits(
+  uint8_t type,
+  const char *digits,
+  uint8_t *buffer)
+{
+  size_t n_digits = strlen(digits);
+  size_t length = 0;
+  bool odd = n_digits & 1;
+
+  // First digit shares its octet with the odd/even indicator and the type
+  buffer[length++] = ((digits[0] - '0') << 4) | (odd << 3) | type;
+  for (size_t i = 1; i < n_digits; i += 2) {
+    uint8_t high = (i + 1 < n_digits) ? (digits[i + 1] - '0') : 0xf;
+    buffer[length++] = (high << 4) | (digits[i] - '0');
+  }
+  return length;
+}
+
+//------------------------------------------------------------------------------
+static size_t mme_load_nas_encode_guti(
+  const mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  buffer[0] = 1 + MME_LOAD_NAS_GUTI_LENGTH;
+  buffer[1] = 0xf0 | MOBILE_IDENTITY_GUTI;
+  memcpy(&buffer[2], ctx->guti, MME_LOAD_NAS_GUTI_LENGTH);
+  return 2 + MME_LOAD_NAS_GUTI_LENGTH;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t mme_load_nas_mac(
+  const mme_load_nas_context_t *ctx,
+  const uint8_t *message,
+  size_t length)
+{
+  nas_stream_cipher_t stream_cipher;
+  uint8_t mac[4] = {0};
+
+  stream_cipher.key = (uint8_t *) ctx->knas_int;
+  stream_cipher.key_length = MME_LOAD_NAS_KNAS_LENGTH;
+  stream_cipher.count = ctx->ul_count;
+  stream_cipher.bearer = 0x00;
+  stream_cipher.direction = SECU_DIRECTION_UPLINK;
+  stream_cipher.message = (uint8_t *) message;
+  stream_cipher.blength = length << 3;
+  switch (ctx->eia) {
+    case NAS_SECURITY_ALGORITHMS_EIA1:
+      nas_stream_encrypt_eia1(&stream_cipher, mac);
+      break;
+    case NAS_SECURITY_ALGORITHMS_EIA2:
+      nas_stream_encrypt_eia2(&stream_cipher, mac);
+      break;
+    default:
+      break;
+  }
+  return ((uint32_t) mac[0] << 24) | ((uint32_t) mac[1] << 16) |
+         ((uint32_t) mac[2] << 8) | mac[3];
+}
+
+/*
+ * Wrap the plain message already written at buffer + SECURITY_HEADER_LENGTH
+ * in a security protected header, or move it to the start of buffer if no
+ * security context is active yet.
+ */
+//------------------------------------------------------------------------------
+static size_t mme_load_nas_protect(
+  mme_load_nas_context_t *ctx,
+  uint8_t sht,
+  uint8_t *buffer,
+  size_t plain_length)
+{
+  uint32_t mac = 0;
+
+  if (!ctx->secured) {
+    memmove(buffer, buffer + SECURITY_HEADER_LENGTH, plain_length);
+    return plain_length;
+  }
+  buffer[0] = (sht << 4) | PD_EMM;
+  buffer[5] = ctx->ul_count & 0xff;
+  mac = mme_load_nas_mac(ctx, &buffer[5], plain_length + 1);
+  buffer[1] = (mac >> 24) & 0xff;
+  buffer[2] = (mac >> 16) & 0xff;
+  buffer[3] = (mac >> 8) & 0xff;
+  buffer[4] = mac & 0xff;
+  ctx->ul_count++;
+  return SECURITY_HEADER_LENGTH + plain_length;
+}
+
+//------------------------------------------------------------------------------
+void mme_load_nas_context_init(mme_load_nas_context_t *ctx, const char *imsi)
+{
+  memset(ctx, 0, sizeof(*ctx));
+  strncpy(ctx->imsi, imsi, sizeof(ctx->imsi) - 1);
+  ctx->ksi = MME_LOAD_NAS_KSI_NO_KEY_AVAILABLE;
+}
+
+//------------------------------------------------------------------------------
+void mme_load_nas_authenticate(
+  mme_load_nas_context_t *ctx,
+  const mme_load_nas_downlink_t *auth_request,
+  uint8_t res[MME_LOAD_AUTH_XRES_LENGTH])
+{
+  mme_load_auth_vector_t vector;
+
+  mme_load_auth_derive_vector(ctx->imsi, auth_request->rand, &vector);
+  memcpy(ctx->kasme, vector.kasme, sizeof(ctx->kasme));
+  memcpy(res, vector.xres, MME_LOAD_AUTH_XRES_LENGTH);
+  ctx->ksi = auth_request->ksi;
+}
+
+//------------------------------------------------------------------------------
+void mme_load_nas_activate_security(
+  mme_load_nas_context_t *ctx,
+  const mme_load_nas_downlink_t *smc)
+{
+  ctx->eia = smc->eia;
+  derive_key_nas(NAS_INT_ALG, ctx->eia, ctx->kasme, ctx->knas_int);
+  ctx->ul_count = 0;
+  ctx->secured = true;
+}
+
+//------------------------------------------------------------------------------
+uint32_t mme_load_nas_m_tmsi(const mme_load_nas_context_t *ctx)
+{
+  return ((uint32_t) ctx->guti[6] << 24) | ((uint32_t) ctx->guti[7] << 16) |
+         ((uint32_t) ctx->guti[8] << 8) | ctx->guti[9];
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_nas_skip_optional_ie(
+  const uint8_t *buffer,
+  size_t length,
+  size_t *offset)
+{
+  uint8_t iei = buffer[*offset];
+
+  if (iei & 0x80) {
+    // Type 1 (half octet) and type 2 IEs
+    *offset += 1;
+  } else if (iei == 0x13) {
+    // Location area identification
+    *offset += 6;
+  } else if (iei == 0x17 || iei == 0x53 || iei == 0x59 || iei == 0x5a ||
+             iei == 0x5e) {
+    // GPRS timers and EMM cause
+    *offset += 2;
+  } else {
+    if (*offset + 1 >= length) {
+      return -1;
+    }
+    *offset += 2 + buffer[*offset + 1];
+  }
+  return (*offset <= length) ? 0 : -1;
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_nas_decode_optional_guti(
+  const uint8_t *buffer,
+  size_t length,
+  size_t offset,
+  mme_load_nas_downlink_t *msg)
+{
+  while (offset < length) {
+    if (
+      buffer[offset] == IEI_GUTI && offset + 2 < length &&
+      buffer[offset + 1] == 1 + MME_LOAD_NAS_GUTI_LENGTH &&
+      offset + 3 + MME_LOAD_NAS_GUTI_LENGTH <= length) {
+      memcpy(msg->guti, &buffer[offset + 3], MME_LOAD_NAS_GUTI_LENGTH);
+      msg->has_guti = true;
+    }
+    if (mme_load_nas_skip_optional_ie(buffer, length, &offset) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_nas_decode_attach_accept(
+  const uint8_t *buffer,
+  size_t length,
+  mme_load_nas_downlink_t *msg)
+{
+  // Attach result, T3412 value, then the TAI list
+  size_t offset = 4;
+  size_t esm_length = 0;
+
+  if (offset >= length) {
+    return -1;
+  }
+  offset += 1 + buffer[offset];
+  if (offset + 2 > length) {
+    return -1;
+  }
+  esm_length = (buffer[offset] << 8) | buffer[offset + 1];
+  offset += 2;
+  if (offset + esm_length > length || esm_length < 3) {
+    return -1;
+  }
+  if (buffer[offset + 2] == ESM_ACTIVATE_DEFAULT_BEARER_REQUEST) {
+    msg->ebi = buffer[offset] >> 4;
+    msg->pti = buffer[offset + 1];
+  }
+  offset += esm_length;
+  return mme_load_nas_decode_optional_guti(buffer, length, offset, msg);
+}
+
+//------------------------------------------------------------------------------
+int mme_load_nas_decode(
+  const uint8_t *buffer,
+  size_t length,
+  mme_load_nas_downlink_t *msg)
+{
+  const uint8_t *plain = buffer;
+  size_t plain_length = length;
+
+  memset(msg, 0, sizeof(*msg));
+  if (length < 2) {
+    return -1;
+  }
+  if ((buffer[0] & 0x0f) == PD_EMM && (buffer[0] >> 4) != SHT_PLAIN) {
+    if (length < SECURITY_HEADER_LENGTH + 2) {
+      return -1;
+    }
+    plain = buffer + SECURITY_HEADER_LENGTH;
+    plain_length = length - SECURITY_HEADER_LENGTH;
+  }
+
+  if ((plain[0] & 0x0f) == PD_ESM) {
+    if (plain_length < 3) {
+      return -1;
+    }
+    msg->pti = plain[1];
+    if (plain[2] == ESM_INFORMATION_REQUEST) {
+      msg->type = MME_LOAD_NAS_MSG_ESM_INFORMATION_REQUEST;
+    }
+    return 0;
+  }
+  if ((plain[0] & 0x0f) != PD_EMM) {
+    return -1;
+  }
+
+  switch (plain[1]) {
+    case EMM_AUTHENTICATION_REQUEST:
+      if (plain_length < 3 + MME_LOAD_AUTH_RAND_LENGTH) {
+        return -1;
+      }
+      msg->type = MME_LOAD_NAS_MSG_AUTHENTICATION_REQUEST;
+      msg->ksi = plain[2] & 0x07;
+      memcpy(msg->rand, &plain[3], MME_LOAD_AUTH_RAND_LENGTH);
+      break;
+    case EMM_AUTHENTICATION_REJECT:
+      msg->type = MME_LOAD_NAS_MSG_AUTHENTICATION_REJECT;
+      break;
+    case EMM_IDENTITY_REQUEST:
+      if (plain_length < 3) {
+        return -1;
+      }
+      msg->type = MME_LOAD_NAS_MSG_IDENTITY_REQUEST;
+      msg->identity_type = plain[2] & 0x07;
+      break;
+    case EMM_SECURITY_MODE_COMMAND: {
+      size_t offset = 0;
+
+      if (plain_length < 5) {
+        return -1;
+      }
+      msg->type = MME_LOAD_NAS_MSG_SECURITY_MODE_COMMAND;
+      msg->eea = (plain[2] >> 4) & 0x07;
+      msg->eia = plain[2] & 0x07;
+      msg->ksi = plain[3] & 0x07;
+      // Skip the replayed UE security capabilities
+      offset = 5 + plain[4];
+      while (offset < plain_length) {
+        if ((plain[offset] & 0xf0) == IEI_IMEISV_REQUEST) {
+          msg->imeisv_requested = (plain[offset] & 0x07) == 1;
+        }
+        if (mme_load_nas_skip_optional_ie(plain, plain_length, &offset) < 0) {
+          return -1;
+        }
+      }
+    } break;
+    case EMM_ATTACH_ACCEPT:
+      msg->type = MME_LOAD_NAS_MSG_ATTACH_ACCEPT;
+      return mme_load_nas_decode_attach_accept(plain, plain_length, msg);
+    case EMM_ATTACH_REJECT:
+      msg->type = MME_LOAD_NAS_MSG_ATTACH_REJECT;
+      msg->cause = (plain_length > 2) ? plain[2] : 0;
+      break;
+    case EMM_TAU_ACCEPT:
+      msg->type = MME_LOAD_NAS_MSG_TAU_ACCEPT;
+      return mme_load_nas_decode_optional_guti(plain, plain_length, 3, msg);
+    case EMM_TAU_REJECT:
+      msg->type = MME_LOAD_NAS_MSG_TAU_REJECT;
+      msg->cause = (plain_length > 2) ? plain[2] : 0;
+      break;
+    case EMM_SERVICE_REJECT:
+      msg->type = MME_LOAD_NAS_MSG_SERVICE_REJECT;
+      msg->cause = (plain_length > 2) ? plain[2] : 0;
+      break;
+    case EMM_DETACH_ACCEPT:
+      msg->type = MME_LOAD_NAS_MSG_DETACH_ACCEPT;
+      break;
+    case EMM_DETACH_REQUEST:
+      msg->type = MME_LOAD_NAS_MSG_DETACH_REQUEST;
+      break;
+    case EMM_INFORMATION:
+      msg->type = MME_LOAD_NAS_MSG_EMM_INFORMATION;
+      break;
+    default:
+      msg->type = MME_LOAD_NAS_MSG_UNKNOWN;
+      break;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_attach_request(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_ATTACH_REQUEST;
+  // NAS key set identifier, EPS attach
+  plain[length++] = (ctx->ksi << 4) | 0x01;
+  if (ctx->has_guti) {
+    length += mme_load_nas_encode_guti(ctx, &plain[length]);
+  } else {
+    plain[length] = (uint8_t) mme_load_nas_encode_digits(
+      MOBILE_IDENTITY_IMSI, ctx->imsi, &plain[length + 1]);
+    length += 1 + plain[length];
+  }
+  plain[length++] = 2;
+  plain[length++] = UE_NETWORK_CAPABILITY_EEA;
+  plain[length++] = UE_NETWORK_CAPABILITY_EIA;
+  // ESM message container: PDN connectivity request, IPv4, initial request
+  plain[length++] = 0;
+  plain[length++] = 4;
+  plain[length++] = PD_ESM;
+  plain[length++] = 0x01;
+  plain[length++] = ESM_PDN_CONNECTIVITY_REQUEST;
+  plain[length++] = 0x11;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_authentication_response(
+  mme_load_nas_context_t *ctx,
+  const uint8_t res[MME_LOAD_AUTH_XRES_LENGTH],
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_AUTHENTICATION_RESPONSE;
+  plain[length++] = MME_LOAD_AUTH_XRES_LENGTH;
+  memcpy(&plain[length], res, MME_LOAD_AUTH_XRES_LENGTH);
+  length += MME_LOAD_AUTH_XRES_LENGTH;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_identity_response(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_IDENTITY_RESPONSE;
+  plain[length] = (uint8_t) mme_load_nas_encode_digits(
+    MOBILE_IDENTITY_IMSI, ctx->imsi, &plain[length + 1]);
+  length += 1 + plain[length];
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_security_mode_complete(
+  mme_load_nas_context_t *ctx,
+  bool include_imeisv,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_SECURITY_MODE_COMPLETE;
+  if (include_imeisv) {
+    plain[length++] = IEI_IMEISV;
+    plain[length] = (uint8_t) mme_load_nas_encode_digits(
+      MOBILE_IDENTITY_IMEISV, mme_load_nas_imeisv, &plain[length + 1]);
+    length += 1 + plain[length];
+  }
+  return mme_load_nas_protect(
+    ctx, SHT_INTEGRITY_CIPHERED_NEW_CTX, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_esm_information_response(
+  mme_load_nas_context_t *ctx,
+  uint8_t pti,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_ESM;
+  plain[length++] = pti;
+  plain[length++] = ESM_INFORMATION_RESPONSE;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY_CIPHERED, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_attach_complete(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_ATTACH_COMPLETE;
+  // ESM message container: activate default EPS bearer context accept
+  plain[length++] = 0;
+  plain[length++] = 3;
+  plain[length++] = (ctx->ebi << 4) | PD_ESM;
+  plain[length++] = 0;
+  plain[length++] = ESM_ACTIVATE_DEFAULT_BEARER_ACCEPT;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY_CIPHERED, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_service_request(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  uint32_t mac = 0;
+
+  buffer[0] = (SHT_SERVICE_REQUEST << 4) | PD_EMM;
+  buffer[1] = ((ctx->ksi & 0x07) << 5) | (ctx->ul_count & 0x1f);
+  // Short MAC: two least significant octets of the MAC of the first 2 octets
+  mac = mme_load_nas_mac(ctx, buffer, 2);
+  buffer[2] = (mac >> 8) & 0xff;
+  buffer[3] = mac & 0xff;
+  ctx->ul_count++;
+  return 4;
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_tau_request(mme_load_nas_context_t *ctx, uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_TAU_REQUEST;
+  // NAS key set identifier, TA updating without active flag
+  plain[length++] = (ctx->ksi << 4) | 0x00;
+  length += mme_load_nas_encode_guti(ctx, &plain[length]);
+  plain[length++] = IEI_UE_NETWORK_CAPABILITY;
+  plain[length++] = 2;
+  plain[length++] = UE_NETWORK_CAPABILITY_EEA;
+  plain[length++] = UE_NETWORK_CAPABILITY_EIA;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_tau_complete(mme_load_nas_context_t *ctx, uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_TAU_COMPLETE;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY_CIPHERED, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_detach_request(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_DETACH_REQUEST;
+  // NAS key set identifier, normal detach, EPS detach
+  plain[length++] = (ctx->ksi << 4) | 0x01;
+  length += mme_load_nas_encode_guti(ctx, &plain[length]);
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+size_t mme_load_nas_detach_accept(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer)
+{
+  uint8_t *plain = buffer + SECURITY_HEADER_LENGTH;
+  size_t length = 0;
+
+  plain[length++] = PD_EMM;
+  plain[length++] = EMM_DETACH_ACCEPT;
+  return mme_load_nas_protect(ctx, SHT_INTEGRITY_CIPHERED, buffer, length);
+}
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_nas.h
+  \brief Minimal UE side NAS (TS 24.301) codec used by the MME load generator
+*/
+
+#ifndef FILE_MME_LOAD_NAS_SEEN
+#define FILE_MME_LOAD_NAS_SEEN
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mme_load_auth.h"
+
+#define MME_LOAD_NAS_MAX_LENGTH 256
+#define MME_LOAD_NAS_KNAS_LENGTH 16
+#define MME_LOAD_NAS_GUTI_LENGTH 10 // PLMN, MME group ID, MME code, M-TMSI
+#define MME_LOAD_NAS_KSI_NO_KEY_AVAILABLE 7
+
+typedef enum {
+  MME_LOAD_NAS_MSG_UNKNOWN = 0,
+  MME_LOAD_NAS_MSG_AUTHENTICATION_REQUEST,
+  MME_LOAD_NAS_MSG_AUTHENTICATION_REJECT,
+  MME_LOAD_NAS_MSG_IDENTITY_REQUEST,
+  MME_LOAD_NAS_MSG_SECURITY_MODE_COMMAND,
+  MME_LOAD_NAS_MSG_ESM_INFORMATION_REQUEST,
+  MME_LOAD_NAS_MSG_ATTACH_ACCEPT,
+  MME_LOAD_NAS_MSG_ATTACH_REJECT,
+  MME_LOAD_NAS_MSG_TAU_ACCEPT,
+  MME_LOAD_NAS_MSG_TAU_REJECT,
+  MME_LOAD_NAS_MSG_SERVICE_REJECT,
+  MME_LOAD_NAS_MSG_DETACH_ACCEPT,
+  MME_LOAD_NAS_MSG_DETACH_REQUEST,
+  MME_LOAD_NAS_MSG_EMM_INFORMATION,
+} mme_load_nas_msg_type_t;
+
+/* NAS state of one simulated UE */
+typedef struct mme_load_nas_context_s {
+  char imsi[16];
+  uint8_t ksi;
+  bool secured;
+  uint8_t eia;
+  uint8_t kasme[MME_LOAD_AUTH_KASME_LENGTH];
+  uint8_t knas_int[MME_LOAD_NAS_KNAS_LENGTH];
+  uint32_t ul_count; // overflow << 8 | sequence number
+  bool has_guti;
+  uint8_t guti[MME_LOAD_NAS_GUTI_LENGTH];
+  uint8_t ebi;
+} mme_load_nas_context_t;
+
+/* Fields of interest of a decoded downlink NAS message */
+typedef struct mme_load_nas_downlink_s {
+  mme_load_nas_msg_type_t type;
+  uint8_t ksi;
+  uint8_t rand[MME_LOAD_AUTH_RAND_LENGTH];
+  uint8_t eia;
+  uint8_t eea;
+  bool imeisv_requested;
+  uint8_t identity_type;
+  uint8_t pti;
+  uint8_t cause;
+  uint8_t ebi;
+  bool has_guti;
+  uint8_t guti[MME_LOAD_NAS_GUTI_LENGTH];
+} mme_load_nas_downlink_t;
+
+void mme_load_nas_context_init(mme_load_nas_context_t *ctx, const char *imsi);
+
+/** \brief Derive KASME from the RAND of an Authentication Request
+ * \param res Filled with the RES to return to the network
+ **/
+void mme_load_nas_authenticate(
+  mme_load_nas_context_t *ctx,
+  const mme_load_nas_downlink_t *auth_request,
+  uint8_t res[MME_LOAD_AUTH_XRES_LENGTH]);
+
+/** \brief Activate the NAS security context selected by a Security Mode
+ * Command, following uplink messages are integrity protected */
+void mme_load_nas_activate_security(
+  mme_load_nas_context_t *ctx,
+  const mme_load_nas_downlink_t *smc);
+
+/** \brief Decode a downlink NAS PDU
+ * \return 0 on success, -1 if the PDU is malformed
+ **/
+int mme_load_nas_decode(
+  const uint8_t *buffer,
+  size_t length,
+  mme_load_nas_downlink_t *msg);
+
+/* The encoders below write the uplink PDU in buffer (at least
+ * MME_LOAD_NAS_MAX_LENGTH bytes) and return its length */
+size_t mme_load_nas_attach_request(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer);
+
+size_t mme_load_nas_authentication_response(
+  mme_load_nas_context_t *ctx,
+  const uint8_t res[MME_LOAD_AUTH_XRES_LENGTH],
+  uint8_t *buffer);
+
+size_t mme_load_nas_identity_response(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer);
+
+size_t mme_load_nas_security_mode_complete(
+  mme_load_nas_context_t *ctx,
+  bool include_imeisv,
+  uint8_t *buffer);
+
+size_t mme_load_nas_esm_information_response(
+  mme_load_nas_context_t *ctx,
+  uint8_t pti,
+  uint8_t *buffer);
+
+size_t mme_load_nas_attach_complete(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer);
+
+size_t mme_load_nas_service_request(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer);
+
+size_t mme_load_nas_tau_request(mme_load_nas_context_t *ctx, uint8_t *buffer);
+
+size_t mme_load_nas_tau_complete(mme_load_nas_context_t *ctx, uint8_t *buffer);
+
+size_t mme_load_nas_detach_request(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer);
+
+size_t mme_load_nas_detach_accept(
+  mme_load_nas_context_t *ctx,
+  uint8_t *buffer);
+
+/** \brief M-TMSI of the current GUTI, host byte order */
+uint32_t mme_load_nas_m_tmsi(const mme_load_nas_context_t *ctx);
+
+#endif /* FILE_MME_LOAD_NAS_SEEN */
@@ -0,0 +1,522 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_s1ap.c
+  \brief eNB side S1AP encoding and decoding used by the MME load generator
+
+  The PDUs are built with the same asn1c generated IE helpers as the MME
+  (s1ap_encode_s1ap_*, s1ap_decode_s1ap_*), only the direction is reversed.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "assertions.h"
+#include "conversions.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "mme_load_s1ap.h"
+
+#define MME_LOAD_ENB_NAME_MAX_LENGTH 32
+#define MME_LOAD_CELL_ID 1
+
+//------------------------------------------------------------------------------
+static void mme_load_s1ap_set_tai(
+  const mme_load_enb_config_t *enb,
+  S1ap_TAI_t *tai)
+{
+  MCC_MNC_TO_PLMNID(
+    enb->mcc, enb->mnc, enb->mnc_digit_length, &tai->pLMNidentity);
+  TAC_TO_ASN1(enb->tac, &tai->tAC);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_s1ap_set_cgi(
+  const mme_load_enb_config_t *enb,
+  S1ap_EUTRAN_CGI_t *cgi)
+{
+  MCC_MNC_TO_PLMNID(
+    enb->mcc, enb->mnc, enb->mnc_digit_length, &cgi->pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY(enb->enb_id, MME_LOAD_CELL_ID, &cgi->cell_ID);
+}
+
+//------------------------------------------------------------------------------
+static void mme_load_s1ap_copy_nas(
+  const S1ap_NAS_PDU_t *nas_pdu,
+  mme_load_s1ap_downlink_t *msg)
+{
+  msg->nas_length = nas_pdu->size;
+  if (msg->nas_length > sizeof(msg->nas)) {
+    msg->nas_length = sizeof(msg->nas);
+  }
+  memcpy(msg->nas, nas_pdu->buf, msg->nas_length);
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_s1_setup_request(
+  const mme_load_enb_config_t *enb,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  S1ap_S1SetupRequestIEs_t ies;
+  S1ap_S1SetupRequest_t s1_setup_request;
+  S1ap_SupportedTAs_Item_t *ta = NULL;
+  S1ap_PLMNidentity_t *plmn = NULL;
+  char name[MME_LOAD_ENB_NAME_MAX_LENGTH];
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(&s1_setup_request, 0, sizeof(s1_setup_request));
+
+  MCC_MNC_TO_PLMNID(
+    enb->mcc,
+    enb->mnc,
+    enb->mnc_digit_length,
+    &ies.global_ENB_ID.pLMNidentity);
+  ies.global_ENB_ID.eNB_ID.present = S1ap_ENB_ID_PR_macroENB_ID;
+  MACRO_ENB_ID_TO_BIT_STRING(
+    enb->enb_id, &ies.global_ENB_ID.eNB_ID.choice.macroENB_ID);
+
+  snprintf(name, sizeof(name), "load-enb-%u", enb->enb_id);
+  ies.presenceMask |= S1AP_S1SETUPREQUESTIES_ENBNAME_PRESENT;
+  OCTET_STRING_fromBuf(&ies.eNBname, name, strlen(name));
+
+  ta = calloc(1, sizeof(*ta));
+  TAC_TO_ASN1(enb->tac, &ta->tAC);
+  plmn = calloc(1, sizeof(*plmn));
+  MCC_MNC_TO_PLMNID(enb->mcc, enb->mnc, enb->mnc_digit_length, plmn);
+  ASN_SEQUENCE_ADD(&ta->broadcastPLMNs.list, plmn);
+  ASN_SEQUENCE_ADD(&ies.supportedTAs.list, ta);
+
+  ies.defaultPagingDRX = S1ap_PagingDRX_v64;
+
+  if (s1ap_encode_s1ap_s1setuprequesties(&s1_setup_request, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_initiating_message(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_S1Setup,
+      S1ap_Criticality_reject,
+      &asn_DEF_S1ap_S1SetupRequest,
+      &s1_setup_request) < 0) {
+    rc = -1;
+  }
+  free_s1ap_s1setuprequest(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_initial_ue_message(
+  const mme_load_enb_config_t *enb,
+  uint32_t enb_ue_s1ap_id,
+  const uint8_t *nas,
+  size_t nas_length,
+  const mme_load_nas_context_t *ue,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  S1ap_InitialUEMessageIEs_t ies;
+  S1ap_InitialUEMessage_t initial_ue_message;
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(&initial_ue_message, 0, sizeof(initial_ue_message));
+
+  ies.eNB_UE_S1AP_ID = enb_ue_s1ap_id;
+  OCTET_STRING_fromBuf(&ies.nas_pdu, (const char *) nas, nas_length);
+  mme_load_s1ap_set_tai(enb, &ies.tai);
+  mme_load_s1ap_set_cgi(enb, &ies.eutran_cgi);
+  if (ue->has_guti) {
+    ies.rrC_Establishment_Cause = S1ap_RRC_Establishment_Cause_mo_Data;
+    ies.presenceMask |= S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT;
+    MME_CODE_TO_OCTET_STRING(ue->guti[5], &ies.s_tmsi.mMEC);
+    M_TMSI_TO_OCTET_STRING(mme_load_nas_m_tmsi(ue), &ies.s_tmsi.m_TMSI);
+  } else {
+    ies.rrC_Establishment_Cause = S1ap_RRC_Establishment_Cause_mo_Signalling;
+  }
+
+  if (s1ap_encode_s1ap_initialuemessageies(&initial_ue_message, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_initiating_message(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_initialUEMessage,
+      S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_InitialUEMessage,
+      &initial_ue_message) < 0) {
+    rc = -1;
+  }
+  free_s1ap_initialuemessage(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_uplink_nas_transport(
+  const mme_load_enb_config_t *enb,
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  const uint8_t *nas,
+  size_t nas_length,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  S1ap_UplinkNASTransportIEs_t ies;
+  S1ap_UplinkNASTransport_t uplink_nas_transport;
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(&uplink_nas_transport, 0, sizeof(uplink_nas_transport));
+
+  ies.mme_ue_s1ap_id = mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = enb_ue_s1ap_id;
+  OCTET_STRING_fromBuf(&ies.nas_pdu, (const char *) nas, nas_length);
+  mme_load_s1ap_set_tai(enb, &ies.tai);
+  mme_load_s1ap_set_cgi(enb, &ies.eutran_cgi);
+
+  if (
+    s1ap_encode_s1ap_uplinknastransporties(&uplink_nas_transport, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_initiating_message(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_uplinkNASTransport,
+      S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UplinkNASTransport,
+      &uplink_nas_transport) < 0) {
+    rc = -1;
+  }
+  free_s1ap_uplinknastransport(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_initial_context_setup_response(
+  const mme_load_enb_config_t *enb,
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  uint8_t e_rab_id,
+  uint32_t s1u_teid,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  S1ap_InitialContextSetupResponseIEs_t ies;
+  S1ap_InitialContextSetupResponse_t initial_context_setup_response;
+  S1ap_E_RABSetupItemCtxtSURes_t *e_rab = NULL;
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(
+    &initial_context_setup_response,
+    0,
+    sizeof(initial_context_setup_response));
+
+  ies.mme_ue_s1ap_id = mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = enb_ue_s1ap_id;
+
+  // Free happens in free_s1ap_initialcontextsetupresponse
+  e_rab = calloc(1, sizeof(*e_rab));
+  e_rab->e_RAB_ID = e_rab_id;
+  e_rab->transportLayerAddress.buf = calloc(4, sizeof(uint8_t));
+  memcpy(e_rab->transportLayerAddress.buf, &enb->s1u_ipv4, 4);
+  e_rab->transportLayerAddress.size = 4;
+  e_rab->transportLayerAddress.bits_unused = 0;
+  GTP_TEID_TO_ASN1(s1u_teid, &e_rab->gTP_TEID);
+  ASN_SEQUENCE_ADD(
+    &ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes, e_rab);
+
+  if (
+    s1ap_encode_s1ap_initialcontextsetupresponseies(
+      &initial_context_setup_response, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_successfull_outcome(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_InitialContextSetup,
+      S1ap_Criticality_reject,
+      &asn_DEF_S1ap_InitialContextSetupResponse,
+      &initial_context_setup_response) < 0) {
+    rc = -1;
+  }
+  free_s1ap_initialcontextsetupresponse(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_ue_context_release_request(
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  S1ap_UEContextReleaseRequestIEs_t ies;
+  S1ap_UEContextReleaseRequest_t ue_context_release_request;
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(&ue_context_release_request, 0, sizeof(ue_context_release_request));
+
+  ies.mme_ue_s1ap_id = mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = enb_ue_s1ap_id;
+  ies.cause.present = S1ap_Cause_PR_radioNetwork;
+  ies.cause.choice.radioNetwork =
+    S1ap_CauseRadioNetwork_user_inactivity;
+
+  if (
+    s1ap_encode_s1ap_uecontextreleaserequesties(
+      &ue_context_release_request, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_initiating_message(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_UEContextReleaseRequest,
+      S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UEContextReleaseRequest,
+      &ue_context_release_request) < 0) {
+    rc = -1;
+  }
+  free_s1ap_uecontextreleaserequest(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_ue_context_release_complete(
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  S1ap_UEContextReleaseCompleteIEs_t ies;
+  S1ap_UEContextReleaseComplete_t ue_context_release_complete;
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(&ue_context_release_complete, 0, sizeof(ue_context_release_complete));
+
+  ies.mme_ue_s1ap_id = mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = enb_ue_s1ap_id;
+
+  if (
+    s1ap_encode_s1ap_uecontextreleasecompleteies(
+      &ue_context_release_complete, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_successfull_outcome(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_UEContextRelease,
+      S1ap_Criticality_reject,
+      &asn_DEF_S1ap_UEContextReleaseComplete,
+      &ue_context_release_complete) < 0) {
+    rc = -1;
+  }
+  free_s1ap_uecontextreleasecomplete(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_reset(uint8_t **buffer, uint32_t *length)
+{
+  S1ap_ResetIEs_t ies;
+  S1ap_Reset_t reset;
+  int rc = 0;
+
+  memset(&ies, 0, sizeof(ies));
+  memset(&reset, 0, sizeof(reset));
+
+  ies.cause.present = S1ap_Cause_PR_misc;
+  ies.cause.choice.misc = S1ap_CauseMisc_om_intervention;
+  ies.resetType.present = S1ap_ResetType_PR_s1_Interface;
+  ies.resetType.choice.s1_Interface = S1ap_ResetAll_reset_all;
+
+  if (s1ap_encode_s1ap_reseties(&reset, &ies) < 0) {
+    rc = -1;
+  } else if (
+    s1ap_generate_initiating_message(
+      buffer,
+      length,
+      S1ap_ProcedureCode_id_Reset,
+      S1ap_Criticality_reject,
+      &asn_DEF_S1ap_Reset,
+      &reset) < 0) {
+    rc = -1;
+  }
+  free_s1ap_reset(&ies);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_s1ap_decode_initiating(
+  S1ap_InitiatingMessage_t *initiating,
+  mme_load_s1ap_downlink_t *msg)
+{
+  int rc = -1;
+
+  switch (initiating->procedureCode) {
+    case S1ap_ProcedureCode_id_downlinkNASTransport: {
+      S1ap_DownlinkNASTransportIEs_t ies = {0};
+
+      rc = s1ap_decode_s1ap_downlinknastransporties(&ies, &initiating->value);
+      if (rc < 0) {
+        break;
+      }
+      msg->type = MME_LOAD_S1AP_MSG_DOWNLINK_NAS_TRANSPORT;
+      msg->mme_ue_s1ap_id = ies.mme_ue_s1ap_id;
+      msg->enb_ue_s1ap_id = ies.eNB_UE_S1AP_ID;
+      msg->has_enb_ue_s1ap_id = true;
+      mme_load_s1ap_copy_nas(&ies.nas_pdu, msg);
+      free_s1ap_downlinknastransport(&ies);
+    } break;
+
+    case S1ap_ProcedureCode_id_InitialContextSetup: {
+      S1ap_InitialContextSetupRequestIEs_t ies = {0};
+      S1ap_E_RABToBeSetupItemCtxtSUReq_t *e_rab = NULL;
+
+      rc = s1ap_decode_s1ap_initialcontextsetuprequesties(
+        &ies, &initiating->value);
+      if (rc < 0) {
+        break;
+      }
+      msg->type = MME_LOAD_S1AP_MSG_INITIAL_CONTEXT_SETUP_REQUEST;
+      msg->mme_ue_s1ap_id = ies.mme_ue_s1ap_id;
+      msg->enb_ue_s1ap_id = ies.eNB_UE_S1AP_ID;
+      msg->has_enb_ue_s1ap_id = true;
+      if (
+        ies.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq
+          .count > 0) {
+        e_rab = (S1ap_E_RABToBeSetupItemCtxtSUReq_t *) ies
+                  .e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq
+                  .array[0];
+        msg->e_rab_id = e_rab->e_RAB_ID;
+        if (e_rab->nAS_PDU) {
+          mme_load_s1ap_copy_nas(e_rab->nAS_PDU, msg);
+        }
+      }
+      free_s1ap_initialcontextsetuprequest(&ies);
+    } break;
+
+    case S1ap_ProcedureCode_id_UEContextRelease: {
+      S1ap_UEContextReleaseCommandIEs_t ies = {0};
+
+      rc = s1ap_decode_s1ap_uecontextreleasecommandies(
+        &ies, &initiating->value);
+      if (rc < 0) {
+        break;
+      }
+      msg->type = MME_LOAD_S1AP_MSG_UE_CONTEXT_RELEASE_COMMAND;
+      if (ies.uE_S1AP_IDs.present == S1ap_UE_S1AP_IDs_PR_uE_S1AP_ID_pair) {
+        msg->mme_ue_s1ap_id =
+          ies.uE_S1AP_IDs.choice.uE_S1AP_ID_pair.mME_UE_S1AP_ID;
+        msg->enb_ue_s1ap_id =
+          ies.uE_S1AP_IDs.choice.uE_S1AP_ID_pair.eNB_UE_S1AP_ID;
+        msg->has_enb_ue_s1ap_id = true;
+      } else {
+        msg->mme_ue_s1ap_id = ies.uE_S1AP_IDs.choice.mME_UE_S1AP_ID;
+      }
+      free_s1ap_uecontextreleasecommand(&ies);
+    } break;
+
+    case S1ap_ProcedureCode_id_Paging: {
+      S1ap_PagingIEs_t ies = {0};
+
+      rc = s1ap_decode_s1ap_pagingies(&ies, &initiating->value);
+      if (rc < 0) {
+        break;
+      }
+      msg->type = MME_LOAD_S1AP_MSG_PAGING;
+      if (ies.uePagingID.present == S1ap_UEPagingID_PR_s_TMSI) {
+        OCTET_STRING_TO_MME_CODE(
+          &ies.uePagingID.choice.s_TMSI.mMEC, msg->mme_code);
+        OCTET_STRING_TO_M_TMSI(
+          &ies.uePagingID.choice.s_TMSI.m_TMSI, msg->m_tmsi);
+      }
+      free_s1ap_paging(&ies);
+    } break;
+
+    default:
+      rc = 0;
+      break;
+  }
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int mme_load_s1ap_decode(
+  const uint8_t *buffer,
+  uint32_t length,
+  mme_load_s1ap_downlink_t *msg)
+{
+  S1AP_PDU_t pdu = {(S1AP_PDU_PR_NOTHING)};
+  S1AP_PDU_t *pdu_p = &pdu;
+  asn_dec_rval_t dec_ret = {(RC_OK)};
+  int rc = -1;
+
+  memset(msg, 0, sizeof(*msg));
+  dec_ret = aper_decode(
+    NULL, &asn_DEF_S1AP_PDU, (void **) &pdu_p, buffer, length, 0, 0);
+  if (dec_ret.code != RC_OK) {
+    return -1;
+  }
+
+  switch (pdu_p->present) {
+    case S1AP_PDU_PR_initiatingMessage:
+      rc = mme_load_s1ap_decode_initiating(
+        &pdu_p->choice.initiatingMessage, msg);
+      break;
+
+    case S1AP_PDU_PR_successfulOutcome:
+      if (
+        pdu_p->choice.successfulOutcome.procedureCode ==
+        S1ap_ProcedureCode_id_S1Setup) {
+        msg->type = MME_LOAD_S1AP_MSG_S1_SETUP_RESPONSE;
+      } else if (
+        pdu_p->choice.successfulOutcome.procedureCode ==
+        S1ap_ProcedureCode_id_Reset) {
+        msg->type = MME_LOAD_S1AP_MSG_RESET_ACKNOWLEDGE;
+      }
+      rc = 0;
+      break;
+
+    case S1AP_PDU_PR_unsuccessfulOutcome:
+      if (
+        pdu_p->choice.unsuccessfulOutcome.procedureCode ==
+        S1ap_ProcedureCode_id_S1Setup) {
+        msg->type = MME_LOAD_S1AP_MSG_S1_SETUP_FAILURE;
+      }
+      rc = 0;
+      break;
+
+    default:
+      break;
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1AP_PDU, pdu_p);
+  return rc;
+}
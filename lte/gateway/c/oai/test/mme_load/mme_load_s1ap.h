@@ -0,0 +1,126 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_s1ap.h
+  \brief eNB side S1AP encoding and decoding used by the MME load generator
+*/
+
+#ifndef FILE_MME_LOAD_S1AP_SEEN
+#define FILE_MME_LOAD_S1AP_SEEN
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mme_load_nas.h"
+
+/* Identity of a simulated eNB, one macro cell per eNB */
+typedef struct mme_load_enb_config_s {
+  uint32_t enb_id;
+  uint16_t mcc;
+  uint16_t mnc;
+  uint8_t mnc_digit_length;
+  uint16_t tac;
+  uint32_t s1u_ipv4; // network byte order
+} mme_load_enb_config_t;
+
+typedef enum {
+  MME_LOAD_S1AP_MSG_UNKNOWN = 0,
+  MME_LOAD_S1AP_MSG_S1_SETUP_RESPONSE,
+  MME_LOAD_S1AP_MSG_S1_SETUP_FAILURE,
+  MME_LOAD_S1AP_MSG_DOWNLINK_NAS_TRANSPORT,
+  MME_LOAD_S1AP_MSG_INITIAL_CONTEXT_SETUP_REQUEST,
+  MME_LOAD_S1AP_MSG_UE_CONTEXT_RELEASE_COMMAND,
+  MME_LOAD_S1AP_MSG_PAGING,
+  MME_LOAD_S1AP_MSG_RESET_ACKNOWLEDGE,
+} mme_load_s1ap_msg_type_t;
+
+/* Fields of interest of a decoded MME to eNB PDU */
+typedef struct mme_load_s1ap_downlink_s {
+  mme_load_s1ap_msg_type_t type;
+  uint32_t mme_ue_s1ap_id;
+  bool has_enb_ue_s1ap_id;
+  uint32_t enb_ue_s1ap_id;
+  uint8_t nas[MME_LOAD_NAS_MAX_LENGTH];
+  size_t nas_length;
+  uint8_t e_rab_id;
+  uint8_t mme_code;
+  uint32_t m_tmsi;
+} mme_load_s1ap_downlink_t;
+
+/** \brief Decode a PDU received from the MME
+ * \return 0 on success, -1 on failure
+ **/
+int mme_load_s1ap_decode(
+  const uint8_t *buffer,
+  uint32_t length,
+  mme_load_s1ap_downlink_t *msg);
+
+/* The encoders below allocate *buffer, to be released with free(), and
+ * return 0 on success or -1 on failure */
+int mme_load_s1ap_s1_setup_request(
+  const mme_load_enb_config_t *enb,
+  uint8_t **buffer,
+  uint32_t *length);
+
+int mme_load_s1ap_initial_ue_message(
+  const mme_load_enb_config_t *enb,
+  uint32_t enb_ue_s1ap_id,
+  const uint8_t *nas,
+  size_t nas_length,
+  const mme_load_nas_context_t *ue,
+  uint8_t **buffer,
+  uint32_t *length);
+
+int mme_load_s1ap_uplink_nas_transport(
+  const mme_load_enb_config_t *enb,
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  const uint8_t *nas,
+  size_t nas_length,
+  uint8_t **buffer,
+  uint32_t *length);
+
+int mme_load_s1ap_initial_context_setup_response(
+  const mme_load_enb_config_t *enb,
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  uint8_t e_rab_id,
+  uint32_t s1u_teid,
+  uint8_t **buffer,
+  uint32_t *length);
+
+int mme_load_s1ap_ue_context_release_request(
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  uint8_t **buffer,
+  uint32_t *length);
+
+int mme_load_s1ap_ue_context_release_complete(
+  uint32_t mme_ue_s1ap_id,
+  uint32_t enb_ue_s1ap_id,
+  uint8_t **buffer,
+  uint32_t *length);
+
+/* Reset of the whole S1 interface, releases every UE of the eNB */
+int mme_load_s1ap_reset(uint8_t **buffer, uint32_t *length);
+
+#endif /* FILE_MME_LOAD_S1AP_SEEN */
@@ -0,0 +1,200 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_stats.c
+  \brief Per-procedure counters and latency histograms of the MME load generator
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "mme_load_stats.h"
+
+static const char *const mme_load_proc_names[MME_LOAD_PROC_MAX] = {
+  "S1 Setup",
+  "Attach",
+  "UE Context Release",
+  "Service Request",
+  "Paging",
+  "TAU",
+  "Detach",
+  "eNB Reset",
+};
+
+//------------------------------------------------------------------------------
+const char *mme_load_proc_name(mme_load_proc_t proc)
+{
+  if (proc >= MME_LOAD_PROC_MAX) {
+    return "Unknown";
+  }
+  return mme_load_proc_names[proc];
+}
+
+//------------------------------------------------------------------------------
+static int mme_load_histogram_index(uint64_t value_us)
+{
+  int magnitude = 0;
+
+  if (value_us < MME_LOAD_HIST_SUB_BUCKETS) {
+    return (int) value_us;
+  }
+  // Position of the highest set bit above the linear range
+  magnitude = 63 - __builtin_clzll(value_us) - MME_LOAD_HIST_SUB_BUCKETS_LOG2 + 1;
+  if (magnitude >= MME_LOAD_HIST_MAGNITUDES) {
+    return MME_LOAD_HIST_BUCKETS - 1;
+  }
+  return (magnitude << MME_LOAD_HIST_SUB_BUCKETS_LOG2) +
+         (int) ((value_us >> (magnitude - 1)) & (MME_LOAD_HIST_SUB_BUCKETS - 1));
+}
+
+//------------------------------------------------------------------------------
+static uint64_t mme_load_histogram_value(int index)
+{
+  int magnitude = index >> MME_LOAD_HIST_SUB_BUCKETS_LOG2;
+  uint64_t sub = (uint64_t)(index & (MME_LOAD_HIST_SUB_BUCKETS - 1));
+
+  if (magnitude == 0) {
+    return sub;
+  }
+  // Upper bound of the bucket
+  return ((sub | MME_LOAD_HIST_SUB_BUCKETS) << (magnitude - 1)) +
+         ((1ULL << (magnitude - 1)) - 1);
+}
+
+//------------------------------------------------------------------------------
+void mme_load_histogram_record(mme_load_histogram_t *hist, uint64_t value_us)
+{
+  hist->buckets[mme_load_histogram_index(value_us)]++;
+  hist->count++;
+  hist->sum_us += value_us;
+  if (value_us > hist->max_us) {
+    hist->max_us = value_us;
+  }
+}
+
+//------------------------------------------------------------------------------
+uint64_t mme_load_histogram_percentile(
+  const mme_load_histogram_t *hist,
+  double percentile)
+{
+  uint64_t rank = 0;
+  uint64_t seen = 0;
+
+  if (!hist->count) {
+    return 0;
+  }
+  rank = (uint64_t)((percentile / 100.0) * (double) hist->count + 0.5);
+  if (rank < 1) rank = 1;
+  for (int i = 0; i < MME_LOAD_HIST_BUCKETS; i++) {
+    seen += hist->buckets[i];
+    if (seen >= rank) {
+      uint64_t value = mme_load_histogram_value(i);
+      return (value > hist->max_us) ? hist->max_us : value;
+    }
+  }
+  return hist->max_us;
+}
+
+//------------------------------------------------------------------------------
+void mme_load_stats_proc_start(mme_load_stats_t *stats, mme_load_proc_t proc)
+{
+  stats->proc[proc].started++;
+}
+
+//------------------------------------------------------------------------------
+void mme_load_stats_proc_end(
+  mme_load_stats_t *stats,
+  mme_load_proc_t proc,
+  uint64_t latency_us)
+{
+  stats->proc[proc].succeeded++;
+  mme_load_histogram_record(&stats->proc[proc].latency, latency_us);
+}
+
+//------------------------------------------------------------------------------
+void mme_load_stats_proc_fail(
+  mme_load_stats_t *stats,
+  mme_load_proc_t proc,
+  bool timed_out)
+{
+  if (timed_out) {
+    stats->proc[proc].timed_out++;
+  } else {
+    stats->proc[proc].failed++;
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_load_stats_report(
+  FILE *out,
+  const mme_load_stats_t *stats,
+  uint64_t elapsed_us)
+{
+  double elapsed_s = (double) elapsed_us / 1000000.0;
+
+  fprintf(out, "\nRun time: %.3f s\n", elapsed_s);
+  fprintf(
+    out,
+    "%-20s %9s %9s %7s %8s %10s %9s %9s %9s %9s %9s\n",
+    "procedure",
+    "started",
+    "ok",
+    "failed",
+    "timeout",
+    "proc/s",
+    "avg(us)",
+    "p50(us)",
+    "p90(us)",
+    "p99(us)",
+    "max(us)");
+  for (int p = 0; p < MME_LOAD_PROC_MAX; p++) {
+    const mme_load_proc_stats_t *ps = &stats->proc[p];
+    if (!ps->started) {
+      continue;
+    }
+    fprintf(
+      out,
+      "%-20s %9" PRIu64 " %9" PRIu64 " %7" PRIu64 " %8" PRIu64
+      " %10.1f %9" PRIu64 " %9" PRIu64 " %9" PRIu64 " %9" PRIu64
+      " %9" PRIu64 "\n",
+      mme_load_proc_name(p),
+      ps->started,
+      ps->succeeded,
+      ps->failed,
+      ps->timed_out,
+      elapsed_s > 0 ? (double) ps->succeeded / elapsed_s : 0.0,
+      ps->latency.count ? ps->latency.sum_us / ps->latency.count : 0,
+      mme_load_histogram_percentile(&ps->latency, 50.0),
+      mme_load_histogram_percentile(&ps->latency, 90.0),
+      mme_load_histogram_percentile(&ps->latency, 99.0),
+      ps->latency.max_us);
+  }
+  fprintf(
+    out,
+    "S1AP PDUs sent %" PRIu64 ", received %" PRIu64 ", decode errors %" PRIu64
+    ", unexpected NAS %" PRIu64 "\n",
+    stats->s1ap_tx,
+    stats->s1ap_rx,
+    stats->s1ap_decode_errors,
+    stats->nas_unexpected);
+}
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_load_stats.h
+  \brief Per-procedure counters and latency histograms of the MME load generator
+*/
+
+#ifndef FILE_MME_LOAD_STATS_SEEN
+#define FILE_MME_LOAD_STATS_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+  MME_LOAD_PROC_S1_SETUP = 0,
+  MME_LOAD_PROC_ATTACH,
+  MME_LOAD_PROC_UE_CONTEXT_RELEASE,
+  MME_LOAD_PROC_SERVICE_REQUEST,
+  MME_LOAD_PROC_PAGING,
+  MME_LOAD_PROC_TAU,
+  MME_LOAD_PROC_DETACH,
+  MME_LOAD_PROC_ENB_RESET,
+  MME_LOAD_PROC_MAX,
+} mme_load_proc_t;
+
+/* Log-linear histogram: each power of two of microseconds is split in
+ * MME_LOAD_HIST_SUB_BUCKETS linear buckets, which keeps the relative error of
+ * the reported percentiles under 100/MME_LOAD_HIST_SUB_BUCKETS %. */
+#define MME_LOAD_HIST_SUB_BUCKETS_LOG2 4
+#define MME_LOAD_HIST_SUB_BUCKETS (1 << MME_LOAD_HIST_SUB_BUCKETS_LOG2)
+#define MME_LOAD_HIST_MAGNITUDES 28 // up to ~268 seconds
+#define MME_LOAD_HIST_BUCKETS                                                  \
+  (MME_LOAD_HIST_MAGNITUDES * MME_LOAD_HIST_SUB_BUCKETS)
+
+typedef struct mme_load_histogram_s {
+  uint64_t buckets[MME_LOAD_HIST_BUCKETS];
+  uint64_t count;
+  uint64_t sum_us;
+  uint64_t max_us;
+} mme_load_histogram_t;
+
+typedef struct mme_load_proc_stats_s {
+  uint64_t started;
+  uint64_t succeeded;
+  uint64_t failed;
+  uint64_t timed_out;
+  mme_load_histogram_t latency;
+} mme_load_proc_stats_t;
+
+typedef struct mme_load_stats_s {
+  mme_load_proc_stats_t proc[MME_LOAD_PROC_MAX];
+  uint64_t s1ap_tx;
+  uint64_t s1ap_rx;
+  uint64_t s1ap_decode_errors;
+  uint64_t nas_unexpected;
+} mme_load_stats_t;
+
+const char *mme_load_proc_name(mme_load_proc_t proc);
+
+void mme_load_histogram_record(mme_load_histogram_t *hist, uint64_t value_us);
+
+uint64_t mme_load_histogram_percentile(
+  const mme_load_histogram_t *hist,
+  double percentile);
+
+void mme_load_stats_proc_start(mme_load_stats_t *stats, mme_load_proc_t proc);
+
+void mme_load_stats_proc_end(
+  mme_load_stats_t *stats,
+  mme_load_proc_t proc,
+  uint64_t latency_us);
+
+void mme_load_stats_proc_fail(
+  mme_load_stats_t *stats,
+  mme_load_proc_t proc,
+  bool timed_out);
+
+/** \brief Print the per-procedure report
+ * \param elapsed_us Wall-clock duration of the run, used for the rates
+ **/
+void mme_load_stats_report(
+  FILE *out,
+  const mme_load_stats_t *stats,
+  uint64_t elapsed_us);
+
+#endif /* FILE_MME_LOAD_STATS_SEEN */
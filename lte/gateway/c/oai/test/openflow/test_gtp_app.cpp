@@ -27,6 +27,7 @@
 
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::Invoke;
 using ::testing::Test;
 using namespace fluid_msg;
 using namespace openflow;
@@ -40,6 +41,9 @@ class GTPApplicationTest : public ::testing::Test {
  protected:
   static constexpr const char *TEST_GTP_MAC = "1.2.3.4.5.6";
   static const uint32_t TEST_GTP_PORT = 123;
+  // Transactions of the flow dumps of the GTP application
+  static const uint32_t TEST_RESYNC_XID = 0x47545200;
+  static const uint32_t TEST_USAGE_XID_PREFIX = 0x47550000;
 
  protected:
   virtual void SetUp()
@@ -51,6 +55,8 @@ class GTPApplicationTest : public ::testing::Test {
       new OpenflowController("127.0.0.1", 6666, 2, false, messenger));
     controller->register_for_event(gtp_app, openflow::EVENT_ADD_GTP_TUNNEL);
     controller->register_for_event(gtp_app, openflow::EVENT_DELETE_GTP_TUNNEL);
+    controller->register_for_event(gtp_app, openflow::EVENT_SWITCH_UP);
+    controller->register_for_event(gtp_app, openflow::EVENT_MULTIPART_REPLY);
   }
 
   virtual void TearDown()
@@ -66,7 +72,12 @@ class GTPApplicationTest : public ::testing::Test {
   GTPApplication *gtp_app;
 };
 
-// Matchers for flow modifications
+// Matchers for flow modifications, the message type is checked first
+
+MATCHER_P(CheckMsgType, msg_type, "")
+{
+  return arg.type() == msg_type;
+}
 
 MATCHER_P(CheckTableId, table_id, "")
 {
@@ -190,6 +201,158 @@ TEST_F(GTPApplicationTest, TestDeleteTunnel)
   controller->dispatch_event(del_tunnel);
 }
 
+/*
+ * Test that on switch up, the GTP flows are dumped from the switch and that
+ * only the differences with the shadow are pushed back
+ */
+TEST_F(GTPApplicationTest, TestResyncOnSwitchUp)
+{
+  struct in_addr ue_ip;
+  ue_ip.s_addr = inet_addr("0.0.0.1");
+  struct in_addr enb_ip;
+  enb_ip.s_addr = inet_addr("0.0.0.2");
+  uint32_t in_tei = 1;
+  uint32_t stale_tei = 99;
+  char imsi[] = "001010000000013";
+  AddGTPTunnelEvent add_tunnel(ue_ip, enb_ip, in_tei, 2, imsi);
+
+  EXPECT_CALL(*messenger, send_of_msg(_, _)).Times(2);
+  controller->dispatch_event(add_tunnel);
+  ::testing::Mock::VerifyAndClearExpectations(messenger.get());
+  EXPECT_EQ(gtp_app->get_shadow().get_nb_flows(), 2);
+
+  // Switch up: dump of the GTP flows only
+  EXPECT_CALL(
+    *messenger, send_of_msg(CheckMsgType(of13::OFPT_MULTIPART_REQUEST), _))
+    .Times(1);
+  SwitchUpEvent switch_up(NULL, *controller, NULL, 0);
+  controller->dispatch_event(switch_up);
+  ::testing::Mock::VerifyAndClearExpectations(messenger.get());
+
+  // The switch lost the tunnel, and has a flow of a previous run
+  of13::MultipartReplyFlow reply(TEST_RESYNC_XID, 0);
+  of13::FlowStats stats(0, 0, 0, 10, 0, 0, 0, GTP_COOKIE_TAG | 0x100, 0, 0);
+  of13::Match match;
+  match.add_oxm_field(new of13::InPort(TEST_GTP_PORT));
+  match.add_oxm_field(new of13::TUNNELId(stale_tei));
+  stats.match(match);
+  reply.add_flow_stats(stats);
+  uint8_t *packed = reply.pack();
+  void *data = malloc(reply.length());
+  memcpy(data, packed, reply.length());
+  OFMsg::free_buffer(packed);
+
+  EXPECT_CALL(
+    *messenger,
+    send_of_msg(
+      AllOf(
+        CheckMsgType(of13::OFPT_FLOW_MOD),
+        CheckTunnelId(stale_tei),
+        CheckCommandType(of13::OFPFC_DELETE_STRICT)),
+      _))
+    .Times(1);
+  EXPECT_CALL(
+    *messenger,
+    send_of_msg(
+      AllOf(
+        CheckMsgType(of13::OFPT_FLOW_MOD),
+        CheckInPort(TEST_GTP_PORT),
+        CheckTunnelId(in_tei),
+        CheckCommandType(of13::OFPFC_ADD)),
+      _))
+    .Times(1);
+  EXPECT_CALL(
+    *messenger,
+    send_of_msg(
+      AllOf(
+        CheckMsgType(of13::OFPT_FLOW_MOD),
+        CheckInPort(of13::OFPP_LOCAL),
+        CheckIPv4Dst(ue_ip),
+        CheckCommandType(of13::OFPFC_ADD)),
+      _))
+    .Times(1);
+  EXPECT_CALL(
+    *messenger, send_of_msg(CheckMsgType(of13::OFPT_BARRIER_REQUEST), _))
+    .Times(1);
+  MultipartReplyEvent reply_event(NULL, *controller, data, reply.length());
+  controller->dispatch_event(reply_event);
+  EXPECT_FALSE(gtp_app->get_shadow().is_resyncing());
+}
+
+/*
+ * Test that a poll dumps the GTP flows, and that the usage of the tunnels is
+ * reported once the dump is complete
+ */
+TEST_F(GTPApplicationTest, TestUsagePoll)
+{
+  std::vector<struct gtp_tunnel_usage> reported;
+  GTPApplication usage_app(
+    TEST_GTP_MAC,
+    TEST_GTP_PORT,
+    [&reported](std::vector<struct gtp_tunnel_usage> &usages) {
+      reported = usages;
+    });
+  struct in_addr ue_ip;
+  ue_ip.s_addr = inet_addr("0.0.0.1");
+  struct in_addr enb_ip;
+  enb_ip.s_addr = inet_addr("0.0.0.2");
+  uint32_t in_tei = 1;
+  char imsi[] = "001010000000013";
+  AddGTPTunnelEvent add_tunnel(ue_ip, enb_ip, in_tei, 2, imsi);
+  ExternalEvent poll(EVENT_POLL_GTP_TUNNEL_USAGE);
+
+  controller->register_for_event(&usage_app, EVENT_ADD_GTP_TUNNEL);
+  controller->register_for_event(&usage_app, EVENT_POLL_GTP_TUNNEL_USAGE);
+  controller->register_for_event(&usage_app, EVENT_MULTIPART_REPLY);
+  EXPECT_CALL(*messenger, send_of_msg(_, _)).Times(4);
+  controller->dispatch_event(add_tunnel);
+  ::testing::Mock::VerifyAndClearExpectations(messenger.get());
+
+  // Polled twice, only the reply to the last poll counts
+  std::vector<uint32_t> xids;
+  EXPECT_CALL(
+    *messenger, send_of_msg(CheckMsgType(of13::OFPT_MULTIPART_REQUEST), _))
+    .Times(2)
+    .WillRepeatedly(Invoke(
+      [&xids](OFMsg &msg, fluid_base::OFConnection *) {
+        xids.push_back(msg.xid());
+      }));
+  controller->dispatch_event(poll);
+  controller->dispatch_event(poll);
+  ::testing::Mock::VerifyAndClearExpectations(messenger.get());
+  ASSERT_EQ(xids.size(), 2);
+  EXPECT_TRUE((xids[0] & 0xffff0000) == TEST_USAGE_XID_PREFIX);
+  EXPECT_NE(xids[0], xids[1]);
+
+  // Counters of the uplink flow
+  of13::FlowStats stats(0, 0, 0, 10, 0, 0, 0, GTP_COOKIE_TAG, 7, 700);
+  of13::Match match;
+  match.add_oxm_field(new of13::InPort(TEST_GTP_PORT));
+  match.add_oxm_field(new of13::TUNNELId(in_tei));
+  stats.match(match);
+
+  EXPECT_CALL(*messenger, send_of_msg(_, _)).Times(0);
+  for (uint32_t xid : xids) {
+    of13::MultipartReplyFlow reply(xid, 0);
+    reply.add_flow_stats(stats);
+    uint8_t *packed = reply.pack();
+    void *data = malloc(reply.length());
+    memcpy(data, packed, reply.length());
+    OFMsg::free_buffer(packed);
+
+    MultipartReplyEvent reply_event(NULL, *controller, data, reply.length());
+    controller->dispatch_event(reply_event);
+    if (xid == xids[0]) {
+      EXPECT_TRUE(reported.empty());
+    }
+  }
+  ASSERT_EQ(reported.size(), 1);
+  EXPECT_EQ(reported[0].i_tei, in_tei);
+  EXPECT_EQ(reported[0].ul_packets, 7);
+  EXPECT_EQ(reported[0].ul_bytes, 700);
+  EXPECT_EQ(reported[0].dl_packets, 0);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
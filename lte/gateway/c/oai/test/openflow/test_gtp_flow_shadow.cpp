@@ -0,0 +1,263 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <chrono>
+#include <map>
+#include <utility>
+#include <gtest/gtest.h>
+#include "GTPFlowShadow.h"
+
+using namespace openflow;
+
+namespace {
+
+/**
+ * Table 0 of a switch, holding the GTP flows by type and match
+ */
+class MockSwitchTable {
+ public:
+  void apply(
+    const std::vector<GTPFlow> &flows_to_add,
+    const std::vector<GTPFlow> &flows_to_delete)
+  {
+    for (auto &flow : flows_to_delete) {
+      auto it = flows_.find(std::make_pair(flow.type, flow.key));
+      // Strict delete, the cookie must match too
+      ASSERT_TRUE(it != flows_.end());
+      ASSERT_EQ(it->second, flow.cookie);
+      flows_.erase(it);
+    }
+    // An add with the same match and priority replaces the flow
+    for (auto &flow : flows_to_add) {
+      flows_[std::make_pair(flow.type, flow.key)] = flow.cookie;
+    }
+  }
+
+  void dump(GTPFlowShadow &shadow) const
+  {
+    for (auto &entry : flows_) {
+      GTPFlow flow = {entry.first.first, entry.first.second, entry.second};
+      shadow.add_switch_flow(flow);
+    }
+  }
+
+  void set(GTPFlowType type, uint32_t key, uint64_t cookie)
+  {
+    flows_[std::make_pair(type, key)] = cookie;
+  }
+
+  bool has(GTPFlowType type, uint32_t key) const
+  {
+    return flows_.count(std::make_pair(type, key)) > 0;
+  }
+
+  size_t size() const { return flows_.size(); }
+
+  void clear() { flows_.clear(); }
+
+ private:
+  std::map<std::pair<GTPFlowType, uint32_t>, uint64_t> flows_;
+};
+
+class GTPFlowShadowTest : public ::testing::Test {
+ protected:
+  static const uint32_t NB_TUNNELS = 50000;
+
+  static uint32_t ue_ip(uint32_t i) { return 0x0a000000 + i; }
+
+  static uint32_t in_tei(uint32_t i) { return 1000 + i; }
+
+  void add_tunnels(uint32_t nb_tunnels)
+  {
+    for (uint32_t i = 0; i < nb_tunnels; i++) {
+      shadow.add_tunnel(ue_ip(i), 0xc0a80001, in_tei(i), 5000 + i, i);
+      GTPFlow ul = {GTP_FLOW_UPLINK,
+                    in_tei(i),
+                    shadow.get_cookie(GTP_FLOW_UPLINK, in_tei(i))};
+      GTPFlow dl = {GTP_FLOW_DOWNLINK,
+                    ue_ip(i),
+                    shadow.get_cookie(GTP_FLOW_DOWNLINK, ue_ip(i))};
+      table.apply({ul, dl}, {});
+    }
+  }
+
+  void resync(
+    std::vector<GTPFlow> &flows_to_add,
+    std::vector<GTPFlow> &flows_to_delete)
+  {
+    shadow.start_resync();
+    table.dump(shadow);
+    shadow.finish_resync(flows_to_add, flows_to_delete);
+    table.apply(flows_to_add, flows_to_delete);
+  }
+
+  // The switch is in sync when a new resync has nothing to do
+  void expect_in_sync()
+  {
+    std::vector<GTPFlow> flows_to_add;
+    std::vector<GTPFlow> flows_to_delete;
+
+    resync(flows_to_add, flows_to_delete);
+    EXPECT_EQ(flows_to_add.size(), 0);
+    EXPECT_EQ(flows_to_delete.size(), 0);
+    EXPECT_EQ(table.size(), shadow.get_nb_flows());
+  }
+
+ protected:
+  GTPFlowShadow shadow;
+  MockSwitchTable table;
+};
+
+TEST_F(GTPFlowShadowTest, TestCookies)
+{
+  shadow.add_tunnel(ue_ip(1), 0xc0a80001, in_tei(1), 5001, 1);
+  uint64_t ul_cookie = shadow.get_cookie(GTP_FLOW_UPLINK, in_tei(1));
+  uint64_t dl_cookie = shadow.get_cookie(GTP_FLOW_DOWNLINK, ue_ip(1));
+
+  EXPECT_EQ(ul_cookie & GTP_COOKIE_TAG_MASK, GTP_COOKIE_TAG);
+  EXPECT_EQ(dl_cookie & GTP_COOKIE_TAG_MASK, GTP_COOKIE_TAG);
+  EXPECT_EQ(ul_cookie & GTP_COOKIE_UPLINK_DISCARD, 0);
+  EXPECT_EQ(dl_cookie & GTP_COOKIE_DOWNLINK_DISCARD, 0);
+  EXPECT_EQ(shadow.get_cookie(GTP_FLOW_UPLINK_DISCARD, in_tei(1)), 0);
+  EXPECT_EQ(shadow.get_cookie(GTP_FLOW_UPLINK, in_tei(2)), 0);
+
+  // The eNB moved: the downlink flow changes, not the uplink one
+  shadow.add_tunnel(ue_ip(1), 0xc0a80002, in_tei(1), 5001, 1);
+  EXPECT_EQ(shadow.get_cookie(GTP_FLOW_UPLINK, in_tei(1)), ul_cookie);
+  EXPECT_NE(shadow.get_cookie(GTP_FLOW_DOWNLINK, ue_ip(1)), dl_cookie);
+
+  shadow.set_discard(ue_ip(1), in_tei(1), true);
+  EXPECT_EQ(
+    shadow.get_cookie(GTP_FLOW_UPLINK_DISCARD, in_tei(1)),
+    GTP_COOKIE_TAG | GTP_COOKIE_UPLINK_DISCARD);
+  EXPECT_EQ(
+    shadow.get_cookie(GTP_FLOW_DOWNLINK_DISCARD, ue_ip(1)),
+    GTP_COOKIE_TAG | GTP_COOKIE_DOWNLINK_DISCARD);
+  EXPECT_EQ(shadow.get_nb_flows(), 4);
+
+  shadow.delete_tunnel(ue_ip(1), in_tei(1));
+  EXPECT_EQ(shadow.get_nb_flows(), 0);
+}
+
+/*
+ * The switch kept its flows: nothing is pushed
+ */
+TEST_F(GTPFlowShadowTest, TestSwitchIntact)
+{
+  std::vector<GTPFlow> flows_to_add;
+  std::vector<GTPFlow> flows_to_delete;
+
+  add_tunnels(NB_TUNNELS);
+  resync(flows_to_add, flows_to_delete);
+  EXPECT_EQ(flows_to_add.size(), 0);
+  EXPECT_EQ(flows_to_delete.size(), 0);
+  EXPECT_FALSE(shadow.is_resyncing());
+}
+
+/*
+ * OVS restarted with an empty table: every flow is pushed again
+ */
+TEST_F(GTPFlowShadowTest, TestSwitchRestart)
+{
+  std::vector<GTPFlow> flows_to_add;
+  std::vector<GTPFlow> flows_to_delete;
+
+  add_tunnels(NB_TUNNELS);
+  table.clear();
+
+  auto start = std::chrono::steady_clock::now();
+  resync(flows_to_add, flows_to_delete);
+  auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+
+  EXPECT_EQ(flows_to_add.size(), 2 * NB_TUNNELS);
+  EXPECT_EQ(flows_to_delete.size(), 0);
+  expect_in_sync();
+  printf(
+    "%u tunnels resynchronized in %.1f ms\n", NB_TUNNELS, usec / 1e3);
+}
+
+/*
+ * Flows changed while the controller was away: the unknown flows are deleted
+ * and the outdated ones replaced
+ */
+TEST_F(GTPFlowShadowTest, TestStaleFlows)
+{
+  std::vector<GTPFlow> flows_to_add;
+  std::vector<GTPFlow> flows_to_delete;
+
+  add_tunnels(100);
+  // Tunnels deleted while the switch was disconnected
+  for (uint32_t i = 0; i < 10; i++) {
+    shadow.delete_tunnel(ue_ip(i), in_tei(i));
+  }
+  // Tunnel moved to another eNB
+  shadow.add_tunnel(ue_ip(50), 0xc0a80002, in_tei(50), 7000, 50);
+  // Flow lost by the switch
+  shadow.add_tunnel(ue_ip(200), 0xc0a80001, in_tei(200), 7200, 200);
+  // Flow of a previous run of the controller
+  table.set(GTP_FLOW_UPLINK, 99999, GTP_COOKIE_TAG | 0x1234);
+
+  resync(flows_to_add, flows_to_delete);
+  EXPECT_EQ(flows_to_add.size(), 3);
+  EXPECT_EQ(flows_to_delete.size(), 21);
+  EXPECT_FALSE(table.has(GTP_FLOW_UPLINK, in_tei(0)));
+  EXPECT_FALSE(table.has(GTP_FLOW_UPLINK, 99999));
+  EXPECT_TRUE(table.has(GTP_FLOW_DOWNLINK, ue_ip(200)));
+  expect_in_sync();
+}
+
+/*
+ * The discard flows of suspended UEs are resynchronized as well
+ */
+TEST_F(GTPFlowShadowTest, TestDiscardFlows)
+{
+  std::vector<GTPFlow> flows_to_add;
+  std::vector<GTPFlow> flows_to_delete;
+
+  add_tunnels(10);
+  shadow.set_discard(ue_ip(1), in_tei(1), true);
+  table.set(
+    GTP_FLOW_DOWNLINK_DISCARD,
+    ue_ip(2),
+    GTP_COOKIE_TAG | GTP_COOKIE_DOWNLINK_DISCARD);
+
+  resync(flows_to_add, flows_to_delete);
+  EXPECT_EQ(flows_to_add.size(), 2);
+  EXPECT_EQ(flows_to_delete.size(), 1);
+  EXPECT_TRUE(table.has(GTP_FLOW_UPLINK_DISCARD, in_tei(1)));
+  EXPECT_TRUE(table.has(GTP_FLOW_DOWNLINK_DISCARD, ue_ip(1)));
+  EXPECT_FALSE(table.has(GTP_FLOW_DOWNLINK_DISCARD, ue_ip(2)));
+  expect_in_sync();
+
+  shadow.set_discard(ue_ip(1), in_tei(1), false);
+  resync(flows_to_add, flows_to_delete);
+  EXPECT_EQ(flows_to_delete.size(), 2);
+  expect_in_sync();
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+} // namespace
@@ -0,0 +1,204 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <chrono>
+#include <gtest/gtest.h>
+#include "GTPTunnelStats.h"
+
+using namespace openflow;
+
+namespace {
+
+const uint32_t NB_TUNNELS = 100000;
+
+class GTPTunnelStatsTest : public ::testing::Test {
+ protected:
+  static const time_t START = 1000;
+
+  static uint32_t ue_ip(uint32_t i) { return 0x0a000000 + i; }
+
+  static uint32_t in_tei(uint32_t i) { return 1000 + i; }
+
+  void add_uplink(uint32_t i, uint64_t packets)
+  {
+    GTPFlow flow = {GTP_FLOW_UPLINK, in_tei(i), 0};
+    stats.add_flow_stats(flow, packets, packets * 100);
+  }
+
+  void add_downlink(uint32_t i, uint64_t packets)
+  {
+    GTPFlow flow = {GTP_FLOW_DOWNLINK, ue_ip(i), 0};
+    stats.add_flow_stats(flow, packets, packets * 1000);
+  }
+
+  // Poll of a single tunnel, returns its usage
+  struct gtp_tunnel_usage poll(
+    uint64_t ul_packets,
+    uint64_t dl_packets,
+    time_t now)
+  {
+    stats.start_poll();
+    add_uplink(1, ul_packets);
+    add_downlink(1, dl_packets);
+    stats.finish_poll(now, usages);
+    EXPECT_EQ(usages.size(), 1);
+    return usages[0];
+  }
+
+ protected:
+  GTPTunnelStats stats;
+  std::vector<struct gtp_tunnel_usage> usages;
+};
+
+TEST_F(GTPTunnelStatsTest, TestDeltas)
+{
+  stats.add_tunnel(ue_ip(1), in_tei(1));
+
+  struct gtp_tunnel_usage usage = poll(10, 5, START);
+  EXPECT_EQ(usage.i_tei, in_tei(1));
+  EXPECT_EQ(usage.ue.s_addr, ue_ip(1));
+  EXPECT_EQ(usage.ul_packets, 10);
+  EXPECT_EQ(usage.ul_bytes, 1000);
+  EXPECT_EQ(usage.dl_packets, 5);
+  EXPECT_EQ(usage.dl_bytes, 5000);
+
+  usage = poll(15, 5, START + 10);
+  EXPECT_EQ(usage.ul_packets, 5);
+  EXPECT_EQ(usage.ul_bytes, 500);
+  EXPECT_EQ(usage.dl_packets, 0);
+
+  // Flow installed again by a resync, its counters restart
+  usage = poll(3, 7, START + 20);
+  EXPECT_EQ(usage.ul_packets, 3);
+  EXPECT_EQ(usage.dl_packets, 2);
+}
+
+TEST_F(GTPTunnelStatsTest, TestMissingFlow)
+{
+  stats.add_tunnel(ue_ip(1), in_tei(1));
+  poll(10, 5, START);
+
+  // Uplink flow missing from the dump: no usage, its counters are kept
+  stats.start_poll();
+  add_downlink(1, 6);
+  stats.finish_poll(START + 10, usages);
+  ASSERT_EQ(usages.size(), 1);
+  EXPECT_EQ(usages[0].ul_packets, 0);
+  EXPECT_EQ(usages[0].ul_bytes, 0);
+  EXPECT_EQ(usages[0].dl_packets, 1);
+
+  // Back in the next dump, only the new traffic is counted
+  struct gtp_tunnel_usage usage = poll(12, 6, START + 20);
+  EXPECT_EQ(usage.ul_packets, 2);
+  EXPECT_EQ(usage.ul_bytes, 200);
+  EXPECT_EQ(usage.dl_packets, 0);
+}
+
+TEST_F(GTPTunnelStatsTest, TestIdle)
+{
+  stats.add_tunnel(ue_ip(1), in_tei(1));
+
+  // Idle from the first poll on, without any traffic
+  EXPECT_EQ(poll(0, 0, START).idle_sec, 0);
+  EXPECT_EQ(poll(0, 0, START + 10).idle_sec, 10);
+  EXPECT_EQ(poll(0, 0, START + 20).idle_sec, 20);
+  EXPECT_EQ(poll(0, 1, START + 30).idle_sec, 0);
+  EXPECT_EQ(poll(0, 1, START + 40).idle_sec, 10);
+  EXPECT_EQ(poll(1, 1, START + 50).idle_sec, 0);
+}
+
+TEST_F(GTPTunnelStatsTest, TestTunnelChanges)
+{
+  stats.add_tunnel(ue_ip(1), in_tei(1));
+  stats.add_tunnel(ue_ip(2), in_tei(2));
+  EXPECT_EQ(stats.get_nb_tunnels(), 2);
+
+  // The downlink flow of the UE IP now belongs to the second tunnel
+  stats.add_tunnel(ue_ip(1), in_tei(3));
+  stats.delete_tunnel(ue_ip(2), in_tei(2));
+  EXPECT_EQ(stats.get_nb_tunnels(), 2);
+
+  stats.start_poll();
+  add_uplink(1, 4);
+  add_uplink(2, 4);
+  add_downlink(1, 8);
+  add_uplink(3, 2);
+  stats.finish_poll(START, usages);
+  ASSERT_EQ(usages.size(), 2);
+  for (auto &usage : usages) {
+    if (usage.i_tei == in_tei(1)) {
+      EXPECT_EQ(usage.ul_packets, 4);
+      EXPECT_EQ(usage.dl_packets, 0);
+    } else {
+      EXPECT_EQ(usage.i_tei, in_tei(3));
+      EXPECT_EQ(usage.ul_packets, 2);
+      EXPECT_EQ(usage.dl_packets, 8);
+    }
+  }
+
+  // A new tunnel in a reused slot starts from zero
+  stats.add_tunnel(ue_ip(4), in_tei(4));
+  stats.start_poll();
+  add_uplink(4, 1);
+  stats.finish_poll(START + 10, usages);
+  ASSERT_EQ(usages.size(), 3);
+  EXPECT_FALSE(stats.is_polling());
+}
+
+/*
+ * Poll of 100K tunnels, the uplink and downlink flows of each
+ */
+TEST_F(GTPTunnelStatsTest, TestPollBenchmark)
+{
+  const int nb_polls = 10;
+  uint64_t ul_bytes = 0;
+
+  for (uint32_t i = 0; i < NB_TUNNELS; i++) {
+    stats.add_tunnel(ue_ip(i), in_tei(i));
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int poll = 1; poll <= nb_polls; poll++) {
+    stats.start_poll();
+    for (uint32_t i = 0; i < NB_TUNNELS; i++) {
+      add_uplink(i, poll * (i % 8));
+      add_downlink(i, poll * (i % 4));
+    }
+    stats.finish_poll(START + poll * 10, usages);
+    ASSERT_EQ(usages.size(), NB_TUNNELS);
+  }
+  auto usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count();
+
+  for (auto &usage : usages) {
+    ul_bytes += usage.ul_bytes;
+  }
+  // (0 + 1 + ... + 7) packets of 100 bytes every 8 tunnels
+  EXPECT_EQ(ul_bytes, (NB_TUNNELS / 8) * 28 * 100);
+  printf("%u tunnels: %.2f ms per poll\n", NB_TUNNELS, usec / 1e3 / nb_polls);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+} // namespace
@@ -0,0 +1,164 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "MPSCRing.h"
+
+using namespace openflow;
+
+namespace {
+
+const uint32_t NB_PRODUCERS = 4;
+const uint32_t NB_EVENTS = 1000000; // per producer
+
+// Same size as a tunnel command
+struct TestCommand {
+  uint32_t producer;
+  uint32_t sequence;
+  int64_t pushed_nsec;
+  char padding[32];
+};
+
+int64_t now_nsec()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+TEST(MPSCRingTest, TestPushPop)
+{
+  MPSCRing<uint32_t> ring(5);
+  uint32_t item = 0;
+
+  EXPECT_EQ(ring.capacity(), 8);
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.pop(item));
+  for (uint32_t i = 0; i < 8; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+  EXPECT_FALSE(ring.push(8));
+  EXPECT_FALSE(ring.empty());
+
+  // In order, and the cells are reused on the next turn
+  for (uint32_t i = 0; i < 20; i++) {
+    EXPECT_TRUE(ring.pop(item));
+    EXPECT_EQ(item, i);
+    EXPECT_TRUE(ring.push(i + 8));
+  }
+  EXPECT_FALSE(ring.push(0));
+}
+
+/*
+ * Producers push as fast as they can, the consumer drains: no command is
+ * lost, and the commands of a producer come out in order
+ */
+TEST(MPSCRingTest, TestProducersBenchmark)
+{
+  MPSCRing<TestCommand> ring(65536);
+  std::vector<std::thread> producers;
+  std::vector<uint32_t> next(NB_PRODUCERS, 0);
+  TestCommand cmd;
+
+  auto start = now_nsec();
+  for (uint32_t p = 0; p < NB_PRODUCERS; p++) {
+    producers.push_back(std::thread([&ring, p]() {
+      TestCommand cmd = {p, 0, 0, {0}};
+      for (uint32_t i = 0; i < NB_EVENTS; i++) {
+        cmd.sequence = i;
+        while (!ring.push(cmd)) {
+          std::this_thread::yield();
+        }
+      }
+    }));
+  }
+  for (uint64_t nb_popped = 0; nb_popped < NB_PRODUCERS * NB_EVENTS;) {
+    if (!ring.pop(cmd)) {
+      continue;
+    }
+    ASSERT_LT(cmd.producer, NB_PRODUCERS);
+    ASSERT_EQ(cmd.sequence, next[cmd.producer]);
+    next[cmd.producer]++;
+    nb_popped++;
+  }
+  auto nsec = now_nsec() - start;
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(ring.empty());
+  printf(
+    "%u producers: %.1f M events/s\n",
+    NB_PRODUCERS,
+    NB_PRODUCERS * NB_EVENTS * 1e3 / nsec);
+}
+
+/*
+ * Time from the push of a command to its pop, at the pace of the tunnel
+ * changes of the SPGW rather than with the ring full
+ */
+TEST(MPSCRingTest, TestLatencyBenchmark)
+{
+  const uint32_t nb_events = 100000;
+  MPSCRing<TestCommand> ring(1024);
+  std::vector<int64_t> latencies;
+  TestCommand cmd;
+
+  latencies.reserve(nb_events);
+  std::thread producer([&ring, nb_events]() {
+    TestCommand cmd = {0, 0, 0, {0}};
+    for (uint32_t i = 0; i < nb_events; i++) {
+      int64_t next_nsec = now_nsec() + 2000;
+      cmd.sequence = i;
+      cmd.pushed_nsec = now_nsec();
+      while (!ring.push(cmd)) {
+        std::this_thread::yield();
+      }
+      while (now_nsec() < next_nsec) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  while (latencies.size() < nb_events) {
+    if (ring.pop(cmd)) {
+      latencies.push_back(now_nsec() - cmd.pushed_nsec);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+
+  std::sort(latencies.begin(), latencies.end());
+  printf(
+    "Push to pop latency: p50 %.2f us, p99 %.2f us\n",
+    latencies[nb_events / 2] / 1e3,
+    latencies[nb_events * 99 / 100] / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+} // namespace
@@ -18,6 +18,7 @@
  * For more information about the OpenAirInterface (OAI) Software Alliance:
  *      contact@openairinterface.org
  */
+#include <string.h>
 #include <memory>
 #include <gtest/gtest.h>
 #include <fluid/of10msg.hh>
@@ -103,6 +104,55 @@ TEST_F(ControllerTest, TestMultipleApplications)
   default_connection_callback(OFConnection::EVENT_CLOSED);
 }
 
+MATCHER_P(CheckEventType, event_type, "")
+{
+  return arg.get_type() == event_type;
+}
+
+// Test that injected events are queued, then dispatched in order by batches
+TEST_F(ControllerTest, TestExternalEvents)
+{
+  MockApplication app;
+  ExternalCommand cmd;
+  const uint32_t nb_events = OpenflowController::EXTERNAL_EVENT_BATCH_SIZE + 1;
+
+  memset(&cmd, 0, sizeof(cmd));
+  controller->register_for_event(&app, EVENT_ADD_GTP_TUNNEL);
+  controller->register_for_event(&app, EVENT_DELETE_GTP_TUNNEL);
+  cmd.type = EVENT_ADD_GTP_TUNNEL;
+  for (uint32_t i = 1; i < nb_events; i++) {
+    EXPECT_TRUE(controller->inject_external_event(cmd));
+  }
+  cmd.type = EVENT_DELETE_GTP_TUNNEL;
+  EXPECT_TRUE(controller->inject_external_event(cmd));
+  {
+    InSequence dummy;
+    EXPECT_CALL(app, event_callback(CheckEventType(EVENT_ADD_GTP_TUNNEL), _))
+      .Times(nb_events - 1);
+    EXPECT_CALL(
+      app, event_callback(CheckEventType(EVENT_DELETE_GTP_TUNNEL), _))
+      .Times(1);
+  }
+  // Not connected: nothing is dispatched until the event loop drains
+  controller->drain_external_events();
+  controller->drain_external_events();
+}
+
+// Test that injection fails instead of blocking when the queue is full
+TEST_F(ControllerTest, TestExternalEventsFull)
+{
+  ExternalCommand cmd;
+
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.type = EVENT_ADD_GTP_TUNNEL;
+  for (size_t i = 0; i < OpenflowController::EXTERNAL_EVENT_RING_SIZE; i++) {
+    ASSERT_TRUE(controller->inject_external_event(cmd));
+  }
+  EXPECT_FALSE(controller->inject_external_event(cmd));
+  controller->drain_external_events();
+  EXPECT_TRUE(controller->inject_external_event(cmd));
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,259 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pgw_rules_bench.c
+  \brief Bearer marking rule installs per second, nftables backend against
+  forked iptables commands. Runs in its own network namespace, so that the
+  rules of the host are left alone; needs CAP_SYS_ADMIN and CAP_NET_ADMIN.
+*/
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "pgw_rules.h"
+
+#define PGW_RULES_BENCH_UE_BASE 0x0a800001 // 10.128.0.1
+#define PGW_RULES_BENCH_SDF_ID 1
+#define PGW_RULES_BENCH_EBI 6
+
+typedef struct pgw_rules_bench_config_s {
+  int nb_rules;
+  int batch;
+  int nb_iptables_rules;
+  bool netns;
+} pgw_rules_bench_config_t;
+
+static pgw_rules_bench_config_t config = {
+  .nb_rules = 10000,
+  .batch = 256,
+  .nb_iptables_rules = 500,
+  .netns = true,
+};
+
+//------------------------------------------------------------------------------
+static uint64_t pgw_rules_bench_now_usec(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//------------------------------------------------------------------------------
+static struct in_addr pgw_rules_bench_ue(int i)
+{
+  struct in_addr ue = {.s_addr = htonl(PGW_RULES_BENCH_UE_BASE + i)};
+  return ue;
+}
+
+//------------------------------------------------------------------------------
+static void pgw_rules_bench_report(
+  const char *name,
+  int nb_rules,
+  int nb_failed,
+  uint64_t usec)
+{
+  printf(
+    "%-28s %8d rules %6d failed %10.0f rules/s\n",
+    name,
+    nb_rules,
+    nb_failed,
+    usec ? nb_rules * 1e6 / usec : 0.0);
+}
+
+//------------------------------------------------------------------------------
+static int pgw_rules_bench_nftables(void)
+{
+  const struct pgw_rule_ops *ops = pgw_rule_ops_init_nftables();
+  uint64_t start = 0;
+  int nb_failed = 0;
+  bool ok = true;
+
+  if (ops->init(PGW_RULES_GTP_IFNAME) != RETURNok) {
+    fprintf(stderr, "nftables not available\n");
+    return RETURNerror;
+  }
+
+  start = pgw_rules_bench_now_usec();
+  for (int i = 0; i < config.nb_rules; i++) {
+    ops->add_bearer_mark(
+      pgw_rules_bench_ue(i), PGW_RULES_BENCH_SDF_ID, PGW_RULES_BENCH_EBI);
+    if (!((i + 1) % config.batch)) {
+      nb_failed += ops->commit();
+    }
+  }
+  nb_failed += ops->commit();
+  pgw_rules_bench_report(
+    "nftables add",
+    config.nb_rules,
+    nb_failed,
+    pgw_rules_bench_now_usec() - start);
+  ok &= (nb_failed == 0);
+
+  nb_failed = 0;
+  start = pgw_rules_bench_now_usec();
+  for (int i = 0; i < config.nb_rules; i++) {
+    ops->del_bearer_mark(
+      pgw_rules_bench_ue(i), PGW_RULES_BENCH_SDF_ID, PGW_RULES_BENCH_EBI);
+    if (!((i + 1) % config.batch)) {
+      nb_failed += ops->commit();
+    }
+  }
+  nb_failed += ops->commit();
+  pgw_rules_bench_report(
+    "nftables delete",
+    config.nb_rules,
+    nb_failed,
+    pgw_rules_bench_now_usec() - start);
+  ok &= (nb_failed == 0);
+
+  /* Deleting again makes the kernel abort every transaction, all the changes
+   * must then be replayed and reported as failed one by one */
+  nb_failed = 0;
+  start = pgw_rules_bench_now_usec();
+  for (int i = 0; i < config.nb_rules; i++) {
+    ops->del_bearer_mark(
+      pgw_rules_bench_ue(i), PGW_RULES_BENCH_SDF_ID, PGW_RULES_BENCH_EBI);
+    if (!((i + 1) % config.batch)) {
+      nb_failed += ops->commit();
+    }
+  }
+  nb_failed += ops->commit();
+  pgw_rules_bench_report(
+    "nftables delete (unknown)",
+    config.nb_rules,
+    nb_failed,
+    pgw_rules_bench_now_usec() - start);
+
+  ok &= (nb_failed == config.nb_rules);
+
+  ops->uninit();
+  return ok ? RETURNok : RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+static void pgw_rules_bench_iptables(void)
+{
+  uint64_t start = 0;
+  int nb_failed = 0;
+
+  start = pgw_rules_bench_now_usec();
+  for (int i = 0; i < config.nb_iptables_rules; i++) {
+    bstring command = pgw_rules_iptables_bearer_mark_command(
+      true,
+      PGW_RULES_GTP_IFNAME,
+      pgw_rules_bench_ue(i),
+      PGW_RULES_BENCH_SDF_ID,
+      PGW_RULES_BENCH_EBI);
+    if (system(bdata(command))) {
+      nb_failed++;
+    }
+    bdestroy_wrapper(&command);
+  }
+  pgw_rules_bench_report(
+    "iptables add (fork+exec)",
+    config.nb_iptables_rules,
+    nb_failed,
+    pgw_rules_bench_now_usec() - start);
+}
+
+//------------------------------------------------------------------------------
+static void pgw_rules_bench_usage(const char *name)
+{
+  fprintf(
+    stderr,
+    "Usage: %s [options]\n"
+    "  -n, --rules <n>          nftables rules to install (default 10000)\n"
+    "  -b, --batch <n>          Rules per nftables transaction (default 256)\n"
+    "  -i, --iptables <n>       iptables rules to install, 0 = skip (500)\n"
+    "  -N, --no-netns           Run in the current network namespace\n",
+    name);
+}
+
+//------------------------------------------------------------------------------
+static int pgw_rules_bench_parse_args(int argc, char *argv[])
+{
+  static const struct option long_options[] = {
+    {"rules", required_argument, NULL, 'n'},
+    {"batch", required_argument, NULL, 'b'},
+    {"iptables", required_argument, NULL, 'i'},
+    {"no-netns", no_argument, NULL, 'N'},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, 0, NULL, 0},
+  };
+  int c = 0;
+
+  while ((c = getopt_long(argc, argv, "n:b:i:Nh", long_options, NULL)) != -1) {
+    switch (c) {
+      case 'n': config.nb_rules = atoi(optarg); break;
+      case 'b': config.batch = atoi(optarg); break;
+      case 'i': config.nb_iptables_rules = atoi(optarg); break;
+      case 'N': config.netns = false; break;
+      default: return RETURNerror;
+    }
+  }
+  if ((config.nb_rules <= 0) || (config.batch <= 0)) {
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  int rc = RETURNok;
+
+  if (pgw_rules_bench_parse_args(argc, argv) != RETURNok) {
+    pgw_rules_bench_usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (
+    OAILOG_INIT("PGW_RULES_BENCH", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    fprintf(stderr, "Failed to initialize logging\n");
+    return EXIT_FAILURE;
+  }
+  if (config.netns && unshare(CLONE_NEWNET)) {
+    fprintf(
+      stderr, "Failed to create a network namespace: %s\n", strerror(errno));
+    return EXIT_FAILURE;
+  }
+
+  rc = pgw_rules_bench_nftables();
+  if (config.nb_iptables_rules > 0) {
+    pgw_rules_bench_iptables();
+  }
+  return (rc == RETURNok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,391 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "gtpu_userspace.h"
+
+#define TEST_GTPU_MAX_TUNNELS 1024
+#define TEST_GTPU_BENCH_TUNNELS 10000
+#define TEST_GTPU_BENCH_BATCHES 100000
+#define TEST_GTPU_PAYLOAD_LEN 100
+#define TEST_GTPU_ENB 0xc0a83c8e // 192.168.60.142
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static struct in_addr test_ue(uint32_t i)
+{
+  struct in_addr ue = {.s_addr = htonl(0x0a800002 + i)};
+
+  return ue;
+}
+
+static struct in_addr test_enb(void)
+{
+  struct in_addr enb = {.s_addr = htonl(TEST_GTPU_ENB)};
+
+  return enb;
+}
+
+// IPv4 packet of len bytes from src to dst
+static uint32_t test_ip_packet(
+  uint8_t *data,
+  uint32_t len,
+  struct in_addr src,
+  struct in_addr dst)
+{
+  memset(data, 0, len);
+  data[0] = 0x45;
+  data[2] = len >> 8;
+  data[3] = len & 0xff;
+  data[8] = 64;
+  data[9] = IPPROTO_UDP;
+  memcpy(data + 12, &src, sizeof(src));
+  memcpy(data + 16, &dst, sizeof(dst));
+  return len;
+}
+
+/* G-PDU carrying an uplink packet of the UE. With a sequence number when
+ * ext is not 0, and the extension header of that type then */
+static uint32_t test_gpdu(
+  uint8_t *data,
+  uint32_t teid,
+  struct in_addr ue,
+  uint8_t ext)
+{
+  struct in_addr server = {.s_addr = htonl(0x08080808)};
+  uint32_t offset = GTPU_US_HEADER_LEN;
+  uint32_t len = 0;
+
+  data[0] = 0x30;
+  data[1] = GTPU_US_MSG_GPDU;
+  data[4] = teid >> 24;
+  data[5] = (teid >> 16) & 0xff;
+  data[6] = (teid >> 8) & 0xff;
+  data[7] = teid & 0xff;
+  if (ext) {
+    data[0] |= 0x06;
+    data[8] = 0x12;
+    data[9] = 0x34;
+    data[10] = 0;
+    data[11] = ext;
+    // One 4 octet extension header, no other after it
+    data[12] = 1;
+    data[13] = 0xaa;
+    data[14] = 0xbb;
+    data[15] = 0;
+    offset += 8;
+  }
+  len = offset +
+        test_ip_packet(data + offset, TEST_GTPU_PAYLOAD_LEN, ue, server);
+  data[2] = (len - GTPU_US_HEADER_LEN) >> 8;
+  data[3] = (len - GTPU_US_HEADER_LEN) & 0xff;
+  return len;
+}
+
+static void test_setup(void)
+{
+  ck_assert_int_eq(gtpu_us_init(TEST_GTPU_MAX_TUNNELS), RETURNok);
+}
+
+static void test_teardown(void)
+{
+  gtpu_us_exit();
+}
+
+START_TEST(gtpu_userspace_table_test)
+{
+  gtpu_us_stats_t stats;
+  uint32_t teids[TEST_GTPU_MAX_TUNNELS];
+
+  srandom(42);
+  for (uint32_t i = 0; i < TEST_GTPU_MAX_TUNNELS; i++) {
+    teids[i] = random() + 1;
+    ck_assert_int_eq(
+      gtpu_us_add_tunnel(test_ue(i), test_enb(), teids[i], i), RETURNok);
+  }
+  ck_assert_int_eq(gtpu_us_count(), TEST_GTPU_MAX_TUNNELS);
+  ck_assert_int_eq(
+    gtpu_us_add_tunnel(test_ue(0), test_enb(), 0xfffffff0, 0), RETURNerror);
+
+  // Deleting every other tunnel shifts the collision chains back
+  for (uint32_t i = 0; i < TEST_GTPU_MAX_TUNNELS; i += 2) {
+    ck_assert_int_eq(gtpu_us_del_tunnel(teids[i]), RETURNok);
+  }
+  ck_assert_int_eq(gtpu_us_del_tunnel(teids[0]), RETURNerror);
+  for (uint32_t i = 0; i < TEST_GTPU_MAX_TUNNELS; i++) {
+    ck_assert_int_eq(
+      gtpu_us_get_tunnel_stats(teids[i], &stats),
+      (i % 2) ? RETURNok : RETURNerror);
+  }
+  ck_assert_int_eq(gtpu_us_count(), TEST_GTPU_MAX_TUNNELS / 2);
+
+  // The same TEID for another UE is refused
+  ck_assert_int_eq(
+    gtpu_us_add_tunnel(test_ue(0), test_enb(), teids[1], 1), RETURNerror);
+}
+END_TEST
+
+START_TEST(gtpu_userspace_uplink_test)
+{
+  uint8_t buffers[8][GTPU_US_PKT_BUFFER_SIZE];
+  gtpu_us_pkt_t pkts[8];
+  gtpu_us_stats_t stats;
+
+  ck_assert_int_eq(
+    gtpu_us_add_tunnel(test_ue(1), test_enb(), 100, 200), RETURNok);
+  memset(pkts, 0, sizeof(pkts));
+  for (int i = 0; i < 8; i++) {
+    pkts[i].data = buffers[i];
+  }
+  pkts[0].len = test_gpdu(buffers[0], 100, test_ue(1), 0);
+  pkts[1].len = test_gpdu(buffers[1], 100, test_ue(1), 0x85);
+  // Unknown TEID
+  pkts[2].len = test_gpdu(buffers[2], 101, test_ue(1), 0);
+  // Source address of another UE
+  pkts[3].len = test_gpdu(buffers[3], 100, test_ue(2), 0);
+  // Length beyond the datagram
+  pkts[4].len = test_gpdu(buffers[4], 100, test_ue(1), 0) - 1;
+  // GTPv0
+  pkts[5].len = test_gpdu(buffers[5], 100, test_ue(1), 0);
+  buffers[5][0] = 0x10;
+  // Extension header of length 0
+  pkts[6].len = test_gpdu(buffers[6], 100, test_ue(1), 0x85);
+  buffers[6][12] = 0;
+  // Echo Request
+  pkts[7].len = test_gpdu(buffers[7], 0, test_ue(1), 0x85);
+  buffers[7][1] = GTPU_US_MSG_ECHO_REQUEST;
+
+  gtpu_us_uplink_batch(pkts, 8);
+  ck_assert_int_eq(pkts[0].verdict, GTPU_US_FORWARD);
+  ck_assert_int_eq(pkts[0].offset, GTPU_US_HEADER_LEN);
+  ck_assert_int_eq(pkts[0].len, TEST_GTPU_PAYLOAD_LEN);
+  ck_assert_int_eq(pkts[1].verdict, GTPU_US_FORWARD);
+  ck_assert_int_eq(pkts[1].offset, GTPU_US_HEADER_LEN + 8);
+  ck_assert_int_eq(pkts[1].len, TEST_GTPU_PAYLOAD_LEN);
+  ck_assert_int_eq(pkts[1].data[pkts[1].offset], 0x45);
+  ck_assert_int_eq(pkts[2].verdict, GTPU_US_DROP_NO_TUNNEL);
+  ck_assert_int_eq(pkts[3].verdict, GTPU_US_DROP_SPOOFED);
+  ck_assert_int_eq(pkts[4].verdict, GTPU_US_DROP_MALFORMED);
+  ck_assert_int_eq(pkts[5].verdict, GTPU_US_DROP_MALFORMED);
+  ck_assert_int_eq(pkts[6].verdict, GTPU_US_DROP_MALFORMED);
+  ck_assert_int_eq(pkts[7].verdict, GTPU_US_ECHO_REQUEST);
+
+  ck_assert_int_eq(gtpu_us_get_tunnel_stats(100, &stats), RETURNok);
+  ck_assert_int_eq(stats.ul_packets, 2);
+  ck_assert_int_eq(stats.ul_bytes, 2 * TEST_GTPU_PAYLOAD_LEN);
+  ck_assert_int_eq(stats.dl_packets, 0);
+}
+END_TEST
+
+START_TEST(gtpu_userspace_downlink_test)
+{
+  struct in_addr server = {.s_addr = htonl(0x08080808)};
+  struct in_addr enb2 = {.s_addr = htonl(TEST_GTPU_ENB + 1)};
+  uint8_t buffers[3][GTPU_US_PKT_BUFFER_SIZE];
+  gtpu_us_pkt_t pkts[3];
+  gtpu_us_stats_t stats;
+  const uint8_t header[GTPU_US_HEADER_LEN] = {
+    0x30, GTPU_US_MSG_GPDU, 0, TEST_GTPU_PAYLOAD_LEN, 0x01, 0x02, 0x03, 0x04};
+
+  // Default bearer, then a dedicated one of the same UE
+  ck_assert_int_eq(
+    gtpu_us_add_tunnel(test_ue(1), test_enb(), 100, 0x01020304), RETURNok);
+  ck_assert_int_eq(gtpu_us_add_tunnel(test_ue(1), enb2, 101, 7), RETURNok);
+  memset(pkts, 0, sizeof(pkts));
+  for (int i = 0; i < 3; i++) {
+    pkts[i].data = buffers[i];
+  }
+  pkts[0].len = test_ip_packet(
+    buffers[0], TEST_GTPU_PAYLOAD_LEN, server, test_ue(1));
+  pkts[1].len = test_ip_packet(
+    buffers[1], TEST_GTPU_PAYLOAD_LEN, server, test_ue(2));
+  pkts[2].len = 10;
+
+  gtpu_us_downlink_batch(pkts, 3);
+  ck_assert_int_eq(pkts[0].verdict, GTPU_US_FORWARD);
+  ck_assert_int_eq(memcmp(pkts[0].header, header, sizeof(header)), 0);
+  ck_assert_int_eq(pkts[0].peer.s_addr, test_enb().s_addr);
+  ck_assert_int_eq(pkts[1].verdict, GTPU_US_DROP_NO_TUNNEL);
+  ck_assert_int_eq(pkts[2].verdict, GTPU_US_DROP_MALFORMED);
+  ck_assert_int_eq(gtpu_us_get_tunnel_stats(100, &stats), RETURNok);
+  ck_assert_int_eq(stats.dl_packets, 1);
+  ck_assert_int_eq(stats.dl_bytes, TEST_GTPU_PAYLOAD_LEN);
+
+  // Suspended UE
+  ck_assert_int_eq(gtpu_us_set_forwarding(100, false), RETURNok);
+  gtpu_us_downlink_batch(pkts, 1);
+  ck_assert_int_eq(pkts[0].verdict, GTPU_US_DROP_DISCARDED);
+  ck_assert_int_eq(gtpu_us_set_forwarding(100, true), RETURNok);
+
+  // Without its default bearer, the UE is reached through the dedicated one
+  ck_assert_int_eq(gtpu_us_del_tunnel(100), RETURNok);
+  gtpu_us_downlink_batch(pkts, 1);
+  ck_assert_int_eq(pkts[0].verdict, GTPU_US_FORWARD);
+  ck_assert_int_eq(pkts[0].peer.s_addr, enb2.s_addr);
+  ck_assert_int_eq(pkts[0].header[7], 7);
+  ck_assert_int_eq(gtpu_us_del_tunnel(101), RETURNok);
+  gtpu_us_downlink_batch(pkts, 1);
+  ck_assert_int_eq(pkts[0].verdict, GTPU_US_DROP_NO_TUNNEL);
+}
+END_TEST
+
+START_TEST(gtpu_userspace_echo_test)
+{
+  uint8_t req[GTPU_US_PKT_BUFFER_SIZE];
+  uint8_t resp[32];
+  uint32_t req_len = test_gpdu(req, 0, test_ue(1), 0x85);
+  int resp_len = 0;
+
+  req[1] = GTPU_US_MSG_ECHO_REQUEST;
+  resp_len = gtpu_us_echo_response(req, req_len, resp, sizeof(resp));
+  ck_assert_int_eq(resp_len, 14);
+  ck_assert_int_eq(resp[0], 0x32);
+  ck_assert_int_eq(resp[1], GTPU_US_MSG_ECHO_RESPONSE);
+  ck_assert_int_eq(resp[3], 6);
+  // Same sequence number, then the Recovery IE
+  ck_assert_int_eq(resp[8], 0x12);
+  ck_assert_int_eq(resp[9], 0x34);
+  ck_assert_int_eq(resp[12], 14);
+
+  // The sequence number is mandatory
+  req_len = test_gpdu(req, 0, test_ue(1), 0);
+  ck_assert_int_eq(gtpu_us_echo_response(req, req_len, resp, sizeof(resp)), -1);
+}
+END_TEST
+
+START_TEST(gtpu_userspace_benchmark_test)
+{
+  uint8_t(*gpdus)[GTPU_US_PKT_BUFFER_SIZE] =
+    calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  uint8_t(*ips)[GTPU_US_PKT_BUFFER_SIZE] =
+    calloc(GTPU_US_BATCH_SIZE, GTPU_US_PKT_BUFFER_SIZE);
+  struct in_addr server = {.s_addr = htonl(0x08080808)};
+  gtpu_us_pkt_t pkts[GTPU_US_BATCH_SIZE];
+  uint32_t gpdu_lens[GTPU_US_BATCH_SIZE];
+  uint64_t ul_usec = 0;
+  uint64_t dl_usec = 0;
+  uint64_t start = 0;
+  uint64_t nb_pkts = (uint64_t) TEST_GTPU_BENCH_BATCHES * GTPU_US_BATCH_SIZE;
+
+  ck_assert_ptr_ne(gpdus, NULL);
+  ck_assert_ptr_ne(ips, NULL);
+  gtpu_us_exit();
+  ck_assert_int_eq(gtpu_us_init(TEST_GTPU_BENCH_TUNNELS), RETURNok);
+  for (uint32_t i = 0; i < TEST_GTPU_BENCH_TUNNELS; i++) {
+    ck_assert_int_eq(
+      gtpu_us_add_tunnel(test_ue(i), test_enb(), 1000 + i, i), RETURNok);
+  }
+  for (uint32_t i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+    uint32_t ue = (i * 313) % TEST_GTPU_BENCH_TUNNELS;
+    gpdu_lens[i] = test_gpdu(gpdus[i], 1000 + ue, test_ue(ue), 0);
+    test_ip_packet(ips[i], TEST_GTPU_PAYLOAD_LEN, server, test_ue(ue));
+  }
+
+  start = test_now_usec();
+  for (uint32_t b = 0; b < TEST_GTPU_BENCH_BATCHES; b++) {
+    for (uint32_t i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+      pkts[i].data = gpdus[i];
+      pkts[i].len = gpdu_lens[i];
+    }
+    gtpu_us_uplink_batch(pkts, GTPU_US_BATCH_SIZE);
+    ck_assert_int_eq(pkts[b % GTPU_US_BATCH_SIZE].verdict, GTPU_US_FORWARD);
+  }
+  ul_usec = test_now_usec() - start;
+
+  start = test_now_usec();
+  for (uint32_t b = 0; b < TEST_GTPU_BENCH_BATCHES; b++) {
+    for (uint32_t i = 0; i < GTPU_US_BATCH_SIZE; i++) {
+      pkts[i].data = ips[i];
+      pkts[i].len = TEST_GTPU_PAYLOAD_LEN;
+    }
+    gtpu_us_downlink_batch(pkts, GTPU_US_BATCH_SIZE);
+    ck_assert_int_eq(pkts[b % GTPU_US_BATCH_SIZE].verdict, GTPU_US_FORWARD);
+  }
+  dl_usec = test_now_usec() - start;
+
+  printf(
+    "%u tunnels, batches of %u: decap %.1f Mpps, encap %.1f Mpps\n",
+    TEST_GTPU_BENCH_TUNNELS,
+    GTPU_US_BATCH_SIZE,
+    nb_pkts / (double) (ul_usec + 1),
+    nb_pkts / (double) (dl_usec + 1));
+  free(gpdus);
+  free(ips);
+}
+END_TEST
+
+Suite *gtpu_userspace_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("Userspace GTP-U tests");
+
+  tc_core = tcase_create("Userspace GTP-U test");
+  tcase_add_checked_fixture(tc_core, test_setup, test_teardown);
+  tcase_add_test(tc_core, gtpu_userspace_table_test);
+  tcase_add_test(tc_core, gtpu_userspace_uplink_test);
+  tcase_add_test(tc_core, gtpu_userspace_downlink_test);
+  tcase_add_test(tc_core, gtpu_userspace_echo_test);
+  tcase_add_test(tc_core, gtpu_userspace_benchmark_test);
+  tcase_set_timeout(tc_core, 60);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_GTPU_US", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = gtpu_userspace_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
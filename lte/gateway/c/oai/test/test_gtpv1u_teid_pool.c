@@ -0,0 +1,249 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "gtpv1u_teid_pool.h"
+
+#define TEST_TEID_POOL_SIZE 1000
+#define TEST_TEID_QUARANTINE_SEC 10
+#define TEST_TEID_NB_SHARDS 4
+#define TEST_TEID_STRESS_SIZE (1 << 20)
+#define TEST_TEID_STRESS_SESSIONS 100000
+#define TEST_TEID_STRESS_CYCLES 10000000
+
+static gtpv1u_teid_range_t test_range = {.first = 1,
+                                         .size = TEST_TEID_POOL_SIZE};
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+// Marks the TEID as used, false if it already was
+static bool test_take(uint8_t *used, gtpv1u_teid_range_t range, teid_t teid)
+{
+  ck_assert_uint_ge(teid, range.first);
+  ck_assert_uint_lt(teid - range.first, range.size);
+  if (used[teid - range.first]) {
+    return false;
+  }
+  used[teid - range.first] = 1;
+  return true;
+}
+
+START_TEST(gtpv1u_teid_unique_test)
+{
+  gtpv1u_teid_pool_t *pool = gtpv1u_teid_pool_create(test_range, 0);
+  uint8_t used[TEST_TEID_POOL_SIZE] = {0};
+
+  ck_assert_ptr_ne(pool, NULL);
+  for (int i = 0; i < TEST_TEID_POOL_SIZE; i++) {
+    ck_assert(test_take(used, test_range, gtpv1u_teid_alloc(pool, 0)));
+  }
+  ck_assert_uint_eq(gtpv1u_teid_count(pool), TEST_TEID_POOL_SIZE);
+  ck_assert_uint_eq(gtpv1u_teid_alloc(pool, 0), GTPV1U_TEID_INVALID);
+
+  // Neither released twice nor released when not from the pool
+  ck_assert_int_eq(gtpv1u_teid_free(pool, 42, 0), RETURNok);
+  ck_assert_int_eq(gtpv1u_teid_free(pool, 42, 0), RETURNerror);
+  ck_assert_int_eq(gtpv1u_teid_free(pool, 0, 0), RETURNerror);
+  ck_assert_int_eq(
+    gtpv1u_teid_free(pool, TEST_TEID_POOL_SIZE + 1, 0), RETURNerror);
+  ck_assert_uint_eq(gtpv1u_teid_count(pool), TEST_TEID_POOL_SIZE - 1);
+  ck_assert_uint_eq(gtpv1u_teid_alloc(pool, 0), 42);
+  gtpv1u_teid_pool_destroy(&pool);
+  ck_assert_ptr_eq(pool, NULL);
+}
+END_TEST
+
+START_TEST(gtpv1u_teid_quarantine_test)
+{
+  gtpv1u_teid_pool_t *pool =
+    gtpv1u_teid_pool_create(test_range, TEST_TEID_QUARANTINE_SEC);
+
+  for (int i = 0; i < TEST_TEID_POOL_SIZE; i++) {
+    gtpv1u_teid_alloc(pool, 100);
+  }
+  ck_assert_int_eq(gtpv1u_teid_free(pool, 7, 100), RETURNok);
+  ck_assert_int_eq(gtpv1u_teid_free(pool, 3, 105), RETURNok);
+
+  // Not reused before its quarantine is over, then oldest first
+  ck_assert_uint_eq(
+    gtpv1u_teid_alloc(pool, 100 + TEST_TEID_QUARANTINE_SEC - 1),
+    GTPV1U_TEID_INVALID);
+  ck_assert_uint_eq(
+    gtpv1u_teid_alloc(pool, 100 + TEST_TEID_QUARANTINE_SEC), 7);
+  ck_assert_uint_eq(
+    gtpv1u_teid_alloc(pool, 100 + TEST_TEID_QUARANTINE_SEC),
+    GTPV1U_TEID_INVALID);
+  ck_assert_uint_eq(
+    gtpv1u_teid_alloc(pool, 105 + TEST_TEID_QUARANTINE_SEC), 3);
+  gtpv1u_teid_pool_destroy(&pool);
+}
+END_TEST
+
+typedef struct test_shard_s {
+  gtpv1u_teid_range_t range;
+  uint8_t *used;
+  uint32_t nb_allocated;
+} test_shard_t;
+
+static void *test_shard_main(void *arg)
+{
+  test_shard_t *shard = (test_shard_t *) arg;
+  gtpv1u_teid_pool_t *pool = gtpv1u_teid_pool_create(shard->range, 0);
+  teid_t teid = GTPV1U_TEID_INVALID;
+
+  // Each thread owns its pool, the shared bitmap is written at disjoint bytes
+  while ((teid = gtpv1u_teid_alloc(pool, 0)) != GTPV1U_TEID_INVALID) {
+    shard->used[teid - test_range.first]++;
+    shard->nb_allocated++;
+  }
+  gtpv1u_teid_pool_destroy(&pool);
+  return NULL;
+}
+
+START_TEST(gtpv1u_teid_shard_test)
+{
+  uint8_t used[TEST_TEID_POOL_SIZE] = {0};
+  pthread_t threads[TEST_TEID_NB_SHARDS];
+  test_shard_t shards[TEST_TEID_NB_SHARDS];
+  uint32_t nb_allocated = 0;
+
+  // 1000 is not a multiple of 3: the last shard takes the remainder
+  ck_assert_uint_eq(gtpv1u_teid_shard(test_range, 2, 3).first, 667);
+  ck_assert_uint_eq(gtpv1u_teid_shard(test_range, 2, 3).size, 334);
+
+  for (int i = 0; i < TEST_TEID_NB_SHARDS; i++) {
+    shards[i].range = gtpv1u_teid_shard(test_range, i, TEST_TEID_NB_SHARDS);
+    shards[i].used = used;
+    shards[i].nb_allocated = 0;
+    pthread_create(&threads[i], NULL, test_shard_main, &shards[i]);
+  }
+  for (int i = 0; i < TEST_TEID_NB_SHARDS; i++) {
+    pthread_join(threads[i], NULL);
+    nb_allocated += shards[i].nb_allocated;
+  }
+  ck_assert_uint_eq(nb_allocated, TEST_TEID_POOL_SIZE);
+  for (int i = 0; i < TEST_TEID_POOL_SIZE; i++) {
+    ck_assert_uint_eq(used[i], 1);
+  }
+}
+END_TEST
+
+START_TEST(gtpv1u_teid_stress_test)
+{
+  gtpv1u_teid_range_t range = {.first = 0x10000,
+                               .size = TEST_TEID_STRESS_SIZE};
+  gtpv1u_teid_pool_t *pool =
+    gtpv1u_teid_pool_create(range, TEST_TEID_QUARANTINE_SEC);
+  uint8_t *used = calloc(TEST_TEID_STRESS_SIZE, 1);
+  teid_t *sessions = calloc(TEST_TEID_STRESS_SESSIONS, sizeof(teid_t));
+  uint32_t seed = 1;
+  uint64_t start = 0;
+  uint64_t usec = 0;
+  time_t now = 0;
+
+  ck_assert_ptr_ne(pool, NULL);
+  for (int i = 0; i < TEST_TEID_STRESS_SESSIONS; i++) {
+    sessions[i] = gtpv1u_teid_alloc(pool, now);
+    ck_assert(test_take(used, range, sessions[i]));
+  }
+
+  // Sessions released and set up at random, 10000 per simulated second
+  start = test_now_usec();
+  for (uint32_t i = 0; i < TEST_TEID_STRESS_CYCLES; i++) {
+    uint32_t session = 0;
+
+    seed = seed * 1103515245 + 12345;
+    session = (seed >> 8) % TEST_TEID_STRESS_SESSIONS;
+    now = i / 10000;
+    used[sessions[session] - range.first] = 0;
+    ck_assert_int_eq(gtpv1u_teid_free(pool, sessions[session], now), RETURNok);
+    sessions[session] = gtpv1u_teid_alloc(pool, now);
+    ck_assert(test_take(used, range, sessions[session]));
+  }
+  usec = test_now_usec() - start;
+  ck_assert_uint_eq(gtpv1u_teid_count(pool), TEST_TEID_STRESS_SESSIONS);
+
+  printf(
+    "%u alloc/free cycles on %u sessions: %.0f cycles/s\n",
+    TEST_TEID_STRESS_CYCLES,
+    TEST_TEID_STRESS_SESSIONS,
+    TEST_TEID_STRESS_CYCLES * 1e6 / (usec + 1));
+  free(sessions);
+  free(used);
+  gtpv1u_teid_pool_destroy(&pool);
+}
+END_TEST
+
+Suite *gtpv1u_teid_pool_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("GTPv1-U TEID pool tests");
+
+  tc_core = tcase_create("GTPv1-U TEID pool test");
+  tcase_add_test(tc_core, gtpv1u_teid_unique_test);
+  tcase_add_test(tc_core, gtpv1u_teid_quarantine_test);
+  tcase_add_test(tc_core, gtpv1u_teid_shard_test);
+  tcase_add_test(tc_core, gtpv1u_teid_stress_test);
+  tcase_set_timeout(tc_core, 120);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_TEID_POOL", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = gtpv1u_teid_pool_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
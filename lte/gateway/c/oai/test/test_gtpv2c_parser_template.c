@@ -0,0 +1,461 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "dynamic_memory_check.h"
+#include "intertask_interface.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cIe.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cMsgParser.h"
+#include "NwGtpv2cPrivate.h"
+#include "sgw_ie_defs.h"
+#include "s11_common.h"
+#include "s11_ie_formatter.h"
+
+#define TEST_GTPV2C_PARSER_BENCH_ITERATIONS 200000
+#define TEST_GTPV2C_PARSER_FLAGS 0x48 // Version 2, TEID present
+
+/* IEs of the Create Session Request, as expected by the SGW */
+static const struct {
+  uint8_t type;
+  uint8_t instance;
+  uint8_t presence;
+  nw_rc_t (*callback)(uint8_t, uint8_t, uint8_t, uint8_t *, void *);
+  size_t offset;
+} create_session_request_ies[] = {
+  {NW_GTPV2C_IE_IMSI,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_imsi_ie_get,
+   offsetof(itti_s11_create_session_request_t, imsi)},
+  {NW_GTPV2C_IE_MSISDN,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_msisdn_ie_get,
+   offsetof(itti_s11_create_session_request_t, msisdn)},
+  {NW_GTPV2C_IE_MEI,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_mei_ie_get,
+   offsetof(itti_s11_create_session_request_t, mei)},
+  {NW_GTPV2C_IE_ULI,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_uli_ie_get,
+   offsetof(itti_s11_create_session_request_t, uli)},
+  {NW_GTPV2C_IE_SERVING_NETWORK,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_serving_network_ie_get,
+   offsetof(itti_s11_create_session_request_t, serving_network)},
+  {NW_GTPV2C_IE_RAT_TYPE,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_MANDATORY,
+   gtpv2c_rat_type_ie_get,
+   offsetof(itti_s11_create_session_request_t, rat_type)},
+  {NW_GTPV2C_IE_INDICATION,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_indication_flags_ie_get,
+   offsetof(itti_s11_create_session_request_t, indication_flags)},
+  {NW_GTPV2C_IE_APN,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_MANDATORY,
+   gtpv2c_apn_ie_get,
+   offsetof(itti_s11_create_session_request_t, apn)},
+  {NW_GTPV2C_IE_SELECTION_MODE,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   s11_ie_indication_generic,
+   NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG},
+  {NW_GTPV2C_IE_PDN_TYPE,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_pdn_type_ie_get,
+   offsetof(itti_s11_create_session_request_t, pdn_type)},
+  {NW_GTPV2C_IE_PAA,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_paa_ie_get,
+   offsetof(itti_s11_create_session_request_t, paa)},
+  {NW_GTPV2C_IE_FTEID,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_MANDATORY,
+   gtpv2c_fteid_ie_get,
+   offsetof(itti_s11_create_session_request_t, sender_fteid_for_cp)},
+  {NW_GTPV2C_IE_FTEID,
+   NW_GTPV2C_IE_INSTANCE_ONE,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_fteid_ie_get,
+   offsetof(itti_s11_create_session_request_t, pgw_address_for_cp)},
+  {NW_GTPV2C_IE_APN_RESTRICTION,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   s11_ie_indication_generic,
+   NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG},
+  {NW_GTPV2C_IE_BEARER_CONTEXT,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_MANDATORY,
+   gtpv2c_bearer_context_to_be_created_within_create_session_request_ie_get,
+   offsetof(itti_s11_create_session_request_t, bearer_contexts_to_be_created)},
+  {NW_GTPV2C_IE_PCO,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_pco_ie_get,
+   offsetof(itti_s11_create_session_request_t, pco)},
+  {NW_GTPV2C_IE_AMBR,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+   gtpv2c_ambr_ie_get,
+   offsetof(itti_s11_create_session_request_t, ambr)},
+  {NW_GTPV2C_IE_RECOVERY,
+   NW_GTPV2C_IE_INSTANCE_ZERO,
+   NW_GTPV2C_IE_PRESENCE_MANDATORY,
+   s11_ie_indication_generic,
+   NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG},
+};
+
+#define CREATE_SESSION_REQUEST_IES                                             \
+  (sizeof(create_session_request_ies) / sizeof(create_session_request_ies[0]))
+
+static nw_gtpv2c_stack_handle_t stack = 0;
+static nw_gtpv2c_msg_parser_template_t *create_session_request_template = NULL;
+
+static nw_gtpv2c_msg_parser_template_t *create_session_request_template_new(
+  void)
+{
+  nw_gtpv2c_msg_parser_template_t *tmpl = NULL;
+
+  if (
+    nwGtpv2cMsgParserTemplateNew(
+      NW_GTP_CREATE_SESSION_REQ, s11_ie_indication_generic, &tmpl) != NW_OK) {
+    return NULL;
+  }
+  for (int i = 0; i < CREATE_SESSION_REQUEST_IES; i++) {
+    if (
+      nwGtpv2cMsgParserTemplateAddIe(
+        tmpl,
+        create_session_request_ies[i].type,
+        create_session_request_ies[i].instance,
+        create_session_request_ies[i].presence,
+        create_session_request_ies[i].callback,
+        create_session_request_ies[i].offset) != NW_OK) {
+      nwGtpv2cMsgParserTemplateDelete(tmpl);
+      return NULL;
+    }
+  }
+  return tmpl;
+}
+
+/* Per message parser, as built by the S11 handlers before the templates */
+static nw_rc_t create_session_request_parse(
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_s11_create_session_request_t *req,
+  uint8_t *offendingIeType)
+{
+  nw_gtpv2c_msg_parser_t *pMsgParser = NULL;
+  uint8_t offendingIeInstance = 0;
+  uint16_t offendingIeLength = 0;
+  nw_rc_t rc = NW_OK;
+
+  rc = nwGtpv2cMsgParserNew(
+    stack,
+    NW_GTP_CREATE_SESSION_REQ,
+    s11_ie_indication_generic,
+    NULL,
+    &pMsgParser);
+  ck_assert_int_eq(rc, NW_OK);
+  for (int i = 0; i < CREATE_SESSION_REQUEST_IES; i++) {
+    nwGtpv2cMsgParserAddIe(
+      pMsgParser,
+      create_session_request_ies[i].type,
+      create_session_request_ies[i].instance,
+      create_session_request_ies[i].presence,
+      create_session_request_ies[i].callback,
+      (create_session_request_ies[i].offset ==
+       NW_GTPV2C_MSG_PARSER_TEMPLATE_NO_ARG) ?
+        NULL :
+        ((uint8_t *) req) + create_session_request_ies[i].offset);
+  }
+  rc = nwGtpv2cMsgParserRun(
+    pMsgParser,
+    hMsg,
+    offendingIeType,
+    &offendingIeInstance,
+    &offendingIeLength);
+  nwGtpv2cMsgParserDelete(stack, pMsgParser);
+  return rc;
+}
+
+static nw_rc_t create_session_request_parse_template(
+  nw_gtpv2c_msg_handle_t hMsg,
+  itti_s11_create_session_request_t *req,
+  uint8_t *offendingIeType)
+{
+  uint8_t offendingIeInstance = 0;
+  uint16_t offendingIeLength = 0;
+
+  return nwGtpv2cMsgParserTemplateRun(
+    create_session_request_template,
+    hMsg,
+    req,
+    offendingIeType,
+    &offendingIeInstance,
+    &offendingIeLength);
+}
+
+/* Create Session Request of an initial attach, as sent by the MME */
+static nw_gtpv2c_msg_handle_t create_session_request_new(bool with_bearer)
+{
+  nw_gtpv2c_msg_handle_t hMsg = 0;
+  imsi_t imsi = {.u.value = {0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0xf1},
+                 .length = 8};
+  rat_type_t rat_type = RAT_EUTRAN;
+  pdn_type_t pdn_type = IPv4;
+  ServingNetwork_t serving_network = {.mcc = {0, 0, 1}, .mnc = {0, 1, 15}};
+  struct in_addr mme_ip = {.s_addr = htonl(0xc0a83c8e)};
+  protocol_configuration_options_t pco = {0};
+  bearer_context_to_be_created_t bearer = {0};
+  uint8_t restart_counter = 0;
+  nw_gtpv2c_msg_t *pMsg = NULL;
+
+  ck_assert_int_eq(
+    nwGtpv2cMsgNew(stack, true, NW_GTP_CREATE_SESSION_REQ, 0, 1, &hMsg),
+    NW_OK);
+  nwGtpv2cMsgAddIe(hMsg, NW_GTPV2C_IE_RECOVERY, 1, 0, &restart_counter);
+  gtpv2c_imsi_ie_set(&hMsg, &imsi);
+  gtpv2c_rat_type_ie_set(&hMsg, &rat_type);
+  gtpv2c_pdn_type_ie_set(&hMsg, &pdn_type);
+  nwGtpv2cMsgAddIeFteid(
+    hMsg, NW_GTPV2C_IE_INSTANCE_ZERO, S11_MME_GTP_C, 0x1234, &mme_ip, NULL);
+  nwGtpv2cMsgAddIeFteid(
+    hMsg, NW_GTPV2C_IE_INSTANCE_ONE, S5_S8_PGW_GTP_C, 0, &mme_ip, NULL);
+  gtpv2c_apn_ie_set(&hMsg, "internet");
+  gtpv2c_serving_network_ie_set(&hMsg, &serving_network);
+  pco.ext = 1;
+  pco.num_protocol_or_container_id = 1;
+  pco.protocol_or_container_ids[0].id =
+    PCO_CI_IP_ADDRESS_ALLOCATION_VIA_NAS_SIGNALLING;
+  pco.protocol_or_container_ids[0].length = 0;
+  gtpv2c_pco_ie_set(&hMsg, &pco);
+  if (with_bearer) {
+    bearer.eps_bearer_id = 5;
+    bearer.bearer_level_qos.qci = 9;
+    bearer.bearer_level_qos.pl = 15;
+    gtpv2c_bearer_context_to_be_created_within_create_session_request_ie_set(
+      &hMsg, &bearer);
+  }
+  /*
+   * The header is only written when the message is sent
+   */
+  pMsg = (nw_gtpv2c_msg_t *) hMsg;
+  pMsg->msgBuf[0] = TEST_GTPV2C_PARSER_FLAGS;
+  return hMsg;
+}
+
+static void create_session_request_clear(itti_s11_create_session_request_t *req)
+{
+  clear_protocol_configuration_options(&req->pco);
+  memset(req, 0, sizeof(*req));
+}
+
+START_TEST(gtpv2c_parser_template_equivalence_test)
+{
+  nw_gtpv2c_msg_handle_t hMsg = create_session_request_new(true);
+  itti_s11_create_session_request_t req = {0};
+  itti_s11_create_session_request_t req_tmpl = {0};
+  uint8_t offendingIeType = 0;
+
+  ck_assert_int_eq(
+    create_session_request_parse(hMsg, &req, &offendingIeType), NW_OK);
+  ck_assert_int_eq(
+    create_session_request_parse_template(hMsg, &req_tmpl, &offendingIeType),
+    NW_OK);
+
+  ck_assert_str_eq(req.apn, "internet");
+  ck_assert_str_eq(req_tmpl.apn, req.apn);
+  ck_assert_int_eq(req_tmpl.rat_type, RAT_EUTRAN);
+  ck_assert_int_eq(req_tmpl.pdn_type, IPv4);
+  ck_assert_int_eq(req_tmpl.sender_fteid_for_cp.teid, 0x1234);
+  ck_assert_int_eq(
+    req_tmpl.bearer_contexts_to_be_created.num_bearer_context, 1);
+  ck_assert_int_eq(
+    req_tmpl.bearer_contexts_to_be_created.bearer_contexts[0].eps_bearer_id,
+    5);
+  ck_assert_int_eq(req_tmpl.pco.num_protocol_or_container_id, 1);
+  ck_assert(!memcmp(&req.imsi, &req_tmpl.imsi, sizeof(req.imsi)));
+  ck_assert(!memcmp(
+    &req.serving_network,
+    &req_tmpl.serving_network,
+    sizeof(req.serving_network)));
+  ck_assert(!memcmp(
+    &req.bearer_contexts_to_be_created,
+    &req_tmpl.bearer_contexts_to_be_created,
+    sizeof(req.bearer_contexts_to_be_created)));
+  ck_assert(nwGtpv2cMsgIsIePresent(hMsg, NW_GTPV2C_IE_APN, 0));
+  ck_assert(!nwGtpv2cMsgIsIePresent(hMsg, NW_GTPV2C_IE_MSISDN, 0));
+
+  create_session_request_clear(&req);
+  create_session_request_clear(&req_tmpl);
+  nwGtpv2cMsgDelete(stack, hMsg);
+}
+END_TEST
+
+START_TEST(gtpv2c_parser_template_mandatory_ie_test)
+{
+  nw_gtpv2c_msg_handle_t hMsg = create_session_request_new(false);
+  itti_s11_create_session_request_t req = {0};
+  uint8_t offendingIeType = 0;
+
+  ck_assert_int_eq(
+    create_session_request_parse_template(hMsg, &req, &offendingIeType),
+    NW_GTPV2C_MANDATORY_IE_MISSING);
+  ck_assert_int_eq(offendingIeType, NW_GTPV2C_IE_BEARER_CONTEXT);
+
+  create_session_request_clear(&req);
+  nwGtpv2cMsgDelete(stack, hMsg);
+}
+END_TEST
+
+START_TEST(gtpv2c_parser_template_malformed_test)
+{
+  nw_gtpv2c_msg_handle_t hMsg = create_session_request_new(true);
+  nw_gtpv2c_msg_t *pMsg = (nw_gtpv2c_msg_t *) hMsg;
+  itti_s11_create_session_request_t req = {0};
+  uint8_t offendingIeType = 0;
+
+  /*
+   * Cut the last IE in its header, then in its value
+   */
+  pMsg->msgLen -= 3 + 4;
+  ck_assert_int_eq(
+    create_session_request_parse_template(hMsg, &req, &offendingIeType),
+    NW_GTPV2C_MSG_MALFORMED);
+  create_session_request_clear(&req);
+  pMsg->msgLen += 4;
+  ck_assert_int_eq(
+    create_session_request_parse_template(hMsg, &req, &offendingIeType),
+    NW_GTPV2C_MSG_MALFORMED);
+  ck_assert_int_eq(offendingIeType, NW_GTPV2C_IE_BEARER_CONTEXT);
+
+  create_session_request_clear(&req);
+  nwGtpv2cMsgDelete(stack, hMsg);
+}
+END_TEST
+
+START_TEST(gtpv2c_parser_template_benchmark_test)
+{
+  nw_gtpv2c_msg_handle_t hMsg = create_session_request_new(true);
+  itti_s11_create_session_request_t req = {0};
+  uint8_t offendingIeType = 0;
+  struct timespec start, end;
+  double parser_usec, template_usec;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < TEST_GTPV2C_PARSER_BENCH_ITERATIONS; i++) {
+    ck_assert_int_eq(
+      create_session_request_parse(hMsg, &req, &offendingIeType), NW_OK);
+    create_session_request_clear(&req);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  parser_usec = (end.tv_sec - start.tv_sec) * 1e6 +
+                (end.tv_nsec - start.tv_nsec) / 1e3;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < TEST_GTPV2C_PARSER_BENCH_ITERATIONS; i++) {
+    ck_assert_int_eq(
+      create_session_request_parse_template(hMsg, &req, &offendingIeType),
+      NW_OK);
+    create_session_request_clear(&req);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  template_usec = (end.tv_sec - start.tv_sec) * 1e6 +
+                  (end.tv_nsec - start.tv_nsec) / 1e3;
+
+  printf(
+    "Create Session Request: parser %.0f parses/s, template %.0f parses/s\n",
+    TEST_GTPV2C_PARSER_BENCH_ITERATIONS * 1e6 / parser_usec,
+    TEST_GTPV2C_PARSER_BENCH_ITERATIONS * 1e6 / template_usec);
+
+  nwGtpv2cMsgDelete(stack, hMsg);
+}
+END_TEST
+
+Suite *gtpv2c_parser_template_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("GTPv2-C parser template tests");
+
+  /* Core test case */
+  tc_core = tcase_create("GTPv2-C parser template test");
+  tcase_add_test(tc_core, gtpv2c_parser_template_equivalence_test);
+  tcase_add_test(tc_core, gtpv2c_parser_template_mandatory_ie_test);
+  tcase_add_test(tc_core, gtpv2c_parser_template_malformed_test);
+  tcase_add_test(tc_core, gtpv2c_parser_template_benchmark_test);
+  tcase_set_timeout(tc_core, 60);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  /* The IE getters log through the OAI logger */
+  if (
+    OAILOG_INIT("TEST_GTPV2C_PARSER", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+  create_session_request_template = create_session_request_template_new();
+  if (
+    (nwGtpv2cInitialize(&stack) != NW_OK) ||
+    (create_session_request_template == NULL)) {
+    return EXIT_FAILURE;
+  }
+
+  s = gtpv2c_parser_template_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  nwGtpv2cMsgParserTemplateDelete(create_session_request_template);
+  nwGtpv2cFinalize(stack);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,338 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "NwGtpv2c.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cPrivate.h"
+#include "NwGtpv2cTrxn.h"
+
+#define TEST_GTPV2C_POOLS_STACKS 4
+#define TEST_GTPV2C_POOLS_ITERATIONS 2000
+#define TEST_GTPV2C_POOLS_BURST 64
+#define TEST_GTPV2C_POOLS_TIMERS 8
+#define TEST_GTPV2C_POOLS_HANDOFF_SIZE 256
+
+/* Messages allocated by one stack thread and released by another one */
+typedef struct test_gtpv2c_pools_handoff_s {
+  pthread_mutex_t lock;
+  nw_gtpv2c_msg_handle_t hMsg[TEST_GTPV2C_POOLS_HANDOFF_SIZE];
+  int count;
+} test_gtpv2c_pools_handoff_t;
+
+typedef struct test_gtpv2c_pools_worker_s {
+  pthread_t thread;
+  nw_gtpv2c_stack_handle_t hStack;
+  int failures;
+} test_gtpv2c_pools_worker_t;
+
+static test_gtpv2c_pools_handoff_t handoff = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static nw_rc_t test_gtpv2c_pools_tmr_start(
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  uint32_t timeoutSec,
+  uint32_t timeoutUsec,
+  uint32_t tmrType,
+  void *tmrArg,
+  nw_gtpv2c_timer_handle_t *tmrHandle)
+{
+  *tmrHandle = (nw_gtpv2c_timer_handle_t) tmrArg;
+  return NW_OK;
+}
+
+static nw_rc_t test_gtpv2c_pools_tmr_stop(
+  nw_gtpv2c_timer_mgr_handle_t tmrMgrHandle,
+  nw_gtpv2c_timer_handle_t tmrHandle)
+{
+  return NW_OK;
+}
+
+static nw_rc_t test_gtpv2c_pools_timeout(void *arg)
+{
+  return NW_OK;
+}
+
+static nw_gtpv2c_stack_handle_t test_gtpv2c_pools_stack_new(void)
+{
+  nw_gtpv2c_stack_handle_t hStack = 0;
+  nw_gtpv2c_timer_mgr_entity_t tmrMgr = {
+    .tmrMgrHandle = 0,
+    .tmrStartCallback = test_gtpv2c_pools_tmr_start,
+    .tmrStopCallback = test_gtpv2c_pools_tmr_stop,
+  };
+
+  if (nwGtpv2cInitialize(&hStack) != NW_OK) {
+    return 0;
+  }
+  nwGtpv2cSetTimerMgrEntity(hStack, &tmrMgr);
+  return hStack;
+}
+
+static void test_gtpv2c_pools_handoff_put(
+  nw_gtpv2c_stack_handle_t hStack,
+  nw_gtpv2c_msg_handle_t hMsg)
+{
+  nw_gtpv2c_msg_handle_t hOld = 0;
+
+  pthread_mutex_lock(&handoff.lock);
+  if (handoff.count < TEST_GTPV2C_POOLS_HANDOFF_SIZE) {
+    handoff.hMsg[handoff.count++] = hMsg;
+  } else {
+    hOld = hMsg;
+  }
+  pthread_mutex_unlock(&handoff.lock);
+
+  if (hOld) {
+    nwGtpv2cMsgDelete(hStack, hOld);
+  }
+}
+
+static void test_gtpv2c_pools_handoff_take(nw_gtpv2c_stack_handle_t hStack)
+{
+  nw_gtpv2c_msg_handle_t hMsg = 0;
+
+  pthread_mutex_lock(&handoff.lock);
+  if (handoff.count > 0) {
+    hMsg = handoff.hMsg[--handoff.count];
+  }
+  pthread_mutex_unlock(&handoff.lock);
+
+  /* Released through the stack of this thread, goes back to its owner */
+  if (hMsg) {
+    nwGtpv2cMsgDelete(hStack, hMsg);
+  }
+}
+
+static void *test_gtpv2c_pools_worker(void *arg)
+{
+  test_gtpv2c_pools_worker_t *worker = (test_gtpv2c_pools_worker_t *) arg;
+  nw_gtpv2c_stack_t *pStack = (nw_gtpv2c_stack_t *) worker->hStack;
+  nw_gtpv2c_msg_handle_t hMsg[TEST_GTPV2C_POOLS_BURST];
+  nw_gtpv2c_trxn_t *pTrxn[TEST_GTPV2C_POOLS_BURST];
+  nw_gtpv2c_timer_handle_t hTimer[TEST_GTPV2C_POOLS_TIMERS];
+
+  for (int i = 0; i < TEST_GTPV2C_POOLS_ITERATIONS; i++) {
+    for (int j = 0; j < TEST_GTPV2C_POOLS_BURST; j++) {
+      if (
+        nwGtpv2cMsgNew(
+          worker->hStack,
+          true,
+          NW_GTP_ECHO_REQ,
+          0,
+          (uint32_t) j,
+          &hMsg[j]) != NW_OK) {
+        worker->failures++;
+        hMsg[j] = 0;
+      }
+      pTrxn[j] = nwGtpv2cTrxnNew(pStack);
+      if (!pTrxn[j]) {
+        worker->failures++;
+      }
+    }
+    for (int j = 0; j < TEST_GTPV2C_POOLS_TIMERS; j++) {
+      if (
+        nwGtpv2cStartTimer(
+          pStack,
+          60 + j,
+          0,
+          NW_GTPV2C_TMR_TYPE_ONE_SHOT,
+          test_gtpv2c_pools_timeout,
+          NULL,
+          &hTimer[j]) != NW_OK) {
+        worker->failures++;
+      }
+    }
+
+    for (int j = 0; j < TEST_GTPV2C_POOLS_BURST; j++) {
+      if (pTrxn[j] && hMsg[j] && (j % 2)) {
+        /* The transaction owns the message from now on */
+        pTrxn[j]->pMsg = (nw_gtpv2c_msg_t *) hMsg[j];
+        hMsg[j] = 0;
+      }
+      if (pTrxn[j]) {
+        nwGtpv2cTrxnDelete(&pTrxn[j]);
+      }
+      if (hMsg[j] && !(j % 4)) {
+        test_gtpv2c_pools_handoff_put(worker->hStack, hMsg[j]);
+      } else if (hMsg[j]) {
+        nwGtpv2cMsgDelete(worker->hStack, hMsg[j]);
+      }
+      test_gtpv2c_pools_handoff_take(worker->hStack);
+    }
+    for (int j = TEST_GTPV2C_POOLS_TIMERS - 1; j >= 0; j--) {
+      nwGtpv2cStopTimer(pStack, hTimer[j]);
+    }
+  }
+  return NULL;
+}
+
+static void test_gtpv2c_pools_check_idle(nw_gtpv2c_pool_stats_t *pool)
+{
+  ck_assert_int_eq(pool->usedCount, 0);
+  ck_assert_uint_le(pool->freeCount, pool->freeMax);
+}
+
+START_TEST(gtpv2c_pools_prealloc_test)
+{
+  nw_gtpv2c_stack_handle_t hStack = test_gtpv2c_pools_stack_new();
+  nw_gtpv2c_stack_stats_t stats;
+
+  ck_assert(hStack != 0);
+  ck_assert_int_eq(nwGtpv2cGetStackStats(hStack, &stats), NW_OK);
+  ck_assert_int_eq(stats.msgPool.freeCount, NW_GTPV2C_MSG_POOL_PREALLOC);
+  ck_assert_int_eq(stats.trxnPool.freeCount, NW_GTPV2C_TRXN_POOL_PREALLOC);
+  ck_assert_int_eq(stats.tunnelPool.freeCount, NW_GTPV2C_TUNNEL_POOL_PREALLOC);
+  ck_assert_int_eq(
+    stats.timeoutInfoPool.freeCount, NW_GTPV2C_TIMEOUT_INFO_POOL_PREALLOC);
+  ck_assert_int_eq(stats.msgPool.usedCount, 0);
+  ck_assert_int_eq(stats.msgPool.heapAllocCount, 0);
+  nwGtpv2cFinalize(hStack);
+}
+END_TEST
+
+START_TEST(gtpv2c_pools_bounded_test)
+{
+  nw_gtpv2c_stack_handle_t hStack = test_gtpv2c_pools_stack_new();
+  int count = NW_GTPV2C_MSG_POOL_FREE_MAX + NW_GTPV2C_MSG_POOL_PREALLOC;
+  nw_gtpv2c_msg_handle_t *hMsg = calloc(count, sizeof(*hMsg));
+  nw_gtpv2c_stack_stats_t stats;
+
+  ck_assert(hStack != 0);
+  ck_assert(hMsg != NULL);
+  for (int i = 0; i < count; i++) {
+    ck_assert_int_eq(
+      nwGtpv2cMsgNew(hStack, true, NW_GTP_ECHO_REQ, 0, i, &hMsg[i]), NW_OK);
+  }
+  nwGtpv2cGetStackStats(hStack, &stats);
+  ck_assert_int_eq(stats.msgPool.usedCount, count);
+  ck_assert_int_eq(stats.msgPool.usedMax, count);
+  ck_assert_int_eq(stats.msgPool.freeCount, 0);
+  ck_assert_int_eq(
+    stats.msgPool.heapAllocCount, count - NW_GTPV2C_MSG_POOL_PREALLOC);
+
+  for (int i = 0; i < count; i++) {
+    nwGtpv2cMsgDelete(hStack, hMsg[i]);
+  }
+  /* The objects above the bound go back to the heap */
+  nwGtpv2cGetStackStats(hStack, &stats);
+  ck_assert_int_eq(stats.msgPool.usedCount, 0);
+  ck_assert_int_eq(stats.msgPool.freeCount, NW_GTPV2C_MSG_POOL_FREE_MAX);
+  free(hMsg);
+  nwGtpv2cFinalize(hStack);
+}
+END_TEST
+
+START_TEST(gtpv2c_pools_stress_test)
+{
+  test_gtpv2c_pools_worker_t workers[TEST_GTPV2C_POOLS_STACKS];
+  nw_gtpv2c_stack_stats_t stats;
+  uint64_t msg_used_max = 0;
+
+  memset(workers, 0, sizeof(workers));
+  for (int i = 0; i < TEST_GTPV2C_POOLS_STACKS; i++) {
+    workers[i].hStack = test_gtpv2c_pools_stack_new();
+    ck_assert(workers[i].hStack != 0);
+  }
+  for (int i = 0; i < TEST_GTPV2C_POOLS_STACKS; i++) {
+    ck_assert_int_eq(
+      pthread_create(
+        &workers[i].thread, NULL, test_gtpv2c_pools_worker, &workers[i]),
+      0);
+  }
+  for (int i = 0; i < TEST_GTPV2C_POOLS_STACKS; i++) {
+    pthread_join(workers[i].thread, NULL);
+    ck_assert_int_eq(workers[i].failures, 0);
+  }
+  /* Whatever is left in the handoff goes back to its owner */
+  while (handoff.count > 0) {
+    test_gtpv2c_pools_handoff_take(workers[0].hStack);
+  }
+
+  for (int i = 0; i < TEST_GTPV2C_POOLS_STACKS; i++) {
+    ck_assert_int_eq(nwGtpv2cGetStackStats(workers[i].hStack, &stats), NW_OK);
+    test_gtpv2c_pools_check_idle(&stats.msgPool);
+    test_gtpv2c_pools_check_idle(&stats.trxnPool);
+    test_gtpv2c_pools_check_idle(&stats.tunnelPool);
+    test_gtpv2c_pools_check_idle(&stats.timeoutInfoPool);
+    ck_assert_uint_ge(stats.msgPool.usedMax, TEST_GTPV2C_POOLS_BURST);
+    ck_assert_uint_ge(stats.trxnPool.usedMax, TEST_GTPV2C_POOLS_BURST);
+    ck_assert_uint_ge(stats.timeoutInfoPool.usedMax, TEST_GTPV2C_POOLS_TIMERS);
+    msg_used_max += stats.msgPool.usedMax;
+    nwGtpv2cFinalize(workers[i].hStack);
+  }
+  printf(
+    "%d stacks, %d iterations: peak %" PRIu64 " messages in use\n",
+    TEST_GTPV2C_POOLS_STACKS,
+    TEST_GTPV2C_POOLS_ITERATIONS,
+    msg_used_max);
+}
+END_TEST
+
+Suite *gtpv2c_pools_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("GTPv2-C pool tests");
+
+  tc_core = tcase_create("GTPv2-C pool test");
+  tcase_add_test(tc_core, gtpv2c_pools_prealloc_test);
+  tcase_add_test(tc_core, gtpv2c_pools_bounded_test);
+  tcase_add_test(tc_core, gtpv2c_pools_stress_test);
+  tcase_set_timeout(tc_core, 60);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_GTPV2C_POOLS", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = gtpv2c_pools_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,278 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "intertask_interface.h"
+#include "itti_workers.h"
+
+#define TEST_ITTI_WORKERS_KEYS 64
+#define TEST_ITTI_WORKERS_MESSAGES 100000
+#define TEST_ITTI_WORKERS_EXCLUSIVE_EVERY 97
+#define TEST_ITTI_WORKERS_BARRIER_EVERY 1009
+#define TEST_ITTI_WORKERS_BENCH_MESSAGES 200000
+// Per message processing cost of the benchmark, about an S1AP decode + handle
+#define TEST_ITTI_WORKERS_BENCH_WORK 2000
+
+/*
+ * The test messages carry their key in SCTP_DATA_CNF.assoc_id, their rank
+ * among the messages of the key in SCTP_DATA_CNF.mme_ue_s1ap_id and whether
+ * they have been dispatched as exclusive in SCTP_DATA_CNF.is_success.
+ * Barriers have the key TEST_ITTI_WORKERS_KEYS and carry the number of
+ * messages dispatched before them instead of a rank.
+ */
+static uint32_t test_next_rank[TEST_ITTI_WORKERS_KEYS];
+static uint32_t test_work = 0;
+static volatile uint32_t test_running = 0;
+static volatile uint32_t test_handled = 0;
+static volatile uint32_t test_out_of_order = 0;
+static volatile uint32_t test_not_exclusive = 0;
+static volatile uint32_t test_barrier_misplaced = 0;
+static volatile uint32_t test_sink = 0;
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void test_reset(uint32_t work)
+{
+  for (int i = 0; i < TEST_ITTI_WORKERS_KEYS; i++) {
+    test_next_rank[i] = 0;
+  }
+  test_work = work;
+  test_running = 0;
+  test_handled = 0;
+  test_out_of_order = 0;
+  test_not_exclusive = 0;
+  test_barrier_misplaced = 0;
+}
+
+static void test_handler(MessageDef *message_p)
+{
+  uint32_t running = __sync_add_and_fetch(&test_running, 1);
+  uint32_t key = SCTP_DATA_CNF(message_p).assoc_id;
+  uint32_t hash = key;
+
+  if (SCTP_DATA_CNF(message_p).is_success && (running != 1)) {
+    __sync_fetch_and_add(&test_not_exclusive, 1);
+  }
+  if (key < TEST_ITTI_WORKERS_KEYS) {
+    // Only the worker of the key updates its rank
+    if (SCTP_DATA_CNF(message_p).mme_ue_s1ap_id != test_next_rank[key]) {
+      __sync_fetch_and_add(&test_out_of_order, 1);
+    }
+    test_next_rank[key] = SCTP_DATA_CNF(message_p).mme_ue_s1ap_id + 1;
+  } else if (test_handled != SCTP_DATA_CNF(message_p).mme_ue_s1ap_id) {
+    // A message dispatched after the barrier ran, or one before did not yet
+    __sync_fetch_and_add(&test_barrier_misplaced, 1);
+  }
+  for (uint32_t i = 0; i < test_work; i++) {
+    hash = (hash * 31) ^ i;
+  }
+  __sync_fetch_and_add(&test_sink, hash);
+  __sync_fetch_and_sub(&test_running, 1);
+  __sync_fetch_and_add(&test_handled, 1);
+  free(message_p);
+}
+
+static MessageDef *test_message(uint32_t key, uint32_t rank, bool exclusive)
+{
+  MessageDef *message_p = calloc(1, sizeof(MessageDef));
+
+  ck_assert_ptr_ne(message_p, NULL);
+  SCTP_DATA_CNF(message_p).assoc_id = key;
+  SCTP_DATA_CNF(message_p).mme_ue_s1ap_id = rank;
+  SCTP_DATA_CNF(message_p).is_success = exclusive;
+  return message_p;
+}
+
+/*
+ * Dispatches nb_messages over the keys, and barriers in between if nb_barriers
+ * is not NULL. Returns the number of exclusive messages.
+ */
+static uint32_t test_dispatch(
+  itti_workers_t *workers,
+  uint32_t nb_messages,
+  bool with_exclusive,
+  uint32_t *nb_barriers)
+{
+  uint32_t rank[TEST_ITTI_WORKERS_KEYS] = {0};
+  uint32_t nb_exclusive = 0;
+
+  for (uint32_t i = 0; i < nb_messages; i++) {
+    uint32_t key = (i * 7) % TEST_ITTI_WORKERS_KEYS;
+    bool exclusive =
+      with_exclusive && ((i % TEST_ITTI_WORKERS_EXCLUSIVE_EVERY) == 0);
+
+    if (nb_barriers && ((i % TEST_ITTI_WORKERS_BARRIER_EVERY) == 0)) {
+      itti_workers_dispatch_barrier(
+        workers,
+        test_message(TEST_ITTI_WORKERS_KEYS, i + (*nb_barriers), true));
+      (*nb_barriers)++;
+    }
+    nb_exclusive += exclusive;
+    itti_workers_dispatch(
+      workers, key, exclusive, test_message(key, rank[key]++, exclusive));
+  }
+  return nb_exclusive;
+}
+
+START_TEST(itti_workers_create_test)
+{
+  itti_workers_t *workers = NULL;
+
+  ck_assert_int_eq(itti_workers_count(workers), 0);
+  ck_assert_ptr_eq(itti_workers_create("TEST", 0, test_handler), NULL);
+  workers = itti_workers_create("TEST", 3, test_handler);
+  ck_assert_ptr_ne(workers, NULL);
+  ck_assert_int_eq(itti_workers_count(workers), 3);
+  itti_workers_destroy(&workers);
+  ck_assert_ptr_eq(workers, NULL);
+  // Nothing to stop
+  itti_workers_destroy(&workers);
+}
+END_TEST
+
+START_TEST(itti_workers_ordering_test)
+{
+  itti_workers_t *workers = NULL;
+
+  test_reset(100);
+  workers = itti_workers_create("TEST", 4, test_handler);
+  ck_assert_ptr_ne(workers, NULL);
+  test_dispatch(workers, TEST_ITTI_WORKERS_MESSAGES, false, NULL);
+  // Queued messages are processed before the workers stop
+  itti_workers_destroy(&workers);
+  ck_assert_int_eq(test_handled, TEST_ITTI_WORKERS_MESSAGES);
+  ck_assert_int_eq(test_out_of_order, 0);
+  // In order and none lost: the next ranks add up to the messages count
+  uint32_t nb_messages = 0;
+  for (int i = 0; i < TEST_ITTI_WORKERS_KEYS; i++) {
+    nb_messages += test_next_rank[i];
+  }
+  ck_assert_int_eq(nb_messages, TEST_ITTI_WORKERS_MESSAGES);
+}
+END_TEST
+
+START_TEST(itti_workers_exclusive_test)
+{
+  itti_workers_t *workers = NULL;
+  uint32_t nb_exclusive = 0;
+  uint32_t nb_barriers = 0;
+
+  test_reset(100);
+  workers = itti_workers_create("TEST", 4, test_handler);
+  ck_assert_ptr_ne(workers, NULL);
+  nb_exclusive =
+    test_dispatch(workers, TEST_ITTI_WORKERS_MESSAGES, true, &nb_barriers);
+  ck_assert_int_gt(nb_exclusive, 0);
+  ck_assert_int_gt(nb_barriers, 0);
+  itti_workers_destroy(&workers);
+  ck_assert_int_eq(test_handled, TEST_ITTI_WORKERS_MESSAGES + nb_barriers);
+  ck_assert_int_eq(test_out_of_order, 0);
+  ck_assert_int_eq(test_not_exclusive, 0);
+  ck_assert_int_eq(test_barrier_misplaced, 0);
+}
+END_TEST
+
+START_TEST(itti_workers_benchmark_test)
+{
+  static const uint32_t nb_workers[] = {1, 2, 4, 8};
+  double rate_1 = 0;
+
+  for (int i = 0; i < sizeof(nb_workers) / sizeof(nb_workers[0]); i++) {
+    itti_workers_t *workers = NULL;
+    uint64_t start = 0;
+    double rate = 0;
+
+    test_reset(TEST_ITTI_WORKERS_BENCH_WORK);
+    workers = itti_workers_create("TEST", nb_workers[i], test_handler);
+    ck_assert_ptr_ne(workers, NULL);
+    start = test_now_usec();
+    test_dispatch(workers, TEST_ITTI_WORKERS_BENCH_MESSAGES, false, NULL);
+    itti_workers_destroy(&workers);
+    rate =
+      TEST_ITTI_WORKERS_BENCH_MESSAGES * 1e6 / (test_now_usec() - start + 1);
+    ck_assert_int_eq(test_handled, TEST_ITTI_WORKERS_BENCH_MESSAGES);
+    if (nb_workers[i] == 1) {
+      rate_1 = rate;
+    }
+    printf(
+      "%u workers, %u keys: %9.0f messages/s (x%.2f)\n",
+      nb_workers[i],
+      TEST_ITTI_WORKERS_KEYS,
+      rate,
+      rate / rate_1);
+  }
+}
+END_TEST
+
+Suite *itti_workers_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("ITTI workers tests");
+
+  tc_core = tcase_create("ITTI workers test");
+  tcase_add_test(tc_core, itti_workers_create_test);
+  tcase_add_test(tc_core, itti_workers_ordering_test);
+  tcase_add_test(tc_core, itti_workers_exclusive_test);
+  tcase_add_test(tc_core, itti_workers_benchmark_test);
+  tcase_set_timeout(tc_core, 120);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_ITTI_WORKERS", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = itti_workers_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bstrlib.h"
+#include "common_types.h"
+#include "hashtable.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_hss_reset.h"
+
+#define TEST_HSS_RESET_NB_UES 100000
+/* UE contexts are large, keys are spread over a smaller pool of contexts */
+#define TEST_HSS_RESET_NB_CONTEXTS 1024
+
+static void test_no_free(void **unused)
+{
+  (void) unused;
+}
+
+START_TEST(token_bucket_burst_test)
+{
+  mme_app_token_bucket_t bucket;
+
+  mme_app_token_bucket_init(&bucket, 500, 50, 1000);
+
+  /* Full bucket at start, nothing left right after */
+  ck_assert_uint_eq(mme_app_token_bucket_take(&bucket, 1000, 200), 50);
+  ck_assert_uint_eq(mme_app_token_bucket_take(&bucket, 1000, 1), 0);
+
+  /* 10 ms at 500/s refill 5 tokens */
+  ck_assert_uint_eq(mme_app_token_bucket_take(&bucket, 11000, 200), 5);
+
+  /* A long pause never refills above the burst */
+  ck_assert_uint_eq(mme_app_token_bucket_take(&bucket, 60000000, 200), 50);
+}
+END_TEST
+
+START_TEST(token_bucket_rate_test)
+{
+  mme_app_token_bucket_t bucket;
+  uint64_t granted = 0;
+
+  mme_app_token_bucket_init(&bucket, 500, 50, 0);
+
+  /* Drain every 10 ms for 10 s: burst + rate * duration, no more */
+  for (uint64_t now = 0; now <= 10000000; now += 10000) {
+    granted += mme_app_token_bucket_take(&bucket, now, UINT32_MAX);
+  }
+  ck_assert_uint_eq(granted, 50 + 500 * 10);
+}
+END_TEST
+
+START_TEST(hss_reset_sweep_bounded_test)
+{
+  hash_table_ts_t *htbl = NULL;
+  ue_mm_context_t *contexts = NULL;
+  mme_app_hss_reset_sweep_t sweep;
+  mme_ue_s1ap_id_t ue_id = INVALID_MME_UE_S1AP_ID;
+  pthread_mutexattr_t attr;
+  uint32_t max_bucket = 0;
+  uint32_t visited = 0;
+  uint32_t max_visited = 0;
+  uint32_t total_visited = 0;
+  uint32_t slices = 0;
+  uint32_t queued = 0;
+  uint32_t expected_queued = 0;
+  bstring name = bfromcstr("test_hss_reset_htbl");
+
+  memset(&sweep, 0, sizeof(sweep));
+  htbl = hashtable_ts_create(TEST_HSS_RESET_NB_UES, NULL, test_no_free, name);
+  ck_assert_ptr_ne(htbl, NULL);
+
+  contexts = calloc(TEST_HSS_RESET_NB_CONTEXTS, sizeof(ue_mm_context_t));
+  ck_assert_ptr_ne(contexts, NULL);
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  for (int i = 0; i < TEST_HSS_RESET_NB_CONTEXTS; i++) {
+    pthread_mutex_init(&contexts[i].recmutex, &attr);
+    contexts[i].mme_ue_s1ap_id = i + 1;
+    contexts[i].mm_state = (i % 8) ? UE_REGISTERED : UE_UNREGISTERED;
+    contexts[i].ecm_state = (i % 2) ? ECM_CONNECTED : ECM_IDLE;
+  }
+  for (int i = 1; i <= TEST_HSS_RESET_NB_UES; i++) {
+    ue_mm_context_t *ue = &contexts[i % TEST_HSS_RESET_NB_CONTEXTS];
+    hashtable_ts_insert(htbl, (const hash_key_t) i, ue);
+    if ((ue->mm_state == UE_REGISTERED) && (ue->ecm_state == ECM_CONNECTED)) {
+      expected_queued++;
+    }
+  }
+
+  /* A slice only ends after a whole bucket */
+  for (hash_size_t b = 0; b < htbl->size; b++) {
+    uint32_t length = 0;
+
+    for (hash_node_t *node = htbl->nodes[b]; node; node = node->next) {
+      length++;
+    }
+    if (length > max_bucket) {
+      max_bucket = length;
+    }
+  }
+
+  mme_app_hss_reset_sweep_start(&sweep, 0);
+  while (sweep.in_progress) {
+    visited = mme_app_hss_reset_sweep_slice(
+      &sweep, htbl, MME_APP_HSS_RESET_SWEEP_SLICE);
+    if (visited > max_visited) {
+      max_visited = visited;
+    }
+    total_visited += visited;
+    slices++;
+    ck_assert_uint_le(slices, TEST_HSS_RESET_NB_UES);
+  }
+  printf(
+    "Swept %u UEs in %u slices, largest slice %u UEs\n",
+    total_visited,
+    slices,
+    max_visited);
+
+  /* Every UE visited once, in slices of about the configured size */
+  ck_assert_uint_eq(total_visited, TEST_HSS_RESET_NB_UES);
+  ck_assert_uint_ge(
+    slices, TEST_HSS_RESET_NB_UES / (2 * MME_APP_HSS_RESET_SWEEP_SLICE));
+
+  /* A slice must leave room for other messages within a timer tick */
+  ck_assert_uint_lt(max_visited, MME_APP_HSS_RESET_SWEEP_SLICE + max_bucket);
+
+  for (int i = 0; i < TEST_HSS_RESET_NB_CONTEXTS; i++) {
+    ck_assert(
+      contexts[i].location_info_confirmed_in_hss ==
+      (contexts[i].mm_state == UE_REGISTERED));
+  }
+  while (mme_app_hss_reset_ulr_dequeue(&sweep, &ue_id)) {
+    ue_mm_context_t *ue = &contexts[ue_id - 1];
+    ck_assert(ue->mm_state == UE_REGISTERED);
+    ck_assert(ue->ecm_state == ECM_CONNECTED);
+    queued++;
+  }
+  ck_assert_uint_eq(queued, expected_queued);
+
+  mme_app_hss_reset_sweep_free(&sweep);
+  hashtable_ts_destroy(htbl);
+  for (int i = 0; i < TEST_HSS_RESET_NB_CONTEXTS; i++) {
+    pthread_mutex_destroy(&contexts[i].recmutex);
+  }
+  pthread_mutexattr_destroy(&attr);
+  free(contexts);
+}
+END_TEST
+
+Suite *hss_reset_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("HSS reset tests");
+
+  /* Core test case */
+  tc_core = tcase_create("HSS reset test");
+  tcase_add_test(tc_core, token_bucket_burst_test);
+  tcase_add_test(tc_core, token_bucket_rate_test);
+  tcase_add_test(tc_core, hss_reset_sweep_bounded_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  /* UE context locking logs through the OAI logger */
+  if (
+    OAILOG_INIT("TEST_HSS_RESET", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = hss_reset_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
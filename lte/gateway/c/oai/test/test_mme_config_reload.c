@@ -0,0 +1,211 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "mme_config.h"
+#include "mme_config_snapshot.h"
+
+#define TEST_CONFIG_GUMMEI                                                     \
+  "  GUMMEI_LIST = ({MCC=\"001\"; MNC=\"01\"; MME_GID=\"1\"; "                 \
+  "MME_CODE=\"1\";});\n"
+#define TEST_CONFIG_INTERFACES                                                 \
+  "  NETWORK_INTERFACES: {\n"                                                  \
+  "    MME_INTERFACE_NAME_FOR_S1_MME = \"eth1\";\n"                            \
+  "    MME_IPV4_ADDRESS_FOR_S1_MME = \"%s\";\n"                                \
+  "    MME_INTERFACE_NAME_FOR_S11_MME = \"lo\";\n"                             \
+  "    MME_IPV4_ADDRESS_FOR_S11_MME = \"127.0.0.1/8\";\n"                      \
+  "    MME_PORT_FOR_S11_MME = 2123;\n"                                         \
+  "  };\n"
+
+static char test_config_file[] = "/tmp/test_mme_config_XXXXXX";
+
+static void test_write_config(
+  const char *tai_list,
+  const char *s1_mme,
+  const char *extra)
+{
+  FILE *f = fopen(test_config_file, "w");
+
+  ck_assert_ptr_ne(f, NULL);
+  fprintf(f, "MME: {\n");
+  fprintf(f, "  TAI_LIST = (%s);\n", tai_list);
+  fprintf(f, TEST_CONFIG_GUMMEI);
+  fprintf(f, TEST_CONFIG_INTERFACES, s1_mme);
+  fprintf(f, "%s", extra);
+  fprintf(f, "};\n");
+  fclose(f);
+}
+
+static void test_setup(void)
+{
+  int fd = mkstemp(test_config_file);
+
+  ck_assert_int_ge(fd, 0);
+  close(fd);
+  test_write_config(
+    "{MCC=\"001\"; MNC=\"01\"; TAC=\"1\";}", "192.168.60.142/24", "");
+  mme_config_init(&mme_config);
+  mme_config.config_file = bfromcstr(test_config_file);
+  ck_assert_int_eq(mme_config_parse_file(&mme_config), 0);
+  ck_assert_int_eq(mme_config_snapshot_publish(&mme_config), RETURNok);
+}
+
+static void test_teardown(void)
+{
+  mme_config_snapshot_exit();
+  mme_config_exit();
+  unlink(test_config_file);
+  strcpy(test_config_file + strlen(test_config_file) - 6, "XXXXXX");
+}
+
+/* Every invalid file is rejected, the current snapshot stays */
+static void test_reload_rejected(
+  const char *tai_list,
+  const char *s1_mme,
+  const char *extra)
+{
+  const mme_config_snapshot_t *before = mme_config_snapshot_get();
+  const mme_config_snapshot_t *after = NULL;
+
+  test_write_config(tai_list, s1_mme, extra);
+  ck_assert_int_eq(mme_config_reload(), RETURNerror);
+  after = mme_config_snapshot_get();
+  ck_assert_ptr_eq(after, before);
+  ck_assert_int_eq(mme_config_find_mnc_length(0, 0, 1, 0, 1, 0), 2);
+  mme_config_snapshot_put(after);
+  mme_config_snapshot_put(before);
+}
+
+START_TEST(mme_config_reload_invalid_test)
+{
+  const char *tai = "{MCC=\"001\"; MNC=\"01\"; TAC=\"1\";}";
+  char many_tais[2048] = {0};
+
+  for (int i = 0; i <= MME_CONFIG_MAX_TAI; i++) {
+    char one[64];
+
+    snprintf(
+      one,
+      sizeof(one),
+      "%s{MCC=\"001\"; MNC=\"01\"; TAC=\"%d\";}",
+      i ? "," : "",
+      i + 1);
+    strcat(many_tais, one);
+  }
+
+  // Syntax error
+  test_reload_rejected(
+    "{MCC=\"001\"; MNC=\"01\" TAC=\"1\";}", "192.168.60.142/24", "");
+  test_reload_rejected(many_tais, "192.168.60.142/24", "");
+  test_reload_rejected(
+    "{MCC=\"001\"; MNC=\"0001\"; TAC=\"1\";}", "192.168.60.142/24", "");
+  test_reload_rejected(tai, "192.168.60.142", "");
+  test_reload_rejected(tai, "192.168.60.300/24", "");
+  test_reload_rejected(
+    tai, "192.168.60.142/24", "  S1AP: {S1AP_WORKERS = 0;};\n");
+  test_reload_rejected(tai, "192.168.60.142/24", "  UE_WORKERS = 1000;\n");
+  test_reload_rejected(
+    tai, "192.168.60.142/24", "  NAS: {AUTH_VECTOR_PREFETCH = 0;};\n");
+  test_reload_rejected(
+    tai, "192.168.60.142/24", "  NAS: {AUTH_VECTOR_LIFETIME = -1;};\n");
+  // Only one GUMMEI is supported
+  test_reload_rejected(
+    tai,
+    "192.168.60.142/24",
+    "  GUMMEI_LIST = ({MCC=\"001\"; MNC=\"01\";},"
+    " {MCC=\"001\"; MNC=\"02\";});\n");
+}
+END_TEST
+
+START_TEST(mme_config_reload_valid_test)
+{
+  const mme_config_snapshot_t *before = mme_config_snapshot_get();
+  const mme_config_snapshot_t *after = NULL;
+
+  test_write_config(
+    "{MCC=\"001\"; MNC=\"01\"; TAC=\"1\";},"
+    "{MCC=\"310\"; MNC=\"410\"; TAC=\"2\";}",
+    "192.168.60.142/24",
+    "");
+  ck_assert_int_eq(mme_config_reload(), RETURNok);
+  after = mme_config_snapshot_get();
+  ck_assert_ptr_ne(after, before);
+  ck_assert_uint_eq(after->generation, before->generation + 1);
+  ck_assert_uint_eq(after->served_tai.nb_tai, 2);
+  // The replaced snapshot stays valid until its last reader releases it
+  ck_assert_uint_eq(before->served_tai.nb_tai, 1);
+  ck_assert_uint_eq(before->refcount, 1);
+  mme_config_snapshot_put(before);
+  mme_config_snapshot_put(after);
+
+  // The MNC length follows the served PLMNs of the new snapshot
+  ck_assert_int_eq(mme_config_find_mnc_length(3, 1, 0, 4, 1, 0), 3);
+  ck_assert_int_eq(mme_config_find_mnc_length(0, 0, 1, 0, 1, 0), 2);
+  ck_assert_int_eq(mme_config_find_mnc_length(2, 0, 8, 9, 3, 0), 0);
+}
+END_TEST
+
+Suite *mme_config_reload_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("MME config reload tests");
+
+  tc_core = tcase_create("MME config reload test");
+  tcase_add_checked_fixture(tc_core, test_setup, test_teardown);
+  tcase_add_test(tc_core, mme_config_reload_invalid_test);
+  tcase_add_test(tc_core, mme_config_reload_valid_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_MME_CONFIG", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = mme_config_reload_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
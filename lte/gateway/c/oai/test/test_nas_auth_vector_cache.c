@@ -0,0 +1,364 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "common_types.h"
+#include "nas_auth_vector_cache.h"
+
+#define TEST_IMSI64 ((imsi64_t) 1010000000001)
+#define TEST_NB_THREADS 4
+#define TEST_NB_UES_PER_THREAD 2000
+
+static uint64_t test_now = 1000;
+
+static uint64_t test_clock(void)
+{
+  return test_now;
+}
+
+static nas_auth_vector_cache_config_t test_config = {
+  .vectors_per_air = 4,
+  .low_water_mark = 2,
+  .lifetime_sec = 60,
+  .max_ues = 1000,
+  .now_sec = test_clock,
+};
+
+/* Vector number n of a subscriber, its RAND tells them apart */
+static void test_vector(const imsi64_t imsi64, int n, eutran_vector_t *vector)
+{
+  memset(vector, 0, sizeof(*vector));
+  memcpy(vector->rand, &imsi64, sizeof(imsi64));
+  vector->rand[RAND_LENGTH_OCTETS - 1] = (uint8_t) n;
+  vector->xres.size = XRES_LENGTH_MAX;
+}
+
+static void test_vectors(
+  const imsi64_t imsi64,
+  int first,
+  int nb,
+  eutran_vector_t *vectors)
+{
+  for (int i = 0; i < nb; i++) {
+    test_vector(imsi64, first + i, &vectors[i]);
+  }
+}
+
+static int test_vector_number(const eutran_vector_t *vector)
+{
+  return vector->rand[RAND_LENGTH_OCTETS - 1];
+}
+
+static void test_setup(void)
+{
+  test_now = 1000;
+  ck_assert_int_eq(nas_auth_vector_cache_init(&test_config), RETURNok);
+}
+
+static void test_teardown(void)
+{
+  nas_auth_vector_cache_exit();
+}
+
+START_TEST(auth_vector_cache_disabled_test)
+{
+  nas_auth_vector_cache_config_t config = test_config;
+  eutran_vector_t vectors[2];
+  eutran_vector_t vector;
+  bool prefetch = true;
+
+  nas_auth_vector_cache_exit();
+  config.vectors_per_air = 1;
+  ck_assert_int_eq(nas_auth_vector_cache_init(&config), RETURNok);
+  ck_assert_int_eq(nas_auth_vector_cache_vectors_per_air(), 1);
+
+  test_vectors(TEST_IMSI64, 0, 2, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 2, false);
+  ck_assert(!nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert(!prefetch);
+
+  // A low water mark reaching the batch size is refused
+  nas_auth_vector_cache_exit();
+  config.vectors_per_air = 2;
+  config.low_water_mark = 2;
+  ck_assert_int_eq(nas_auth_vector_cache_init(&config), RETURNerror);
+}
+END_TEST
+
+START_TEST(auth_vector_cache_fifo_test)
+{
+  eutran_vector_t vectors[4];
+  eutran_vector_t vector;
+  nas_auth_vector_cache_stats_t stats;
+  bool prefetch = false;
+
+  ck_assert_int_eq(nas_auth_vector_cache_vectors_per_air(), 4);
+  ck_assert(!nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+
+  // The first vector of a batch is used by the procedure, 3 are cached
+  test_vectors(TEST_IMSI64, 1, 3, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 3, false);
+
+  // Vectors come out in SQN order, prefetch once below the low water mark
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert_int_eq(test_vector_number(&vector), 1);
+  ck_assert(!prefetch);
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert_int_eq(test_vector_number(&vector), 2);
+  ck_assert(prefetch);
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert_int_eq(test_vector_number(&vector), 3);
+  ck_assert(!prefetch);
+  ck_assert(!nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert(!prefetch);
+
+  // The prefetched vectors refill the subscriber
+  test_vectors(TEST_IMSI64, 4, 4, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 3, true);
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert_int_eq(test_vector_number(&vector), 4);
+
+  nas_auth_vector_cache_get_stats(&stats);
+  ck_assert_uint_eq(stats.hits, 4);
+  ck_assert_uint_eq(stats.misses, 2);
+  ck_assert_uint_eq(stats.prefetches, 1);
+  ck_assert_uint_eq(stats.stored, 6);
+}
+END_TEST
+
+START_TEST(auth_vector_cache_flush_test)
+{
+  eutran_vector_t vectors[4];
+  eutran_vector_t vector;
+  nas_auth_vector_cache_stats_t stats;
+  bool prefetch = false;
+
+  test_vectors(TEST_IMSI64, 1, 3, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 3, false);
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert(prefetch);
+
+  // A re-synchronisation while the prefetch is in flight makes it stale
+  nas_auth_vector_cache_flush(TEST_IMSI64);
+  ck_assert(!nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  test_vectors(TEST_IMSI64, 4, 4, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 4, true);
+  ck_assert(!nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+
+  nas_auth_vector_cache_get_stats(&stats);
+  ck_assert_uint_eq(stats.flushed, 1);
+  ck_assert_uint_eq(stats.dropped, 4);
+
+  // A failed prefetch lets the next hit ask again
+  test_vectors(TEST_IMSI64, 8, 3, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 3, false);
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert(prefetch);
+  nas_auth_vector_cache_prefetch_failed(TEST_IMSI64);
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert_int_eq(test_vector_number(&vector), 10);
+  ck_assert(prefetch);
+}
+END_TEST
+
+START_TEST(auth_vector_cache_capacity_test)
+{
+  eutran_vector_t vectors[4];
+  eutran_vector_t vector;
+  bool prefetch = false;
+
+  // Room for 2 batches, the oldest vectors make room for the newest
+  for (int batch = 0; batch < 3; batch++) {
+    test_vectors(TEST_IMSI64, 4 * batch, 4, vectors);
+    nas_auth_vector_cache_put(TEST_IMSI64, vectors, 4, false);
+  }
+  for (int n = 4; n < 12; n++) {
+    ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+    ck_assert_int_eq(test_vector_number(&vector), n);
+  }
+  ck_assert(!nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+}
+END_TEST
+
+START_TEST(auth_vector_cache_expiry_test)
+{
+  eutran_vector_t vectors[3];
+  eutran_vector_t vector;
+  nas_auth_vector_cache_stats_t stats;
+  bool prefetch = false;
+
+  test_vectors(TEST_IMSI64, 1, 2, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 2, false);
+  test_now += 30;
+  test_vectors(TEST_IMSI64, 3, 1, vectors);
+  nas_auth_vector_cache_put(TEST_IMSI64, vectors, 1, false);
+
+  // Only the vector fetched 30 s later is still valid
+  test_now += 40;
+  ck_assert(nas_auth_vector_cache_get(TEST_IMSI64, &vector, &prefetch));
+  ck_assert_int_eq(test_vector_number(&vector), 3);
+
+  // Idle subscribers are reclaimed by the operations on their shard
+  for (imsi64_t imsi64 = 1; imsi64 <= 100; imsi64++) {
+    test_vectors(imsi64, 0, 2, vectors);
+    nas_auth_vector_cache_put(imsi64, vectors, 2, false);
+  }
+  test_now += 60;
+  for (imsi64_t imsi64 = 1000; imsi64 < 3000; imsi64++) {
+    ck_assert(!nas_auth_vector_cache_get(imsi64, &vector, &prefetch));
+  }
+  nas_auth_vector_cache_get_stats(&stats);
+  ck_assert_uint_eq(stats.expired, 202);
+}
+END_TEST
+
+START_TEST(auth_vector_cache_eviction_test)
+{
+  nas_auth_vector_cache_config_t config = test_config;
+  eutran_vector_t vectors[2];
+  eutran_vector_t vector;
+  nas_auth_vector_cache_stats_t stats;
+  bool prefetch = false;
+  int nb_hits = 0;
+
+  nas_auth_vector_cache_exit();
+  config.max_ues = 16;
+  ck_assert_int_eq(nas_auth_vector_cache_init(&config), RETURNok);
+  for (imsi64_t imsi64 = 1; imsi64 <= 200; imsi64++) {
+    test_vectors(imsi64, 0, 2, vectors);
+    nas_auth_vector_cache_put(imsi64, vectors, 2, false);
+  }
+  for (imsi64_t imsi64 = 1; imsi64 <= 200; imsi64++) {
+    nb_hits += nas_auth_vector_cache_get(imsi64, &vector, &prefetch);
+  }
+  ck_assert_int_le(nb_hits, 16);
+  ck_assert_int_gt(nb_hits, 0);
+  nas_auth_vector_cache_get_stats(&stats);
+  ck_assert_uint_eq(stats.evicted, 2 * (200 - nb_hits));
+}
+END_TEST
+
+static void *test_worker(void *arg)
+{
+  imsi64_t first = (imsi64_t)(uintptr_t) arg;
+  eutran_vector_t vectors[3];
+  eutran_vector_t vector;
+  bool prefetch = false;
+
+  for (imsi64_t imsi64 = first; imsi64 < first + TEST_NB_UES_PER_THREAD;
+       imsi64++) {
+    test_vectors(imsi64, 1, 3, vectors);
+    nas_auth_vector_cache_put(imsi64, vectors, 3, false);
+  }
+  for (int round = 1; round <= 3; round++) {
+    for (imsi64_t imsi64 = first; imsi64 < first + TEST_NB_UES_PER_THREAD;
+         imsi64++) {
+      if (
+        (!nas_auth_vector_cache_get(imsi64, &vector, &prefetch)) ||
+        (test_vector_number(&vector) != round) ||
+        memcmp(vector.rand, &imsi64, sizeof(imsi64))) {
+        return (void *) 1;
+      }
+    }
+  }
+  return NULL;
+}
+
+START_TEST(auth_vector_cache_threads_test)
+{
+  nas_auth_vector_cache_config_t config = test_config;
+  pthread_t threads[TEST_NB_THREADS];
+  nas_auth_vector_cache_stats_t stats;
+
+  nas_auth_vector_cache_exit();
+  config.max_ues = TEST_NB_THREADS * TEST_NB_UES_PER_THREAD * 2;
+  ck_assert_int_eq(nas_auth_vector_cache_init(&config), RETURNok);
+  for (int i = 0; i < TEST_NB_THREADS; i++) {
+    uintptr_t first = 1 + i * TEST_NB_UES_PER_THREAD;
+    ck_assert_int_eq(
+      pthread_create(&threads[i], NULL, test_worker, (void *) first), 0);
+  }
+  for (int i = 0; i < TEST_NB_THREADS; i++) {
+    void *failed = NULL;
+    pthread_join(threads[i], &failed);
+    ck_assert_ptr_eq(failed, NULL);
+  }
+  nas_auth_vector_cache_get_stats(&stats);
+  ck_assert_uint_eq(stats.hits, 3 * TEST_NB_THREADS * TEST_NB_UES_PER_THREAD);
+  ck_assert_uint_eq(
+    stats.prefetches, TEST_NB_THREADS * TEST_NB_UES_PER_THREAD);
+}
+END_TEST
+
+Suite *auth_vector_cache_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("Authentication vector cache tests");
+
+  /* Core test case */
+  tc_core = tcase_create("Authentication vector cache test");
+  tcase_add_checked_fixture(tc_core, test_setup, test_teardown);
+  tcase_add_test(tc_core, auth_vector_cache_disabled_test);
+  tcase_add_test(tc_core, auth_vector_cache_fifo_test);
+  tcase_add_test(tc_core, auth_vector_cache_flush_test);
+  tcase_add_test(tc_core, auth_vector_cache_capacity_test);
+  tcase_add_test(tc_core, auth_vector_cache_expiry_test);
+  tcase_add_test(tc_core, auth_vector_cache_eviction_test);
+  tcase_add_test(tc_core, auth_vector_cache_threads_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  /* The cache logs its configuration through the OAI logger */
+  if (
+    OAILOG_INIT("TEST_AUTH_VECTOR_CACHE", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = auth_vector_cache_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,379 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "3gpp_23.003.h"
+#include "3gpp_24.007.h"
+#include "3gpp_24.008.h"
+#include "3gpp_24.301.h"
+#include "3gpp_36.401.h"
+#include "common_types.h"
+#include "dynamic_memory_check.h"
+#include "mme_app_ue_context.h"
+#include "emm_msg.h"
+#include "esm_msg.h"
+#include "TLVDecoder.h"
+
+#define TEST_NAS_DECODE_FUZZ_ITERATIONS 20000
+#define TEST_NAS_DECODE_BENCH_ITERATIONS 200000
+#define TEST_NAS_DECODE_MAX_LENGTH 256
+
+/* PDN Connectivity Request with APN "internet" and a PCO carrying a DNS
+ * server request and PAP credentials */
+static const uint8_t pdn_connectivity_request[] = {
+  0x02, 0x01, 0xd0, 0x11, 0x28, 0x09, 0x08, 0x69, 0x6e, 0x74,
+  0x65, 0x72, 0x6e, 0x65, 0x74, 0x27, 0x0a, 0x80, 0x00, 0x0d,
+  0x00, 0xc0, 0x23, 0x03, 0x01, 0x02, 0x03,
+};
+
+/* Attach Request by IMSI carrying the PDN Connectivity Request above */
+static const uint8_t attach_request[] = {
+  0x07, 0x41, 0x71, 0x08, 0x09, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,
+  0x10, 0x02, 0xe0, 0xe0, 0x00, 0x1b, 0x02, 0x01, 0xd0, 0x11, 0x28,
+  0x09, 0x08, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x6e, 0x65, 0x74, 0x27,
+  0x0a, 0x80, 0x00, 0x0d, 0x00, 0xc0, 0x23, 0x03, 0x01, 0x02, 0x03,
+  0x5c, 0x0a, 0x00,
+};
+
+/* TAU Request by GUTI with last visited TAI, UE network capability and EPS
+ * bearer context status */
+static const uint8_t tau_request[] = {
+  0x07, 0x48, 0x00, 0x0b, 0xf6, 0x00, 0xf1, 0x10, 0x00, 0x01,
+  0x01, 0x01, 0x02, 0x03, 0x04, 0x52, 0x00, 0xf1, 0x10, 0x00,
+  0x01, 0x58, 0x02, 0xe0, 0xe0, 0x57, 0x02, 0x20, 0x00,
+};
+
+typedef int (*test_decode_t)(
+  const uint8_t *pdu,
+  uint32_t length,
+  uint8_t *out,
+  uint32_t *out_length);
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+/* Decode an EMM message then encode it back, the encoding is what is
+ * compared between the two decoding modes */
+static int test_emm_decode(
+  const uint8_t *pdu,
+  uint32_t length,
+  uint8_t *out,
+  uint32_t *out_length)
+{
+  uint8_t buffer[TEST_NAS_DECODE_MAX_LENGTH];
+  EMM_msg msg;
+  int rc = 0;
+
+  memcpy(buffer, pdu, length);
+  memset(&msg, 0, sizeof(msg));
+  rc = emm_msg_decode(&msg, buffer, length);
+  if (rc >= 0 && out) {
+    int encoded = emm_msg_encode(&msg, out, TEST_NAS_DECODE_MAX_LENGTH);
+    *out_length = encoded < 0 ? 0 : encoded;
+  }
+  if (msg.header.message_type == ATTACH_REQUEST) {
+    bdestroy_wrapper(&msg.attach_request.esmmessagecontainer);
+  }
+  return rc;
+}
+
+static int test_esm_decode(
+  const uint8_t *pdu,
+  uint32_t length,
+  uint8_t *out,
+  uint32_t *out_length)
+{
+  uint8_t buffer[TEST_NAS_DECODE_MAX_LENGTH];
+  ESM_msg msg;
+  int rc = 0;
+
+  memcpy(buffer, pdu, length);
+  memset(&msg, 0, sizeof(msg));
+  rc = esm_msg_decode(&msg, buffer, length);
+  if (rc >= 0 && out) {
+    int encoded = esm_msg_encode(&msg, out, TEST_NAS_DECODE_MAX_LENGTH);
+    *out_length = encoded < 0 ? 0 : encoded;
+  }
+  if (msg.header.message_type == PDN_CONNECTIVITY_REQUEST) {
+    bdestroy_wrapper(&msg.pdn_connectivity_request.accesspointname);
+    clear_protocol_configuration_options(
+      &msg.pdn_connectivity_request.protocolconfigurationoptions);
+  }
+  return rc;
+}
+
+/* Run the decoder with and without arena, both must give the same result.
+ * Run under AddressSanitizer, this also checks that malformed input is
+ * rejected without reading past the PDU. */
+static int test_compare(
+  test_decode_t decode,
+  const uint8_t *pdu,
+  uint32_t length)
+{
+  uint8_t heap_out[TEST_NAS_DECODE_MAX_LENGTH];
+  uint8_t arena_out[TEST_NAS_DECODE_MAX_LENGTH];
+  uint32_t heap_length = 0;
+  uint32_t arena_length = 0;
+  tlv_decode_arena_t arena;
+  int heap_rc = 0;
+  int arena_rc = 0;
+
+  heap_rc = decode(pdu, length, heap_out, &heap_length);
+  tlv_decode_arena_begin(&arena);
+  arena_rc = decode(pdu, length, arena_out, &arena_length);
+  tlv_decode_arena_end(&arena);
+
+  ck_assert_int_eq(heap_rc, arena_rc);
+  if (heap_rc >= 0) {
+    ck_assert_uint_eq(heap_length, arena_length);
+    ck_assert(!memcmp(heap_out, arena_out, heap_length));
+  }
+  return heap_rc;
+}
+
+static void test_fuzz(
+  test_decode_t decode,
+  const uint8_t *seed,
+  uint32_t seed_length,
+  uint32_t first_mutable)
+{
+  uint8_t pdu[TEST_NAS_DECODE_MAX_LENGTH];
+
+  srand(seed_length);
+  for (int i = 0; i < TEST_NAS_DECODE_FUZZ_ITERATIONS; i++) {
+    uint32_t length = seed_length;
+    int nb_mutations = 1 + rand() % 4;
+
+    memcpy(pdu, seed, seed_length);
+    for (int m = 0; m < nb_mutations; m++) {
+      uint32_t pos = first_mutable + rand() % (seed_length - first_mutable);
+      pdu[pos] ^= (uint8_t)(1 + rand() % 255);
+    }
+    if (!(rand() % 4)) {
+      length = first_mutable + rand() % (seed_length - first_mutable + 1);
+    }
+    test_compare(decode, pdu, length);
+  }
+}
+
+static void test_bench(
+  const char *name,
+  test_decode_t decode,
+  const uint8_t *pdu,
+  uint32_t length)
+{
+  tlv_decode_arena_t arena;
+  uint64_t start = 0;
+  uint64_t heap_usec = 0;
+  uint64_t arena_usec = 0;
+
+  start = test_now_usec();
+  for (int i = 0; i < TEST_NAS_DECODE_BENCH_ITERATIONS; i++) {
+    decode(pdu, length, NULL, NULL);
+  }
+  heap_usec = test_now_usec() - start + 1;
+
+  start = test_now_usec();
+  for (int i = 0; i < TEST_NAS_DECODE_BENCH_ITERATIONS; i++) {
+    tlv_decode_arena_begin(&arena);
+    decode(pdu, length, NULL, NULL);
+    tlv_decode_arena_end(&arena);
+  }
+  arena_usec = test_now_usec() - start + 1;
+
+  printf(
+    "%-26s heap %9.0f decodes/s, arena %9.0f decodes/s\n",
+    name,
+    TEST_NAS_DECODE_BENCH_ITERATIONS * 1e6 / heap_usec,
+    TEST_NAS_DECODE_BENCH_ITERATIONS * 1e6 / arena_usec);
+}
+
+START_TEST(nas_decode_arena_view_test)
+{
+  uint8_t buffer[sizeof(attach_request)];
+  tlv_decode_arena_t arena;
+  EMM_msg msg;
+  bstring esm = NULL;
+
+  memcpy(buffer, attach_request, sizeof(buffer));
+  memset(&msg, 0, sizeof(msg));
+  tlv_decode_arena_begin(&arena);
+  ck_assert_int_gt(emm_msg_decode(&msg, buffer, sizeof(buffer)), 0);
+  tlv_decode_arena_end(&arena);
+
+  /* The ESM container points into the PDU */
+  ck_assert_int_eq(arena.nb_views, 1);
+  ck_assert_ptr_eq(msg.attach_request.esmmessagecontainer, &arena.views[0]);
+  ck_assert_ptr_eq(
+    msg.attach_request.esmmessagecontainer->data, &buffer[17]);
+  ck_assert_int_eq(blength(msg.attach_request.esmmessagecontainer), 27);
+
+  /* A view kept beyond the PDU is copied, bdestroy leaves views alone */
+  esm = tlv_decode_bstring_own(msg.attach_request.esmmessagecontainer);
+  ck_assert_ptr_ne(esm, msg.attach_request.esmmessagecontainer);
+  ck_assert(biseq(esm, msg.attach_request.esmmessagecontainer) == 1);
+  ck_assert_int_eq(bdestroy(msg.attach_request.esmmessagecontainer), BSTR_ERR);
+  ck_assert_ptr_eq(tlv_decode_bstring_own(esm), esm);
+  bdestroy(esm);
+
+  /* Without arena the decoder allocates again */
+  memset(&msg, 0, sizeof(msg));
+  ck_assert_int_gt(emm_msg_decode(&msg, buffer, sizeof(buffer)), 0);
+  ck_assert(msg.attach_request.esmmessagecontainer->mlen > 0);
+  bdestroy(msg.attach_request.esmmessagecontainer);
+}
+END_TEST
+
+START_TEST(nas_decode_arena_overflow_test)
+{
+  tlv_decode_arena_t arena;
+  bstring bstrs[TLV_DECODE_ARENA_MAX_VIEWS + 2];
+  const uint8_t data[] = {0x01, 0x02, 0x03};
+
+  tlv_decode_arena_begin(&arena);
+  for (int i = 0; i <= TLV_DECODE_ARENA_MAX_VIEWS; i++) {
+    ck_assert_int_eq(decode_bstring(&bstrs[i], 3, data, sizeof(data)), 3);
+  }
+
+  /* Once out of views, the arena falls back on heap copies */
+  ck_assert(bstrs[TLV_DECODE_ARENA_MAX_VIEWS - 1]->mlen < 0);
+  ck_assert(bstrs[TLV_DECODE_ARENA_MAX_VIEWS]->mlen > 0);
+  ck_assert_int_eq(bdestroy(bstrs[TLV_DECODE_ARENA_MAX_VIEWS]), BSTR_OK);
+
+  /* Blocks are handed out until the buffer is full */
+  ck_assert_ptr_eq(tlv_decode_arena_alloc(1000), arena.buffer);
+  ck_assert_ptr_eq(tlv_decode_arena_alloc(24), &arena.buffer[1000]);
+  ck_assert_uint_eq(arena.used, TLV_DECODE_ARENA_SIZE);
+
+  /* Then the arena is removed, the caller deciphers into the heap and
+   * the IEs decoded from it must be heap copies too */
+  ck_assert_ptr_eq(tlv_decode_arena_alloc(1), NULL);
+  arena.nb_views = 0;
+  ck_assert_int_eq(
+    decode_bstring(
+      &bstrs[TLV_DECODE_ARENA_MAX_VIEWS + 1], 3, data, sizeof(data)),
+    3);
+  ck_assert(bstrs[TLV_DECODE_ARENA_MAX_VIEWS + 1]->mlen > 0);
+  ck_assert_int_eq(bdestroy(bstrs[TLV_DECODE_ARENA_MAX_VIEWS + 1]), BSTR_OK);
+  tlv_decode_arena_end(&arena);
+
+  /* Without arena there is nothing to allocate from */
+  ck_assert_ptr_eq(tlv_decode_arena_alloc(1), NULL);
+}
+END_TEST
+
+START_TEST(nas_decode_regression_test)
+{
+  ck_assert_int_gt(
+    test_compare(test_emm_decode, attach_request, sizeof(attach_request)), 0);
+  ck_assert_int_gt(
+    test_compare(test_emm_decode, tau_request, sizeof(tau_request)), 0);
+  ck_assert_int_gt(
+    test_compare(
+      test_esm_decode,
+      pdn_connectivity_request,
+      sizeof(pdn_connectivity_request)),
+    0);
+}
+END_TEST
+
+START_TEST(nas_decode_fuzz_test)
+{
+  /* The message headers are kept, so that the mutated messages reach the
+   * IE decoders */
+  test_fuzz(test_emm_decode, attach_request, sizeof(attach_request), 2);
+  test_fuzz(test_emm_decode, tau_request, sizeof(tau_request), 2);
+  test_fuzz(
+    test_esm_decode,
+    pdn_connectivity_request,
+    sizeof(pdn_connectivity_request),
+    15);
+}
+END_TEST
+
+START_TEST(nas_decode_benchmark_test)
+{
+  test_bench(
+    "Attach Request", test_emm_decode, attach_request, sizeof(attach_request));
+  test_bench(
+    "PDN Connectivity Request",
+    test_esm_decode,
+    pdn_connectivity_request,
+    sizeof(pdn_connectivity_request));
+  test_bench("TAU Request", test_emm_decode, tau_request, sizeof(tau_request));
+}
+END_TEST
+
+Suite *nas_decode_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("NAS decode fuzz tests");
+
+  /* Core test case */
+  tc_core = tcase_create("NAS decode fuzz test");
+  tcase_add_test(tc_core, nas_decode_arena_view_test);
+  tcase_add_test(tc_core, nas_decode_arena_overflow_test);
+  tcase_add_test(tc_core, nas_decode_regression_test);
+  tcase_add_test(tc_core, nas_decode_fuzz_test);
+  tcase_add_test(tc_core, nas_decode_benchmark_test);
+  tcase_set_timeout(tc_core, 60);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  /* The NAS decoders log through the OAI logger */
+  if (
+    OAILOG_INIT("TEST_NAS_DECODE", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = nas_decode_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
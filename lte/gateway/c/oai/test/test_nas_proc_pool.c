@@ -0,0 +1,390 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nas_proc_pool.h"
+#include "nas_puid_index.h"
+
+#define TEST_NAS_PROC_POOL_NB_UES 1000
+#define TEST_NAS_PROC_POOL_NB_ROUNDS 10
+
+/* Stand-ins for the NAS procedure types, only the sizes matter here */
+typedef struct test_proc_s {
+  uint64_t puid;
+  uint8_t body[248];
+} test_proc_t;
+
+typedef struct test_wrapper_s {
+  void *proc;
+  void *next;
+  void **prev;
+} test_wrapper_t;
+
+/* The objects a full attach goes through, as in nas_procedures.c */
+typedef struct test_attach_s {
+  void *emm_procedures;
+  void *attach_proc;
+  void *auth_info_proc;
+  void *cn_wrapper;
+  void *auth_proc;
+  void *auth_wrapper;
+  void *smc_proc;
+  void *smc_wrapper;
+} test_attach_t;
+
+static nas_proc_pool_t emm_procedures_pool =
+  NAS_PROC_POOL_INITIALIZER("emm_procedures", test_proc_t);
+static nas_proc_pool_t attach_pool =
+  NAS_PROC_POOL_INITIALIZER("attach", test_proc_t);
+static nas_proc_pool_t auth_info_pool =
+  NAS_PROC_POOL_INITIALIZER("auth_info", test_proc_t);
+static nas_proc_pool_t auth_pool =
+  NAS_PROC_POOL_INITIALIZER("authentication", test_proc_t);
+static nas_proc_pool_t smc_pool = NAS_PROC_POOL_INITIALIZER("smc", test_proc_t);
+static nas_proc_pool_t wrapper_pool =
+  NAS_PROC_POOL_INITIALIZER("wrapper", test_wrapper_t);
+
+static nas_proc_pool_t *attach_pools[] = {
+  &emm_procedures_pool,
+  &attach_pool,
+  &auth_info_pool,
+  &auth_pool,
+  &smc_pool,
+  &wrapper_pool,
+};
+
+#define TEST_NB_ATTACH_POOLS (sizeof(attach_pools) / sizeof(attach_pools[0]))
+
+static uint64_t attach_pools_allocs(void)
+{
+  uint64_t allocs = 0;
+
+  for (int i = 0; i < TEST_NB_ATTACH_POOLS; i++) {
+    allocs += attach_pools[i]->nb_allocs;
+  }
+  return allocs;
+}
+
+static uint64_t attach_pools_heap_allocs(void)
+{
+  uint64_t allocs = 0;
+
+  for (int i = 0; i < TEST_NB_ATTACH_POOLS; i++) {
+    allocs += attach_pools[i]->nb_heap_allocs;
+  }
+  return allocs;
+}
+
+/* Attach request up to SMC: the CN and common procedures are deleted as
+ * soon as they complete, the attach procedure lives until attach complete */
+static void test_attach_start(test_attach_t *ue)
+{
+  ue->emm_procedures = nas_proc_pool_alloc(&emm_procedures_pool);
+  ue->attach_proc = nas_proc_pool_alloc(&attach_pool);
+  ue->auth_info_proc = nas_proc_pool_alloc(&auth_info_pool);
+  ue->cn_wrapper = nas_proc_pool_alloc(&wrapper_pool);
+  nas_proc_pool_release(&ue->auth_info_proc);
+  nas_proc_pool_release(&ue->cn_wrapper);
+  ue->auth_proc = nas_proc_pool_alloc(&auth_pool);
+  ue->auth_wrapper = nas_proc_pool_alloc(&wrapper_pool);
+  nas_proc_pool_release(&ue->auth_proc);
+  nas_proc_pool_release(&ue->auth_wrapper);
+  ue->smc_proc = nas_proc_pool_alloc(&smc_pool);
+  ue->smc_wrapper = nas_proc_pool_alloc(&wrapper_pool);
+}
+
+static void test_attach_complete(test_attach_t *ue)
+{
+  nas_proc_pool_release(&ue->smc_proc);
+  nas_proc_pool_release(&ue->smc_wrapper);
+  nas_proc_pool_release(&ue->attach_proc);
+  nas_proc_pool_release(&ue->emm_procedures);
+}
+
+START_TEST(nas_proc_pool_reuse_test)
+{
+  nas_proc_pool_t pool = NAS_PROC_POOL_INITIALIZER("reuse", test_proc_t);
+  test_proc_t *proc = nas_proc_pool_alloc(&pool);
+  void *first = proc;
+
+  ck_assert_ptr_ne(proc, NULL);
+  memset(proc, 0xA5, sizeof(*proc));
+  nas_proc_pool_release((void **) &proc);
+  ck_assert_ptr_eq(proc, NULL);
+  ck_assert_uint_eq(pool.nb_free, 1);
+  ck_assert_uint_eq(pool.nb_in_use, 0);
+
+  /* The released object comes back zeroed */
+  proc = nas_proc_pool_alloc(&pool);
+  ck_assert_ptr_eq(proc, first);
+  ck_assert_uint_eq(proc->puid, 0);
+  ck_assert_uint_eq(proc->body[sizeof(proc->body) - 1], 0);
+  ck_assert_uint_eq(pool.nb_heap_allocs, 1);
+  ck_assert_uint_eq(pool.nb_allocs, 2);
+
+  /* NULL is ignored, as by free_wrapper */
+  nas_proc_pool_release(NULL);
+  nas_proc_pool_release((void **) &proc);
+  nas_proc_pool_release((void **) &proc);
+  ck_assert_uint_eq(pool.nb_free, 1);
+
+  nas_proc_pool_trim(&pool);
+  ck_assert_uint_eq(pool.nb_free, 0);
+}
+END_TEST
+
+START_TEST(nas_proc_pool_max_free_test)
+{
+  nas_proc_pool_t pool = NAS_PROC_POOL_INITIALIZER("max_free", test_proc_t);
+  void *procs[16];
+
+  pool.max_free = 4;
+  for (int i = 0; i < 16; i++) {
+    procs[i] = nas_proc_pool_alloc(&pool);
+  }
+  for (int i = 0; i < 16; i++) {
+    nas_proc_pool_release(&procs[i]);
+  }
+  /* Objects above the cap went back to the heap */
+  ck_assert_uint_eq(pool.nb_free, 4);
+  ck_assert_uint_eq(pool.nb_in_use, 0);
+  nas_proc_pool_trim(&pool);
+}
+END_TEST
+
+/* Allocation count of an attach storm: after the first round, every
+ * procedure object comes from the pools and none from the heap */
+START_TEST(nas_proc_pool_attach_storm_test)
+{
+  test_attach_t *ues = calloc(TEST_NAS_PROC_POOL_NB_UES, sizeof(*ues));
+  uint64_t warm_heap_allocs = 0;
+  uint64_t allocs = 0;
+
+  ck_assert_ptr_ne(ues, NULL);
+  for (int round = 0; round < TEST_NAS_PROC_POOL_NB_ROUNDS; round++) {
+    for (int i = 0; i < TEST_NAS_PROC_POOL_NB_UES; i++) {
+      test_attach_start(&ues[i]);
+    }
+    for (int i = 0; i < TEST_NAS_PROC_POOL_NB_UES; i++) {
+      test_attach_complete(&ues[i]);
+    }
+    if (!round) {
+      warm_heap_allocs = attach_pools_heap_allocs();
+    }
+  }
+  allocs = attach_pools_allocs();
+
+  printf(
+    "%d attaches: %" PRIu64 " procedure allocations, %" PRIu64
+    " from the heap, %.2f per attach in steady state\n",
+    TEST_NAS_PROC_POOL_NB_UES * TEST_NAS_PROC_POOL_NB_ROUNDS,
+    allocs,
+    attach_pools_heap_allocs(),
+    (double) (attach_pools_heap_allocs() - warm_heap_allocs) /
+      (TEST_NAS_PROC_POOL_NB_UES * (TEST_NAS_PROC_POOL_NB_ROUNDS - 1)));
+
+  ck_assert_uint_eq(
+    allocs, 8 * TEST_NAS_PROC_POOL_NB_UES * TEST_NAS_PROC_POOL_NB_ROUNDS);
+  /* Common procedures are recycled within an attach, so the first round
+   * needs fewer than 8 heap allocations per UE */
+  ck_assert_uint_le(warm_heap_allocs, 8 * TEST_NAS_PROC_POOL_NB_UES);
+  ck_assert_uint_eq(attach_pools_heap_allocs(), warm_heap_allocs);
+
+  for (int i = 0; i < TEST_NB_ATTACH_POOLS; i++) {
+    ck_assert_uint_eq(attach_pools[i]->nb_in_use, 0);
+    nas_proc_pool_trim(attach_pools[i]);
+  }
+  free(ues);
+}
+END_TEST
+
+/* Any distinct addresses do as procedures for the index */
+static test_proc_t index_procs[4 * NAS_EMM_PUID_INDEX_SIZE + 1];
+
+#define TEST_PROC(i) ((struct nas_emm_proc_s *) &index_procs[i])
+
+START_TEST(nas_puid_index_add_get_remove_test)
+{
+  nas_emm_puid_entry_t index[NAS_EMM_PUID_INDEX_SIZE] = {{0}};
+
+  ck_assert(nas_puid_index_add(index, 1, TEST_PROC(1)));
+  ck_assert(nas_puid_index_add(index, 2, TEST_PROC(2)));
+  ck_assert(nas_puid_index_add(index, 3, TEST_PROC(3)));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1), TEST_PROC(1));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 2), TEST_PROC(2));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 3), TEST_PROC(3));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 4), NULL);
+
+  nas_puid_index_remove(index, 2);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 2), NULL);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1), TEST_PROC(1));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 3), TEST_PROC(3));
+
+  /* Removing an unknown UID changes nothing */
+  nas_puid_index_remove(index, 2);
+  nas_puid_index_remove(index, 42);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1), TEST_PROC(1));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 3), TEST_PROC(3));
+}
+END_TEST
+
+START_TEST(nas_puid_index_collision_test)
+{
+  const uint64_t size = NAS_EMM_PUID_INDEX_SIZE;
+  nas_emm_puid_entry_t index[NAS_EMM_PUID_INDEX_SIZE] = {{0}};
+
+  /* 1, 1 + size and 1 + 2 * size share their home slot, 2 is pushed out of
+   * its own one */
+  ck_assert(nas_puid_index_add(index, 1, TEST_PROC(0)));
+  ck_assert(nas_puid_index_add(index, 1 + size, TEST_PROC(1)));
+  ck_assert(nas_puid_index_add(index, 1 + 2 * size, TEST_PROC(2)));
+  ck_assert(nas_puid_index_add(index, 2, TEST_PROC(3)));
+  ck_assert_uint_eq(index[4].puid, 2);
+
+  /* Removing the head of the chain shifts every follower back */
+  nas_puid_index_remove(index, 1);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1), NULL);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1 + size), TEST_PROC(1));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1 + 2 * size), TEST_PROC(2));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 2), TEST_PROC(3));
+  ck_assert_uint_eq(index[1].puid, 1 + size);
+  ck_assert_uint_eq(index[2].puid, 1 + 2 * size);
+  ck_assert_uint_eq(index[3].puid, 2);
+  ck_assert_uint_eq(index[4].puid, 0);
+
+  /* A follower moves back to its home slot */
+  nas_puid_index_remove(index, 1 + 2 * size);
+  ck_assert_uint_eq(index[2].puid, 2);
+  ck_assert_uint_eq(index[3].puid, 0);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 2), TEST_PROC(3));
+
+  /* Probe sequences wrap around the end of the index */
+  ck_assert(nas_puid_index_add(index, size - 1, TEST_PROC(4)));
+  ck_assert(nas_puid_index_add(index, 2 * size - 1, TEST_PROC(5)));
+  ck_assert_uint_eq(index[0].puid, 2 * size - 1);
+  nas_puid_index_remove(index, size - 1);
+  ck_assert_uint_eq(index[size - 1].puid, 2 * size - 1);
+  ck_assert_ptr_eq(nas_puid_index_get(index, 2 * size - 1), TEST_PROC(5));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 1 + size), TEST_PROC(1));
+}
+END_TEST
+
+START_TEST(nas_puid_index_full_test)
+{
+  nas_emm_puid_entry_t index[NAS_EMM_PUID_INDEX_SIZE] = {{0}};
+
+  for (int i = 0; i < NAS_EMM_PUID_INDEX_SIZE; i++) {
+    ck_assert(nas_puid_index_add(index, 3 + i * 5, TEST_PROC(i)));
+  }
+  ck_assert(!nas_puid_index_add(index, 100, TEST_PROC(8)));
+  /* A full index is searched to its end */
+  ck_assert_ptr_eq(nas_puid_index_get(index, 100), NULL);
+  for (int i = 0; i < NAS_EMM_PUID_INDEX_SIZE; i++) {
+    ck_assert_ptr_eq(nas_puid_index_get(index, 3 + i * 5), TEST_PROC(i));
+  }
+
+  nas_puid_index_remove(index, 3 + 2 * 5);
+  ck_assert(nas_puid_index_add(index, 100, TEST_PROC(8)));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 100), TEST_PROC(8));
+  ck_assert_ptr_eq(nas_puid_index_get(index, 3 + 2 * 5), NULL);
+}
+END_TEST
+
+/* Random adds and removes, checked against a plain list of the indexed
+ * UIDs, with UIDs drawn from a small range to force collisions */
+START_TEST(nas_puid_index_random_test)
+{
+  nas_emm_puid_entry_t index[NAS_EMM_PUID_INDEX_SIZE] = {{0}};
+  uint64_t indexed[NAS_EMM_PUID_INDEX_SIZE] = {0};
+  int nb_indexed = 0;
+  unsigned int seed = 1;
+
+  for (int round = 0; round < 100000; round++) {
+    uint64_t puid = 1 + (rand_r(&seed) % (4 * NAS_EMM_PUID_INDEX_SIZE));
+    int found = -1;
+
+    for (int i = 0; i < nb_indexed; i++) {
+      if (indexed[i] == puid) {
+        found = i;
+      }
+    }
+    if (found >= 0) {
+      nas_puid_index_remove(index, puid);
+      indexed[found] = indexed[--nb_indexed];
+    } else if (nb_indexed < NAS_EMM_PUID_INDEX_SIZE) {
+      ck_assert(nas_puid_index_add(index, puid, TEST_PROC(puid)));
+      indexed[nb_indexed++] = puid;
+    }
+    for (uint64_t p = 1; p <= 4 * NAS_EMM_PUID_INDEX_SIZE; p++) {
+      bool expected = false;
+
+      for (int i = 0; i < nb_indexed; i++) {
+        expected |= (indexed[i] == p);
+      }
+      ck_assert_ptr_eq(
+        nas_puid_index_get(index, p), expected ? TEST_PROC(p) : NULL);
+    }
+  }
+}
+END_TEST
+
+Suite *nas_proc_pool_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("NAS procedure pool tests");
+
+  /* Core test case */
+  tc_core = tcase_create("NAS procedure pool test");
+  tcase_add_test(tc_core, nas_proc_pool_reuse_test);
+  tcase_add_test(tc_core, nas_proc_pool_max_free_test);
+  tcase_add_test(tc_core, nas_proc_pool_attach_storm_test);
+  tcase_add_test(tc_core, nas_puid_index_add_get_remove_test);
+  tcase_add_test(tc_core, nas_puid_index_collision_test);
+  tcase_add_test(tc_core, nas_puid_index_full_test);
+  tcase_add_test(tc_core, nas_puid_index_random_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = nas_proc_pool_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,428 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "conversions.h"
+#include "intertask_interface_types.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_decoder.h"
+#include "s1ap_mme_fast_decoder.h"
+
+#define TEST_S1AP_FAST_FUZZ_ITERATIONS 20000
+#define TEST_S1AP_FAST_BENCH_ITERATIONS 200000
+#define TEST_S1AP_FAST_NAS_MAX_LENGTH 300
+
+typedef int (*test_s1ap_decode_t)(
+  s1ap_message *message,
+  const_bstring const raw,
+  MessagesIds *message_id);
+
+typedef struct test_s1ap_ue_s {
+  uint32_t mme_ue_s1ap_id;
+  uint32_t enb_ue_s1ap_id;
+  uint32_t nas_length;
+  long rrc_establishment_cause;
+  bool s_tmsi;
+} test_s1ap_ue_t;
+
+static const test_s1ap_ue_t test_ues[] = {
+  {0, 0, 0, 0, false},
+  {1, 1, 18, 1, false},
+  {255, 255, 127, 2, false},
+  {256, 256, 128, 3, false},
+  {65536, 0x00ffffff, 300, 4, false},
+  {0xffffffff, 0x00123456, 42, 3, false},
+};
+
+static const uint8_t test_plmn[] = {0x09, 0xf1, 0x07};
+static const uint8_t test_tac[] = {0x00, 0x01};
+static const uint8_t test_cell_id[] = {0x00, 0x0b, 0xc6, 0x10};
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void test_nas(uint8_t *nas, uint32_t length)
+{
+  for (uint32_t i = 0; i < length; i++) {
+    nas[i] = (uint8_t)(i * 7 + 0x17);
+  }
+}
+
+static void test_tai_ecgi_fill(S1ap_TAI_t *tai, S1ap_EUTRAN_CGI_t *ecgi)
+{
+  OCTET_STRING_fromBuf(
+    &tai->pLMNidentity, (const char *) test_plmn, sizeof(test_plmn));
+  OCTET_STRING_fromBuf(&tai->tAC, (const char *) test_tac, sizeof(test_tac));
+  OCTET_STRING_fromBuf(
+    &ecgi->pLMNidentity, (const char *) test_plmn, sizeof(test_plmn));
+  OCTET_STRING_fromBuf(
+    &ecgi->cell_ID, (const char *) test_cell_id, sizeof(test_cell_id));
+  ecgi->cell_ID.bits_unused = 4;
+}
+
+/* PDUs are encoded with asn1c, the reference of the fast path */
+static bstring test_uplink_nas_transport(const test_s1ap_ue_t *ue)
+{
+  S1ap_UplinkNASTransport_t uplink_nas_transport;
+  S1ap_UplinkNASTransportIEs_t ies;
+  uint8_t nas[TEST_S1AP_FAST_NAS_MAX_LENGTH];
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+  bstring raw = NULL;
+
+  memset(&uplink_nas_transport, 0, sizeof(uplink_nas_transport));
+  memset(&ies, 0, sizeof(ies));
+  test_nas(nas, ue->nas_length);
+  ies.mme_ue_s1ap_id = ue->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue->enb_ue_s1ap_id;
+  OCTET_STRING_fromBuf(&ies.nas_pdu, (const char *) nas, ue->nas_length);
+  test_tai_ecgi_fill(&ies.tai, &ies.eutran_cgi);
+
+  if (
+    (s1ap_encode_s1ap_uplinknastransporties(&uplink_nas_transport, &ies) >=
+     0) &&
+    (s1ap_generate_initiating_message(
+       &buffer,
+       &length,
+       S1ap_ProcedureCode_id_uplinkNASTransport,
+       S1ap_Criticality_ignore,
+       &asn_DEF_S1ap_UplinkNASTransport,
+       &uplink_nas_transport) > 0)) {
+    raw = blk2bstr(buffer, length);
+    free(buffer);
+  }
+  free_s1ap_uplinknastransport(&ies);
+  return raw;
+}
+
+static bstring test_initial_ue_message(const test_s1ap_ue_t *ue)
+{
+  S1ap_InitialUEMessage_t initial_ue_message;
+  S1ap_InitialUEMessageIEs_t ies;
+  uint8_t nas[TEST_S1AP_FAST_NAS_MAX_LENGTH];
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+  bstring raw = NULL;
+
+  memset(&initial_ue_message, 0, sizeof(initial_ue_message));
+  memset(&ies, 0, sizeof(ies));
+  test_nas(nas, ue->nas_length);
+  ies.eNB_UE_S1AP_ID = ue->enb_ue_s1ap_id;
+  OCTET_STRING_fromBuf(&ies.nas_pdu, (const char *) nas, ue->nas_length);
+  test_tai_ecgi_fill(&ies.tai, &ies.eutran_cgi);
+  ies.rrC_Establishment_Cause = ue->rrc_establishment_cause;
+  if (ue->s_tmsi) {
+    ies.presenceMask |= S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT;
+    INT8_TO_OCTET_STRING(0x01, &ies.s_tmsi.mMEC);
+    M_TMSI_TO_OCTET_STRING(0xc0000123, &ies.s_tmsi.m_TMSI);
+  }
+
+  if (
+    (s1ap_encode_s1ap_initialuemessageies(&initial_ue_message, &ies) >= 0) &&
+    (s1ap_generate_initiating_message(
+       &buffer,
+       &length,
+       S1ap_ProcedureCode_id_initialUEMessage,
+       S1ap_Criticality_ignore,
+       &asn_DEF_S1ap_InitialUEMessage,
+       &initial_ue_message) > 0)) {
+    raw = blk2bstr(buffer, length);
+    free(buffer);
+  }
+  free_s1ap_initialuemessage(&ies);
+  return raw;
+}
+
+static void test_octet_string_eq(
+  const OCTET_STRING_t *fast,
+  const OCTET_STRING_t *asn1c)
+{
+  ck_assert_int_eq(fast->size, asn1c->size);
+  ck_assert(!memcmp(fast->buf, asn1c->buf, fast->size));
+}
+
+static void test_tai_ecgi_eq(
+  const S1ap_TAI_t *fast_tai,
+  const S1ap_EUTRAN_CGI_t *fast_ecgi,
+  const S1ap_TAI_t *asn1c_tai,
+  const S1ap_EUTRAN_CGI_t *asn1c_ecgi)
+{
+  test_octet_string_eq(&fast_tai->pLMNidentity, &asn1c_tai->pLMNidentity);
+  test_octet_string_eq(&fast_tai->tAC, &asn1c_tai->tAC);
+  test_octet_string_eq(&fast_ecgi->pLMNidentity, &asn1c_ecgi->pLMNidentity);
+  test_octet_string_eq(
+    (const OCTET_STRING_t *) &fast_ecgi->cell_ID,
+    (const OCTET_STRING_t *) &asn1c_ecgi->cell_ID);
+  ck_assert_int_eq(fast_ecgi->cell_ID.bits_unused, asn1c_ecgi->cell_ID.bits_unused);
+}
+
+/* Decode with both decoders, when the fast path takes the PDU, asn1c must
+ * decode it to the same IEs. Returns whether the fast path took it. */
+static bool test_compare(const_bstring const raw)
+{
+  s1ap_message fast = {0};
+  s1ap_message asn1c = {0};
+  MessagesIds fast_id = MESSAGES_ID_MAX;
+  MessagesIds asn1c_id = MESSAGES_ID_MAX;
+  int asn1c_rc = 0;
+
+  if (s1ap_mme_fast_decode_pdu(&fast, raw, &fast_id) != RETURNok) {
+    return false;
+  }
+  ck_assert(fast.fast_decoded);
+
+  asn1c_rc = s1ap_mme_asn1c_decode_pdu(&asn1c, raw, &asn1c_id);
+  ck_assert_int_ge(asn1c_rc, 0);
+  ck_assert_int_eq(fast_id, asn1c_id);
+  ck_assert_int_eq(fast.procedureCode, asn1c.procedureCode);
+  ck_assert_int_eq(fast.criticality, asn1c.criticality);
+  ck_assert_int_eq(fast.direction, asn1c.direction);
+
+  if (fast_id == S1AP_UPLINK_NAS_LOG) {
+    S1ap_UplinkNASTransportIEs_t *f = &fast.msg.s1ap_UplinkNASTransportIEs;
+    S1ap_UplinkNASTransportIEs_t *a = &asn1c.msg.s1ap_UplinkNASTransportIEs;
+
+    ck_assert_int_eq(f->presenceMask, a->presenceMask);
+    ck_assert_uint_eq(f->mme_ue_s1ap_id, a->mme_ue_s1ap_id);
+    ck_assert_uint_eq(f->eNB_UE_S1AP_ID, a->eNB_UE_S1AP_ID);
+    test_octet_string_eq(&f->nas_pdu, &a->nas_pdu);
+    test_tai_ecgi_eq(&f->tai, &f->eutran_cgi, &a->tai, &a->eutran_cgi);
+  } else {
+    S1ap_InitialUEMessageIEs_t *f = &fast.msg.s1ap_InitialUEMessageIEs;
+    S1ap_InitialUEMessageIEs_t *a = &asn1c.msg.s1ap_InitialUEMessageIEs;
+
+    ck_assert_int_eq(fast_id, S1AP_INITIAL_UE_MESSAGE_LOG);
+    ck_assert_int_eq(f->presenceMask, a->presenceMask);
+    ck_assert_uint_eq(f->eNB_UE_S1AP_ID, a->eNB_UE_S1AP_ID);
+    test_octet_string_eq(&f->nas_pdu, &a->nas_pdu);
+    test_tai_ecgi_eq(&f->tai, &f->eutran_cgi, &a->tai, &a->eutran_cgi);
+    ck_assert_int_eq(f->rrC_Establishment_Cause, a->rrC_Establishment_Cause);
+  }
+
+  /* Nothing was allocated by the fast path */
+  ck_assert_int_eq(s1ap_free_mme_decode_pdu(&fast, fast_id), RETURNok);
+  s1ap_free_mme_decode_pdu(&asn1c, asn1c_id);
+  return true;
+}
+
+static void test_fuzz(const_bstring const seed)
+{
+  uint8_t pdu[TEST_S1AP_FAST_NAS_MAX_LENGTH + 64];
+  uint32_t seed_length = blength(seed);
+  uint32_t nb_fast = 0;
+
+  ck_assert_uint_le(seed_length, sizeof(pdu));
+  srand(seed_length);
+  for (int i = 0; i < TEST_S1AP_FAST_FUZZ_ITERATIONS; i++) {
+    struct tagbstring raw;
+    uint32_t length = seed_length;
+    int nb_mutations = 1 + rand() % 3;
+
+    memcpy(pdu, bdata(seed), seed_length);
+    for (int m = 0; m < nb_mutations; m++) {
+      pdu[rand() % seed_length] ^= (uint8_t)(1 << (rand() % 8));
+    }
+    if (!(rand() % 4)) {
+      length = rand() % (seed_length + 1);
+    }
+    btfromblk(raw, pdu, length);
+    nb_fast += test_compare(&raw);
+  }
+  /* Most of the single bit flips land in the NAS-PDU */
+  ck_assert_uint_gt(nb_fast, 0);
+}
+
+static void test_bench(const char *name, const_bstring const raw)
+{
+  const test_s1ap_decode_t decoders[] = {s1ap_mme_asn1c_decode_pdu,
+                                         s1ap_mme_fast_decode_pdu};
+  double rates[2] = {0};
+
+  for (int d = 0; d < 2; d++) {
+    uint64_t start = test_now_usec();
+
+    for (int i = 0; i < TEST_S1AP_FAST_BENCH_ITERATIONS; i++) {
+      s1ap_message message = {0};
+      MessagesIds message_id = MESSAGES_ID_MAX;
+
+      if (decoders[d](&message, raw, &message_id) >= 0) {
+        s1ap_free_mme_decode_pdu(&message, message_id);
+      }
+    }
+    rates[d] =
+      TEST_S1AP_FAST_BENCH_ITERATIONS * 1e6 / (test_now_usec() - start + 1);
+  }
+  printf(
+    "%-22s asn1c %9.0f decodes/s, fast path %9.0f decodes/s\n",
+    name,
+    rates[0],
+    rates[1]);
+}
+
+START_TEST(s1ap_fast_decoder_uplink_nas_transport_test)
+{
+  for (int i = 0; i < sizeof(test_ues) / sizeof(test_ues[0]); i++) {
+    bstring raw = test_uplink_nas_transport(&test_ues[i]);
+    s1ap_message message = {0};
+    MessagesIds message_id = MESSAGES_ID_MAX;
+
+    ck_assert_ptr_ne(raw, NULL);
+    ck_assert(test_compare(raw));
+
+    /* The NAS-PDU is a view into the received buffer */
+    ck_assert_int_eq(
+      s1ap_mme_decode_pdu(&message, raw, &message_id), RETURNok);
+    ck_assert(message.fast_decoded);
+    ck_assert_uint_eq(
+      message.msg.s1ap_UplinkNASTransportIEs.mme_ue_s1ap_id,
+      test_ues[i].mme_ue_s1ap_id);
+    ck_assert_uint_eq(
+      message.msg.s1ap_UplinkNASTransportIEs.nas_pdu.size,
+      test_ues[i].nas_length);
+    ck_assert(
+      (message.msg.s1ap_UplinkNASTransportIEs.nas_pdu.buf >= raw->data) &&
+      (message.msg.s1ap_UplinkNASTransportIEs.nas_pdu.buf <=
+       raw->data + blength(raw)));
+    bdestroy(raw);
+  }
+}
+END_TEST
+
+START_TEST(s1ap_fast_decoder_initial_ue_message_test)
+{
+  for (int i = 0; i < sizeof(test_ues) / sizeof(test_ues[0]); i++) {
+    bstring raw = test_initial_ue_message(&test_ues[i]);
+
+    ck_assert_ptr_ne(raw, NULL);
+    ck_assert(test_compare(raw));
+    bdestroy(raw);
+  }
+}
+END_TEST
+
+START_TEST(s1ap_fast_decoder_fallback_test)
+{
+  test_s1ap_ue_t ue = test_ues[1];
+  bstring raw = NULL;
+  s1ap_message message = {0};
+  MessagesIds message_id = MESSAGES_ID_MAX;
+
+  /* Optional IEs are left to asn1c */
+  ue.s_tmsi = true;
+  raw = test_initial_ue_message(&ue);
+  ck_assert_ptr_ne(raw, NULL);
+  ck_assert(!test_compare(raw));
+  ck_assert_int_ge(s1ap_mme_decode_pdu(&message, raw, &message_id), 0);
+  ck_assert(!message.fast_decoded);
+  ck_assert(
+    message.msg.s1ap_InitialUEMessageIEs.presenceMask &
+    S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT);
+  s1ap_free_mme_decode_pdu(&message, message_id);
+
+  /* So are truncated PDUs */
+  btrunc(raw, blength(raw) - 1);
+  ck_assert(!test_compare(raw));
+  bdestroy(raw);
+}
+END_TEST
+
+START_TEST(s1ap_fast_decoder_fuzz_test)
+{
+  bstring uplink = test_uplink_nas_transport(&test_ues[1]);
+  bstring initial = test_initial_ue_message(&test_ues[4]);
+
+  test_fuzz(uplink);
+  test_fuzz(initial);
+  bdestroy(uplink);
+  bdestroy(initial);
+}
+END_TEST
+
+START_TEST(s1ap_fast_decoder_benchmark_test)
+{
+  bstring uplink = test_uplink_nas_transport(&test_ues[1]);
+  bstring initial = test_initial_ue_message(&test_ues[2]);
+
+  test_bench("UplinkNASTransport", uplink);
+  test_bench("InitialUEMessage", initial);
+  bdestroy(uplink);
+  bdestroy(initial);
+}
+END_TEST
+
+Suite *s1ap_fast_decoder_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("S1AP fast decoder tests");
+
+  tc_core = tcase_create("S1AP fast decoder test");
+  tcase_add_test(tc_core, s1ap_fast_decoder_uplink_nas_transport_test);
+  tcase_add_test(tc_core, s1ap_fast_decoder_initial_ue_message_test);
+  tcase_add_test(tc_core, s1ap_fast_decoder_fallback_test);
+  tcase_add_test(tc_core, s1ap_fast_decoder_fuzz_test);
+  tcase_add_test(tc_core, s1ap_fast_decoder_benchmark_test);
+  tcase_set_timeout(tc_core, 120);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  /* asn1c complains about every fuzzed PDU it rejects */
+  if (
+    OAILOG_INIT("TEST_S1AP_FAST", OAILOG_LEVEL_CRITICAL, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = s1ap_fast_decoder_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
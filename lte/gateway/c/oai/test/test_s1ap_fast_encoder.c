@@ -0,0 +1,304 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_fast_encoder.h"
+#include "s1ap_mme_handlers.h"
+
+#define TEST_S1AP_FAST_BENCH_ITERATIONS 200000
+#define TEST_S1AP_FAST_NAS_MAX_LENGTH 2048
+
+typedef struct test_s1ap_ids_s {
+  mme_ue_s1ap_id_t mme_ue_s1ap_id;
+  enb_ue_s1ap_id_t enb_ue_s1ap_id;
+} test_s1ap_ids_t;
+
+static const test_s1ap_ids_t test_ids[] = {
+  {0, 0},
+  {1, 1},
+  {255, 256},
+  {65535, 65536},
+  {0x00ffffff, 0x00ffffff},
+  {0x01000000, 0x00123456},
+  {0xffffffff, 7},
+};
+
+static const uint32_t test_nas_lengths[] =
+  {0, 1, 42, 127, 128, 300, 1000, 2048};
+
+typedef struct test_s1ap_cause_s {
+  S1ap_Cause_PR type;
+  long value;
+} test_s1ap_cause_t;
+
+/* The causes the MME sends, and the first and last root values */
+static const test_s1ap_cause_t test_causes[] = {
+  {S1ap_Cause_PR_nas, S1ap_CauseNas_detach},
+  {S1ap_Cause_PR_nas, S1ap_CauseNas_unspecified},
+  {S1ap_Cause_PR_nas, S1ap_CauseNas_normal_release},
+  {S1ap_Cause_PR_radioNetwork,
+   S1ap_CauseRadioNetwork_release_due_to_eutran_generated_reason},
+  {S1ap_Cause_PR_radioNetwork, S1ap_CauseRadioNetwork_unspecified},
+  {S1ap_Cause_PR_radioNetwork, S1ap_CauseRadioNetwork_cs_fallback_triggered},
+  {S1ap_Cause_PR_radioNetwork,
+   S1ap_CauseRadioNetwork_ue_not_available_for_ps_service},
+  {S1ap_Cause_PR_radioNetwork, S1ap_CauseRadioNetwork_x2_handover_triggered},
+  {S1ap_Cause_PR_transport, S1ap_CauseTransport_unspecified},
+  {S1ap_Cause_PR_protocol, S1ap_CauseProtocol_unspecified},
+  {S1ap_Cause_PR_misc, S1ap_CauseMisc_control_processing_overload},
+  {S1ap_Cause_PR_misc, S1ap_CauseMisc_unknown_PLMN},
+};
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static bstring test_nas(uint32_t length)
+{
+  uint8_t nas[TEST_S1AP_FAST_NAS_MAX_LENGTH];
+
+  for (uint32_t i = 0; i < length; i++) {
+    nas[i] = (uint8_t)(i * 13 + 0x07);
+  }
+  return blk2bstr(nas, length);
+}
+
+/* Reference encodings, the way the MME did them before the templates */
+static bstring test_asn1c_downlink_nas_transport(
+  const test_s1ap_ids_t *ids,
+  const_bstring const nas)
+{
+  s1ap_message message = {0};
+  S1ap_DownlinkNASTransportIEs_t *ies =
+    &message.msg.s1ap_DownlinkNASTransportIEs;
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+  bstring b = NULL;
+
+  message.procedureCode = S1ap_ProcedureCode_id_downlinkNASTransport;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  ies->mme_ue_s1ap_id = ids->mme_ue_s1ap_id;
+  ies->eNB_UE_S1AP_ID = ids->enb_ue_s1ap_id;
+  OCTET_STRING_fromBuf(&ies->nas_pdu, (char *) bdata(nas), blength(nas));
+  if (s1ap_mme_encode_pdu(&message, &buffer, &length) >= 0) {
+    b = blk2bstr(buffer, length);
+    free(buffer);
+  }
+  free_s1ap_downlinknastransport(ies);
+  return b;
+}
+
+static bstring test_asn1c_ue_context_release_command(
+  const test_s1ap_ids_t *ids,
+  const test_s1ap_cause_t *cause)
+{
+  s1ap_message message = {0};
+  S1ap_UEContextReleaseCommandIEs_t *ies =
+    &message.msg.s1ap_UEContextReleaseCommandIEs;
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+  bstring b = NULL;
+
+  message.procedureCode = S1ap_ProcedureCode_id_UEContextRelease;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  ies->uE_S1AP_IDs.present = S1ap_UE_S1AP_IDs_PR_uE_S1AP_ID_pair;
+  ies->uE_S1AP_IDs.choice.uE_S1AP_ID_pair.mME_UE_S1AP_ID = ids->mme_ue_s1ap_id;
+  ies->uE_S1AP_IDs.choice.uE_S1AP_ID_pair.eNB_UE_S1AP_ID = ids->enb_ue_s1ap_id;
+  s1ap_mme_set_cause(&ies->cause, cause->type, cause->value);
+  if (s1ap_mme_encode_pdu(&message, &buffer, &length) >= 0) {
+    b = blk2bstr(buffer, length);
+    free(buffer);
+  }
+  free_s1ap_uecontextreleasecommand(ies);
+  return b;
+}
+
+static void test_bstr_eq(const_bstring const fast, const_bstring const asn1c)
+{
+  ck_assert_ptr_ne(fast, NULL);
+  ck_assert_ptr_ne(asn1c, NULL);
+  ck_assert_int_eq(blength(fast), blength(asn1c));
+  ck_assert(!memcmp(bdata(fast), bdata(asn1c), blength(fast)));
+}
+
+START_TEST(s1ap_fast_encoder_downlink_nas_transport_test)
+{
+  for (int i = 0; i < sizeof(test_ids) / sizeof(test_ids[0]); i++) {
+    for (int n = 0; n < sizeof(test_nas_lengths) / sizeof(test_nas_lengths[0]);
+         n++) {
+      bstring nas = test_nas(test_nas_lengths[n]);
+      bstring asn1c = test_asn1c_downlink_nas_transport(&test_ids[i], nas);
+      bstring fast = NULL;
+
+      ck_assert_int_eq(
+        s1ap_mme_fast_encode_downlink_nas_transport(
+          test_ids[i].mme_ue_s1ap_id, test_ids[i].enb_ue_s1ap_id, nas, &fast),
+        RETURNok);
+      test_bstr_eq(fast, asn1c);
+      bdestroy(fast);
+      bdestroy(asn1c);
+      bdestroy(nas);
+    }
+  }
+}
+END_TEST
+
+START_TEST(s1ap_fast_encoder_ue_context_release_command_test)
+{
+  for (int i = 0; i < sizeof(test_ids) / sizeof(test_ids[0]); i++) {
+    for (int c = 0; c < sizeof(test_causes) / sizeof(test_causes[0]); c++) {
+      bstring asn1c =
+        test_asn1c_ue_context_release_command(&test_ids[i], &test_causes[c]);
+      bstring fast = NULL;
+
+      ck_assert_int_eq(
+        s1ap_mme_fast_encode_ue_context_release_command(
+          test_ids[i].mme_ue_s1ap_id,
+          test_ids[i].enb_ue_s1ap_id,
+          test_causes[c].type,
+          test_causes[c].value,
+          &fast),
+        RETURNok);
+      test_bstr_eq(fast, asn1c);
+      bdestroy(fast);
+      bdestroy(asn1c);
+    }
+  }
+}
+END_TEST
+
+START_TEST(s1ap_fast_encoder_fallback_test)
+{
+  bstring nas = test_nas(16);
+  bstring fast = NULL;
+
+  // eNB UE S1AP ids are 24 bits
+  ck_assert_int_eq(
+    s1ap_mme_fast_encode_downlink_nas_transport(1, 0x01000000, nas, &fast),
+    RETURNerror);
+  // Cause values of the extension are left to asn1c
+  ck_assert_int_eq(
+    s1ap_mme_fast_encode_ue_context_release_command(
+      1, 1, S1ap_Cause_PR_nas, S1ap_CauseNas_csg_subscription_expiry, &fast),
+    RETURNerror);
+  ck_assert_int_eq(
+    s1ap_mme_fast_encode_ue_context_release_command(
+      1, 1, S1ap_Cause_PR_NOTHING, 0, &fast),
+    RETURNerror);
+  ck_assert_ptr_eq(fast, NULL);
+  bdestroy(nas);
+}
+END_TEST
+
+START_TEST(s1ap_fast_encoder_benchmark_test)
+{
+  bstring nas = test_nas(42);
+  test_s1ap_ids_t ids = {0x1234, 0x5678};
+  uint64_t start = 0;
+  double asn1c_rate = 0;
+  double fast_rate = 0;
+
+  start = test_now_usec();
+  for (int i = 0; i < TEST_S1AP_FAST_BENCH_ITERATIONS; i++) {
+    bstring b = test_asn1c_downlink_nas_transport(&ids, nas);
+    bdestroy(b);
+  }
+  asn1c_rate =
+    TEST_S1AP_FAST_BENCH_ITERATIONS * 1e6 / (test_now_usec() - start + 1);
+
+  start = test_now_usec();
+  for (int i = 0; i < TEST_S1AP_FAST_BENCH_ITERATIONS; i++) {
+    bstring b = NULL;
+
+    if (
+      s1ap_mme_fast_encode_downlink_nas_transport(
+        ids.mme_ue_s1ap_id, ids.enb_ue_s1ap_id, nas, &b) == RETURNok) {
+      bdestroy(b);
+    }
+  }
+  fast_rate =
+    TEST_S1AP_FAST_BENCH_ITERATIONS * 1e6 / (test_now_usec() - start + 1);
+
+  printf(
+    "DownlinkNASTransport asn1c %9.0f encodes/s, template %9.0f encodes/s\n",
+    asn1c_rate,
+    fast_rate);
+  bdestroy(nas);
+}
+END_TEST
+
+Suite *s1ap_fast_encoder_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("S1AP fast encoder tests");
+
+  tc_core = tcase_create("S1AP fast encoder test");
+  tcase_add_test(tc_core, s1ap_fast_encoder_downlink_nas_transport_test);
+  tcase_add_test(tc_core, s1ap_fast_encoder_ue_context_release_command_test);
+  tcase_add_test(tc_core, s1ap_fast_encoder_fallback_test);
+  tcase_add_test(tc_core, s1ap_fast_encoder_benchmark_test);
+  tcase_set_timeout(tc_core, 120);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_S1AP_FAST", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = s1ap_fast_encoder_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,191 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "log.h"
+#include "shared_ts_log.h"
+#include "common_defs.h"
+#include "sgw_paging.h"
+
+#define TEST_SGW_PAGING_NB_UES 10000
+#define TEST_SGW_PAGING_IDLE_UES 1000
+#define TEST_SGW_PAGING_PACKET_INS 1000000
+
+static uint64_t test_now_usec(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static struct in_addr test_ue_ip(uint32_t i)
+{
+  struct in_addr ip = {.s_addr = htonl(0xc0a80000 + i)};
+
+  return ip;
+}
+
+static void test_add_ues(uint32_t nb_ues)
+{
+  char imsi[IMSI_BCD_DIGITS_MAX + 1];
+
+  for (uint32_t i = 0; i < nb_ues; i++) {
+    struct in_addr ip = test_ue_ip(i);
+    snprintf(imsi, sizeof(imsi), "00101%010u", i);
+    sgw_paging_add_ue(&ip, imsi);
+  }
+}
+
+static void test_setup(void)
+{
+  ck_assert_int_eq(sgw_paging_init(4096), RETURNok);
+}
+
+static void test_teardown(void)
+{
+  sgw_paging_exit();
+}
+
+START_TEST(sgw_paging_index_test)
+{
+  char imsi[IMSI_BCD_DIGITS_MAX + 1] = {0};
+  struct in_addr ip = test_ue_ip(42);
+  struct in_addr unknown = test_ue_ip(TEST_SGW_PAGING_NB_UES);
+
+  test_add_ues(TEST_SGW_PAGING_NB_UES);
+  ck_assert_int_eq(sgw_paging_trigger(&ip, 100, imsi), SGW_PAGING_SEND);
+  ck_assert_str_eq(imsi, "001010000000042");
+  ck_assert_int_eq(
+    sgw_paging_trigger(&unknown, 100, imsi), SGW_PAGING_UNKNOWN_UE);
+
+  // Released, then given to another UE
+  sgw_paging_remove_ue(&ip);
+  ck_assert_int_eq(sgw_paging_trigger(&ip, 200, imsi), SGW_PAGING_UNKNOWN_UE);
+  sgw_paging_add_ue(&ip, "001019999999999");
+  ck_assert_int_eq(sgw_paging_trigger(&ip, 200, imsi), SGW_PAGING_SEND);
+  ck_assert_str_eq(imsi, "001019999999999");
+}
+END_TEST
+
+START_TEST(sgw_paging_coalescing_test)
+{
+  char imsi[IMSI_BCD_DIGITS_MAX + 1] = {0};
+  struct in_addr ip = test_ue_ip(1);
+
+  test_add_ues(2);
+  ck_assert_int_eq(sgw_paging_trigger(&ip, 100, imsi), SGW_PAGING_SEND);
+  ck_assert_int_eq(
+    sgw_paging_trigger(&ip, 100, imsi), SGW_PAGING_OUTSTANDING);
+  ck_assert_int_eq(
+    sgw_paging_trigger(&ip, 100 + SGW_PAGING_OUTSTANDING_SEC - 1, imsi),
+    SGW_PAGING_OUTSTANDING);
+
+  // No answer from the UE: paged again once the procedure is over
+  ck_assert_int_eq(
+    sgw_paging_trigger(&ip, 100 + SGW_PAGING_OUTSTANDING_SEC, imsi),
+    SGW_PAGING_SEND);
+
+  // The UE answered: the next downlink data pages it right away
+  sgw_paging_done(&ip);
+  ck_assert_int_eq(sgw_paging_trigger(&ip, 200, imsi), SGW_PAGING_SEND);
+}
+END_TEST
+
+START_TEST(sgw_paging_flood_benchmark_test)
+{
+  char imsi[IMSI_BCD_DIGITS_MAX + 1] = {0};
+  uint32_t nb_sent = 0;
+  uint32_t nb_coalesced = 0;
+  uint64_t start = 0;
+  uint64_t usec = 0;
+  time_t now = time(NULL);
+
+  test_add_ues(TEST_SGW_PAGING_NB_UES);
+  start = test_now_usec();
+  for (uint32_t i = 0; i < TEST_SGW_PAGING_PACKET_INS; i++) {
+    struct in_addr ip = test_ue_ip((i * 7) % TEST_SGW_PAGING_IDLE_UES);
+    switch (sgw_paging_trigger(&ip, now, imsi)) {
+      case SGW_PAGING_SEND: nb_sent++; break;
+      case SGW_PAGING_OUTSTANDING: nb_coalesced++; break;
+      default: ck_abort_msg("UE %u not found", i); break;
+    }
+  }
+  usec = test_now_usec() - start;
+
+  ck_assert_int_eq(nb_sent, TEST_SGW_PAGING_IDLE_UES);
+  ck_assert_int_eq(
+    nb_coalesced, TEST_SGW_PAGING_PACKET_INS - TEST_SGW_PAGING_IDLE_UES);
+  printf(
+    "%u packet-ins for %u idle UEs: %u pages, %.0f packet-ins/s\n",
+    TEST_SGW_PAGING_PACKET_INS,
+    TEST_SGW_PAGING_IDLE_UES,
+    nb_sent,
+    TEST_SGW_PAGING_PACKET_INS * 1e6 / (usec + 1));
+}
+END_TEST
+
+Suite *sgw_paging_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("SGW paging tests");
+
+  tc_core = tcase_create("SGW paging test");
+  tcase_add_checked_fixture(tc_core, test_setup, test_teardown);
+  tcase_add_test(tc_core, sgw_paging_index_test);
+  tcase_add_test(tc_core, sgw_paging_coalescing_test);
+  tcase_add_test(tc_core, sgw_paging_flood_benchmark_test);
+  tcase_set_timeout(tc_core, 60);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  if (
+    OAILOG_INIT("TEST_SGW_PAGING", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS) ||
+    shared_log_init(MAX_LOG_PROTOS)) {
+    return EXIT_FAILURE;
+  }
+
+  s = sgw_paging_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
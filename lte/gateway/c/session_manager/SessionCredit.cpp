@@ -14,8 +14,8 @@
 
 namespace magma {
 
-uint64_t SessionCredit::USAGE_REPORTING_LIMIT =
-    std::numeric_limits<uint64_t>::max();
+std::atomic<uint64_t> SessionCredit::USAGE_REPORTING_LIMIT(
+    std::numeric_limits<uint64_t>::max());
 
 SessionCredit::SessionCredit(ServiceState start_state)
   : reporting_(false),
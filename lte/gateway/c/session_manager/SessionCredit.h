@@ -8,6 +8,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <ctime>
 #include <unordered_map>
 #include <memory>
@@ -141,9 +142,10 @@ public:
   /**
    * Limit for the total usage (tx + rx) in credit updates.
    * If the used counts are greater than the limits, then the credit
-   * updates will be sent over multiple transactions.
+   * updates will be sent over multiple transactions. Updated when sessiond's
+   * config changes.
    */
-  static uint64_t USAGE_REPORTING_LIMIT;
+  static std::atomic<uint64_t> USAGE_REPORTING_LIMIT;
 
 private:
   bool reporting_;
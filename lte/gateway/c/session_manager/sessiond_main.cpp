@@ -46,6 +46,25 @@ static magma::mconfig::SessionD load_mconfig() {
   return mconfig;
 }
 
+// Applies the log level and the reporting limit when the configs change
+static void watch_configs() {
+  magma::MConfigLoader{}.subscribe_service_mconfig<magma::mconfig::SessionD>(
+    SESSIOND_SERVICE,
+    [](std::shared_ptr<const magma::mconfig::SessionD> mconfig) {
+      if (mconfig) {
+        magma::set_verbosity(magma::LogLevel::FATAL - mconfig->log_level());
+      }
+    });
+  magma::ServiceConfigLoader{}.subscribe_service_config(
+    SESSIOND_SERVICE,
+    [](std::shared_ptr<const YAML::Node> config) {
+      auto limit = (*config)["usage_reporting_limit_bytes"];
+      if (limit) {
+        magma::SessionCredit::USAGE_REPORTING_LIMIT = limit.as<uint64_t>();
+      }
+    });
+}
+
 static void run_bare_service303() {
   magma::service303::MagmaService server(SESSIOND_SERVICE, SESSIOND_VERSION);
   server.Start();
@@ -82,6 +101,7 @@ int main (int argc, char* argv[]) {
   auto config = magma::ServiceConfigLoader{}.load_service_config(
     SESSIOND_SERVICE);
   magma::set_verbosity(magma::LogLevel::FATAL - mconfig.log_level());
+  watch_configs();
 
   if (!sessiond_enabled(mconfig)) {
     MLOG(MINFO) << "Credit control disabled, local enforcer not running";
@@ -0,0 +1,233 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <exception>
+
+#include "ConfigCache.h"
+#include "magma_logging.h"
+
+namespace magma {
+
+static const uint32_t WATCHED_EVENTS =
+  IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+
+ConfigCache& ConfigCache::Instance() {
+  static ConfigCache* instance = new ConfigCache();
+  return *instance;
+}
+
+ConfigCache::ConfigCache()
+  : next_subscriber_id_(0), inotify_fd_(-1), stop_fds_{-1, -1} {}
+
+ConfigCache::~ConfigCache() {
+  if (watcher_.joinable()) {
+    char stop = 0;
+    if (write(stop_fds_[1], &stop, sizeof(stop)) < 0) {
+      MLOG(MERROR) << "Couldn't stop the config watcher";
+    }
+    watcher_.join();
+  }
+  for (int fd : {inotify_fd_, stop_fds_[0], stop_fds_[1]}) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+std::shared_ptr<const void> ConfigCache::get_snapshot(
+    const std::string& key,
+    const std::vector<std::string>& files,
+    Loader load) {
+  // Stamped before loading: a change made while loading triggers a reload
+  auto stamps = stat_files(files);
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.stamps == stamps) {
+      return it->second.snapshot;
+    }
+  }
+  auto snapshot = load();
+
+  std::lock_guard<std::mutex> guard(lock_);
+  auto& entry = entries_[key];
+  entry.files = files;
+  entry.stamps = std::move(stamps);
+  entry.load = std::move(load);
+  entry.snapshot = snapshot;
+  return snapshot;
+}
+
+std::vector<ConfigCache::file_stamp_t> ConfigCache::stat_files(
+    const std::vector<std::string>& files) {
+  std::vector<file_stamp_t> stamps(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    struct stat file_stat;
+    if (stat(files[i].c_str(), &file_stat) < 0) {
+      stamps[i] = {false, 0, 0, 0};
+      continue;
+    }
+    stamps[i] = {
+      true,
+      file_stat.st_ino,
+      file_stat.st_size,
+      file_stat.st_mtim.tv_sec * 1000000000LL + file_stat.st_mtim.tv_nsec};
+  }
+  return stamps;
+}
+
+int ConfigCache::subscribe(const std::string& key, Callback callback) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || !watch_files(it->second.files)) {
+    return -1;
+  }
+  int id = next_subscriber_id_++;
+  subscribers_[id] = {key, std::move(callback)};
+  return id;
+}
+
+void ConfigCache::unsubscribe(int id) {
+  std::lock_guard<std::mutex> guard(lock_);
+  subscribers_.erase(id);
+}
+
+bool ConfigCache::watch_files(const std::vector<std::string>& files) {
+  if (inotify_fd_ < 0) {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+      MLOG(MERROR) << "Couldn't watch config files: " << strerror(errno);
+      return false;
+    }
+    if (pipe2(stop_fds_, O_CLOEXEC) < 0) {
+      MLOG(MERROR) << "Couldn't create the config watcher: " << strerror(errno);
+      close(inotify_fd_);
+      inotify_fd_ = -1;
+      return false;
+    }
+    watcher_ = std::thread(&ConfigCache::watch_loop, this);
+  }
+
+  bool watched = false;
+  for (const auto& file : files) {
+    auto slash = file.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : file.substr(0, slash);
+    // The watch descriptor of a directory already watched is returned
+    int wd = inotify_add_watch(inotify_fd_, dir.c_str(), WATCHED_EVENTS);
+    if (wd < 0) {
+      MLOG(MDEBUG) << "Couldn't watch " << dir << ": " << strerror(errno);
+      continue;
+    }
+    watched_dirs_[wd] = dir;
+    watched = true;
+  }
+  return watched;
+}
+
+void ConfigCache::watch_loop() {
+  // Large enough for a burst of events, inotify_event is followed by the name
+  alignas(struct inotify_event) char buffer[16 * 1024];
+  struct pollfd fds[2] = {
+    {inotify_fd_, POLLIN, 0},
+    {stop_fds_[0], POLLIN, 0},
+  };
+
+  while (true) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      MLOG(MERROR) << "Config watcher stopped: " << strerror(errno);
+      return;
+    }
+    if (fds[1].revents) {
+      return;
+    }
+
+    // Changes come in bursts, each config is reloaded once per read
+    std::set<std::string> paths;
+    ssize_t length;
+    while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+      std::lock_guard<std::mutex> guard(lock_);
+      for (char* ptr = buffer; ptr < buffer + length;) {
+        auto event = reinterpret_cast<struct inotify_event*>(ptr);
+        auto dir_it = watched_dirs_.find(event->wd);
+        if (event->len && dir_it != watched_dirs_.end()) {
+          paths.insert(dir_it->second + "/" + event->name);
+        }
+        ptr += sizeof(struct inotify_event) + event->len;
+      }
+    }
+    if (!paths.empty()) {
+      refresh(paths);
+    }
+  }
+}
+
+void ConfigCache::refresh(const std::set<std::string>& paths) {
+  std::vector<std::pair<std::string, entry_t>> changed;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (const auto& it : entries_) {
+      for (const auto& file : it.second.files) {
+        if (paths.count(file)) {
+          changed.push_back(it);
+          break;
+        }
+      }
+    }
+  }
+
+  for (auto& it : changed) {
+    const std::string& key = it.first;
+    auto stamps = stat_files(it.second.files);
+    if (stamps == it.second.stamps) {
+      continue;
+    }
+    std::shared_ptr<const void> snapshot;
+    try {
+      snapshot = it.second.load();
+    } catch (const std::exception& e) {
+      // Likely written in several steps, the next event reloads it
+      MLOG(MERROR) << "Couldn't reload config " << key << ": " << e.what();
+      continue;
+    }
+
+    std::vector<Callback> callbacks;
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      auto& entry = entries_[key];
+      entry.stamps = std::move(stamps);
+      entry.snapshot = std::move(snapshot);
+      for (const auto& subscriber : subscribers_) {
+        if (subscriber.second.key == key) {
+          callbacks.push_back(subscriber.second.callback);
+        }
+      }
+    }
+    MLOG(MINFO) << "Config " << key << " changed, reloaded";
+    for (const auto& callback : callbacks) {
+      try {
+        callback();
+      } catch (const std::exception& e) {
+        MLOG(MERROR) << "Couldn't apply config " << key << ": " << e.what();
+      }
+    }
+  }
+}
+
+} // namespace magma
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace magma {
+
+/**
+ * ConfigCache is a process-wide cache of parsed configuration files. Each
+ * config is parsed once into an immutable snapshot shared by all its readers.
+ * It is parsed again only when one of its files changes: every get checks
+ * the files with stat(). A watcher thread, started by the first subscription,
+ * also reloads the subscribed configs on inotify events and notifies their
+ * subscribers, so that services can apply new settings without a restart.
+ */
+class ConfigCache final {
+  public:
+    using Loader = std::function<std::shared_ptr<const void>()>;
+    using Callback = std::function<void()>;
+
+    static ConfigCache& Instance();
+
+    ConfigCache();
+    ~ConfigCache();
+
+    /*
+     * Returns the snapshot of a config, parsed on the first call and after
+     * one of its files changed
+     *
+     * @param key: name of the config, always loaded as the same type T
+     * @param files: files the config is made of, they may not exist
+     * @param load: parses the files, nothing is cached if it throws
+     * @return the snapshot returned by load
+     */
+    template <typename T>
+    std::shared_ptr<const T> get(
+        const std::string& key,
+        const std::vector<std::string>& files,
+        std::function<std::shared_ptr<const T>()> load) {
+      return std::static_pointer_cast<const T>(get_snapshot(
+        key, files, [load]() { return std::shared_ptr<const void>(load()); }));
+    }
+
+    /*
+     * Calls callback from the watcher thread after a config was reloaded
+     * because one of its files changed. Files in a directory that doesn't
+     * exist yet are only reloaded by get.
+     *
+     * @param key: name of a config already loaded with get
+     * @return id of the subscription, -1 if the config isn't loaded or its
+     *    files can't be watched
+     */
+    int subscribe(const std::string& key, Callback callback);
+
+    void unsubscribe(int id);
+
+  private:
+    struct file_stamp_t {
+      bool exists;
+      ino_t inode;
+      off_t size;
+      int64_t mtime_ns;
+
+      bool operator==(const file_stamp_t& other) const {
+        return exists == other.exists && inode == other.inode &&
+          size == other.size && mtime_ns == other.mtime_ns;
+      }
+    };
+
+    struct entry_t {
+      std::vector<std::string> files;
+      std::vector<file_stamp_t> stamps;
+      Loader load;
+      std::shared_ptr<const void> snapshot;
+    };
+
+    struct subscriber_t {
+      std::string key;
+      Callback callback;
+    };
+
+    std::shared_ptr<const void> get_snapshot(
+      const std::string& key,
+      const std::vector<std::string>& files,
+      Loader load);
+
+    static std::vector<file_stamp_t> stat_files(
+      const std::vector<std::string>& files);
+
+    /*
+     * Starts the watcher thread if needed and watches the directories of the
+     * files, the files themselves are often replaced by a rename
+     */
+    bool watch_files(const std::vector<std::string>& files);
+
+    void watch_loop();
+
+    // Reloads the configs made of one of the paths and notifies subscribers
+    void refresh(const std::set<std::string>& paths);
+
+  private:
+    std::mutex lock_;
+    std::unordered_map<std::string, entry_t> entries_;
+    std::map<int, subscriber_t> subscribers_;
+    int next_subscriber_id_;
+    int inotify_fd_;
+    int stop_fds_[2];
+    std::unordered_map<int, std::string> watched_dirs_;
+    std::thread watcher_;
+};
+
+} // namespace magma
@@ -26,25 +26,40 @@ static bool check_file_exists(const std::string filename) {
   return f.is_open();
 }
 
+static std::shared_ptr<const json> parse_mconfig_file(std::ifstream& file) {
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  auto mconfig_json = std::make_shared<json>();
+  try {
+    *mconfig_json << file;
+  } catch (const std::exception& e) {
+    MLOG(MERROR) << "Couldn't parse mconfig file: " << e.what();
+    return nullptr;
+  }
+  return mconfig_json;
+}
+
 bool MConfigLoader::load_service_mconfig(
     const std::string& service_name,
     google::protobuf::Message* message) {
-  std::ifstream file;
-  get_mconfig_file(&file);
-  if (!file.is_open()) {
+  // The file is parsed once, and again when it changes
+  auto mconfig_json = ConfigCache::Instance().get<json>(
+    "mconfig", get_mconfig_files(), []() {
+      std::ifstream file;
+      get_mconfig_file(&file);
+      return parse_mconfig_file(file);
+    });
+  if (!mconfig_json) {
     MLOG(MERROR) << "Couldn't load mconfig file";
     return false;
   }
 
-  json mconfig_json;
-  mconfig_json << file;
-  file.close();
-
   // config is located at mconfig_json["configs_by_key"][service_name]
-  auto configs_it = mconfig_json.find("configs_by_key");
-  if (configs_it == mconfig_json.end()) {
-    configs_it = mconfig_json.find("configsByKey");
-    if (configs_it == mconfig_json.end()) {
+  auto configs_it = mconfig_json->find("configs_by_key");
+  if (configs_it == mconfig_json->end()) {
+    configs_it = mconfig_json->find("configsByKey");
+    if (configs_it == mconfig_json->end()) {
       MLOG(MERROR) << "Could not find configs_by_key in mconfig";
       return false;
     }
@@ -56,30 +71,38 @@ bool MConfigLoader::load_service_mconfig(
     MLOG(MERROR) << "Couldn't find pipelined config";
     return false;
   }
-  service_it->erase("@type"); // @type param makes parsing fail
+  json service_config = *service_it;
+  service_config.erase("@type"); // @type param makes parsing fail
 
   // Parse to message and return
   auto status = google::protobuf::util::JsonStringToMessage(
-    service_it->dump(), message);
+    service_config.dump(), message);
   if (!status.ok()) {
     MLOG(MERROR) << "Couldn't parse pipelined config";
   }
   return status.ok();
 }
 
+std::string MConfigLoader::get_static_mconfig_path() {
+  const char* cfg_dir = std::getenv("MAGMA_CONFIG_LOCATION");
+  if (cfg_dir == nullptr) {
+    cfg_dir = MConfigLoader::CONFIG_DIR;
+  }
+  return std::string(cfg_dir) + "/"
+    + std::string(MConfigLoader::MCONFIG_FILE_NAME);
+}
+
+std::vector<std::string> MConfigLoader::get_mconfig_files() {
+  return {MConfigLoader::DYNAMIC_MCONFIG_PATH, get_static_mconfig_path()};
+}
+
 void MConfigLoader::get_mconfig_file(std::ifstream* file) {
   // Load from /var/opt/magma if config exists, else read from /etc/magma
   if (check_file_exists(MConfigLoader::DYNAMIC_MCONFIG_PATH)) {
     file->open(MConfigLoader::DYNAMIC_MCONFIG_PATH);
     return;
   }
-  const char* cfg_dir = std::getenv("MAGMA_CONFIG_LOCATION");
-  if (cfg_dir == nullptr) {
-    cfg_dir = MConfigLoader::CONFIG_DIR;
-  }
-  auto file_path = std::string(cfg_dir) + "/"
-    + std::string(MConfigLoader::MCONFIG_FILE_NAME);
-  file->open(file_path.c_str());
+  file->open(get_static_mconfig_path().c_str());
   return;
 }
 
@@ -8,6 +8,16 @@
  */
 #pragma once
 
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/message.h>
+
+#include "ConfigCache.h"
+
 namespace magma {
 
 /**
@@ -28,6 +38,46 @@ public:
     const std::string& service_name,
     google::protobuf::Message* message);
 
+  /**
+   * get_service_mconfig returns the cached mconfig of a service, parsed once
+   * and shared with the other readers.
+   * @param service_name - name of service to load
+   * @returns the mconfig, nullptr if it couldn't be loaded
+   */
+  template <typename T>
+  std::shared_ptr<const T> get_service_mconfig(
+      const std::string& service_name) {
+    return ConfigCache::Instance().get<T>(
+      "mconfig:" + service_name + ":" + T::descriptor()->full_name(),
+      get_mconfig_files(),
+      [service_name]() -> std::shared_ptr<const T> {
+        auto message = std::make_shared<T>();
+        MConfigLoader loader;
+        if (!loader.load_service_mconfig(service_name, message.get())) {
+          return nullptr;
+        }
+        return message;
+      });
+  }
+
+  /**
+   * subscribe_service_mconfig calls callback, from the config watcher thread,
+   * with the new mconfig of the service whenever the mconfig file changes.
+   * @returns id of the subscription for ConfigCache::unsubscribe, -1 if the
+   *          file can't be watched
+   */
+  template <typename T>
+  int subscribe_service_mconfig(
+      const std::string& service_name,
+      std::function<void(std::shared_ptr<const T>)> callback) {
+    get_service_mconfig<T>(service_name);
+    return ConfigCache::Instance().subscribe(
+      "mconfig:" + service_name + ":" + T::descriptor()->full_name(),
+      [service_name, callback]() {
+        callback(MConfigLoader{}.get_service_mconfig<T>(service_name));
+      });
+  }
+
 private:
   static constexpr const char* DYNAMIC_MCONFIG_PATH
     = "/var/opt/magma/configs/gateway.mconfig";
@@ -35,7 +85,10 @@ private:
   static constexpr const char* MCONFIG_FILE_NAME = "gateway.mconfig";
 
 private:
-  void get_mconfig_file(std::ifstream* file);
+  static void get_mconfig_file(std::ifstream* file);
+  static std::string get_static_mconfig_path();
+  // Files the mconfig may be loaded from, the first existing one is used
+  static std::vector<std::string> get_mconfig_files();
 };
 
 }
@@ -17,19 +17,48 @@
 
 namespace magma {
 
-YAML::Node ServiceConfigLoader::load_service_config(
-    const std::string& service_name){
-  auto file_path = std::string(CONFIG_DIR) + service_name + ".yml";
-  YAML::Node base_config = YAML::LoadFile(file_path);
+static std::shared_ptr<const YAML::Node> parse_service_config(
+    const std::string& file_path,
+    const std::string& override_file,
+    const std::string& service_name) {
+  auto base_config = std::make_shared<YAML::Node>(YAML::LoadFile(file_path));
 
   // Try to override original file, if an override exists
   try {
-    auto override_file = std::string(OVERRIDE_DIR) + service_name + ".yml";
-    return YAMLUtils::merge_nodes(base_config, YAML::LoadFile(override_file));
-  } catch (YAML::BadFile e) {
+    *base_config = YAMLUtils::merge_nodes(
+      *base_config, YAML::LoadFile(override_file));
+  } catch (const YAML::BadFile& e) {
     MLOG(MDEBUG) << "Override file not found for service " << service_name;
   }
   return base_config;
 }
 
+YAML::Node ServiceConfigLoader::load_service_config(
+    const std::string& service_name){
+  return YAML::Clone(*get_service_config(service_name));
+}
+
+std::shared_ptr<const YAML::Node> ServiceConfigLoader::get_service_config(
+    const std::string& service_name) {
+  auto file_path = std::string(CONFIG_DIR) + service_name + ".yml";
+  auto override_file = std::string(OVERRIDE_DIR) + service_name + ".yml";
+  return ConfigCache::Instance().get<YAML::Node>(
+    "service_config:" + service_name,
+    {file_path, override_file},
+    [file_path, override_file, service_name]() {
+      return parse_service_config(file_path, override_file, service_name);
+    });
+}
+
+int ServiceConfigLoader::subscribe_service_config(
+    const std::string& service_name,
+    std::function<void(std::shared_ptr<const YAML::Node>)> callback) {
+  get_service_config(service_name);
+  return ConfigCache::Instance().subscribe(
+    "service_config:" + service_name,
+    [service_name, callback]() {
+      callback(ServiceConfigLoader{}.get_service_config(service_name));
+    });
+}
+
 }
@@ -8,9 +8,13 @@
  */
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <string>
 #include "yaml-cpp/yaml.h"
 
+#include "ConfigCache.h"
+
 namespace magma {
 
 /**
@@ -21,12 +25,34 @@ class ServiceConfigLoader final {
 
   public:
     /*
-     * Load service configuration from file.
+     * Load service configuration from file. The files are parsed once by the
+     * ConfigCache, the Node returned is a copy the caller can modify.
      *
      * @return YAML::Node a Node representation of the file.
      */
     YAML::Node load_service_config(const std::string& service_name);
 
+    /*
+     * Returns the cached service configuration, without copying it. It is
+     * shared with the other readers and must not be modified.
+     *
+     * @return the merged configuration, throws YAML::BadFile if the service
+     *    config file doesn't exist
+     */
+    std::shared_ptr<const YAML::Node> get_service_config(
+      const std::string& service_name);
+
+    /*
+     * Calls callback, from the config watcher thread, with the new service
+     * configuration whenever its files change
+     *
+     * @return id of the subscription for ConfigCache::unsubscribe, -1 if the
+     *    files can't be watched
+     */
+    int subscribe_service_config(
+      const std::string& service_name,
+      std::function<void(std::shared_ptr<const YAML::Node>)> callback);
+
 
   private:
     static constexpr const char* CONFIG_DIR = "/etc/magma/";
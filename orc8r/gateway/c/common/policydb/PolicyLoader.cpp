@@ -16,8 +16,9 @@ namespace magma {
 
 static bool try_redis_connect(cpp_redis::client& client) {
   ServiceConfigLoader loader;
-  auto config = loader.load_service_config("redis");
-  auto port = config["port"].as<uint32_t>();
+  // Retried until redis is up, the config is only parsed once
+  auto config = loader.get_service_config("redis");
+  auto port = (*config)["port"].as<uint32_t>();
   try {
     client.connect("127.0.0.1", port, [](
         const std::string& host,
@@ -80,6 +80,10 @@ void MagmaService::ClearServiceInfoCallback() {
   service_info_callback_ = nullptr;
 }
 
+void MagmaService::SetMetricsDeltaExport(uint32_t full_export_interval) {
+  metrics_exporter_.SetDeltaExport(full_export_interval);
+}
+
 Status MagmaService::GetServiceInfo(
     ServerContext* context, const Void* request, ServiceInfo* response) {
   auto start_time_secs =
@@ -111,11 +115,8 @@ Status MagmaService::GetMetrics(
   setSharedMetrics();
 
   MetricsSingleton& instance = MetricsSingleton::Instance();
-  const std::vector<MetricFamily>& collected = instance.registry_->Collect();
-  for (auto it = collected.begin(); it != collected.end(); it++) {
-    MetricFamily* family = response->add_family();
-    family->CopyFrom(*it);
-  }
+  std::vector<MetricFamily> collected = instance.registry_->Collect();
+  metrics_exporter_.Export(collected, response);
   return Status::OK;
 }
 
@@ -12,6 +12,7 @@
 #include <orc8r/protos/service303.grpc.pb.h>
 #include <chrono>
 
+#include "MetricsExporter.h"
 #include "MetricsRegistry.h"
 #include "MetricsSingleton.h"
 
@@ -74,6 +75,13 @@ class MagmaService final : public Service303::Service {
      */
     void ClearServiceInfoCallback();
 
+    /**
+     * Only exports the metrics that changed since the previous GetMetrics
+     * call, and all of them every full_export_interval calls. 0, the default,
+     * exports all of them on every call.
+     */
+    void SetMetricsDeltaExport(uint32_t full_export_interval);
+
     /*
     * Returns the service info (name, version, state, etc.)
     *
@@ -166,6 +174,7 @@ class MagmaService final : public Service303::Service {
     std::unique_ptr<Server> server_;
     grpc::ServerBuilder builder_;
     ServiceInfoCallback service_info_callback_;
+    MetricsExporter metrics_exporter_;
 };
 
 }} // namespace magma::service303
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <functional>
+#include <string>
+
+#include "MetricsExporter.h"
+
+using io::prometheus::client::Metric;
+using io::prometheus::client::MetricFamily;
+using magma::orc8r::MetricsContainer;
+
+namespace magma { namespace service303 {
+
+static inline void hash_combine(std::size_t& seed, const std::string& value) {
+  seed ^= std::hash<std::string>{}(value) + 0x9e3779b9 + (seed << 6) +
+    (seed >> 2);
+}
+
+MetricsExporter::MetricsExporter()
+  : full_export_interval_(0), nb_exports_(0) {}
+
+void MetricsExporter::SetDeltaExport(uint32_t full_export_interval) {
+  std::lock_guard<std::mutex> guard(lock_);
+  full_export_interval_ = full_export_interval;
+  nb_exports_ = 0;
+  last_values_.clear();
+}
+
+std::size_t MetricsExporter::Export(
+    std::vector<MetricFamily>& collected,
+    MetricsContainer* response) {
+  bool full_export = true;
+  std::size_t nb_series = 0;
+  std::lock_guard<std::mutex> guard(lock_);
+
+  if (full_export_interval_ > 0) {
+    full_export = (nb_exports_ % full_export_interval_) == 0;
+    nb_exports_++;
+  }
+  response->mutable_family()->Reserve(
+    response->family_size() + collected.size());
+  for (auto& family : collected) {
+    if (full_export_interval_ > 0) {
+      filter_unchanged(family, full_export);
+    }
+    if (family.metric_size() == 0) {
+      continue;
+    }
+    nb_series += family.metric_size();
+    // Swapping only exchanges the pointers of the repeated fields
+    response->add_family()->Swap(&family);
+  }
+  if (full_export_interval_ > 0) {
+    prune_series();
+  }
+  return nb_series;
+}
+
+void MetricsExporter::filter_unchanged(
+    MetricFamily& family,
+    bool full_export) {
+  auto* metrics = family.mutable_metric();
+  const std::size_t family_hash = std::hash<std::string>{}(family.name());
+  int nb_kept = 0;
+
+  for (int i = 0; i < metrics->size(); i++) {
+    const Metric& metric = metrics->Get(i);
+    const series_value_t value = get_value(family, metric);
+    const std::size_t key = hash_series(family_hash, metric);
+    auto inserted = last_values_.insert({key, {value, nb_exports_}});
+    if (!inserted.second) {
+      series_state_t& state = inserted.first->second;
+      state.export_id = nb_exports_;
+      if (state.value == value && !full_export) {
+        continue;
+      }
+      state.value = value;
+    }
+    if (nb_kept != i) {
+      metrics->SwapElements(nb_kept, i);
+    }
+    nb_kept++;
+  }
+  metrics->DeleteSubrange(nb_kept, metrics->size() - nb_kept);
+}
+
+void MetricsExporter::prune_series() {
+  for (auto it = last_values_.begin(); it != last_values_.end();) {
+    if (it->second.export_id != nb_exports_) {
+      it = last_values_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::size_t MetricsExporter::hash_series(
+    std::size_t family_hash,
+    const Metric& metric) {
+  std::size_t seed = family_hash;
+  for (const auto& label : metric.label()) {
+    hash_combine(seed, label.name());
+    hash_combine(seed, label.value());
+  }
+  return seed;
+}
+
+MetricsExporter::series_value_t MetricsExporter::get_value(
+    const MetricFamily& family,
+    const Metric& metric) {
+  switch (family.type()) {
+    case io::prometheus::client::COUNTER:
+      return {metric.counter().value(), 0};
+    case io::prometheus::client::GAUGE:
+      return {metric.gauge().value(), 0};
+    case io::prometheus::client::SUMMARY:
+      return {metric.summary().sample_sum(), metric.summary().sample_count()};
+    case io::prometheus::client::HISTOGRAM:
+      return {
+        metric.histogram().sample_sum(), metric.histogram().sample_count()};
+    default:
+      return {metric.untyped().value(), 0};
+  }
+}
+
+}} // namespace magma::service303
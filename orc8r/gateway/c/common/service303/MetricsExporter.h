@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <prometheus/metrics.pb.h>
+#include <orc8r/protos/metricsd.pb.h>
+
+namespace magma { namespace service303 {
+
+/**
+ * MetricsExporter moves the families collected from the prometheus registry
+ * into a MetricsContainer, without copying them. With delta export enabled,
+ * only the series whose value changed since the previous export are kept,
+ * and every series is sent again every full_export_interval exports so that
+ * the ones that never change do not go stale upstream. The series that
+ * are no longer collected are forgotten.
+ *
+ * GetMetrics runs on the gRPC thread pool, so exports are serialized.
+ */
+class MetricsExporter final {
+  public:
+    MetricsExporter();
+
+    /*
+     * Enables delta export
+     *
+     * @param full_export_interval: number of exports between two full ones,
+     *    0 disables delta export
+     */
+    void SetDeltaExport(uint32_t full_export_interval);
+
+    /*
+     * Moves the collected families into the response. collected is left with
+     * empty families.
+     *
+     * @param collected: families returned by the registry
+     * @param response (out): container the families are added to
+     * @return number of series exported
+     */
+    std::size_t Export(
+      std::vector<io::prometheus::client::MetricFamily>& collected,
+      magma::orc8r::MetricsContainer* response);
+
+    /*
+     * Number of series whose last exported value is known
+     */
+    std::size_t SizeSeries() const {
+      std::lock_guard<std::mutex> guard(lock_);
+      return last_values_.size();
+    }
+
+  private:
+    /*
+     * Drops the series of the family unchanged since the last export, and
+     * records the value of the others
+     */
+    void filter_unchanged(
+      io::prometheus::client::MetricFamily& family,
+      bool full_export);
+
+    /*
+     * Forgets the series not seen by the current export
+     */
+    void prune_series();
+
+    static std::size_t hash_series(
+      std::size_t family_hash,
+      const io::prometheus::client::Metric& metric);
+
+    /*
+     * Value compared between two exports. Histograms and summaries change
+     * whenever an observation is added, so their count and sum are enough.
+     */
+    struct series_value_t {
+      double value;
+      uint64_t count;
+
+      bool operator==(const series_value_t& other) const {
+        return value == other.value && count == other.count;
+      }
+    };
+
+    static series_value_t get_value(
+      const io::prometheus::client::MetricFamily& family,
+      const io::prometheus::client::Metric& metric);
+
+    struct series_state_t {
+      series_value_t value;
+      // Export that last saw the series
+      uint32_t export_id;
+    };
+
+  private:
+    mutable std::mutex lock_;
+    uint32_t full_export_interval_;
+    uint32_t nb_exports_;
+    std::unordered_map<std::size_t, series_state_t> last_values_;
+};
+
+}} // namespace magma::service303
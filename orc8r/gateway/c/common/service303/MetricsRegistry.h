@@ -118,13 +118,15 @@ template <typename T, typename MetricFamilyFactory>
 std::size_t MetricsRegistry<T, MetricFamilyFactory>::hash_name_and_labels(
     const std::string& name,
     const std::map<std::string, std::string>& labels) {
-  auto combined = std::accumulate(
-      labels.begin(), labels.end(), std::string{name},
-      [](const std::string& acc,
-         const std::pair<std::string, std::string>& label_pair) {
-        return acc + label_pair.first + label_pair.second;
-      });
-  return std::hash<std::string>{}(combined);
+  // Called on every metric update, combine the hashes rather than hashing a
+  // concatenation of the strings
+  std::hash<std::string> hasher;
+  std::size_t seed = hasher(name);
+  for (const auto& label_pair : labels) {
+    seed ^= hasher(label_pair.first) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= hasher(label_pair.second) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+  return seed;
 }
 
 template <typename T, typename MetricFamilyFactory>
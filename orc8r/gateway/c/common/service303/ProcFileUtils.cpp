@@ -9,9 +9,11 @@
  */
 
 #include <string>
-#include <ratio>
-#include <fstream>
-#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "ProcFileUtils.h"
 
@@ -23,42 +25,43 @@ const std::string ProcFileUtils::VIRTUAL_MEM_PREFIX = "VmSize:";
 const std::string ProcFileUtils::PHYSICAL_MEM_PREFIX = "VmRSS:";
 
 double ProcFileUtils::parseForPrefix(
-    std::ifstream& infile,
-    const std::string& to_compare,
+    const char* content,
     const std::string& prefix_name) {
-  if (to_compare.compare(prefix_name) == 0) {
-    std::string value_string;
-    infile >> value_string;
-    // KiB -> bytes
-    return std::stod(value_string) * 1024;
+  const char* line = content;
+  while ((line = strstr(line, prefix_name.c_str())) != nullptr) {
+    // Only match at the start of a line
+    if (line == content || line[-1] == '\n') {
+      // KiB -> bytes
+      return strtod(line + prefix_name.size(), nullptr) * 1024;
+    }
+    line += prefix_name.size();
   }
   return -1;
 }
 
 const ProcFileUtils::memory_info_t ProcFileUtils::getMemoryInfo() {
-  std::ifstream infile(ProcFileUtils::STATUS_FILE);
   ProcFileUtils::memory_info_t info;
-  std::string content;
-  // Parse file token by token until prefixes are found
-  while (infile >> content) {
-    double value;
-    // look for and set virtual_mem
-    value = ProcFileUtils::parseForPrefix(infile, content,
-      ProcFileUtils::VIRTUAL_MEM_PREFIX);
-    if (value >= 0) {
-      info.virtual_mem = value;
-    }
-    // look for and set physical_mem
-    value = ProcFileUtils::parseForPrefix(infile, content,
-      ProcFileUtils::PHYSICAL_MEM_PREFIX);
-    if (value >= 0) {
-      info.physical_mem = value;
-    }
-
-    if (info.virtual_mem >= 0 && info.physical_mem >= 0) {
+  // The status file is around 1.5KB
+  char content[4096];
+  size_t length = 0;
+  int fd = open(ProcFileUtils::STATUS_FILE.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return info;
+  }
+  while (length < sizeof(content) - 1) {
+    ssize_t nb_read = read(fd, content + length, sizeof(content) - 1 - length);
+    if (nb_read <= 0) {
       break;
     }
+    length += nb_read;
   }
+  close(fd);
+  content[length] = '\0';
+
+  info.virtual_mem = ProcFileUtils::parseForPrefix(content,
+    ProcFileUtils::VIRTUAL_MEM_PREFIX);
+  info.physical_mem = ProcFileUtils::parseForPrefix(content,
+    ProcFileUtils::PHYSICAL_MEM_PREFIX);
   return info;
 }
 
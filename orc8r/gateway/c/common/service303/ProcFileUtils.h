@@ -28,7 +28,9 @@ class ProcFileUtils final {
 
   public:
     /*
-     * Parses the /proc/self/status file for information on memory usage
+     * Parses the /proc/self/status file for information on memory usage. The
+     * file is read with a single read() and parsed in place, it is called on
+     * every metrics scrape.
      *
      * @return memory_info_t containing virtual and physical memory usage
      */
@@ -36,15 +38,13 @@ class ProcFileUtils final {
 
   private:
     /*
-     * Helper function to read from the proc file stream and output the value if
-     * the prefix is found
+     * Helper function to find a "<prefix> <value> kB" line in the content of
+     * the status file and output its value
      *
-     * @return -1 if the string isn't the prefix we're looking for, otherwise
-     *    return the actual value
+     * @return -1 if the prefix isn't found, otherwise the value in bytes
      */
     static double parseForPrefix(
-      std::ifstream& infile,
-      const std::string& to_compare,
+      const char* content,
       const std::string& prefix_name);
 
   private:
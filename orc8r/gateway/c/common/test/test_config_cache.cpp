@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include <gtest/gtest.h>
+#include "yaml-cpp/yaml.h"
+
+#include "ConfigCache.h"
+#include "YAMLUtils.h"
+
+using ::testing::Test;
+
+namespace magma {
+
+const int NB_SERVICES = 30;
+const int NB_LOADS = 1000;
+
+class ConfigCacheTest : public ::testing::Test {
+  protected:
+    virtual void SetUp() {
+      char dir[] = "/tmp/config_cache_XXXXXX";
+      ASSERT_NE(mkdtemp(dir), nullptr);
+      dir_ = dir;
+      file_ = dir_ + "/service.yml";
+      override_file_ = dir_ + "/override/service.yml";
+      nb_loads_ = 0;
+    }
+
+    virtual void TearDown() {
+      unlink(file_.c_str());
+      unlink(override_file_.c_str());
+      rmdir((dir_ + "/override").c_str());
+      rmdir(dir_.c_str());
+    }
+
+    // Replaces the file the way config updates do, with a rename
+    void write_file(const std::string& path, const std::string& content) {
+      auto tmp_path = path + ".tmp";
+      std::ofstream file(tmp_path);
+      file << content;
+      file.close();
+      ASSERT_EQ(rename(tmp_path.c_str(), path.c_str()), 0);
+    }
+
+    std::shared_ptr<const YAML::Node> get_config(ConfigCache& cache) {
+      return cache.get<YAML::Node>(
+        "service", {file_, override_file_}, [this]() {
+          nb_loads_++;
+          auto config = YAML::LoadFile(file_);
+          try {
+            config = YAMLUtils::merge_nodes(
+              config, YAML::LoadFile(override_file_));
+          } catch (const YAML::BadFile& e) {}
+          return std::make_shared<const YAML::Node>(config);
+        });
+    }
+
+  protected:
+    std::string dir_;
+    std::string file_;
+    std::string override_file_;
+    std::atomic<int> nb_loads_;
+};
+
+TEST_F(ConfigCacheTest, test_parsed_once) {
+  ConfigCache cache;
+  write_file(file_, "port: 1\n");
+
+  auto config = get_config(cache);
+  EXPECT_EQ((*config)["port"].as<int>(), 1);
+  EXPECT_EQ(get_config(cache), config);
+  EXPECT_EQ(nb_loads_, 1);
+
+  // Reloaded when a file changes, or appears
+  write_file(file_, "port: 22\n");
+  EXPECT_EQ((*get_config(cache))["port"].as<int>(), 22);
+  ASSERT_EQ(mkdir((dir_ + "/override").c_str(), 0755), 0);
+  write_file(override_file_, "port: 333\n");
+  EXPECT_EQ((*get_config(cache))["port"].as<int>(), 333);
+  EXPECT_EQ(nb_loads_, 3);
+  // The old snapshot is left as is
+  EXPECT_EQ((*config)["port"].as<int>(), 1);
+}
+
+TEST_F(ConfigCacheTest, test_load_failure) {
+  ConfigCache cache;
+
+  EXPECT_THROW(get_config(cache), YAML::BadFile);
+  EXPECT_EQ(cache.subscribe("service", []() {}), -1);
+  write_file(file_, "port: 1\n");
+  EXPECT_EQ((*get_config(cache))["port"].as<int>(), 1);
+}
+
+TEST_F(ConfigCacheTest, test_subscribe) {
+  ConfigCache cache;
+  std::mutex lock;
+  std::condition_variable changed;
+  int nb_changes = 0;
+  int port = 0;
+
+  write_file(file_, "port: 1\n");
+  get_config(cache);
+  int id = cache.subscribe("service", [&]() {
+    std::lock_guard<std::mutex> guard(lock);
+    port = (*get_config(cache))["port"].as<int>();
+    nb_changes++;
+    changed.notify_all();
+  });
+  ASSERT_GE(id, 0);
+
+  write_file(file_, "port: 2\n");
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    ASSERT_TRUE(changed.wait_for(
+      guard, std::chrono::seconds(5), [&]() { return nb_changes == 1; }));
+    EXPECT_EQ(port, 2);
+  }
+  // Reloaded by the watcher, not by the subscriber
+  EXPECT_EQ(nb_loads_, 2);
+
+  // A file being written is not applied, the next write is
+  write_file(file_, "port: [3\n");
+  write_file(file_, "port: 4\n");
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    ASSERT_TRUE(changed.wait_for(
+      guard, std::chrono::seconds(5), [&]() { return port == 4; }));
+  }
+
+  cache.unsubscribe(id);
+  write_file(file_, "port: 5\n");
+  usleep(100000);
+  EXPECT_EQ(port, 4);
+  EXPECT_EQ((*get_config(cache))["port"].as<int>(), 5);
+}
+
+// Loads of a service registry sized config, as done at service startup
+TEST_F(ConfigCacheTest, test_startup_benchmark) {
+  ConfigCache cache;
+  YAML::Emitter out;
+
+  out << YAML::BeginMap << YAML::Key << "services" << YAML::Value
+      << YAML::BeginMap;
+  for (int i = 0; i < NB_SERVICES; i++) {
+    out << YAML::Key << "service_" + std::to_string(i) << YAML::Value
+        << YAML::BeginMap << YAML::Key << "ip_address" << YAML::Value
+        << "127.0.0.1" << YAML::Key << "port" << YAML::Value << 50000 + i
+        << YAML::EndMap;
+  }
+  out << YAML::EndMap << YAML::EndMap;
+  write_file(file_, out.c_str());
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < NB_LOADS; i++) {
+    auto config = YAML::LoadFile(file_);
+    EXPECT_TRUE(config["services"].IsMap());
+  }
+  std::chrono::nanoseconds parse_time =
+    std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < NB_LOADS; i++) {
+    auto config = get_config(cache);
+    EXPECT_TRUE((*config)["services"].IsMap());
+  }
+  std::chrono::nanoseconds cached_time =
+    std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < NB_LOADS; i++) {
+    auto config = YAML::Clone(*get_config(cache));
+    EXPECT_TRUE(config["services"].IsMap());
+  }
+  std::chrono::nanoseconds copy_time =
+    std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(nb_loads_, 1);
+
+  std::cout << out.size() << " bytes config, per load: parsed "
+            << parse_time.count() / NB_LOADS / 1000 << " us, cached "
+            << cached_time.count() / NB_LOADS / 1000 << " us, cached copy "
+            << copy_time.count() / NB_LOADS / 1000 << " us" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+}
@@ -0,0 +1,265 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "MetricsExporter.h"
+#include "ProcFileUtils.h"
+
+using io::prometheus::client::Metric;
+using io::prometheus::client::MetricFamily;
+using magma::orc8r::MetricsContainer;
+using ::testing::Test;
+
+namespace magma { namespace service303 {
+
+const int NB_FAMILIES = 100;
+const int NB_SERIES_PER_FAMILY = 100;
+const int NB_SCRAPES = 100;
+
+/*
+ * Builds what the registry collects: NB_FAMILIES gauge families of
+ * NB_SERIES_PER_FAMILY series labeled by eNB, the value of the first
+ * nb_changed series of each family being bumped by generation
+ */
+std::vector<MetricFamily> collect(int generation, int nb_changed) {
+  std::vector<MetricFamily> collected(NB_FAMILIES);
+  for (int i = 0; i < NB_FAMILIES; i++) {
+    MetricFamily& family = collected[i];
+    family.set_name("family_" + std::to_string(i));
+    family.set_type(io::prometheus::client::GAUGE);
+    for (int j = 0; j < NB_SERIES_PER_FAMILY; j++) {
+      Metric* metric = family.add_metric();
+      auto* label = metric->add_label();
+      label->set_name("enb");
+      label->set_value(std::to_string(j));
+      label = metric->add_label();
+      label->set_name("apn");
+      label->set_value("internet");
+      metric->mutable_gauge()->set_value(j < nb_changed ? generation : 0);
+    }
+  }
+  return collected;
+}
+
+int count_series(const MetricsContainer& response) {
+  int nb_series = 0;
+  for (const auto& family : response.family()) {
+    nb_series += family.metric_size();
+  }
+  return nb_series;
+}
+
+TEST(test_metrics_exporter, test_full_export) {
+  MetricsExporter exporter;
+  MetricsContainer response;
+
+  auto collected = collect(1, 0);
+  EXPECT_EQ(exporter.Export(collected, &response),
+    NB_FAMILIES * NB_SERIES_PER_FAMILY);
+  EXPECT_EQ(response.family_size(), NB_FAMILIES);
+  EXPECT_EQ(response.family(1).name(), "family_1");
+  EXPECT_EQ(response.family(1).metric(2).label(0).value(), "2");
+  // Moved, not copied
+  EXPECT_EQ(collected[1].metric_size(), 0);
+
+  response.Clear();
+  collected = collect(1, 0);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(count_series(response), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+  EXPECT_EQ(exporter.SizeSeries(), 0);
+}
+
+TEST(test_metrics_exporter, test_delta_export) {
+  MetricsExporter exporter;
+  MetricsContainer response;
+
+  exporter.SetDeltaExport(3);
+  auto collected = collect(1, 2);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(count_series(response), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+  EXPECT_EQ(exporter.SizeSeries(), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+
+  // Only the 2 series updated in each family
+  response.Clear();
+  collected = collect(2, 2);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(response.family_size(), NB_FAMILIES);
+  EXPECT_EQ(count_series(response), NB_FAMILIES * 2);
+  EXPECT_EQ(response.family(0).metric(1).label(0).value(), "1");
+  EXPECT_EQ(response.family(0).metric(1).gauge().value(), 2);
+
+  // Nothing changed, empty families are left out
+  response.Clear();
+  collected = collect(2, 2);
+  EXPECT_EQ(exporter.Export(collected, &response), 0);
+  EXPECT_EQ(response.family_size(), 0);
+
+  // Full export
+  response.Clear();
+  collected = collect(2, 2);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(count_series(response), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+
+  exporter.SetDeltaExport(0);
+  EXPECT_EQ(exporter.SizeSeries(), 0);
+}
+
+TEST(test_metrics_exporter, test_histogram_delta) {
+  MetricsExporter exporter;
+  MetricsContainer response;
+  std::vector<MetricFamily> collected(1);
+
+  exporter.SetDeltaExport(10);
+  collected[0].set_name("latency");
+  collected[0].set_type(io::prometheus::client::HISTOGRAM);
+  collected[0].add_metric()->mutable_histogram()->set_sample_count(1);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(count_series(response), 1);
+
+  // Same sum, one more observation
+  response.Clear();
+  collected[0].set_name("latency");
+  collected[0].add_metric()->mutable_histogram()->set_sample_count(2);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(count_series(response), 1);
+}
+
+TEST(test_metrics_exporter, test_vanished_series) {
+  MetricsExporter exporter;
+  MetricsContainer response;
+
+  exporter.SetDeltaExport(10);
+  auto collected = collect(1, 0);
+  exporter.Export(collected, &response);
+  EXPECT_EQ(exporter.SizeSeries(), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+
+  // Only the first family is still collected
+  response.Clear();
+  collected = collect(1, 0);
+  collected.resize(1);
+  EXPECT_EQ(exporter.Export(collected, &response), 0);
+  EXPECT_EQ(exporter.SizeSeries(), NB_SERIES_PER_FAMILY);
+
+  // The others come back as new series
+  response.Clear();
+  collected = collect(1, 0);
+  EXPECT_EQ(exporter.Export(collected, &response),
+    (NB_FAMILIES - 1) * NB_SERIES_PER_FAMILY);
+  EXPECT_EQ(exporter.SizeSeries(), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+}
+
+// GetMetrics may be called from several gRPC threads at once
+TEST(test_metrics_exporter, test_concurrent_delta_export) {
+  const int nb_threads = 4;
+  MetricsExporter exporter;
+  std::vector<std::thread> threads;
+
+  exporter.SetDeltaExport(5);
+  for (int t = 0; t < nb_threads; t++) {
+    threads.emplace_back([&exporter, t]() {
+      for (int i = 0; i < 20; i++) {
+        MetricsContainer response;
+        auto collected = collect(t * 20 + i, 2);
+        exporter.Export(collected, &response);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(exporter.SizeSeries(), NB_FAMILIES * NB_SERIES_PER_FAMILY);
+}
+
+/*
+ * Time to export, serialize and free a scrape, as GetMetrics and gRPC do, by
+ * copying the families as GetMetrics used to, or with the exporter
+ */
+std::chrono::nanoseconds time_scrape(
+    MetricsExporter* exporter,
+    int generation,
+    int nb_changed,
+    int* nb_series,
+    std::size_t* nb_bytes) {
+  auto collected = collect(generation, nb_changed);
+  auto start = std::chrono::steady_clock::now();
+  {
+    MetricsContainer response;
+    if (exporter) {
+      exporter->Export(collected, &response);
+    } else {
+      for (const auto& family : collected) {
+        response.add_family()->CopyFrom(family);
+      }
+    }
+    *nb_bytes += response.SerializeAsString().size();
+    *nb_series = count_series(response);
+    collected.clear();
+  }
+  return std::chrono::steady_clock::now() - start;
+}
+
+// 10K series, 1% of them updated between two scrapes
+TEST(test_metrics_exporter, test_scrape_benchmark) {
+  const int nb_changed = 1;
+  std::chrono::nanoseconds copy_time(0);
+  std::chrono::nanoseconds full_time(0);
+  std::chrono::nanoseconds delta_time(0);
+  std::size_t copy_bytes = 0;
+  std::size_t full_bytes = 0;
+  std::size_t delta_bytes = 0;
+  int nb_series = 0;
+  MetricsExporter full_exporter;
+  MetricsExporter delta_exporter;
+
+  delta_exporter.SetDeltaExport(NB_SCRAPES);
+  for (int i = 0; i < NB_SCRAPES; i++) {
+    copy_time += time_scrape(nullptr, i, nb_changed, &nb_series, &copy_bytes);
+    EXPECT_EQ(nb_series, NB_FAMILIES * NB_SERIES_PER_FAMILY);
+    full_time +=
+      time_scrape(&full_exporter, i, nb_changed, &nb_series, &full_bytes);
+    EXPECT_EQ(nb_series, NB_FAMILIES * NB_SERIES_PER_FAMILY);
+    delta_time +=
+      time_scrape(&delta_exporter, i, nb_changed, &nb_series, &delta_bytes);
+    if (i > 0) {
+      EXPECT_EQ(nb_series, NB_FAMILIES * nb_changed);
+    }
+  }
+  std::cout << NB_FAMILIES * NB_SERIES_PER_FAMILY << " series per scrape: "
+            << "copy " << copy_time.count() / NB_SCRAPES / 1000 << " us, "
+            << "full " << full_time.count() / NB_SCRAPES / 1000 << " us "
+            << full_bytes / NB_SCRAPES << " bytes, "
+            << "delta " << delta_time.count() / NB_SCRAPES / 1000 << " us "
+            << delta_bytes / NB_SCRAPES << " bytes" << std::endl;
+}
+
+TEST(test_metrics_exporter, test_memory_info) {
+  const int nb_reads = 10000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < nb_reads; i++) {
+    auto info = ProcFileUtils::getMemoryInfo();
+    EXPECT_GT(info.physical_mem, 0);
+    EXPECT_GE(info.virtual_mem, info.physical_mem);
+  }
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "getMemoryInfo: " << elapsed.count() / nb_reads << " ns"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+}}